@@ -32,20 +32,29 @@
 #include "gnc-ui-util.h"
 
 
+/* A child of a QuickFill node, for one (upper-cased) character. */
+typedef struct
+{
+    guint key;
+    QuickFill *qf;
+} QuickFillMatch;
+
 struct _QuickFill
 {
     char *text;          /* the first matching text string     */
     int len;             /* number of chars in text string     */
-    GHashTable *matches; /* array of children in the tree      */
+    guint num_matches;   /* number of children in the tree     */
+    QuickFillMatch *matches; /* children, sorted by key        */
 };
 
 
 /** PROTOTYPES ******************************************************/
 static void quickfill_insert_recursive (QuickFill *qf, const char *text,
-                                        int depth, QuickFillSort sort);
+                                        const char *key_char, int len,
+                                        QuickFillSort sort);
 
 static void gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
-        gint depth, QuickFillSort sort);
+        const gchar *key_char, QuickFillSort sort);
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_REGISTER;
@@ -69,7 +78,8 @@ gnc_quickfill_new (void)
     qf->text = NULL;
     qf->len = 0;
 
-    qf->matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qf->num_matches = 0;
+    qf->matches = NULL;
 
     return qf;
 }
@@ -77,11 +87,92 @@ gnc_quickfill_new (void)
 /********************************************************************\
 \********************************************************************/
 
-static gboolean
-destroy_helper (gpointer key, gpointer value, gpointer data)
+/* Binary search the children of qf for key. Returns the index of the
+ * child if found, otherwise the index where it would be inserted. */
+static guint
+quickfill_find_match (const QuickFill *qf, guint key, gboolean *found)
+{
+    guint lo = 0;
+    guint hi = qf->num_matches;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (qf->matches[mid].key == key)
+        {
+            *found = TRUE;
+            return mid;
+        }
+        if (qf->matches[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *found = FALSE;
+    return lo;
+}
+
+static QuickFill *
+quickfill_lookup_match (const QuickFill *qf, guint key)
+{
+    gboolean found;
+    guint i = quickfill_find_match (qf, key, &found);
+
+    return found ? qf->matches[i].qf : NULL;
+}
+
+static QuickFill *
+quickfill_add_match (QuickFill *qf, guint key)
+{
+    gboolean found;
+    guint i = quickfill_find_match (qf, key, &found);
+
+    if (found)
+        return qf->matches[i].qf;
+
+    qf->matches = g_renew (QuickFillMatch, qf->matches, qf->num_matches + 1);
+    memmove (&qf->matches[i + 1], &qf->matches[i],
+             (qf->num_matches - i) * sizeof (QuickFillMatch));
+    qf->num_matches++;
+
+    qf->matches[i].key = key;
+    qf->matches[i].qf = gnc_quickfill_new ();
+
+    return qf->matches[i].qf;
+}
+
+static void
+quickfill_remove_match (QuickFill *qf, guint key)
+{
+    gboolean found;
+    guint i = quickfill_find_match (qf, key, &found);
+
+    if (!found)
+        return;
+
+    qf->num_matches--;
+    memmove (&qf->matches[i], &qf->matches[i + 1],
+             (qf->num_matches - i) * sizeof (QuickFillMatch));
+    if (qf->num_matches == 0)
+    {
+        g_free (qf->matches);
+        qf->matches = NULL;
+    }
+}
+
+static void
+quickfill_destroy_matches (QuickFill *qf)
 {
-    gnc_quickfill_destroy (value);
-    return TRUE;
+    guint i;
+
+    for (i = 0; i < qf->num_matches; i++)
+        gnc_quickfill_destroy (qf->matches[i].qf);
+
+    g_free (qf->matches);
+    qf->matches = NULL;
+    qf->num_matches = 0;
 }
 
 void
@@ -90,9 +181,7 @@ gnc_quickfill_destroy (QuickFill *qf)
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach (qf->matches, (GHFunc)destroy_helper, NULL);
-    g_hash_table_destroy (qf->matches);
-    qf->matches = NULL;
+    quickfill_destroy_matches (qf);
 
     if (qf->text)
         CACHE_REMOVE(qf->text);
@@ -108,7 +197,7 @@ gnc_quickfill_purge (QuickFill *qf)
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach_remove (qf->matches, destroy_helper, NULL);
+    quickfill_destroy_matches (qf);
 
     if (qf->text)
         CACHE_REMOVE (qf->text);
@@ -140,7 +229,7 @@ gnc_quickfill_get_char_match (QuickFill *qf, gunichar uc)
 
     DEBUG ("xaccGetQuickFill(): index = %u\n", key);
 
-    return g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+    return quickfill_lookup_match (qf, key);
 }
 
 /********************************************************************\
@@ -187,14 +276,6 @@ gnc_quickfill_get_string_match (QuickFill *qf, const char *str)
 /********************************************************************\
 \********************************************************************/
 
-static void
-unique_len_helper (gpointer key, gpointer value, gpointer data)
-{
-    QuickFill **qf_p = data;
-
-    *qf_p = value;
-}
-
 QuickFill *
 gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 {
@@ -204,16 +285,9 @@ gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
     if (qf == NULL)
         return NULL;
 
-    while (1)
+    while (qf->num_matches == 1)
     {
-        guint count;
-
-        count = g_hash_table_size (qf->matches);
-
-        if (count != 1)
-            break;
-
-        g_hash_table_foreach (qf->matches, unique_len_helper, &qf);
+        qf = qf->matches[0].qf;
 
         if (length != NULL)
             (*length)++;
@@ -235,41 +309,37 @@ gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    quickfill_insert_recursive (qf, normalized_str, 0, sort);
+    quickfill_insert_recursive (qf, normalized_str, normalized_str,
+                                g_utf8_strlen (normalized_str, -1), sort);
     g_free (normalized_str);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+/* key_char points at the character of text for this depth of the
+ * tree and len is the length of text in characters, so that neither
+ * needs recomputing from the start of text at every level. */
 static void
-quickfill_insert_recursive (QuickFill *qf, const char *text, int depth,
+quickfill_insert_recursive (QuickFill *qf, const char *text,
+                            const char *key_char, int len,
                             QuickFillSort sort)
 {
     guint key;
     char *old_text;
     QuickFill *match_qf;
-    int len;
-    char *key_char;
     gunichar key_char_uc;
 
     if (qf == NULL)
         return;
 
-    if ((text == NULL) || (g_utf8_strlen (text, -1) <= depth))
+    if ((text == NULL) || (*key_char == '\0'))
         return;
 
-    key_char = g_utf8_offset_to_pointer (text, depth);
-
     key_char_uc = g_utf8_get_char (key_char);
     key = g_unichar_toupper (key_char_uc);
 
-    match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
-    if (match_qf == NULL)
-    {
-        match_qf = gnc_quickfill_new ();
-        g_hash_table_insert (qf->matches, GUINT_TO_POINTER (key), match_qf);
-    }
+    match_qf = quickfill_add_match (qf, key);
 
     old_text = match_qf->text;
 
@@ -282,8 +352,6 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int depth,
 
     case QUICKFILL_LIFO:
     default:
-        len = g_utf8_strlen (text, -1);
-
         /* If there's no string there already, just put the new one in. */
         if (old_text == NULL)
         {
@@ -303,7 +371,8 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int depth,
         break;
     }
 
-    quickfill_insert_recursive (match_qf, text, ++depth, sort);
+    quickfill_insert_recursive (match_qf, text, g_utf8_next_char (key_char),
+                                len, sort);
 }
 
 /********************************************************************\
@@ -318,7 +387,7 @@ gnc_quickfill_remove (QuickFill *qf, const gchar *text, QuickFillSort sort)
     if (text == NULL) return;
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    gnc_quickfill_remove_recursive (qf, normalized_str, 0, sort);
+    gnc_quickfill_remove_recursive (qf, normalized_str, normalized_str, sort);
     g_free (normalized_str);
 }
 
@@ -359,8 +428,8 @@ best_text_helper (gpointer key, gpointer value, gpointer user_data)
 
 
 static void
-gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
-                                QuickFillSort sort)
+gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
+                                const gchar *key_char, QuickFillSort sort)
 {
     QuickFill *match_qf;
     gchar *child_text;
@@ -369,28 +438,27 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
     child_text = NULL;
     child_len = 0;
 
-    if (depth < g_utf8_strlen (text, -1))
+    if (*key_char != '\0')
     {
         /* process next letter */
 
-        gchar *key_char;
         gunichar key_char_uc;
         guint key;
 
-        key_char = g_utf8_offset_to_pointer (text, depth);
         key_char_uc = g_utf8_get_char (key_char);
         key = g_unichar_toupper (key_char_uc);
 
-        match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+        match_qf = quickfill_lookup_match (qf, key);
         if (match_qf)
         {
             /* remove text from child qf */
-            gnc_quickfill_remove_recursive (match_qf, text, depth + 1, sort);
+            gnc_quickfill_remove_recursive (match_qf, text,
+                                            g_utf8_next_char (key_char), sort);
 
             if (match_qf->text == NULL)
             {
                 /* text was the only word with a prefix up to match_qf */
-                g_hash_table_remove (qf->matches, GUINT_TO_POINTER (key));
+                quickfill_remove_match (qf, key);
                 gnc_quickfill_destroy (match_qf);
 
             }
@@ -422,14 +490,17 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
         }
         else
         {
-            if (g_hash_table_size (qf->matches) != 0)
+            if (qf->num_matches != 0)
             {
                 /* otherwise search for another good text */
                 struct _BestText bts;
+                guint i;
                 bts.text = NULL;
                 bts.sort = sort;
 
-                g_hash_table_foreach (qf->matches, (GHFunc) best_text_helper, &bts);
+                for (i = 0; i < qf->num_matches; i++)
+                    best_text_helper (GUINT_TO_POINTER (qf->matches[i].key),
+                                      qf->matches[i].qf, &bts);
                 best_text = bts.text;
                 best_len = (best_text == NULL) ? 0 : g_utf8_strlen (best_text, -1);
             }
@@ -1214,9 +1214,34 @@
 static double
 rnd (double x, unsigned places)
 {
+    static const double scale[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+    };
     double r;
     char buf[50];			/* make buffer large enough */
 
+    /* The schedules round several times per period, so avoid the
+     * printf round trip when the scaled value is small enough and far
+     * enough from a tie that rounding it cannot differ from printf's
+     * rounding of the exact value.  k / scale is then the double
+     * nearest the decimal printf would write. */
+    if (places < sizeof (scale) / sizeof (scale[0]))
+    {
+        double y = x * scale[places];
+        if (dabs (y) < 1e9)
+        {
+            double k = floor (y);
+            double f = y - k;
+            if (dabs (f - 0.5) > 1e-6)
+            {
+                if (f > 0.5)
+                    k += 1.0;
+                return (k == 0.0) ? copysign (0.0, x) : k / scale[places];
+            }
+        }
+    }
+
     sprintf (buf, "%.*f", (int) places, x);
     r = strtod(buf, NULL);
 
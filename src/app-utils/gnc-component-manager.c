@@ -40,8 +40,6 @@ typedef struct
 {
     GHashTable * event_masks;
     GHashTable * entity_events;
-
-    gboolean match;
 } ComponentEventInfo;
 
 typedef struct
@@ -64,8 +62,27 @@ static guint  suspend_counter = 0;
 static gint   next_component_id = 1;
 static GList *components = NULL;
 
-static ComponentEventInfo changes = { NULL, NULL, FALSE };
-static ComponentEventInfo changes_backup = { NULL, NULL, FALSE };
+static ComponentEventInfo changes = { NULL, NULL };
+static ComponentEventInfo changes_backup = { NULL, NULL };
+
+/* Inverted indexes of the component watches, so a refresh only has to
+ * look at the components watching something that changed. They map
+ * entity GUIDs and entity types to lists of component ids. */
+static GHashTable *entity_watchers = NULL;
+static GHashTable *type_watchers = NULL;
+
+/* Refresh statistics, kept while profiling is active: the refresh
+ * passes and, per component class, the refresh handler calls. */
+typedef struct
+{
+    const char *component_class;
+    gint64 refreshes;
+    gint64 usec;
+} RefreshStats;
+
+static GHashTable *refresh_stats = NULL;
+static gint64 refresh_passes = 0;
+static gint64 refresh_usec = 0;
 
 
 /* This static indicates the debugging module that this .o belongs to.  */
@@ -252,6 +269,111 @@ add_event_type (ComponentEventInfo *cei, QofIdTypeConst entity_type,
         *mask = event_mask;
 }
 
+static void
+index_entity_watch (const GncGUID *entity, gint component_id)
+{
+    gpointer key = NULL;
+    gpointer ids = NULL;
+
+    if (!entity_watchers)
+        entity_watchers = guid_hash_table_new ();
+
+    if (!g_hash_table_lookup_extended (entity_watchers, entity, &key, &ids))
+    {
+        GncGUID *guid = guid_malloc ();
+
+        *guid = *entity;
+        key = guid;
+    }
+
+    ids = g_list_prepend (ids, GINT_TO_POINTER (component_id));
+    g_hash_table_insert (entity_watchers, key, ids);
+}
+
+static void
+unindex_entity_watch (const GncGUID *entity, gint component_id)
+{
+    gpointer key;
+    gpointer ids;
+
+    if (!entity_watchers ||
+            !g_hash_table_lookup_extended (entity_watchers, entity, &key, &ids))
+        return;
+
+    ids = g_list_remove (ids, GINT_TO_POINTER (component_id));
+    if (ids)
+    {
+        g_hash_table_insert (entity_watchers, key, ids);
+        return;
+    }
+
+    g_hash_table_remove (entity_watchers, key);
+    guid_free (key);
+}
+
+static void
+index_type_watch (QofIdTypeConst entity_type, gint component_id)
+{
+    gpointer key = NULL;
+    gpointer ids = NULL;
+
+    if (!type_watchers)
+        type_watchers = g_hash_table_new (g_str_hash, g_str_equal);
+
+    if (!g_hash_table_lookup_extended (type_watchers, entity_type, &key, &ids))
+        key = qof_string_cache_insert ((gpointer) entity_type);
+
+    ids = g_list_prepend (ids, GINT_TO_POINTER (component_id));
+    g_hash_table_insert (type_watchers, key, ids);
+}
+
+static void
+unindex_type_watch (QofIdTypeConst entity_type, gint component_id)
+{
+    gpointer key;
+    gpointer ids;
+
+    if (!type_watchers ||
+            !g_hash_table_lookup_extended (type_watchers, entity_type, &key, &ids))
+        return;
+
+    ids = g_list_remove (ids, GINT_TO_POINTER (component_id));
+    if (ids)
+    {
+        g_hash_table_insert (type_watchers, key, ids);
+        return;
+    }
+
+    g_hash_table_remove (type_watchers, key);
+    qof_string_cache_remove (key);
+}
+
+static void
+unindex_entity_watch_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    unindex_entity_watch (key, GPOINTER_TO_INT (user_data));
+}
+
+static void
+unindex_type_watch_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    unindex_type_watch (key, GPOINTER_TO_INT (user_data));
+}
+
+static gboolean
+destroy_watchers_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    GList *ids = value;
+
+    g_list_free (ids);
+    if (user_data)
+        qof_string_cache_remove (key);
+    else
+        guid_free (key);
+
+    return TRUE;
+}
+
 static void
 gnc_cm_event_handler (QofInstance *entity,
                       QofEventId event_type,
@@ -283,6 +405,83 @@ gnc_cm_event_handler (QofInstance *entity,
         gnc_gui_refresh_internal (FALSE);
 }
 
+static void
+gnc_cm_reset_stats (void)
+{
+    if (refresh_stats)
+        g_hash_table_remove_all (refresh_stats);
+    refresh_passes = refresh_usec = 0;
+}
+
+static gint
+compare_refresh_usec (gconstpointer a, gconstpointer b)
+{
+    gint64 ua = (*(RefreshStats * const *)a)->usec;
+    gint64 ub = (*(RefreshStats * const *)b)->usec;
+
+    return ua < ub ? 1 : ua > ub ? -1 : 0;
+}
+
+static void
+gnc_cm_report_stats (GString *summary)
+{
+    GPtrArray *sorted = g_ptr_array_new ();
+    GHashTableIter iter;
+    gpointer key, value;
+    guint i;
+
+    if (refresh_stats)
+    {
+        g_hash_table_iter_init (&iter, refresh_stats);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            g_ptr_array_add (sorted, value);
+    }
+    g_ptr_array_sort (sorted, compare_refresh_usec);
+    g_string_append_printf (summary, "GUI refreshes: %" G_GINT64_FORMAT
+                            " passes, %" G_GINT64_FORMAT " us\n",
+                            refresh_passes, refresh_usec);
+    for (i = 0; i < sorted->len; ++i)
+    {
+        RefreshStats *rs = g_ptr_array_index (sorted, i);
+        g_string_append_printf (summary, "  %10" G_GINT64_FORMAT " us %10"
+                                G_GINT64_FORMAT " refreshes  %s\n",
+                                rs->usec, rs->refreshes, rs->component_class);
+    }
+    g_ptr_array_free (sorted, TRUE);
+}
+
+/* Calls the component's refresh handler, timing it while profiling. */
+static void
+gnc_cm_refresh_component (ComponentInfo *ci, GHashTable *changes)
+{
+    RefreshStats *rs;
+    const char *component_class;
+    gint64 start;
+
+    if (G_LIKELY (!QOF_PROFILE_IS_ACTIVE ()))
+    {
+        ci->refresh_handler (changes, ci->user_data);
+        return;
+    }
+
+    /* The component may close itself, so look up its class first. */
+    component_class = ci->component_class ? ci->component_class : "(null)";
+    if (!refresh_stats)
+        refresh_stats = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, g_free);
+    rs = g_hash_table_lookup (refresh_stats, component_class);
+    if (!rs)
+    {
+        rs = g_new0 (RefreshStats, 1);
+        rs->component_class = g_strdup (component_class);
+        g_hash_table_insert (refresh_stats, (gpointer)rs->component_class, rs);
+    }
+    start = g_get_monotonic_time ();
+    ci->refresh_handler (changes, ci->user_data);
+    rs->usec += g_get_monotonic_time () - start;
+    rs->refreshes++;
+}
+
 static gint handler_id;
 
 void
@@ -301,6 +500,7 @@ gnc_component_manager_init (void)
     changes_backup.entity_events = guid_hash_table_new ();
 
     handler_id = qof_event_register_handler (gnc_cm_event_handler, NULL);
+    qof_profile_register_report (gnc_cm_reset_stats, gnc_cm_report_stats);
 }
 
 void
@@ -324,6 +524,29 @@ gnc_component_manager_shutdown (void)
     destroy_event_hash (changes_backup.entity_events);
     changes_backup.entity_events = NULL;
 
+    if (entity_watchers)
+    {
+        g_hash_table_foreach_remove (entity_watchers, destroy_watchers_helper,
+                                     NULL);
+        g_hash_table_destroy (entity_watchers);
+        entity_watchers = NULL;
+    }
+
+    if (type_watchers)
+    {
+        g_hash_table_foreach_remove (type_watchers, destroy_watchers_helper,
+                                     GINT_TO_POINTER (TRUE));
+        g_hash_table_destroy (type_watchers);
+        type_watchers = NULL;
+    }
+
+    if (refresh_stats)
+    {
+        g_hash_table_destroy (refresh_stats);
+        refresh_stats = NULL;
+    }
+    qof_profile_unregister_report (gnc_cm_report_stats);
+
     qof_event_unregister_handler (handler_id);
 }
 
@@ -454,6 +677,8 @@ gnc_gui_component_watch_entity (gint component_id,
                                 QofEventId event_mask)
 {
     ComponentInfo *ci;
+    gboolean was_watched;
+    gboolean is_watched;
 
     if (entity == NULL)
         return;
@@ -465,7 +690,14 @@ gnc_gui_component_watch_entity (gint component_id,
         return;
     }
 
+    was_watched = g_hash_table_lookup (ci->watch_info.entity_events, entity) != NULL;
     add_event (&ci->watch_info, entity, event_mask, FALSE);
+    is_watched = g_hash_table_lookup (ci->watch_info.entity_events, entity) != NULL;
+
+    if (is_watched && !was_watched)
+        index_entity_watch (entity, component_id);
+    else if (was_watched && !is_watched)
+        unindex_entity_watch (entity, component_id);
 }
 
 void
@@ -482,6 +714,10 @@ gnc_gui_component_watch_entity_type (gint component_id,
         return;
     }
 
+    if (entity_type &&
+            !g_hash_table_lookup (ci->watch_info.event_masks, entity_type))
+        index_type_watch (entity_type, component_id);
+
     add_event_type (&ci->watch_info, entity_type, event_mask, FALSE);
 }
 
@@ -506,6 +742,9 @@ gnc_gui_component_clear_watches (gint component_id)
         return;
     }
 
+    g_hash_table_foreach (ci->watch_info.entity_events,
+                          unindex_entity_watch_helper,
+                          GINT_TO_POINTER (component_id));
     clear_event_info (&ci->watch_info);
 }
 
@@ -531,6 +770,9 @@ gnc_unregister_gui_component (gint component_id)
 
     components = g_list_remove (components, ci);
 
+    g_hash_table_foreach (ci->watch_info.event_masks,
+                          unindex_type_watch_helper,
+                          GINT_TO_POINTER (component_id));
     destroy_mask_hash (ci->watch_info.event_masks);
     ci->watch_info.event_masks = NULL;
 
@@ -597,80 +839,86 @@ gnc_resume_gui_refresh (void)
 }
 
 static void
-match_type_helper (gpointer key, gpointer value, gpointer user_data)
+match_type_watchers (gpointer key, gpointer value, gpointer user_data)
 {
-    ComponentEventInfo *cei = user_data;
     QofIdType id_type = key;
     QofEventId * et = value;
-    QofEventId * et_2;
+    GHashTable *matched = user_data;
+    GList *node;
 
-    et_2 = g_hash_table_lookup (cei->event_masks, id_type);
-    if (!et_2)
+    if (!type_watchers || !*et)
         return;
 
-    if (*et & *et_2)
-        cei->match = TRUE;
+    node = g_hash_table_lookup (type_watchers, id_type);
+    for ( ; node; node = node->next)
+    {
+        ComponentInfo *ci = find_component (GPOINTER_TO_INT (node->data));
+        QofEventId * et_2;
+
+        if (!ci)
+            continue;
+
+        et_2 = g_hash_table_lookup (ci->watch_info.event_masks, id_type);
+        if (et_2 && (*et & *et_2))
+            g_hash_table_insert (matched, node->data, node->data);
+    }
 }
 
 static void
-match_helper (gpointer key, gpointer value, gpointer user_data)
+match_entity_watchers (gpointer key, gpointer value, gpointer user_data)
 {
     GncGUID *guid = key;
     EventInfo *ei_1 = value;
-    EventInfo *ei_2;
-    ComponentEventInfo *cei = user_data;
+    GHashTable *matched = user_data;
+    GList *node;
 
-    ei_2 = g_hash_table_lookup (cei->entity_events, guid);
-    if (!ei_2)
+    if (!entity_watchers)
         return;
 
-    if (ei_1->event_mask & ei_2->event_mask)
-        cei->match = TRUE;
-}
-
-static gboolean
-changes_match (ComponentEventInfo *cei, ComponentEventInfo *changes)
-{
-    ComponentEventInfo *big_cei;
-    GHashTable *smalltable;
-
-    if (cei == NULL)
-        return FALSE;
+    node = g_hash_table_lookup (entity_watchers, guid);
+    for ( ; node; node = node->next)
+    {
+        ComponentInfo *ci = find_component (GPOINTER_TO_INT (node->data));
+        EventInfo *ei_2;
 
-    /* check types first, for efficiency */
-    cei->match = FALSE;
-    g_hash_table_foreach (changes->event_masks, match_type_helper, cei);
-    if (cei->match)
-        return TRUE;
+        if (!ci)
+            continue;
 
-    if (g_hash_table_size (cei->entity_events) <=
-            g_hash_table_size (changes->entity_events))
-    {
-        smalltable = cei->entity_events;
-        big_cei = changes;
-    }
-    else
-    {
-        smalltable = changes->entity_events;
-        big_cei = cei;
+        ei_2 = g_hash_table_lookup (ci->watch_info.entity_events, guid);
+        if (ei_2 && (ei_1->event_mask & ei_2->event_mask))
+            g_hash_table_insert (matched, node->data, node->data);
     }
+}
+
+/* Return the set of ids of the components whose watches match the
+ * accumulated changes. Only the components listed in the watcher
+ * indexes for a changed type or entity are examined. */
+static GHashTable *
+find_matching_component_ids (ComponentEventInfo *changes)
+{
+    GHashTable *matched;
 
-    big_cei->match = FALSE;
+    matched = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-    g_hash_table_foreach (smalltable, match_helper, big_cei);
+    g_hash_table_foreach (changes->event_masks, match_type_watchers, matched);
+    g_hash_table_foreach (changes->entity_events, match_entity_watchers,
+                          matched);
 
-    return big_cei->match;
+    return matched;
 }
 
 static void
 gnc_gui_refresh_internal (gboolean force)
 {
+    GHashTable *matched = NULL;
     GList *list;
     GList *node;
+    gint64 start;
 
     if (!got_events && !force)
         return;
 
+    start = G_UNLIKELY (QOF_PROFILE_IS_ACTIVE ()) ? g_get_monotonic_time () : 0;
     gnc_suspend_gui_refresh ();
 
     {
@@ -691,6 +939,9 @@ gnc_gui_refresh_internal (gboolean force)
 
     list = find_component_ids_by_class (NULL);
 
+    if (!force)
+        matched = find_matching_component_ids (&changes_backup);
+
     for (node = list; node; node = node->next)
     {
         ComponentInfo *ci = find_component (GPOINTER_TO_INT (node->data));
@@ -713,17 +964,17 @@ gnc_gui_refresh_internal (gboolean force)
 #if CM_DEBUG
                 fprintf (stderr, "calling %s:%d C handler\n", ci->component_class, ci->component_id);
 #endif
-                ci->refresh_handler (NULL, ci->user_data);
+                gnc_cm_refresh_component (ci, NULL);
             }
         }
-        else if (changes_match (&ci->watch_info, &changes_backup))
+        else if (g_hash_table_lookup (matched, node->data))
         {
             if (ci->refresh_handler)
             {
 #if CM_DEBUG
                 fprintf (stderr, "calling %s:%d C handler\n", ci->component_class, ci->component_id);
 #endif
-                ci->refresh_handler (changes_backup.entity_events, ci->user_data);
+                gnc_cm_refresh_component (ci, changes_backup.entity_events);
             }
         }
         else
@@ -737,8 +988,15 @@ gnc_gui_refresh_internal (gboolean force)
     clear_event_info (&changes_backup);
     got_events = FALSE;
 
+    if (matched)
+        g_hash_table_destroy (matched);
     g_list_free (list);
 
+    if (start)
+    {
+        refresh_passes++;
+        refresh_usec += g_get_monotonic_time () - start;
+    }
     gnc_resume_gui_refresh ();
 }
 
@@ -48,12 +48,49 @@ typedef struct ParserNum
     gnc_numeric value;
 } ParserNum;
 
+typedef enum
+{
+    GEP_CONST,
+    GEP_VAR,
+    GEP_SLOT,
+    GEP_NEG,
+    GEP_OP
+} GEPNodeType;
+
+/* A node of a compiled expression. Constant subexpressions are folded
+ * into GEP_CONST nodes while compiling. A named variable is a GEP_SLOT
+ * whose left child is the variable's current value and whose right
+ * child is the GEP_VAR leaf: the parser negates operands in place, and
+ * for a variable that must only affect the uses which follow. */
+typedef struct GEPNode
+{
+    GEPNodeType type;
+    char op;
+    gnc_numeric value;
+    char *name;
+    struct GEPNode *left;
+    struct GEPNode *right;
+} GEPNode;
+
+struct _GNCExpFormula
+{
+    char *expression;
+    GEPNode *root;          /* NULL if the expression is interpreted */
+    GPtrArray *nodes;
+};
+
 
 /** Static Globals *************************************************/
 static GHashTable   *variable_bindings = NULL;
 static ParseError    last_error        = PARSER_NO_ERROR;
 static GNCParseError last_gncp_error   = NO_ERR;
 static gboolean      parser_inited     = FALSE;
+static GHashTable   *compiled_formulas = NULL;
+
+/* Scratch state of gnc_exp_parser_compile; the parser callbacks have
+ * no closure argument. */
+static GPtrArray    *compile_nodes        = NULL;
+static gboolean      compile_needs_interp = FALSE;
 
 
 /** Implementations ************************************************/
@@ -134,6 +171,12 @@ gnc_exp_parser_shutdown (void)
     GKeyFile* key_file;
     gchar *filename;
 
+    if (compiled_formulas)
+    {
+        g_hash_table_destroy (compiled_formulas);
+        compiled_formulas = NULL;
+    }
+
     if (!parser_inited)
         return;
 
@@ -373,6 +416,29 @@ trans_numeric(const char *digit_str,
     return pnum;
 }
 
+static gnc_numeric
+apply_numeric_op (char op_sym, gnc_numeric left, gnc_numeric right)
+{
+    switch (op_sym)
+    {
+    case ADD_OP:
+        return gnc_numeric_add (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case SUB_OP:
+        return gnc_numeric_sub (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case DIV_OP:
+        return gnc_numeric_div (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case MUL_OP:
+        return gnc_numeric_mul (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case ASN_OP:
+    default:
+        return right;
+    }
+}
+
 static void *
 numeric_ops(char op_sym,
             void *left_value,
@@ -386,29 +452,7 @@ numeric_ops(char op_sym,
         return NULL;
 
     result = (op_sym == ASN_OP) ? left : g_new0(ParserNum, 1);
-
-    switch (op_sym)
-    {
-    case ADD_OP:
-        result->value = gnc_numeric_add (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case SUB_OP:
-        result->value = gnc_numeric_sub (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case DIV_OP:
-        result->value = gnc_numeric_div (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case MUL_OP:
-        result->value = gnc_numeric_mul (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case ASN_OP:
-        result->value = right->value;
-        break;
-    }
+    result->value = apply_numeric_op (op_sym, left->value, right->value);
 
     return result;
 }
@@ -594,6 +638,348 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     return last_error == PARSER_NO_ERROR;
 }
 
+/** Compiled expressions *******************************************/
+
+static GEPNode *
+gep_node_new (GEPNodeType type)
+{
+    GEPNode *node = g_new0 (GEPNode, 1);
+
+    node->type = type;
+    g_ptr_array_add (compile_nodes, node);
+
+    return node;
+}
+
+static void
+gep_node_free (gpointer data)
+{
+    GEPNode *node = data;
+
+    g_free (node->name);
+    g_free (node);
+}
+
+static GEPNode *
+gep_current (GEPNode *node)
+{
+    return (node && node->type == GEP_SLOT) ? node->left : node;
+}
+
+static void *
+compile_trans_numeric (const char *digit_str,
+                       gchar      *radix_point,
+                       gchar      *group_char,
+                       char      **rstr)
+{
+    GEPNode *node;
+    gnc_numeric value;
+
+    if (digit_str == NULL)
+        return NULL;
+
+    /* The parser asks for a "0" without an end pointer when it
+     * creates a named variable. */
+    if (rstr == NULL)
+    {
+        node = gep_node_new (GEP_SLOT);
+        node->right = gep_node_new (GEP_VAR);
+        node->left = node->right;
+        return node;
+    }
+
+    if (!xaccParseAmount (digit_str, TRUE, &value, rstr))
+        return NULL;
+
+    node = gep_node_new (GEP_CONST);
+    node->value = value;
+
+    return node;
+}
+
+static void *
+compile_numeric_ops (char op_sym, void *left_value, void *right_value)
+{
+    GEPNode *left = gep_current (left_value);
+    GEPNode *right = gep_current (right_value);
+    GEPNode *node;
+
+    if ((left == NULL) || (right == NULL))
+        return NULL;
+
+    if (left->type == GEP_CONST && right->type == GEP_CONST)
+    {
+        node = gep_node_new (GEP_CONST);
+        node->value = apply_numeric_op (op_sym, left->value, right->value);
+        return node;
+    }
+
+    node = gep_node_new (GEP_OP);
+    node->op = op_sym;
+    node->left = left;
+    node->right = right;
+
+    return node;
+}
+
+static void *
+compile_negate (void *value)
+{
+    GEPNode *node = value;
+    GEPNode *child;
+
+    if (node == NULL)
+        return NULL;
+
+    switch (node->type)
+    {
+    case GEP_SLOT:
+        if (node->left->type == GEP_NEG)
+        {
+            node->left = node->left->left;
+        }
+        else
+        {
+            child = gep_node_new (GEP_NEG);
+            child->left = node->left;
+            node->left = child;
+        }
+        break;
+    case GEP_CONST:
+        node->value = gnc_numeric_neg (node->value);
+        break;
+    default:
+        /* An unshared temporary; push its contents down a level. */
+        child = gep_node_new (node->type);
+        child->op = node->op;
+        child->left = node->left;
+        child->right = node->right;
+        node->type = GEP_NEG;
+        node->left = child;
+        node->right = NULL;
+        break;
+    }
+
+    return node;
+}
+
+static void
+compile_free_numeric (void *value)
+{
+    /* Nodes are owned by compile_nodes. */
+}
+
+static void *
+compile_func_op (const char *fname, int argc, void **argv)
+{
+    /* Function calls go to Scheme with concrete values, so such
+     * expressions are left to the interpreter. */
+    compile_needs_interp = TRUE;
+    return gep_node_new (GEP_CONST);
+}
+
+GNCExpFormula *
+gnc_exp_parser_compile (const char *expression, char **error_loc_p)
+{
+    GNCExpFormula *formula;
+    parser_env_ptr pe;
+    var_store_ptr vars;
+    struct lconv *lc;
+    var_store result;
+    char *error_loc;
+
+    if (expression == NULL)
+        return NULL;
+
+    formula = g_new0 (GNCExpFormula, 1);
+    formula->expression = g_strdup (expression);
+
+    if (error_loc_p != NULL)
+        *error_loc_p = NULL;
+
+    /* Assignments modify the variable bindings and strings are only
+     * good as function arguments; leave both to the interpreter. */
+    if (strpbrk (expression, "=\""))
+        return formula;
+
+    result.variable_name = NULL;
+    result.value = NULL;
+    result.next_var = NULL;
+
+    compile_nodes = g_ptr_array_new_with_free_func (gep_node_free);
+    compile_needs_interp = FALSE;
+
+    lc = gnc_localeconv ();
+
+    pe = init_parser (NULL, lc->mon_decimal_point, lc->mon_thousands_sep,
+                      compile_trans_numeric, compile_numeric_ops,
+                      compile_negate, compile_free_numeric, compile_func_op);
+
+    error_loc = parse_string (&result, expression, pe);
+
+    if (error_loc != NULL)
+    {
+        if (error_loc_p != NULL)
+            *error_loc_p = error_loc;
+
+        last_error = get_parse_error (pe);
+
+        exit_parser (pe);
+        g_ptr_array_free (compile_nodes, TRUE);
+        compile_nodes = NULL;
+        gnc_exp_parser_formula_free (formula);
+        return NULL;
+    }
+
+    for (vars = parser_get_vars (pe); vars; vars = vars->next_var)
+    {
+        GEPNode *slot = vars->value;
+        slot->right->name = g_strdup (vars->variable_name);
+    }
+
+    formula->root = gep_current (result.value);
+    if (compile_needs_interp || formula->root == NULL)
+    {
+        formula->root = NULL;
+        g_ptr_array_free (compile_nodes, TRUE);
+    }
+    else
+        formula->nodes = compile_nodes;
+    compile_nodes = NULL;
+
+    exit_parser (pe);
+
+    return formula;
+}
+
+void
+gnc_exp_parser_formula_free (GNCExpFormula *formula)
+{
+    if (formula == NULL)
+        return;
+
+    if (formula->nodes)
+        g_ptr_array_free (formula->nodes, TRUE);
+    g_free (formula->expression);
+    g_free (formula);
+}
+
+static gnc_numeric
+gep_lookup_variable (const char *name, GHashTable *varHash)
+{
+    gpointer key, value;
+    ParserNum *pnum;
+    gnc_numeric *num;
+
+    /* Same precedence as the interpreter: the caller's variables, then
+     * the predefined ones. Anything else is a new variable worth 0,
+     * which is reported back through varHash. */
+    if (varHash != NULL &&
+        g_hash_table_lookup_extended (varHash, name, &key, &value))
+        return value ? *(gnc_numeric*)value : gnc_numeric_create (0, 0);
+
+    pnum = variable_bindings ? g_hash_table_lookup (variable_bindings, name)
+                             : NULL;
+    if (pnum != NULL)
+        return pnum->value;
+
+    if (varHash != NULL)
+    {
+        num = g_new0 (gnc_numeric, 1);
+        *num = gnc_numeric_zero ();
+        g_hash_table_insert (varHash, g_strdup (name), num);
+    }
+
+    return gnc_numeric_zero ();
+}
+
+static gnc_numeric
+gep_eval_node (const GEPNode *node, GHashTable *varHash)
+{
+    switch (node->type)
+    {
+    case GEP_CONST:
+        return node->value;
+    case GEP_VAR:
+        return gep_lookup_variable (node->name, varHash);
+    case GEP_SLOT:
+        return gep_eval_node (node->left, varHash);
+    case GEP_NEG:
+        return gnc_numeric_neg (gep_eval_node (node->left, varHash));
+    case GEP_OP:
+        return apply_numeric_op (node->op,
+                                 gep_eval_node (node->left, varHash),
+                                 gep_eval_node (node->right, varHash));
+    }
+
+    return gnc_numeric_zero ();
+}
+
+gboolean
+gnc_exp_parser_eval (const GNCExpFormula *formula,
+                     gnc_numeric *value_p,
+                     char **error_loc_p,
+                     GHashTable *varHash)
+{
+    gnc_numeric value;
+
+    if (formula == NULL)
+        return FALSE;
+
+    if (formula->root == NULL)
+        return gnc_exp_parser_parse_separate_vars (formula->expression,
+                                                   value_p, error_loc_p,
+                                                   varHash);
+
+    if (!parser_inited)
+        gnc_exp_parser_real_init ( (varHash == NULL) );
+
+    value = gep_eval_node (formula->root, varHash);
+
+    if (gnc_numeric_check (value))
+    {
+        if (error_loc_p != NULL)
+            *error_loc_p = formula->expression;
+
+        last_error = NUMERIC_ERROR;
+        return FALSE;
+    }
+
+    if (value_p)
+        *value_p = gnc_numeric_reduce (value);
+
+    if (error_loc_p != NULL)
+        *error_loc_p = NULL;
+
+    last_error = PARSER_NO_ERROR;
+    return TRUE;
+}
+
+const GNCExpFormula *
+gnc_exp_parser_lookup_formula (const char *expression)
+{
+    GNCExpFormula *formula;
+
+    if (expression == NULL)
+        return NULL;
+
+    if (compiled_formulas == NULL)
+        compiled_formulas = g_hash_table_new_full
+            (g_str_hash, g_str_equal, NULL,
+             (GDestroyNotify) gnc_exp_parser_formula_free);
+
+    formula = g_hash_table_lookup (compiled_formulas, expression);
+    if (formula == NULL)
+    {
+        formula = gnc_exp_parser_compile (expression, NULL);
+        if (formula == NULL)
+            return NULL;
+        g_hash_table_insert (compiled_formulas, formula->expression, formula);
+    }
+
+    return formula;
+}
+
 const char *
 gnc_exp_parser_error_string (void)
 {
@@ -85,6 +85,34 @@ gboolean gnc_exp_parser_parse_separate_vars (const char * expression,
         char **error_loc_p,
         GHashTable *varHash );
 
+/**
+ * An expression parsed once for repeated evaluation against different
+ * variable bindings, with its constant subexpressions folded.
+ * Expressions using assignments or functions are kept as text and
+ * interpreted on each evaluation.
+ **/
+typedef struct _GNCExpFormula GNCExpFormula;
+
+/* Compile the given expression. Returns NULL if it does not parse, in
+ * which case *error_loc_p is set as by gnc_exp_parser_parse. Free the
+ * result with gnc_exp_parser_formula_free. */
+GNCExpFormula * gnc_exp_parser_compile (const char *expression,
+                                        char **error_loc_p);
+
+void gnc_exp_parser_formula_free (GNCExpFormula *formula);
+
+/* Evaluate a compiled expression as gnc_exp_parser_parse_separate_vars
+ * would evaluate its text. */
+gboolean gnc_exp_parser_eval (const GNCExpFormula *formula,
+                              gnc_numeric *value_p,
+                              char **error_loc_p,
+                              GHashTable *varHash);
+
+/* Return the compiled form of expression from a cache owned by the
+ * parser, compiling it on first use. Returns NULL if the expression
+ * does not parse. The cache is dropped by gnc_exp_parser_shutdown. */
+const GNCExpFormula * gnc_exp_parser_lookup_formula (const char *expression);
+
 /* If the last parse returned FALSE, return an error string describing
  * the problem. Otherwise, return NULL. */
 const char * gnc_exp_parser_error_string (void);
@@ -41,6 +41,7 @@
 #include "Scrub.h"
 #include "Split.h"
 #include "Transaction.h"
+#include "TransLog.h"
 #include "gnc-commodity.h"
 #include "gnc-event.h"
 #include "gnc-exp-parser.h"
@@ -895,11 +896,20 @@ increment_sx_state(GncSxInstance *inst, GDate **last_occur_date, int *instance_c
     }
 }
 
+/* State shared by all the instances created in one effect_change run,
+ * so their account commits and events can be coalesced. */
+typedef struct _SxCreationBatch
+{
+    GHashTable *accounts;       /* Accounts held in an open edit */
+    GList *txns;                /* Transactions created, newest first */
+} SxCreationBatch;
+
 typedef struct _SxTxnCreationData
 {
     GncSxInstance *instance;
     GList **created_txn_guids;
     GList **creation_errors;
+    SxCreationBatch *batch;
 } SxTxnCreationData;
 
 static gboolean
@@ -966,14 +976,24 @@ _get_sx_formula_value(const SchedXaction* sx,
     if (formula_str != NULL && strlen(formula_str) != 0)
     {
         GHashTable *parser_vars = NULL;
+        const GNCExpFormula *formula;
+        gboolean parse_ok;
         if (variable_bindings)
         {
             parser_vars = gnc_sx_instance_get_variables_for_parser(variable_bindings);
         }
-        if (!gnc_exp_parser_parse_separate_vars(formula_str,
-                                                numeric,
-                                                &parseErrorLoc,
-                                                parser_vars))
+        /* The same template formulas are evaluated for every instance,
+         * so use the parser's compiled copy when there is one. */
+        formula = gnc_exp_parser_lookup_formula(formula_str);
+        if (formula != NULL)
+            parse_ok = gnc_exp_parser_eval(formula, numeric,
+                                           &parseErrorLoc, parser_vars);
+        else
+            parse_ok = gnc_exp_parser_parse_separate_vars(formula_str,
+                                                          numeric,
+                                                          &parseErrorLoc,
+                                                          parser_vars);
+        if (!parse_ok)
         {
             GString *err = g_string_new("");
             g_string_printf(err, "Error parsing SX [%s] key [%s]=formula [%s] at [%s]: %s",
@@ -1215,6 +1235,26 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
 
     xaccTransCommitEdit(new_txn);
 
+    if (creation_data->batch != NULL)
+    {
+        SxCreationBatch *batch = creation_data->batch;
+
+        /* Hold the accounts open from here on, so that later instances
+         * posting to them don't commit them again. */
+        for (txn_splits = xaccTransGetSplitList(new_txn);
+             txn_splits != NULL;
+             txn_splits = txn_splits->next)
+        {
+            Account *acct = xaccSplitGetAccount(txn_splits->data);
+            if (acct && !g_hash_table_lookup(batch->accounts, acct))
+            {
+                xaccAccountBeginEdit(acct);
+                g_hash_table_insert(batch->accounts, acct, acct);
+            }
+        }
+        batch->txns = g_list_prepend(batch->txns, new_txn);
+    }
+
     if (creation_data->created_txn_guids != NULL)
     {
         *creation_data->created_txn_guids
@@ -1226,7 +1266,7 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
 }
 
 static void
-create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_guids, GList **creation_errors)
+create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_guids, GList **creation_errors, SxCreationBatch *batch)
 {
     SxTxnCreationData creation_data;
     Account *sx_template_account;
@@ -1236,6 +1276,7 @@ create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_gu
     creation_data.instance = instance;
     creation_data.created_txn_guids = created_txn_guids;
     creation_data.creation_errors = creation_errors;
+    creation_data.batch = batch;
 
     xaccAccountForEachTransaction(sx_template_account,
                                   create_each_transaction_helper,
@@ -1248,7 +1289,8 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                                     GList **created_transaction_guids,
                                     GList **creation_errors)
 {
-    GList *iter;
+    GList *iter, *accounts, *changed_sxes = NULL;
+    SxCreationBatch batch;
 
     if (qof_book_is_readonly(gnc_get_current_book()))
     {
@@ -1256,6 +1298,13 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         return;
     }
 
+    /* Catching up many instances creates many transactions; hold the
+     * events and the account commits until they are all in. */
+    batch.accounts = g_hash_table_new(g_direct_hash, g_direct_equal);
+    batch.txns = NULL;
+    qof_event_suspend();
+    xaccLogBeginBatch();
+
     for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
     {
         GList *instance_iter;
@@ -1318,7 +1367,8 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                 case SX_INSTANCE_STATE_TO_CREATE:
                     create_transactions_for_instance (inst,
                                                       created_transaction_guids,
-                                                      &instance_errors);
+                                                      &instance_errors,
+                                                      &batch);
                     if (instance_errors == NULL)
                     {
                         increment_sx_state (inst, &last_occur_date,
@@ -1344,7 +1394,30 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         xaccSchedXactionSetLastOccurDate(instances->sx, last_occur_date);
         gnc_sx_set_instance_count(instances->sx, instance_count);
         xaccSchedXactionSetRemOccur(instances->sx, remain_occur_count);
+        changed_sxes = g_list_prepend(changed_sxes, instances->sx);
     }
+
+    accounts = g_hash_table_get_keys(batch.accounts);
+    for (iter = accounts; iter != NULL; iter = iter->next)
+        xaccAccountCommitEdit(iter->data);
+    xaccLogEndBatch();
+    qof_event_resume();
+
+    /* One event per new transaction, account and SX touched, instead
+     * of one for every split and edit along the way. */
+    batch.txns = g_list_reverse(batch.txns);
+    for (iter = batch.txns; iter != NULL; iter = iter->next)
+        qof_event_gen(QOF_INSTANCE(iter->data), QOF_EVENT_MODIFY, NULL);
+    for (iter = accounts; iter != NULL; iter = iter->next)
+        qof_event_gen(QOF_INSTANCE(iter->data), QOF_EVENT_MODIFY, NULL);
+    changed_sxes = g_list_reverse(changed_sxes);
+    for (iter = changed_sxes; iter != NULL; iter = iter->next)
+        qof_event_gen(QOF_INSTANCE(iter->data), QOF_EVENT_MODIFY, NULL);
+
+    g_list_free(changed_sxes);
+    g_list_free(accounts);
+    g_list_free(batch.txns);
+    g_hash_table_destroy(batch.accounts);
 }
 
 void
@@ -246,12 +246,76 @@ test_variable_expressions()
     success("variable found");
 }
 
+static void
+test_compiled_expressions (void)
+{
+    const char *exps[] =
+    {
+        "1 + 2 * 3",
+        "a * 2 + -a",
+        "a + -a",
+        "-(a + b) * c",
+        "(a)",
+        "--a + b",
+        "a * b - -(c / 2) + 7 - 3 * -b",
+        "a / (b - b)",
+        "1.5 * x",
+    };
+    gnc_numeric bindings[][3] =
+    {
+        { { 1, 1 }, { 2, 1 }, { 3, 1 } },
+        { { -45, 10 }, { 7, 1 }, { 1, 4 } },
+    };
+    const char *names[] = { "a", "b", "c" };
+    unsigned int i, j, k;
+
+    for (i = 0; i < G_N_ELEMENTS (exps); i++)
+    {
+        char *errLoc = NULL;
+        GNCExpFormula *formula = gnc_exp_parser_compile (exps[i], &errLoc);
+
+        do_test (formula != NULL, "compile");
+        for (j = 0; formula && j < G_N_ELEMENTS (bindings); j++)
+        {
+            GHashTable *vars = g_hash_table_new (g_str_hash, g_str_equal);
+            GHashTable *cvars = g_hash_table_new (g_str_hash, g_str_equal);
+            gnc_numeric num = gnc_numeric_zero (), cnum = gnc_numeric_zero ();
+            gboolean ok, cok;
+
+            for (k = 0; k < G_N_ELEMENTS (names); k++)
+            {
+                g_hash_table_insert (vars, (gpointer)names[k], &bindings[j][k]);
+                g_hash_table_insert (cvars, (gpointer)names[k], &bindings[j][k]);
+            }
+            ok = gnc_exp_parser_parse_separate_vars (exps[i], &num, &errLoc, vars);
+            cok = gnc_exp_parser_eval (formula, &cnum, &errLoc, cvars);
+            do_test (ok == cok, "compiled and parsed agree on success");
+            do_test (!ok || gnc_numeric_equal (num, cnum),
+                     "compiled and parsed agree on value");
+            do_test (g_hash_table_size (vars) == g_hash_table_size (cvars),
+                     "compiled and parsed find the same variables");
+            g_hash_table_destroy (vars);
+            g_hash_table_destroy (cvars);
+        }
+        gnc_exp_parser_formula_free (formula);
+    }
+
+    do_test (gnc_exp_parser_compile ("1 +", NULL) == NULL,
+             "bad expression does not compile");
+    do_test (gnc_exp_parser_lookup_formula ("2 * a") ==
+             gnc_exp_parser_lookup_formula ("2 * a"),
+             "compiled formulas are cached");
+    gnc_exp_parser_shutdown ();
+    success ("compiled expressions");
+}
+
 static void
 real_main (void *closure, int argc, char **argv)
 {
     /* set_should_print_success (TRUE); */
     test_parser();
     test_variable_expressions();
+    test_compiled_expressions();
     print_test_results();
     exit(get_rv());
 }
@@ -0,0 +1,181 @@
+/********************************************************************
+ * test-quickfill.c: GLib g_test test suite for QuickFill.c.        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <unittest-support.h>
+#include <qof.h>
+
+#include "../QuickFill.h"
+
+static const gchar *suitename = "/app-utils/QuickFill";
+void test_suite_quickfill (void);
+
+typedef struct
+{
+    QuickFill *qf;
+} Fixture;
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    fixture->qf = gnc_quickfill_new ();
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gnc_quickfill_destroy (fixture->qf);
+}
+
+static const char *
+match_string (QuickFill *qf, const char *str)
+{
+    return gnc_quickfill_string (gnc_quickfill_get_string_match (qf, str));
+}
+
+static void
+test_char_match (Fixture *fixture, gconstpointer pData)
+{
+    /* Not in key order, so the children are inserted all over the
+     * sorted array. */
+    const char *keys = "QWERTYUIOPASDFGHJKLZXCVBNM";
+    const char *c;
+
+    for (c = keys; *c; ++c)
+    {
+        gchar *text = g_strdup_printf ("%c item", *c);
+        gnc_quickfill_insert (fixture->qf, text, QUICKFILL_LIFO);
+        g_free (text);
+    }
+
+    for (c = keys; *c; ++c)
+    {
+        gchar *text = g_strdup_printf ("%c item", *c);
+        QuickFill *upper = gnc_quickfill_get_char_match (fixture->qf, *c);
+        QuickFill *lower = gnc_quickfill_get_char_match (fixture->qf,
+                                                         g_ascii_tolower (*c));
+        g_assert (upper != NULL);
+        g_assert (lower == upper);
+        g_assert_cmpstr (gnc_quickfill_string (upper), ==, text);
+        g_free (text);
+    }
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, '1') == NULL);
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, '@') == NULL);
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, '[') == NULL);
+
+    /* Matching ignores case beyond ASCII too. */
+    gnc_quickfill_insert (fixture->qf, "Caf\xc3\xa9", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (fixture->qf, "CAF\xc3\x89"), ==,
+                     "Caf\xc3\xa9");
+}
+
+static void
+test_prefix_match (Fixture *fixture, gconstpointer pData)
+{
+    QuickFill *qf;
+    int len;
+
+    gnc_quickfill_insert (fixture->qf, "The Book", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "The Movie", QUICKFILL_LIFO);
+
+    /* The latest string wins... */
+    g_assert_cmpstr (match_string (fixture->qf, "the "), ==, "The Movie");
+    g_assert_cmpstr (match_string (fixture->qf, "the b"), ==, "The Book");
+    g_assert (gnc_quickfill_get_string_match (fixture->qf, "the c") == NULL);
+    g_assert (gnc_quickfill_get_string_len_match (fixture->qf, "the book",
+                                                  100) != NULL);
+    g_assert_cmpstr (gnc_quickfill_string
+                     (gnc_quickfill_get_string_len_match (fixture->qf,
+                                                          "the mxyz", 5)),
+                     ==, "The Movie");
+
+    /* ...and the unique part ends where they differ. */
+    qf = gnc_quickfill_get_unique_len_match (fixture->qf, &len);
+    g_assert_cmpint (len, ==, 4);
+    g_assert_cmpstr (gnc_quickfill_string
+                     (gnc_quickfill_get_char_match (qf, 'b')),
+                     ==, "The Book");
+
+    /* ...except that a string doesn't displace its own prefix. */
+    gnc_quickfill_insert (fixture->qf, "Gas", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "Gas Station", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (fixture->qf, "gas"), ==, "Gas");
+    g_assert_cmpstr (match_string (fixture->qf, "gas s"), ==, "Gas Station");
+
+    /* Sorted alphabetically the first string wins, whatever the order
+     * they were added in. */
+    gnc_quickfill_insert (fixture->qf, "Apple Tree", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (fixture->qf, "Apple Pie", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (fixture->qf, "Apple Tart", QUICKFILL_ALPHA);
+    g_assert_cmpstr (match_string (fixture->qf, "apple "), ==, "Apple Pie");
+    g_assert_cmpstr (match_string (fixture->qf, "apple t"), ==, "Apple Tart");
+}
+
+static void
+test_remove (Fixture *fixture, gconstpointer pData)
+{
+    gnc_quickfill_insert (fixture->qf, "Rent", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "Gas", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "Gas Station", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "Groceries", QUICKFILL_LIFO);
+    gnc_quickfill_insert (fixture->qf, "Allowance", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (fixture->qf, "g"), ==, "Groceries");
+    g_assert_cmpstr (match_string (fixture->qf, "ga"), ==, "Gas");
+
+    /* The longer string takes over the nodes of the one removed. */
+    gnc_quickfill_remove (fixture->qf, "Gas", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (fixture->qf, "g"), ==, "Groceries");
+    g_assert_cmpstr (match_string (fixture->qf, "ga"), ==, "Gas Station");
+    g_assert_cmpstr (match_string (fixture->qf, "gas"), ==, "Gas Station");
+
+    /* Removing the last string under a node removes the node. */
+    gnc_quickfill_remove (fixture->qf, "Gas Station", QUICKFILL_LIFO);
+    g_assert (gnc_quickfill_get_string_match (fixture->qf, "ga") == NULL);
+    g_assert_cmpstr (match_string (fixture->qf, "gr"), ==, "Groceries");
+
+    /* Removing a child from the middle of the array keeps the others
+     * on either side of it. */
+    gnc_quickfill_remove (fixture->qf, "Groceries", QUICKFILL_LIFO);
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, 'g') == NULL);
+    g_assert_cmpstr (match_string (fixture->qf, "a"), ==, "Allowance");
+    g_assert_cmpstr (match_string (fixture->qf, "r"), ==, "Rent");
+
+    /* Strings that aren't there are ignored. */
+    gnc_quickfill_remove (fixture->qf, "Rental", QUICKFILL_LIFO);
+    gnc_quickfill_remove (fixture->qf, "Bills", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (fixture->qf, "rent"), ==, "Rent");
+
+    gnc_quickfill_remove (fixture->qf, "Rent", QUICKFILL_LIFO);
+    gnc_quickfill_remove (fixture->qf, "Allowance", QUICKFILL_LIFO);
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, 'a') == NULL);
+    g_assert (gnc_quickfill_get_char_match (fixture->qf, 'r') == NULL);
+}
+
+void
+test_suite_quickfill (void)
+{
+    GNC_TEST_ADD (suitename, "char match", Fixture, NULL, setup, test_char_match, teardown);
+    GNC_TEST_ADD (suitename, "prefix match", Fixture, NULL, setup, test_prefix_match, teardown);
+    GNC_TEST_ADD (suitename, "remove", Fixture, NULL, setup, test_remove, teardown);
+}
@@ -213,6 +213,31 @@ test_state_changes()
     remove_sx(foo);
 }
 
+static void
+test_schedule_change()
+{
+    GDate start, end;
+    SchedXaction *sx;
+    Recurrence *r;
+
+    g_date_clear(&start, 1);
+    gnc_gdate_set_today (&start);
+    end = start;
+    g_date_add_days(&end, 13);
+
+    sx = add_daily_sx("daily", &start, NULL, NULL);
+    do_test(gnc_sx_get_num_occur_daterange(sx, &start, &end) == 14, "14 daily occurrences");
+    /* Asking again is answered from the remembered occurrences. */
+    do_test(gnc_sx_get_num_occur_daterange(sx, &start, &end) == 14, "14 daily occurrences again");
+
+    r = g_new0(Recurrence, 1);
+    recurrenceSet(r, 1, PERIOD_WEEK, &start, WEEKEND_ADJ_NONE);
+    gnc_sx_set_schedule(sx, g_list_append(NULL, r));
+    do_test(gnc_sx_get_num_occur_daterange(sx, &start, &end) == 2, "2 weekly occurrences after schedule change");
+
+    remove_sx(sx);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -228,6 +253,7 @@ main(int argc, char **argv)
     }
     test_basic();
     test_state_changes();
+    test_schedule_change();
 
     print_test_results();
     exit(get_rv());
@@ -117,6 +117,9 @@ typedef struct
     // be used to prevent infinite loops.
     gboolean retry;         // Signals the calling function that it should retry (the error handler detected
     // transient error and managed to resolve it, but it can't run the original query)
+    guint sql_savepoint;    // Depth of open transactions; those inside the outermost are savepoints
+    gboolean transaction_lost; // The server ended the open transactions when the connection was lost
+    gint64 last_activity;   // Monotonic time the connection was last verified, to detect idle drops
 
 } GncDbiSqlConnection;
 
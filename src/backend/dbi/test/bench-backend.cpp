@@ -0,0 +1,252 @@
+/********************************************************************
+ * bench-backend.cpp: Times loading and saving a synthetic book in  *
+ *                    each storage format.                          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* The book is generated once and then stored in each format in turn:
+ * uncompressed and gzipped XML, sqlite3 and, when the build was
+ * configured with test URLs for them, MySQL and PostgreSQL.  For each
+ * one the phases are
+ *
+ *   sync_all: writing the whole book to a new file or database,
+ *   load:     reading it back into a new session,
+ *   commit:   changing one transaction and committing it,
+ *   commits:  doing that for --commits different transactions.
+ *
+ * The XML backend only writes on save, so there the commit phases
+ * include the save that the autosave would do after them: one per
+ * commit for "commit" and one at the end for "commits". */
+
+extern "C"
+{
+#include "config.h"
+#include <string.h>
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-prefs.h"
+#include <test-stuff.h>
+#include <test-engine-stuff.h>
+}
+#include "bench-stuff.h"
+
+static gint num_accounts = 100;
+static gint num_transactions = 20000;
+static gint num_prices = 2000;
+static gint num_commits = 100;
+static gint seed = 42;
+static gchar *output_file = NULL;
+
+static GOptionEntry options[] =
+{
+    { "accounts", 'a', 0, G_OPTION_ARG_INT, &num_accounts,
+      "Number of accounts in the book", "N" },
+    { "transactions", 't', 0, G_OPTION_ARG_INT, &num_transactions,
+      "Number of transactions in the book", "N" },
+    { "prices", 'p', 0, G_OPTION_ARG_INT, &num_prices,
+      "Number of prices in the book", "N" },
+    { "commits", 'c', 0, G_OPTION_ARG_INT, &num_commits,
+      "Number of transactions to change in the commits phase", "N" },
+    { "seed", 's', 0, G_OPTION_ARG_INT, &seed,
+      "Seed for the book generator", "N" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file,
+      "Write the results to this file instead of stdout", "FILE" },
+    { NULL }
+};
+
+static void
+collect_trans (QofInstance *inst, gpointer data)
+{
+    g_ptr_array_add (static_cast<GPtrArray*>(data), inst);
+}
+
+static void
+change_trans (Transaction *trans, gint n)
+{
+    gchar *desc = g_strdup_printf ("Benchmark change %d", n);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, desc);
+    xaccTransCommitEdit (trans);
+    g_free (desc);
+}
+
+static gchar *
+phase_name (const char *store, const char *phase)
+{
+    return g_strconcat (store, "_", phase, NULL);
+}
+
+static gboolean
+session_ok (QofSession *session, const char *url, const char *store)
+{
+    if (qof_session_get_error (session) == ERR_BACKEND_NO_ERR)
+        return TRUE;
+    g_warning ("Can't use %s, skipping %s: %s", url, store,
+               qof_session_get_error_message (session));
+    return FALSE;
+}
+
+static void
+bench_store (Bench *bench, QofSession *session, const char *store,
+             const char *url, gboolean save_commits)
+{
+    QofSession *io_session = qof_session_new ();
+    GPtrArray *trans;
+    gchar *name;
+    gint i;
+
+    qof_session_begin (io_session, url, FALSE, TRUE, TRUE);
+    if (!session_ok (io_session, url, store))
+    {
+        qof_session_destroy (io_session);
+        return;
+    }
+    qof_session_swap_data (session, io_session);
+    name = phase_name (store, "sync_all");
+    bench_start (bench);
+    qof_session_save (io_session, NULL);
+    bench_stop (bench, name, 1);
+    g_free (name);
+    qof_session_swap_data (session, io_session);
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+
+    io_session = qof_session_new ();
+    qof_session_begin (io_session, url, FALSE, FALSE, FALSE);
+    if (!session_ok (io_session, url, store))
+    {
+        qof_session_destroy (io_session);
+        return;
+    }
+    name = phase_name (store, "load");
+    bench_start (bench);
+    qof_session_load (io_session, NULL);
+    bench_stop (bench, name, 1);
+    g_free (name);
+
+    trans = g_ptr_array_new ();
+    qof_collection_foreach (qof_book_get_collection (qof_session_get_book (io_session),
+                                                     GNC_ID_TRANS),
+                            collect_trans, trans);
+    if (trans->len > 0)
+    {
+        name = phase_name (store, "commit");
+        bench_start (bench);
+        change_trans (static_cast<Transaction*>(g_ptr_array_index (trans, 0)), 0);
+        if (save_commits)
+            qof_session_save (io_session, NULL);
+        bench_stop (bench, name, 1);
+        g_free (name);
+
+        name = phase_name (store, "commits");
+        bench_start (bench);
+        for (i = 1; i <= num_commits; ++i)
+            change_trans (static_cast<Transaction*>(g_ptr_array_index (trans, i % trans->len)), i);
+        if (save_commits)
+            qof_session_save (io_session, NULL);
+        bench_stop (bench, name, num_commits);
+        g_free (name);
+    }
+    g_ptr_array_free (trans, TRUE);
+
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+}
+
+int
+main (int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error = NULL;
+    QofSession *session;
+    QofBook *book;
+    Bench *bench;
+    gchar *tmpdir, *url;
+    gboolean ok;
+
+    context = g_option_context_new ("- time the storage backends");
+    g_option_context_add_main_entries (context, options, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+        g_printerr ("%s\n", error->message);
+        g_error_free (error);
+        return 1;
+    }
+    g_option_context_free (context);
+
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    cashobjects_register ();
+    if (!qof_load_backend_library ("../.libs/", "gncmod-backend-dbi"))
+        g_warning ("Can't load the dbi backend, skipping the sql runs");
+    if (!qof_load_backend_library ("../../xml/.libs", "gncmod-backend-xml"))
+        g_warning ("Can't load the xml backend, skipping the xml runs");
+    xaccLogDisable ();
+
+    bench_seed (seed);
+    bench = bench_new ("backend");
+    bench_add_int (bench, "seed", seed);
+    bench_add_int (bench, "accounts", num_accounts);
+    bench_add_int (bench, "transactions", num_transactions);
+    bench_add_int (bench, "prices", num_prices);
+    bench_add_int (bench, "commits", num_commits);
+
+    session = qof_session_new ();
+    book = qof_session_get_book (session);
+    bench_add_accounts (book, MAX (num_accounts, 2));
+    bench_free_prices (bench_add_prices (book, num_prices));
+    add_random_transactions_to_book (book, num_transactions);
+
+    tmpdir = bench_make_tmpdir ();
+    if (tmpdir)
+    {
+        gnc_prefs_set_file_save_compressed (FALSE);
+        url = g_strconcat ("xml://", tmpdir, "/bench.gnucash", NULL);
+        bench_store (bench, session, "xml", url, TRUE);
+        g_free (url);
+
+        gnc_prefs_set_file_save_compressed (TRUE);
+        url = g_strconcat ("xml://", tmpdir, "/bench-gz.gnucash", NULL);
+        bench_store (bench, session, "xml_gz", url, TRUE);
+        g_free (url);
+
+        url = g_strconcat ("sqlite3://", tmpdir, "/bench.sqlite3", NULL);
+        bench_store (bench, session, "sqlite3", url, FALSE);
+        g_free (url);
+
+        bench_remove_dir (tmpdir);
+        g_free (tmpdir);
+    }
+    if (strlen (TEST_MYSQL_URL) > 0)
+        bench_store (bench, session, "mysql", TEST_MYSQL_URL, FALSE);
+    if (strlen (TEST_PGSQL_URL) > 0)
+    {
+        g_setenv ("PGOPTIONS", "-c client_min_messages=WARNING", FALSE);
+        bench_store (bench, session, "pgsql", TEST_PGSQL_URL, FALSE);
+    }
+
+    ok = bench_finish (bench, output_file);
+    qof_session_end (session);
+    qof_session_destroy (session);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+/********************************************************************
+ * bench-engine.cpp: Times the engine and the file backends on a    *
+ *                   synthetic book.                                *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* The book is built with the test-engine-stuff generators from a fixed
+ * seed, so two runs with the same options time the same data.  Each
+ * operation is timed once over the whole book and reported with the
+ * number of times it was done; the results are written as a single JSON
+ * object so that runs can be compared across releases. */
+
+extern "C"
+{
+#include "config.h"
+#include <stdlib.h>
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Query.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+#include <test-stuff.h>
+#include <test-engine-stuff.h>
+}
+#include "bench-stuff.h"
+
+static gint num_accounts = 100;
+static gint num_transactions = 10000;
+static gint num_prices = 1000;
+static gint num_lookups = 10000;
+static gint seed = 42;
+static gchar *output_file = NULL;
+
+static GOptionEntry options[] =
+{
+    { "accounts", 'a', 0, G_OPTION_ARG_INT, &num_accounts,
+      "Number of accounts in the book", "N" },
+    { "transactions", 't', 0, G_OPTION_ARG_INT, &num_transactions,
+      "Number of transactions in the book", "N" },
+    { "prices", 'p', 0, G_OPTION_ARG_INT, &num_prices,
+      "Number of prices in the book", "N" },
+    { "lookups", 'l', 0, G_OPTION_ARG_INT, &num_lookups,
+      "Number of balance, query and price lookups to time", "N" },
+    { "seed", 's', 0, G_OPTION_ARG_INT, &seed,
+      "Seed for the book generator", "N" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file,
+      "Write the results to this file instead of stdout", "FILE" },
+    { NULL }
+};
+
+static time64
+random_time (time64 first, time64 last)
+{
+    return first + (time64)((last - first) * (rand () / (RAND_MAX + 1.0)));
+}
+
+static void
+bench_session_io (Bench *bench, QofSession *session, const char *url,
+                  const char *name)
+{
+    QofSession *io_session = qof_session_new ();
+    gchar *save_name = g_strconcat (name, "_save", NULL);
+    gchar *load_name = g_strconcat (name, "_load", NULL);
+
+    qof_session_begin (io_session, url, FALSE, TRUE, TRUE);
+    if (qof_session_get_error (io_session) != ERR_BACKEND_NO_ERR)
+    {
+        g_warning ("Can't open %s, skipping %s: %s", url, name,
+                   qof_session_get_error_message (io_session));
+        qof_session_destroy (io_session);
+        g_free (save_name);
+        g_free (load_name);
+        return;
+    }
+    qof_session_swap_data (session, io_session);
+    bench_start (bench);
+    qof_session_save (io_session, NULL);
+    bench_stop (bench, save_name, 1);
+    qof_session_swap_data (session, io_session);
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+
+    io_session = qof_session_new ();
+    qof_session_begin (io_session, url, TRUE, FALSE, FALSE);
+    bench_start (bench);
+    qof_session_load (io_session, NULL);
+    bench_stop (bench, load_name, 1);
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+
+    g_free (save_name);
+    g_free (load_name);
+}
+
+int
+main (int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error = NULL;
+    QofSession *session;
+    QofBook *book;
+    Account *root;
+    GList *accounts, *node;
+    GPtrArray *prices;
+    QofQuery *query;
+    Bench *bench;
+    time64 first = G_MAXINT64, last = G_MININT64;
+    gint num_account_list, i;
+    gchar *tmpdir, *url;
+    gboolean ok;
+
+    context = g_option_context_new ("- time engine operations");
+    g_option_context_add_main_entries (context, options, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+        g_printerr ("%s\n", error->message);
+        g_error_free (error);
+        return 1;
+    }
+    g_option_context_free (context);
+
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    cashobjects_register ();
+    if (!qof_load_backend_library ("../.libs/", "gncmod-backend-dbi"))
+        g_warning ("Can't load the dbi backend, skipping the sqlite3 runs");
+    if (!qof_load_backend_library ("../../xml/.libs", "gncmod-backend-xml"))
+        g_warning ("Can't load the xml backend, skipping the xml runs");
+    xaccLogDisable ();
+
+    bench_seed (seed);
+    bench = bench_new ("engine");
+    bench_add_int (bench, "seed", seed);
+    bench_add_int (bench, "accounts", num_accounts);
+    bench_add_int (bench, "transactions", num_transactions);
+    bench_add_int (bench, "prices", num_prices);
+
+    session = qof_session_new ();
+    book = qof_session_get_book (session);
+    bench_add_accounts (book, MAX (num_accounts, 2));
+    root = gnc_book_get_root_account (book);
+
+    bench_start (bench);
+    prices = bench_add_prices (book, num_prices);
+    bench_stop (bench, "price_insert", prices->len);
+
+    /* Every split goes through xaccSplitSetAccount and the account's
+     * sorted insert when its transaction is committed. */
+    bench_start (bench);
+    add_random_transactions_to_book (book, num_transactions);
+    bench_stop (bench, "transaction_insert", num_transactions);
+
+    accounts = gnc_account_get_descendants (root);
+    num_account_list = g_list_length (accounts);
+    for (node = accounts; node; node = node->next)
+    {
+        GList *splits = xaccAccountGetSplitList (static_cast<Account*>(node->data));
+        if (splits)
+        {
+            Split *head = static_cast<Split*>(splits->data);
+            Split *tail = static_cast<Split*>(g_list_last (splits)->data);
+            first = MIN (first, xaccTransGetDate (xaccSplitGetParent (head)));
+            last = MAX (last, xaccTransGetDate (xaccSplitGetParent (tail)));
+        }
+    }
+    if (first > last)
+        first = last = gnc_time (NULL);
+
+    bench_start (bench);
+    for (node = accounts; node; node = node->next)
+        xaccAccountSortSplits (static_cast<Account*>(node->data), TRUE);
+    bench_stop (bench, "split_sort", num_account_list);
+
+    bench_start (bench);
+    for (node = accounts; node; node = node->next)
+        xaccAccountRecomputeBalance (static_cast<Account*>(node->data));
+    bench_stop (bench, "balance_recompute", num_account_list);
+
+    bench_start (bench);
+    node = accounts;
+    for (i = 0; i < num_lookups; ++i)
+    {
+        xaccAccountGetBalanceAsOfDate (static_cast<Account*>(node->data),
+                                       random_time (first, last));
+        node = node->next ? node->next : accounts;
+    }
+    bench_stop (bench, "balance_as_of_date", num_lookups);
+
+    bench_start (bench);
+    for (i = 0; i < num_lookups / 100; ++i)
+    {
+        time64 start = random_time (first, last);
+
+        query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book);
+        xaccQueryAddDateMatchTT (query, TRUE, start, TRUE,
+                                 random_time (start, last), QOF_QUERY_AND);
+        qof_query_run (query);
+        qof_query_destroy (query);
+    }
+    bench_stop (bench, "query_run", num_lookups / 100);
+
+    bench_start (bench);
+    for (i = 0; prices->len && i < num_lookups; ++i)
+    {
+        GNCPrice *p = static_cast<GNCPrice*>(g_ptr_array_index (prices, i % prices->len));
+        Timespec ts = {random_time (first, last), 0};
+        GNCPrice *found = gnc_pricedb_lookup_nearest_in_time (gnc_pricedb_get_db (book),
+                                                              gnc_price_get_commodity (p),
+                                                              gnc_price_get_currency (p),
+                                                              ts);
+        if (found)
+            gnc_price_unref (found);
+    }
+    bench_stop (bench, "price_lookup", prices->len ? num_lookups : 0);
+    g_list_free (accounts);
+
+    tmpdir = bench_make_tmpdir ();
+    if (tmpdir)
+    {
+        url = g_strconcat ("xml://", tmpdir, "/bench.gnucash", NULL);
+        bench_session_io (bench, session, url, "xml");
+        g_free (url);
+        url = g_strconcat ("sqlite3://", tmpdir, "/bench.sqlite3", NULL);
+        bench_session_io (bench, session, url, "sqlite3");
+        g_free (url);
+        bench_remove_dir (tmpdir);
+        g_free (tmpdir);
+    }
+    bench_free_prices (prices);
+
+    ok = bench_finish (bench, output_file);
+    qof_session_end (session);
+    qof_session_destroy (session);
+    return ok ? 0 : 1;
+}
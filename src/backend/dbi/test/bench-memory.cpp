@@ -0,0 +1,170 @@
+/********************************************************************
+ * bench-memory.cpp: Reports where the memory of a synthetic book   *
+ *                   goes as it is built and loaded.                *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* The book is built from a fixed seed in three phases, accounts,
+ * prices and transactions, and gnc_book_get_memory_usage() is reported
+ * after each of them.  The book is then written to a sqlite3 file and
+ * loaded into a new session, which is reported as "sqlite3_load", so
+ * that the book a backend builds can be compared with the generated
+ * one.  Each report ends with its total and the process' resident set
+ * size; the gap between them is what the accounting doesn't see. */
+
+extern "C"
+{
+#include "config.h"
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "gnc-engine.h"
+#include "TransLog.h"
+#include <test-stuff.h>
+#include <test-engine-stuff.h>
+}
+#include "bench-stuff.h"
+
+static gint num_accounts = 100;
+static gint num_transactions = 20000;
+static gint num_prices = 2000;
+static gint seed = 42;
+static gchar *output_file = NULL;
+
+static GOptionEntry options[] =
+{
+    { "accounts", 'a', 0, G_OPTION_ARG_INT, &num_accounts,
+      "Number of accounts in the book", "N" },
+    { "transactions", 't', 0, G_OPTION_ARG_INT, &num_transactions,
+      "Number of transactions in the book", "N" },
+    { "prices", 'p', 0, G_OPTION_ARG_INT, &num_prices,
+      "Number of prices in the book", "N" },
+    { "seed", 's', 0, G_OPTION_ARG_INT, &seed,
+      "Seed for the book generator", "N" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file,
+      "Write the results to this file instead of stdout", "FILE" },
+    { NULL }
+};
+
+static void
+report_memory (Bench *bench, QofBook *book, const char *phase)
+{
+    GList *usage = gnc_book_get_memory_usage (book);
+
+    bench_add_memory_usage (bench, phase, usage);
+    qof_memory_usage_free (usage);
+}
+
+static void
+bench_load (Bench *bench, QofSession *session, const char *url)
+{
+    QofSession *io_session = qof_session_new ();
+
+    qof_session_begin (io_session, url, FALSE, TRUE, TRUE);
+    if (qof_session_get_error (io_session) != ERR_BACKEND_NO_ERR)
+    {
+        g_warning ("Can't use %s, skipping the load: %s", url,
+                   qof_session_get_error_message (io_session));
+        qof_session_destroy (io_session);
+        return;
+    }
+    qof_session_swap_data (session, io_session);
+    qof_session_save (io_session, NULL);
+    qof_session_swap_data (session, io_session);
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+
+    io_session = qof_session_new ();
+    qof_session_begin (io_session, url, FALSE, FALSE, FALSE);
+    bench_start (bench);
+    qof_session_load (io_session, NULL);
+    bench_stop (bench, "sqlite3_load", 1);
+    report_memory (bench, qof_session_get_book (io_session), "sqlite3_load");
+    qof_session_end (io_session);
+    qof_session_destroy (io_session);
+}
+
+int
+main (int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error = NULL;
+    QofSession *session;
+    QofBook *book;
+    Bench *bench;
+    gchar *tmpdir;
+    gboolean ok;
+
+    context = g_option_context_new ("- report the memory a book takes");
+    g_option_context_add_main_entries (context, options, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+        g_printerr ("%s\n", error->message);
+        g_error_free (error);
+        return 1;
+    }
+    g_option_context_free (context);
+
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    cashobjects_register ();
+    if (!qof_load_backend_library ("../.libs/", "gncmod-backend-dbi"))
+        g_warning ("Can't load the dbi backend, skipping the load");
+    xaccLogDisable ();
+
+    bench_seed (seed);
+    bench = bench_new ("memory");
+    bench_add_int (bench, "seed", seed);
+    bench_add_int (bench, "accounts", num_accounts);
+    bench_add_int (bench, "transactions", num_transactions);
+    bench_add_int (bench, "prices", num_prices);
+
+    session = qof_session_new ();
+    book = qof_session_get_book (session);
+
+    bench_start (bench);
+    bench_add_accounts (book, MAX (num_accounts, 2));
+    bench_stop (bench, "accounts", num_accounts);
+    report_memory (bench, book, "accounts");
+
+    bench_start (bench);
+    bench_free_prices (bench_add_prices (book, num_prices));
+    bench_stop (bench, "prices", num_prices);
+    report_memory (bench, book, "prices");
+
+    bench_start (bench);
+    add_random_transactions_to_book (book, num_transactions);
+    bench_stop (bench, "transactions", num_transactions);
+    report_memory (bench, book, "transactions");
+
+    tmpdir = bench_make_tmpdir ();
+    if (tmpdir)
+    {
+        gchar *url = g_strconcat ("sqlite3://", tmpdir, "/bench.sqlite3", NULL);
+        bench_load (bench, session, url);
+        g_free (url);
+        bench_remove_dir (tmpdir);
+        g_free (tmpdir);
+    }
+
+    ok = bench_finish (bench, output_file);
+    qof_session_end (session);
+    qof_session_destroy (session);
+    return ok ? 0 : 1;
+}
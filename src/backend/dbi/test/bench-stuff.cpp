@@ -0,0 +1,286 @@
+/********************************************************************
+ * bench-stuff.cpp: Synthetic books and JSON timings for the        *
+ *                  benchmark programs.                             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#ifndef G_OS_WIN32
+#include <sys/resource.h>
+#endif
+#include "qof.h"
+#include "gnc-pricedb.h"
+#include <test-stuff.h>
+#include <test-engine-stuff.h>
+}
+#include "bench-stuff.h"
+
+/* Returns the number following key in one of the /proc/self files, or
+ * -1 if there is no such file or key. */
+static gint64
+proc_self_value (const char *file, const char *key)
+{
+    gchar *contents, *line;
+    gint64 value = -1;
+
+    if (!g_file_get_contents (file, &contents, NULL, NULL))
+        return -1;
+    line = strstr (contents, key);
+    if (line && (line == contents || line[-1] == '\n'))
+        value = g_ascii_strtoll (line + strlen (key), NULL, 10);
+    g_free (contents);
+    return value;
+}
+
+static gint64
+peak_rss_kb (void)
+{
+    gint64 peak = proc_self_value ("/proc/self/status", "VmHWM:");
+#ifndef G_OS_WIN32
+    if (peak < 0)
+    {
+        struct rusage usage;
+        if (getrusage (RUSAGE_SELF, &usage) == 0)
+#ifdef __APPLE__
+            peak = usage.ru_maxrss / 1024;
+#else
+            peak = usage.ru_maxrss;
+#endif
+    }
+#endif
+    return peak;
+}
+
+Bench *
+bench_new (const char *benchmark)
+{
+    Bench *bench = g_new0 (Bench, 1);
+
+    bench->header = g_string_new (NULL);
+    bench->results = g_string_new (NULL);
+    bench->memory = g_string_new (NULL);
+    bench_add_string (bench, "benchmark", benchmark);
+    bench_add_string (bench, "version", VERSION);
+    return bench;
+}
+
+void
+bench_add_int (Bench *bench, const char *key, gint64 value)
+{
+    g_string_append_printf (bench->header, "  \"%s\": %" G_GINT64_FORMAT ",\n",
+                            key, value);
+}
+
+void
+bench_add_string (Bench *bench, const char *key, const char *value)
+{
+    gchar *escaped = g_strescape (value, NULL);
+
+    g_string_append_printf (bench->header, "  \"%s\": \"%s\",\n",
+                            key, escaped);
+    g_free (escaped);
+}
+
+void
+bench_start (Bench *bench)
+{
+    /* Writing 5 to clear_refs resets VmHWM on Linux, so that the peak
+     * is the phase's own rather than the process'. */
+    FILE *clear_refs = fopen ("/proc/self/clear_refs", "w");
+
+    if (clear_refs)
+    {
+        fputs ("5", clear_refs);
+        fclose (clear_refs);
+    }
+    bench->start_written = proc_self_value ("/proc/self/io", "wchar:");
+    bench->start = g_get_monotonic_time ();
+}
+
+void
+bench_stop (Bench *bench, const char *name, gint count)
+{
+    gdouble seconds = (g_get_monotonic_time () - bench->start) / 1e6;
+    gint64 written = proc_self_value ("/proc/self/io", "wchar:");
+
+    if (written >= 0 && bench->start_written >= 0)
+        written -= bench->start_written;
+    else
+        written = -1;
+    g_string_append_printf (bench->results,
+                            "%s\n    { \"name\": \"%s\", \"count\": %d, "
+                            "\"seconds\": %.6f, \"peak_rss_kb\": %"
+                            G_GINT64_FORMAT ", \"bytes_written\": %"
+                            G_GINT64_FORMAT " }",
+                            bench->results->len ? "," : "",
+                            name, count, seconds, peak_rss_kb (), written);
+}
+
+static void
+append_memory_row (Bench *bench, const char *phase, const char *category,
+                   gint64 count, gint64 bytes)
+{
+    gchar *escaped = g_strescape (category, NULL);
+
+    g_string_append_printf (bench->memory,
+                            "%s\n    { \"phase\": \"%s\", \"category\": \"%s\", "
+                            "\"count\": %" G_GINT64_FORMAT ", \"bytes\": %"
+                            G_GINT64_FORMAT " }",
+                            bench->memory->len ? "," : "",
+                            phase, escaped, count, bytes);
+    g_free (escaped);
+}
+
+void
+bench_add_memory_usage (Bench *bench, const char *phase, GList *usage)
+{
+    gint64 total = 0, rss;
+    GList *node;
+
+    for (node = usage; node; node = node->next)
+    {
+        QofMemoryUsage *mu = static_cast<QofMemoryUsage*>(node->data);
+        append_memory_row (bench, phase, mu->category, mu->count, mu->bytes);
+        total += mu->bytes;
+    }
+    append_memory_row (bench, phase, "total", g_list_length (usage), total);
+    /* What the accounting misses shows up as the difference. */
+    rss = proc_self_value ("/proc/self/status", "VmRSS:");
+    append_memory_row (bench, phase, "rss", 1, rss < 0 ? -1 : rss * 1024);
+}
+
+gboolean
+bench_finish (Bench *bench, const char *filename)
+{
+    GError *error = NULL;
+    gchar *memory = bench->memory->len ?
+        g_strdup_printf (",\n  \"memory\": [%s\n  ]", bench->memory->str) :
+        g_strdup ("");
+    gchar *json = g_strdup_printf ("{\n%s  \"results\": [%s\n  ]%s\n}\n",
+                                   bench->header->str, bench->results->str,
+                                   memory);
+    gboolean ok = TRUE;
+
+    if (!filename)
+        fputs (json, stdout);
+    else if (!g_file_set_contents (filename, json, -1, &error))
+    {
+        g_printerr ("%s\n", error->message);
+        g_error_free (error);
+        ok = FALSE;
+    }
+    g_free (json);
+    g_free (memory);
+    g_string_free (bench->header, TRUE);
+    g_string_free (bench->results, TRUE);
+    g_string_free (bench->memory, TRUE);
+    g_free (bench);
+    return ok;
+}
+
+void
+bench_seed (gint seed)
+{
+    srand (seed);
+    /* Keep the generated kvp slots from dominating the book. */
+    set_max_kvp_depth (1);
+    set_max_kvp_frame_elements (2);
+}
+
+void
+bench_add_accounts (QofBook *book, gint count)
+{
+    while (count-- > 0)
+        get_random_account (book);
+}
+
+GPtrArray *
+bench_add_prices (QofBook *book, gint count)
+{
+    GNCPriceDB *pdb = gnc_pricedb_get_db (book);
+    GPtrArray *prices = g_ptr_array_new ();
+    gint tries = count * 2;
+
+    while (count > 0 && tries-- > 0)
+    {
+        GNCPrice *p = get_random_price (book);
+
+        /* A price on the same day as another one replaces it. */
+        if (gnc_pricedb_add_price (pdb, p))
+        {
+            g_ptr_array_add (prices, p);
+            --count;
+        }
+        else
+            gnc_price_unref (p);
+    }
+    return prices;
+}
+
+void
+bench_free_prices (GPtrArray *prices)
+{
+    guint i;
+
+    for (i = 0; i < prices->len; ++i)
+        gnc_price_unref (static_cast<GNCPrice*>(g_ptr_array_index (prices, i)));
+    g_ptr_array_free (prices, TRUE);
+}
+
+gchar *
+bench_make_tmpdir (void)
+{
+    gchar *name = g_strdup_printf ("gnc-bench-%d", (int)getpid ());
+    gchar *dirname = g_build_filename (g_get_tmp_dir (), name, NULL);
+
+    g_free (name);
+    if (g_mkdir (dirname, 0700) != 0)
+    {
+        g_warning ("Can't create %s, skipping the file runs", dirname);
+        g_free (dirname);
+        return NULL;
+    }
+    return dirname;
+}
+
+void
+bench_remove_dir (const gchar *dirname)
+{
+    GDir *dir = g_dir_open (dirname, 0, NULL);
+    const gchar *entry;
+
+    if (!dir)
+        return;
+    while ((entry = g_dir_read_name (dir)) != NULL)
+    {
+        gchar *path = g_build_filename (dirname, entry, NULL);
+        g_unlink (path);
+        g_free (path);
+    }
+    g_dir_close (dir);
+    g_rmdir (dirname);
+}
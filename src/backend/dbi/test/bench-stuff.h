@@ -0,0 +1,71 @@
+/********************************************************************
+ * bench-stuff.h: Synthetic books and JSON timings for the          *
+ *                benchmark programs.                               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef _BENCH_STUFF_H_
+#define _BENCH_STUFF_H_
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <glib.h>
+#include "qof.h"
+
+/* Collects the results of one benchmark run.  Every phase between
+ * bench_start() and bench_stop() is reported with its wall time, the
+ * process' peak resident set size during it and the bytes it wrote;
+ * the last two are -1 where the platform can't tell.  The memory
+ * usage reports are kept apart from the phases. */
+typedef struct
+{
+    GString *header;
+    GString *results;
+    GString *memory;
+    gint64 start;
+    gint64 start_written;
+} Bench;
+
+Bench *bench_new (const char *benchmark);
+void bench_add_int (Bench *bench, const char *key, gint64 value);
+void bench_add_string (Bench *bench, const char *key, const char *value);
+void bench_start (Bench *bench);
+void bench_stop (Bench *bench, const char *name, gint count);
+/* Reports a list of QofMemoryUsage, as taken after phase, with its
+ * total and the process' resident set size at the time. */
+void bench_add_memory_usage (Bench *bench, const char *phase, GList *usage);
+/* Writes the results to filename, or stdout if it is NULL, and frees
+ * the bench. */
+gboolean bench_finish (Bench *bench, const char *filename);
+
+/* Seeds the generators and keeps their random kvp slots small. */
+void bench_seed (gint seed);
+void bench_add_accounts (QofBook *book, gint count);
+/* Returns the added prices, each with a reference the caller owns. */
+GPtrArray *bench_add_prices (QofBook *book, gint count);
+void bench_free_prices (GPtrArray *prices);
+
+/* A new, empty directory for the file backends, and its removal. */
+gchar *bench_make_tmpdir (void);
+void bench_remove_dir (const gchar *dirname);
+#ifdef __cplusplus
+}
+#endif
+#endif /* _BENCH_STUFF_H_ */
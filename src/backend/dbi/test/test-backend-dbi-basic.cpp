@@ -45,6 +45,7 @@ extern "C"
 #include <TransLog.h>
 #include "Transaction.h"
 #include "Split.h"
+#include "Query.h"
 #include "gnc-commodity.h"
 #include "gncAddress.h"
 #include "gncCustomer.h"
@@ -52,11 +53,14 @@ extern "C"
 /* For version_control */
 #include <gnc-prefs.h>
 #include <qofsession-p.h>
+/* For change_log */
+#include <gnc-prefs-p.h>
 }
 /* For test_conn_index_functions */
 #include "test-dbi-stuff.h"
 #include "test-dbi-business-stuff.h"
 #include "../gnc-backend-dbi-priv.h"
+#include <gnc-transaction-sql.h>
 
 #if LIBDBI_VERSION >= 900
 #define HAVE_LIBDBI_R 1
@@ -496,6 +500,277 @@ cleanup:
     }
     return;
 }
+/* The transactions the split query's SQL translation selects must
+ * include those of every split the engine matches; with exact is TRUE
+ * they must be exactly those. */
+static void
+check_split_query_sql (QofBackend *qbe, QofQuery *query, gboolean exact)
+{
+    auto be = (GncSqlBackend*)qbe;
+    auto engine_txs = g_hash_table_new (guid_hash_to_guint,
+                                        guid_g_hash_table_equal);
+    auto sql_txs = g_hash_table_new_full (guid_hash_to_guint,
+                                          guid_g_hash_table_equal,
+                                          g_free, NULL);
+    auto sql = gnc_sql_split_query_to_tx_subquery (be, query);
+
+    for (auto node = qof_query_run (query); node; node = node->next)
+    {
+        auto tx = xaccSplitGetParent (static_cast<Split*>(node->data));
+        auto guid = qof_instance_get_guid (QOF_INSTANCE (tx));
+        g_hash_table_insert (engine_txs, (gpointer)guid, (gpointer)guid);
+    }
+    g_assert (sql != NULL);
+    auto result = gnc_sql_execute_select_sql (be, sql);
+    g_assert (result != NULL);
+    for (auto row = gnc_sql_result_get_first_row (result); row;
+            row = gnc_sql_result_get_next_row (result))
+    {
+        auto val = gnc_sql_row_get_value_at_col_name (row, "guid");
+        GncGUID guid;
+        g_assert (string_to_guid (g_value_get_string (val), &guid));
+        g_hash_table_insert (sql_txs, guid_copy (&guid), NULL);
+    }
+    gnc_sql_result_dispose (result);
+
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init (&iter, engine_txs);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        g_assert (g_hash_table_contains (sql_txs, key));
+    if (exact)
+        g_assert_cmpuint (g_hash_table_size (sql_txs), ==,
+                          g_hash_table_size (engine_txs));
+
+    g_free (sql);
+    g_hash_table_destroy (sql_txs);
+    g_hash_table_destroy (engine_txs);
+}
+
+/* The SQL translation of split queries, which picks the transactions
+ * to load when they are loaded as needed. */
+static void
+test_dbi_split_query_sql (Fixture *fixture, gconstpointer pData)
+{
+    auto url = (gchar*)pData;
+    QofSession *session;
+    QofBook *book;
+    QofQuery *query;
+    Split *split;
+    Transaction *tx;
+    GList *splits;
+
+    auto msg = "[gnc_dbi_unlock()] There was no lock entry in the Lock table";
+    auto log_domain = "gnc.backend.dbi";
+    auto loglevel = static_cast<GLogLevelFlags>(G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct *check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                     (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+    session = qof_session_new ();
+    qof_session_begin (session, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session);
+    qof_session_save (session, NULL);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    book = qof_session_get_book (session);
+    auto qbe = qof_session_get_backend (session);
+
+    /* No terms: every transaction */
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    check_split_query_sql (qbe, query, TRUE);
+    splits = qof_query_run (query);
+    g_assert (splits != NULL);
+    split = static_cast<Split*>(splits->data);
+    tx = xaccSplitGetParent (split);
+    qof_query_destroy (query);
+
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddSingleAccountMatch (query, xaccSplitGetAccount (split),
+                                    QOF_QUERY_AND);
+    check_split_query_sql (qbe, query, TRUE);
+    qof_query_destroy (query);
+
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddDateMatchTT (query, TRUE, xaccTransGetDate (tx),
+                             TRUE, xaccTransGetDate (tx), QOF_QUERY_AND);
+    check_split_query_sql (qbe, query, FALSE);
+    qof_query_destroy (query);
+
+    /* Two OR terms, one of them only partly translated */
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddDescriptionMatch (query, xaccTransGetDescription (tx),
+                                  TRUE, FALSE, QOF_COMPARE_EQUAL,
+                                  QOF_QUERY_AND);
+    xaccQueryAddSingleAccountMatch (query, xaccSplitGetAccount (split),
+                                    QOF_QUERY_OR);
+    xaccQueryAddClearedMatch (query, CLEARED_RECONCILED, QOF_QUERY_AND);
+    check_split_query_sql (qbe, query, FALSE);
+    qof_query_destroy (query);
+
+    qof_session_end (session);
+    qof_session_destroy (session);
+}
+
+/* The balances the database sums as of a date and over a period must
+ * be those the engine computes from the splits it holds. */
+static void
+test_dbi_account_balances_sql (Fixture *fixture, gconstpointer pData)
+{
+    auto url = (gchar*)pData;
+    QofSession *session;
+    QofBook *book;
+    QofQuery *query;
+    GList *splits;
+
+    auto msg = "[gnc_dbi_unlock()] There was no lock entry in the Lock table";
+    auto log_domain = "gnc.backend.dbi";
+    auto loglevel = static_cast<GLogLevelFlags>(G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct *check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                     (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+    session = qof_session_new ();
+    qof_session_begin (session, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session);
+    qof_session_save (session, NULL);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    book = qof_session_get_book (session);
+    auto be = (GncSqlBackend*)qof_session_get_backend (session);
+
+    /* Every split is loaded, so the engine doesn't ask the database. */
+    g_assert (be->be.balance_lookup == NULL);
+
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    splits = qof_query_run (query);
+    g_assert (splits != NULL);
+    auto date = xaccTransGetDate (xaccSplitGetParent (static_cast<Split*>(splits->data)));
+    qof_query_destroy (query);
+
+    Timespec start = { date - 30 * 86400, 0 };
+    Timespec end = { date, 0 };
+    auto as_of = gnc_sql_get_account_balances_as_of_slist (be, end);
+    auto period = gnc_sql_get_account_period_balances_slist (be, start, end);
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto acct = static_cast<Account*>(node->data);
+        auto expected = xaccAccountGetBalanceAsOfDate (acct, date + 1);
+        auto change = xaccAccountGetBalanceChangeForPeriod (acct, start.tv_sec,
+                      date + 1, FALSE);
+        gnc_numeric balance = gnc_numeric_zero ();
+        gnc_numeric period_balance = gnc_numeric_zero ();
+
+        for (auto bal = as_of; bal; bal = bal->next)
+            if (static_cast<acct_balances_t*>(bal->data)->acct == acct)
+                balance = static_cast<acct_balances_t*>(bal->data)->balance;
+        g_assert (gnc_numeric_equal (balance, expected));
+        for (auto bal = period; bal; bal = bal->next)
+            if (static_cast<acct_balances_t*>(bal->data)->acct == acct)
+                period_balance = static_cast<acct_balances_t*>(bal->data)->balance;
+        g_assert (gnc_numeric_equal (period_balance, change));
+
+        g_assert (gnc_sql_balance_lookup (&be->be, QOF_INSTANCE (acct),
+                                          NULL, &end, &balance));
+        g_assert (gnc_numeric_equal (balance, expected));
+        g_assert (gnc_sql_balance_lookup (&be->be, QOF_INSTANCE (acct),
+                                          &start, &end, &balance));
+        g_assert (gnc_numeric_equal (balance, change));
+    }
+    g_list_free (accounts);
+    g_slist_free_full (as_of, g_free);
+    g_slist_free_full (period, g_free);
+
+    qof_session_end (session);
+    qof_session_destroy (session);
+}
+
+static gboolean
+change_log_get_bool (const gchar *group, const gchar *pref_name)
+{
+    return g_strcmp0 (pref_name, "sql-change-log") == 0;
+}
+
+/* Two sessions share a database with the change log on: the second one
+ * must notice and load the transaction the first one commits. */
+static void
+test_dbi_change_log (Fixture *fixture, gconstpointer pData)
+{
+    auto url = (gchar*)pData;
+    QofSession *session_1, *session_2;
+    QofBook *book_1;
+    Account *acct;
+    Transaction *tx;
+    Split *split;
+    GncGUID guid;
+    PrefsBackend prefs {};
+    auto saved_prefs = prefsbackend;
+
+    auto msg = "[gnc_dbi_unlock()] There was no lock entry in the Lock table";
+    auto log_domain = "gnc.backend.dbi";
+    auto loglevel = static_cast<GLogLevelFlags>(G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct *check = test_error_struct_new (log_domain, loglevel, msg);
+
+    prefs.get_bool = change_log_get_bool;
+    prefsbackend = &prefs;
+    if (fixture->filename)
+        url = fixture->filename;
+
+    session_1 = qof_session_new ();
+    qof_session_begin (session_1, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_1), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_1);
+    qof_session_save (session_1, NULL);
+    g_assert_cmpint (qof_session_get_error (session_1), ==, ERR_BACKEND_NO_ERR);
+
+    session_2 = qof_session_new ();
+    qof_session_begin (session_2, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+    qof_session_load (session_2, NULL);
+    g_assert (!qof_session_events_pending (session_2));
+
+    book_1 = qof_session_get_book (session_1);
+    acct = gnc_account_lookup_by_name (gnc_book_get_root_account (book_1),
+                                       "Bank 1");
+    g_assert (acct != NULL);
+    tx = xaccMallocTransaction (book_1);
+    xaccTransBeginEdit (tx);
+    xaccTransSetCurrency (tx, xaccAccountGetCommodity (acct));
+    xaccTransSetDescription (tx, "From the other session");
+    split = xaccMallocSplit (book_1);
+    xaccSplitSetParent (split, tx);
+    xaccSplitSetAccount (split, acct);
+    xaccTransCommitEdit (tx);
+    guid = *qof_instance_get_guid (QOF_INSTANCE (tx));
+
+    /* The committing session already has it. */
+    g_assert (!qof_session_events_pending (session_1));
+    g_assert (qof_session_events_pending (session_2));
+    g_assert (qof_session_process_events (session_2));
+    tx = xaccTransLookup (&guid, qof_session_get_book (session_2));
+    g_assert (tx != NULL);
+    g_assert_cmpstr (xaccTransGetDescription (tx), ==, "From the other session");
+    g_assert_cmpint (xaccTransCountSplits (tx), ==, 1);
+    g_assert (!qof_session_events_pending (session_2));
+    g_assert (!qof_session_process_events (session_2));
+
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                     (GLogFunc)test_checked_handler);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_1);
+    qof_session_destroy (session_1);
+    prefsbackend = saved_prefs;
+}
+
 /* Test the gnc_dbi_load logic that forces a newer database to be
  * opened read-only and an older one to be safe-saved. Again, it would
  * be better to do this starting from a fresh file, but instead we're
@@ -610,6 +885,12 @@ create_dbi_test_suite (const char *dbm_name, const char *url)
                   test_dbi_safe_save, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
                   test_dbi_version_control, teardown);
+    GNC_TEST_ADD (subsuite, "change_log", Fixture, url, setup_memory,
+                  test_dbi_change_log, teardown);
+    GNC_TEST_ADD (subsuite, "split_query_sql", Fixture, url, setup,
+                  test_dbi_split_query_sql, teardown);
+    GNC_TEST_ADD (subsuite, "account_balances_sql", Fixture, url, setup,
+                  test_dbi_account_balances_sql, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
                   setup_business, test_dbi_version_control, teardown);
     g_free (subsuite);
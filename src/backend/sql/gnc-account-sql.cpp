@@ -307,6 +307,9 @@ load_all_accounts( GncSqlBackend* be )
         }
         if ( bal_slist != NULL )
         {
+            /* Only the accounts' totals are in memory, so their dated
+             * balances have to be summed by the database too. */
+            be->be.balance_lookup = gnc_sql_balance_lookup;
             g_slist_free( bal_slist );
         }
     }
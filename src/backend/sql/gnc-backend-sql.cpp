@@ -39,6 +39,7 @@ extern "C"
 #include <qofquery-p.h>
 #include <qofquerycore-p.h>
 #include <Account.h>
+#include <Transaction.h>
 #include <TransLog.h>
 #include <gnc-engine.h>
 #include <SX-book.h>
@@ -80,10 +81,21 @@ extern "C"
 #include "gnc-vendor-sql.h"
 
 static void gnc_sql_init_object_handlers( void );
+static void begin_insert_batching( GncSqlBackend* be );
+static gboolean flush_pending_inserts( GncSqlBackend* be,
+                                       const gchar* table_name );
+static gboolean add_pending_insert( GncSqlBackend* be, const gchar* table_name,
+                                    QofIdTypeConst obj_name, gpointer pObject,
+                                    const GncSqlColumnTableEntry* table );
+static gboolean end_insert_batching( GncSqlBackend* be, gboolean flush );
 static void update_progress( GncSqlBackend* be );
 static void finish_progress( GncSqlBackend* be );
 static void register_standard_col_type_handlers( void );
 static gboolean reset_version_info( GncSqlBackend* be );
+static void forget_saved_rows( GncSqlBackend* be );
+static void init_change_log( GncSqlBackend* be );
+static gboolean record_change( GncSqlBackend* be, QofInstance* inst,
+                               gboolean is_destroying );
 /*@ null @*/
 static GncSqlStatement* build_insert_statement( GncSqlBackend* be,
         const gchar* table_name,
@@ -135,7 +147,7 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 /* ================================================================= */
 
 void
-gnc_sql_init( /*@ unused @*/ GncSqlBackend* be )
+gnc_sql_init( GncSqlBackend* be )
 {
     static gboolean initialized = FALSE;
 
@@ -145,6 +157,11 @@ gnc_sql_init( /*@ unused @*/ GncSqlBackend* be )
         gnc_sql_init_object_handlers();
         initialized = TRUE;
     }
+
+    if ( be != NULL )
+    {
+        be->insert_batch_size = GNC_SQL_DEFAULT_INSERT_BATCH_SIZE;
+    }
 }
 
 /* ================================================================= */
@@ -463,10 +480,12 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     ENTER( "book=%p, be->book=%p", book, be->book );
     update_progress( be );
     (void)reset_version_info( be );
+    forget_saved_rows( be );
 
     /* Create new tables */
     be->is_pristine_db = TRUE;
     qof_object_foreach_backend( GNC_SQL_BACKEND, create_tables_cb, be );
+    init_change_log( be );
 
     /* Save all contents */
     be->book = book;
@@ -476,6 +495,10 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     be->operations_done = 0;
 
     is_ok = gnc_sql_connection_begin_transaction( be->conn );
+    if ( is_ok )
+    {
+        begin_insert_batching( be );
+    }
 
     // FIXME: should write the set of commodities that are used
     //write_commodities( be, book );
@@ -503,6 +526,11 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     {
         qof_object_foreach_backend( GNC_SQL_BACKEND, write_cb, be );
     }
+    /* Send, or after a failure discard, the rows still batched. */
+    if ( !end_insert_batching( be, is_ok ) )
+    {
+        is_ok = FALSE;
+    }
     if ( is_ok )
     {
         is_ok = gnc_sql_connection_commit_transaction( be->conn );
@@ -521,11 +549,79 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
         if (!qof_backend_check_error ((QofBackend*)be))
             qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_SERVER_ERR );
         is_ok = gnc_sql_connection_rollback_transaction( be->conn );
+        forget_saved_rows( be );
     }
     finish_progress( be );
     LEAVE( "book=%p", book );
 }
 
+typedef struct
+{
+    GncSqlBackend* be;
+    gboolean is_ok;
+} sync_dirty_t;
+
+static void
+sync_dirty_instance_cb( QofInstance* inst, gpointer data )
+{
+    sync_dirty_t* sync = static_cast<decltype(sync)>(data);
+
+    /* Objects still being edited are written by their own commit. */
+    if ( !sync->is_ok || !qof_instance_get_dirty_flag( inst ) ||
+            qof_instance_get_editlevel( inst ) > 0 )
+        return;
+
+    gnc_sql_commit_edit( sync->be, inst );
+    if ( qof_instance_get_dirty_flag( inst ) ||
+            qof_backend_check_error( (QofBackend*)sync->be ) )
+        sync->is_ok = FALSE;
+    update_progress( sync->be );
+}
+
+static void
+sync_dirty_collection_cb( QofCollection* col, gpointer data )
+{
+    if ( qof_collection_is_dirty( col ) )
+        qof_collection_foreach( col, sync_dirty_instance_cb, data );
+}
+
+gboolean
+gnc_sql_sync_dirty( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
+{
+    sync_dirty_t sync;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+    g_return_val_if_fail( book != NULL, FALSE );
+
+    ENTER( "book=%p", book );
+    update_progress( be );
+
+    sync.be = be;
+    sync.is_ok = gnc_sql_connection_begin_transaction( be->conn );
+    if ( sync.is_ok )
+    {
+        qof_book_foreach_collection( book, sync_dirty_collection_cb, &sync );
+    }
+    if ( sync.is_ok )
+    {
+        sync.is_ok = gnc_sql_connection_commit_transaction( be->conn );
+    }
+    if ( sync.is_ok )
+    {
+        qof_book_mark_session_saved( book );
+    }
+    else
+    {
+        /* The objects written so far are rolled back with the rest, so
+         * they must be written again by the full sync. */
+        (void)gnc_sql_connection_rollback_transaction( be->conn );
+        forget_saved_rows( be );
+    }
+    finish_progress( be );
+    LEAVE( "ok=%d", sync.is_ok );
+    return sync.is_ok;
+}
+
 /* ================================================================= */
 /* Routines to deal with the creation of multiple books. */
 
@@ -579,6 +675,7 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     gboolean is_dirty;
     gboolean is_destroying;
     gboolean is_infant;
+    gboolean is_batching;
 
     g_return_if_fail( be != NULL );
     g_return_if_fail( inst != NULL );
@@ -586,7 +683,6 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     if ( qof_book_is_readonly( be->book ) )
     {
         qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_READONLY );
-        (void)gnc_sql_connection_rollback_transaction( be->conn );
         return;
     }
     /* During initial load where objects are being created, don't commit
@@ -628,6 +724,14 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
         return;
     }
 
+    /* Send the rows the object and its children insert into each table
+     * together, saving a round trip to the server per row. */
+    is_batching = be->pending_inserts == NULL;
+    if ( is_batching )
+    {
+        begin_insert_batching( be );
+    }
+
     be_data.is_known = FALSE;
     be_data.be = be;
     be_data.inst = inst;
@@ -635,6 +739,16 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
 
     qof_object_foreach_backend( GNC_SQL_BACKEND, commit_cb, &be_data );
 
+    if ( is_batching &&
+            !end_insert_batching( be, be_data.is_known && be_data.is_ok ) )
+    {
+        be_data.is_ok = FALSE;
+    }
+    if ( be_data.is_known && be_data.is_ok && be->log_changes )
+    {
+        be_data.is_ok = record_change( be, inst, is_destroying );
+    }
+
     if ( !be_data.is_known )
     {
         PERR( "gnc_sql_commit_edit(): Unknown object type '%s'\n", inst->e_type );
@@ -650,6 +764,7 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     {
         // Error - roll it back
         (void)gnc_sql_connection_rollback_transaction( be->conn );
+        forget_saved_rows( be );
 
         // This *should* leave things marked dirty
         LEAVE( "Rolled back - database error" );
@@ -658,11 +773,110 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
 
     (void)gnc_sql_connection_commit_transaction( be->conn );
 
+    /* Inside a group commit, this was only a savepoint */
+    if ( be->group_depth > 0 && be->group_ok )
+    {
+        g_hash_table_insert( be->group_instances,
+                             guid_copy( qof_instance_get_guid( inst ) ),
+                             (gpointer)inst->e_type );
+        LEAVE( "Saved with the group" );
+        return;
+    }
+
     qof_book_mark_session_saved( be->book );
     qof_instance_mark_clean(inst);
 
     LEAVE( "" );
 }
+
+void
+gnc_sql_begin_group_commit( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    ENTER( "depth=%d", be->group_depth );
+    if ( be->group_depth++ == 0 )
+    {
+        be->group_ok = gnc_sql_connection_begin_transaction( be->conn );
+        if ( !be->group_ok )
+        {
+            PERR( "gnc_sql_begin_group_commit(): begin_transaction failed\n" );
+        }
+        else
+        {
+            be->group_instances = g_hash_table_new_full( guid_hash_to_guint,
+                                  guid_g_hash_table_equal,
+                                  (GDestroyNotify)guid_free, NULL );
+        }
+    }
+    LEAVE( "" );
+}
+
+typedef struct
+{
+    QofBook* book;
+    gboolean saved;
+} group_end_data;
+
+/* The commit of an instance of the group went into the database, or
+ * didn't.  Instances destroyed meanwhile are gone from the book. */
+static void
+group_end_cb( gpointer key, gpointer value, gpointer user_data )
+{
+    group_end_data* data = static_cast<decltype(data)>(user_data);
+    QofCollection* col = qof_book_get_collection( data->book,
+                                                  static_cast<QofIdTypeConst>(value) );
+    QofInstance* inst = qof_collection_lookup_entity( col,
+                                                      static_cast<GncGUID*>(key) );
+
+    if ( inst == NULL )
+        return;
+    if ( data->saved )
+    {
+        qof_instance_mark_clean( inst );
+    }
+    else
+    {
+        qof_instance_set_dirty( inst );
+        qof_collection_mark_dirty( col );
+    }
+}
+
+void
+gnc_sql_end_group_commit( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( be->group_depth > 0 );
+
+    ENTER( "depth=%d", be->group_depth );
+    if ( --be->group_depth == 0 && be->group_ok )
+    {
+        group_end_data data;
+
+        be->group_ok = FALSE;
+        data.book = be->book;
+        data.saved = gnc_sql_connection_commit_transaction( be->conn );
+        if ( !data.saved )
+        {
+            /* The commits in the group are lost; leave their instances
+             * dirty to be saved again. */
+            (void)gnc_sql_connection_rollback_transaction( be->conn );
+            forget_saved_rows( be );
+            qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_SERVER_ERR );
+        }
+        g_hash_table_foreach( be->group_instances, group_end_cb, &data );
+        g_hash_table_destroy( be->group_instances );
+        be->group_instances = NULL;
+        if ( !data.saved )
+        {
+            qof_book_mark_session_dirty( be->book );
+            LEAVE( "Rolled back - database commit error" );
+            return;
+        }
+        qof_book_mark_session_saved( be->book );
+    }
+    LEAVE( "" );
+}
 /* ---------------------------------------------------------------------- */
 
 /* Query processing */
@@ -1724,6 +1938,15 @@ static GncSqlColumnTypeHandler double_handler
 };
 /* ----------------------------------------------------------------- */
 
+/* Is the column the QofInstance "guid" property of the object? */
+static inline gboolean
+is_instance_guid_param( gpointer pObject, const GncSqlColumnTableEntry* table_row )
+{
+    return table_row->gobj_param_name != NULL
+           && strcmp( table_row->gobj_param_name, "guid" ) == 0
+           && QOF_IS_INSTANCE( pObject );
+}
+
 static void
 load_guid( const GncSqlBackend* be, GncSqlRow* row,
            /*@ null @*/ QofSetterFunc setter, gpointer pObject,
@@ -1751,7 +1974,12 @@ load_guid( const GncSqlBackend* be, GncSqlRow* row,
     }
     if ( pGuid != NULL )
     {
-        if ( table_row->gobj_param_name != NULL )
+        /* An object's own guid needn't go through the property system */
+        if ( is_instance_guid_param( pObject, table_row ) )
+        {
+            qof_instance_set_guid( QOF_INSTANCE(pObject), pGuid );
+        }
+        else if ( table_row->gobj_param_name != NULL )
         {
 	if (QOF_IS_INSTANCE (pObject))
 	    qof_instance_increase_editlevel (QOF_INSTANCE (pObject));
@@ -1787,7 +2015,8 @@ add_gvalue_guid_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
                           const gpointer pObject, const GncSqlColumnTableEntry* table_row, GSList** pList )
 {
     QofAccessFunc getter;
-    GncGUID* guid = NULL;
+    const GncGUID* guid = NULL;
+    GncGUID* guid_copy = NULL;
     gchar guid_buf[GUID_ENCODING_LENGTH+1];
     GValue* value;
 
@@ -1798,9 +2027,15 @@ add_gvalue_guid_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
 
     value = g_new0( GValue, 1 );
     g_assert( value != NULL );
-    if ( table_row->gobj_param_name != NULL )
+    if ( is_instance_guid_param( pObject, table_row ) )
+    {
+        guid = qof_instance_get_guid( pObject );
+    }
+    else if ( table_row->gobj_param_name != NULL )
     {
-        g_object_get( pObject, table_row->gobj_param_name, &guid, NULL );
+        /* Boxed properties are returned as a copy */
+        g_object_get( pObject, table_row->gobj_param_name, &guid_copy, NULL );
+        guid = guid_copy;
     }
     else
     {
@@ -1816,6 +2051,10 @@ add_gvalue_guid_to_slist( const GncSqlBackend* be, QofIdTypeConst obj_name,
         (void)guid_to_string_buff( guid, guid_buf );
         g_value_set_string( value, guid_buf );
     }
+    if ( guid_copy != NULL )
+    {
+        guid_free( guid_copy );
+    }
 
     (*pList) = g_slist_append( (*pList), value );
 
@@ -1839,6 +2078,7 @@ gnc_sql_add_gvalue_objectref_guid_to_slist( const GncSqlBackend* be, QofIdTypeCo
     const GncGUID* guid = NULL;
     gchar guid_buf[GUID_ENCODING_LENGTH+1];
     QofInstance* inst = NULL;
+    gboolean is_ref = FALSE;
     GValue* value;
 
     g_return_if_fail( be != NULL );
@@ -1850,7 +2090,9 @@ gnc_sql_add_gvalue_objectref_guid_to_slist( const GncSqlBackend* be, QofIdTypeCo
     g_assert( value != NULL );
     if ( table_row->gobj_param_name != NULL )
     {
+        /* Object properties are returned with a reference added */
         g_object_get( pObject, table_row->gobj_param_name, &inst, NULL );
+        is_ref = inst != NULL;
     }
     else
     {
@@ -1870,6 +2112,10 @@ gnc_sql_add_gvalue_objectref_guid_to_slist( const GncSqlBackend* be, QofIdTypeCo
         (void)guid_to_string_buff( guid, guid_buf );
         g_value_set_string( value, guid_buf );
     }
+    if ( is_ref )
+    {
+        g_object_unref( inst );
+    }
 
     (*pList) = g_slist_append( (*pList), value );
 }
@@ -2538,6 +2784,218 @@ create_single_col_select_statement( GncSqlBackend* be,
 }
 
 /* ================================================================= */
+/* Statement statistics, kept while the gnc.backend.sql.stats log domain
+ * is at info level (e.g. --log gnc.backend.sql.stats=info). */
+#define STATS_LOG_MODULE "gnc.backend.sql.stats"
+#define STATS_BUCKETS 32
+#define SLOW_STATEMENT_USECS (250 * 1000)
+
+typedef struct
+{
+    guint count;
+    gint64 total_usecs;
+    gint64 max_usecs;
+    guint64 rows;
+    guint64 bytes_sent;
+    guint histogram[STATS_BUCKETS];	/* bucket i counts times below 2^(i+1) usecs */
+} statement_stats_t;
+
+/* The statement with its literal values replaced by '?', runs of values
+ * collapsed and the rows of an INSERT dropped, so that statements which
+ * differ only in their data are counted together. */
+static gchar*
+statement_shape( const gchar* sql )
+{
+    GString* shape = g_string_sized_new( strlen( sql ) );
+    const gchar* p = sql;
+
+    while ( *p != '\0' )
+    {
+        gboolean is_literal = FALSE;
+
+        if ( *p == '\'' )
+        {
+            for ( ++p; *p != '\0'; ++p )
+            {
+                if ( *p == '\'' && *(p + 1) == '\'' ) ++p;
+                else if ( *p == '\'' ) break;
+            }
+            if ( *p != '\0' ) ++p;
+            is_literal = TRUE;
+        }
+        else if ( g_ascii_isdigit( *p ) &&
+                  ( shape->len == 0 ||
+                    !( g_ascii_isalnum( shape->str[shape->len - 1] ) ||
+                       shape->str[shape->len - 1] == '_' ) ) )
+        {
+            while ( g_ascii_isdigit( *p ) || *p == '.' ) ++p;
+            is_literal = TRUE;
+        }
+        if ( is_literal )
+        {
+            gsize len = shape->len;
+            while ( len > 0 && shape->str[len - 1] == ' ' ) --len;
+            if ( len > 1 && shape->str[len - 1] == ',' &&
+                    shape->str[len - 2] == '?' )
+                g_string_truncate( shape, len - 1 );
+            else
+                g_string_append_c( shape, '?' );
+            continue;
+        }
+        g_string_append_c( shape, *p++ );
+        if ( g_str_has_prefix( shape->str, "INSERT" ) &&
+                g_str_has_suffix( shape->str, " VALUES" ) )
+        {
+            g_string_append( shape, " ..." );
+            break;
+        }
+    }
+    return g_string_free( shape, FALSE );
+}
+
+static void
+record_statement( GncSqlBackend* be, GncSqlStatement* stmt, gint64 start,
+                  guint64 rows )
+{
+    gint64 usecs = g_get_monotonic_time() - start;
+    const gchar* sql = gnc_sql_statement_to_sql( stmt );
+    gchar* shape = statement_shape( sql );
+    statement_stats_t* stats;
+    guint bucket = 0;
+
+    if ( be->statement_stats == NULL )
+        be->statement_stats = g_hash_table_new_full( g_str_hash, g_str_equal,
+                                                     g_free, g_free );
+    stats = static_cast<decltype(stats)>(g_hash_table_lookup( be->statement_stats, shape ));
+    if ( stats == NULL )
+    {
+        stats = g_new0( statement_stats_t, 1 );
+        g_hash_table_insert( be->statement_stats, shape, stats );
+    }
+    else
+    {
+        g_free( shape );
+    }
+    stats->count++;
+    stats->total_usecs += usecs;
+    stats->max_usecs = MAX( stats->max_usecs, usecs );
+    stats->rows += rows;
+    stats->bytes_sent += strlen( sql );
+    while ( bucket < STATS_BUCKETS - 1 && ( usecs >> ( bucket + 1 ) ) > 0 )
+        ++bucket;
+    stats->histogram[bucket]++;
+
+    if ( usecs > SLOW_STATEMENT_USECS )
+        g_log( STATS_LOG_MODULE, G_LOG_LEVEL_INFO,
+               "Slow statement (%" G_GINT64_FORMAT " ms, %" G_GUINT64_FORMAT
+               " rows): %s", usecs / 1000, rows, sql );
+}
+
+static inline gboolean
+statement_stats_enabled( void )
+{
+    return qof_log_check( STATS_LOG_MODULE, QOF_LOG_INFO );
+}
+
+static GncSqlResult*
+execute_select_statement( GncSqlBackend* be, GncSqlStatement* stmt )
+{
+    GncSqlResult* result;
+    gint64 start;
+
+    if ( !statement_stats_enabled() )
+        return gnc_sql_connection_execute_select_statement( be->conn, stmt );
+
+    start = g_get_monotonic_time();
+    result = gnc_sql_connection_execute_select_statement( be->conn, stmt );
+    record_statement( be, stmt, start,
+                      result != NULL ? gnc_sql_result_get_num_rows( result ) : 0 );
+    return result;
+}
+
+static gint
+execute_nonselect_statement( GncSqlBackend* be, GncSqlStatement* stmt )
+{
+    gint result;
+    gint64 start;
+
+    if ( !statement_stats_enabled() )
+        return gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+
+    start = g_get_monotonic_time();
+    result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+    record_statement( be, stmt, start, result > 0 ? result : 0 );
+    return result;
+}
+
+static gint
+compare_stats_total( gconstpointer a, gconstpointer b, gpointer table )
+{
+    statement_stats_t* sa = static_cast<decltype(sa)>(g_hash_table_lookup( (GHashTable*)table, a ));
+    statement_stats_t* sb = static_cast<decltype(sb)>(g_hash_table_lookup( (GHashTable*)table, b ));
+
+    return sa->total_usecs < sb->total_usecs ? 1 :
+           sa->total_usecs > sb->total_usecs ? -1 : 0;
+}
+
+/* The upper bound of the histogram bucket holding the percentile */
+static gint64
+stats_percentile_usecs( const statement_stats_t* stats, guint percent )
+{
+    guint64 wanted = ( (guint64)stats->count * percent + 99 ) / 100;
+    guint64 seen = 0;
+    guint bucket;
+
+    for ( bucket = 0; bucket < STATS_BUCKETS - 1; ++bucket )
+    {
+        seen += stats->histogram[bucket];
+        if ( seen >= wanted )
+            break;
+    }
+    return MIN( (gint64)1 << ( bucket + 1 ), stats->max_usecs );
+}
+
+void
+gnc_sql_dump_statement_stats( GncSqlBackend* be )
+{
+    GList* shapes;
+    GList* node;
+
+    g_return_if_fail( be != NULL );
+
+    if ( be->statement_stats == NULL )
+        return;
+
+    shapes = g_hash_table_get_keys( be->statement_stats );
+    shapes = g_list_sort_with_data( shapes, compare_stats_total,
+                                    be->statement_stats );
+    g_log( STATS_LOG_MODULE, G_LOG_LEVEL_INFO,
+           "count, total ms, mean us, p99 us, max us, rows, bytes sent, statement" );
+    for ( node = shapes; node != NULL; node = node->next )
+    {
+        statement_stats_t* stats = static_cast<decltype(stats)>(g_hash_table_lookup( be->statement_stats, node->data ));
+        g_log( STATS_LOG_MODULE, G_LOG_LEVEL_INFO,
+               "%u, %" G_GINT64_FORMAT ", %" G_GINT64_FORMAT ", %" G_GINT64_FORMAT
+               ", %" G_GINT64_FORMAT ", %" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ", %s",
+               stats->count, stats->total_usecs / 1000,
+               stats->total_usecs / stats->count,
+               stats_percentile_usecs( stats, 99 ), stats->max_usecs,
+               stats->rows, stats->bytes_sent, (const gchar*)node->data );
+    }
+    g_list_free( shapes );
+}
+
+void
+gnc_sql_reset_statement_stats( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->statement_stats != NULL )
+    {
+        g_hash_table_destroy( be->statement_stats );
+        be->statement_stats = NULL;
+    }
+}
 
 /*@ null @*/ GncSqlResult*
 gnc_sql_execute_select_statement( GncSqlBackend* be, GncSqlStatement* stmt )
@@ -2547,7 +3005,8 @@ gnc_sql_execute_select_statement( GncSqlBackend* be, GncSqlStatement* stmt )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( stmt != NULL, NULL );
 
-    result = gnc_sql_connection_execute_select_statement( be->conn, stmt );
+    (void)flush_pending_inserts( be, NULL );
+    result = execute_select_statement( be, stmt );
     if ( result == NULL )
     {
         PERR( "SQL error: %s\n", gnc_sql_statement_to_sql( stmt ) );
@@ -2589,7 +3048,8 @@ gnc_sql_execute_select_sql( GncSqlBackend* be, const gchar* sql )
     {
         return NULL;
     }
-    result = gnc_sql_connection_execute_select_statement( be->conn, stmt );
+    (void)flush_pending_inserts( be, NULL );
+    result = execute_select_statement( be, stmt );
     gnc_sql_statement_dispose( stmt );
     if ( result == NULL )
     {
@@ -2614,7 +3074,8 @@ gnc_sql_execute_nonselect_sql( GncSqlBackend* be, const gchar* sql )
     {
         return -1;
     }
-    result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+    (void)flush_pending_inserts( be, NULL );
+    result = execute_nonselect_statement( be, stmt );
     gnc_sql_statement_dispose( stmt );
     return result;
 }
@@ -2628,8 +3089,14 @@ execute_statement_get_count( GncSqlBackend* be, GncSqlStatement* stmt )
     g_return_val_if_fail( be != NULL, 0 );
     g_return_val_if_fail( stmt != NULL, 0 );
 
-    result = gnc_sql_execute_select_statement( be, stmt );
-    if ( result != NULL )
+    /* The caller has sent any rows pending for the table queried */
+    result = execute_select_statement( be, stmt );
+    if ( result == NULL )
+    {
+        PERR( "SQL error: %s\n", gnc_sql_statement_to_sql( stmt ) );
+        qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
+    }
+    else
     {
         count = gnc_sql_result_get_num_rows( result );
         gnc_sql_result_dispose( result );
@@ -2695,6 +3162,7 @@ gnc_sql_object_is_it_in_db( GncSqlBackend* be, const gchar* table_name,
     g_assert( list != NULL );
     gnc_sql_statement_add_where_cond( sqlStmt, obj_name, pObject, &table[0], (GValue*)(list->data) );
 
+    (void)flush_pending_inserts( be, table_name );
     count = execute_statement_get_count( be, sqlStmt );
     gnc_sql_statement_dispose( sqlStmt );
     if ( count == 0 )
@@ -2723,6 +3191,19 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
     g_return_val_if_fail( pObject != NULL, FALSE );
     g_return_val_if_fail( table != NULL, FALSE );
 
+    if ( be->pending_inserts != NULL )
+    {
+        if ( op == OP_DB_INSERT )
+        {
+            return add_pending_insert( be, table_name, obj_name, pObject, table );
+        }
+        /* Keep the statements in order */
+        if ( !flush_pending_inserts( be, NULL ) )
+        {
+            return FALSE;
+        }
+    }
+
     if ( op == OP_DB_INSERT )
     {
         stmt = build_insert_statement( be, table_name, obj_name, pObject, table );
@@ -2743,7 +3224,7 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
     {
         gint result;
 
-        result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+        result = execute_nonselect_statement( be, stmt );
         if ( result == -1 )
         {
             PERR( "SQL error: %s\n", gnc_sql_statement_to_sql( stmt ) );
@@ -2867,32 +3348,56 @@ free_gvalue_list( GSList* list )
     g_slist_free( list );
 }
 
-/*@ null @*/ static GncSqlStatement*
-build_insert_statement( GncSqlBackend* be,
-                        const gchar* table_name,
-                        QofIdTypeConst obj_name, gpointer pObject,
+/* The column text of the INSERT and UPDATE statements for a table
+ * depends only on its static column table, so it is built once per
+ * table instead of on every commit. */
+typedef struct
+{
+    gchar* table_name;
+    gchar* insert_sql;          /* "INSERT INTO t(c1,...,cn) VALUES(" */
+    gchar* update_sql;          /* "UPDATE t SET " */
+    GPtrArray* update_cols;     /* "c2=", ..., "cn=" */
+} GncSqlStatementTemplate;
+
+static /*@ null @*//*@ only @*/ GHashTable* g_statementTemplateHash = NULL;
+
+static void
+statement_template_free( gpointer data )
+{
+    GncSqlStatementTemplate* tmpl = static_cast<decltype(tmpl)>(data);
+
+    g_free( tmpl->table_name );
+    g_free( tmpl->insert_sql );
+    g_free( tmpl->update_sql );
+    g_ptr_array_free( tmpl->update_cols, TRUE );
+    g_free( tmpl );
+}
+
+static const GncSqlStatementTemplate*
+get_statement_template( const gchar* table_name,
                         const GncSqlColumnTableEntry* table )
 {
-    GncSqlStatement* stmt;
+    GncSqlStatementTemplate* tmpl;
     GString* sql;
-    GSList* values;
-    GSList* node;
-    gchar* sqlbuf;
     GList* colnames = NULL;
     GList* colname;
     const GncSqlColumnTableEntry* table_row;
 
-    g_return_val_if_fail( be != NULL, NULL );
-    g_return_val_if_fail( table_name != NULL, NULL );
-    g_return_val_if_fail( obj_name != NULL, NULL );
-    g_return_val_if_fail( pObject != NULL, NULL );
-    g_return_val_if_fail( table != NULL, NULL );
+    if ( g_statementTemplateHash == NULL )
+    {
+        g_statementTemplateHash = g_hash_table_new_full( g_direct_hash,
+                                                         g_direct_equal, NULL,
+                                                         statement_template_free );
+    }
 
-    sqlbuf = g_strdup_printf( "INSERT INTO %s(", table_name );
-    sql = g_string_new( sqlbuf );
-    g_free( sqlbuf );
+    tmpl = static_cast<decltype(tmpl)>(
+        g_hash_table_lookup( g_statementTemplateHash, table ));
+    if ( tmpl != NULL && strcmp( tmpl->table_name, table_name ) == 0 )
+    {
+        return tmpl;
+    }
 
-    // Get all col names and all values
+    // Get all col names
     for ( table_row = table; table_row->col_name != NULL; table_row++ )
     {
         if (( table_row->flags & COL_AUTOINC ) == 0 )
@@ -2907,18 +3412,42 @@ build_insert_statement( GncSqlBackend* be,
     }
     g_assert( colnames != NULL );
 
+    tmpl = g_new0( GncSqlStatementTemplate, 1 );
+    tmpl->table_name = g_strdup( table_name );
+    tmpl->update_sql = g_strdup_printf( "UPDATE %s SET ", table_name );
+    tmpl->update_cols = g_ptr_array_new_with_free_func( g_free );
+
+    sql = g_string_new( NULL );
+    g_string_printf( sql, "INSERT INTO %s(", table_name );
     for ( colname = colnames; colname != NULL; colname = colname->next )
     {
         if ( colname != colnames )
         {
             g_string_append( sql, "," );
+            g_ptr_array_add( tmpl->update_cols,
+                             g_strconcat( (gchar*)colname->data, "=", NULL ));
         }
         g_string_append( sql, (gchar*)colname->data );
         g_free( colname->data );
     }
     g_list_free( colnames );
-
     g_string_append( sql, ") VALUES(" );
+    tmpl->insert_sql = g_string_free( sql, FALSE );
+
+    g_hash_table_insert( g_statementTemplateHash, (gpointer)table, tmpl );
+
+    return tmpl;
+}
+
+/* Append the comma separated values of one row */
+static void
+append_insert_values( GncSqlBackend* be, GString* sql,
+                      QofIdTypeConst obj_name, gpointer pObject,
+                      const GncSqlColumnTableEntry* table )
+{
+    GSList* values;
+    GSList* node;
+
     values = create_gslist_from_values( be, obj_name, pObject, table );
     for ( node = values; node != NULL; node = node->next )
     {
@@ -2934,6 +3463,184 @@ build_insert_statement( GncSqlBackend* be,
         (void)g_value_reset( value );
     }
     free_gvalue_list( values );
+}
+
+/* While gnc_sql_sync_all() writes a book into an empty database, rows
+ * are collected per column table into multi-row INSERT statements of
+ * up to be->insert_batch_size rows. Any other statement first sends
+ * what is pending so that the database sees them in order. */
+typedef struct
+{
+    gchar* table_name;
+    GString* sql;
+    gint rows;
+} GncSqlInsertBatch;
+
+static void
+insert_batch_free( gpointer data )
+{
+    GncSqlInsertBatch* batch = static_cast<decltype(batch)>(data);
+
+    g_free( batch->table_name );
+    (void)g_string_free( batch->sql, TRUE );
+    g_free( batch );
+}
+
+static void
+begin_insert_batching( GncSqlBackend* be )
+{
+    if ( be->insert_batch_size > 1 && be->pending_inserts == NULL )
+    {
+        be->pending_inserts = g_hash_table_new_full( g_direct_hash,
+                                                     g_direct_equal, NULL,
+                                                     insert_batch_free );
+    }
+}
+
+static gboolean
+flush_insert_batch( GncSqlBackend* be, GncSqlInsertBatch* batch )
+{
+    GncSqlStatement* stmt;
+    gint result = -1;
+
+    if ( batch->rows == 0 )
+    {
+        return TRUE;
+    }
+
+    (void)g_string_append( batch->sql, ")" );
+    stmt = gnc_sql_connection_create_statement_from_sql( be->conn,
+                                                         batch->sql->str );
+    if ( stmt != NULL )
+    {
+        result = execute_nonselect_statement( be, stmt );
+        gnc_sql_statement_dispose( stmt );
+    }
+    if ( result == -1 )
+    {
+        PERR( "SQL error inserting %d rows into %s\n", batch->rows,
+              batch->table_name );
+        qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
+    }
+    batch->rows = 0;
+
+    return result != -1;
+}
+
+static gboolean
+add_pending_insert( GncSqlBackend* be, const gchar* table_name,
+                    QofIdTypeConst obj_name, gpointer pObject,
+                    const GncSqlColumnTableEntry* table )
+{
+    GncSqlInsertBatch* batch;
+
+    batch = static_cast<decltype(batch)>(
+        g_hash_table_lookup( be->pending_inserts, table ));
+    if ( batch == NULL )
+    {
+        batch = g_new0( GncSqlInsertBatch, 1 );
+        batch->table_name = g_strdup( table_name );
+        batch->sql = g_string_new( NULL );
+        g_hash_table_insert( be->pending_inserts, (gpointer)table, batch );
+    }
+    else if ( strcmp( batch->table_name, table_name ) != 0 )
+    {
+        if ( !flush_insert_batch( be, batch ) )
+        {
+            return FALSE;
+        }
+        g_free( batch->table_name );
+        batch->table_name = g_strdup( table_name );
+    }
+
+    if ( batch->rows == 0 )
+    {
+        (void)g_string_assign( batch->sql,
+                               get_statement_template( table_name, table )->insert_sql );
+    }
+    else
+    {
+        (void)g_string_append( batch->sql, "),(" );
+    }
+    append_insert_values( be, batch->sql, obj_name, pObject, table );
+
+    if ( ++batch->rows >= be->insert_batch_size )
+    {
+        return flush_insert_batch( be, batch );
+    }
+
+    return TRUE;
+}
+
+/* Send the pending rows for table_name, or for all tables if NULL */
+static gboolean
+flush_pending_inserts( GncSqlBackend* be, const gchar* table_name )
+{
+    GHashTableIter iter;
+    gpointer data;
+    gboolean ok = TRUE;
+
+    if ( be->pending_inserts == NULL )
+    {
+        return TRUE;
+    }
+
+    g_hash_table_iter_init( &iter, be->pending_inserts );
+    while ( g_hash_table_iter_next( &iter, NULL, &data ))
+    {
+        GncSqlInsertBatch* batch = static_cast<decltype(batch)>(data);
+        if ( table_name != NULL && strcmp( batch->table_name, table_name ) != 0 )
+        {
+            continue;
+        }
+        if ( !flush_insert_batch( be, batch ))
+        {
+            ok = FALSE;
+        }
+    }
+
+    return ok;
+}
+
+static gboolean
+end_insert_batching( GncSqlBackend* be, gboolean flush )
+{
+    gboolean ok = TRUE;
+
+    if ( be->pending_inserts == NULL )
+    {
+        return TRUE;
+    }
+
+    if ( flush )
+    {
+        ok = flush_pending_inserts( be, NULL );
+    }
+    g_hash_table_destroy( be->pending_inserts );
+    be->pending_inserts = NULL;
+
+    return ok;
+}
+
+/*@ null @*/ static GncSqlStatement*
+build_insert_statement( GncSqlBackend* be,
+                        const gchar* table_name,
+                        QofIdTypeConst obj_name, gpointer pObject,
+                        const GncSqlColumnTableEntry* table )
+{
+    GncSqlStatement* stmt;
+    GString* sql;
+    const GncSqlStatementTemplate* tmpl;
+
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( table_name != NULL, NULL );
+    g_return_val_if_fail( obj_name != NULL, NULL );
+    g_return_val_if_fail( pObject != NULL, NULL );
+    g_return_val_if_fail( table != NULL, NULL );
+
+    tmpl = get_statement_template( table_name, table );
+    sql = g_string_new( tmpl->insert_sql );
+    append_insert_values( be, sql, obj_name, pObject, table );
     (void)g_string_append( sql, ")" );
 
     stmt = gnc_sql_connection_create_statement_from_sql( be->conn, sql->str );
@@ -2951,12 +3658,9 @@ build_update_statement( GncSqlBackend* be,
     GncSqlStatement* stmt;
     GString* sql;
     GSList* values;
-    GList* colnames = NULL;
     GSList* value;
-    GList* colname;
-    gboolean firstCol;
-    const GncSqlColumnTableEntry* table_row;
-    gchar* sqlbuf;
+    guint col;
+    const GncSqlStatementTemplate* tmpl;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( table_name != NULL, NULL );
@@ -2964,50 +3668,28 @@ build_update_statement( GncSqlBackend* be,
     g_return_val_if_fail( pObject != NULL, NULL );
     g_return_val_if_fail( table != NULL, NULL );
 
-    // Get all col names and all values
-    for ( table_row = table; table_row->col_name != NULL; table_row++ )
-    {
-        if (( table_row->flags & COL_AUTOINC ) == 0 )
-        {
-            GncSqlColumnTypeHandler* pHandler;
-
-            // Add col names to the list
-            pHandler = get_handler( table_row );
-            g_assert( pHandler != NULL );
-            pHandler->add_colname_to_list_fn( table_row, &colnames );
-        }
-    }
-    g_assert( colnames != NULL );
+    tmpl = get_statement_template( table_name, table );
     values = create_gslist_from_values( be, obj_name, pObject, table );
 
     // Create the SQL statement
-    sqlbuf = g_strdup_printf( "UPDATE %s SET ", table_name );
-    sql = g_string_new( sqlbuf );
-    g_free( sqlbuf );
+    sql = g_string_new( tmpl->update_sql );
 
-    firstCol = TRUE;
-    for ( colname = colnames->next, value = values->next;
-            colname != NULL && value != NULL;
-            colname = colname->next, value = value->next )
+    for ( col = 0, value = values->next;
+            col < tmpl->update_cols->len && value != NULL;
+            col++, value = value->next )
     {
         gchar* value_str;
-        if ( !firstCol )
+        if ( col != 0 )
         {
             (void)g_string_append( sql, "," );
         }
-        (void)g_string_append( sql, (gchar*)colname->data );
-        (void)g_string_append( sql, "=" );
+        (void)g_string_append( sql,
+                               (gchar*)g_ptr_array_index( tmpl->update_cols, col ));
         value_str = gnc_sql_get_sql_value( be->conn, (GValue*)(value->data) );
         (void)g_string_append( sql, value_str );
         g_free( value_str );
-        firstCol = FALSE;
-    }
-    for ( colname = colnames; colname != NULL; colname = colname->next )
-    {
-        g_free( colname->data );
     }
-    g_list_free( colnames );
-    if ( value != NULL || colname != NULL )
+    if ( value != NULL || col < tmpl->update_cols->len )
     {
         PERR( "Mismatch in number of column names and values" );
     }
@@ -3270,6 +3952,7 @@ gnc_sql_init_version_info( GncSqlBackend* be )
         g_hash_table_destroy( be->versions );
     }
     be->versions = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+    forget_saved_rows( be );
 
     if ( gnc_sql_connection_does_table_exist( be->conn, VERSION_TABLE_NAME ) )
     {
@@ -3306,6 +3989,7 @@ gnc_sql_init_version_info( GncSqlBackend* be )
 	gnc_sql_set_table_version( be, "Gnucash-Resave",
 				   GNUCASH_RESAVE_VERSION );
     }
+    init_change_log( be );
 }
 
 /**
@@ -3338,7 +4022,8 @@ reset_version_info( GncSqlBackend* be )
 }
 
 /**
- * Finalizes the version table info by destroying the hash table.
+ * Finalizes the version table info by destroying the hash table, along
+ * with the tables of commodities and slots known to be saved.
  *
  * @param be Backend struct
  */
@@ -3352,6 +4037,189 @@ gnc_sql_finalize_version_info( GncSqlBackend* be )
         g_hash_table_destroy( be->versions );
         be->versions = NULL;
     }
+    if ( be->saved_commodities != NULL )
+    {
+        g_hash_table_destroy( be->saved_commodities );
+        be->saved_commodities = NULL;
+    }
+    if ( be->saved_slots != NULL )
+    {
+        g_hash_table_destroy( be->saved_slots );
+        be->saved_slots = NULL;
+    }
+    gnc_sql_dump_statement_stats( be );
+    gnc_sql_reset_statement_stats( be );
+}
+
+/* ================================================================= */
+#define CHANGES_MAX_TYPE_LEN 40
+#define CHANGES_RETAIN_DAYS 30
+/* A commit stamps its change log row before its transaction commits, so
+ * other sessions may only see the row some time after its change_time.
+ * Each poll therefore looks back this many seconds before the last one;
+ * the transactions it sees again are already loaded and skipped. */
+#define CHANGES_POLL_OVERLAP 60
+#define GNC_PREF_SQL_CHANGE_LOG "sql-change-log"
+
+static GncSqlColumnTableEntry changes_table[] =
+{
+    /*@ -full_init_block @*/
+    { "obj_guid",    CT_GUID,     0,                    COL_NNUL },
+    { "obj_type",    CT_STRING,   CHANGES_MAX_TYPE_LEN, COL_NNUL },
+    { "change_time", CT_TIMESPEC, 0,                    COL_NNUL },
+    { "destroyed",   CT_BOOLEAN,  0,                    COL_NNUL },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
+/* Turns the change log on if the preference asks for it, creating the
+ * table if needed and dropping the rows no session should still need. */
+static void
+init_change_log( GncSqlBackend* be )
+{
+    Timespec cutoff = { gnc_time( NULL ) - CHANGES_RETAIN_DAYS * 86400, 0 };
+    gchar* datebuf;
+    gchar* sql;
+
+    be->log_changes = !be->is_snapshot &&
+                      gnc_prefs_get_bool( GNC_PREFS_GROUP_GENERAL,
+                                          GNC_PREF_SQL_CHANGE_LOG );
+    if ( !be->log_changes )
+        return;
+    be->changes_seen.tv_sec = gnc_time( NULL ) - CHANGES_POLL_OVERLAP;
+    be->changes_seen.tv_nsec = 0;
+
+    if ( !gnc_sql_connection_does_table_exist( be->conn, GNC_SQL_CHANGES_TABLE ) )
+    {
+        if ( !do_create_table( be, GNC_SQL_CHANGES_TABLE, changes_table ) )
+        {
+            PERR( "Unable to create the change log table\n" );
+            be->log_changes = FALSE;
+        }
+        return;
+    }
+    datebuf = gnc_sql_convert_timespec_to_string( be, cutoff );
+    sql = g_strdup_printf( "DELETE FROM %s WHERE change_time < '%s'",
+                           GNC_SQL_CHANGES_TABLE, datebuf );
+    (void)gnc_sql_execute_nonselect_sql( be, sql );
+    g_free( sql );
+    g_free( datebuf );
+}
+
+/* Adds the change log row for a commit, in the commit's transaction,
+ * and notifies the listening sessions, which get the notification only
+ * once the transaction commits. */
+static gboolean
+record_change( GncSqlBackend* be, QofInstance* inst, gboolean is_destroying )
+{
+    Timespec now = { gnc_time( NULL ), 0 };
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    gchar* datebuf;
+    gchar* sql;
+    gint result;
+
+    (void)guid_to_string_buff( qof_instance_get_guid( inst ), guid_buf );
+    datebuf = gnc_sql_convert_timespec_to_string( be, now );
+    sql = g_strdup_printf( "INSERT INTO %s VALUES('%s','%s','%s',%d)",
+                           GNC_SQL_CHANGES_TABLE, guid_buf, inst->e_type,
+                           datebuf, is_destroying ? 1 : 0 );
+    result = gnc_sql_execute_nonselect_sql( be, sql );
+    g_free( sql );
+    g_free( datebuf );
+    if ( result == -1 )
+    {
+        PERR( "Unable to record the change of %s %s\n", inst->e_type, guid_buf );
+        return FALSE;
+    }
+    if ( be->notify_changes &&
+            gnc_sql_execute_nonselect_sql( be, "NOTIFY " GNC_SQL_CHANGES_TABLE ) == -1 )
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+gboolean
+gnc_sql_changes_pending( GncSqlBackend* be )
+{
+    GncSqlResult* result;
+    gboolean pending = FALSE;
+    gchar* datebuf;
+    gchar* sql;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+
+    if ( !be->log_changes || be->book == NULL || be->loading )
+        return FALSE;
+
+    datebuf = gnc_sql_convert_timespec_to_string( be, be->changes_seen );
+    sql = g_strdup_printf( "SELECT DISTINCT obj_guid FROM %s WHERE obj_type='%s' AND destroyed=0 AND change_time>='%s'",
+                           GNC_SQL_CHANGES_TABLE, GNC_ID_TRANS, datebuf );
+    g_free( datebuf );
+    result = gnc_sql_execute_select_sql( be, sql );
+    g_free( sql );
+    if ( result != NULL )
+    {
+        GncSqlRow* row = gnc_sql_result_get_first_row( result );
+
+        /* This session's own commits are logged too; only the
+         * transactions it doesn't have yet count. */
+        for ( ; row != NULL && !pending;
+                row = gnc_sql_result_get_next_row( result ) )
+        {
+            const GValue* val = gnc_sql_row_get_value_at_col_name( row, "obj_guid" );
+            GncGUID guid;
+
+            if ( val != NULL && g_value_get_string( val ) != NULL &&
+                    string_to_guid( g_value_get_string( val ), &guid ) )
+            {
+                pending = xaccTransLookup( &guid, be->book ) == NULL;
+            }
+        }
+        gnc_sql_result_dispose( result );
+    }
+    return pending;
+}
+
+gboolean
+gnc_sql_load_changes( GncSqlBackend* be )
+{
+    QofCollection* col;
+    Timespec since;
+    guint n_before;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+
+    if ( !be->log_changes || be->book == NULL || be->loading )
+        return FALSE;
+
+    ENTER( " " );
+    since = be->changes_seen;
+    be->changes_seen.tv_sec = gnc_time( NULL ) - CHANGES_POLL_OVERLAP;
+    col = qof_book_get_collection( be->book, GNC_ID_TRANS );
+    n_before = qof_collection_count( col );
+
+    be->loading = TRUE;
+    qof_event_suspend();
+    gnc_sql_transaction_load_changed_since( be, since );
+    be->loading = FALSE;
+    qof_event_resume();
+
+    LEAVE( "%u transactions loaded", qof_collection_count( col ) - n_before );
+    return qof_collection_count( col ) != n_before;
+}
+
+/**
+ * Forgets what is known to be in the database already, after it may have
+ * lost rows.
+ *
+ * @param be Backend struct
+ */
+static void
+forget_saved_rows( GncSqlBackend* be )
+{
+    gnc_sql_forget_saved_commodities( be );
+    gnc_sql_slots_forget_saved( be );
 }
 
 /**
@@ -64,9 +64,36 @@ struct GncSqlBackend
     gint operations_done;			/**< Number of operations (save/load) done */
     GHashTable* versions;			/**< Version number for each table */
     const gchar* timespec_format;	/**< Format string for SQL for timespec values */
+    gint insert_batch_size;		/**< Rows per multi-row INSERT while syncing or committing, < 2 disables */
+    GHashTable* pending_inserts;	/**< INSERT rows not yet sent, while syncing or committing */
+    GHashTable* saved_commodities;	/**< GUIDs of commodities known to have a row */
+    GHashTable* saved_slots;		/**< Slots of each object as last written or read */
+    gint group_depth;			/**< Nesting of gnc_sql_begin_group_commit() calls */
+    gboolean group_ok;			/**< The group commit's transaction was begun */
+    GHashTable* group_instances;	/**< Type of each instance committed in the group, by GUID */
+    gboolean is_snapshot;		/**< Read-only session reading one consistent state, holding no lock */
+    gboolean log_changes;		/**< Record each commit in the changes table for other sessions */
+    gboolean notify_changes;		/**< Also send a NOTIFY on each commit (PostgreSQL) */
+    Timespec changes_seen;		/**< Change log rows from before this time have been loaded */
+    GHashTable* statement_stats;	/**< Timings of each statement shape, while gnc.backend.sql.stats logs info */
 };
 typedef struct GncSqlBackend GncSqlBackend;
 
+/**
+ * Table in which, when the sql-change-log preference is set, each commit
+ * records the GUID, type and time of the object it wrote, so that the
+ * other sessions sharing the database can pick up the change.  It is
+ * also the PostgreSQL NOTIFY channel announcing new rows.
+ */
+#define GNC_SQL_CHANGES_TABLE "changes"
+
+/**
+ * Default number of rows gnc_sql_sync_all() and gnc_sql_commit_edit()
+ * collect into one multi-row INSERT. SQLite limits a VALUES list to 500
+ * rows by default.
+ */
+#define GNC_SQL_DEFAULT_INSERT_BATCH_SIZE 250
+
 /**
  * Initialize the SQL backend.
  *
@@ -100,6 +127,17 @@ void gnc_sql_push_commodity_for_postload_processing (GncSqlBackend *be,
  */
 void gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book );
 
+/**
+ * Save only the dirty objects of a book, inside one database
+ * transaction.  The database must already hold the book with the
+ * current schema.
+ *
+ * @param be SQL backend
+ * @param book Book to be saved
+ * @return TRUE if successful, FALSE if the transaction was rolled back
+ */
+gboolean gnc_sql_sync_dirty( GncSqlBackend* be, /*@ dependent @*/ QofBook *book );
+
 /**
  * An object is about to be edited.
  *
@@ -124,6 +162,43 @@ void gnc_sql_rollback_edit( GncSqlBackend* qbe, QofInstance *inst );
  */
 void gnc_sql_commit_edit( GncSqlBackend* qbe, QofInstance *inst );
 
+/**
+ * Starts a group of commits that are stored in one database transaction,
+ * each commit becoming a savepoint within it.  Groups may nest.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_begin_group_commit( GncSqlBackend* be );
+
+/**
+ * Ends a group of commits, committing the database transaction when the
+ * outermost group ends.  Only then are the instances committed in the
+ * group marked clean and the book saved; if the transaction fails, they
+ * are left dirty and the backend error is set.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_end_group_commit( GncSqlBackend* be );
+
+/**
+ * Whether the change log (see GNC_SQL_CHANGES_TABLE) names transactions
+ * that other sessions saved and this one hasn't loaded yet.  Always FALSE
+ * unless the sql-change-log preference is set.
+ *
+ * @param be SQL backend
+ * @return TRUE if gnc_sql_load_changes() has something to load
+ */
+gboolean gnc_sql_changes_pending( GncSqlBackend* be );
+
+/**
+ * Loads the transactions other sessions logged since the last load, with
+ * engine events suspended.
+ *
+ * @param be SQL backend
+ * @return TRUE if any transaction was loaded
+ */
+gboolean gnc_sql_load_changes( GncSqlBackend* be );
+
 /**
  */
 typedef struct GncSqlColumnTableEntry GncSqlColumnTableEntry;
@@ -651,6 +726,13 @@ void gnc_sql_add_objectref_guid_col_info_to_list( const GncSqlBackend* be,
  */
 guint gnc_sql_append_guid_list_to_sql( GString* str, GList* list, guint maxCount );
 
+/**
+ * Most GUIDs to list in one "IN (...)" clause.  Longer lists are loaded
+ * with several statements, which databases handle much better than one
+ * huge one.
+ */
+#define GNC_SQL_MAX_GUIDS_PER_STATEMENT 1000
+
 /**
  * Appends column names for a subtable to the end of a GList.
  *
@@ -672,6 +754,26 @@ void gnc_sql_add_subtable_colnames_to_list( const GncSqlColumnTableEntry* table_
  */
 gchar* gnc_sql_get_sql_value( const GncSqlConnection* conn, const GValue* value );
 
+/**
+ * Logs, to the gnc.backend.sql.stats domain at info level, the number of
+ * executions, total, mean, 99th percentile and maximum time, rows and
+ * bytes sent of each statement shape run since the statistics were last
+ * reset, most expensive first.  Statistics are only gathered while that
+ * domain logs at info level, which also logs each statement taking more
+ * than a quarter second.  They are dumped and reset when the session
+ * ends.
+ *
+ * @param be SQL backend struct
+ */
+void gnc_sql_dump_statement_stats( GncSqlBackend* be );
+
+/**
+ * Discards the statement statistics gathered so far.
+ *
+ * @param be SQL backend struct
+ */
+void gnc_sql_reset_statement_stats( GncSqlBackend* be );
+
 /**
  * Initializes DB table version information.
  *
@@ -127,6 +127,44 @@ load_single_commodity( GncSqlBackend* be, GncSqlRow* row )
     return pCommodity;
 }
 
+/* Remember which commodities have a row so that saving the many objects
+ * referring to a commodity doesn't query the database each time. */
+static void
+mark_commodity_saved( GncSqlBackend* be, const GncGUID* guid, gboolean saved )
+{
+    if ( !saved )
+    {
+        if ( be->saved_commodities != NULL )
+        {
+            (void)g_hash_table_remove( be->saved_commodities, guid );
+        }
+        return;
+    }
+    if ( be->saved_commodities == NULL )
+    {
+        be->saved_commodities = g_hash_table_new_full( guid_hash_to_guint,
+                                guid_g_hash_table_equal,
+                                (GDestroyNotify)guid_free, NULL );
+    }
+    if ( !g_hash_table_contains( be->saved_commodities, guid ) )
+    {
+        GncGUID* key = guid_malloc();
+        *key = *guid;
+        g_hash_table_add( be->saved_commodities, key );
+    }
+}
+
+void
+gnc_sql_forget_saved_commodities( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->saved_commodities != NULL )
+    {
+        g_hash_table_remove_all( be->saved_commodities );
+    }
+}
+
 static void
 load_all_commodities( GncSqlBackend* be )
 {
@@ -155,6 +193,7 @@ load_all_commodities( GncSqlBackend* be )
 
                 guid = *qof_instance_get_guid( QOF_INSTANCE(pCommodity) );
                 pCommodity = gnc_commodity_table_insert( pTable, pCommodity );
+                mark_commodity_saved( be, &guid, TRUE );
 		if (qof_instance_is_dirty (QOF_INSTANCE (pCommodity)))
 		    gnc_sql_push_commodity_for_postload_processing (be, (gpointer)pCommodity);
                 qof_instance_set_guid( QOF_INSTANCE(pCommodity), &guid );
@@ -220,6 +259,7 @@ do_commit_commodity( GncSqlBackend* be, QofInstance* inst, gboolean force_insert
         {
             is_ok = gnc_sql_slots_delete( be, guid );
         }
+        mark_commodity_saved( be, guid, op != OP_DB_DELETE );
     }
 
     return is_ok;
@@ -253,10 +293,20 @@ gnc_sql_save_commodity( GncSqlBackend* be, gnc_commodity* pCommodity )
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( pCommodity != NULL, FALSE );
 
+    if ( be->saved_commodities != NULL
+            && g_hash_table_contains( be->saved_commodities,
+                                      qof_instance_get_guid( pCommodity ) ) )
+    {
+        return TRUE;
+    }
     if ( !is_commodity_in_db( be, pCommodity ) )
     {
         is_ok = do_commit_commodity( be, QOF_INSTANCE(pCommodity), TRUE );
     }
+    else
+    {
+        mark_commodity_saved( be, qof_instance_get_guid( pCommodity ), TRUE );
+    }
 
     return is_ok;
 }
@@ -38,4 +38,13 @@ void gnc_sql_init_commodity_handler( void );
 gboolean gnc_sql_save_commodity( GncSqlBackend* be, gnc_commodity* pCommodity );
 void gnc_sql_commit_commodity (gnc_commodity* pCommodity);
 
+/**
+ * Forgets which commodities gnc_sql_save_commodity() has seen in the
+ * database.  Must be called whenever the database may have lost rows,
+ * e.g. after a rollback or when the tables are recreated.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_forget_saved_commodities( GncSqlBackend* be );
+
 #endif /* GNC_COMMODITY_SQL_H */
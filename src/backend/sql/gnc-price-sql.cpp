@@ -33,6 +33,8 @@ extern "C"
 
 #include "qof.h"
 #include "gnc-pricedb.h"
+#include "gnc-pricedb-p.h"
+#include "gnc-prefs.h"
 
 #if defined( S_SPLINT_S )
 #include "splint-defs.h"
@@ -53,6 +55,8 @@ extern "C"
 #define PRICE_MAX_SOURCE_LEN 2048
 #define PRICE_MAX_TYPE_LEN 2048
 
+#define GNC_PREF_SQL_PRICE_WINDOW_DAYS "sql-price-window-days"
+
 static const GncSqlColumnTableEntry col_table[] =
 {
     /*@ -full_init_block @*/
@@ -86,31 +90,34 @@ load_single_price( GncSqlBackend* be, GncSqlRow* row )
     return pPrice;
 }
 
+/* Adds the prices selected by sql, with their slots, to the pricedb.
+ * Prices already loaded are skipped, so that windows and lazy lookups
+ * may overlap. */
 static void
-load_all_prices( GncSqlBackend* be )
+load_prices_for_sql( GncSqlBackend* be, const gchar* sql,
+                     const gchar* subquery )
 {
-    GncSqlStatement* stmt;
     GncSqlResult* result;
-    QofBook* pBook;
     GNCPriceDB* pPriceDB;
 
     g_return_if_fail( be != NULL );
+    g_return_if_fail( sql != NULL );
 
-    pBook = be->book;
-    pPriceDB = gnc_pricedb_get_db( pBook );
-    stmt = gnc_sql_create_select_statement( be, TABLE_NAME );
-    if ( stmt != NULL )
+    pPriceDB = gnc_pricedb_get_db( be->book );
+    result = gnc_sql_execute_select_sql( be, sql );
+    if ( result != NULL )
     {
-        result = gnc_sql_execute_select_statement( be, stmt );
-        gnc_sql_statement_dispose( stmt );
-        if ( result != NULL )
+        GNCPrice* pPrice;
+        GncSqlRow* row = gnc_sql_result_get_first_row( result );
+        gboolean prev_loading = be->loading;
+
+        be->loading = TRUE;
+        gnc_pricedb_set_bulk_update( pPriceDB, TRUE );
+        while ( row != NULL )
         {
-            GNCPrice* pPrice;
-            GncSqlRow* row = gnc_sql_result_get_first_row( result );
-            gchar* sql;
+            const GncGUID* guid = gnc_sql_load_guid( be, row );
 
-            gnc_pricedb_set_bulk_update( pPriceDB, TRUE );
-            while ( row != NULL )
+            if ( guid == NULL || gnc_price_lookup( guid, be->book ) == NULL )
             {
                 pPrice = load_single_price( be, row );
 
@@ -119,16 +126,125 @@ load_all_prices( GncSqlBackend* be )
                     (void)gnc_pricedb_add_price( pPriceDB, pPrice );
                     gnc_price_unref( pPrice );
                 }
-                row = gnc_sql_result_get_next_row( result );
             }
-            gnc_sql_result_dispose( result );
-            gnc_pricedb_set_bulk_update( pPriceDB, FALSE );
+            row = gnc_sql_result_get_next_row( result );
+        }
+        gnc_sql_result_dispose( result );
+        gnc_pricedb_set_bulk_update( pPriceDB, FALSE );
 
-            sql = g_strdup_printf( "SELECT DISTINCT guid FROM %s", TABLE_NAME );
-            gnc_sql_slots_load_for_sql_subquery( be, sql, (BookLookupFn)gnc_price_lookup );
-            g_free( sql );
+        gnc_sql_slots_load_for_sql_subquery( be, subquery, (BookLookupFn)gnc_price_lookup );
+        be->loading = prev_loading;
+    }
+}
+
+/* The newest price of each pair dated before the window, which lookups
+ * just before it need without asking for the older prices. */
+#define PRICE_BOUNDARY_SQL \
+    "SELECT p.* FROM " TABLE_NAME " p INNER JOIN (SELECT commodity_guid, " \
+    "currency_guid, MAX(date) AS date FROM " TABLE_NAME " WHERE date < '%s' " \
+    "GROUP BY commodity_guid, currency_guid) b ON " \
+    "p.commodity_guid = b.commodity_guid AND " \
+    "p.currency_guid = b.currency_guid AND p.date = b.date"
+
+static void
+sql_price_lookup( QofBackend* qbe, gpointer data )
+{
+    GncSqlBackend* be = (GncSqlBackend*)qbe;
+    GNCPriceLookup* lookup = (GNCPriceLookup*)data;
+    gchar commodity_guid[GUID_ENCODING_LENGTH + 1];
+    gchar currency_guid[GUID_ENCODING_LENGTH + 1];
+    gchar* datebuf;
+    gchar* where;
+    gchar* sql;
+    gchar* subquery;
+
+    g_return_if_fail( be != NULL );
+    g_return_if_fail( lookup != NULL );
+    if ( lookup->type != LOOKUP_ALL ) return;
+
+    datebuf = gnc_sql_convert_timespec_to_string( be, lookup->date );
+    if ( lookup->commodity == NULL )
+    {
+        where = g_strdup_printf( "date < '%s'", datebuf );
+    }
+    else
+    {
+        (void)guid_to_string_buff( qof_instance_get_guid( lookup->commodity ),
+                                   commodity_guid );
+        if ( lookup->currency == NULL )
+        {
+            where = g_strdup_printf( "date < '%s' AND (commodity_guid = '%s' "
+                                     "OR currency_guid = '%s')",
+                                     datebuf, commodity_guid, commodity_guid );
+        }
+        else
+        {
+            (void)guid_to_string_buff( qof_instance_get_guid( lookup->currency ),
+                                       currency_guid );
+            where = g_strdup_printf( "date < '%s' AND ((commodity_guid = '%s' "
+                                     "AND currency_guid = '%s') OR "
+                                     "(commodity_guid = '%s' AND "
+                                     "currency_guid = '%s'))", datebuf,
+                                     commodity_guid, currency_guid,
+                                     currency_guid, commodity_guid );
         }
     }
+    g_free( datebuf );
+
+    sql = g_strdup_printf( "SELECT * FROM %s WHERE %s", TABLE_NAME, where );
+    subquery = g_strdup_printf( "SELECT DISTINCT guid FROM %s WHERE %s",
+                                TABLE_NAME, where );
+    load_prices_for_sql( be, sql, subquery );
+    g_free( subquery );
+    g_free( sql );
+    g_free( where );
+}
+
+static void
+load_all_prices( GncSqlBackend* be )
+{
+    gint window_days;
+    gchar* sql;
+    gchar* subquery;
+
+    g_return_if_fail( be != NULL );
+
+    window_days = gnc_prefs_get_int( GNC_PREFS_GROUP_GENERAL,
+                                     GNC_PREF_SQL_PRICE_WINDOW_DAYS );
+    if ( window_days <= 0 )
+    {
+        sql = g_strdup_printf( "SELECT * FROM %s", TABLE_NAME );
+        subquery = g_strdup_printf( "SELECT DISTINCT guid FROM %s", TABLE_NAME );
+        load_prices_for_sql( be, sql, subquery );
+        g_free( subquery );
+        g_free( sql );
+    }
+    else
+    {
+        /* Only load the recent prices; the pricedb asks for the
+         * others through price_lookup when it needs them. */
+        Timespec since = { gnc_time( NULL ) - (time64)window_days * 86400, 0 };
+        gchar* datebuf = gnc_sql_convert_timespec_to_string( be, since );
+
+        sql = g_strdup_printf( "SELECT * FROM %s WHERE date >= '%s'",
+                               TABLE_NAME, datebuf );
+        subquery = g_strdup_printf( "SELECT DISTINCT guid FROM %s WHERE date >= '%s'",
+                                    TABLE_NAME, datebuf );
+        load_prices_for_sql( be, sql, subquery );
+        g_free( subquery );
+        g_free( sql );
+
+        sql = g_strdup_printf( PRICE_BOUNDARY_SQL, datebuf );
+        subquery = g_strdup_printf( "SELECT DISTINCT guid FROM (" PRICE_BOUNDARY_SQL ") w",
+                                    datebuf );
+        load_prices_for_sql( be, sql, subquery );
+        g_free( subquery );
+        g_free( sql );
+        g_free( datebuf );
+
+        gnc_pricedb_set_lazy_window( gnc_pricedb_get_db( be->book ), since );
+        be->be.price_lookup = sql_price_lookup;
+    }
 }
 
 /* ================================================================= */
@@ -706,6 +706,64 @@ save_slot( const gchar* key, KvpValue* value, gpointer data )
     (void)g_string_truncate( pSlot_info->path, curlen );
 }
 
+/* Copies of the slots each object had when they were last written to or
+ * read from the database, so that committing an object whose slots didn't
+ * change doesn't delete and reinsert every one of them. */
+static void
+free_saved_slots( gpointer frame )
+{
+    delete static_cast<KvpFrame*>(frame);
+}
+
+static void
+remember_saved_slots( GncSqlBackend* be, const GncGUID* guid,
+                      const KvpFrame* frame )
+{
+    GncGUID* key;
+
+    if ( be->saved_slots == NULL )
+    {
+        be->saved_slots = g_hash_table_new_full( guid_hash_to_guint,
+                          guid_g_hash_table_equal,
+                          (GDestroyNotify)guid_free, free_saved_slots );
+    }
+    key = guid_malloc();
+    *key = *guid;
+    g_hash_table_replace( be->saved_slots, key, new KvpFrame(*frame) );
+}
+
+static gboolean
+slots_unchanged( const GncSqlBackend* be, const GncGUID* guid,
+                 const KvpFrame* frame )
+{
+    const KvpFrame* saved;
+
+    if ( be->saved_slots == NULL ) return FALSE;
+    saved = static_cast<const KvpFrame*>(g_hash_table_lookup( be->saved_slots, guid ));
+    return saved != NULL && compare( saved, frame ) == 0;
+}
+
+static void
+remember_loaded_slots( gpointer key, gpointer value, gpointer be )
+{
+    QofInstance* inst = QOF_INSTANCE(key);
+
+    remember_saved_slots( static_cast<GncSqlBackend*>(be),
+                          qof_instance_get_guid( inst ),
+                          qof_instance_get_slots( inst ) );
+}
+
+void
+gnc_sql_slots_forget_saved( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->saved_slots != NULL )
+    {
+        g_hash_table_remove_all( be->saved_slots );
+    }
+}
+
 gboolean
 gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant,
                     QofInstance *inst)
@@ -720,6 +778,11 @@ gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant,
     // If this is not saving into a new db, clear out the old saved slots first
     if ( !be->is_pristine_db && !is_infant )
     {
+        if ( slots_unchanged( be, guid, pFrame ) )
+        {
+            (void)g_string_free( slot_info.path, TRUE );
+            return TRUE;
+        }
         (void)gnc_sql_slots_delete( be, guid );
     }
 
@@ -728,6 +791,10 @@ gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant,
     pFrame->for_each_slot(save_slot, &slot_info);
     (void)g_string_free( slot_info.path, TRUE );
 
+    if ( slot_info.is_ok )
+    {
+        remember_saved_slots( be, guid, pFrame );
+    }
     return slot_info.is_ok;
 }
 
@@ -743,6 +810,10 @@ gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid )
     g_return_val_if_fail( be != NULL, FALSE );
     g_return_val_if_fail( guid != NULL, FALSE );
 
+    if ( be->saved_slots != NULL )
+    {
+        (void)g_hash_table_remove( be->saved_slots, guid );
+    }
     (void)guid_to_string_buff( guid, guid_buf );
 
     buf = g_strdup_printf( "SELECT * FROM %s WHERE obj_guid='%s' and slot_type in ('%d', '%d') and not guid_val is null",
@@ -830,6 +901,7 @@ gnc_sql_slots_load( GncSqlBackend* be, QofInstance* inst )
     info.context = NONE;
 
     slots_load_info( &info );
+    remember_saved_slots( be, info.guid, info.pKvpFrame );
 }
 
 static void
@@ -916,7 +988,8 @@ gnc_sql_slots_load_for_list( GncSqlBackend* be, GList* list )
     GncSqlStatement* stmt;
     GString* sql;
     GncSqlResult* result;
-    gboolean single_item;
+    GList* chunk;
+    GList* next;
 
     g_return_if_fail( be != NULL );
 
@@ -925,64 +998,73 @@ gnc_sql_slots_load_for_list( GncSqlBackend* be, GList* list )
 
     coll = qof_instance_get_collection( QOF_INSTANCE(list->data) );
 
-    // Create the query for all slots for all items on the list
-    sql = g_string_sized_new( 40 + (GUID_ENCODING_LENGTH + 3) * g_list_length( list ) );
-    g_string_append_printf( sql, "SELECT * FROM %s WHERE %s ", TABLE_NAME, obj_guid_col_table[0].col_name );
-    if ( g_list_length( list ) != 1 )
-    {
-        (void)g_string_append( sql, "IN (" );
-        single_item = FALSE;
-    }
-    else
-    {
-        (void)g_string_append( sql, "= " );
-        single_item = TRUE;
-    }
-    (void)gnc_sql_append_guid_list_to_sql( sql, list, G_MAXUINT );
-    if ( !single_item )
+    // Query the slots for at most GNC_SQL_MAX_GUIDS_PER_STATEMENT items at a time
+    sql = g_string_sized_new( 40 + (GUID_ENCODING_LENGTH + 3) *
+                              MIN( g_list_length( list ), GNC_SQL_MAX_GUIDS_PER_STATEMENT ) );
+    for ( chunk = list; chunk != NULL; chunk = next )
     {
-        (void)g_string_append( sql, ")" );
-    }
+        guint count;
 
-    // Execute the query and load the slots
-    stmt = gnc_sql_create_statement_from_sql( be, sql->str );
-    if ( stmt == NULL )
-    {
-        PERR( "stmt == NULL, SQL = '%s'\n", sql->str );
-        (void)g_string_free( sql, TRUE );
-        return;
-    }
-    (void)g_string_free( sql, TRUE );
-    result = gnc_sql_execute_select_statement( be, stmt );
-    gnc_sql_statement_dispose( stmt );
-    if ( result != NULL )
-    {
-        GncSqlRow* row = gnc_sql_result_get_first_row( result );
+        g_string_printf( sql, "SELECT * FROM %s WHERE %s ", TABLE_NAME, obj_guid_col_table[0].col_name );
+        if ( chunk->next != NULL )
+        {
+            (void)g_string_append( sql, "IN (" );
+        }
+        else
+        {
+            (void)g_string_append( sql, "= " );
+        }
+        count = gnc_sql_append_guid_list_to_sql( sql, chunk, GNC_SQL_MAX_GUIDS_PER_STATEMENT );
+        next = g_list_nth( chunk, count );
+        if ( chunk->next != NULL )
+        {
+            (void)g_string_append( sql, ")" );
+        }
 
-        while ( row != NULL )
+        // Execute the query and load the slots
+        stmt = gnc_sql_create_statement_from_sql( be, sql->str );
+        if ( stmt == NULL )
         {
-            load_slot_for_list_item( be, row, coll );
-            row = gnc_sql_result_get_next_row( result );
+            PERR( "stmt == NULL, SQL = '%s'\n", sql->str );
+            break;
+        }
+        result = gnc_sql_execute_select_statement( be, stmt );
+        gnc_sql_statement_dispose( stmt );
+        if ( result != NULL )
+        {
+            GncSqlRow* row = gnc_sql_result_get_first_row( result );
+
+            while ( row != NULL )
+            {
+                load_slot_for_list_item( be, row, coll );
+                row = gnc_sql_result_get_next_row( result );
+            }
+            gnc_sql_result_dispose( result );
+
+            for ( GList* node = chunk; node != next; node = node->next )
+            {
+                remember_loaded_slots( node->data, NULL, be );
+            }
         }
-        gnc_sql_result_dispose( result );
     }
+    (void)g_string_free( sql, TRUE );
 }
 
-static void
+static QofInstance*
 load_slot_for_book_object( GncSqlBackend* be, GncSqlRow* row, BookLookupFn lookup_fn )
 {
     slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID, NULL, FRAME, NULL, NULL };
     const GncGUID* guid;
     QofInstance* inst;
 
-    g_return_if_fail( be != NULL );
-    g_return_if_fail( row != NULL );
-    g_return_if_fail( lookup_fn != NULL );
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( row != NULL, NULL );
+    g_return_val_if_fail( lookup_fn != NULL, NULL );
 
     guid = load_obj_guid( be, row );
-    g_return_if_fail( guid != NULL );
+    g_return_val_if_fail( guid != NULL, NULL );
     inst = lookup_fn( guid, be->book );
-    g_return_if_fail( inst != NULL );
+    g_return_val_if_fail( inst != NULL, NULL );
 
     slot_info.be = be;
     slot_info.pKvpFrame = qof_instance_get_slots( inst );
@@ -994,6 +1076,8 @@ load_slot_for_book_object( GncSqlBackend* be, GncSqlRow* row, BookLookupFn looku
     {
         (void)g_string_free( slot_info.path, TRUE );
     }
+
+    return inst;
 }
 
 /**
@@ -1035,13 +1119,21 @@ void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subque
     if ( result != NULL )
     {
         GncSqlRow* row = gnc_sql_result_get_first_row( result );
+        GHashTable* loaded = g_hash_table_new( g_direct_hash, g_direct_equal );
 
         while ( row != NULL )
         {
-            load_slot_for_book_object( be, row, lookup_fn );
+            QofInstance* inst = load_slot_for_book_object( be, row, lookup_fn );
+            if ( inst != NULL )
+            {
+                g_hash_table_add( loaded, inst );
+            }
             row = gnc_sql_result_get_next_row( result );
         }
         gnc_sql_result_dispose( result );
+
+        g_hash_table_foreach( loaded, remember_loaded_slots, be );
+        g_hash_table_destroy( loaded );
     }
 }
 
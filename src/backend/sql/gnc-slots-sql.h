@@ -57,6 +57,15 @@ gboolean gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid,
  */
 gboolean gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid );
 
+/**
+ * gnc_sql_slots_forget_saved - Forgets the slots last written or read for
+ * each object, so that the next gnc_sql_slots_save() rewrites them.  Must be
+ * called whenever the database may have lost rows, e.g. after a rollback.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_forget_saved( GncSqlBackend* be );
+
 /** Loads slots for an object from the db.
  *
  * @param be SQL backend
@@ -47,22 +47,25 @@ extern "C"
 #endif
 }
 
-#include "escape.h"
-
 #include "gnc-backend-sql.h"
 #include "gnc-transaction-sql.h"
 #include "gnc-commodity-sql.h"
 #include "gnc-slots-sql.h"
 
-#define SIMPLE_QUERY_COMPILATION 1
+/* When set, opening a book loads only the accounts, with starting balances
+ * summed by the database, and transactions are loaded by the queries that
+ * need them (registers, reports, finds).  Build with
+ * -DLOAD_TRANSACTIONS_AS_NEEDED=1 to enable it. */
+#ifndef LOAD_TRANSACTIONS_AS_NEEDED
 #define LOAD_TRANSACTIONS_AS_NEEDED 0
+#endif
 
 static QofLogModule log_module = G_LOG_DOMAIN;
 
 #define TRANSACTION_TABLE "transactions"
-#define TX_TABLE_VERSION 3
+#define TX_TABLE_VERSION 4
 #define SPLIT_TABLE "splits"
-#define SPLIT_TABLE_VERSION 4
+#define SPLIT_TABLE_VERSION 5
 
 typedef struct
 {
@@ -126,6 +129,17 @@ static const GncSqlColumnTableEntry post_date_col_table[] =
     /*@ +full_init_block @*/
 };
 
+/* Covers the post_date ordering and range tests of the generated
+ * queries, which join back to splits through the guid. */
+static const GncSqlColumnTableEntry post_date_guid_col_table[] =
+{
+    /*@ -full_init_block @*/
+    { "post_date", CT_TIMESPEC, 0, 0,        "post-date" },
+    { "guid",      CT_GUID,     0, COL_NNUL, "guid" },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
 static const GncSqlColumnTableEntry account_guid_col_table[] =
 {
     /*@ -full_init_block @*/
@@ -142,6 +156,89 @@ static const GncSqlColumnTableEntry tx_guid_col_table[] =
     /*@ +full_init_block @*/
 };
 
+/* Covers the per-account lookups: the transaction guids of an account,
+ * optionally restricted by reconcile state, and the balance grouping,
+ * can all be answered from the index alone. */
+static const GncSqlColumnTableEntry account_reconcile_tx_col_table[] =
+{
+    /*@ -full_init_block @*/
+    { "account_guid",    CT_ACCOUNTREF, 0, COL_NNUL, "account" },
+    { "reconcile_state", CT_STRING,     1, COL_NNUL, NULL },
+    { "tx_guid",         CT_TXREF,      0, COL_NNUL, "transaction" },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
+/* The columns of split_col_table loaded by load_single_split, which sets
+ * the guid and the references itself.  Keep them in step. */
+static const GncSqlColumnTableEntry split_data_col_table[] =
+{
+    /*@ -full_init_block @*/
+    { "memo",            CT_STRING,       SPLIT_MAX_MEMO_LEN,   COL_NNUL,          "memo" },
+    { "action",          CT_STRING,       SPLIT_MAX_ACTION_LEN, COL_NNUL,          "action" },
+    {
+        "reconcile_state", CT_STRING,       1,                    COL_NNUL,          NULL, NULL,
+        (QofAccessFunc)get_split_reconcile_state, set_split_reconcile_state
+    },
+    { "reconcile_date",  CT_TIMESPEC,     0,                    0,                 "reconcile-date" },
+    { "value",           CT_NUMERIC,      0,                    COL_NNUL,          "value" },
+    { "quantity",        CT_NUMERIC,      0,                    COL_NNUL,          "amount" },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
+static const GncSqlColumnTableEntry split_tx_col_table[] =
+{
+    /*@ -full_init_block @*/
+    { "tx_guid", CT_TXREF, 0, COL_NNUL, "transaction" },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
+static const GncSqlColumnTableEntry split_lot_col_table[] =
+{
+    /*@ -full_init_block @*/
+    {
+        "lot_guid",        CT_LOTREF,       0,                    0,                 NULL, NULL,
+        (QofAccessFunc)xaccSplitGetLot, set_split_lot
+    },
+    { NULL }
+    /*@ +full_init_block @*/
+};
+
+/* The guid columns of a split row, in the order lookup_result_refs
+ * returns their entities. */
+typedef enum
+{
+    SPLIT_REF_SPLIT,
+    SPLIT_REF_TX,
+    SPLIT_REF_ACCOUNT,
+    SPLIT_REF_LOT,
+    SPLIT_N_REFS
+} split_ref_t;
+
+typedef struct
+{
+    const gchar* col_name;
+    QofIdTypeConst type;
+} ref_col_t;
+
+static const ref_col_t split_ref_cols[SPLIT_N_REFS] =
+{
+    { "guid",         GNC_ID_SPLIT },
+    { "tx_guid",      GNC_ID_TRANS },
+    { "account_guid", GNC_ID_ACCOUNT },
+    { "lot_guid",     GNC_ID_LOT }
+};
+
+static const ref_col_t tx_ref_cols[] =
+{
+    { "guid", GNC_ID_TRANS }
+};
+
+/* Rows whose references are looked up together */
+#define REF_LOOKUP_BATCH 1024
+
 /* ================================================================= */
 
 static /*@ dependent @*//*@ null @*/ gpointer
@@ -187,8 +284,106 @@ set_split_lot( gpointer pObject, /*@ null @*/ gpointer pLot )
     gnc_lot_add_split( lot, split );
 }
 
+/* Reads a guid column of the row, or the null guid if it is empty. */
+static void
+load_row_guid( GncSqlRow* row, const gchar* col_name, GncGUID* guid )
+{
+    const GValue* val = gnc_sql_row_get_value_at_col_name( row, col_name );
+
+    if ( val == NULL || !G_VALUE_HOLDS_STRING( val ) ||
+            g_value_get_string( val ) == NULL ||
+            !string_to_guid( g_value_get_string( val ), guid ) )
+    {
+        *guid = *guid_null();
+    }
+}
+
+/**
+ * Looks up the entities the guid columns of every row of the result
+ * refer to, REF_LOOKUP_BATCH rows at a time, rather than one column of
+ * one row at a time.  The result is read once here, and once more by the
+ * caller to load the rows.
+ *
+ * @param be SQL backend
+ * @param result Result of a select
+ * @param cols The guid columns and the types they refer to
+ * @param n_cols Number of columns
+ * @param num_rows Where the number of rows read is stored
+ * @return The entity of column k of row i at [i * n_cols + k], NULL if
+ * none is loaded; freed with g_free()
+ */
+static QofInstance**
+lookup_result_refs( GncSqlBackend* be, GncSqlResult* result,
+                    const ref_col_t* cols, guint n_cols, guint* num_rows )
+{
+    guint rows = gnc_sql_result_get_num_rows( result );
+    QofInstance** refs = g_new0( QofInstance*, rows * n_cols + 1 );
+    GncGUID* guids = g_new( GncGUID, REF_LOOKUP_BATCH * n_cols );
+    QofInstance** found = g_new( QofInstance*, REF_LOOKUP_BATCH );
+    GncSqlRow* row = gnc_sql_result_get_first_row( result );
+    guint base = 0;
+
+    while ( row != NULL && base < rows )
+    {
+        guint n, i, k;
+
+        for ( n = 0; row != NULL && n < REF_LOOKUP_BATCH && base + n < rows; n++ )
+        {
+            for ( k = 0; k < n_cols; k++ )
+                load_row_guid( row, cols[k].col_name, &guids[k * REF_LOOKUP_BATCH + n] );
+            row = gnc_sql_result_get_next_row( result );
+        }
+        for ( k = 0; k < n_cols; k++ )
+        {
+            QofCollection* col = qof_book_get_collection( be->book, cols[k].type );
+
+            (void)qof_collection_lookup_entities( col, &guids[k * REF_LOOKUP_BATCH],
+                                                  n, found );
+            for ( i = 0; i < n; i++ )
+                refs[(base + i) * n_cols + k] = found[i];
+        }
+        base += n;
+    }
+    g_free( found );
+    g_free( guids );
+
+    *num_rows = base;
+    return refs;
+}
+
+/* Sets the split's transaction and account to the entities looked up
+ * for its row.  Those that weren't found go through the column handlers,
+ * which load a missing transaction and warn about a missing account. */
+static void
+load_split_parents( GncSqlBackend* be, GncSqlRow* row, Split* pSplit,
+                    QofInstance* const* refs )
+{
+    if ( refs[SPLIT_REF_TX] != NULL )
+    {
+        qof_instance_increase_editlevel( pSplit );
+        g_object_set( pSplit, "transaction", refs[SPLIT_REF_TX], NULL );
+        qof_instance_decrease_editlevel( pSplit );
+    }
+    else
+    {
+        gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, split_tx_col_table );
+    }
+    if ( refs[SPLIT_REF_ACCOUNT] != NULL )
+    {
+        qof_instance_increase_editlevel( pSplit );
+        g_object_set( pSplit, "account", refs[SPLIT_REF_ACCOUNT], NULL );
+        qof_instance_decrease_editlevel( pSplit );
+    }
+    else
+    {
+        gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, account_guid_col_table );
+    }
+}
+
+/* Loads a split from the row, given the entities lookup_result_refs
+ * found for the row's split_ref_cols. */
 static /*@ null @*/ Split*
-load_single_split( GncSqlBackend* be, GncSqlRow* row )
+load_single_split( GncSqlBackend* be, GncSqlRow* row, QofInstance* const* refs )
 {
     const GncGUID* guid;
     GncGUID split_guid;
@@ -209,22 +404,29 @@ load_single_split( GncSqlBackend* be, GncSqlRow* row )
     else
     {
 	split_guid = *guid;
-	pSplit = xaccSplitLookup( &split_guid, be->book );
+	pSplit = GNC_SPLIT(refs[SPLIT_REF_SPLIT]);
     }
 
     if ( pSplit == NULL )
     {
-	pSplit = xaccMallocSplit( be->book );
+	pSplit = xaccMallocSplitWithGUID( be->book, &split_guid );
     }
 
-    /* If the split is dirty, don't overwrite it */
+    /* If the split is dirty, don't overwrite it.  The account is set
+     * before the amount, which is rounded to its commodity. */
     if ( !qof_instance_is_dirty( QOF_INSTANCE(pSplit) ) )
     {
-        gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, split_col_table );
+        load_split_parents( be, row, pSplit, refs );
+        gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, split_data_col_table );
+        if ( refs[SPLIT_REF_LOT] != NULL )
+            set_split_lot( pSplit, refs[SPLIT_REF_LOT] );
+        else
+            gnc_sql_load_object( be, row, GNC_ID_SPLIT, pSplit, split_lot_col_table );
     }
 
     /*# -ifempty */
-    if (pSplit != xaccSplitLookup( &split_guid, be->book ))
+    if (pSplit != GNC_SPLIT(refs[SPLIT_REF_SPLIT]) &&
+        pSplit != xaccSplitLookup( &split_guid, be->book ))
     {
         gchar guidstr[GUID_ENCODING_LENGTH+1];
         guid_to_string_buff(qof_instance_get_guid(pSplit), guidstr);
@@ -235,53 +437,105 @@ load_single_split( GncSqlBackend* be, GncSqlRow* row )
     return pSplit;
 }
 
+/* Runs a split query, prepending the splits loaded to *split_list.  The
+ * splits, transactions, accounts and lots the rows refer to are looked
+ * up for the whole result first. */
 static void
-load_splits_for_tx_list( GncSqlBackend* be, GList* list )
+load_splits_for_sql( GncSqlBackend* be, const gchar* sql, GList** split_list )
 {
-    GString* sql;
     GncSqlResult* result;
 
-    g_return_if_fail( be != NULL );
-
-    if ( list == NULL ) return;
-
-    sql = g_string_sized_new( 40 + (GUID_ENCODING_LENGTH + 3) * g_list_length( list ) );
-    g_string_append_printf( sql, "SELECT * FROM %s WHERE %s IN (", SPLIT_TABLE, tx_guid_col_table[0].col_name );
-    (void)gnc_sql_append_guid_list_to_sql( sql, list, G_MAXUINT );
-    (void)g_string_append( sql, ")" );
-
-    // Execute the query and load the splits
-    result = gnc_sql_execute_select_sql( be, sql->str );
+    result = gnc_sql_execute_select_sql( be, sql );
     if ( result != NULL )
     {
-        GList* split_list = NULL;
+        QofInstance** refs;
         GncSqlRow* row;
+        guint num_rows;
+        guint i = 0;
 
+        refs = lookup_result_refs( be, result, split_ref_cols, SPLIT_N_REFS,
+                                   &num_rows );
         row = gnc_sql_result_get_first_row( result );
-        while ( row != NULL )
+        while ( row != NULL && i < num_rows )
         {
             Split* s;
-            s = load_single_split( be, row );
+            s = load_single_split( be, row, &refs[i++ * SPLIT_N_REFS] );
             if ( s != NULL )
             {
-                split_list = g_list_prepend( split_list, s );
+                *split_list = g_list_prepend( *split_list, s );
             }
             row = gnc_sql_result_get_next_row( result );
         }
+        g_free( refs );
+        gnc_sql_result_dispose( result );
+    }
+}
 
-        if ( split_list != NULL )
+/* Loads the splits, and their slots, of the transactions on the list.  If
+ * tx_subquery isn't NULL it selects the guids of exactly those
+ * transactions, and is used instead of listing every guid in the SQL. */
+static void
+load_splits_for_tx_list( GncSqlBackend* be, GList* list,
+                         /*@ null @*/ const gchar* tx_subquery )
+{
+    GString* sql;
+    GList* split_list = NULL;
+
+    g_return_if_fail( be != NULL );
+
+    if ( list == NULL ) return;
+
+    if ( tx_subquery != NULL )
+    {
+        sql = g_string_new( NULL );
+        g_string_printf( sql, "SELECT * FROM %s WHERE %s IN (%s)", SPLIT_TABLE,
+                         tx_guid_col_table[0].col_name, tx_subquery );
+        load_splits_for_sql( be, sql->str, &split_list );
+    }
+    else
+    {
+        GList* chunk = list;
+
+        sql = g_string_sized_new( 40 + (GUID_ENCODING_LENGTH + 3) *
+                                  MIN( g_list_length( list ), GNC_SQL_MAX_GUIDS_PER_STATEMENT ) );
+        while ( chunk != NULL )
         {
-            gnc_sql_slots_load_for_list( be, split_list );
-            g_list_free( split_list );
+            guint count;
+
+            g_string_printf( sql, "SELECT * FROM %s WHERE %s IN (", SPLIT_TABLE, tx_guid_col_table[0].col_name );
+            count = gnc_sql_append_guid_list_to_sql( sql, chunk, GNC_SQL_MAX_GUIDS_PER_STATEMENT );
+            (void)g_string_append( sql, ")" );
+            load_splits_for_sql( be, sql->str, &split_list );
+            chunk = g_list_nth( chunk, count );
         }
+    }
 
-        gnc_sql_result_dispose( result );
+    if ( split_list != NULL )
+    {
+        if ( tx_subquery != NULL )
+        {
+            gchar* split_subquery =
+                g_strdup_printf( "SELECT guid FROM %s WHERE %s IN (%s)",
+                                 SPLIT_TABLE, tx_guid_col_table[0].col_name,
+                                 tx_subquery );
+            gnc_sql_slots_load_for_sql_subquery( be, split_subquery,
+                                                 (BookLookupFn)xaccSplitLookup );
+            g_free( split_subquery );
+        }
+        else
+        {
+            gnc_sql_slots_load_for_list( be, split_list );
+        }
+        g_list_free( split_list );
     }
     (void)g_string_free( sql, TRUE );
 }
 
+/* Loads a transaction from the row, unless lookup_result_refs found it
+ * already loaded. */
 static /*@ null @*/ Transaction*
-load_single_tx( GncSqlBackend* be, GncSqlRow* row )
+load_single_tx( GncSqlBackend* be, GncSqlRow* row,
+                /*@ null @*/ QofInstance* loaded )
 {
     const GncGUID* guid;
     GncGUID tx_guid;
@@ -290,18 +544,17 @@ load_single_tx( GncSqlBackend* be, GncSqlRow* row )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( row != NULL, NULL );
 
-    guid = gnc_sql_load_guid( be, row );
-    if ( guid == NULL ) return NULL;
-    tx_guid = *guid;
-
     // Don't overwrite the transaction if it's already been loaded (and possibly modified).
-    pTx = xaccTransLookup( &tx_guid, be->book );
-    if ( pTx != NULL )
+    if ( loaded != NULL )
     {
         return NULL;
     }
 
-    pTx = xaccMallocTransaction( be->book );
+    guid = gnc_sql_load_guid( be, row );
+    if ( guid == NULL ) return NULL;
+    tx_guid = *guid;
+
+    pTx = xaccMallocTransactionWithGUID( be->book, &tx_guid );
     xaccTransBeginEdit( pTx );
     gnc_sql_load_object( be, row, GNC_ID_TRANS, pTx, tx_col_table );
 
@@ -334,15 +587,66 @@ typedef struct
     gnc_numeric end_reconciled_bal;
 } full_acct_balances_t;
 
+#if LOAD_TRANSACTIONS_AS_NEEDED
+/**
+ * Saves the start/end balances for an account.
+ *
+ * @param acc Account
+ * @param pData GSList** of full_acct_balances_t structures to prepend to
+ */
+static void
+save_account_balances( Account* acc, gpointer pData )
+{
+    GSList** pBal_list = (GSList**)pData;
+    full_acct_balances_t* newbal;
+    gnc_numeric* pstart;
+    gnc_numeric* pend;
+    gnc_numeric* pstart_c;
+    gnc_numeric* pend_c;
+    gnc_numeric* pstart_r;
+    gnc_numeric* pend_r;
+
+    g_object_get( acc,
+                  "start-balance", &pstart,
+                  "end-balance", &pend,
+                  "start-cleared-balance", &pstart_c,
+                  "end-cleared-balance", &pend_c,
+                  "start-reconciled-balance", &pstart_r,
+                  "end-reconciled-balance", &pend_r,
+                  NULL );
+
+    newbal = g_new( full_acct_balances_t, 1 );
+    newbal->acc = acc;
+    newbal->start_bal = *pstart;
+    newbal->end_bal = *pend;
+    newbal->start_cleared_bal = *pstart_c;
+    newbal->end_cleared_bal = *pend_c;
+    newbal->start_reconciled_bal = *pstart_r;
+    newbal->end_reconciled_bal = *pend_r;
+    *pBal_list = g_slist_prepend( *pBal_list, newbal );
+
+    g_free( pstart );
+    g_free( pend );
+    g_free( pstart_c );
+    g_free( pend_c );
+    g_free( pstart_r );
+    g_free( pend_r );
+}
+#endif
+
 /**
  * Executes a transaction query statement and loads the transactions and all
  * of the splits.
  *
  * @param be SQL backend
  * @param stmt SQL statement
+ * @param tx_subquery NULL, or SQL selecting the guids of the transactions
+ * stmt returns.  The splits and slots are then selected with it, and the
+ * database needn't parse a list of every guid loaded.
  */
 static void
-query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
+query_transactions( GncSqlBackend* be, GncSqlStatement* stmt,
+                    /*@ null @*/ const gchar* tx_subquery )
 {
     GncSqlResult* result;
 
@@ -356,6 +660,9 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
         GList* node;
         GncSqlRow* row;
         Transaction* tx;
+        QofInstance** refs;
+        guint num_rows;
+        guint i = 0;
 #if LOAD_TRANSACTIONS_AS_NEEDED
         GSList* bal_list = NULL;
         GSList* nextbal;
@@ -366,29 +673,50 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
 
         // Save the start/ending balances (balance, cleared and reconciled) for
         // every account.
-        gnc_account_foreach_descendant( gnc_book_get_root_account( be->primary_book ),
-                                        save_account_balances,
+        gnc_account_foreach_descendant( root, save_account_balances,
                                         &bal_list );
 #endif
 
-        // Load the transactions
+        // Append the splits to their accounts unsorted and sort each
+        // account once at the end, rather than finding every split's
+        // place as it arrives.
+        gnc_account_begin_bulk_ingest( be->book );
+
+        // Load the transactions, looking up those already loaded for the
+        // whole result first
+        refs = lookup_result_refs( be, result, tx_ref_cols,
+                                   G_N_ELEMENTS( tx_ref_cols ), &num_rows );
         row = gnc_sql_result_get_first_row( result );
-        while ( row != NULL )
+        while ( row != NULL && i < num_rows )
         {
-            tx = load_single_tx( be, row );
+            tx = load_single_tx( be, row, refs[i++] );
             if ( tx != NULL )
             {
                 tx_list = g_list_prepend( tx_list, tx );
             }
+            else
+            {
+                // Skipped: the subquery would reload its splits too
+                tx_subquery = NULL;
+            }
             row = gnc_sql_result_get_next_row( result );
         }
+        g_free( refs );
         gnc_sql_result_dispose( result );
 
         // Load all splits and slots for the transactions
         if ( tx_list != NULL )
         {
-            gnc_sql_slots_load_for_list( be, tx_list );
-            load_splits_for_tx_list( be, tx_list );
+            if ( tx_subquery != NULL )
+            {
+                gnc_sql_slots_load_for_sql_subquery( be, tx_subquery,
+                                                     (BookLookupFn)xaccTransLookup );
+            }
+            else
+            {
+                gnc_sql_slots_load_for_list( be, tx_list );
+            }
+            load_splits_for_tx_list( be, tx_list, tx_subquery );
         }
 
         // Commit all of the transactions
@@ -398,6 +726,7 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
             xaccTransCommitEdit( pTx );
         }
         g_list_free( tx_list );
+        gnc_account_end_bulk_ingest( be->book );
 
 #if LOAD_TRANSACTIONS_AS_NEEDED
         // Update the account balances based on the loaded splits.  If the end
@@ -418,7 +747,7 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
                           "end-reconciled-balance", &pnew_end_r_bal,
                           NULL );
 
-	    qof_instance_increase_editlevel (balns-acc);
+	    qof_instance_increase_editlevel (balns->acc);
             if ( !gnc_numeric_eq( *pnew_end_bal, balns->end_bal ) )
             {
                 adj = gnc_numeric_sub( balns->end_bal, *pnew_end_bal,
@@ -426,7 +755,6 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
                 balns->start_bal = gnc_numeric_add( balns->start_bal, adj,
                                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 g_object_set( balns->acc, "start-balance", &balns->start_bal, NULL );
-		qof_instance_decrease_editlevel (balns-acc);
             }
             if ( !gnc_numeric_eq( *pnew_end_c_bal, balns->end_cleared_bal ) )
             {
@@ -444,7 +772,7 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
                                               GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 g_object_set( balns->acc, "start-reconciled-balance", &balns->start_reconciled_bal, NULL );
             }
-	    qof_instance_decrease_editlevel (balns-acc);
+	    qof_instance_decrease_editlevel (balns->acc);
             xaccAccountRecomputeBalance( balns->acc );
             g_free( pnew_end_bal );
             g_free( pnew_end_c_bal );
@@ -485,14 +813,28 @@ create_transaction_tables( GncSqlBackend* be )
         {
             PERR( "Unable to create index\n" );
         }
+        ok = gnc_sql_create_index( be, "tx_post_date_guid_index", TRANSACTION_TABLE, post_date_guid_col_table );
+        if ( !ok )
+        {
+            PERR( "Unable to create index\n" );
+        }
     }
     else if ( version < TX_TABLE_VERSION )
     {
         /* Upgrade:
             1->2: 64 bit int handling
         	2->3: allow dates to be NULL
+            3->4: covering post_date index
         */
-        gnc_sql_upgrade_table( be, TRANSACTION_TABLE, tx_col_table );
+        if ( version < 3 )
+        {
+            gnc_sql_upgrade_table( be, TRANSACTION_TABLE, tx_col_table );
+        }
+        ok = gnc_sql_create_index( be, "tx_post_date_guid_index", TRANSACTION_TABLE, post_date_guid_col_table );
+        if ( !ok )
+        {
+            PERR( "Unable to create index\n" );
+        }
         (void)gnc_sql_set_table_version( be, TRANSACTION_TABLE, TX_TABLE_VERSION );
         PINFO("Transactions table upgraded from version %d to version %d\n", version, TX_TABLE_VERSION);
     }
@@ -511,20 +853,34 @@ create_transaction_tables( GncSqlBackend* be )
         {
             PERR( "Unable to create index\n" );
         }
+        ok = gnc_sql_create_index( be, "splits_account_reconcile_index", SPLIT_TABLE, account_reconcile_tx_col_table );
+        if ( !ok )
+        {
+            PERR( "Unable to create index\n" );
+        }
     }
     else if ( version < SPLIT_TABLE_VERSION )
     {
 
         /* Upgrade:
            1->2: 64 bit int handling
-           3->4: Split reconcile date can be NULL */
-        gnc_sql_upgrade_table( be, SPLIT_TABLE, split_col_table );
-        ok = gnc_sql_create_index( be, "splits_tx_guid_index", SPLIT_TABLE, tx_guid_col_table );
-        if ( !ok )
+           3->4: Split reconcile date can be NULL
+           4->5: covering account/reconcile state index */
+        if ( version < 4 )
         {
-            PERR( "Unable to create index\n" );
+            gnc_sql_upgrade_table( be, SPLIT_TABLE, split_col_table );
+            ok = gnc_sql_create_index( be, "splits_tx_guid_index", SPLIT_TABLE, tx_guid_col_table );
+            if ( !ok )
+            {
+                PERR( "Unable to create index\n" );
+            }
+            ok = gnc_sql_create_index( be, "splits_account_guid_index", SPLIT_TABLE, account_guid_col_table );
+            if ( !ok )
+            {
+                PERR( "Unable to create index\n" );
+            }
         }
-        ok = gnc_sql_create_index( be, "splits_account_guid_index", SPLIT_TABLE, account_guid_col_table );
+        ok = gnc_sql_create_index( be, "splits_account_reconcile_index", SPLIT_TABLE, account_reconcile_tx_col_table );
         if ( !ok )
         {
             PERR( "Unable to create index\n" );
@@ -823,8 +1179,12 @@ void gnc_sql_transaction_load_tx_for_account( GncSqlBackend* be, Account* accoun
     g_free( query_sql );
     if ( stmt != NULL )
     {
-        query_transactions( be, stmt );
+        gchar* tx_subquery =
+            g_strdup_printf( "SELECT DISTINCT tx_guid FROM %s WHERE account_guid='%s'",
+                             SPLIT_TABLE, guid_buf );
+        query_transactions( be, stmt, tx_subquery );
         gnc_sql_statement_dispose( stmt );
+        g_free( tx_subquery );
     }
 }
 
@@ -846,243 +1206,377 @@ void gnc_sql_transaction_load_all_tx( GncSqlBackend* be )
     g_free( query_sql );
     if ( stmt != NULL )
     {
-        query_transactions( be, stmt );
+        gchar* tx_subquery = g_strdup_printf( "SELECT guid FROM %s",
+                                              TRANSACTION_TABLE );
+        query_transactions( be, stmt, tx_subquery );
         gnc_sql_statement_dispose( stmt );
+        g_free( tx_subquery );
     }
 }
 
-static void
-convert_query_comparison_to_sql( QofQueryPredData* pPredData, gboolean isInverted, GString* sql )
+/**
+ * Loads the transactions other sessions added to the change log since
+ * a time.
+ *
+ * @param be SQL backend
+ * @param since Earliest change time of interest
+ */
+void gnc_sql_transaction_load_changed_since( GncSqlBackend* be, Timespec since )
 {
-    if ( pPredData->how == QOF_COMPARE_LT
-            || ( isInverted && pPredData->how == QOF_COMPARE_GTE ) )
+    gchar* datebuf;
+    gchar* tx_subquery;
+    gchar* query_sql;
+    GncSqlStatement* stmt;
+
+    g_return_if_fail( be != NULL );
+
+    datebuf = gnc_sql_convert_timespec_to_string( be, since );
+    tx_subquery = g_strdup_printf( "SELECT DISTINCT obj_guid FROM %s WHERE obj_type='%s' AND destroyed=0 AND change_time>='%s'",
+                                   GNC_SQL_CHANGES_TABLE, GNC_ID_TRANS, datebuf );
+    g_free( datebuf );
+    query_sql = g_strdup_printf( "SELECT * FROM %s WHERE guid IN (%s)",
+                                 TRANSACTION_TABLE, tx_subquery );
+    stmt = gnc_sql_create_statement_from_sql( be, query_sql );
+    g_free( query_sql );
+    if ( stmt != NULL )
     {
-        g_string_append( sql, "<" );
+        query_transactions( be, stmt, tx_subquery );
+        gnc_sql_statement_dispose( stmt );
     }
-    else if ( pPredData->how == QOF_COMPARE_LTE
-              || ( isInverted && pPredData->how == QOF_COMPARE_GT ) )
+    g_free( tx_subquery );
+}
+
+/* How faithfully a query term was translated to SQL.  The rows the
+ * statement selects are only loaded; the query itself is still run over
+ * them in memory, so a translation may select more rows than match, but
+ * never fewer. */
+typedef enum
+{
+    SQL_TERM_NONE,          /* not translated, any row may match */
+    SQL_TERM_SUPERSET,      /* selects at least the matching rows */
+    SQL_TERM_EXACT          /* selects exactly the matching rows */
+} SqlTermMatch;
+
+/* The split and transaction columns holding each split parameter path */
+typedef struct
+{
+    const gchar* param;
+    /*@ null @*/ const gchar* sub_param;
+    const gchar* column;
+} split_query_column_t;
+
+static const split_query_column_t split_query_columns[] =
+{
+    { QOF_PARAM_GUID,        NULL,               "s.guid" },
+    { SPLIT_ACCOUNT,         QOF_PARAM_GUID,     "s.account_guid" },
+    { SPLIT_TRANS,           QOF_PARAM_GUID,     "s.tx_guid" },
+    { SPLIT_LOT,             QOF_PARAM_GUID,     "s.lot_guid" },
+    { SPLIT_MEMO,            NULL,               "s.memo" },
+    { SPLIT_ACTION,          NULL,               "s.action" },
+    { SPLIT_RECONCILE,       NULL,               "s.reconcile_state" },
+    { SPLIT_DATE_RECONCILED, NULL,               "s.reconcile_date" },
+    { SPLIT_VALUE,           NULL,               "s.value" },
+    { SPLIT_AMOUNT,          NULL,               "s.quantity" },
+    { SPLIT_TRANS,           TRANS_DATE_POSTED,  "t.post_date" },
+    { SPLIT_TRANS,           TRANS_DATE_ENTERED, "t.enter_date" },
+    { SPLIT_TRANS,           TRANS_DESCRIPTION,  "t.description" },
+    { SPLIT_TRANS,           TRANS_NUM,          "t.num" },
+    { NULL }
+};
+
+static /*@ null @*/ const gchar*
+split_query_column( GSList* paramPath )
+{
+    const split_query_column_t* col;
+
+    for ( col = split_query_columns; col->param != NULL; col++ )
     {
-        g_string_append( sql, "<=" );
+        if ( g_strcmp0( static_cast<const gchar*>(paramPath->data), col->param ) != 0 )
+            continue;
+        if ( col->sub_param == NULL && paramPath->next == NULL )
+            return col->column;
+        if ( col->sub_param != NULL && paramPath->next != NULL &&
+                paramPath->next->next == NULL &&
+                g_strcmp0( static_cast<const gchar*>(paramPath->next->data),
+                           col->sub_param ) == 0 )
+            return col->column;
     }
-    else if ( pPredData->how == QOF_COMPARE_EQUAL
-              || ( isInverted && pPredData->how == QOF_COMPARE_NEQ ) )
+    return NULL;
+}
+
+static const gchar*
+convert_query_comparison_to_sql( QofQueryCompare how )
+{
+    switch ( how )
     {
-        g_string_append( sql, "=" );
+    case QOF_COMPARE_LT:
+        return "<";
+    case QOF_COMPARE_LTE:
+        return "<=";
+    case QOF_COMPARE_EQUAL:
+        return "=";
+    case QOF_COMPARE_GT:
+        return ">";
+    case QOF_COMPARE_GTE:
+        return ">=";
+    case QOF_COMPARE_NEQ:
+        return "<>";
+    default:
+        return NULL;
     }
-    else if ( pPredData->how == QOF_COMPARE_GT
-              || ( isInverted && pPredData->how == QOF_COMPARE_LTE ) )
+}
+
+static gboolean
+append_quoted_string( const GncSqlBackend* be, GString* sql, const gchar* str )
+{
+    gchar* quoted = gnc_sql_connection_quote_string( be->conn,
+                                                     const_cast<gchar*>(str) );
+    if ( quoted == NULL ) return FALSE;
+    g_string_append( sql, quoted );
+    g_free( quoted );
+    return TRUE;
+}
+
+static SqlTermMatch
+convert_guid_term_to_sql( const gchar* fieldName, query_guid_t guid_data,
+                          GString* sql )
+{
+    GList* guid_entry;
+    gboolean any = guid_data->options == QOF_GUID_MATCH_ANY;
+
+    if ( !any && guid_data->options != QOF_GUID_MATCH_NONE )
+        return SQL_TERM_NONE;
+    if ( guid_data->guids == NULL )
     {
-        g_string_append( sql, ">" );
+        g_string_append( sql, any ? "1=0" : "1=1" );
+        return SQL_TERM_EXACT;
     }
-    else if ( pPredData->how == QOF_COMPARE_GTE
-              || ( isInverted && pPredData->how == QOF_COMPARE_LT ) )
+
+    g_string_append_printf( sql, "COALESCE(%s,'') %s (", fieldName,
+                            any ? "IN" : "NOT IN" );
+    for ( guid_entry = guid_data->guids; guid_entry != NULL; guid_entry = guid_entry->next )
     {
-        g_string_append( sql, ">=" );
+        gchar guid_buf[GUID_ENCODING_LENGTH+1];
+
+        if ( guid_entry != guid_data->guids ) g_string_append( sql, "," );
+        (void)guid_to_string_buff(static_cast<GncGUID*>(guid_entry->data),
+                                  guid_buf );
+        g_string_append_printf( sql, "'%s'", guid_buf );
     }
-    else if ( pPredData->how == QOF_COMPARE_NEQ
-              || ( isInverted && pPredData->how == QOF_COMPARE_EQUAL ) )
+    g_string_append( sql, ")" );
+    return SQL_TERM_EXACT;
+}
+
+static SqlTermMatch
+convert_char_term_to_sql( const gchar* fieldName, query_char_t char_data,
+                          GString* sql )
+{
+    gboolean any = char_data->options == QOF_CHAR_MATCH_ANY;
+    int i;
+
+    if ( !any && char_data->options != QOF_CHAR_MATCH_NONE )
+        return SQL_TERM_NONE;
+    if ( char_data->char_list[0] == '\0' )
     {
-        g_string_append( sql, "~=" );
+        g_string_append( sql, any ? "1=0" : "1=1" );
+        return SQL_TERM_EXACT;
     }
-    else
+
+    g_string_append_printf( sql, "COALESCE(%s,'') %s (", fieldName,
+                            any ? "IN" : "NOT IN" );
+    for ( i = 0; char_data->char_list[i] != '\0'; i++ )
     {
-        PERR( "Unknown comparison type\n" );
-        g_string_append( sql, "??" );
+        if ( !g_ascii_isalnum( char_data->char_list[i] ) )
+            return SQL_TERM_NONE;
+        if ( i != 0 ) g_string_append( sql, "," );
+        g_string_append_printf( sql, "'%c'", char_data->char_list[i] );
     }
+    g_string_append( sql, ")" );
+    return SQL_TERM_EXACT;
 }
 
-static void
-convert_query_term_to_sql( const GncSqlBackend* be, const gchar* fieldName, QofQueryTerm* pTerm, GString* sql )
+/* Databases differ on whether = and LIKE ignore case, so a string term
+ * is at best a superset, and can't be negated. */
+static SqlTermMatch
+convert_string_term_to_sql( const GncSqlBackend* be, const gchar* fieldName,
+                            query_string_t string_data, GString* sql )
 {
-    QofQueryPredData* pPredData;
-    gboolean isInverted;
+    QofQueryCompare how = string_data->pd.how;
 
-    g_return_if_fail( pTerm != NULL );
-    g_return_if_fail( sql != NULL );
+    if ( string_data->is_regex ||
+            string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE )
+        return SQL_TERM_NONE;
 
-    pPredData = qof_query_term_get_pred_data( pTerm );
-    isInverted = qof_query_term_is_inverted( pTerm );
-
-    if ( g_strcmp0( pPredData->type_name, QOF_TYPE_GUID ) == 0 )
+    if ( how == QOF_COMPARE_EQUAL )
     {
-        query_guid_t guid_data = (query_guid_t)pPredData;
-        GList* guid_entry;
-
-        g_string_append( sql, "(" );
-        g_string_append( sql, fieldName );
+        g_string_append_printf( sql, "COALESCE(%s,'') = ", fieldName );
+        if ( !append_quoted_string( be, sql, string_data->matchstring ) )
+            return SQL_TERM_NONE;
+        return SQL_TERM_SUPERSET;
+    }
+    if ( how == QOF_COMPARE_CONTAINS )
+    {
+        GString* pattern = g_string_new( "%" );
+        const gchar* c;
+        gboolean ok;
 
-        switch ( guid_data->options )
+        for ( c = string_data->matchstring; *c; c++ )
         {
-        case QOF_GUID_MATCH_ANY:
-            if ( isInverted ) g_string_append( sql, " NOT IN (" );
-            else g_string_append( sql, " IN (" );
-            break;
-
-        case QOF_GUID_MATCH_NONE:
-            if ( isInverted ) g_string_append( sql, " IN (" );
-            else g_string_append( sql, " NOT IN (" );
-            break;
-
-        default:
-            PERR( "Unexpected GncGUID match type: %d\n", guid_data->options );
+            if ( *c == '%' || *c == '_' || *c == '!' )
+                g_string_append_c( pattern, '!' );
+            g_string_append_c( pattern, *c );
         }
+        g_string_append_c( pattern, '%' );
+        g_string_append_printf( sql, "COALESCE(%s,'') LIKE ", fieldName );
+        ok = append_quoted_string( be, sql, pattern->str );
+        g_string_append( sql, " ESCAPE '!'" );
+        g_string_free( pattern, TRUE );
+        return ok ? SQL_TERM_SUPERSET : SQL_TERM_NONE;
+    }
+    return SQL_TERM_NONE;
+}
 
-        for ( guid_entry = guid_data->guids; guid_entry != NULL; guid_entry = guid_entry->next )
-        {
-            gchar guid_buf[GUID_ENCODING_LENGTH+1];
+/* Numeric columns are stored as a _num/_denom pair with a positive
+ * denominator, so these compare exactly in integers, mirroring
+ * numeric_match_predicate. */
+static SqlTermMatch
+convert_numeric_term_to_sql( const gchar* fieldName, query_numeric_t pData,
+                             GString* sql )
+{
+    gint64 num = gnc_numeric_num( pData->amount );
+    gint64 denom = gnc_numeric_denom( pData->amount );
+    QofQueryCompare how = pData->pd.how;
+    SqlTermMatch match = SQL_TERM_EXACT;
 
-            if ( guid_entry != guid_data->guids ) g_string_append( sql, "," );
-            (void)guid_to_string_buff(static_cast<GncGUID*>(guid_entry->data),
-                                      guid_buf );
-            g_string_append_printf( sql, "'%s'", guid_buf );
-        }
-        g_string_append( sql, "))" );
+    if ( gnc_numeric_check( pData->amount ) != GNC_ERROR_OK || denom <= 0 )
+        return SQL_TERM_NONE;
 
-    }
-    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_CHAR ) == 0 )
+    switch ( pData->options )
     {
-        query_char_t char_data = (query_char_t)pPredData;
-        int i;
-
-        if ( isInverted )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        if ( char_data->options == QOF_CHAR_MATCH_NONE )
-        {
-            g_string_append( sql, "NOT " );
-        }
-        g_string_append( sql, "(" );
-        for ( i = 0; char_data->char_list[i] != '\0'; i++ )
-        {
-            if ( i != 0 )
-            {
-                g_string_append( sql, " OR " );
-            }
-            g_string_append( sql, fieldName );
-            g_string_append( sql, " = '" );
-            g_string_append_c( sql, char_data->char_list[i] );
-            g_string_append( sql, "'" );
-        }
-        g_string_append( sql, ") " );
-        if ( isInverted )
-        {
-            g_string_append( sql, ") " );
-        }
+    case QOF_NUMERIC_MATCH_CREDIT:
+        g_string_append_printf( sql, "%s_num <= 0 AND ", fieldName );
+        break;
+    case QOF_NUMERIC_MATCH_DEBIT:
+        g_string_append_printf( sql, "%s_num >= 0 AND ", fieldName );
+        break;
+    default:
+        break;
+    }
 
+    if ( how == QOF_COMPARE_EQUAL )
+    {
+        /* Equal to four decimal places; the engine rounds the
+         * difference first, so allow the boundary. */
+        g_string_append_printf( sql, "ABS(ABS(%s_num)*%" G_GINT64_FORMAT
+                                " - %" G_GINT64_FORMAT "*%s_denom)*10000"
+                                " <= %s_denom*%" G_GINT64_FORMAT,
+                                fieldName, denom, ABS( num ), fieldName,
+                                fieldName, denom );
+        match = SQL_TERM_SUPERSET;
     }
-    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_STRING ) == 0 )
+    else if ( how != QOF_COMPARE_NEQ && convert_query_comparison_to_sql( how ) )
     {
-        query_string_t string_data = (query_string_t)pPredData;
-        sqlEscape* escape = sqlEscape_new();
-
-        if ( isInverted )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        if ( pPredData->how == QOF_COMPARE_NEQ )
-        {
-            g_string_append( sql, "NOT(" );
-        }
-        g_string_append( sql, fieldName );
-        if ( string_data->is_regex || string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE )
-        {
-            PWARN( "String is_regex || option = QOF_STRING_MATCH_INSENSITIVE\n" );
-        }
-//			g_string_append( sql, " ~" );
-//		} else {
-        g_string_append( sql, " =" );
-//		}
-//		if( string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE ) {
-//			g_string_append( sql, "*" );
-//		}
-        g_string_append( sql, "'" );
-        g_string_append( sql, sqlEscapeString( escape, string_data->matchstring ) );
-        g_string_append( sql, "'" );
-        if ( pPredData->how == QOF_COMPARE_NEQ )
-        {
-            g_string_append( sql, ")" );
-        }
-        if ( isInverted )
-        {
-            g_string_append( sql, ")" );
-        }
-        sqlEscape_destroy( escape );
-
+        g_string_append_printf( sql, "ABS(%s_num)*%" G_GINT64_FORMAT " %s %"
+                                G_GINT64_FORMAT "*%s_denom",
+                                fieldName, denom,
+                                convert_query_comparison_to_sql( how ),
+                                num, fieldName );
     }
     else
     {
-        g_string_append( sql, "(" );
-        g_string_append( sql, fieldName );
-        convert_query_comparison_to_sql( pPredData, isInverted, sql );
-
-        if ( strcmp( pPredData->type_name, QOF_TYPE_NUMERIC ) == 0 )
-        {
-            query_numeric_t pData = (query_numeric_t)pPredData;
-            double d = gnc_numeric_to_double( pData->amount );
-
-            g_string_append_printf( sql, "%f", d );
-
-        }
-        else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_DATE ) == 0 )
-        {
-            query_date_t date_data = (query_date_t)pPredData;
-            gchar* datebuf;
-
-            datebuf = gnc_sql_convert_timespec_to_string( be, date_data->date );
-            g_string_append_printf( sql, "'%s'", datebuf );
-
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_INT32 ) == 0 )
-        {
-            query_int32_t pData = (query_int32_t)pPredData;
+        return SQL_TERM_NONE;
+    }
+    return match;
+}
 
-            g_string_append_printf( sql, "%d", pData->val );
+/* The engine takes a missing date for the epoch, which compares before
+ * any date; let those rows through rather than guess how the database
+ * orders them. */
+static SqlTermMatch
+convert_date_term_to_sql( const GncSqlBackend* be, const gchar* fieldName,
+                          query_date_t date_data, GString* sql )
+{
+    const gchar* op = convert_query_comparison_to_sql( date_data->pd.how );
+    gchar* datebuf;
 
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_INT64 ) == 0 )
-        {
-            query_int64_t pData = (query_int64_t)pPredData;
+    if ( op == NULL || date_data->options != QOF_DATE_MATCH_NORMAL )
+        return SQL_TERM_NONE;
 
-            g_string_append_printf( sql, "%" G_GINT64_FORMAT, pData->val );
+    datebuf = gnc_sql_convert_timespec_to_string( be, date_data->date );
+    g_string_append_printf( sql, "%s %s '%s' OR %s IS NULL",
+                            fieldName, op, datebuf, fieldName );
+    g_free( datebuf );
+    return SQL_TERM_SUPERSET;
+}
 
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_DOUBLE ) == 0 )
-        {
-            query_double_t pData = (query_double_t)pPredData;
+static SqlTermMatch
+convert_query_term_to_sql( const GncSqlBackend* be, const gchar* fieldName,
+                           QofQueryTerm* pTerm, GString* sql )
+{
+    QofQueryPredData* pPredData;
+    GString* expr;
+    SqlTermMatch match;
 
-            g_string_append_printf( sql, "%f", pData->val );
+    g_return_val_if_fail( pTerm != NULL, SQL_TERM_NONE );
+    g_return_val_if_fail( sql != NULL, SQL_TERM_NONE );
 
-        }
-        else if ( strcmp( pPredData->type_name, QOF_TYPE_BOOLEAN ) == 0 )
-        {
-            query_boolean_t pData = (query_boolean_t)pPredData;
+    pPredData = qof_query_term_get_pred_data( pTerm );
+    expr = g_string_new( "" );
 
-            g_string_append_printf( sql, "%d", pData->val );
+    if ( g_strcmp0( pPredData->type_name, QOF_TYPE_GUID ) == 0 )
+        match = convert_guid_term_to_sql( fieldName, (query_guid_t)pPredData, expr );
+    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_CHAR ) == 0 )
+        match = convert_char_term_to_sql( fieldName, (query_char_t)pPredData, expr );
+    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_STRING ) == 0 )
+        match = convert_string_term_to_sql( be, fieldName,
+                                            (query_string_t)pPredData, expr );
+    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_NUMERIC ) == 0 )
+        match = convert_numeric_term_to_sql( fieldName,
+                                             (query_numeric_t)pPredData, expr );
+    else if ( g_strcmp0( pPredData->type_name, QOF_TYPE_DATE ) == 0 )
+        match = convert_date_term_to_sql( be, fieldName,
+                                          (query_date_t)pPredData, expr );
+    else
+        match = SQL_TERM_NONE;
 
-        }
+    /* Only an exact translation can be negated */
+    if ( qof_query_term_is_inverted( pTerm ) )
+    {
+        if ( match == SQL_TERM_EXACT )
+            g_string_append_printf( sql, "NOT(%s)", expr->str );
         else
-        {
-            PERR( "Unknown query predicate type: %s\n", pPredData->type_name );
-        }
-
-        g_string_append( sql, ")" );
+            match = SQL_TERM_NONE;
+    }
+    else if ( match != SQL_TERM_NONE )
+    {
+        g_string_append_printf( sql, "(%s)", expr->str );
     }
+    g_string_free( expr, TRUE );
+    return match;
 }
 
 typedef struct
 {
     GncSqlStatement* stmt;
+    gchar* tx_subquery;		/* Selects the guids of the transactions stmt does */
     gboolean has_been_run;
 } split_query_info_t;
 
-#define TX_GUID_CHECK 0
-
-G_GNUC_UNUSED static /*@ null @*/ gpointer
+/* Translate the query's sum of products into a WHERE clause selecting
+ * the splits, and so the transactions, it may match.  Terms that can't
+ * be translated are left to the engine.  If every term was translated
+ * exactly and the query only wants the last few results in the default
+ * order, which goes by date posted first, the transactions dated before
+ * the max_results-th latest matching split needn't be loaded either. */
+static /*@ null @*/ gpointer
 compile_split_query( GncSqlBackend* be, QofQuery* query )
 {
     split_query_info_t* query_info = NULL;
+    GString* where = g_string_new( "" );
+    gboolean exact = TRUE;
+    gboolean unrestricted = !qof_query_has_terms( query );
     gchar* query_sql;
+    GList* orTerm;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( query != NULL, NULL );
@@ -1091,151 +1585,107 @@ compile_split_query( GncSqlBackend* be, QofQuery* query )
         g_malloc(sizeof(split_query_info_t)));
     g_assert( query_info != NULL );
     query_info->has_been_run = FALSE;
+    query_info->tx_subquery = NULL;
 
-    if ( qof_query_has_terms( query ) )
+    for ( orTerm = qof_query_get_terms( query ); orTerm != NULL && !unrestricted;
+            orTerm = orTerm->next )
     {
-        GList* orterms = qof_query_get_terms( query );
-        GList* orTerm;
-        GString* sql = g_string_new( "" );
-        gboolean need_OR = FALSE;
+        GString* and_sql = g_string_new( "" );
+        GList* andTerm;
 
-        for ( orTerm = orterms; orTerm != NULL; orTerm = orTerm->next )
+        for ( andTerm = (GList*)orTerm->data; andTerm != NULL; andTerm = andTerm->next )
         {
-            GList* andterms = (GList*)orTerm->data;
-            GList* andTerm;
-            gboolean need_AND = FALSE;
-#if TX_GUID_CHECK
-            gboolean has_tx_guid_check = FALSE;
-#endif
-            if ( need_OR )
+            QofQueryTerm* term = (QofQueryTerm*)andTerm->data;
+            GSList* paramPath = qof_query_term_get_param_path( term );
+            const gchar* column;
+            GString* term_sql;
+            SqlTermMatch match;
+
+            /* The database holds a single book */
+            if ( g_strcmp0( static_cast<const gchar*>(paramPath->data),
+                            QOF_PARAM_BOOK ) == 0 )
+                continue;
+
+            column = split_query_column( paramPath );
+            if ( column == NULL )
             {
-                g_string_append( sql, " OR " );
+                DEBUG( "Split query term on %s left to the engine",
+                       (gchar*)paramPath->data );
+                exact = FALSE;
+                continue;
             }
-            g_string_append( sql, "(" );
-            for ( andTerm = andterms; andTerm != NULL; andTerm = andTerm->next )
-            {
-                QofQueryTerm* term;
-                GSList* paramPath;
-                gboolean unknownPath = FALSE;
-
-                term = (QofQueryTerm*)andTerm->data;
-                paramPath = qof_query_term_get_param_path( term );
-                const char *path = static_cast<decltype(path)>(paramPath->data);
-                const char *next_path =
-                    static_cast<decltype(next_path)>(paramPath->next->data);
-                if (strcmp(path, QOF_PARAM_BOOK) == 0) continue;
-
-#if SIMPLE_QUERY_COMPILATION
-                if ( strcmp(path, SPLIT_ACCOUNT) != 0 ||
-                     strcmp(next_path, QOF_PARAM_GUID) != 0 ) continue;
-#endif
-
-                if ( need_AND ) g_string_append( sql, " AND " );
-
-                if ( strcmp(path, SPLIT_ACCOUNT) == 0 &&
-                     strcmp(next_path, QOF_PARAM_GUID) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.account_guid", term, sql );
-#if SIMPLE_QUERY_COMPILATION
-                    goto done_compiling_query;
-#endif
-
-                }
-                else if ( strcmp(path, SPLIT_RECONCILE) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.reconcile_state", term, sql );
-
-                }
-                else if ( strcmp(path, SPLIT_TRANS) == 0 )
-                {
-#if TX_GUID_CHECK
-                    if ( !has_tx_guid_check )
-                    {
-                        g_string_append( sql, "(splits.tx_guid = transactions.guid) AND " );
-                        has_tx_guid_check = TRUE;
-                    }
-#endif
-                    if (strcmp(next_path, TRANS_DATE_POSTED) == 0 )
-                    {
-                        convert_query_term_to_sql( be, "t.post_date", term, sql );
-                    }
-                    else if (strcmp(next_path, TRANS_DESCRIPTION) == 0 )
-                    {
-                        convert_query_term_to_sql( be, "t.description", term, sql );
-                    }
-                    else
-                    {
-                        unknownPath = TRUE;
-                    }
 
-                }
-                else if ( strcmp(path, SPLIT_VALUE) == 0 )
-                {
-                    convert_query_term_to_sql( be, "s.value_num/s.value_denom", term, sql );
-
-                }
-                else
-                {
-                    unknownPath = TRUE;
-                }
-
-                if ( unknownPath )
-                {
-                    GString* name = g_string_new( (gchar*)paramPath->data );
-                    while ( paramPath->next != NULL )
-                    {
-                        g_string_append( name, "." );
-                        g_string_append( name, next_path );
-                        paramPath = paramPath->next;
-                    }
-                    PERR( "Unknown SPLIT query field: %s\n", name->str );
-                    g_string_free( name, TRUE );
-                }
-                need_AND = TRUE;
-            }
-
-            /* If the last char in the string is a '(', then for some reason, there were
-               no terms added to the SQL.  If so, remove it and ignore the OR term. */
-            if ( sql->str[sql->len-1] == '(' )
+            term_sql = g_string_new( "" );
+            match = convert_query_term_to_sql( be, column, term, term_sql );
+            if ( match != SQL_TERM_EXACT ) exact = FALSE;
+            if ( match != SQL_TERM_NONE )
             {
-                g_string_truncate( sql, sql->len - 1 );
-                need_OR = FALSE;
-            }
-            else
-            {
-                g_string_append( sql, ")" );
-                need_OR = TRUE;
+                if ( and_sql->len != 0 ) g_string_append( and_sql, " AND " );
+                g_string_append( and_sql, term_sql->str );
             }
+            g_string_free( term_sql, TRUE );
         }
 
-#if SIMPLE_QUERY_COMPILATION
-done_compiling_query:
-#endif
-        if ( sql->len != 0 )
-        {
-#if SIMPLE_QUERY_COMPILATION
-            g_string_append( sql, ")" );
-#endif
-            query_sql = g_strdup_printf(
-                            "SELECT DISTINCT t.* FROM %s AS t, %s AS s WHERE s.tx_guid=t.guid AND %s",
-                            TRANSACTION_TABLE, SPLIT_TABLE, sql->str );
-        }
+        /* An OR term with nothing to restrict it lets every row through */
+        if ( and_sql->len == 0 )
+            unrestricted = TRUE;
         else
+            g_string_append_printf( where, "%s(%s)",
+                                    where->len != 0 ? " OR " : "",
+                                    and_sql->str );
+        g_string_free( and_sql, TRUE );
+    }
+    if ( unrestricted )
+        g_string_assign( where, "1=1" );
+
+    if ( exact && qof_query_get_max_results( query ) > 0 )
+    {
+        QofQuerySort *primary, *secondary, *tertiary;
+        GSList* sortPath;
+
+        qof_query_get_sorts( query, &primary, &secondary, &tertiary );
+        sortPath = qof_query_sort_get_param_path( primary );
+        if ( sortPath != NULL &&
+                g_strcmp0( static_cast<const gchar*>(sortPath->data),
+                           QUERY_DEFAULT_SORT ) == 0 )
         {
-            query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
+            gboolean inc = qof_query_sort_get_increasing( primary );
+            gchar* nth = g_strdup_printf(
+                             "(SELECT t.post_date FROM %s AS t, %s AS s"
+                             " WHERE s.tx_guid=t.guid AND (%s)"
+                             " ORDER BY t.post_date %s LIMIT 1 OFFSET %d)",
+                             TRANSACTION_TABLE, SPLIT_TABLE, where->str,
+                             inc ? "DESC" : "ASC",
+                             qof_query_get_max_results( query ) - 1 );
+            gchar* restricted = g_strdup_printf(
+                                    "(%s) AND (t.post_date %s %s OR %s IS NULL"
+                                    " OR t.post_date IS NULL)",
+                                    where->str, inc ? ">=" : "<=", nth, nth );
+            g_string_assign( where, restricted );
+            g_free( restricted );
+            g_free( nth );
         }
-        query_info->stmt = gnc_sql_create_statement_from_sql( be, query_sql );
-
-        g_string_free( sql, TRUE );
-        g_free( query_sql );
+    }
 
+    if ( unrestricted && g_strcmp0( where->str, "1=1" ) == 0 )
+    {
+        query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
+        query_info->tx_subquery = g_strdup_printf( "SELECT guid FROM %s",
+                                  TRANSACTION_TABLE );
     }
     else
     {
-        query_sql = g_strdup_printf( "SELECT * FROM %s", TRANSACTION_TABLE );
-        query_info->stmt = gnc_sql_create_statement_from_sql( be, query_sql );
-        g_free( query_sql );
+        query_sql = g_strdup_printf(
+                        "SELECT DISTINCT t.* FROM %s AS t, %s AS s WHERE s.tx_guid=t.guid AND %s",
+                        TRANSACTION_TABLE, SPLIT_TABLE, where->str );
+        query_info->tx_subquery = g_strdup_printf(
+                        "SELECT DISTINCT t.guid FROM %s AS t, %s AS s WHERE s.tx_guid=t.guid AND %s",
+                        TRANSACTION_TABLE, SPLIT_TABLE, where->str );
     }
+    query_info->stmt = gnc_sql_create_statement_from_sql( be, query_sql );
+
+    g_string_free( where, TRUE );
+    g_free( query_sql );
 
     return query_info;
 }
@@ -1250,7 +1700,7 @@ run_split_query( GncSqlBackend* be, gpointer pQuery )
 
     if ( !query_info->has_been_run )
     {
-        query_transactions( be, query_info->stmt );
+        query_transactions( be, query_info->stmt, query_info->tx_subquery );
         query_info->has_been_run = TRUE;
         gnc_sql_statement_dispose( query_info->stmt );
         query_info->stmt = NULL;
@@ -1263,9 +1713,29 @@ free_split_query( GncSqlBackend* be, gpointer pQuery )
     g_return_if_fail( be != NULL );
     g_return_if_fail( pQuery != NULL );
 
+    g_free( ((split_query_info_t*)pQuery)->tx_subquery );
     g_free( pQuery );
 }
 
+gchar*
+gnc_sql_split_query_to_tx_subquery( GncSqlBackend* be, QofQuery* query )
+{
+    split_query_info_t* query_info;
+    gchar* tx_subquery;
+
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( query != NULL, NULL );
+
+    query_info = static_cast<decltype(query_info)>(compile_split_query( be, query ));
+    if ( query_info == NULL )
+        return NULL;
+    if ( query_info->stmt != NULL )
+        gnc_sql_statement_dispose( query_info->stmt );
+    tx_subquery = query_info->tx_subquery;
+    g_free( query_info );
+    return tx_subquery;
+}
+
 /* ----------------------------------------------------------------- */
 typedef struct
 {
@@ -1320,7 +1790,7 @@ static const GncSqlColumnTableEntry acct_balances_col_table[] =
     /*@ +full_init_block @*/
 };
 
-G_GNUC_UNUSED static /*@ null @*/ single_acct_balance_t*
+static /*@ null @*/ single_acct_balance_t*
 load_single_acct_balances( const GncSqlBackend* be, GncSqlRow* row )
 {
     single_acct_balance_t* bal = NULL;
@@ -1337,22 +1807,20 @@ load_single_acct_balances( const GncSqlBackend* be, GncSqlRow* row )
     return bal;
 }
 
-/*@ null @*/ GSList*
-gnc_sql_get_account_balances_slist( GncSqlBackend* be )
+/**
+ * Runs a query returning one sum per account, reconcile state and
+ * denominator, ordered by account, and merges the sums of each account
+ * into an acct_balances_t.
+ */
+static /*@ null @*/ GSList*
+load_account_balances( GncSqlBackend* be, const gchar* sql )
 {
-#if LOAD_TRANSACTIONS_AS_NEEDED
     GncSqlResult* result;
     GncSqlStatement* stmt;
-    gchar* buf;
     GSList* bal_slist = NULL;
 
-    g_return_val_if_fail( be != NULL, NULL );
-
-    buf = g_strdup_printf( "SELECT account_guid, reconcile_state, sum(quantity_num) as quantity_num, quantity_denom FROM %s GROUP BY account_guid, reconcile_state, quantity_denom ORDER BY account_guid, reconcile_state",
-                           SPLIT_TABLE );
-    stmt = gnc_sql_create_statement_from_sql( be, buf );
+    stmt = gnc_sql_create_statement_from_sql( be, sql );
     g_assert( stmt != NULL );
-    g_free( buf );
     result = gnc_sql_execute_select_statement( be, stmt );
     gnc_sql_statement_dispose( stmt );
     if ( result != NULL )
@@ -1380,7 +1848,7 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
                 }
                 if ( bal == NULL )
                 {
-                    bal = g_malloc( (gsize)sizeof(acct_balances_t) );
+                    bal = g_new( acct_balances_t, 1 );
                     g_assert( bal != NULL );
 
                     bal->acct = single_bal->acct;
@@ -1388,17 +1856,20 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
                     bal->cleared_balance = gnc_numeric_zero();
                     bal->reconciled_balance = gnc_numeric_zero();
                 }
-                if ( single_bal->reconcile_state == 'n' )
+                /* Match xaccAccountRecomputeBalance(): anything but 'n'
+                 * is cleared, and frozen splits count as reconciled. */
+                if ( single_bal->reconcile_state == NREC )
                 {
                     bal->balance = gnc_numeric_add( bal->balance, single_bal->balance,
                                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 }
-                else if ( single_bal->reconcile_state == 'c' )
+                else if ( single_bal->reconcile_state != YREC
+                          && single_bal->reconcile_state != FREC )
                 {
                     bal->cleared_balance = gnc_numeric_add( bal->cleared_balance, single_bal->balance,
                                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
                 }
-                else if ( single_bal->reconcile_state == 'y' )
+                else
                 {
                     bal->reconciled_balance = gnc_numeric_add( bal->reconciled_balance, single_bal->balance,
                                               GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD );
@@ -1420,12 +1891,118 @@ gnc_sql_get_account_balances_slist( GncSqlBackend* be )
         gnc_sql_result_dispose( result );
     }
 
+    return bal_slist;
+}
+
+/**
+ * Sums the splits posted between start and end, either of which may be
+ * NULL, of acct or of every account when acct is NULL.
+ */
+static /*@ null @*/ GSList*
+load_dated_account_balances( GncSqlBackend* be, /*@ null @*/ const Account* acct,
+                             /*@ null @*/ const Timespec* start,
+                             /*@ null @*/ const Timespec* end )
+{
+    GString* where;
+    gchar* buf;
+    GSList* bal_slist;
+
+    where = g_string_new( "s.tx_guid=t.guid" );
+    if ( acct != NULL )
+    {
+        gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+
+        (void)guid_to_string_buff( qof_instance_get_guid( acct ), guid_buf );
+        g_string_append_printf( where, " AND s.account_guid='%s'", guid_buf );
+    }
+    if ( start != NULL )
+    {
+        gchar* datebuf = gnc_sql_convert_timespec_to_string( be, *start );
+        g_string_append_printf( where, " AND t.post_date>='%s'", datebuf );
+        g_free( datebuf );
+    }
+    if ( end != NULL )
+    {
+        gchar* datebuf = gnc_sql_convert_timespec_to_string( be, *end );
+        g_string_append_printf( where, " AND t.post_date<='%s'", datebuf );
+        g_free( datebuf );
+    }
+    buf = g_strdup_printf( "SELECT s.account_guid AS account_guid, s.reconcile_state AS reconcile_state, sum(s.quantity_num) AS quantity_num, s.quantity_denom AS quantity_denom FROM %s AS s, %s AS t WHERE %s GROUP BY s.account_guid, s.reconcile_state, s.quantity_denom ORDER BY s.account_guid, s.reconcile_state",
+                           SPLIT_TABLE, TRANSACTION_TABLE, where->str );
+    g_string_free( where, TRUE );
+    bal_slist = load_account_balances( be, buf );
+    g_free( buf );
+
+    return bal_slist;
+}
+
+/*@ null @*/ GSList*
+gnc_sql_get_account_balances_slist( GncSqlBackend* be )
+{
+#if LOAD_TRANSACTIONS_AS_NEEDED
+    gchar* buf;
+    GSList* bal_slist;
+
+    g_return_val_if_fail( be != NULL, NULL );
+
+    buf = g_strdup_printf( "SELECT account_guid, reconcile_state, sum(quantity_num) as quantity_num, quantity_denom FROM %s GROUP BY account_guid, reconcile_state, quantity_denom ORDER BY account_guid, reconcile_state",
+                           SPLIT_TABLE );
+    bal_slist = load_account_balances( be, buf );
+    g_free( buf );
+
     return bal_slist;
 #else
     return NULL;
 #endif
 }
 
+/*@ null @*/ GSList*
+gnc_sql_get_account_balances_as_of_slist( GncSqlBackend* be, Timespec end )
+{
+    g_return_val_if_fail( be != NULL, NULL );
+
+    return load_dated_account_balances( be, NULL, NULL, &end );
+}
+
+/*@ null @*/ GSList*
+gnc_sql_get_account_period_balances_slist( GncSqlBackend* be,
+        Timespec start, Timespec end )
+{
+    g_return_val_if_fail( be != NULL, NULL );
+
+    return load_dated_account_balances( be, NULL, &start, &end );
+}
+
+gboolean
+gnc_sql_balance_lookup( QofBackend* qbe, QofInstance* inst,
+                        /*@ null @*/ const Timespec* start,
+                        /*@ null @*/ const Timespec* end,
+                        gnc_numeric* balance )
+{
+    GncSqlBackend* be = (GncSqlBackend*)qbe;
+    GSList* bal_slist;
+    GSList* bal;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+    g_return_val_if_fail( GNC_IS_ACCOUNT(inst), FALSE );
+    g_return_val_if_fail( balance != NULL, FALSE );
+
+    /* An account without splits in the period has no row. */
+    *balance = gnc_numeric_zero();
+    bal_slist = load_dated_account_balances( be, GNC_ACCOUNT(inst), start, end );
+    for ( bal = bal_slist; bal != NULL; bal = bal->next )
+    {
+        acct_balances_t* balances = (acct_balances_t*)bal->data;
+
+        if ( balances->acct == GNC_ACCOUNT(inst) )
+            *balance = balances->balance;
+        g_free( balances );
+    }
+    g_slist_free( bal_slist );
+
+    return TRUE;
+}
+
 /* ----------------------------------------------------------------- */
 static void
 load_tx_guid( const GncSqlBackend* be, GncSqlRow* row,
@@ -1460,7 +2037,7 @@ load_tx_guid( const GncSqlBackend* be, GncSqlRow* row,
                                    TRANSACTION_TABLE, guid_str );
             stmt = gnc_sql_create_statement_from_sql( (GncSqlBackend*)be, buf );
             g_free( buf );
-            query_transactions( (GncSqlBackend*)be, stmt );
+            query_transactions( (GncSqlBackend*)be, stmt, NULL );
             tx = xaccTransLookup( &guid, be->book );
         }
 
@@ -70,6 +70,30 @@ void gnc_sql_transaction_load_tx_for_account( GncSqlBackend* be, Account* accoun
  */
 void gnc_sql_transaction_load_all_tx( GncSqlBackend* be );
 
+/**
+ * Loads the transactions that other sessions recorded in the change log
+ * (see GNC_SQL_CHANGES_TABLE) at or after a time.  As with the other
+ * loads, transactions already in memory are left alone, so this picks up
+ * the transactions new to this session.  Used by gnc_sql_load_changes().
+ *
+ * @param be SQL backend
+ * @param since Earliest change time of interest
+ */
+void gnc_sql_transaction_load_changed_since( GncSqlBackend* be, Timespec since );
+
+/**
+ * Translates a split query into SQL selecting the guids of the
+ * transactions holding the splits it may match.  This is how the
+ * LOAD_TRANSACTIONS_AS_NEEDED mode decides which transactions a query
+ * loads: every matching split's transaction is selected, and terms that
+ * can't be translated select more rather than fewer.
+ *
+ * @param be SQL backend
+ * @param query Query for GNC_ID_SPLIT
+ * @return Newly allocated SQL, to be freed with g_free()
+ */
+gchar* gnc_sql_split_query_to_tx_subquery( GncSqlBackend* be, QofQuery* query );
+
 typedef struct
 {
     Account* acct;
@@ -88,4 +112,48 @@ typedef struct
 /*@ null @*/
 GSList* gnc_sql_get_account_balances_slist( GncSqlBackend* be );
 
+/**
+ * Returns a list of acct_balances_t structures holding each account's
+ * balances as of a date, the sums of the amounts of its splits in
+ * transactions posted on or before it.  The sums are taken by the
+ * database, so no split has to be loaded.
+ *
+ * @param be SQL backend
+ * @param end Latest post date included
+ * @return GSList of acct_balances_t structures, freed with g_free()
+ */
+/*@ null @*/
+GSList* gnc_sql_get_account_balances_as_of_slist( GncSqlBackend* be,
+        Timespec end );
+
+/**
+ * Returns a list of acct_balances_t structures holding each account's
+ * change over a period, the sums of the amounts of its splits in
+ * transactions posted from start to end, both included.
+ *
+ * @param be SQL backend
+ * @param start Earliest post date included
+ * @param end Latest post date included
+ * @return GSList of acct_balances_t structures, freed with g_free()
+ */
+/*@ null @*/
+GSList* gnc_sql_get_account_period_balances_slist( GncSqlBackend* be,
+        Timespec start,
+        Timespec end );
+
+/**
+ * The QofBackend balance_lookup of the SQL backend: sums one account's
+ * splits posted from start to end in the database.
+ *
+ * @param qbe SQL backend
+ * @param inst Account
+ * @param start Earliest post date included, or NULL
+ * @param end Latest post date included, or NULL
+ * @param balance Where the sum is stored
+ * @return TRUE
+ */
+gboolean gnc_sql_balance_lookup( QofBackend* qbe, QofInstance* inst,
+                                 const Timespec* start, const Timespec* end,
+                                 gnc_numeric* balance );
+
 #endif /* GNC_TRANSACTION_SQL_H */
@@ -265,6 +265,86 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (inst);
     g_object_unref (be.book);
 }
+/* gnc_sql_begin_group_commit
+void
+gnc_sql_begin_group_commit (GncSqlBackend* be)// C: 1 */
+/* gnc_sql_end_group_commit
+void
+gnc_sql_end_group_commit (GncSqlBackend* be)// C: 1 */
+static gboolean group_commit_ok;
+/* Stays registered for the rest of the run */
+static GncSqlObjectBackend fake_object_backend;
+
+static gboolean
+fake_group_commit_transaction (GncSqlConnection *conn)
+{
+    return group_commit_ok;
+}
+
+static gboolean
+fake_object_commit (GncSqlBackend* be, QofInstance* inst)
+{
+    return TRUE;
+}
+
+static void
+test_gnc_sql_group_commit (void)
+{
+    GncSqlBackend be;
+    GncSqlConnection conn;
+    QofInstance *inst;
+    const char *fake_type = "FakeObject";
+
+    memset (&be, 0, sizeof (be));
+    memset (&conn, 0, sizeof (conn));
+    fake_object_backend.version = GNC_SQL_BACKEND_VERSION;
+    fake_object_backend.type_name = fake_type;
+    fake_object_backend.commit = fake_object_commit;
+
+    qof_object_initialize ();
+    qof_object_register_backend (fake_type, GNC_SQL_BACKEND,
+                                 &fake_object_backend);
+    be.book = qof_book_new ();
+    be.conn = &conn;
+    conn.beginTransaction = fake_connection_function;
+    conn.rollbackTransaction = fake_connection_function;
+    conn.commitTransaction = fake_group_commit_transaction;
+    inst  = static_cast<decltype(inst)>(g_object_new (QOF_TYPE_INSTANCE, NULL));
+    qof_instance_init_data (inst, fake_type, be.book);
+
+    /* The instance is saved once the group's transaction commits. */
+    group_commit_ok = TRUE;
+    qof_instance_set_dirty_flag (inst, TRUE);
+    qof_book_mark_session_dirty (be.book);
+    gnc_sql_begin_group_commit (&be);
+    gnc_sql_begin_group_commit (&be);
+    gnc_sql_commit_edit (&be, inst);
+    gnc_sql_end_group_commit (&be);
+    g_assert (qof_instance_get_dirty_flag (inst));
+    g_assert (qof_book_session_not_saved (be.book));
+    gnc_sql_end_group_commit (&be);
+    g_assert (!qof_instance_get_dirty_flag (inst));
+    g_assert (!qof_book_session_not_saved (be.book));
+    g_assert_cmpint (qof_backend_get_error (&be.be), ==, ERR_BACKEND_NO_ERR);
+    g_assert (be.group_instances == NULL);
+
+    /* If it doesn't, the instance stays dirty, though the engine marked
+     * it clean after its commit, and the error is reported. */
+    qof_instance_set_dirty_flag (inst, TRUE);
+    qof_book_mark_session_dirty (be.book);
+    gnc_sql_begin_group_commit (&be);
+    gnc_sql_commit_edit (&be, inst);
+    qof_instance_set_dirty_flag (inst, FALSE);
+    group_commit_ok = FALSE;
+    gnc_sql_end_group_commit (&be);
+    g_assert (qof_instance_get_dirty_flag (inst));
+    g_assert (qof_book_session_not_saved (be.book));
+    g_assert_cmpint (qof_backend_get_error (&be.be), ==, ERR_BACKEND_SERVER_ERR);
+    g_assert (be.group_instances == NULL);
+
+    g_object_unref (inst);
+    g_object_unref (be.book);
+}
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -965,6 +1045,7 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql group commit", test_gnc_sql_group_commit);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
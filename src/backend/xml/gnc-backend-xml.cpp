@@ -59,6 +59,10 @@ typedef int ssize_t;
 # include <dirent.h>
 #endif
 #include <time.h>
+#ifdef __linux__
+# include <sys/ioctl.h>
+# include <linux/fs.h>
+#endif
 #ifdef G_OS_WIN32
 # include <io.h>
 # define close _close
@@ -74,6 +78,7 @@ typedef int ssize_t;
 
 #include "qof.h"
 #include "TransLog.h"
+#include "Transaction.h"
 #include "gnc-engine.h"
 
 #include "gnc-uri-utils.h"
@@ -103,7 +108,17 @@ typedef int ssize_t;
 
 static QofLogModule log_module = GNC_MOD_BACKEND;
 
+#define GNC_PREF_XML_JOURNAL "xml-journal"
+#define GNC_PREF_XML_OPEN_CACHE "xml-open-cache"
+#define GNC_PREF_FILE_COMPRESSION_LEVEL "file-compression-level"
+#define GNC_PREF_FILE_COMPRESSION_THREADS "file-compression-threads"
+/* Once the journal grows past this, the next save rewrites the file. */
+#define XML_JOURNAL_MAX_SIZE (8 * 1024 * 1024)
+
 static gboolean save_may_clobber_data (QofBackend *bend);
+static void xml_commit_edit (QofBackend *bend, QofInstance *inst);
+static void xml_journal_close (FileBackend *be);
+static gboolean xml_save_finish (FileBackend *be);
 
 /* ================================================================= */
 
@@ -382,6 +397,13 @@ xml_session_begin(QofBackend *be_start, QofSession *session,
         return;
     }
 
+    /* A journal left by an earlier session is always replayed on load,
+     * but new records are only written while we hold the lock. */
+    be->journalfile = g_strconcat(be->fullpath, ".journal", NULL);
+    if (be->lockfd >= 0 &&
+            gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_XML_JOURNAL))
+        be_start->commit = xml_commit_edit;
+
     LEAVE (" ");
     return;
 }
@@ -394,19 +416,29 @@ xml_session_end(QofBackend *be_start)
     FileBackend *be = (FileBackend*)be_start;
     ENTER (" ");
 
+    /* Ending doesn't save, so a save that fails here is lost; leave the
+     * error for qof_session_end's caller. */
+    if (!xml_save_finish (be))
+        PERR ("Background save to %s failed, the file was not updated",
+              be->fullpath);
+
     if ( be->book && qof_book_is_readonly( be->book ) )
     {
         qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_READONLY );
         return;
     }
 
+    xml_journal_close (be);
+
     if (be->linkfile)
         g_unlink (be->linkfile);
 
     if (be->lockfd > 0)
         close (be->lockfd);
 
-    if (be->lockfile)
+    /* A session begun with ignore_lock never took the lock, which may
+     * well be held by someone else. */
+    if (be->lockfile && be->lockfd >= 0)
     {
         int rv;
 #ifdef G_OS_WIN32
@@ -433,12 +465,20 @@ xml_session_end(QofBackend *be_start)
 
     g_free (be->linkfile);
     be->linkfile = NULL;
+
+    g_free (be->journalfile);
+    be->journalfile = NULL;
+
+    g_free (be->rotate_backup);
+    be->rotate_backup = NULL;
     LEAVE (" ");
 }
 
 static void
 xml_destroy_backend(QofBackend *be)
 {
+    xml_save_finish ((FileBackend *) be);
+
     /* Stop transaction logging */
     xaccLogSetBaseName (NULL);
 
@@ -458,7 +498,7 @@ xml_destroy_backend(QofBackend *be)
    current year/month/day/hour/minute/second. */
 
 /* The variable buf_size must be a compile-time constant */
-#define buf_size 1024
+#define buf_size 65536
 
 static gboolean
 copy_file(const char *orig, const char *bkup)
@@ -486,6 +526,17 @@ copy_file(const char *orig, const char *bkup)
         return FALSE;
     }
 
+#ifdef FICLONE
+    /* On copy-on-write filesystems the copy can share the original's
+     * extents instead of duplicating its data. */
+    if (ioctl(bkup_fd, FICLONE, orig_fd) == 0)
+    {
+        close(orig_fd);
+        close(bkup_fd);
+        return TRUE;
+    }
+#endif
+
     do
     {
         count_read = read(orig_fd, buf, buf_size);
@@ -682,14 +733,137 @@ gnc_xml_be_backup_file(FileBackend *be)
     backup = g_strconcat( datafile, ".", timestamp, GNC_DATAFILE_EXT, NULL );
     g_free (timestamp);
 
-    bkup_ret = gnc_int_link_or_make_backup(be, datafile, backup);
-    g_free(backup);
-
-    return bkup_ret;
+    g_free (be->rotate_backup);
+    be->rotate_backup = NULL;
+#ifdef HAVE_LINK
+    if (link (datafile, backup) == 0)
+    {
+        g_free (backup);
+        return TRUE;
+    }
+    if (errno != EPERM && errno != ENOSYS
+# ifdef EOPNOTSUPP
+            && errno != EOPNOTSUPP
+# endif
+# ifdef ENOTSUP
+            && errno != ENOTSUP
+# endif
+       )
+    {
+        qof_backend_set_error((QofBackend*)be, ERR_FILEIO_BACKUP_ERROR);
+        PWARN ("unable to make file backup from %s to %s: %s",
+               datafile, backup, g_strerror(errno) ? g_strerror(errno) : "");
+        g_free (backup);
+        return FALSE;
+    }
+#endif
+    /* No hard links here: rather than copying the whole file now, the
+     * old file is renamed to the backup name once the new one has been
+     * written (see gnc_xml_be_install_file). */
+    be->rotate_backup = backup;
+    return TRUE;
 }
 
 /* ================================================================= */
 
+/* Move a completely written temporary file into the place of datafile,
+ * carrying over the original's permissions and keeping the previous
+ * version as a backup link. */
+static gboolean
+gnc_xml_be_install_file(FileBackend *fbe, const char *tmp_name,
+                        const char *datafile)
+{
+    QofBackend *be = &fbe->be;
+    struct stat statbuf;
+    int rc;
+
+    /* Record the file's permissions before g_unlinking it */
+    rc = g_stat(datafile, &statbuf);
+    if (rc == 0)
+    {
+        /* We must never chmod the file /dev/null */
+        g_assert(g_strcmp0(tmp_name, "/dev/null") != 0);
+
+        /* Use the permissions from the original data file */
+        if (g_chmod(tmp_name, statbuf.st_mode) != 0)
+        {
+            /* qof_backend_set_error(be, ERR_BACKEND_PERM); */
+            /* qof_backend_set_message( be, "Failed to chmod filename %s", tmp_name ); */
+            /* Even if the chmod did fail, the save
+               nevertheless completed successfully. It is
+               therefore wrong to signal the ERR_BACKEND_PERM
+               error here which implies that the saving itself
+               failed. Instead, we simply ignore this. */
+            PWARN("unable to chmod filename %s: %s",
+                  tmp_name ? tmp_name : "(null)",
+                  g_strerror(errno) ? g_strerror(errno) : "");
+#if VFAT_DOESNT_SUCK  /* chmod always fails on vfat/samba fs */
+            /* g_free(tmp_name); */
+            /* return FALSE; */
+#endif
+        }
+#ifdef HAVE_CHOWN
+        /* Don't try to change the owner. Only root can do
+           that. */
+        if (chown(tmp_name, -1, statbuf.st_gid) != 0)
+        {
+            /* qof_backend_set_error(be, ERR_BACKEND_PERM); */
+            /* qof_backend_set_message( be, "Failed to chown filename %s", tmp_name ); */
+            /* A failed chown doesn't mean that the saving itself
+            failed. So don't abort with an error here! */
+            PWARN("unable to chown filename %s: %s",
+                  tmp_name ? tmp_name : "(null)",
+                  strerror(errno) ? strerror(errno) : "");
+#if VFAT_DOESNT_SUCK /* chown always fails on vfat fs */
+            /* g_free(tmp_name);
+            return FALSE; */
+#endif
+        }
+#endif
+    }
+    if (fbe->rotate_backup && g_strcmp0(datafile, fbe->fullpath) == 0)
+    {
+        rc = g_rename(datafile, fbe->rotate_backup);
+        g_free(fbe->rotate_backup);
+        fbe->rotate_backup = NULL;
+        if (rc != 0 && errno != ENOENT)
+        {
+            qof_backend_set_error(be, ERR_FILEIO_BACKUP_ERROR);
+            PWARN("unable to rotate %s to a backup: %s", datafile,
+                  g_strerror(errno) ? g_strerror(errno) : "");
+            return FALSE;
+        }
+    }
+    else if (g_unlink(datafile) != 0 && errno != ENOENT)
+    {
+        qof_backend_set_error(be, ERR_BACKEND_READONLY);
+        PWARN("unable to unlink filename %s: %s",
+              datafile ? datafile : "(null)",
+              g_strerror(errno) ? g_strerror(errno) : "");
+        return FALSE;
+    }
+    /* A rename moves the new file into place without touching its data;
+     * only fall back to link-or-copy if that is refused. */
+    if (g_rename(tmp_name, datafile) == 0)
+        return TRUE;
+    if (!gnc_int_link_or_make_backup(fbe, tmp_name, datafile))
+    {
+        qof_backend_set_error(be, ERR_FILEIO_BACKUP_ERROR);
+        qof_backend_set_message( be, "Failed to make backup file %s",
+                                 datafile ? datafile : "NULL" );
+        return FALSE;
+    }
+    if (g_unlink(tmp_name) != 0)
+    {
+        qof_backend_set_error(be, ERR_BACKEND_PERM);
+        PWARN("unable to unlink temp filename %s: %s",
+              tmp_name ? tmp_name : "(null)",
+              g_strerror(errno) ? g_strerror(errno) : "");
+        return FALSE;
+    }
+    return TRUE;
+}
+
 static gboolean
 gnc_xml_be_write_to_file(FileBackend *fbe,
                          QofBook *book,
@@ -698,8 +872,6 @@ gnc_xml_be_write_to_file(FileBackend *fbe,
 {
     QofBackend *be = &fbe->be;
     char *tmp_name;
-    struct stat statbuf;
-    int rc;
     QofBackendError be_err;
 
     ENTER (" book=%p file=%s", book, datafile);
@@ -739,75 +911,8 @@ gnc_xml_be_write_to_file(FileBackend *fbe,
 
     if (gnc_book_write_to_xml_file_v2(book, tmp_name, gnc_prefs_get_file_save_compressed()))
     {
-        /* Record the file's permissions before g_unlinking it */
-        rc = g_stat(datafile, &statbuf);
-        if (rc == 0)
-        {
-            /* We must never chmod the file /dev/null */
-            g_assert(g_strcmp0(tmp_name, "/dev/null") != 0);
-
-            /* Use the permissions from the original data file */
-            if (g_chmod(tmp_name, statbuf.st_mode) != 0)
-            {
-                /* qof_backend_set_error(be, ERR_BACKEND_PERM); */
-                /* qof_backend_set_message( be, "Failed to chmod filename %s", tmp_name ); */
-                /* Even if the chmod did fail, the save
-                   nevertheless completed successfully. It is
-                   therefore wrong to signal the ERR_BACKEND_PERM
-                   error here which implies that the saving itself
-                   failed. Instead, we simply ignore this. */
-                PWARN("unable to chmod filename %s: %s",
-                      tmp_name ? tmp_name : "(null)",
-                      g_strerror(errno) ? g_strerror(errno) : "");
-#if VFAT_DOESNT_SUCK  /* chmod always fails on vfat/samba fs */
-                /* g_free(tmp_name); */
-                /* return FALSE; */
-#endif
-            }
-#ifdef HAVE_CHOWN
-            /* Don't try to change the owner. Only root can do
-               that. */
-            if (chown(tmp_name, -1, statbuf.st_gid) != 0)
-            {
-                /* qof_backend_set_error(be, ERR_BACKEND_PERM); */
-                /* qof_backend_set_message( be, "Failed to chown filename %s", tmp_name ); */
-                /* A failed chown doesn't mean that the saving itself
-                failed. So don't abort with an error here! */
-                PWARN("unable to chown filename %s: %s",
-                      tmp_name ? tmp_name : "(null)",
-                      strerror(errno) ? strerror(errno) : "");
-#if VFAT_DOESNT_SUCK /* chown always fails on vfat fs */
-                /* g_free(tmp_name);
-                return FALSE; */
-#endif
-            }
-#endif
-        }
-        if (g_unlink(datafile) != 0 && errno != ENOENT)
+        if (!gnc_xml_be_install_file(fbe, tmp_name, datafile))
         {
-            qof_backend_set_error(be, ERR_BACKEND_READONLY);
-            PWARN("unable to unlink filename %s: %s",
-                  datafile ? datafile : "(null)",
-                  g_strerror(errno) ? g_strerror(errno) : "");
-            g_free(tmp_name);
-            LEAVE("");
-            return FALSE;
-        }
-        if (!gnc_int_link_or_make_backup(fbe, tmp_name, datafile))
-        {
-            qof_backend_set_error(be, ERR_FILEIO_BACKUP_ERROR);
-            qof_backend_set_message( be, "Failed to make backup file %s",
-                                     datafile ? datafile : "NULL" );
-            g_free(tmp_name);
-            LEAVE("");
-            return FALSE;
-        }
-        if (g_unlink(tmp_name) != 0)
-        {
-            qof_backend_set_error(be, ERR_BACKEND_PERM);
-            PWARN("unable to unlink temp filename %s: %s",
-                  tmp_name ? tmp_name : "(null)",
-                  g_strerror(errno) ? g_strerror(errno) : "");
             g_free(tmp_name);
             LEAVE("");
             return FALSE;
@@ -872,6 +977,11 @@ gnc_xml_be_remove_old_files(FileBackend *be)
     GDir *dir;
     struct stat lockstatbuf, statbuf;
     time64 now;
+    regex_t pattern;
+    gchar *expression;
+    gboolean have_pattern;
+    gint retention_policy;
+    int retention_days;
 
     if (g_stat (be->lockfile, &lockstatbuf) != 0)
         return;
@@ -880,6 +990,17 @@ gnc_xml_be_remove_old_files(FileBackend *be)
     if (!dir)
         return;
 
+    /* Compile the date stamp pattern and look up the retention policy
+     * once for the whole scan rather than for every directory entry. */
+    expression = g_strdup_printf ("^\\.[[:digit:]]{14}(\\%s|\\%s|\\.xac)$",
+                                  GNC_DATAFILE_EXT, GNC_LOGFILE_EXT);
+    have_pattern = regcomp(&pattern, expression, REG_EXTENDED | REG_ICASE) == 0;
+    if (!have_pattern)
+        PWARN("Cannot compile regex for date stamp");
+    g_free(expression);
+    retention_policy = gnc_prefs_get_file_retention_policy();
+    retention_days = gnc_prefs_get_file_retention_days();
+
     now = gnc_time(NULL);
     while ((dent = g_dir_read_name(dir)) != NULL)
     {
@@ -938,20 +1059,12 @@ gnc_xml_be_remove_old_files(FileBackend *be)
             /* Find the start of the date stamp. This takes some pointer
              * juggling, but considering the above tests, this should always
              * be safe */
-            regex_t pattern;
             gchar *stamp_start = name + strlen(be->fullpath);
-            gchar *expression = g_strdup_printf ("^\\.[[:digit:]]{14}(\\%s|\\%s|\\.xac)$",
-                                                 GNC_DATAFILE_EXT, GNC_LOGFILE_EXT);
             gboolean got_date_stamp = FALSE;
 
-            if (regcomp(&pattern, expression, REG_EXTENDED | REG_ICASE) != 0)
-                PWARN("Cannot compile regex for date stamp");
-            else if (regexec(&pattern, stamp_start, 0, NULL, 0) == 0)
+            if (have_pattern && regexec(&pattern, stamp_start, 0, NULL, 0) == 0)
                 got_date_stamp = TRUE;
 
-            regfree(&pattern);
-            g_free(expression);
-
             if (!got_date_stamp) /* Not a gnucash created file after all... */
             {
                 g_free(name);
@@ -962,13 +1075,13 @@ gnc_xml_be_remove_old_files(FileBackend *be)
         /* The file is a backup or log file. Check the user's retention preference
          * to determine if we should keep it or not
          */
-        if (gnc_prefs_get_file_retention_policy() == XML_RETAIN_NONE)
+        if (retention_policy == XML_RETAIN_NONE)
         {
             PINFO ("remove stale file: %s  - reason: preference XML_RETAIN_NONE", name);
             g_unlink(name);
         }
-        else if ((gnc_prefs_get_file_retention_policy() == XML_RETAIN_DAYS) &&
-                 (gnc_prefs_get_file_retention_days() > 0))
+        else if ((retention_policy == XML_RETAIN_DAYS) &&
+                 (retention_days > 0))
         {
             int days;
 
@@ -980,8 +1093,8 @@ gnc_xml_be_remove_old_files(FileBackend *be)
             }
             days = (int)(difftime(now, statbuf.st_mtime) / 86400);
 
-            PINFO ("file retention = %d days", gnc_prefs_get_file_retention_days());
-            if (days >= gnc_prefs_get_file_retention_days())
+            PINFO ("file retention = %d days", retention_days);
+            if (days >= retention_days)
             {
                 PINFO ("remove stale file: %s  - reason: more than %d days old", name, days);
                 g_unlink(name);
@@ -990,6 +1103,279 @@ gnc_xml_be_remove_old_files(FileBackend *be)
         g_free(name);
     }
     g_dir_close (dir);
+    if (have_pattern)
+        regfree(&pattern);
+}
+
+/* ================================================================= */
+/* The transaction journal. While it is active, committed transactions
+ * are appended to be->journalfile and a save just flushes it to disk.
+ * Any other change, or a journal grown past XML_JOURNAL_MAX_SIZE, makes
+ * the next save a full rewrite, which starts a new, empty journal. */
+
+static gboolean
+xml_journal_flush (FILE *journal)
+{
+    if (fflush (journal) != 0)
+        return FALSE;
+#ifdef G_OS_WIN32
+    return _commit (fileno (journal)) == 0;
+#else
+    return fsync (fileno (journal)) == 0;
+#endif
+}
+
+static void
+xml_journal_close (FileBackend *be)
+{
+    if (!be->journal)
+        return;
+    xml_journal_flush (be->journal);
+    fclose (be->journal);
+    be->journal = NULL;
+}
+
+/* Called after every successful full write: the file now holds all
+ * the journaled data, so the journal starts over. */
+static void
+xml_journal_reset (FileBackend *be)
+{
+    xml_journal_close (be);
+    be->journal_stale = FALSE;
+
+    if (!be->journalfile)
+        return;
+    if (be->be.commit != xml_commit_edit)
+    {
+        g_unlink (be->journalfile);
+        return;
+    }
+
+    be->journal = g_fopen (be->journalfile, "w");
+    if (!be->journal || !gnc_xml2_journal_write_header (be->journal)
+            || !xml_journal_flush (be->journal))
+    {
+        PWARN ("Unable to start journal %s", be->journalfile);
+        if (be->journal)
+            fclose (be->journal);
+        be->journal = NULL;
+        g_unlink (be->journalfile);
+    }
+}
+
+/* Apply a journal left by an earlier session and, if journaling, carry
+ * on appending to it. */
+static void
+xml_journal_load (FileBackend *be, QofBook *book)
+{
+    if (!be->journalfile)
+        return;
+
+    if (!g_file_test (be->journalfile, G_FILE_TEST_EXISTS))
+    {
+        if (be->be.commit == xml_commit_edit)
+            xml_journal_reset (be);
+        return;
+    }
+
+    if (!gnc_xml2_journal_replay (be->journalfile, book))
+    {
+        PWARN ("Journal %s is damaged, some changes may be lost",
+               be->journalfile);
+        be->journal_stale = TRUE;
+    }
+
+    if (be->be.commit == xml_commit_edit && !be->journal_stale)
+    {
+        be->journal = g_fopen (be->journalfile, "a");
+        if (!be->journal)
+            be->journal_stale = TRUE;
+    }
+    else
+        be->journal_stale = TRUE;
+}
+
+static void
+xml_commit_edit (QofBackend *bend, QofInstance *inst)
+{
+    FileBackend *be = (FileBackend *) bend;
+    gboolean ok;
+
+    if (!be->journal || be->journal_stale)
+        return;
+
+    /* Splits are journaled as part of their transaction. */
+    if (GNC_IS_SPLIT (inst))
+        return;
+
+    if (!GNC_IS_TRANSACTION (inst))
+    {
+        if (qof_instance_get_dirty_flag (inst) ||
+                qof_instance_get_destroying (inst))
+            be->journal_stale = TRUE;
+        return;
+    }
+
+    if (qof_instance_get_destroying (inst))
+        ok = gnc_xml2_journal_write_destroy (be->journal,
+                                             qof_instance_get_guid (inst));
+    else
+        ok = gnc_xml2_journal_write_trans (be->journal, GNC_TRANSACTION (inst));
+
+    if (!ok || fflush (be->journal) != 0)
+    {
+        PWARN ("Unable to append to journal %s", be->journalfile);
+        be->journal_stale = TRUE;
+    }
+}
+
+/* Try to make a save just a flush of the journal; FALSE means the file
+ * has to be rewritten. */
+static gboolean
+xml_journal_sync (FileBackend *be)
+{
+    if (!be->journal || be->journal_stale)
+        return FALSE;
+    if (ftell (be->journal) > XML_JOURNAL_MAX_SIZE)
+        return FALSE;
+    return xml_journal_flush (be->journal);
+}
+
+/* ================================================================= */
+/* Background saves. When the file is compressed and we are running
+ * inside a main loop, the book is serialized uncompressed on the calling
+ * thread -- so the file matches the book at that moment -- and only the
+ * compression runs on a worker thread. An idle callback then moves the
+ * result into place. */
+
+static gboolean xml_save_idle (gpointer data);
+
+static gpointer
+xml_save_thread_func (FileBackend *fbe)
+{
+    gboolean ok = gnc_xml2_compress_file (fbe->save_plainfile,
+                                          fbe->save_tmpfile);
+
+    /* The snapshot is exactly the uncompressed content of the new file;
+     * keep it as the open cache if asked to. */
+    if (!(ok && fbe->save_cachefile &&
+            (g_unlink (fbe->save_cachefile) == 0 || errno == ENOENT) &&
+            g_rename (fbe->save_plainfile, fbe->save_cachefile) == 0))
+        g_unlink (fbe->save_plainfile);
+    g_idle_add (xml_save_idle, fbe);
+    return GINT_TO_POINTER (ok);
+}
+
+/* Wait for a pending background save and complete it.  The book is
+ * marked saved only once the new file is in place, and only if nothing
+ * changed since the snapshot; a failure is set as the backend error. */
+static gboolean
+xml_save_finish (FileBackend *fbe)
+{
+    gboolean ok;
+
+    if (!fbe->save_thread)
+        return TRUE;
+
+    ENTER ("file=%s", fbe->fullpath);
+    ok = GPOINTER_TO_INT (g_thread_join (fbe->save_thread));
+    fbe->save_thread = NULL;
+    g_idle_remove_by_data (fbe);
+
+    if (ok)
+        ok = gnc_xml_be_install_file (fbe, fbe->save_tmpfile, fbe->fullpath);
+
+    if (ok)
+    {
+        if (fbe->book &&
+                qof_book_get_generation (fbe->book) == fbe->save_generation)
+            qof_book_mark_session_saved (fbe->book);
+        xml_journal_reset (fbe);
+        gnc_xml_be_remove_old_files (fbe);
+    }
+    else
+    {
+        PWARN ("Background save to %s failed", fbe->fullpath);
+        g_unlink (fbe->save_tmpfile);
+        /* Nothing reached the file and the book is still dirty: have
+         * the next save retry in the foreground. */
+        fbe->save_failed = TRUE;
+        qof_backend_set_error ((QofBackend*) fbe, ERR_FILEIO_WRITE_ERROR);
+    }
+
+    g_free (fbe->save_plainfile);
+    fbe->save_plainfile = NULL;
+    g_free (fbe->save_tmpfile);
+    fbe->save_tmpfile = NULL;
+    g_free (fbe->save_cachefile);
+    fbe->save_cachefile = NULL;
+    LEAVE ("ok=%d", ok);
+    return ok;
+}
+
+static gboolean
+xml_save_idle (gpointer data)
+{
+    xml_save_finish (static_cast<FileBackend*>(data));
+    return FALSE;
+}
+
+/* Returns FALSE, without setting an error, whenever the save has to be
+ * done in the foreground instead. */
+static gboolean
+xml_save_start (FileBackend *fbe, QofBook *book)
+{
+    char *tmp_name;
+    char *plain_name;
+
+    if (fbe->save_failed || g_main_depth () == 0
+            || fbe->be.commit == xml_commit_edit
+            || !gnc_prefs_get_file_save_compressed ())
+        return FALSE;
+
+    tmp_name = g_strconcat (fbe->fullpath, ".tmp-XXXXXX", NULL);
+    if (!mktemp (tmp_name))
+    {
+        g_free (tmp_name);
+        return FALSE;
+    }
+    plain_name = g_strconcat (tmp_name, ".plain", NULL);
+
+    if (!gnc_book_write_to_xml_file_v2 (book, plain_name, FALSE)
+            || !gnc_xml_be_backup_file (fbe))
+    {
+        g_unlink (plain_name);
+        g_free (plain_name);
+        g_free (tmp_name);
+        return FALSE;
+    }
+
+    fbe->save_plainfile = plain_name;
+    fbe->save_tmpfile = tmp_name;
+    fbe->save_generation = qof_book_get_generation (book);
+    if (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_XML_OPEN_CACHE))
+        fbe->save_cachefile = g_strconcat (fbe->fullpath, GNC_XML_CACHE_EXT,
+                                           NULL);
+#ifndef HAVE_GLIB_2_32
+    fbe->save_thread = g_thread_create ((GThreadFunc) xml_save_thread_func,
+                                        fbe, TRUE, NULL);
+#else
+    fbe->save_thread = g_thread_try_new ("xml_save",
+                                         (GThreadFunc) xml_save_thread_func,
+                                         fbe, NULL);
+#endif
+    if (!fbe->save_thread)
+    {
+        g_unlink (plain_name);
+        g_free (plain_name);
+        g_free (tmp_name);
+        g_free (fbe->save_cachefile);
+        fbe->save_plainfile = NULL;
+        fbe->save_tmpfile = NULL;
+        fbe->save_cachefile = NULL;
+        return FALSE;
+    }
+    return TRUE;
 }
 
 static void
@@ -1014,7 +1400,46 @@ xml_sync_all(QofBackend* be, QofBook *book)
         return;
     }
 
-    gnc_xml_be_write_to_file (fbe, book, fbe->fullpath, TRUE);
+    /* A background save that failed since the last sync is retried in
+     * the foreground below, which reports its own outcome. */
+    if (fbe->save_failed)
+        qof_backend_get_error (be);
+
+    /* One that fails now is reported now; the next save retries it. */
+    if (!xml_save_finish (fbe))
+    {
+        LEAVE ("book=%p background save failed", book);
+        return;
+    }
+
+    if (xml_journal_sync (fbe))
+    {
+        LEAVE ("book=%p journaled", book);
+        return;
+    }
+
+    gnc_xml2_set_compression (
+        gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                           GNC_PREF_FILE_COMPRESSION_LEVEL),
+        MAX (gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                GNC_PREF_FILE_COMPRESSION_THREADS), 0));
+
+    if (xml_save_start (fbe, book))
+    {
+        LEAVE ("book=%p saving in background", book);
+        return;
+    }
+
+    if (gnc_xml_be_write_to_file (fbe, book, fbe->fullpath, TRUE))
+    {
+        gchar *cachefile = g_strconcat (fbe->fullpath, GNC_XML_CACHE_EXT, NULL);
+
+        /* Only background saves refresh the open cache; drop a stale one. */
+        g_unlink (cachefile);
+        g_free (cachefile);
+        fbe->save_failed = FALSE;
+        xml_journal_reset (fbe);
+    }
     gnc_xml_be_remove_old_files (fbe);
     LEAVE ("book=%p", book);
 }
@@ -1165,9 +1590,16 @@ gnc_xml_be_load_from_file (QofBackend *bend, QofBook *book, QofBackendLoadType l
     {
         qof_backend_set_error(bend, error);
     }
+    else
+        xml_journal_load (be, book);
 
     /* We just got done loading, it can't possibly be dirty !! */
     qof_book_mark_session_saved (book);
+
+    /* ... unless a journal was replayed that is not being continued: its
+     * data only reaches the file with the next full save. */
+    if (be->journal_stale)
+        qof_book_mark_session_dirty (book);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -1238,6 +1670,17 @@ gnc_backend_new(void)
 
     gnc_be->book = NULL;
 
+    gnc_be->journalfile = NULL;
+    gnc_be->journal = NULL;
+    gnc_be->journal_stale = FALSE;
+
+    gnc_be->save_thread = NULL;
+    gnc_be->save_plainfile = NULL;
+    gnc_be->save_tmpfile = NULL;
+    gnc_be->save_cachefile = NULL;
+    gnc_be->save_failed = FALSE;
+    gnc_be->rotate_backup = NULL;
+
     return be;
 }
 
@@ -38,6 +38,9 @@ extern "C"
 #include <gmodule.h>
 #include "qofbackend-p.h"
 
+/** Suffix of the uncompressed copy of a compressed book that may be kept
+ * next to it to speed up opening it again. */
+#define GNC_XML_CACHE_EXT ".cache"
 
 typedef enum
 {
@@ -67,6 +70,19 @@ struct FileBackend_struct
     int lockfd;
 
     QofBook *book;  /* The primary, main open book */
+
+    char *journalfile; /* Transactions committed since the last full write */
+    FILE *journal;     /* Open for appending while journaling is active */
+    gboolean journal_stale; /* Non-transaction data changed; rewrite fully */
+
+    GThread *save_thread; /* Compressing a background save */
+    char *save_plainfile; /* Its uncompressed snapshot of the book */
+    char *save_tmpfile;   /* and the compressed file it is writing */
+    char *save_cachefile; /* Where to keep the snapshot as open cache */
+    guint64 save_generation; /* Of the book when the snapshot was taken */
+    gboolean save_failed; /* The last background save did not complete */
+
+    char *rotate_backup; /* Rename the old file to this on the next install */
 };
 
 typedef struct FileBackend_struct FileBackend;
@@ -196,6 +196,19 @@ gnc_transaction_dom_tree_create(Transaction *trn)
 
 /***********************************************************************/
 
+/* The GUID in node's child element tag, if there is one, so that the
+ * instance can be created with it; g_free it. */
+static GncGUID *
+dom_tree_find_guid(xmlNodePtr node, const gchar *tag)
+{
+    xmlNodePtr mark;
+
+    for (mark = node->xmlChildrenNode; mark; mark = mark->next)
+        if (g_strcmp0(tag, (char*)mark->name) == 0)
+            return dom_tree_to_guid(mark);
+    return NULL;
+}
+
 struct split_pdata
 {
     Split *split;
@@ -384,10 +397,13 @@ dom_tree_to_split(xmlNodePtr node, QofBook *book)
 {
     struct split_pdata pdata;
     Split *ret;
+    GncGUID *guid;
 
     g_return_val_if_fail (book, NULL);
 
-    ret = xaccMallocSplit(book);
+    guid = dom_tree_find_guid(node, "split:id");
+    ret = xaccMallocSplitWithGUID(book, guid);
+    g_free(guid);
     g_return_val_if_fail(ret, NULL);
 
     pdata.split = ret;
@@ -615,11 +631,14 @@ dom_tree_to_transaction( xmlNodePtr node, QofBook *book )
     Transaction *trn;
     gboolean successful;
     struct trans_pdata pdata;
+    GncGUID *guid;
 
     g_return_val_if_fail(node, NULL);
     g_return_val_if_fail(book, NULL);
 
-    trn = xaccMallocTransaction(book);
+    guid = dom_tree_find_guid(node, "trn:id");
+    trn = xaccMallocTransactionWithGUID(book, guid);
+    g_free(guid);
     g_return_val_if_fail(trn, NULL);
     xaccTransBeginEdit(trn);
 
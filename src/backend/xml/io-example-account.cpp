@@ -320,19 +320,29 @@ gnc_titse_sixtp_parser_create(void)
 }
 
 
-GncExampleAccount*
-gnc_read_example_account(const gchar *filename)
+/* A parser that accepts and drops an element and everything below it,
+ * without building a DOM tree. */
+static sixtp*
+gnc_skip_sixtp_parser_create(void)
 {
-    GncExampleAccount *gea;
-    sixtp *top_parser;
-    sixtp *main_parser;
-
-    g_return_val_if_fail (filename != NULL, NULL);
+    sixtp *skip = sixtp_new();
 
-    gea = g_new0(GncExampleAccount, 1);
+    if (skip && !sixtp_add_sub_parser(skip, SIXTP_MAGIC_CATCHER, skip))
+    {
+        sixtp_destroy(skip);
+        return NULL;
+    }
+    return skip;
+}
 
-    gea->book = qof_book_new();
-    gea->filename = g_strdup(filename);
+/* Parse the header elements, the account tree, or both out of gea's
+ * file; whatever is not wanted is skipped. */
+static gboolean
+example_account_parse(GncExampleAccount *gea, gboolean want_header,
+                      gboolean want_tree)
+{
+    sixtp *top_parser;
+    sixtp *main_parser;
 
     top_parser = sixtp_new();
     main_parser = sixtp_new();
@@ -342,29 +352,53 @@ gnc_read_example_account(const gchar *filename)
                 GNC_ACCOUNT_STRING, main_parser,
                 NULL, NULL))
     {
-        gnc_destroy_example_account(gea);
         return FALSE;
     }
 
     if (!sixtp_add_some_sub_parsers(
                 main_parser, TRUE,
-                GNC_ACCOUNT_TITLE, gnc_titse_sixtp_parser_create(),
-                GNC_ACCOUNT_SHORT, gnc_short_descrip_sixtp_parser_create(),
-                GNC_ACCOUNT_LONG, gnc_long_descrip_sixtp_parser_create(),
-                GNC_ACCOUNT_EXCLUDEP, gnc_excludep_sixtp_parser_create(),
-                GNC_ACCOUNT_SELECTED, gnc_selected_sixtp_parser_create(),
-                "gnc:account", gnc_account_sixtp_parser_create(),
+                GNC_ACCOUNT_TITLE, want_header ?
+                gnc_titse_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
+                GNC_ACCOUNT_SHORT, want_header ?
+                gnc_short_descrip_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
+                GNC_ACCOUNT_LONG, want_header ?
+                gnc_long_descrip_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
+                GNC_ACCOUNT_EXCLUDEP, want_header ?
+                gnc_excludep_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
+                GNC_ACCOUNT_SELECTED, want_header ?
+                gnc_selected_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
+                "gnc:account", want_tree ?
+                gnc_account_sixtp_parser_create() : gnc_skip_sixtp_parser_create(),
                 NULL, NULL))
     {
-        gnc_destroy_example_account(gea);
         return FALSE;
     }
 
-    if (!gnc_xml_parse_file(top_parser, filename,
+    if (!gnc_xml_parse_file(top_parser, gea->filename,
                             generic_callback, gea, gea->book))
     {
         sixtp_destroy(top_parser);
         xaccLogEnable ();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+GncExampleAccount*
+gnc_read_example_account(const gchar *filename)
+{
+    GncExampleAccount *gea;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+
+    gea = g_new0(GncExampleAccount, 1);
+
+    gea->book = qof_book_new();
+    gea->filename = g_strdup(filename);
+
+    if (!example_account_parse(gea, TRUE, TRUE))
+    {
         gnc_destroy_example_account(gea);
         return FALSE;
     }
@@ -372,6 +406,44 @@ gnc_read_example_account(const gchar *filename)
     return gea;
 }
 
+GncExampleAccount*
+gnc_read_example_account_header(const gchar *filename)
+{
+    GncExampleAccount *gea;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+
+    gea = g_new0(GncExampleAccount, 1);
+    gea->filename = g_strdup(filename);
+
+    if (!example_account_parse(gea, TRUE, FALSE))
+    {
+        gnc_destroy_example_account(gea);
+        return NULL;
+    }
+
+    return gea;
+}
+
+gboolean
+gnc_example_account_load_tree(GncExampleAccount *gea)
+{
+    g_return_val_if_fail (gea != NULL, FALSE);
+
+    if (gea->root)
+        return TRUE;
+
+    if (!gea->book)
+        gea->book = qof_book_new();
+
+    if (!example_account_parse(gea, FALSE, TRUE))
+        return FALSE;
+
+    if (!gea->root)
+        gea->root = gnc_book_get_root_account(gea->book);
+    return TRUE;
+}
+
 static void
 write_string_part(FILE *out, const char *tag, const char *data)
 {
@@ -455,8 +527,9 @@ gnc_free_example_account_list(GSList *list)
     g_slist_free(list);
 }
 
-GSList*
-gnc_load_example_account_list(const char *dirname)
+static GSList*
+load_example_account_list(const char *dirname,
+                          GncExampleAccount *(*reader)(const gchar *filename))
 {
     GSList *ret;
     GDir *dir;
@@ -483,7 +556,7 @@ gnc_load_example_account_list(const char *dirname)
 
         if (!g_file_test(filename, G_FILE_TEST_IS_DIR))
         {
-            gea = gnc_read_example_account(filename);
+            gea = reader(filename);
 
             if (gea == NULL)
             {
@@ -503,6 +576,18 @@ gnc_load_example_account_list(const char *dirname)
     return ret;
 }
 
+GSList*
+gnc_load_example_account_list(const char *dirname)
+{
+    return load_example_account_list(dirname, gnc_read_example_account);
+}
+
+GSList*
+gnc_load_example_account_header_list(const char *dirname)
+{
+    return load_example_account_list(dirname, gnc_read_example_account_header);
+}
+
 
 
 /***********************************************************************/
@@ -50,10 +50,15 @@ void gnc_destroy_example_account(GncExampleAccount *gea);
 gboolean gnc_write_example_account(GncExampleAccount *gea,
                                    const gchar *filename);
 GncExampleAccount *gnc_read_example_account(const gchar *filename);
+/* Reads only the title, descriptions and flags; root and book stay NULL
+ * until gnc_example_account_load_tree is called. */
+GncExampleAccount *gnc_read_example_account_header(const gchar *filename);
+gboolean gnc_example_account_load_tree(GncExampleAccount *gea);
 
 
 void gnc_free_example_account_list(GSList *list);
 GSList* gnc_load_example_account_list(const char *dirname);
+GSList* gnc_load_example_account_header_list(const char *dirname);
 #ifdef __cplusplus
 }
 #endif
@@ -59,3 +59,35 @@ gnc_xml_parse_fd(sixtp *top_parser, FILE *fd,
     return sixtp_parse_fd(top_parser, fd,
                           NULL, &gpdata, &parse_result);
 }
+
+gboolean
+gnc_xml_parse_io(sixtp *top_parser, xmlInputReadCallback read_func,
+                 gpointer read_context, gxpf_callback callback,
+                 gpointer parsedata, gpointer bookdata)
+{
+    gpointer parse_result = NULL;
+    gxpf_data gpdata;
+
+    gpdata.cb = callback;
+    gpdata.parsedata = parsedata;
+    gpdata.bookdata = bookdata;
+
+    return sixtp_parse_io(top_parser, read_func, read_context,
+                          NULL, &gpdata, &parse_result);
+}
+
+gboolean
+gnc_xml_parse_buffer(sixtp *top_parser, char *bufp, gsize bufsz,
+                     gxpf_callback callback, gpointer parsedata,
+                     gpointer bookdata)
+{
+    gpointer parse_result = NULL;
+    gxpf_data gpdata;
+
+    gpdata.cb = callback;
+    gpdata.parsedata = parsedata;
+    gpdata.bookdata = bookdata;
+
+    return sixtp_parse_buffer(top_parser, bufp, bufsz,
+                              NULL, &gpdata, &parse_result);
+}
@@ -53,4 +53,14 @@ gnc_xml_parse_fd(sixtp *top_parser, FILE *fd,
                  gxpf_callback callback, gpointer parsedata,
                  gpointer bookdata);
 
+gboolean
+gnc_xml_parse_io(sixtp *top_parser, xmlInputReadCallback read_func,
+                 gpointer read_context, gxpf_callback callback,
+                 gpointer parsedata, gpointer bookdata);
+
+gboolean
+gnc_xml_parse_buffer(sixtp *top_parser, char *bufp, gsize bufsz,
+                     gxpf_callback callback, gpointer parsedata,
+                     gpointer bookdata);
+
 #endif /* IO_GNCXML_GEN_H */
@@ -39,6 +39,7 @@ extern "C"
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <string.h>
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
@@ -54,6 +55,8 @@ extern "C"
 #include "Transaction.h"
 #include "TransactionP.h"
 #include "TransLog.h"
+#include "gncInvoice.h"
+#include "gncInvoiceP.h"
 #if PLATFORM(WINDOWS)
 #ifdef __STRICT_ANSI_UNSET__
 #undef __STRICT_ANSI_UNSET__
@@ -71,6 +74,7 @@ extern "C"
 #include "sixtp-utils.h"
 #include "gnc-xml.h"
 #include "io-utils.h"
+#include "sixtp-dom-generators.h"
 #include "sixtp-dom-parsers.h"
 #include "io-gncxml-v2.h"
 #include "io-gncxml-gen.h"
@@ -106,6 +110,7 @@ struct file_backend
     const char    * tag;
     sixtp         * parser;
     FILE          * out;
+    xmlOutputBufferPtr outbuf;
     QofBook       * book;
 };
 
@@ -118,6 +123,11 @@ extern const gchar *gnc_v2_book_version_string;        /* see gnc-book-xml-v2 */
 static FILE *try_gz_open (const char *filename, const char *perms, gboolean use_gzip,
                           gboolean compress);
 static gboolean is_gzipped_file(const gchar *name);
+static gzFile gz_open_file(const gchar *filename, const gchar *perms);
+typedef struct xml_load_source xml_load_source;
+static int xml_load_source_read(void *context, char *buffer, int len);
+static gboolean xml_cache_is_current(const gchar *filename,
+                                     const gchar *cachename);
 static gboolean wait_for_gzip(FILE *file);
 
 static void
@@ -799,22 +809,70 @@ qof_session_load_from_xml_file_v2_full(
 	 * info.
 	 */
 	gchar *filename = fbe->fullpath;
-	FILE *file;
+	gchar *cachename = g_strconcat(filename, GNC_XML_CACHE_EXT, NULL);
 	gboolean is_compressed = is_gzipped_file(filename);
-	file = try_gz_open(filename, "r", is_compressed, FALSE);
-	if (file == NULL)
+	xml_load_source src;
+
+	if (is_compressed && xml_cache_is_current(filename, cachename))
+	{
+	    PINFO("Reading %s from its uncompressed cache", filename);
+	    filename = cachename;
+	    is_compressed = FALSE;
+	}
+
+	/* Progress follows the bytes read, not the object counts. */
+	gd->countCallback = NULL;
+	xml_load_source_init(&src, filename, gd->gui_display_fn);
+
+	if (is_compressed)
 	{
-	    PWARN("Unable to open file %s", filename);
-	    retval = FALSE;
+	    /* Inflate in-process, feeding the parser directly rather than
+	     * going through a pipe and a decompression thread. */
+	    src.gzfile = gz_open_file(filename, "rb");
+	    if (src.gzfile == NULL)
+	    {
+		PWARN("Unable to open file %s", filename);
+		retval = FALSE;
+	    }
+	    else
+	    {
+		retval = gnc_xml_parse_io(top_parser, xml_load_source_read, &src,
+					  generic_callback, gd, book);
+		gzclose(src.gzfile);
+	    }
 	}
 	else
 	{
-	    retval = gnc_xml_parse_fd(top_parser, file,
-				      generic_callback, gd, book);
-	    fclose(file);
-	    if (is_compressed)
-		wait_for_gzip(file);
+	    /* Parse straight out of a read-only mapping of the file. */
+	    GMappedFile *map = g_mapped_file_new(filename, FALSE, NULL);
+	    if (map && g_mapped_file_get_length(map) > 0
+		    && g_mapped_file_get_length(map) <= G_MAXINT)
+	    {
+		src.data = g_mapped_file_get_contents(map);
+		src.length = g_mapped_file_get_length(map);
+		src.total = src.length;
+		retval = gnc_xml_parse_io(top_parser, xml_load_source_read, &src,
+					  generic_callback, gd, book);
+	    }
+	    else
+	    {
+		src.file = g_fopen(filename, "r");
+		if (src.file == NULL)
+		{
+		    PWARN("Unable to open file %s", filename);
+		    retval = FALSE;
+		}
+		else
+		{
+		    retval = gnc_xml_parse_io(top_parser, xml_load_source_read,
+					      &src, generic_callback, gd, book);
+		    fclose(src.file);
+		}
+	    }
+	    if (map)
+		g_mapped_file_unref(map);
 	}
+	g_free(cachename);
     }
 
     if (!retval)
@@ -844,11 +902,8 @@ qof_session_load_from_xml_file_v2_full(
     root = gnc_book_get_root_account(book);
     xaccAccountTreeScrubQuoteSources (root, gnc_commodity_table_get_table(book));
 
-    /* Fix account and transaction commodities */
-    xaccAccountTreeScrubCommodities (root);
-
-    /* Fix split amount/value */
-    xaccAccountTreeScrubSplits (root);
+    /* Fix account and transaction commodities and split amount/value */
+    xaccAccountTreeScrubCommoditiesAndSplits (root);
 
     /* commit all groups, this completes the BeginEdit started when the
      * account_end_handler finished reading the account.
@@ -1184,10 +1239,14 @@ xml_add_trn_data(Transaction *t, gpointer data)
 
     node = gnc_transaction_dom_tree_create(t);
 
-    xmlElemDump(be_data->out, NULL, node);
+    /* This writes what xmlElemDump would, but through the one output
+       buffer the caller made for all the transactions, rather than a new
+       one for each. */
+    xmlNodeDumpOutput(be_data->outbuf, NULL, node, 0, 1, NULL);
     xmlFreeNode(node);
+    xmlOutputBufferWrite(be_data->outbuf, 1, "\n");
 
-    if (ferror(be_data->out) || fprintf(be_data->out, "\n") < 0)
+    if (be_data->outbuf->error || ferror(be_data->out))
         return -1;
 
     be_data->gd->counter.transactions_loaded++;
@@ -1195,6 +1254,169 @@ xml_add_trn_data(Transaction *t, gpointer data)
     return 0;
 }
 
+/* Parallel serialization of the transaction list: the transactions are
+ * collected in traversal order, cut into XML_TRN_CHUNK_SIZE chunks and
+ * rendered to memory by a thread pool, then written out chunk by chunk
+ * in order.  xmlNodeDump and xmlNodeDumpOutput share one serializer, so
+ * the bytes match the sequential path exactly.  Building the DOM only
+ * reads the engine objects; the traversal itself, the file I/O and the
+ * progress callback stay on the calling thread. */
+#ifdef HAVE_GLIB_2_36
+#define XML_TRN_CHUNK_SIZE 256
+
+typedef struct
+{
+    Transaction **trans;
+    guint n_trans;
+    xmlBufferPtr buf;
+    gboolean done;
+    gboolean ok;
+} xml_trn_chunk_t;
+
+static GMutex xml_trn_chunk_mutex;
+static GCond xml_trn_chunk_cond;
+
+static int
+xml_collect_trn(Transaction *t, gpointer data)
+{
+    g_ptr_array_add(static_cast<GPtrArray*>(data), t);
+    return 0;
+}
+
+static void
+xml_dump_trn_chunk(xml_trn_chunk_t *chunk, gpointer user_data)
+{
+    gboolean ok = TRUE;
+    guint i;
+
+    for (i = 0; ok && i < chunk->n_trans; i++)
+    {
+        xmlNodePtr node = gnc_transaction_dom_tree_create(chunk->trans[i]);
+        ok = xmlNodeDump(chunk->buf, NULL, node, 0, 1) >= 0
+             && xmlBufferAdd(chunk->buf, BAD_CAST "\n", 1) == 0;
+        xmlFreeNode(node);
+    }
+
+    g_mutex_lock(&xml_trn_chunk_mutex);
+    chunk->ok = ok;
+    chunk->done = TRUE;
+    g_cond_broadcast(&xml_trn_chunk_cond);
+    g_mutex_unlock(&xml_trn_chunk_mutex);
+}
+
+static gboolean
+write_transactions_parallel(GPtrArray *trans, struct file_backend *be_data,
+                            guint nthreads)
+{
+    guint n_chunks = (trans->len + XML_TRN_CHUNK_SIZE - 1) / XML_TRN_CHUNK_SIZE;
+    xml_trn_chunk_t *chunks = g_new0(xml_trn_chunk_t, n_chunks);
+    guint window = 2 * nthreads, pushed = 0, i;
+    gboolean ok = TRUE;
+    GThreadPool *pool;
+
+    pool = g_thread_pool_new((GFunc)xml_dump_trn_chunk, NULL, nthreads, FALSE,
+                             NULL);
+    if (pool == NULL)
+    {
+        g_free(chunks);
+        return FALSE;
+    }
+
+    for (i = 0; i < n_chunks; i++)
+    {
+        chunks[i].trans = (Transaction**)trans->pdata + i * XML_TRN_CHUNK_SIZE;
+        chunks[i].n_trans = MIN(XML_TRN_CHUNK_SIZE,
+                                trans->len - i * XML_TRN_CHUNK_SIZE);
+    }
+
+    /* Keep at most window chunks rendered but unwritten. */
+    for (i = 0; i < n_chunks; i++)
+    {
+        xml_trn_chunk_t *chunk = &chunks[i];
+
+        while (ok && pushed < n_chunks && pushed < i + window)
+        {
+            chunks[pushed].buf = xmlBufferCreate();
+            g_thread_pool_push(pool, &chunks[pushed], NULL);
+            pushed++;
+        }
+        if (i >= pushed)
+            break;
+
+        g_mutex_lock(&xml_trn_chunk_mutex);
+        while (!chunk->done)
+            g_cond_wait(&xml_trn_chunk_cond, &xml_trn_chunk_mutex);
+        g_mutex_unlock(&xml_trn_chunk_mutex);
+
+        if (ok && chunk->ok)
+        {
+            xmlOutputBufferWrite(be_data->outbuf, xmlBufferLength(chunk->buf),
+                                 (const char*)xmlBufferContent(chunk->buf));
+            ok = !(be_data->outbuf->error || ferror(be_data->out));
+        }
+        else
+            ok = FALSE;
+        xmlBufferFree(chunk->buf);
+        chunk->buf = NULL;
+
+        if (ok)
+        {
+            be_data->gd->counter.transactions_loaded += chunk->n_trans;
+            sixtp_run_callback(be_data->gd, "transaction");
+        }
+    }
+
+    /* On failure, let the chunks already queued finish before their
+     * buffers go away. */
+    g_thread_pool_free(pool, FALSE, TRUE);
+    for (i = 0; i < pushed; i++)
+        if (chunks[i].buf)
+            xmlBufferFree(chunks[i].buf);
+    g_free(chunks);
+    return ok;
+}
+#endif /* HAVE_GLIB_2_36 */
+
+static gboolean
+write_transactions_with_outbuf(Account *root, struct file_backend *be_data)
+{
+    gboolean ok;
+
+    be_data->outbuf = xmlOutputBufferCreateFile(be_data->out, NULL);
+    if (be_data->outbuf == NULL)
+        return FALSE;
+
+#ifdef HAVE_GLIB_2_36
+    if (g_get_num_processors() > 1)
+    {
+        GPtrArray *trans = g_ptr_array_new();
+
+        xaccAccountTreeForEachTransaction(root, xml_collect_trn, trans);
+        if (trans->len > XML_TRN_CHUNK_SIZE)
+            ok = write_transactions_parallel(trans, be_data,
+                                             g_get_num_processors());
+        else
+        {
+            guint i;
+
+            ok = TRUE;
+            for (i = 0; ok && i < trans->len; i++)
+                ok = 0 == xml_add_trn_data(static_cast<Transaction*>(trans->pdata[i]),
+                                           be_data);
+        }
+        g_ptr_array_free(trans, TRUE);
+    }
+    else
+#endif
+    ok = 0 == xaccAccountTreeForEachTransaction(root, xml_add_trn_data,
+                                                (gpointer) be_data);
+    /* Closing flushes the buffer into out, which stays open */
+    if (xmlOutputBufferClose(be_data->outbuf) < 0)
+        ok = FALSE;
+    be_data->outbuf = NULL;
+    return ok;
+}
+
 static gboolean
 write_transactions(FILE *out, QofBook *book, sixtp_gdv2 *gd)
 {
@@ -1202,10 +1424,8 @@ write_transactions(FILE *out, QofBook *book, sixtp_gdv2 *gd)
 
     be_data.out = out;
     be_data.gd = gd;
-    return 0 ==
-           xaccAccountTreeForEachTransaction(gnc_book_get_root_account(book),
-                   xml_add_trn_data,
-                   (gpointer) &be_data);
+    return write_transactions_with_outbuf(gnc_book_get_root_account(book),
+                                          &be_data);
 }
 
 static gboolean
@@ -1222,7 +1442,7 @@ write_template_transaction_data( FILE *out, QofBook *book, sixtp_gdv2 *gd )
     {
         if (fprintf(out, "<%s>\n", TEMPLATE_TRANSACTION_TAG) < 0
                 || !write_account_tree(out, ra, gd)
-                || xaccAccountTreeForEachTransaction(ra, xml_add_trn_data, (gpointer)&be_data)
+                || !write_transactions_with_outbuf(ra, &be_data)
                 || fprintf(out, "</%s>\n", TEMPLATE_TRANSACTION_TAG) < 0)
 
             return FALSE;
@@ -1407,49 +1627,438 @@ gnc_book_write_accounts_to_xml_filehandle_v2(QofBackend *be, QofBook *book, FILE
 
 #define BUFLEN 4096
 
-/* Compress or decompress function that is to be run in a separate thread.
- * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
-static gpointer
-gz_thread_func(gz_thread_params_t *params)
+#define GZ_IO_BUFFER_SIZE (128 * 1024)
+
+static gzFile
+gz_open_file(const gchar *filename, const gchar *perms)
 {
-    gchar buffer[BUFLEN];
-    gssize bytes;
-    gint gzval;
     gzFile file;
-    gint success = 1;
 
 #ifdef G_OS_WIN32
     {
-        gchar *conv_name = g_win32_locale_filename_from_utf8(params->filename);
-        gchar *perms;
+        gchar *conv_name = g_win32_locale_filename_from_utf8(filename);
+        gchar *bin_perms;
 
         if (!conv_name)
         {
-            g_warning("Could not convert '%s' to system codepage",
-                      params->filename);
-            success = 0;
-            goto cleanup_gz_thread_func;
+            g_warning("Could not convert '%s' to system codepage", filename);
+            return NULL;
         }
 
-        if (strchr(params->perms, 'b'))
-            perms = g_strdup(params->perms);
+        if (strchr(perms, 'b'))
+            bin_perms = g_strdup(perms);
         else
-            perms = g_strdup_printf("%cb%s", *params->perms, params->perms + 1);
+            bin_perms = g_strdup_printf("%cb%s", *perms, perms + 1);
 
-        file = gzopen(conv_name, perms);
-        g_free(perms);
+        file = gzopen(conv_name, bin_perms);
+        g_free(bin_perms);
         g_free(conv_name);
     }
 #else /* !G_OS_WIN32 */
-    file = gzopen(params->filename, params->perms);
+    file = gzopen(filename, perms);
 #endif /* G_OS_WIN32 */
 
+#if ZLIB_VERNUM >= 0x1240
+    if (file)
+        gzbuffer(file, GZ_IO_BUFFER_SIZE);
+#endif
+    return file;
+}
+
+/* The file backend may keep an uncompressed copy of a compressed book
+ * next to it, from which the book opens without inflating it. The copy
+ * is only trusted if its length and CRC match the gzip trailer of the
+ * book, so a stale or damaged cache is simply ignored. */
+static gboolean
+xml_cache_is_current(const gchar *filename, const gchar *cachename)
+{
+    guchar trailer[8];
+    guint32 crc, isize;
+    uLong cache_crc;
+    GMappedFile *map;
+    const gchar *data;
+    gsize length, done;
+    FILE *file;
+    gboolean ok;
+
+    file = g_fopen(filename, "rb");
+    if (!file)
+        return FALSE;
+    ok = fseek(file, -(long)sizeof(trailer), SEEK_END) == 0
+         && fread(trailer, 1, sizeof(trailer), file) == sizeof(trailer);
+    fclose(file);
+    if (!ok)
+        return FALSE;
+
+    crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16)
+          | ((guint32)trailer[3] << 24);
+    isize = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16)
+            | ((guint32)trailer[7] << 24);
+
+    map = g_mapped_file_new(cachename, FALSE, NULL);
+    if (!map)
+        return FALSE;
+    data = g_mapped_file_get_contents(map);
+    length = g_mapped_file_get_length(map);
+    ok = length > 0 && (guint32)length == isize;
+
+    cache_crc = crc32(0L, Z_NULL, 0);
+    for (done = 0; ok && done < length;)
+    {
+        uInt chunk = (uInt)MIN(length - done, (gsize)G_MAXINT);
+        cache_crc = crc32(cache_crc, (const Bytef*)data + done, chunk);
+        done += chunk;
+    }
+    g_mapped_file_unref(map);
+
+    return ok && (guint32)cache_crc == crc;
+}
+
+/* What the loader reads from: exactly one of gzfile, data or file is
+ * set.  Progress comes from the position in the file on disk, so it
+ * needs neither the count-data headers nor a callback per object, and is
+ * reported at most every XML_LOAD_PROGRESS_INTERVAL microseconds. */
+#define XML_LOAD_PROGRESS_INTERVAL (G_USEC_PER_SEC / 10)
+
+struct xml_load_source
+{
+    gzFile gzfile;
+    const gchar *data;
+    gsize length;
+    gsize offset;
+    FILE *file;
+    gint64 total;
+    gint64 next_update;
+    QofBePercentageFunc percentage;
+};
+
+static void
+xml_load_source_init(xml_load_source *src, const gchar *filename,
+                     QofBePercentageFunc percentage)
+{
+    struct stat st;
+
+    memset(src, 0, sizeof(*src));
+    src->percentage = percentage;
+    if (g_stat(filename, &st) == 0)
+        src->total = st.st_size;
+}
+
+static void
+xml_load_source_progress(xml_load_source *src, gint64 pos)
+{
+    gint64 now;
+
+    if (!src->percentage || pos < 0 || src->total <= 0)
+        return;
+    now = g_get_monotonic_time();
+    if (now < src->next_update)
+        return;
+    src->next_update = now + XML_LOAD_PROGRESS_INTERVAL;
+    src->percentage(NULL, MIN(pos, src->total) * 100 / src->total);
+}
+
+/* libxml2 read callback; a compressed file is inflated straight into the
+ * parser's buffer. */
+static int
+xml_load_source_read(void *context, char *buffer, int len)
+{
+    xml_load_source *src = static_cast<xml_load_source*>(context);
+    gint64 pos = -1;
+    int ret;
+
+    if (src->gzfile)
+    {
+        ret = gzread(src->gzfile, buffer, len);
+        if (ret < 0)
+        {
+            gint errnum;
+            const gchar *error = gzerror(src->gzfile, &errnum);
+            g_warning("Could not read from compressed file. The error is: '%s' (%d)",
+                      error, errnum);
+            return ret;
+        }
+#if ZLIB_VERNUM >= 0x1240
+        pos = gzoffset(src->gzfile);
+#endif
+    }
+    else if (src->data)
+    {
+        ret = MIN((gsize)len, src->length - src->offset);
+        memcpy(buffer, src->data + src->offset, ret);
+        src->offset += ret;
+        pos = src->offset;
+    }
+    else
+    {
+        ret = fread(buffer, 1, len, src->file);
+        if (ret == 0 && ferror(src->file))
+            return -1;
+        pos = ftell(src->file);
+    }
+
+    xml_load_source_progress(src, pos);
+    return ret;
+}
+
+/* The compression settings, from gnc_xml2_set_compression(). */
+static gint gz_compress_level = Z_DEFAULT_COMPRESSION;
+static guint gz_compress_threads = 0;
+
+void
+gnc_xml2_set_compression(gint level, guint nthreads)
+{
+    gz_compress_level = (level >= 1 && level <= 9) ? level
+                        : Z_DEFAULT_COMPRESSION;
+    gz_compress_threads = nthreads;
+}
+
+/* Parallel compression, after pigz: the uncompressed stream is cut into
+ * GZ_BLOCK_SIZE blocks that are deflated independently by a thread pool,
+ * each primed with the last GZ_DICT_SIZE bytes of its predecessor so the
+ * ratio stays close to that of a single stream.  Every block ends with a
+ * sync flush, so the raw deflate data can simply be concatenated behind
+ * one gzip header; the trailer's CRC is assembled with crc32_combine. */
+#ifdef HAVE_GLIB_2_36
+#define GZ_BLOCK_SIZE (128 * 1024)
+#define GZ_DICT_SIZE (32 * 1024)
+
+typedef struct
+{
+    gchar *in;
+    gsize in_len;
+    gchar *dict;
+    gsize dict_len;
+    gchar *out;
+    gsize out_len;
+    uLong crc;
+    gboolean done;
+    gboolean ok;
+} gz_block_t;
+
+static GMutex gz_block_mutex;
+static GCond gz_block_cond;
+
+static void
+gz_block_free(gz_block_t *block)
+{
+    g_free(block->in);
+    g_free(block->dict);
+    g_free(block->out);
+    g_free(block);
+}
+
+/* The pool's user_data is the compression level. */
+static void
+gz_compress_block(gz_block_t *block, gpointer user_data)
+{
+    z_stream strm;
+    gboolean ok = FALSE;
+
+    memset(&strm, 0, sizeof(strm));
+    block->crc = crc32(crc32(0L, Z_NULL, 0), (Bytef*)block->in, block->in_len);
+    if (deflateInit2(&strm, GPOINTER_TO_INT(user_data), Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY) == Z_OK)
+    {
+        if (block->dict_len == 0 ||
+            deflateSetDictionary(&strm, (Bytef*)block->dict,
+                                 block->dict_len) == Z_OK)
+        {
+            /* deflateBound covers Z_FINISH; leave room for the empty
+             * stored block a sync flush appends. */
+            gsize bound = deflateBound(&strm, block->in_len) + 16;
+            block->out = static_cast<gchar*>(g_malloc(bound));
+            strm.next_in = (Bytef*)block->in;
+            strm.avail_in = block->in_len;
+            strm.next_out = (Bytef*)block->out;
+            strm.avail_out = bound;
+            if (deflate(&strm, Z_SYNC_FLUSH) == Z_OK && strm.avail_in == 0
+                && strm.avail_out > 0)
+            {
+                block->out_len = bound - strm.avail_out;
+                ok = TRUE;
+            }
+        }
+        deflateEnd(&strm);
+    }
+
+    g_mutex_lock(&gz_block_mutex);
+    block->ok = ok;
+    block->done = TRUE;
+    g_cond_broadcast(&gz_block_cond);
+    g_mutex_unlock(&gz_block_mutex);
+}
+
+static void
+gz_put_le32(guchar *buf, guint32 val)
+{
+    buf[0] = val & 0xff;
+    buf[1] = (val >> 8) & 0xff;
+    buf[2] = (val >> 16) & 0xff;
+    buf[3] = (val >> 24) & 0xff;
+}
+
+/* Wait for the oldest pending block, append it to the file and fold its
+ * CRC and length into the running totals. */
+static gboolean
+gz_write_oldest_block(GQueue *pending, FILE *file, uLong *crc, guint32 *isize)
+{
+    gz_block_t *block = static_cast<gz_block_t*>(g_queue_pop_head(pending));
+    gboolean ok;
+
+    g_mutex_lock(&gz_block_mutex);
+    while (!block->done)
+        g_cond_wait(&gz_block_cond, &gz_block_mutex);
+    g_mutex_unlock(&gz_block_mutex);
+
+    ok = block->ok
+         && fwrite(block->out, 1, block->out_len, file) == block->out_len;
+    if (ok)
+    {
+        *crc = crc32_combine(*crc, block->crc, block->in_len);
+        *isize += block->in_len;
+    }
+    gz_block_free(block);
+    return ok;
+}
+
+/* The number of threads to compress with: as configured, or one per
+ * processor. */
+static guint
+gz_thread_count(void)
+{
+    return gz_compress_threads ? gz_compress_threads : g_get_num_processors();
+}
+
+static gboolean
+gz_parallel_compress(gz_thread_params_t *params, guint nthreads, gint level)
+{
+    static const guchar header[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0,
+                                       0, 3 };
+    /* A final, empty block with fixed Huffman codes terminates the
+     * deflate stream after the last sync-flushed block. */
+    static const guchar last_block[2] = { 0x03, 0x00 };
+    guchar trailer[8];
+    GThreadPool *pool;
+    GQueue *pending;
+    FILE *file;
+    gchar *tail = NULL;
+    gsize tail_len = 0;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    guint32 isize = 0;
+    gboolean success = TRUE;
+
+    file = g_fopen(params->filename, "wb");
+    if (file == NULL)
+    {
+        g_warning("Could not open the compressed file '%s'. The error is '%s' (errno %d)",
+                  params->filename, g_strerror(errno) ? g_strerror(errno) : "", errno);
+        return FALSE;
+    }
+
+    pool = g_thread_pool_new((GFunc)gz_compress_block, GINT_TO_POINTER(level),
+                             nthreads, FALSE, NULL);
+    pending = g_queue_new();
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+        success = FALSE;
+
+    while (success)
+    {
+        gz_block_t *block = g_new0(gz_block_t, 1);
+        gsize filled = 0;
+        gssize bytes = 0;
+
+        block->in = static_cast<gchar*>(g_malloc(GZ_BLOCK_SIZE));
+        while (filled < GZ_BLOCK_SIZE &&
+               (bytes = read(params->fd, block->in + filled,
+                             GZ_BLOCK_SIZE - filled)) > 0)
+            filled += bytes;
+
+        if (bytes < 0)
+        {
+            g_warning("Could not read from pipe. The error is '%s' (errno %d)",
+                      g_strerror(errno) ? g_strerror(errno) : "", errno);
+            success = FALSE;
+        }
+        if (filled == 0)
+        {
+            gz_block_free(block);
+            break;
+        }
+
+        block->in_len = filled;
+        block->dict = tail;
+        block->dict_len = tail_len;
+        tail_len = MIN(filled, GZ_DICT_SIZE);
+        tail = static_cast<gchar*>(g_memdup(block->in + filled - tail_len,
+                                            tail_len));
+
+        g_queue_push_tail(pending, block);
+        g_thread_pool_push(pool, block, NULL);
+
+        /* Keep a bounded number of blocks in flight. */
+        while (success && g_queue_get_length(pending) > 2 * nthreads)
+            success = gz_write_oldest_block(pending, file, &crc, &isize);
+
+        if (bytes == 0)
+            break;
+    }
+
+    while (!g_queue_is_empty(pending))
+    {
+        if (!gz_write_oldest_block(pending, file, &crc, &isize))
+            success = FALSE;
+    }
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_queue_free(pending);
+    g_free(tail);
+
+    gz_put_le32(trailer, crc);
+    gz_put_le32(trailer + 4, isize);
+    if (success &&
+        (fwrite(last_block, 1, sizeof(last_block), file) != sizeof(last_block)
+         || fwrite(trailer, 1, sizeof(trailer), file) != sizeof(trailer)))
+        success = FALSE;
+
+    if (fclose(file) != 0)
+        success = FALSE;
+
+    if (!success)
+        g_warning("Could not write the compressed file '%s'", params->filename);
+
+    return success;
+}
+#endif /* HAVE_GLIB_2_36 */
+
+/* Compress or decompress function that is to be run in a separate thread.
+ * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
+static gpointer
+gz_thread_func(gz_thread_params_t *params)
+{
+    gchar buffer[BUFLEN];
+    gssize bytes;
+    gint gzval;
+    gzFile file;
+    gint success = 1;
+
+#ifdef HAVE_GLIB_2_36
+    if (params->compress && gz_thread_count() > 1)
+    {
+        success = gz_parallel_compress(params, gz_thread_count(),
+                                       gz_compress_level) ? 1 : 0;
+        goto cleanup_gz_thread_func;
+    }
+#endif
+
+    file = gz_open_file(params->filename, params->perms);
     if (file == NULL)
     {
         g_warning("Child threads gzopen failed");
         success = 0;
         goto cleanup_gz_thread_func;
     }
+    if (params->compress && gz_compress_level != Z_DEFAULT_COMPRESSION)
+        gzsetparams(file, gz_compress_level, Z_DEFAULT_STRATEGY);
 
     if (params->compress)
     {
@@ -1530,6 +2139,32 @@ cleanup_gz_thread_func:
     return GINT_TO_POINTER(success);
 }
 
+gboolean
+gnc_xml2_compress_file(const gchar *source, const gchar *dest)
+{
+    gz_thread_params_t *params;
+#ifdef G_OS_WIN32
+    int fd = g_open(source, O_RDONLY | _O_BINARY, 0);
+#else
+    int fd = g_open(source, O_RDONLY, 0);
+#endif
+
+    if (fd == -1)
+    {
+        g_warning("Could not open '%s' for compression", source);
+        return FALSE;
+    }
+
+    /* Run the pipe reader directly on the file; it closes fd. */
+    params = g_new(gz_thread_params_t, 1);
+    params->fd = fd;
+    params->filename = g_strdup(dest);
+    params->perms = g_strdup("w");
+    params->compress = TRUE;
+
+    return GPOINTER_TO_INT(gz_thread_func(params));
+}
+
 static FILE *
 try_gz_open (const char *filename, const char *perms, gboolean use_gzip,
              gboolean compress)
@@ -1824,6 +2459,82 @@ conv_list_free(GList *conv_list)
     g_list_free(conv_list);
 }
 
+/* Line-oriented reader used by the encoding scans. Uncompressed files are
+ * mapped and walked in place; compressed ones go through try_gz_open. */
+typedef struct
+{
+    FILE *file;
+    gboolean is_compressed;
+    GMappedFile *map;
+    const gchar *pos;
+    const gchar *end;
+} line_source;
+
+static gboolean
+line_source_open(line_source *src, const gchar *filename)
+{
+    memset(src, 0, sizeof(*src));
+    src->is_compressed = is_gzipped_file(filename);
+    if (!src->is_compressed)
+    {
+        src->map = g_mapped_file_new(filename, FALSE, NULL);
+        if (src->map)
+        {
+            src->pos = g_mapped_file_get_contents(src->map);
+            src->end = src->pos + g_mapped_file_get_length(src->map);
+            return TRUE;
+        }
+    }
+    src->file = try_gz_open(filename, "r", src->is_compressed, FALSE);
+    return src->file != NULL;
+}
+
+/* Same contract as fgets: at most size - 1 bytes, stopping after a
+ * newline, NUL terminated. Returns FALSE at end of input or on error,
+ * with *eof telling the two apart. */
+static gboolean
+line_source_gets(line_source *src, gchar *line, gsize size, gboolean *eof)
+{
+    const gchar *nl;
+    gsize len;
+
+    if (src->file)
+    {
+        if (fgets(line, size, src->file))
+            return TRUE;
+        *eof = feof(src->file);
+        return FALSE;
+    }
+
+    if (src->pos >= src->end)
+    {
+        *eof = TRUE;
+        return FALSE;
+    }
+    len = MIN((gsize)(src->end - src->pos), size - 1);
+    nl = static_cast<const gchar*>(memchr(src->pos, '\n', len));
+    if (nl)
+        len = nl - src->pos + 1;
+    memcpy(line, src->pos, len);
+    line[len] = '\0';
+    src->pos += len;
+    return TRUE;
+}
+
+static void
+line_source_close(line_source *src)
+{
+    if (src->map)
+        g_mapped_file_unref(src->map);
+    if (src->file)
+    {
+        fclose(src->file);
+        if (src->is_compressed)
+            wait_for_gzip(src->file);
+    }
+    memset(src, 0, sizeof(*src));
+}
+
 typedef struct
 {
     GQuark encoding;
@@ -1835,19 +2546,16 @@ gnc_xml2_find_ambiguous(const gchar *filename, GList *encodings,
                         GHashTable **unique, GHashTable **ambiguous,
                         GList **impossible)
 {
-    FILE *file = NULL;
+    line_source src;
     GList *iconv_list = NULL, *conv_list = NULL, *iter;
     iconv_item_type *iconv_item = NULL, *ascii = NULL;
     const gchar *enc;
     GHashTable *processed = NULL;
     gint n_impossible = 0;
     GError *error = NULL;
-    gboolean is_compressed;
     gboolean clean_return = FALSE;
 
-    is_compressed = is_gzipped_file(filename);
-    file = try_gz_open(filename, "r", is_compressed, FALSE);
-    if (file == NULL)
+    if (!line_source_open(&src, filename))
     {
         PWARN("Unable to open file %s", filename);
         goto cleanup_find_ambs;
@@ -1903,10 +2611,11 @@ gnc_xml2_find_ambiguous(const gchar *filename, GList *encodings,
         gchar line[256], *word, *utf8;
         gchar **word_array, **word_cursor;
         conv_type *conv = NULL;
+        gboolean eof = FALSE;
 
-        if (!fgets(line, sizeof(line) - 1, file))
+        if (!line_source_gets(&src, line, sizeof(line) - 1, &eof))
         {
-            if (feof(file))
+            if (eof)
             {
                 break;
             }
@@ -2025,12 +2734,7 @@ cleanup_find_ambs:
         g_hash_table_destroy(processed);
     if (ascii)
         g_free(ascii);
-    if (file)
-    {
-        fclose(file);
-        if (is_compressed)
-            wait_for_gzip(file);
-    }
+    line_source_close(&src);
 
     return (clean_return) ? n_impossible : -1;
 }
@@ -2046,16 +2750,13 @@ parse_with_subst_push_handler (xmlParserCtxtPtr xml_context,
                                push_data_type *push_data)
 {
     const gchar *filename;
-    FILE *file = NULL;
+    line_source src;
     GIConv ascii = (GIConv) - 1;
     GString *output = NULL;
     GError *error = NULL;
-    gboolean is_compressed;
 
     filename = push_data->filename;
-    is_compressed = is_gzipped_file(filename);
-    file = try_gz_open(filename, "r", is_compressed, FALSE);
-    if (file == NULL)
+    if (!line_source_open(&src, filename))
     {
         PWARN("Unable to open file %s", filename);
         goto cleanup_push_handler;
@@ -2074,10 +2775,11 @@ parse_with_subst_push_handler (xmlParserCtxtPtr xml_context,
         gchar line[256], *word, *repl, *utf8;
         gint pos, len;
         gchar *start, *cursor;
+        gboolean eof = FALSE;
 
-        if (!fgets(line, sizeof(line) - 1, file))
+        if (!line_source_gets(&src, line, sizeof(line) - 1, &eof))
         {
-            if (feof(file))
+            if (eof)
             {
                 break;
             }
@@ -2164,12 +2866,7 @@ cleanup_push_handler:
         g_string_free(output, TRUE);
     if (ascii != (GIConv) - 1)
         g_iconv_close(ascii);
-    if (file)
-    {
-        fclose(file);
-        if (is_compressed)
-            wait_for_gzip(file);
-    }
+    line_source_close(&src);
 }
 
 gboolean
@@ -2191,3 +2888,220 @@ gnc_xml2_parse_with_subst (FileBackend *fbe, QofBook *book, GHashTable *subst)
 
     return success;
 }
+
+/***********************************************************************/
+/* Transaction journal: an append-only sidecar holding the transactions
+ * committed since the last full write, so that saves in between only
+ * need to append. Each record is a complete <gnc:transaction> element,
+ * or a <journal:destroy> carrying the GUID of a deleted transaction. The
+ * root element is never closed on disk; replay closes it in memory. */
+
+static const char *JOURNAL_TAG = "gnc-journal";
+static const char *JOURNAL_DESTROY_TAG = "journal:destroy";
+static const char *JOURNAL_TRN_ID_TAG = "trn:id";
+
+static gboolean
+write_journal_node(FILE *journal, xmlNodePtr node)
+{
+    if (!node)
+        return FALSE;
+    xmlElemDump(journal, NULL, node);
+    xmlFreeNode(node);
+    return fputc('\n', journal) != EOF && !ferror(journal);
+}
+
+gboolean
+gnc_xml2_journal_write_header(FILE *journal)
+{
+    return fprintf(journal, "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+                   "<%s>\n", JOURNAL_TAG) >= 0;
+}
+
+gboolean
+gnc_xml2_journal_write_trans(FILE *journal, Transaction *trans)
+{
+    return write_journal_node(journal,
+                              gnc_transaction_dom_tree_create(trans));
+}
+
+gboolean
+gnc_xml2_journal_write_destroy(FILE *journal, const GncGUID *guid)
+{
+    return write_journal_node(journal,
+                              guid_to_dom_tree(JOURNAL_DESTROY_TAG, guid));
+}
+
+/* The journal records what was committed, so a transaction it replaces
+ * or deletes goes even if it has been made read-only since, like the
+ * transaction of a posted invoice. */
+static void
+journal_destroy_trans(Transaction *trans)
+{
+    xaccTransBeginEdit(trans);
+    if (xaccTransGetReadOnly(trans))
+        xaccTransClearReadOnly(trans);
+    xaccTransDestroy(trans);
+    xaccTransCommitEdit(trans);
+}
+
+/* Moves trans and its splits to fresh GUIDs, so that a record carrying
+ * theirs can be parsed while they are still there; returns the old
+ * GUIDs for journal_restore_trans. */
+static GList*
+journal_stash_trans(Transaction *trans)
+{
+    GList *guids = NULL, *node;
+    GncGUID guid;
+
+    guids = g_list_prepend(guids,
+                           guid_copy(qof_instance_get_guid(QOF_INSTANCE(trans))));
+    guid_replace(&guid);
+    qof_instance_set_guid(QOF_INSTANCE(trans), &guid);
+    for (node = xaccTransGetSplitList(trans); node; node = node->next)
+    {
+        guids = g_list_prepend(guids,
+                               guid_copy(qof_instance_get_guid(QOF_INSTANCE(node->data))));
+        guid_replace(&guid);
+        qof_instance_set_guid(QOF_INSTANCE(node->data), &guid);
+    }
+    return g_list_reverse(guids);
+}
+
+static void
+journal_restore_trans(Transaction *trans, GList *guids)
+{
+    GList *node = guids, *split;
+
+    qof_instance_set_guid(QOF_INSTANCE(trans), static_cast<GncGUID*>(node->data));
+    for (split = xaccTransGetSplitList(trans), node = node->next;
+         split && node; split = split->next, node = node->next)
+        qof_instance_set_guid(QOF_INSTANCE(split->data),
+                              static_cast<GncGUID*>(node->data));
+}
+
+static gboolean
+journal_trn_end_handler(gpointer data_for_children,
+                        GSList* data_from_children, GSList* sibling_data,
+                        gpointer parent_data, gpointer global_data,
+                        gpointer *result, const gchar *tag)
+{
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    gxpf_data *gdata = (gxpf_data*)global_data;
+    QofBook *book = static_cast<QofBook*>(gdata->bookdata);
+    Transaction *trn = NULL, *old = NULL;
+    GList *old_guids = NULL;
+    xmlNodePtr child;
+
+    if (parent_data || !tag)
+        return TRUE;
+
+    g_return_val_if_fail(tree, FALSE);
+
+    /* A journaled transaction supersedes the one loaded from the file,
+     * but only once the record has been parsed: a damaged record must
+     * leave the old one alone. */
+    for (child = tree->xmlChildrenNode; child; child = child->next)
+    {
+        if (g_strcmp0((const char*)child->name, JOURNAL_TRN_ID_TAG) == 0)
+        {
+            GncGUID *guid = dom_tree_to_guid(child);
+
+            old = guid ? xaccTransLookup(guid, book) : NULL;
+            g_free(guid);
+            break;
+        }
+    }
+    if (old)
+        old_guids = journal_stash_trans(old);
+
+    trn = dom_tree_to_transaction(tree, book);
+    xmlFreeNode(tree);
+
+    if (old && !trn)
+        journal_restore_trans(old, old_guids);
+    else if (old)
+    {
+        GncInvoice *invoice = gncInvoiceGetInvoiceFromTxn(old);
+
+        if (invoice && gncInvoiceGetPostedTxn(invoice) == old)
+            gncInvoiceReplacePostedTxn(invoice, trn);
+        journal_destroy_trans(old);
+    }
+    g_list_free_full(old_guids, (GDestroyNotify)guid_free);
+    return trn != NULL;
+}
+
+static gboolean
+journal_destroy_end_handler(gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer *result, const gchar *tag)
+{
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    gxpf_data *gdata = (gxpf_data*)global_data;
+    GncGUID *guid;
+
+    if (parent_data || !tag)
+        return TRUE;
+
+    g_return_val_if_fail(tree, FALSE);
+
+    guid = dom_tree_to_guid(tree);
+    if (guid)
+    {
+        Transaction *trans =
+            xaccTransLookup(guid, static_cast<QofBook*>(gdata->bookdata));
+        if (trans)
+            journal_destroy_trans(trans);
+        g_free(guid);
+    }
+    xmlFreeNode(tree);
+    return TRUE;
+}
+
+gboolean
+gnc_xml2_journal_replay(const gchar *filename, QofBook *book)
+{
+    sixtp *top_parser, *journal_parser;
+    gchar *contents = NULL;
+    gsize length = 0;
+    GString *buffer;
+    gboolean success;
+
+    if (!g_file_get_contents(filename, &contents, &length, NULL))
+        return FALSE;
+
+    top_parser = sixtp_new();
+    journal_parser = sixtp_new();
+    if (!sixtp_add_some_sub_parsers(
+                top_parser, TRUE,
+                JOURNAL_TAG, journal_parser,
+                NULL, NULL)
+            || !sixtp_add_some_sub_parsers(
+                journal_parser, TRUE,
+                TRANSACTION_TAG,
+                sixtp_dom_parser_new(journal_trn_end_handler, NULL, NULL),
+                JOURNAL_DESTROY_TAG,
+                sixtp_dom_parser_new(journal_destroy_end_handler, NULL, NULL),
+                NULL, NULL))
+    {
+        sixtp_destroy(top_parser);
+        g_free(contents);
+        return FALSE;
+    }
+
+    buffer = g_string_new_len(contents, length);
+    g_free(contents);
+    g_string_append_printf(buffer, "</%s>\n", JOURNAL_TAG);
+
+    /* Records are applied as they are parsed, so a record torn by a
+     * crash only loses itself, not the ones before it. */
+    xaccLogDisable();
+    success = gnc_xml_parse_buffer(top_parser, buffer->str, buffer->len,
+                                   NULL, NULL, book);
+    xaccLogEnable();
+
+    sixtp_destroy(top_parser);
+    g_string_free(buffer, TRUE);
+    return success;
+}
@@ -87,6 +87,16 @@ gboolean qof_session_load_from_xml_file_v2(FileBackend *, QofBook *, QofBookFile
 gboolean gnc_book_write_to_xml_filehandle_v2(QofBook *book, FILE *fh);
 gboolean gnc_book_write_to_xml_file_v2(QofBook *book, const char *filename, gboolean compress);
 
+/** Write a gzip-compressed copy of the file @a source to @a dest.
+ * Safe to call from any thread. */
+gboolean gnc_xml2_compress_file(const gchar *source, const gchar *dest);
+
+/** Set how compressed files are written from now on: @a level is the
+ * zlib level from 1 to 9, anything else meaning zlib's default, and
+ * @a nthreads the number of threads deflating at once, 0 meaning one
+ * per processor.  With one thread the file is written by gzwrite. */
+void gnc_xml2_set_compression(gint level, guint nthreads);
+
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2(QofBackend *be, QofBook *book, FILE *fh);
 gboolean gnc_book_write_accounts_to_xml_file_v2(QofBackend * be, QofBook *book,
@@ -141,6 +151,24 @@ gint gnc_xml2_find_ambiguous(
  */
 gboolean gnc_xml2_parse_with_subst (
     FileBackend *fbe, QofBook *book, GHashTable *subst);
+
+/** Start a new transaction journal by writing its XML preamble. */
+gboolean gnc_xml2_journal_write_header(FILE *journal);
+
+/** Append the current state of @a trans to a transaction journal. */
+gboolean gnc_xml2_journal_write_trans(FILE *journal, Transaction *trans);
+
+/** Append a record of the destruction of the transaction @a guid. */
+gboolean gnc_xml2_journal_write_destroy(FILE *journal, const GncGUID *guid);
+
+/** Apply the records of the journal @a filename to @a book, which must
+ * already hold the data of the matching full file.
+ *
+ * @return FALSE if the journal could not be read or a record was damaged;
+ * the records before the damage are still applied.
+ */
+gboolean gnc_xml2_journal_replay(const gchar *filename, QofBook *book);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,19 @@ extern "C"
 
 static QofLogModule log_module = GNC_MOD_IO;
 
+/* The text of a node holding nothing but one run of text, which is how
+ * every value the writers produce looks; NULL if it holds anything else.
+ * It saves the converters copying the text only to parse and free it. */
+static inline const char*
+dom_tree_simple_text(xmlNodePtr node)
+{
+    xmlNodePtr child = node->xmlChildrenNode;
+
+    if (child && !child->next && child->type == XML_TEXT_NODE)
+        return (const char*)child->content;
+    return NULL;
+}
+
 GncGUID*
 dom_tree_to_guid(xmlNodePtr node)
 {
@@ -55,6 +68,7 @@ dom_tree_to_guid(xmlNodePtr node)
 
     {
         char *type;
+        const char *text;
 
         type = (char*)xmlNodeGetContent (node->properties->xmlAttrPropertyValue);
 
@@ -64,6 +78,13 @@ dom_tree_to_guid(xmlNodePtr node)
             auto gid = guid_new();
             char *guid_str;
 
+            text = dom_tree_simple_text(node);
+            if (text)
+            {
+                string_to_guid(text, gid);
+                xmlFree (type);
+                return gid;
+            }
             guid_str = (char*)xmlNodeGetContent (node->xmlChildrenNode);
             string_to_guid(guid_str, gid);
             xmlFree (guid_str);
@@ -490,6 +511,7 @@ dom_tree_to_text(xmlNodePtr tree)
     */
     gchar *result;
     gchar *temp;
+    const char *text;
 
     g_return_val_if_fail(tree, NULL);
 
@@ -500,6 +522,10 @@ dom_tree_to_text(xmlNodePtr tree)
         return g_strdup("");
     }
 
+    text = dom_tree_simple_text(tree);
+    if (text)
+        return g_strdup (text);
+
     temp = (char*)xmlNodeListGetString (NULL, tree->xmlChildrenNode, TRUE);
     if (!temp)
     {
@@ -40,15 +40,15 @@ sixtp_stack_frame_destroy(sixtp_stack_frame *sf)
     g_slist_free(sf->data_from_children);
     sf->data_from_children = NULL;
 
-    g_free(sf);
+    g_slice_free(sixtp_stack_frame, sf);
 }
 
 sixtp_stack_frame*
-sixtp_stack_frame_new(sixtp* next_parser, char *tag)
+sixtp_stack_frame_new(sixtp* next_parser, const char *tag)
 {
     sixtp_stack_frame* new_frame;
 
-    new_frame = g_new0(sixtp_stack_frame, 1);
+    new_frame = g_slice_new0(sixtp_stack_frame);
     new_frame->parser = next_parser;
     new_frame->tag = tag;
     new_frame->data_for_children = NULL;
@@ -33,7 +33,7 @@ extern "C"
 typedef struct sixtp_stack_frame
 {
     sixtp *parser;
-    gchar *tag;
+    const gchar *tag; /* interned */
     gpointer data_for_children;
     GSList *data_from_children; /* in reverse chronological order */
     gpointer frame_data;
@@ -60,7 +60,7 @@ GSList* sixtp_pop_and_destroy_frame(GSList *frame_stack);
 
 void sixtp_print_frame_stack(GSList *stack, FILE *f);
 
-sixtp_stack_frame* sixtp_stack_frame_new(sixtp* next_parser, char *tag);
+sixtp_stack_frame* sixtp_stack_frame_new(sixtp* next_parser, const char *tag);
 
 sixtp_parser_context* sixtp_context_new(sixtp *initial_parser,
                                         gpointer global_data,
@@ -95,7 +95,10 @@ static gboolean dom_chars_handler(
 {
     if (length > 0)
     {
-	gchar *newtext = g_strdup (text);
+        /* text points into the parser's input buffer and isn't
+         * terminated, so copy (and check) only this run of characters
+         * rather than the rest of the buffer. */
+	gchar *newtext = g_strndup (text, length);
         xmlNodeAddContentLen((xmlNodePtr)parent_data,
 			     checked_char_cast (newtext), length);
 	g_free (newtext);
@@ -68,8 +68,7 @@ sixtp_child_result_destroy(sixtp_child_result *r)
     {
         r->cleanup_handler(r);
     }
-    if (r->type == SIXTP_CHILD_RESULT_NODE) g_free(r->tag);
-    g_free(r);
+    g_slice_free(sixtp_child_result, r);
 }
 
 void
@@ -144,6 +143,12 @@ sixtp_set_chars_fail(sixtp *parser, sixtp_result_handler handler)
     parser->chars_fail_handler = handler;
 }
 
+typedef struct
+{
+    GQuark tag;
+    sixtp *parser;
+} sixtp_child_entry;
+
 sixtp *
 sixtp_new(void)
 {
@@ -157,6 +162,9 @@ sixtp_new(void)
             g_free(s);
             s = NULL;
         }
+        else
+            s->child_index = g_array_new(FALSE, FALSE,
+                                         sizeof(sixtp_child_entry));
     }
     return(s);
 }
@@ -255,6 +263,7 @@ sixtp_destroy_node(sixtp *sp, GHashTable *corpses)
     g_return_if_fail(corpses);
     g_hash_table_foreach(sp->child_parsers, sixtp_destroy_child, corpses);
     g_hash_table_destroy(sp->child_parsers);
+    g_array_free(sp->child_index, TRUE);
     g_free(sp);
 }
 
@@ -313,9 +322,46 @@ sixtp_add_sub_parser(sixtp *parser, const gchar* tag, sixtp *sub_parser)
 
     g_hash_table_insert(parser->child_parsers,
                         g_strdup(tag), (gpointer) sub_parser);
+
+    if (g_strcmp0(tag, SIXTP_MAGIC_CATCHER) == 0)
+        parser->catch_all = sub_parser;
+    else
+    {
+        sixtp_child_entry entry = { g_quark_from_string(tag), sub_parser };
+        guint i;
+
+        for (i = 0; i < parser->child_index->len; i++)
+        {
+            sixtp_child_entry *e = &g_array_index(parser->child_index,
+                                                  sixtp_child_entry, i);
+            if (e->tag == entry.tag)
+            {
+                e->parser = sub_parser;
+                return(TRUE);
+            }
+        }
+        g_array_append_val(parser->child_index, entry);
+    }
     return(TRUE);
 }
 
+/* Parsers have a handful of children at most, so a linear scan
+ * comparing quarks beats hashing the tag string. */
+static sixtp *
+sixtp_find_child(const sixtp *parser, GQuark tag)
+{
+    guint i;
+
+    for (i = 0; i < parser->child_index->len; i++)
+    {
+        const sixtp_child_entry *e = &g_array_index(parser->child_index,
+                                                    sixtp_child_entry, i);
+        if (e->tag == tag)
+            return e->parser;
+    }
+    return parser->catch_all;
+}
+
 /*
  * This is a bit complex because of having to make sure to
  * cleanup things we haven't looked at on an error condition
@@ -390,36 +436,23 @@ sixtp_sax_start_handler(void *user_data,
     sixtp_stack_frame *current_frame = NULL;
     sixtp *current_parser = NULL;
     sixtp *next_parser = NULL;
-    gchar *next_parser_tag = NULL;
-    gboolean lookup_success = FALSE;
     sixtp_stack_frame *new_frame = NULL;
+    GQuark tag_id;
 
     current_frame = (sixtp_stack_frame *) pdata->stack->data;
     current_parser = current_frame->parser;
 
-    /* Use an extended lookup so we can get *our* copy of the key.
-       Since we've strduped it, we know its lifetime... */
-    lookup_success =
-        g_hash_table_lookup_extended(current_parser->child_parsers,
-                                     name,
-                                     reinterpret_cast<void**>(&next_parser_tag),
-                                     reinterpret_cast<void**>(&next_parser));
-
-
-    if (!lookup_success)
+    /* Intern the tag once: the quark drives child dispatch and its
+       string lives for the whole process, so neither the frame nor the
+       child result needs a private copy. */
+    tag_id = g_quark_from_string((const gchar*) name);
+    next_parser = sixtp_find_child(current_parser, tag_id);
+    if (!next_parser)
     {
-        /* magic catch all value */
-        lookup_success = g_hash_table_lookup_extended(
-                             current_parser->child_parsers, SIXTP_MAGIC_CATCHER,
-                             reinterpret_cast<void**>(&next_parser_tag),
-                             reinterpret_cast<void**>(&next_parser));
-        if (!lookup_success)
-        {
-            g_critical("Tag <%s> not allowed in current context.",
-                       name ? (char *) name : "(null)");
-            pdata->parsing_ok = FALSE;
-            next_parser = pdata->bad_xml_parser;
-        }
+        g_critical("Tag <%s> not allowed in current context.",
+                   name ? (char *) name : "(null)");
+        pdata->parsing_ok = FALSE;
+        next_parser = pdata->bad_xml_parser;
     }
 
     if (current_frame->parser->before_child)
@@ -427,7 +460,7 @@ sixtp_sax_start_handler(void *user_data,
         GSList *parent_data_from_children = NULL;
         gpointer parent_data_for_children = NULL;
 
-        if (g_slist_length(pdata->stack) > 1)
+        if (pdata->stack->next)
         {
             /* we're not in the top level node */
             sixtp_stack_frame *parent_frame =
@@ -447,7 +480,7 @@ sixtp_sax_start_handler(void *user_data,
     }
 
     /* now allocate the new stack frame and shift to it */
-    new_frame = sixtp_stack_frame_new( next_parser, g_strdup((char*) name));
+    new_frame = sixtp_stack_frame_new(next_parser, g_quark_to_string(tag_id));
 
     new_frame->line = xmlSAX2GetLineNumber( pdata->saxParserCtxt );
     new_frame->col  = xmlSAX2GetColumnNumber( pdata->saxParserCtxt );
@@ -488,7 +521,7 @@ sixtp_sax_characters_handler(void *user_data, const xmlChar *text, int len)
         if (pdata->parsing_ok && result)
         {
             /* push the result onto the current "child" list. */
-            sixtp_child_result *child_data = g_new0(sixtp_child_result, 1);
+            sixtp_child_result *child_data = g_slice_new0(sixtp_child_result);
 
             child_data->type = SIXTP_CHILD_RESULT_CHARS;
             child_data->tag = NULL;
@@ -509,7 +542,7 @@ sixtp_sax_end_handler(void *user_data, const xmlChar *name)
     sixtp_stack_frame *current_frame;
     sixtp_stack_frame *parent_frame;
     sixtp_child_result *child_result_data = NULL;
-    gchar *end_tag = NULL;
+    const gchar *end_tag = NULL;
 
     current_frame = (sixtp_stack_frame *) pdata->stack->data;
     parent_frame = (sixtp_stack_frame *) pdata->stack->next->data;
@@ -547,10 +580,10 @@ sixtp_sax_end_handler(void *user_data, const xmlChar *name)
     if (current_frame->frame_data)
     {
         /* push the result onto the parent's child result list. */
-        child_result_data = g_new(sixtp_child_result, 1);
+        child_result_data = g_slice_new(sixtp_child_result);
 
         child_result_data->type = SIXTP_CHILD_RESULT_NODE;
-        child_result_data->tag = g_strdup(current_frame->tag);
+        child_result_data->tag = current_frame->tag;
         child_result_data->data = current_frame->frame_data;
         child_result_data->should_cleanup = TRUE;
         child_result_data->cleanup_handler = current_frame->parser->cleanup_result;
@@ -560,7 +593,7 @@ sixtp_sax_end_handler(void *user_data, const xmlChar *name)
             g_slist_prepend(parent_frame->data_from_children, child_result_data);
     }
 
-    /* grab it before it goes away - we own the reference */
+    /* interned, so it outlives the frame */
     end_tag = current_frame->tag;
 
     g_debug("Finished with end of <%s>", end_tag ? end_tag : "(null)");
@@ -573,7 +606,7 @@ sixtp_sax_end_handler(void *user_data, const xmlChar *name)
     current_frame = (sixtp_stack_frame *) pdata->stack->data;
     /* reset the parent, checking to see if we're at the top level node */
     parent_frame = (sixtp_stack_frame *)
-                   ((g_slist_length(pdata->stack) > 1) ? (pdata->stack->next->data) : NULL);
+                   (pdata->stack->next ? pdata->stack->next->data : NULL);
 
     if (current_frame->parser->after_child)
     {
@@ -600,8 +633,6 @@ sixtp_sax_end_handler(void *user_data, const xmlChar *name)
                                                end_tag,
                                                child_result_data);
     }
-
-    g_free (end_tag);
 }
 
 xmlEntityPtr
@@ -727,7 +758,7 @@ sixtp_parse_file_common(sixtp *sixtp,
     {
         if (parse_result)
             *parse_result = NULL;
-        if (g_slist_length(ctxt->data.stack) > 1)
+        if (ctxt->data.stack->next)
             sixtp_handle_catastrophe(&ctxt->data);
         sixtp_context_destroy(ctxt);
         return FALSE;
@@ -781,10 +812,25 @@ sixtp_parse_fd(sixtp *sixtp,
                gpointer data_for_top_level,
                gpointer global_data,
                gpointer *parse_result)
+{
+    return sixtp_parse_io(sixtp, sixtp_parser_read, fd, data_for_top_level,
+                          global_data, parse_result);
+}
+
+/* Parse from an arbitrary stream, pulling the data through read_func. This
+ * lets callers decompress in-process instead of going through a FILE. */
+gboolean
+sixtp_parse_io(sixtp *sixtp,
+               xmlInputReadCallback read_func,
+               gpointer read_context,
+               gpointer data_for_top_level,
+               gpointer global_data,
+               gpointer *parse_result)
 {
     gboolean ret;
     xmlParserCtxtPtr context = xmlCreateIOParserCtxt( NULL, NULL,
-                                                     sixtp_parser_read, NULL /*no close */, fd,
+                                                     read_func, NULL /*no close */,
+                                                     read_context,
                                                      XML_CHAR_ENCODING_NONE);
     ret = sixtp_parse_file_common(sixtp, context, data_for_top_level,
                                   global_data, parse_result);
@@ -850,7 +896,7 @@ sixtp_parse_push (sixtp *sixtp,
     {
         if (parse_result)
             *parse_result = NULL;
-        if (g_slist_length(ctxt->data.stack) > 1)
+        if (ctxt->data.stack->next)
             sixtp_handle_catastrophe(&ctxt->data);
         sixtp_context_destroy(ctxt);
         return FALSE;
@@ -149,6 +149,12 @@ typedef struct sixtp
        children. */
 
     GHashTable *child_parsers;
+
+    /* The same children keyed by interned tag (a GArray of
+       sixtp_child_entry) plus the SIXTP_MAGIC_CATCHER child, so the
+       SAX start handler can dispatch without hashing the tag twice. */
+    GArray *child_index;
+    struct sixtp *catch_all;
 } sixtp;
 
 typedef enum
@@ -183,7 +189,7 @@ typedef enum
 struct _sixtp_child_result
 {
     sixtp_child_result_type type;
-    gchar *tag; /* NULL for a CHARS node. */
+    const gchar *tag; /* Interned; NULL for a CHARS node. */
     gpointer data;
     gboolean should_cleanup;
     sixtp_result_handler cleanup_handler;
@@ -238,6 +244,9 @@ gboolean sixtp_parse_file(sixtp *sixtp, const char *filename,
 gboolean sixtp_parse_fd(sixtp *sixtp, FILE *fd,
                         gpointer data_for_top_level, gpointer global_data,
                         gpointer *parse_result);
+gboolean sixtp_parse_io(sixtp *sixtp, xmlInputReadCallback read_func,
+                        gpointer read_context, gpointer data_for_top_level,
+                        gpointer global_data, gpointer *parse_result);
 gboolean sixtp_parse_buffer(sixtp *sixtp, char *bufp, int bufsz,
                             gpointer data_for_top_level, gpointer global_data,
                             gpointer *parse_result);
@@ -111,6 +111,27 @@ guile_main (void *closure, int argc, char **argv)
         gnc_free_example_account_list(list);
     }
 
+    {
+        GSList *node;
+        gboolean lazy_ok = TRUE;
+
+        list = gnc_load_example_account_header_list(location);
+
+        do_test(list != NULL, "gnc_load_example_account_header_list");
+
+        for (node = list; node; node = node->next)
+        {
+            GncExampleAccount *gea = static_cast<GncExampleAccount*>(node->data);
+            if (gea->root != NULL || gea->book != NULL || gea->title == NULL
+                    || !gnc_example_account_load_tree(gea)
+                    || gea->root == NULL)
+                lazy_ok = FALSE;
+        }
+        do_test(lazy_ok, "gnc_example_account_load_tree");
+
+        gnc_free_example_account_list(list);
+    }
+
 
     print_test_results();
     exit(get_rv());
@@ -0,0 +1,169 @@
+/********************************************************************
+ * test-xml-compress.cpp: Compressing XML files and reading them    *
+ *                        back.                                     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+extern "C"
+{
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <test-stuff.h>
+}
+
+#include "../io-gncxml-v2.h"
+
+static gchar *plain_file, *gz_file;
+
+/* Text that compresses about as well as a book does, spanning several
+ * of the parallel compressor's blocks. */
+static GString *
+make_contents (gsize len)
+{
+    GString *contents = g_string_sized_new (len);
+    guint32 seed = 1;
+
+    while (contents->len < len)
+    {
+        seed = seed * 1103515245 + 12345;
+        g_string_append_printf (contents,
+                                "<split:value>%u/100</split:value>\n",
+                                (seed >> 8) % 100000);
+    }
+    g_string_truncate (contents, len);
+    return contents;
+}
+
+/* Inflates gz_file the way gunzip does; NULL if it isn't valid gzip. */
+static GString *
+gunzip_file (void)
+{
+    GString *contents = g_string_new (NULL);
+    gzFile file = gzopen (gz_file, "rb");
+    char buffer[8192];
+    int bytes = 0;
+
+    if (!file)
+    {
+        g_string_free (contents, TRUE);
+        return NULL;
+    }
+    while ((bytes = gzread (file, buffer, sizeof (buffer))) > 0)
+        g_string_append_len (contents, buffer, bytes);
+    if (gzclose (file) != Z_OK || bytes < 0)
+    {
+        g_string_free (contents, TRUE);
+        return NULL;
+    }
+    return contents;
+}
+
+static gsize
+file_size (const gchar *filename)
+{
+    GStatBuf st;
+    return g_stat (filename, &st) == 0 ? st.st_size : 0;
+}
+
+/* Compresses contents with the given settings and checks that gunzip
+ * gives it back; returns the size of the compressed file. */
+static gsize
+check_round_trip (GString *contents, gint level, guint nthreads)
+{
+    GString *inflated;
+    gsize size;
+    gchar *msg;
+
+    g_file_set_contents (plain_file, contents->str, contents->len, NULL);
+    gnc_xml2_set_compression (level, nthreads);
+
+    msg = g_strdup_printf ("compress %" G_GSIZE_FORMAT " bytes, level %d, "
+                           "%u threads", contents->len, level, nthreads);
+    do_test (gnc_xml2_compress_file (plain_file, gz_file), msg);
+    g_free (msg);
+
+    inflated = gunzip_file ();
+    msg = g_strdup_printf ("gunzip %" G_GSIZE_FORMAT " bytes, level %d, "
+                           "%u threads", contents->len, level, nthreads);
+    do_test (inflated && inflated->len == contents->len &&
+             memcmp (inflated->str, contents->str, contents->len) == 0, msg);
+    g_free (msg);
+    if (inflated)
+        g_string_free (inflated, TRUE);
+
+    size = file_size (gz_file);
+    g_unlink (gz_file);
+    return size;
+}
+
+static void
+test_round_trips (void)
+{
+    GString *large = make_contents (1024 * 1024 + 12345);
+    GString *block = make_contents (128 * 1024);
+    GString *empty = g_string_new (NULL);
+    guint threads[] = { 1, 2, 4 };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (threads); ++i)
+    {
+        gsize fast, small;
+
+        fast = check_round_trip (large, 1, threads[i]);
+        small = check_round_trip (large, 9, threads[i]);
+        do_test (fast > 0 && small > 0 && small < large->len,
+                 "the file is compressed");
+        do_test (small <= fast, "the higher level compresses better");
+
+        check_round_trip (large, -1, threads[i]);
+        check_round_trip (block, -1, threads[i]);
+        check_round_trip (empty, -1, threads[i]);
+    }
+    /* One thread per processor. */
+    check_round_trip (large, 6, 0);
+
+    g_string_free (large, TRUE);
+    g_string_free (block, TRUE);
+    g_string_free (empty, TRUE);
+}
+
+int
+main (int argc, char ** argv)
+{
+    gchar *name;
+
+    name = g_strdup_printf ("test-xml-compress-%d", (int)getpid ());
+    plain_file = g_build_filename (g_get_tmp_dir (), name, NULL);
+    gz_file = g_strconcat (plain_file, ".gz", NULL);
+    g_free (name);
+
+    test_round_trips ();
+
+    g_unlink (plain_file);
+    g_free (plain_file);
+    g_free (gz_file);
+    print_test_results ();
+    exit (get_rv ());
+}
@@ -0,0 +1,252 @@
+/********************************************************************
+ * test-xml-journal.cpp: Replaying the transaction journal.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+extern "C"
+{
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gnc-engine.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+
+#include <test-stuff.h>
+}
+
+#include "../io-gncxml-v2.h"
+
+static QofBook *book;
+static Account *acc_a, *acc_b;
+static GncGUID trans_guid;
+static gchar *journal_file;
+
+/* Replay replaces the transaction, so look it up afresh each time. */
+static Transaction *
+current_trans (void)
+{
+    return xaccTransLookup (&trans_guid, book);
+}
+
+static void
+set_trans (Transaction *trans, const char *desc, gint64 cents)
+{
+    Split *split_a = xaccTransFindSplitByAccount (trans, acc_a);
+    Split *split_b = xaccTransFindSplitByAccount (trans, acc_b);
+    gnc_numeric amount = gnc_numeric_create (cents, 100);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, desc);
+    xaccSplitSetAmount (split_a, gnc_numeric_neg (amount));
+    xaccSplitSetValue (split_a, gnc_numeric_neg (amount));
+    xaccSplitSetAmount (split_b, amount);
+    xaccSplitSetValue (split_b, amount);
+    xaccTransCommitEdit (trans);
+}
+
+static Transaction *
+make_trans (void)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *split_a = xaccMallocSplit (book);
+    Split *split_b = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, xaccAccountGetCommodity (acc_a));
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_time (NULL));
+    xaccSplitSetParent (split_a, trans);
+    xaccSplitSetParent (split_b, trans);
+    xaccSplitSetAccount (split_a, acc_a);
+    xaccSplitSetAccount (split_b, acc_b);
+    xaccTransCommitEdit (trans);
+    set_trans (trans, "original", 1000);
+    return trans;
+}
+
+static Account *
+make_account (gnc_commodity *currency, const char *name)
+{
+    Account *acc = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetCommodity (acc, currency);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (gnc_book_get_root_account (book), acc);
+    return acc;
+}
+
+/* Writes a journal holding the current state of trans and returns its
+ * contents, for the tests to damage. */
+static gchar *
+write_journal (Transaction *trans)
+{
+    FILE *journal = g_fopen (journal_file, "w");
+    gchar *contents = NULL;
+
+    do_test (journal && gnc_xml2_journal_write_header (journal) &&
+             gnc_xml2_journal_write_trans (journal, trans),
+             "write the journal");
+    if (journal)
+        fclose (journal);
+    g_file_get_contents (journal_file, &contents, NULL, NULL);
+    return contents;
+}
+
+static gint
+trans_count (void)
+{
+    return qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS));
+}
+
+static void
+check_trans (const char *desc, gint64 cents, const char *title)
+{
+    Transaction *trans = current_trans ();
+    gchar *msg;
+
+    msg = g_strdup_printf ("%s: one transaction", title);
+    do_test (trans != NULL && trans_count () == 1, msg);
+    g_free (msg);
+    if (!trans)
+        return;
+    msg = g_strdup_printf ("%s: description", title);
+    do_test (g_strcmp0 (xaccTransGetDescription (trans), desc) == 0, msg);
+    g_free (msg);
+    msg = g_strdup_printf ("%s: balances", title);
+    do_test (gnc_numeric_equal (xaccAccountGetBalance (acc_b),
+                                gnc_numeric_create (cents, 100)) &&
+             gnc_numeric_equal (xaccAccountGetBalance (acc_a),
+                                gnc_numeric_create (-cents, 100)), msg);
+    g_free (msg);
+}
+
+static void
+test_replay_replaces (void)
+{
+    set_trans (current_trans (), "journaled", 2000);
+    g_free (write_journal (current_trans ()));
+    set_trans (current_trans (), "original", 1000);
+
+    do_test (gnc_xml2_journal_replay (journal_file, book), "replay");
+    check_trans ("journaled", 2000, "replay");
+}
+
+static void
+test_replay_damaged (void)
+{
+    gchar *contents, **parts, *damaged;
+
+    /* A well-formed record that doesn't parse as a transaction. */
+    set_trans (current_trans (), "damaged", 4000);
+    contents = write_journal (current_trans ());
+    set_trans (current_trans (), "original", 1000);
+    parts = g_strsplit (contents, "trn:description", -1);
+    damaged = g_strjoinv ("trn:bogus", parts);
+    g_file_set_contents (journal_file, damaged, -1, NULL);
+    g_strfreev (parts);
+    g_free (damaged);
+    g_free (contents);
+
+    do_test (!gnc_xml2_journal_replay (journal_file, book), "replay damaged");
+    check_trans ("original", 1000, "replay damaged");
+}
+
+static void
+test_replay_truncated (void)
+{
+    GString *journal;
+    gchar *first, *second, *record;
+
+    /* A complete record followed by one torn in the middle. */
+    set_trans (current_trans (), "first", 5000);
+    first = write_journal (current_trans ());
+    set_trans (current_trans (), "second", 6000);
+    second = write_journal (current_trans ());
+    set_trans (current_trans (), "original", 1000);
+    record = strstr (second, "<gnc:transaction");
+    journal = g_string_new (first);
+    g_string_append_len (journal, record, strlen (record) / 2);
+    g_file_set_contents (journal_file, journal->str, journal->len, NULL);
+    g_string_free (journal, TRUE);
+    g_free (first);
+    g_free (second);
+
+    do_test (!gnc_xml2_journal_replay (journal_file, book), "replay truncated");
+    check_trans ("first", 5000, "replay truncated");
+}
+
+static void
+test_replay_read_only (void)
+{
+    /* Like the transaction of a posted invoice. */
+    set_trans (current_trans (), "read-only", 3000);
+    xaccTransSetReadOnly (current_trans (), "posted");
+    g_free (write_journal (current_trans ()));
+
+    do_test (gnc_xml2_journal_replay (journal_file, book), "replay read-only");
+    check_trans ("read-only", 3000, "replay read-only");
+    do_test (current_trans () && xaccTransGetReadOnly (current_trans ()),
+             "replay read-only: still read-only");
+}
+
+int
+main (int argc, char ** argv)
+{
+    gnc_commodity_table *table;
+    gnc_commodity *usd;
+    gchar *name;
+
+    qof_init ();
+    cashobjects_register ();
+    xaccLogDisable ();
+
+    book = qof_book_new ();
+    table = gnc_commodity_table_get_table (book);
+    usd = gnc_commodity_new (book, "US Dollar", "ISO4217", "USD", "840", 100);
+    usd = gnc_commodity_table_insert (table, usd);
+    acc_a = make_account (usd, "A");
+    acc_b = make_account (usd, "B");
+
+    name = g_strdup_printf ("test-xml-journal-%d", (int)getpid ());
+    journal_file = g_build_filename (g_get_tmp_dir (), name, NULL);
+    g_free (name);
+
+    trans_guid = *qof_instance_get_guid (QOF_INSTANCE (make_trans ()));
+
+    test_replay_replaces ();
+    test_replay_damaged ();
+    test_replay_truncated ();
+    test_replay_read_only ();
+
+    g_unlink (journal_file);
+    g_free (journal_file);
+    print_test_results ();
+    qof_book_destroy (book);
+    qof_close ();
+    exit (get_rv ());
+}
@@ -86,6 +86,8 @@ static int          nofile           = 0;
 static const gchar *gsettings_prefix = NULL;
 static const char  *add_quotes_file  = NULL;
 static char        *namespace_regexp = NULL;
+static gchar      **run_reports      = NULL;
+static const gchar *output_dir       = NULL;
 static const char  *file_to_load     = NULL;
 static gchar      **args_remaining   = NULL;
 
@@ -143,6 +145,20 @@ static GOptionEntry options[] =
            http://developer.gnome.org/doc/API/2.0/glib/glib-Commandline-option-parser.html */
         N_("REGEXP")
     },
+    {
+        "run-report", '\0', 0, G_OPTION_ARG_STRING_ARRAY, &run_reports,
+        N_("Run the named report or saved report on the datafile and write it to an html file named after it, without starting the user interface.\nThis can be invoked multiple times."),
+        /* Translators: Argument description for autohelp; see
+           http://developer.gnome.org/doc/API/2.0/glib/glib-Commandline-option-parser.html */
+        N_("REPORTNAME")
+    },
+    {
+        "output-dir", '\0', 0, G_OPTION_ARG_STRING, &output_dir,
+        N_("Directory to write the reports of --run-report into; defaults to the current directory"),
+        /* Translators: Argument description for autohelp; see
+           http://developer.gnome.org/doc/API/2.0/glib/glib-Commandline-option-parser.html */
+        N_("DIRECTORY")
+    },
     {
         G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &args_remaining, NULL, N_("[datafile]") },
     { NULL }
@@ -598,6 +614,78 @@ fail:
     gnc_shutdown(1);
 }
 
+/* Run the reports named with --run-report on the datafile, writing each
+ * to <output-dir>/<report name>.html.  The book is opened without
+ * taking its lock and never saved, so this can run alongside a
+ * GnuCash that has the book open, or alongside other --run-report
+ * runs on the same book.  All the reports are run on the one loaded
+ * book, one after the other. */
+static void
+inner_main_run_reports(void *closure, int argc, char **argv)
+{
+    SCM run_report;
+    QofSession *session = NULL;
+    gchar **name;
+    int failures = 0;
+
+    scm_c_eval_string("(debug-set! stack 200000)");
+    scm_set_current_module(scm_c_resolve_module("gnucash main"));
+
+    load_gnucash_modules();
+    load_system_config();
+    load_user_config();
+    gnc_prefs_init ();
+
+    session = gnc_get_current_session();
+    if (!session) goto fail;
+
+    qof_session_begin(session, file_to_load, TRUE, FALSE, FALSE);
+    if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR) goto fail;
+
+    qof_session_load(session, NULL);
+    if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR) goto fail;
+
+    scm_c_use_module("gnucash report report-system");
+    run_report = scm_c_eval_string("gnc:report-run-by-name");
+
+    for (name = run_reports; *name; name++)
+    {
+        SCM html = scm_call_1(run_report, scm_from_utf8_string(*name));
+        gchar *basename, *filename;
+        GError *error = NULL;
+        char *text;
+
+        if (!scm_is_string(html))
+        {
+            g_printerr(_("Report \"%s\" could not be run.\n"), *name);
+            failures++;
+            continue;
+        }
+
+        basename = g_strconcat(*name, ".html", NULL);
+        g_strdelimit(basename, "/\\:*?\"<>|", '_');
+        filename = g_build_filename(output_dir ? output_dir : ".", basename, NULL);
+        text = scm_to_utf8_string(html);
+        if (!g_file_set_contents(filename, text, -1, &error))
+        {
+            g_printerr("%s\n", error->message);
+            g_error_free(error);
+            failures++;
+        }
+        free(text);
+        g_free(filename);
+        g_free(basename);
+    }
+
+    qof_session_end(session);
+    gnc_shutdown(failures ? 1 : 0);
+    return;
+fail:
+    if (session && qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
+        g_warning("Session Error: %s", qof_session_get_error_message(session));
+    gnc_shutdown(1);
+}
+
 static char *
 get_file_to_load()
 {
@@ -607,6 +695,25 @@ get_file_to_load()
         return gnc_history_get_last();
 }
 
+/* Finance::Quote is looked for by running a perl script, which is
+ * slow, and only getting quotes and the commodity dialogs need it; so
+ * it is done once the main window is up. */
+static gboolean
+install_price_quote_sources (gpointer unused)
+{
+    scm_c_use_module("gnucash price-quotes");
+    scm_c_eval_string("(gnc:price-quotes-install-sources)");
+    return FALSE;
+}
+
+/* Writes the GNC_PROFILE trace while the component manager and the
+ * other GUI subsystems can still report their statistics. */
+static void
+write_profile (gpointer data, gpointer user_data)
+{
+    qof_profile_write ();
+}
+
 static void
 inner_main (void *closure, int argc, char **argv)
 {
@@ -641,11 +748,7 @@ inner_main (void *closure, int argc, char **argv)
     gnc_main_gui_init();
 
     gnc_hook_add_dangler(HOOK_UI_SHUTDOWN, (GFunc)gnc_file_quit, NULL);
-
-    /* Install Price Quote Sources */
-    gnc_update_splash_screen(_("Checking Finance::Quote..."), GNC_SPLASH_PERCENTAGE_UNKNOWN);
-    scm_c_use_module("gnucash price-quotes");
-    scm_c_eval_string("(gnc:price-quotes-install-sources)");
+    gnc_hook_add_dangler(HOOK_UI_SHUTDOWN, write_profile, NULL);
 
     gnc_hook_run(HOOK_STARTUP, NULL);
 
@@ -666,9 +769,13 @@ inner_main (void *closure, int argc, char **argv)
     gnc_destroy_splash_screen();
     gnc_main_window_show_all_windows();
 
+    /* Install Price Quote Sources */
+    g_idle_add_full(G_PRIORITY_LOW, install_price_quote_sources, NULL, NULL);
+
     gnc_hook_run(HOOK_UI_POST_STARTUP, NULL);
     gnc_ui_start_event_loop();
     gnc_hook_remove_dangler(HOOK_UI_SHUTDOWN, (GFunc)gnc_file_quit);
+    gnc_hook_remove_dangler(HOOK_UI_SHUTDOWN, write_profile);
 
     gnc_shutdown(0);
     return;
@@ -806,6 +913,24 @@ main(int argc, char ** argv)
         exit(0);  /* never reached */
     }
 
+    /* If asked via a command line parameter, only run reports */
+    if (run_reports)
+    {
+        if (!file_to_load)
+        {
+            g_printerr(_("%s\nRun '%s --help' to see a full list of available command line options.\n"),
+                       _("Error: --run-report needs a datafile to run the reports on."),
+                       argv[0]);
+            return 1;
+        }
+        /* The report modules use gtk types, but nothing is ever shown,
+         * so it's fine if there is no display to open. */
+        gtk_init_check (&argc, &argv);
+        gnc_module_system_init();
+        scm_boot_guile(argc, argv, inner_main_run_reports, 0);
+        exit(0);  /* never reached */
+    }
+
     /* We need to initialize gtk before looking up all modules */
     gnc_gtk_add_rc_file ();
     if(!gtk_init_check (&argc, &argv))
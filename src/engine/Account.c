@@ -40,6 +40,7 @@
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qofbackend-p.h"
 #include "gnc-features.h"
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
@@ -47,6 +48,9 @@ static QofLogModule log_module = GNC_MOD_ACCOUNT;
 /* The Canonical Account Separator.  Pre-Initialized. */
 static gchar account_separator[8] = ".";
 static gunichar account_uc_separator = ':';
+/* Bumped whenever the separator changes, invalidating every cached
+ * full name at once. */
+static guint account_full_name_generation = 1;
 /* Predefined KVP paths */
 static const char *KEY_ASSOC_INCOME_ACCOUNT = "ofx/associated-income-account";
 #define AB_KEY "hbci"
@@ -118,6 +122,15 @@ enum
 \********************************************************************/
 
 static void xaccAccountBringUpToDate (Account *acc);
+static void account_splits_clear (AccountPrivate *priv);
+static void account_clear_full_names (Account *acc);
+static const gchar *account_get_full_name_cached (const Account *account);
+static void account_tree_indexes_invalidate (Account *acc);
+static void account_drop_indexes (AccountPrivate *priv);
+static void imap_bayes_table_free (struct imap_bayes_table *table);
+static gboolean account_bulk_ingest_defer (Account *acc);
+static gint account_split_array_find (const AccountPrivate *priv,
+                                      const Split *s, guint limit);
 
 
 /********************************************************************\
@@ -150,12 +163,14 @@ gnc_set_account_separator (const gchar *separator)
     {
         account_uc_separator = ':';
         strcpy(account_separator, ":");
+        account_full_name_generation++;
         return;
     }
 
     account_uc_separator = uc;
     count = g_unichar_to_utf8(uc, account_separator);
     account_separator[count] = '\0';
+    account_full_name_generation++;
 }
 
 gchar *gnc_account_name_violations_errmsg (const gchar *separator, GList* invalid_account_names)
@@ -249,6 +264,11 @@ gnc_account_init(Account* acc)
     priv = GET_PRIVATE(acc);
     priv->parent   = NULL;
     priv->children = NULL;
+    priv->full_name = NULL;
+    priv->full_name_generation = 0;
+    priv->full_name_index = NULL;
+    priv->full_name_index_generation = 0;
+    priv->code_index = NULL;
 
     priv->accountName = CACHE_INSERT("");
     priv->accountCode = CACHE_INSERT("");
@@ -260,6 +280,7 @@ gnc_account_init(Account* acc)
 
     priv->policy = xaccGetFIFOPolicy();
     priv->lots = NULL;
+    priv->open_lots = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     priv->commodity = NULL;
     priv->commodity_scu = 0;
@@ -272,8 +293,11 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 
     priv->splits = NULL;
+    priv->split_array = g_ptr_array_new();
+    priv->split_nodes = g_hash_table_new(g_direct_hash, g_direct_equal);
     priv->sort_dirty = FALSE;
 }
 
@@ -286,6 +310,22 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+
+    g_free(priv->full_name);
+    priv->full_name = NULL;
+    account_drop_indexes(priv);
+    imap_bayes_table_free(priv->imap_bayes);
+    priv->imap_bayes = NULL;
+    g_list_free(priv->splits);
+    priv->splits = NULL;
+    g_ptr_array_free(priv->split_array, TRUE);
+    priv->split_array = NULL;
+    g_hash_table_destroy(priv->split_nodes);
+    priv->split_nodes = NULL;
+    g_hash_table_destroy(priv->open_lots);
+    priv->open_lots = NULL;
+
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1221,6 +1261,7 @@ xaccFreeAccount (Account *acc)
         }
         g_list_free (priv->lots);
         priv->lots = NULL;
+        g_hash_table_remove_all (priv->open_lots);
     }
 
     /* Next, clean up the splits */
@@ -1359,8 +1400,7 @@ xaccAccountCommitEdit (Account *acc)
         }
         else
         {
-            g_list_free(priv->splits);
-            priv->splits = NULL;
+            account_splits_clear(priv);
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1385,6 +1425,7 @@ xaccAccountCommitEdit (Account *acc)
         }
         g_list_free(priv->lots);
         priv->lots = NULL;
+        g_hash_table_remove_all(priv->open_lots);
 
         qof_instance_set_dirty(&acc->inst);
         qof_instance_decrease_editlevel(acc);
@@ -1686,6 +1727,18 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
 
 /********************************************************************\
 \********************************************************************/
+
+/* Record that the running balances from split_array[index] onwards
+ * need to be recomputed.  The watermark only ever moves down until
+ * the next recompute. */
+static void
+account_set_balance_dirty_from (AccountPrivate *priv, guint index)
+{
+    if (!priv->balance_dirty || index < priv->balance_dirty_from)
+        priv->balance_dirty_from = index;
+    priv->balance_dirty = TRUE;
+}
+
 void
 gnc_account_set_sort_dirty (Account *acc)
 {
@@ -1698,6 +1751,8 @@ gnc_account_set_sort_dirty (Account *acc)
 
     priv = GET_PRIVATE(acc);
     priv->sort_dirty = TRUE;
+    /* Nothing sorts it before the end of an ingest. */
+    (void)account_bulk_ingest_defer(acc);
 }
 
 void
@@ -1711,43 +1766,307 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from(priv, 0);
+}
+
+void
+gnc_account_set_balance_dirty_at (Account *acc, const Split *split)
+{
+    AccountPrivate *priv;
+    guint limit;
+    gint index;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    priv = GET_PRIVATE(acc);
+    if (priv->balance_dirty && priv->balance_dirty_from == 0)
+        return;
+
+    /* Only a position below the current watermark can lower it. */
+    limit = priv->balance_dirty ? priv->balance_dirty_from
+            : priv->split_array->len;
+    index = account_split_array_find(priv, split, limit);
+    account_set_balance_dirty_from(priv, index >= 0 ? (guint)index : limit);
+}
+
+/********************************************************************\
+ * Split storage helpers.                                           *
+ *                                                                  *
+ * The split array is kept in xaccSplitOrder() order whenever       *
+ * sort_dirty is FALSE, so positions can be found by bisection.     *
+ * While sort_dirty is TRUE new splits are simply appended and the  *
+ * next xaccAccountSortSplits() puts everything back in order.      *
+\********************************************************************/
+
+/* Return the index of the first split in the array that sorts after s. */
+static guint
+account_split_upper_bound (const AccountPrivate *priv, const Split *s)
+{
+    guint lo = 0, hi = priv->split_array->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        const Split *m = g_ptr_array_index(priv->split_array, mid);
+        if (xaccSplitOrder(m, s) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Return the index of the first split in the array that doesn't sort
+ * before s. */
+static guint
+account_split_lower_bound (const AccountPrivate *priv, const Split *s)
+{
+    guint lo = 0, hi = priv->split_array->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        const Split *m = g_ptr_array_index(priv->split_array, mid);
+        if (xaccSplitOrder(m, s) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Find the array position of s among the first limit splits, or -1 if
+ * it isn't there.  A split whose sort key has changed, or one appended
+ * while the account was sort-dirty, won't be where the bisection
+ * expects it, so fall back to a scan. */
+static gint
+account_split_array_find (const AccountPrivate *priv, const Split *s,
+                          guint limit)
+{
+    guint i;
+
+    if (limit > priv->split_array->len)
+        limit = priv->split_array->len;
+
+    i = account_split_lower_bound(priv, s);
+    if (i < limit && g_ptr_array_index(priv->split_array, i) == s)
+        return (gint)i;
+
+    for (i = 0; i < limit; i++)
+        if (g_ptr_array_index(priv->split_array, i) == s)
+            return (gint)i;
+    return -1;
+}
+
+static void
+account_split_array_insert (GPtrArray *array, guint index, Split *s)
+{
+    g_ptr_array_add(array, NULL);
+    if (index < array->len - 1)
+        memmove(&array->pdata[index + 1], &array->pdata[index],
+                (array->len - 1 - index) * sizeof(gpointer));
+    array->pdata[index] = s;
+}
+
+static void
+account_splits_clear (AccountPrivate *priv)
+{
+    g_list_free(priv->splits);
+    priv->splits = NULL;
+    g_ptr_array_set_size(priv->split_array, 0);
+    g_hash_table_remove_all(priv->split_nodes);
+}
+
+/* Rebuild the array from the list after the list has been reordered.
+ * The list nodes themselves are reused, so split_nodes stays valid.
+ * Running balances are only invalidated from the first position whose
+ * split changed. */
+static void
+account_split_array_rebuild (AccountPrivate *priv)
+{
+    GList *node;
+    guint i, first_moved = priv->split_array->len;
+
+    for (node = priv->splits, i = 0; node; node = node->next, i++)
+    {
+        if (g_ptr_array_index(priv->split_array, i) != node->data)
+        {
+            if (i < first_moved)
+                first_moved = i;
+            priv->split_array->pdata[i] = node->data;
+        }
+    }
+    account_set_balance_dirty_from(priv, first_moved);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+/********************************************************************\
+ * Bulk ingest                                                      *
+ *                                                                  *
+ * While a book is ingesting, splits inserted into its accounts are *
+ * appended unsorted, and neither inserting nor removing splits     *
+ * generates events.  The accounts touched are remembered and       *
+ * brought up to date once when the ingest ends.                    *
+\********************************************************************/
+
+#define GNC_ACCOUNT_BULK_INGEST "gnc-account-bulk-ingest"
+
+typedef struct
+{
+    guint depth;
+    GPtrArray *accounts;        /* touched accounts, in order, ref'd */
+    GHashTable *seen;
+} AccountBulkIngest;
+
+static AccountBulkIngest *
+account_get_bulk_ingest (const Account *acc)
+{
+    QofBook *book = gnc_account_get_book(acc);
+    return book ? qof_book_get_data(book, GNC_ACCOUNT_BULK_INGEST) : NULL;
+}
+
+static void
+account_bulk_ingest_note (AccountBulkIngest *ingest, Account *acc)
+{
+    if (g_hash_table_lookup(ingest->seen, acc))
+        return;
+    g_hash_table_insert(ingest->seen, acc, acc);
+    g_ptr_array_add(ingest->accounts, g_object_ref(acc));
+}
+
+/* If acc's book is ingesting, leaves bringing acc up to date to the
+ * end of the ingest and returns TRUE. */
+static gboolean
+account_bulk_ingest_defer (Account *acc)
+{
+    AccountBulkIngest *ingest = account_get_bulk_ingest(acc);
+
+    if (!ingest)
+        return FALSE;
+    account_bulk_ingest_note(ingest, acc);
+    return TRUE;
+}
+
+void
+gnc_account_begin_bulk_ingest (QofBook *book)
+{
+    AccountBulkIngest *ingest;
+
+    g_return_if_fail(QOF_IS_BOOK(book));
+
+    ingest = qof_book_get_data(book, GNC_ACCOUNT_BULK_INGEST);
+    if (!ingest)
+    {
+        ingest = g_new0(AccountBulkIngest, 1);
+        ingest->accounts = g_ptr_array_new();
+        ingest->seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+        qof_book_set_data(book, GNC_ACCOUNT_BULK_INGEST, ingest);
+    }
+    ingest->depth++;
+}
+
+void
+gnc_account_end_bulk_ingest (QofBook *book)
+{
+    AccountBulkIngest *ingest;
+    guint i;
+
+    g_return_if_fail(QOF_IS_BOOK(book));
+
+    ingest = qof_book_get_data(book, GNC_ACCOUNT_BULK_INGEST);
+    g_return_if_fail(ingest != NULL);
+    if (--ingest->depth > 0)
+        return;
+
+    /* Detach first, so that the accounts see a normal book below. */
+    qof_book_set_data(book, GNC_ACCOUNT_BULK_INGEST, NULL);
+    for (i = 0; i < ingest->accounts->len; i++)
+    {
+        Account *acc = g_ptr_array_index(ingest->accounts, i);
+
+        if (!qof_instance_get_destroying(acc))
+        {
+            xaccAccountSortSplits(acc, TRUE);
+            xaccAccountRecomputeBalance(acc);
+            qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
+        }
+        g_object_unref(acc);
+    }
+    g_ptr_array_free(ingest->accounts, TRUE);
+    g_hash_table_destroy(ingest->seen);
+    g_free(ingest);
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
+    AccountBulkIngest *ingest;
     GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (g_hash_table_lookup(priv->split_nodes, s))
         return FALSE;
 
-    if (qof_instance_get_editlevel(acc) == 0)
+    ingest = account_get_bulk_ingest(acc);
+    if (!ingest && qof_instance_get_editlevel(acc) == 0 && !priv->sort_dirty)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        guint len = priv->split_array->len;
+        guint index = account_split_upper_bound(priv, s);
+
+        if (index < len)
+        {
+            GList *next = g_hash_table_lookup(priv->split_nodes,
+                                              g_ptr_array_index(priv->split_array, index));
+            priv->splits = g_list_insert_before(priv->splits, next, s);
+            node = next->prev;
+        }
+        else if (len > 0)
+        {
+            GList *last = g_hash_table_lookup(priv->split_nodes,
+                                              g_ptr_array_index(priv->split_array, len - 1));
+            node = g_list_alloc();
+            node->data = s;
+            node->prev = last;
+            last->next = node;
+        }
+        else
+        {
+            priv->splits = g_list_prepend(priv->splits, s);
+            node = priv->splits;
+        }
+        account_split_array_insert(priv->split_array, index, s);
+        account_set_balance_dirty_from(priv, index);
     }
     else
     {
         priv->splits = g_list_prepend(priv->splits, s);
+        node = priv->splits;
+        g_ptr_array_add(priv->split_array, s);
+        account_set_balance_dirty_from(priv, priv->split_array->len - 1);
         priv->sort_dirty = TRUE;
     }
+    g_hash_table_insert(priv->split_nodes, s, node);
+
+    if (ingest)
+    {
+        account_bulk_ingest_note(ingest, acc);
+        return TRUE;
+    }
 
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1757,23 +2076,36 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
+    AccountBulkIngest *ingest;
     GList *node;
+    gint index;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
+    node = g_hash_table_lookup(priv->split_nodes, s);
     if (NULL == node)
         return FALSE;
 
+    index = account_split_array_find(priv, s, priv->split_array->len);
+    if (index >= 0)
+        g_ptr_array_remove_index(priv->split_array, (guint)index);
+    account_set_balance_dirty_from(priv, index >= 0 ? (guint)index : 0);
+    g_hash_table_remove(priv->split_nodes, s);
     priv->splits = g_list_delete_link(priv->splits, node);
+
+    ingest = account_get_bulk_ingest(acc);
+    if (ingest)
+    {
+        account_bulk_ingest_note(ingest, acc);
+        return TRUE;
+    }
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
@@ -1789,14 +2121,16 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
     priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+    account_split_array_rebuild(priv);
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
 }
 
 static void
 xaccAccountBringUpToDate(Account *acc)
 {
     if (!acc) return;
+    /* The end of the ingest does this once for every touched account. */
+    if (account_bulk_ingest_defer(acc)) return;
 
     /* if a re-sort happens here, then everything will update, so the
        cost basis and balance calls are no-ops */
@@ -1912,6 +2246,7 @@ xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 
     ENTER ("(acc=%p, lot=%p)", acc, lot);
     priv->lots = g_list_remove(priv->lots, lot);
+    g_hash_table_remove(priv->open_lots, lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_REMOVE, NULL);
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
@@ -1941,10 +2276,13 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
         old_acc = lot_account;
         opriv = GET_PRIVATE(old_acc);
         opriv->lots = g_list_remove(opriv->lots, lot);
+        g_hash_table_remove(opriv->open_lots, lot);
     }
 
     priv = GET_PRIVATE(acc);
     priv->lots = g_list_prepend(priv->lots, lot);
+    /* Whether it is actually open is settled by the next search. */
+    g_hash_table_insert(priv->open_lots, lot, lot);
     gnc_lot_set_account(lot, acc);
 
     /* Don't move the splits to the new account.  The caller will do this
@@ -1958,6 +2296,128 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
 }
 
+void
+gnc_account_set_lot_closed (Account *acc, GNCLot *lot, gboolean closed)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    priv = GET_PRIVATE(acc);
+    if (closed)
+        g_hash_table_remove(priv->open_lots, lot);
+    else
+        g_hash_table_insert(priv->open_lots, lot, lot);
+}
+
+gpointer
+gnc_account_foreach_open_lot (const Account *acc,
+                              gpointer (*proc)(GNCLot *lot, gpointer data),
+                              gpointer data)
+{
+    AccountPrivate *priv;
+    GList *candidates, *node;
+    gpointer result = NULL;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    g_return_val_if_fail(proc, NULL);
+
+    priv = GET_PRIVATE(acc);
+    /* In lot list order, like xaccAccountForEachLot; proc may settle a
+     * lot's closed state, which edits open_lots. */
+    candidates = g_list_copy(priv->lots);
+    for (node = candidates; node && !result; node = node->next)
+    {
+        if (g_hash_table_lookup(priv->open_lots, node->data))
+            result = proc(node->data, data);
+    }
+    g_list_free(candidates);
+
+    return result;
+}
+
+/* A GHashTable slot holds a hash, a key and a value. */
+static gint64
+hash_table_bytes (GHashTable *table)
+{
+    return table ? g_hash_table_size (table) *
+           (sizeof (guint) + 2 * sizeof (gpointer)) : 0;
+}
+
+static gint64
+hash_table_count (GHashTable *table)
+{
+    return table ? g_hash_table_size (table) : 0;
+}
+
+static void
+add_key_bytes (gpointer key, gpointer value, gpointer data)
+{
+    *(gint64*)data += strlen (key) + 1;
+}
+
+/* The indexes also own copies of their keys. */
+static gint64
+index_bytes (GHashTable *index)
+{
+    gint64 bytes = hash_table_bytes (index);
+
+    if (index)
+        g_hash_table_foreach (index, add_key_bytes, &bytes);
+    return bytes;
+}
+
+GList *
+gnc_account_tree_get_memory_usage (Account *root, GList *usage)
+{
+    GList *accounts, *node;
+    gint64 splits = 0, children = 0, arrays = 0, array_splits = 0;
+    gint64 split_nodes = 0, split_nodes_bytes = 0;
+    gint64 open_lots = 0, open_lots_bytes = 0;
+    gint64 indexed = 0, indexes_bytes = 0;
+
+    g_return_val_if_fail (GNC_IS_ACCOUNT (root), usage);
+
+    accounts = g_list_prepend (gnc_account_get_descendants (root), root);
+    for (node = accounts; node; node = node->next)
+    {
+        AccountPrivate *priv = GET_PRIVATE (node->data);
+
+        splits += g_list_length (priv->splits);
+        children += g_list_length (priv->children);
+        if (priv->split_array)
+        {
+            arrays++;
+            array_splits += priv->split_array->len;
+        }
+        split_nodes += hash_table_count (priv->split_nodes);
+        split_nodes_bytes += hash_table_bytes (priv->split_nodes);
+        open_lots += hash_table_count (priv->open_lots);
+        open_lots_bytes += hash_table_bytes (priv->open_lots);
+        /* Only the top of a tree has them. */
+        indexed += hash_table_count (priv->full_name_index) +
+                   hash_table_count (priv->code_index);
+        indexes_bytes += index_bytes (priv->full_name_index) +
+                         index_bytes (priv->code_index);
+    }
+    g_list_free (accounts);
+
+    usage = qof_memory_usage_append (usage, "Account split lists", splits,
+                                     splits * sizeof (GList));
+    usage = qof_memory_usage_append (usage, "Account child lists", children,
+                                     children * sizeof (GList));
+    usage = qof_memory_usage_append (usage, "Account split arrays",
+                                     array_splits,
+                                     arrays * sizeof (GPtrArray) +
+                                     array_splits * sizeof (gpointer));
+    usage = qof_memory_usage_append (usage, "Account split nodes",
+                                     split_nodes, split_nodes_bytes);
+    usage = qof_memory_usage_append (usage, "Account open lots",
+                                     open_lots, open_lots_bytes);
+    return qof_memory_usage_append (usage, "Account name and code indexes",
+                                    indexed, indexes_bytes);
+}
+
 /********************************************************************\
 \********************************************************************/
 static void
@@ -1981,6 +2441,7 @@ void
 xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 {
     AccountPrivate *from_priv;
+    QofBook *book;
 
     /* errors */
     g_return_if_fail(GNC_IS_ACCOUNT(accfrom));
@@ -1995,11 +2456,22 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     g_return_if_fail (qof_instance_books_equal(accfrom, accto));
     ENTER ("(accfrom=%p, accto=%p)", accfrom, accto);
 
+    /* Hold back the per-split sorting and events on both accounts
+     * until everything has moved. */
+    book = gnc_account_get_book(accfrom);
+    gnc_account_begin_bulk_ingest(book);
     xaccAccountBeginEdit(accfrom);
     xaccAccountBeginEdit(accto);
     /* Begin editing both accounts and all transactions in accfrom. */
     g_list_foreach(from_priv->splits, (GFunc)xaccPreSplitMove, NULL);
 
+    /* A lot only makes sense in a single commodity.  If the accounts
+     * share one, carry the lots over whole; otherwise the splits leave
+     * their lots as they move. */
+    if (gnc_commodity_equiv(from_priv->commodity, GET_PRIVATE(accto)->commodity))
+        while (from_priv->lots)
+            xaccAccountInsertLot(accto, from_priv->lots->data);
+
     /* Concatenate accfrom's lists of splits and lots to accto's lists. */
     //to_priv->splits = g_list_concat(to_priv->splits, from_priv->splits);
     //to_priv->lots = g_list_concat(to_priv->lots, from_priv->lots);
@@ -2022,6 +2494,7 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     g_assert(from_priv->lots == NULL);
     xaccAccountCommitEdit(accfrom);
     xaccAccountCommitEdit(accto);
+    gnc_account_end_bulk_ingest(book);
 
     LEAVE ("(accfrom=%p, accto=%p)", accfrom, accto);
 }
@@ -2055,6 +2528,112 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
  * Return: void                                                     *
 \********************************************************************/
 
+/* gnc_numeric_add_fixed() for the running balances.  The amounts in an
+ * account are nearly all in its commodity's SCU, so once the balance is
+ * too the sum is a plain integer add; only a mismatched denominator or
+ * an int64 overflow goes through the general code. */
+static inline gnc_numeric
+account_balance_add (gnc_numeric balance, gnc_numeric amt)
+{
+    if (balance.denom == amt.denom && balance.denom > 0 &&
+        (amt.num >= 0 ? balance.num <= G_MAXINT64 - amt.num
+         : balance.num > G_MININT64 - amt.num))
+    {
+        balance.num += amt.num;
+        return balance;
+    }
+    return gnc_numeric_add_fixed (balance, amt);
+}
+
+/* Whether a balance can start the integer sums below: it must be in
+ * their denominator, or be a zero which gnc_numeric_add_fixed() would
+ * give that denominator with the first non-zero amount. */
+static inline gboolean
+account_balance_scalable (gnc_numeric start, gint64 denom, guint64 *bound)
+{
+    if (start.denom != denom && (start.num != 0 || start.denom <= 0))
+        return FALSE;
+    if (start.num == G_MININT64)
+        return FALSE;
+    *bound = MAX(*bound, (guint64) ABS(start.num));
+    return TRUE;
+}
+
+/* Recompute the running balances from split_array[from] on as integer
+ * prefix sums, the cleared and reconciled ones masked by the reconcile
+ * state.  A first pass checks that the amounts share one denominator
+ * and that no sum can overflow, so the second one needs neither
+ * denominator nor overflow checks.  The results are exactly those of
+ * the gnc_numeric_add_fixed() loop.  Returns FALSE, having changed
+ * nothing, if the check fails. */
+static gboolean
+account_recompute_balance_scaled (AccountPrivate *priv, guint from,
+                                  gnc_numeric *balance,
+                                  gnc_numeric *cleared_balance,
+                                  gnc_numeric *reconciled_balance)
+{
+    GPtrArray *splits = priv->split_array;
+    gint64 denom = 0, bal, clr, rec, bal_den, clr_den, rec_den;
+    guint64 bound = 0, total = 0;
+    guint i;
+
+    for (i = from; i < splits->len; i++)
+    {
+        gnc_numeric amt = xaccSplitGetAmount (g_ptr_array_index(splits, i));
+        guint64 mag;
+
+        if (amt.denom <= 0 || amt.num == G_MININT64)
+            return FALSE;
+        if (amt.num == 0)
+            continue;
+        if (denom == 0)
+            denom = amt.denom;
+        else if (amt.denom != denom)
+            return FALSE;
+        mag = (guint64) ABS(amt.num);
+        if (mag > (guint64) G_MAXINT64 - total)
+            return FALSE;
+        total += mag;
+    }
+    if (denom == 0 ||
+        !account_balance_scalable (*balance, denom, &bound) ||
+        !account_balance_scalable (*cleared_balance, denom, &bound) ||
+        !account_balance_scalable (*reconciled_balance, denom, &bound) ||
+        total > (guint64) G_MAXINT64 - bound)
+        return FALSE;
+
+    bal = balance->num;
+    clr = cleared_balance->num;
+    rec = reconciled_balance->num;
+    bal_den = balance->denom;
+    clr_den = cleared_balance->denom;
+    rec_den = reconciled_balance->denom;
+    for (i = from; i < splits->len; i++)
+    {
+        Split *split = g_ptr_array_index(splits, i);
+        gint64 amt = xaccSplitGetAmount (split).num;
+        gint64 clr_amt = amt & -(gint64) (NREC != split->reconciled);
+        gint64 rec_amt = amt & -(gint64) (YREC == split->reconciled ||
+                                          FREC == split->reconciled);
+
+        bal += amt;
+        clr += clr_amt;
+        rec += rec_amt;
+        bal_den = amt ? denom : bal_den;
+        clr_den = clr_amt ? denom : clr_den;
+        rec_den = rec_amt ? denom : rec_den;
+
+        split->balance = gnc_numeric_create (bal, bal_den);
+        split->cleared_balance = gnc_numeric_create (clr, clr_den);
+        split->reconciled_balance = gnc_numeric_create (rec, rec_den);
+    }
+
+    *balance = gnc_numeric_create (bal, bal_den);
+    *cleared_balance = gnc_numeric_create (clr, clr_den);
+    *reconciled_balance = gnc_numeric_create (rec, rec_den);
+    return TRUE;
+}
+
 void
 xaccAccountRecomputeBalance (Account * acc)
 {
@@ -2062,7 +2641,8 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    GList *lp;
+    guint i, from;
+    QOF_PROFILE_BEGIN (start);
 
     if (NULL == acc) return;
 
@@ -2072,29 +2652,47 @@ xaccAccountRecomputeBalance (Account * acc)
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    /* Pick up the running balances where they were last known to be
+     * good; everything before the watermark is left alone. */
+    from = MIN(priv->balance_dirty_from, priv->split_array->len);
+    if (from == 0)
+    {
+        balance            = priv->starting_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
+    else
+    {
+        Split *prev = g_ptr_array_index(priv->split_array, from - 1);
+        balance            = prev->balance;
+        cleared_balance    = prev->cleared_balance;
+        reconciled_balance = prev->reconciled_balance;
+    }
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    PINFO ("acct=%s starting at split %u baln=%" G_GINT64_FORMAT "/%"
+           G_GINT64_FORMAT, priv->accountName, from, balance.num,
+           balance.denom);
+    if (account_recompute_balance_scaled (priv, from, &balance,
+                                          &cleared_balance,
+                                          &reconciled_balance))
+        from = priv->split_array->len;
+    for (i = from; i < priv->split_array->len; i++)
     {
-        Split *split = (Split *) lp->data;
+        Split *split = g_ptr_array_index(priv->split_array, i);
         gnc_numeric amt = xaccSplitGetAmount (split);
 
-        balance = gnc_numeric_add_fixed(balance, amt);
+        balance = account_balance_add(balance, amt);
 
         if (NREC != split->reconciled)
         {
-            cleared_balance = gnc_numeric_add_fixed(cleared_balance, amt);
+            cleared_balance = account_balance_add(cleared_balance, amt);
         }
 
         if (YREC == split->reconciled ||
                 FREC == split->reconciled)
         {
             reconciled_balance =
-                gnc_numeric_add_fixed(reconciled_balance, amt);
+                account_balance_add(reconciled_balance, amt);
         }
 
         split->balance = balance;
@@ -2107,6 +2705,8 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
+    QOF_PROFILE_END (start, "balance-recompute");
 }
 
 /********************************************************************\
@@ -2221,7 +2821,8 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    /* new type may affect balance computation */
+    account_set_balance_dirty_from(priv, 0);
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2242,6 +2843,8 @@ xaccAccountSetName (Account *acc, const char *str)
 
     xaccAccountBeginEdit(acc);
     CACHE_REPLACE(priv->accountName, str);
+    account_clear_full_names (acc);
+    account_tree_indexes_invalidate (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2261,6 +2864,7 @@ xaccAccountSetCode (Account *acc, const char *str)
 
     xaccAccountBeginEdit(acc);
     CACHE_REPLACE(priv->accountCode, str ? str : "");
+    account_tree_indexes_invalidate (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2315,10 +2919,8 @@ set_kvp_string_tag (Account *acc, const char *tag, const char *value)
 static const char*
 get_kvp_string_tag (const Account *acc, const char *tag)
 {
-    GValue v = G_VALUE_INIT;
     if (acc == NULL || tag == NULL) return NULL;
-    qof_instance_get_kvp (QOF_INSTANCE (acc), tag, &v);
-    return G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : NULL;
+    return qof_instance_kvp_get_string (QOF_INSTANCE (acc), tag);
 }
 
 void
@@ -2397,7 +2999,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from(priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -2550,6 +3152,9 @@ gnc_account_append_child (Account *new_parent, Account *child)
     }
     cpriv->parent = new_parent;
     ppriv->children = g_list_append(ppriv->children, child);
+    account_clear_full_names (child);
+    account_drop_indexes (cpriv);
+    account_tree_indexes_invalidate (child);
     qof_instance_set_dirty(&new_parent->inst);
     qof_instance_set_dirty(&child->inst);
 
@@ -2590,12 +3195,14 @@ gnc_account_remove_child (Account *parent, Account *child)
     ed.idx = g_list_index(ppriv->children, child);
 
     ppriv->children = g_list_remove(ppriv->children, child);
+    account_tree_indexes_invalidate (parent);
 
     /* Now send the event. */
     qof_event_gen(&child->inst, QOF_EVENT_REMOVE, &ed);
 
     /* clear the account's parent pointer after REMOVE event generation. */
     cpriv->parent = NULL;
+    account_clear_full_names (child);
 
     qof_event_gen (&parent->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -2813,39 +3420,186 @@ gnc_account_lookup_by_name (const Account *parent, const char * name)
     return NULL;
 }
 
-Account *
-gnc_account_lookup_by_code (const Account *parent, const char * code)
+/********************************************************************\
+ * Lookup indexes                                                   *
+ *                                                                  *
+ * The top account of a tree carries hash tables mapping full names *
+ * and codes to accounts.  Each table records the account the       *
+ * corresponding linear search would have found first, so results   *
+ * don't change when several accounts share a name or code.         *
+\********************************************************************/
+
+static void
+account_drop_indexes (AccountPrivate *priv)
 {
-    AccountPrivate *cpriv, *ppriv;
-    Account *child, *result;
-    GList *node;
+    if (priv->full_name_index)
+        g_hash_table_destroy(priv->full_name_index);
+    priv->full_name_index = NULL;
+    if (priv->code_index)
+        g_hash_table_destroy(priv->code_index);
+    priv->code_index = NULL;
+}
 
-    g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
-    g_return_val_if_fail(code, NULL);
+static Account *
+account_get_top (const Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
 
-    /* first, look for accounts hanging off the current node */
-    ppriv = GET_PRIVATE(parent);
-    for (node = ppriv->children; node; node = node->next)
+    while (priv->parent)
     {
-        child = node->data;
-        cpriv = GET_PRIVATE(child);
-        if (g_strcmp0(cpriv->accountCode, code) == 0)
-            return child;
+        acc = priv->parent;
+        priv = GET_PRIVATE(acc);
     }
+    return (Account *)acc;
+}
 
-    /* if we are still here, then we haven't found the account yet.
-     * Recursively search each of the child accounts next */
-    for (node = ppriv->children; node; node = node->next)
-    {
-        child = node->data;
-        result = gnc_account_lookup_by_code (child, code);
-        if (result)
+static void
+account_tree_indexes_invalidate (Account *acc)
+{
+    account_drop_indexes(GET_PRIVATE(account_get_top(acc)));
+}
+
+static void
+account_index_insert (GHashTable *index, const gchar *key, Account *acc)
+{
+    if (key && !g_hash_table_lookup(index, key))
+        g_hash_table_insert(index, g_strdup(key), acc);
+}
+
+/* Same visiting order as gnc_account_lookup_by_code(): all the
+ * children first, then each child's subtree. */
+static void
+account_index_codes (GHashTable *index, const Account *parent)
+{
+    AccountPrivate *ppriv = GET_PRIVATE(parent);
+    GList *node;
+
+    for (node = ppriv->children; node; node = node->next)
+        account_index_insert(index, GET_PRIVATE(node->data)->accountCode,
+                             node->data);
+    for (node = ppriv->children; node; node = node->next)
+        account_index_codes(index, node->data);
+}
+
+/* Same visiting order as gnc_account_lookup_by_full_name_helper():
+ * depth first, children in order. */
+static void
+account_index_full_names (GHashTable *index, const Account *parent)
+{
+    AccountPrivate *ppriv = GET_PRIVATE(parent);
+    GList *node;
+
+    for (node = ppriv->children; node; node = node->next)
+    {
+        account_index_insert(index, account_get_full_name_cached(node->data),
+                             node->data);
+        account_index_full_names(index, node->data);
+    }
+}
+
+static GHashTable *
+account_get_code_index (const Account *top)
+{
+    AccountPrivate *priv = GET_PRIVATE(top);
+
+    if (!priv->code_index)
+    {
+        priv->code_index = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                 g_free, NULL);
+        account_index_codes(priv->code_index, top);
+    }
+    return priv->code_index;
+}
+
+static GHashTable *
+account_get_full_name_index (const Account *top)
+{
+    AccountPrivate *priv = GET_PRIVATE(top);
+
+    if (priv->full_name_index &&
+            priv->full_name_index_generation != account_full_name_generation)
+    {
+        g_hash_table_destroy(priv->full_name_index);
+        priv->full_name_index = NULL;
+    }
+    if (!priv->full_name_index)
+    {
+        priv->full_name_index = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                g_free, NULL);
+        account_index_full_names(priv->full_name_index, top);
+        priv->full_name_index_generation = account_full_name_generation;
+    }
+    return priv->full_name_index;
+}
+
+/* TRUE if no account on the path from acc upwards has the separator
+ * in its name, i.e. acc's full name splits back into its own path. */
+static gboolean
+account_path_is_plain (const Account *acc)
+{
+    const gchar *sep = gnc_get_account_separator_string();
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    while (priv->parent)
+    {
+        if (priv->accountName && strstr(priv->accountName, sep))
+            return FALSE;
+        priv = GET_PRIVATE(priv->parent);
+    }
+    return TRUE;
+}
+
+static Account *
+account_lookup_by_code_linear (const Account *parent, const char * code)
+{
+    AccountPrivate *cpriv, *ppriv;
+    Account *child, *result;
+    GList *node;
+
+    /* first, look for accounts hanging off the current node */
+    ppriv = GET_PRIVATE(parent);
+    for (node = ppriv->children; node; node = node->next)
+    {
+        child = node->data;
+        cpriv = GET_PRIVATE(child);
+        if (g_strcmp0(cpriv->accountCode, code) == 0)
+            return child;
+    }
+
+    /* if we are still here, then we haven't found the account yet.
+     * Recursively search each of the child accounts next */
+    for (node = ppriv->children; node; node = node->next)
+    {
+        child = node->data;
+        result = account_lookup_by_code_linear (child, code);
+        if (result)
             return result;
     }
 
     return NULL;
 }
 
+Account *
+gnc_account_lookup_by_code (const Account *parent, const char * code)
+{
+    Account *top, *found;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
+    g_return_val_if_fail(code, NULL);
+
+    top = account_get_top(parent);
+    found = g_hash_table_lookup(account_get_code_index(top), code);
+    if (!found)
+        return NULL;
+
+    /* The index holds the first match in the whole tree.  If that one
+     * is below parent it is also the first match below parent;
+     * otherwise there may still be another one further down. */
+    if (found != parent && xaccAccountHasAncestor(found, parent))
+        return found;
+    return account_lookup_by_code_linear(parent, code);
+}
+
 /********************************************************************\
  * Fetch an account, given its full name                            *
 \********************************************************************/
@@ -2911,6 +3665,16 @@ gnc_account_lookup_by_full_name (const Account *any_acc,
         root = rpriv->parent;
         rpriv = GET_PRIVATE(root);
     }
+    /* Anything the helper can find is in the index.  An account name
+     * containing the separator, though, makes its full name look like
+     * a deeper path which the helper would never match; those are
+     * rare, so leave them to the helper. */
+    found = g_hash_table_lookup(account_get_full_name_index(root), name);
+    if (!found)
+        return NULL;
+    if (account_path_is_plain(found))
+        return found;
+
     names = g_strsplit(name, gnc_get_account_separator_string(), -1);
     found = gnc_account_lookup_by_full_name_helper(root, names);
     g_strfreev(names);
@@ -3015,15 +3779,50 @@ xaccAccountGetName (const Account *acc)
     return GET_PRIVATE(acc)->accountName;
 }
 
+/* Return the cached full name of the account, building it (and those
+ * of its ancestors) first if needed.  The root account's name is not
+ * part of the full name. */
+static const gchar *
+account_get_full_name_cached (const Account *account)
+{
+    AccountPrivate *priv, *ppriv;
+
+    priv = GET_PRIVATE(account);
+    if (!priv->parent)
+        return "";
+
+    if (priv->full_name &&
+            priv->full_name_generation == account_full_name_generation)
+        return priv->full_name;
+
+    g_free(priv->full_name);
+    ppriv = GET_PRIVATE(priv->parent);
+    if (!ppriv->parent)
+        priv->full_name = g_strdup(priv->accountName);
+    else
+        priv->full_name =
+            g_strconcat(account_get_full_name_cached(priv->parent),
+                        account_separator, priv->accountName, NULL);
+    priv->full_name_generation = account_full_name_generation;
+    return priv->full_name;
+}
+
+/* Drop the cached full names of the account and all its descendants. */
+static void
+account_clear_full_names (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    GList *node;
+
+    g_free(priv->full_name);
+    priv->full_name = NULL;
+    for (node = priv->children; node; node = node->next)
+        account_clear_full_names(node->data);
+}
+
 gchar *
 gnc_account_get_full_name(const Account *account)
 {
-    AccountPrivate *priv;
-    const Account *a;
-    char *fullname;
-    gchar **names;
-    int level;
-
     /* So much for hardening the API. Too many callers to this function don't
      * bother to check if they have a non-NULL pointer before calling. */
     if (NULL == account)
@@ -3032,35 +3831,16 @@ gnc_account_get_full_name(const Account *account)
     /* errors */
     g_return_val_if_fail(GNC_IS_ACCOUNT(account), g_strdup(""));
 
-    /* optimizations */
-    priv = GET_PRIVATE(account);
-    if (!priv->parent)
-        return g_strdup("");
-
-    /* Figure out how much space is needed by counting the nodes up to
-     * the root. */
-    level = 0;
-    for (a = account; a; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        level++;
-    }
-
-    /* Get all the pointers in the right order. The root node "entry"
-     * becomes the terminating NULL pointer for the array of strings. */
-    names = g_malloc(level * sizeof(gchar *));
-    names[--level] = NULL;
-    for (a = account; level > 0; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        names[--level] = priv->accountName;
-    }
-
-    /* Build the full name */
-    fullname =  g_strjoinv(account_separator, names);
-    g_free(names);
+    return g_strdup(account_get_full_name_cached(account));
+}
 
-    return fullname;
+const char *
+xaccAccountGetFullName (const Account *account)
+{
+    if (NULL == account)
+        return "";
+    g_return_val_if_fail(GNC_IS_ACCOUNT(account), "");
+    return account_get_full_name_cached(account);
 }
 
 const char *
@@ -3108,14 +3888,11 @@ xaccAccountGetNotes (const Account *acc)
 gnc_commodity *
 DxaccAccountGetCurrency (const Account *acc)
 {
-    GValue v = G_VALUE_INIT;
     const char *s = NULL;
     gnc_commodity_table *table;
 
     if (!acc) return NULL;
-    qof_instance_get_kvp (QOF_INSTANCE(acc), "old-currency", &v);
-    if (G_VALUE_HOLDS_STRING (&v))
-        s = g_value_get_string (&v);
+    s = qof_instance_kvp_get_string (QOF_INSTANCE(acc), "old-currency");
     if (!s) return NULL;
 
     table = gnc_commodity_table_get_table (qof_instance_get_book(acc));
@@ -3175,7 +3952,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from(priv, 0);
 }
 
 void
@@ -3188,7 +3965,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from(priv, 0);
 }
 
 void
@@ -3201,7 +3978,7 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from(priv, 0);
 }
 
 gnc_numeric
@@ -3263,85 +4040,288 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Return the index of the first split in the (sorted) split array that
+ * was posted at or after date.  Splits are ordered by posted date
+ * first, so a bisection on the date alone is enough.  A split without
+ * a parent sorts after everything else and is treated the same way
+ * here. */
+static guint
+account_split_date_lower_bound (const AccountPrivate *priv, time64 date)
+{
+    guint lo = 0, hi = priv->split_array->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        const Split *split = g_ptr_array_index(priv->split_array, mid);
+        const Transaction *trans = split->parent;
+
+        if (trans && trans->date_posted.tv_sec < date)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* When the backend doesn't keep every split in memory, the ones the
+ * account holds can't give a dated balance, and the backend sums the
+ * splits posted from start to before end instead. */
+static gboolean
+account_backend_balance (Account *acc, const time64 *start, time64 end,
+                         gnc_numeric *balance)
+{
+    QofBackend *be = qof_book_get_backend (qof_instance_get_book (acc));
+    Timespec ts_start, ts_end;
+
+    if (!be || !be->balance_lookup)
+        return FALSE;
+
+    if (start)
+    {
+        ts_start.tv_sec = *start;
+        ts_start.tv_nsec = 0;
+    }
+    ts_end.tv_sec = end - 1;
+    ts_end.tv_nsec = 0;
+    return (be->balance_lookup) (be, QOF_INSTANCE (acc),
+                                 start ? &ts_start : NULL, &ts_end, balance);
+}
+
 gnc_numeric
 xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 {
-    /* Ideally this could use xaccAccountForEachSplit, but
-     * it doesn't exist yet and I'm uncertain of exactly how
-     * it would work at this time, since it differs from
-     * xaccAccountForEachTransaction by using gpointer return
-     * values rather than gints.
-     */
     AccountPrivate *priv;
-    GList   *lp;
-    Timespec ts, trans_ts;
-    gboolean found = FALSE;
+    guint index;
     gnc_numeric balance;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    if (account_backend_balance (acc, NULL, date, &balance))
+        return balance;
+
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
     priv = GET_PRIVATE(acc);
-    balance = priv->balance;
-
-    /* Since transaction post times are stored as a Timespec,
-     * convert date into a Timespec as well rather than converting
-     * each transaction's Timespec into a time64.
-     *
-     * FIXME: CAS: I think this comment is a bogus justification for
-     * using xaccTransGetDatePostedTS.  There's no benefit to using
-     * Timespec when the input argument is time64, and it's hard to
-     * imagine that casting long long to long and comparing two longs is
-     * worse than comparing two long longs every time.  IMO,
-     * xaccAccountGetPresentBalance gets this right, and its algorithm
-     * should be used here.
-     */
-    ts.tv_sec = date;
-    ts.tv_nsec = 0;
 
-    lp = priv->splits;
-    while ( lp && !found )
-    {
-        xaccTransGetDatePostedTS( xaccSplitGetParent( (Split *)lp->data ),
-                                  &trans_ts );
-        if ( timespec_cmp( &trans_ts, &ts ) >= 0 )
-            found = TRUE;
-        else
-            lp = lp->next;
-    }
+    /* Find the first split posted on or after the requested date; the
+     * running balance of the split just before it is the answer. */
+    index = account_split_date_lower_bound (priv, date);
 
-    if ( lp )
+    /* No splits posted after the given date, so the latest account
+     * balance is good enough. */
+    if (index == priv->split_array->len)
+        return priv->balance;
+
+    /* AsOf date must be before any entries, return zero. */
+    if (index == 0)
+        return gnc_numeric_zero();
+
+    return xaccSplitGetBalance (g_ptr_array_index(priv->split_array,
+                                                  index - 1));
+}
+
+Split *
+xaccAccountFindLastSplitAtDate (Account *acc, time64 date)
+{
+    AccountPrivate *priv;
+    guint index;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    priv = GET_PRIVATE(acc);
+
+    /* The first split posted after the date follows the one we want. */
+    if (date == G_MAXINT64)
+        index = priv->split_array->len;
+    else
+        index = account_split_date_lower_bound (priv, date + 1);
+
+    if (index == 0)
+        return NULL;
+    return g_ptr_array_index(priv->split_array, index - 1);
+}
+
+/********************************************************************\
+ * Balance snapshots                                                *
+\********************************************************************/
+
+struct gnc_balance_snapshot_s
+{
+    guint n_accounts;
+    guint n_dates;
+    /* n_accounts rows of n_dates entries each */
+    gnc_numeric *balance;
+    gnc_numeric *cleared_balance;
+    gnc_numeric *reconciled_balance;
+};
+
+static gint
+balance_snapshot_date_cmp (gconstpointer a, gconstpointer b, gpointer data)
+{
+    const time64 *dates = data;
+    time64 da = dates[*(const guint*)a], db = dates[*(const guint*)b];
+
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+GncBalanceSnapshot *
+gnc_balance_snapshot_new (GList *accounts, const time64 *dates, guint n_dates)
+{
+    GncBalanceSnapshot *snapshot;
+    guint *order, row, k;
+    GList *node;
+
+    g_return_val_if_fail (dates || n_dates == 0, NULL);
+
+    snapshot = g_new0 (GncBalanceSnapshot, 1);
+    snapshot->n_accounts = g_list_length (accounts);
+    snapshot->n_dates = n_dates;
+    snapshot->balance = g_new (gnc_numeric, snapshot->n_accounts * n_dates);
+    snapshot->cleared_balance =
+        g_new (gnc_numeric, snapshot->n_accounts * n_dates);
+    snapshot->reconciled_balance =
+        g_new (gnc_numeric, snapshot->n_accounts * n_dates);
+
+    /* Visit the dates in ascending order so that each account's splits
+     * are walked only once. */
+    order = g_new (guint, n_dates ? n_dates : 1);
+    for (k = 0; k < n_dates; k++)
+        order[k] = k;
+    g_qsort_with_data (order, n_dates, sizeof (guint),
+                       balance_snapshot_date_cmp, (gpointer)dates);
+
+    for (node = accounts, row = 0; node; node = node->next, row++)
     {
-        if ( lp->prev )
+        Account *acc = node->data;
+        AccountPrivate *priv;
+        guint index = 0;
+
+        if (!GNC_IS_ACCOUNT (acc))
         {
-            /* Since lp is now pointing to a split which was past the reconcile
-             * date, get the running balance of the previous split.
-             */
-            balance = xaccSplitGetBalance( (Split *)lp->prev->data );
+            for (k = 0; k < n_dates; k++)
+            {
+                guint cell = row * n_dates + k;
+                snapshot->balance[cell] = gnc_numeric_zero ();
+                snapshot->cleared_balance[cell] = gnc_numeric_zero ();
+                snapshot->reconciled_balance[cell] = gnc_numeric_zero ();
+            }
+            continue;
         }
-        else
+
+        xaccAccountSortSplits (acc, TRUE);
+        xaccAccountRecomputeBalance (acc);
+        priv = GET_PRIVATE (acc);
+
+        for (k = 0; k < n_dates; k++)
         {
-            /* AsOf date must be before any entries, return zero. */
-            balance = gnc_numeric_zero();
+            time64 date = dates[order[k]];
+            guint cell = row * n_dates + order[k];
+
+            /* Same stopping rule as account_split_date_lower_bound. */
+            while (index < priv->split_array->len)
+            {
+                const Split *split = g_ptr_array_index (priv->split_array,
+                                                        index);
+                if (!split->parent || split->parent->date_posted.tv_sec >= date)
+                    break;
+                index++;
+            }
+
+            if (index == priv->split_array->len)
+            {
+                snapshot->balance[cell] = priv->balance;
+                snapshot->cleared_balance[cell] = priv->cleared_balance;
+                snapshot->reconciled_balance[cell] = priv->reconciled_balance;
+            }
+            else if (index == 0)
+            {
+                snapshot->balance[cell] = gnc_numeric_zero ();
+                snapshot->cleared_balance[cell] = gnc_numeric_zero ();
+                snapshot->reconciled_balance[cell] = gnc_numeric_zero ();
+            }
+            else
+            {
+                const Split *split = g_ptr_array_index (priv->split_array,
+                                                        index - 1);
+                snapshot->balance[cell] = split->balance;
+                snapshot->cleared_balance[cell] = split->cleared_balance;
+                snapshot->reconciled_balance[cell] = split->reconciled_balance;
+            }
         }
     }
 
-    /* Otherwise there were no splits posted after the given date,
-     * so the latest account balance should be good enough.
-     */
+    g_free (order);
+    return snapshot;
+}
+
+void
+gnc_balance_snapshot_free (GncBalanceSnapshot *snapshot)
+{
+    if (!snapshot) return;
+    g_free (snapshot->balance);
+    g_free (snapshot->cleared_balance);
+    g_free (snapshot->reconciled_balance);
+    g_free (snapshot);
+}
+
+guint
+gnc_balance_snapshot_get_n_accounts (const GncBalanceSnapshot *snapshot)
+{
+    g_return_val_if_fail (snapshot, 0);
+    return snapshot->n_accounts;
+}
+
+guint
+gnc_balance_snapshot_get_n_dates (const GncBalanceSnapshot *snapshot)
+{
+    g_return_val_if_fail (snapshot, 0);
+    return snapshot->n_dates;
+}
 
-    return( balance );
+#define BALANCE_SNAPSHOT_CELL(snapshot, field, account_index, date_index) \
+    g_return_val_if_fail (snapshot, gnc_numeric_zero ()); \
+    g_return_val_if_fail (account_index < snapshot->n_accounts, \
+                          gnc_numeric_zero ()); \
+    g_return_val_if_fail (date_index < snapshot->n_dates, \
+                          gnc_numeric_zero ()); \
+    return snapshot->field[account_index * snapshot->n_dates + date_index]
+
+gnc_numeric
+gnc_balance_snapshot_get_balance (const GncBalanceSnapshot *snapshot,
+                                  guint account_index, guint date_index)
+{
+    BALANCE_SNAPSHOT_CELL (snapshot, balance, account_index, date_index);
+}
+
+gnc_numeric
+gnc_balance_snapshot_get_cleared_balance (const GncBalanceSnapshot *snapshot,
+        guint account_index, guint date_index)
+{
+    BALANCE_SNAPSHOT_CELL (snapshot, cleared_balance,
+                           account_index, date_index);
 }
 
+gnc_numeric
+gnc_balance_snapshot_get_reconciled_balance (const GncBalanceSnapshot *snapshot,
+        guint account_index, guint date_index)
+{
+    BALANCE_SNAPSHOT_CELL (snapshot, reconciled_balance,
+                           account_index, date_index);
+}
+
+#undef BALANCE_SNAPSHOT_CELL
+
 /*
  * Originally gsr_account_present_balance in gnc-split-reg.c
  *
- * How does this routine compare to xaccAccountGetBalanceAsOfDate just
- * above?  These two routines should eventually be collapsed into one.
- * Perhaps the startup logic from that one, and the logic from this
- * one that walks from the tail of the split list.
+ * This uses the same bisection as xaccAccountGetBalanceAsOfDate, but
+ * doesn't force a sort, so if the splits are waiting to be sorted it
+ * walks back from the tail of the split list as it always did.
  */
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)
@@ -3349,11 +4329,22 @@ xaccAccountGetPresentBalance (const Account *acc)
     AccountPrivate *priv;
     GList *node;
     time64 today;
+    guint index;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
+
+    if (!priv->sort_dirty)
+    {
+        index = account_split_date_lower_bound (priv, today + 1);
+        if (index == 0)
+            return gnc_numeric_zero ();
+        return xaccSplitGetBalance (g_ptr_array_index(priv->split_array,
+                                                      index - 1));
+    }
+
     for (node = g_list_last(priv->splits); node; node = node->prev)
     {
         Split *split = node->data;
@@ -3479,8 +4470,39 @@ typedef struct
     xaccGetBalanceFn fn;
     xaccGetBalanceAsOfDateFn asOfDateFn;
     time64 date;
+    GHashTable *conversions;
 } CurrencyBalance;
 
+/*
+ * Convert an account balance to cb->currency.  The prices for each
+ * commodity are looked up once per tree walk; the result is the same
+ * as that of xaccAccountConvertBalanceToCurrency.
+ */
+static gnc_numeric
+xaccAccountConvertBalanceCached (CurrencyBalance *cb, const Account *acc,
+                                 gnc_numeric balance)
+{
+    const gnc_commodity *commodity = GET_PRIVATE(acc)->commodity;
+    GNCPriceConversion *conv;
+
+    if (gnc_numeric_zero_p (balance) ||
+            gnc_commodity_equiv (commodity, cb->currency))
+        return balance;
+
+    if (!cb->conversions)
+        cb->conversions = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                          NULL,
+                          (GDestroyNotify)gnc_price_conversion_free);
+    conv = g_hash_table_lookup (cb->conversions, commodity);
+    if (!conv)
+    {
+        GNCPriceDB *pdb = gnc_pricedb_get_db (gnc_account_get_book (acc));
+        conv = gnc_pricedb_conversion_new (pdb, commodity, cb->currency, NULL);
+        g_hash_table_insert (cb->conversions, (gpointer)commodity, conv);
+    }
+    return gnc_price_conversion_apply (conv, balance);
+}
+
 
 /*
  * A helper function for iterating over all the accounts in a list or
@@ -3495,7 +4517,7 @@ xaccAccountBalanceHelper (Account *acc, gpointer data)
 
     if (!cb->fn || !cb->currency)
         return;
-    balance = xaccAccountGetXxxBalanceInCurrency (acc, cb->fn, cb->currency);
+    balance = xaccAccountConvertBalanceCached (cb, acc, cb->fn (acc));
     cb->balance = gnc_numeric_add (cb->balance, balance,
                                    gnc_commodity_get_fraction (cb->currency),
                                    GNC_HOW_RND_ROUND_HALF_UP);
@@ -3509,8 +4531,8 @@ xaccAccountBalanceAsOfDateHelper (Account *acc, gpointer data)
 
     g_return_if_fail (cb->asOfDateFn && cb->currency);
 
-    balance = xaccAccountGetXxxBalanceAsOfDateInCurrency (
-                  acc, cb->date, cb->asOfDateFn, cb->currency);
+    balance = xaccAccountConvertBalanceCached (
+                  cb, acc, cb->asOfDateFn (acc, cb->date));
     cb->balance = gnc_numeric_add (cb->balance, balance,
                                    gnc_commodity_get_fraction (cb->currency),
                                    GNC_HOW_RND_ROUND_HALF_UP);
@@ -3552,14 +4574,16 @@ xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
         /* MSVC compiler: Somehow, the struct initialization containing a
            gnc_numeric doesn't work. As an exception, we hand-initialize
            that member afterwards. */
-        CurrencyBalance cb = { report_commodity, { 0 }, fn, NULL, 0 };
+        CurrencyBalance cb = { report_commodity, { 0 }, fn, NULL, 0, NULL };
         cb.balance = balance;
 #else
-        CurrencyBalance cb = { report_commodity, balance, fn, NULL, 0 };
+        CurrencyBalance cb = { report_commodity, balance, fn, NULL, 0, NULL };
 #endif
 
         gnc_account_foreach_descendant (acc, xaccAccountBalanceHelper, &cb);
         balance = cb.balance;
+        if (cb.conversions)
+            g_hash_table_destroy (cb.conversions);
     }
 
     return balance;
@@ -3589,14 +4613,16 @@ xaccAccountGetXxxBalanceAsOfDateInCurrencyRecursive (
         /* MSVC compiler: Somehow, the struct initialization containing a
            gnc_numeric doesn't work. As an exception, we hand-initialize
            that member afterwards. */
-        CurrencyBalance cb = { report_commodity, 0, NULL, fn, date };
+        CurrencyBalance cb = { report_commodity, 0, NULL, fn, date, NULL };
         cb.balance = balance;
 #else
-        CurrencyBalance cb = { report_commodity, balance, NULL, fn, date };
+        CurrencyBalance cb = { report_commodity, balance, NULL, fn, date, NULL };
 #endif
 
         gnc_account_foreach_descendant (acc, xaccAccountBalanceAsOfDateHelper, &cb);
         balance = cb.balance;
+        if (cb.conversions)
+            g_hash_table_destroy (cb.conversions);
     }
 
     return balance;
@@ -3672,11 +4698,93 @@ xaccAccountGetBalanceChangeForPeriod (Account *acc, time64 t1, time64 t2,
 {
     gnc_numeric b1, b2;
 
+    /* One sum over the period rather than two dated balances. */
+    if (!recurse && account_backend_balance (acc, &t1, t2, &b1))
+        return b1;
+
     b1 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t1, NULL, recurse);
     b2 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t2, NULL, recurse);
     return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 }
 
+/*
+ * The balances at every period boundary come from one balance
+ * snapshot over the account and its descendants; they are then summed
+ * up exactly as xaccAccountGetXxxBalanceAsOfDateInCurrencyRecursive
+ * would do it for each date.
+ */
+gnc_numeric *
+xaccAccountGetBalanceChangesForPeriods (Account *acc, const time64 *starts,
+                                        const time64 *ends, guint n_periods,
+                                        gboolean recurse)
+{
+    const gnc_commodity *commodity;
+    GncBalanceSnapshot *snapshot;
+    gnc_numeric *changes, *totals;
+    time64 *dates;
+    GList *accounts, *node;
+    guint i, j, row;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    g_return_val_if_fail((starts && ends) || n_periods == 0, NULL);
+
+    changes = g_new (gnc_numeric, n_periods ? n_periods : 1);
+    commodity = xaccAccountGetCommodity (acc);
+    if (!commodity)
+    {
+        for (i = 0; i < n_periods; i++)
+            changes[i] = gnc_numeric_zero ();
+        return changes;
+    }
+
+    /* Period i's start and end are dates 2i and 2i + 1. */
+    dates = g_new (time64, 2 * n_periods + 1);
+    for (i = 0; i < n_periods; i++)
+    {
+        dates[2 * i] = starts[i];
+        dates[2 * i + 1] = ends[i];
+    }
+
+    accounts = recurse ? gnc_account_get_descendants (acc) : NULL;
+    accounts = g_list_prepend (accounts, acc);
+    snapshot = gnc_balance_snapshot_new (accounts, dates, 2 * n_periods);
+
+    totals = g_new (gnc_numeric, 2 * n_periods + 1);
+    for (j = 0; j < 2 * n_periods; j++)
+        totals[j] = gnc_balance_snapshot_get_balance (snapshot, 0, j);
+
+    if (accounts->next)
+    {
+        /* Only the commodity and the conversion cache are used. */
+        CurrencyBalance cb = { commodity, { 0 }, NULL, NULL, 0, NULL };
+        int fraction = gnc_commodity_get_fraction (commodity);
+
+        for (node = accounts->next, row = 1; node; node = node->next, row++)
+        {
+            for (j = 0; j < 2 * n_periods; j++)
+            {
+                gnc_numeric balance = xaccAccountConvertBalanceCached (
+                    &cb, node->data,
+                    gnc_balance_snapshot_get_balance (snapshot, row, j));
+                totals[j] = gnc_numeric_add (totals[j], balance, fraction,
+                                             GNC_HOW_RND_ROUND_HALF_UP);
+            }
+        }
+        if (cb.conversions)
+            g_hash_table_destroy (cb.conversions);
+    }
+
+    for (i = 0; i < n_periods; i++)
+        changes[i] = gnc_numeric_sub (totals[2 * i + 1], totals[2 * i],
+                                      GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+
+    g_free (totals);
+    gnc_balance_snapshot_free (snapshot);
+    g_list_free (accounts);
+    g_free (dates);
+    return changes;
+}
+
 
 /********************************************************************\
 \********************************************************************/
@@ -3733,19 +4841,29 @@ xaccAccountFindOpenLots (const Account *acc,
                          gpointer user_data, GCompareFunc sort_func)
 {
     AccountPrivate *priv;
-    GList *lot_list;
+    GList *lot_list, *candidates;
     GList *retval = NULL;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
 
     priv = GET_PRIVATE(acc);
-    for (lot_list = priv->lots; lot_list; lot_list = lot_list->next)
+    /* The lots not known to be closed, in the order of the lot list so
+     * that unsorted results don't depend on hashing; settling a lot's
+     * state may drop it from open_lots, so walk a copy. */
+    candidates = g_list_copy(priv->lots);
+    for (lot_list = candidates; lot_list; lot_list = lot_list->next)
     {
         GNCLot *lot = lot_list->data;
 
+        if (!g_hash_table_lookup(priv->open_lots, lot))
+            continue;
+
         /* If this lot is closed, then ignore it */
         if (gnc_lot_is_closed (lot))
+        {
+            g_hash_table_remove(priv->open_lots, lot);
             continue;
+        }
 
         if (match_func && !(match_func)(lot, user_data))
             continue;
@@ -3756,6 +4874,7 @@ xaccAccountFindOpenLots (const Account *acc,
         else
             retval = g_list_prepend (retval, lot);
     }
+    g_list_free (candidates);
 
     return retval;
 }
@@ -3810,10 +4929,8 @@ xaccAccountSetTaxRelated (Account *acc, gboolean tax_related)
 const char *
 xaccAccountGetTaxUSCode (const Account *acc)
 {
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
-    qof_instance_get_kvp (QOF_INSTANCE(acc), "/tax-US/code", &v);
-    return G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : NULL;
+    return qof_instance_kvp_get_string (QOF_INSTANCE(acc), "/tax-US/code");
 }
 
 void
@@ -3833,12 +4950,10 @@ xaccAccountSetTaxUSCode (Account *acc, const char *code)
 const char *
 xaccAccountGetTaxUSPayerNameSource (const Account *acc)
 {
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
-    qof_instance_get_kvp (QOF_INSTANCE(acc),
-                          "/tax-US/payer-name-source", &v);
-    return G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : NULL;
- }
+    return qof_instance_kvp_get_string (QOF_INSTANCE(acc),
+                                        "/tax-US/payer-name-source");
+}
 
 void
 xaccAccountSetTaxUSPayerNameSource (Account *acc, const char *source)
@@ -3858,11 +4973,9 @@ gint64
 xaccAccountGetTaxUSCopyNumber (const Account *acc)
 {
     gint64 copy_number = 0;
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
-    qof_instance_get_kvp (QOF_INSTANCE(acc), "/tax-US/copy-number", &v);
-    if (G_VALUE_HOLDS_INT64 (&v))
-        copy_number = g_value_get_int64 (&v);
+    qof_instance_kvp_get_int64 (QOF_INSTANCE(acc), "/tax-US/copy-number",
+                                &copy_number);
 
     return (copy_number == 0) ? 1 : copy_number;
 }
@@ -5002,15 +6115,72 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
 /********************************************************************\
 \********************************************************************/
 
+/* The ForEach traversals below keep their visited transactions in a
+ * set of their own rather than in the transactions' markers, so they
+ * can nest and don't interfere with the staged traversals above. */
+
+static int
+account_foreach_unvisited_transaction (const Account *acc,
+                                       GHashTable *visited,
+                                       TransactionCallback thunk,
+                                       void *cb_data)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    GList *split_p, *next;
+    int retval;
+
+    for (split_p = priv->splits; split_p; split_p = next)
+    {
+        /* As in xaccAccountStagedTransactionTraversal, in case the
+         * thunk destroys the split we're on. */
+        Transaction *trans = ((Split*)split_p->data)->parent;
+        next = g_list_next(split_p);
+
+        if (!trans || g_hash_table_lookup(visited, trans))
+            continue;
+        g_hash_table_insert(visited, trans, trans);
+        retval = thunk(trans, cb_data);
+        if (retval) return retval;
+    }
+    return 0;
+}
+
+static int
+account_tree_foreach_unvisited_transaction (const Account *acc,
+        GHashTable *visited,
+        TransactionCallback thunk,
+        void *cb_data)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    GList *acc_p;
+    int retval;
+
+    /* depth first traversal */
+    for (acc_p = priv->children; acc_p; acc_p = g_list_next(acc_p))
+    {
+        retval = account_tree_foreach_unvisited_transaction(acc_p->data,
+                 visited, thunk, cb_data);
+        if (retval) return retval;
+    }
+
+    return account_foreach_unvisited_transaction(acc, visited, thunk, cb_data);
+}
+
 int
 xaccAccountTreeForEachTransaction (Account *acc,
                                    int (*proc)(Transaction *t, void *data),
                                    void *data)
 {
+    GHashTable *visited;
+    int retval;
+
     if (!acc || !proc) return 0;
 
-    gnc_account_tree_begin_staged_transaction_traversals (acc);
-    return gnc_account_tree_staged_transaction_traversal (acc, 42, proc, data);
+    visited = g_hash_table_new(g_direct_hash, g_direct_equal);
+    retval = account_tree_foreach_unvisited_transaction (acc, visited,
+             proc, data);
+    g_hash_table_destroy(visited);
+    return retval;
 }
 
 
@@ -5018,9 +6188,44 @@ gint
 xaccAccountForEachTransaction(const Account *acc, TransactionCallback proc,
                               void *data)
 {
+    GHashTable *visited;
+    gint retval;
+
     if (!acc || !proc) return 0;
-    xaccAccountBeginStagedTransactionTraversals (acc);
-    return xaccAccountStagedTransactionTraversal(acc, 42, proc, data);
+
+    visited = g_hash_table_new(g_direct_hash, g_direct_equal);
+    retval = account_foreach_unvisited_transaction (acc, visited, proc, data);
+    g_hash_table_destroy(visited);
+    return retval;
+}
+
+gint
+xaccAccountForEachSplitInRange (Account *acc, time64 t_start, time64 t_end,
+                                SplitCallback proc, gpointer data)
+{
+    AccountPrivate *priv;
+    guint index;
+
+    if (!acc || !proc) return 0;
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    priv = GET_PRIVATE(acc);
+
+    for (index = account_split_date_lower_bound (priv, t_start);
+            index < priv->split_array->len; index++)
+    {
+        Split *s = g_ptr_array_index(priv->split_array, index);
+        gint retval;
+
+        if (!s->parent)
+            continue;
+        if (s->parent->date_posted.tv_sec >= t_end)
+            break;
+        retval = proc (s, data);
+        if (retval)
+            return retval;
+    }
+    return 0;
 }
 
 /* ================================================================ */
@@ -5136,147 +6341,195 @@ gnc_account_imap_delete_account (GncImportMatchMap *imap,
 --------------------------------------------------------------------------*/
 
 
-struct account_token_count
+/* The import-map-bayes frame of an account, compiled into a table the
+ * first time the account is used for a Bayesian lookup.  Tokens are
+ * interned in a string chunk and the accounts they map to are numbered,
+ * so scoring a transaction is a hash probe per token plus arithmetic on
+ * an array indexed by account number.  gnc_account_imap_add_account_bayes
+ * keeps the table in step with the KVP frame, and everything else that
+ * edits the frame drops it so that it is rebuilt on the next lookup. */
+typedef struct
 {
-    char* account_guid;
-    gint64 token_count; /**< occurances of a given token for this account_guid */
-};
+    guint account;              /* index into imap_bayes_table.accounts */
+    gint64 count;
+} ImapBayesCount;
 
-/** total_count and the token_count for a given account let us calculate the
- * probability of a given account with any single token
- */
-struct token_accounts_info
+typedef struct
 {
-    GList *accounts; /**< array of struct account_token_count */
     gint64 total_count;
+    GArray *counts;             /* of ImapBayesCount */
+} ImapBayesToken;
+
+struct imap_bayes_table
+{
+    GStringChunk *strings;      /* interned tokens and account guids */
+    GHashTable *tokens;         /* token -> ImapBayesToken */
+    GPtrArray *accounts;        /* account number -> guid string */
+    GHashTable *account_ids;    /* guid string -> account number + 1 */
 };
 
-/** gpointer is a pointer to a struct token_accounts_info
- * \note Can always assume that keys are unique, reduces code in this function
- */
 static void
-buildTokenInfo(const char *key, const GValue *value, gpointer data)
+imap_bayes_token_free (ImapBayesToken *token)
 {
-    struct token_accounts_info *tokenInfo = (struct token_accounts_info*)data;
-    struct account_token_count* this_account;
-
-    //  PINFO("buildTokenInfo: account '%s', token_count: '%" G_GINT64_FORMAT "'", (char*)key,
-    //                  g_value_get_int64(value));
-
-    /* add the count to the total_count */
-    tokenInfo->total_count += g_value_get_int64(value);
-
-    /* allocate a new structure for this account and it's token count */
-    this_account = (struct account_token_count*)
-                   g_new0(struct account_token_count, 1);
-
-    /* fill in the account guid and number of tokens found for this account guid */
-    this_account->account_guid = (char*)key;
-    this_account->token_count = g_value_get_int64(value);
-
-    /* append onto the glist a pointer to the new account_token_count structure */
-    tokenInfo->accounts = g_list_prepend(tokenInfo->accounts, this_account);
+    g_array_free (token->counts, TRUE);
+    g_free (token);
 }
 
-/** intermediate values used to calculate the bayes probability of a given account
-  where p(AB) = (a*b)/[a*b + (1-a)(1-b)], product is (a*b),
-  product_difference is (1-a) * (1-b)
- */
-struct account_probability
+static void
+imap_bayes_table_free (struct imap_bayes_table *table)
 {
-    double product; /* product of probabilities */
-    double product_difference; /* product of (1-probabilities) */
-};
+    if (!table) return;
+    g_hash_table_destroy (table->tokens);
+    g_hash_table_destroy (table->account_ids);
+    g_ptr_array_free (table->accounts, TRUE);
+    g_string_chunk_free (table->strings);
+    g_free (table);
+}
 
-/** convert a hash table of account names and (struct account_probability*)
-  into a hash table of 100000x the percentage match value, ie. 10% would be
-  0.10 * 100000 = 10000
- */
-#define PROBABILITY_FACTOR 100000
+/* Drop the compiled table after an edit of the frame it was made from. */
 static void
-buildProbabilities(gpointer key, gpointer value, gpointer data)
+imap_bayes_table_invalidate (Account *acc)
 {
-    GHashTable *final_probabilities = (GHashTable*)data;
-    struct account_probability *account_p = (struct account_probability*)value;
+    AccountPrivate *priv = GET_PRIVATE(acc);
 
-    /* P(AB) = A*B / [A*B + (1-A)*(1-B)]
-     * NOTE: so we only keep track of a running product(A*B*C...)
-     * and product difference ((1-A)(1-B)...)
-     */
-    gint32 probability =
-        (account_p->product /
-         (account_p->product + account_p->product_difference))
-        * PROBABILITY_FACTOR;
-
-    PINFO("P('%s') = '%d'", (char*)key, probability);
-
-    g_hash_table_insert(final_probabilities, key, GINT_TO_POINTER(probability));
+    imap_bayes_table_free (priv->imap_bayes);
+    priv->imap_bayes = NULL;
 }
 
-/** Frees an array of the same time that buildProperties built */
 static void
-freeProbabilities(gpointer key, gpointer value, gpointer data)
+imap_bayes_table_add (struct imap_bayes_table *table, const char *token_str,
+                      const char *guid_str, gint64 count)
 {
-    /* free up the struct account_probability that was allocated
-     * in gnc_account_find_account_bayes()
-     */
-    g_free(value);
+    ImapBayesToken *token = g_hash_table_lookup (table->tokens, token_str);
+    guint account, i;
+    gpointer id;
+
+    id = g_hash_table_lookup (table->account_ids, guid_str);
+    if (id)
+        account = GPOINTER_TO_UINT (id) - 1;
+    else
+    {
+        gchar *guid = g_string_chunk_insert_const (table->strings, guid_str);
+        account = table->accounts->len;
+        g_ptr_array_add (table->accounts, guid);
+        g_hash_table_insert (table->account_ids, guid,
+                             GUINT_TO_POINTER (account + 1));
+    }
+
+    if (!token)
+    {
+        token = g_new0 (ImapBayesToken, 1);
+        token->counts = g_array_new (FALSE, FALSE, sizeof (ImapBayesCount));
+        g_hash_table_insert (table->tokens,
+                             g_string_chunk_insert_const (table->strings,
+                                                          token_str),
+                             token);
+    }
+
+    token->total_count += count;
+    for (i = 0; i < token->counts->len; i++)
+    {
+        ImapBayesCount *c = &g_array_index (token->counts, ImapBayesCount, i);
+        if (c->account == account)
+        {
+            c->count += count;
+            return;
+        }
+    }
+    {
+        ImapBayesCount c = { account, count };
+        g_array_append_val (token->counts, c);
+    }
 }
 
-/** holds an account guid and its corresponding integer probability
-  the integer probability is some factor of 10
- */
-struct account_info
+typedef struct
 {
-    char* account_guid;
-    gint32 probability;
-};
+    Account *acc;
+    struct imap_bayes_table *table;
+    gchar *token;               /* path of the frame below IMAP_FRAME_BAYES */
+} ImapBayesLoad;
 
-/** Find the highest probability and the corresponding account guid
-    store in data, a (struct account_info*)
-    NOTE: this is a g_hash_table_foreach() function for a hash table of entries
-    key is a  pointer to the account guid, value is a gint32, 100000x
-    the probability for this account
-*/
+/* Tokens containing the KVP path separator end up in nested frames, so
+ * descend into frames and treat the int64 slots found at any depth as
+ * the account counts of the token spelled by the path to them. */
 static void
-highestProbability(gpointer key, gpointer value, gpointer data)
+imap_bayes_load_slot (const char *key, const GValue *value, gpointer data)
 {
-    struct account_info *account_i = (struct account_info*)data;
+    ImapBayesLoad *load = data;
 
-    /* if the current probability is greater than the stored, store the current */
-    if (GPOINTER_TO_INT(value) > account_i->probability)
+    if (G_VALUE_HOLDS_INT64 (value))
+    {
+        if (load->token)
+            imap_bayes_table_add (load->table, load->token, key,
+                                  g_value_get_int64 (value));
+    }
+    else if (G_VALUE_HOLDS_STRING (value) && !g_value_get_string (value))
     {
-        /* Save the new highest probability and the assoaciated account guid */
-        account_i->probability = GPOINTER_TO_INT(value);
-        account_i->account_guid = key;
+        ImapBayesLoad sub = { load->acc, load->table, NULL };
+        gchar *path;
+
+        sub.token = load->token ? g_strconcat (load->token, "/", key, NULL)
+                    : g_strdup (key);
+        path = g_strconcat (IMAP_FRAME_BAYES "/", sub.token, NULL);
+        qof_instance_foreach_slot (QOF_INSTANCE (load->acc), path,
+                                   imap_bayes_load_slot, &sub);
+        g_free (path);
+        g_free (sub.token);
     }
 }
 
+static struct imap_bayes_table *
+imap_bayes_table_get (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    ImapBayesLoad load;
+
+    if (priv->imap_bayes)
+        return priv->imap_bayes;
+
+    priv->imap_bayes = g_new0 (struct imap_bayes_table, 1);
+    priv->imap_bayes->strings = g_string_chunk_new (1024);
+    priv->imap_bayes->tokens =
+        g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                               (GDestroyNotify)imap_bayes_token_free);
+    priv->imap_bayes->accounts = g_ptr_array_new ();
+    priv->imap_bayes->account_ids = g_hash_table_new (g_str_hash, g_str_equal);
 
+    load.acc = acc;
+    load.table = priv->imap_bayes;
+    load.token = NULL;
+    qof_instance_foreach_slot (QOF_INSTANCE (acc), IMAP_FRAME_BAYES,
+                               imap_bayes_load_slot, &load);
+    return priv->imap_bayes;
+}
+
+/** intermediate values used to calculate the bayes probability of a given account
+  where p(AB) = (a*b)/[a*b + (1-a)(1-b)], product is (a*b),
+  product_difference is (1-a) * (1-b)
+ */
+struct account_probability
+{
+    gboolean seen;
+    double product; /* product of probabilities */
+    double product_difference; /* product of (1-probabilities) */
+};
+
+/** the probabilities are kept as 100000x the percentage match value,
+  ie. 10% would be 0.10 * 100000 = 10000
+ */
+#define PROBABILITY_FACTOR 100000
 #define threshold (.90 * PROBABILITY_FACTOR) /* 90% */
 
 /** Look up an Account in the map */
 Account*
 gnc_account_imap_find_account_bayes (GncImportMatchMap *imap, GList *tokens)
 {
-    struct token_accounts_info tokenInfo; /**< holds the accounts and total
-                                           * token count for a single token */
-    GList *current_token;                 /**< pointer to the current
-                                           * token from the input GList
-                                           * tokens */
-    GList *current_account_token;         /**< pointer to the struct
-                                           * account_token_count */
-    struct account_token_count *account_c; /**< an account name and the number
-                                            * of times a token has appeared
-                                            * for the account */
-    struct account_probability *account_p; /**< intermediate storage of values
-                                            * to compute the bayes probability
-                                            * of an account */
-    GHashTable *running_probabilities = g_hash_table_new(g_str_hash,
-                                                         g_str_equal);
-    GHashTable *final_probabilities = g_hash_table_new(g_str_hash,
-                                                       g_str_equal);
-    struct account_info account_i;
+    struct imap_bayes_table *table;
+    struct account_probability *probabilities;
+    GList *current_token;
+    const char *best_guid = NULL;
+    gint32 best_probability = 0;
+    guint i;
 
     ENTER(" ");
 
@@ -5288,135 +6541,88 @@ gnc_account_imap_find_account_bayes (GncImportMatchMap *imap, GList *tokens)
         return NULL;
     }
 
+    table = imap_bayes_table_get (imap->acc);
+    probabilities = g_new0 (struct account_probability,
+                            table->accounts->len ? table->accounts->len : 1);
+
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list
      */
     for (current_token = tokens; current_token;
          current_token = current_token->next)
     {
-        char* path = g_strdup_printf (IMAP_FRAME_BAYES "/%s",
-                                            (char*)current_token->data);
-        /* zero out the token_accounts_info structure */
-        memset(&tokenInfo, 0, sizeof(struct token_accounts_info));
+        ImapBayesToken *token;
 
         PINFO("token: '%s'", (char*)current_token->data);
 
-        /* process the accounts for this token, adding the account if it
-         * doesn't already exist or adding to the existing accounts token
-         * count if it does
-         */
-        qof_instance_foreach_slot(QOF_INSTANCE (imap->acc), path,
-                                  buildTokenInfo, &tokenInfo);
-        g_free (path);
-        /* for each account we have just found, see if the account
-         * already exists in the list of account probabilities, if not
-         * add it
-         */
-        for (current_account_token = tokenInfo.accounts; current_account_token;
-                current_account_token = current_account_token->next)
-        {
-            /* get the account name and corresponding token count */
-            account_c = (struct account_token_count*)current_account_token->data;
-
-            PINFO("account_c->account_guid('%s'), "
-                  "account_c->token_count('%" G_GINT64_FORMAT
-                  "')/total_count('%" G_GINT64_FORMAT "')",
-                  account_c->account_guid, account_c->token_count,
-                  tokenInfo.total_count);
+        if (!current_token->data)
+            continue;
+        token = g_hash_table_lookup (table->tokens, current_token->data);
+        if (!token)
+            continue;
 
-            account_p = g_hash_table_lookup(running_probabilities,
-                                            account_c->account_guid);
+        for (i = 0; i < token->counts->len; i++)
+        {
+            ImapBayesCount *c = &g_array_index (token->counts,
+                                                ImapBayesCount, i);
+            struct account_probability *account_p = &probabilities[c->account];
+            double p = (double)c->count / (double)token->total_count;
 
-            /* if the account exists in the list then continue
-             * the running probablities
-             */
-            if (account_p)
+            if (account_p->seen)
             {
-                account_p->product = (((double)account_c->token_count /
-                                      (double)tokenInfo.total_count)
-                                      * account_p->product);
-                account_p->product_difference =
-                    ((double)1 - ((double)account_c->token_count /
-                                  (double)tokenInfo.total_count))
-                    * account_p->product_difference;
-                PINFO("product == %f, product_difference == %f",
-                      account_p->product, account_p->product_difference);
+                account_p->product *= p;
+                account_p->product_difference *= (double)1 - p;
             }
             else
             {
-                /* add a new entry */
-                PINFO("adding a new entry for this account");
-                account_p = (struct account_probability*)
-                            g_new0(struct account_probability, 1);
-
-                /* set the product and product difference values */
-                account_p->product = ((double)account_c->token_count /
-                                      (double)tokenInfo.total_count);
-                account_p->product_difference =
-                    (double)1 - ((double)account_c->token_count /
-                                 (double)tokenInfo.total_count);
-
-                PINFO("product == %f, product_difference == %f",
-                      account_p->product, account_p->product_difference);
-
-                /* add the account guid and (struct account_probability*)
-                 * to the hash table */
-                g_hash_table_insert(running_probabilities,
-                                    account_c->account_guid, account_p);
+                account_p->seen = TRUE;
+                account_p->product = p;
+                account_p->product_difference = (double)1 - p;
             }
-        } /* for all accounts in tokenInfo */
-
-        /* free the data in tokenInfo */
-        for (current_account_token = tokenInfo.accounts; current_account_token;
-                current_account_token = current_account_token->next)
-        {
-            /* free up each struct account_token_count we allocated */
-            g_free((struct account_token_count*)current_account_token->data);
+            PINFO("product == %f, product_difference == %f",
+                  account_p->product, account_p->product_difference);
         }
-
-        g_list_free(tokenInfo.accounts); /* free the accounts GList */
     }
 
-    /* build a hash table of account names and their final probabilities
-     * from each entry in the running_probabilties hash table
-     */
-    g_hash_table_foreach(running_probabilities, buildProbabilities,
-                         final_probabilities);
-
-    /* find the highest probabilty and the corresponding account */
-    memset(&account_i, 0, sizeof(struct account_info));
-    g_hash_table_foreach(final_probabilities, highestProbability, &account_i);
-
-    /* free each element of the running_probabilities hash */
-    g_hash_table_foreach(running_probabilities, freeProbabilities, NULL);
+    /* P(AB) = A*B / [A*B + (1-A)*(1-B)]; find the highest one. */
+    for (i = 0; i < table->accounts->len; i++)
+    {
+        struct account_probability *account_p = &probabilities[i];
+        gint32 probability;
 
-    /* free the hash tables */
-    g_hash_table_destroy(running_probabilities);
-    g_hash_table_destroy(final_probabilities);
+        if (!account_p->seen)
+            continue;
+        probability = (account_p->product /
+                       (account_p->product + account_p->product_difference))
+                      * PROBABILITY_FACTOR;
+        PINFO("P('%s') = '%d'", (char*)g_ptr_array_index (table->accounts, i),
+              probability);
+        if (probability > best_probability)
+        {
+            best_probability = probability;
+            best_guid = g_ptr_array_index (table->accounts, i);
+        }
+    }
+    g_free (probabilities);
 
-    PINFO("highest P('%s') = '%d'",
-          account_i.account_guid ? account_i.account_guid : "(null)",
-          account_i.probability);
+    PINFO("highest P('%s') = '%d'", best_guid ? best_guid : "(null)",
+          best_probability);
 
     /* has this probability met our threshold? */
-    if (account_i.probability >= threshold)
+    if (best_probability >= threshold)
     {
-        GncGUID *guid;
+        GncGUID guid;
         Account *account = NULL;
 
         PINFO("Probability has met threshold");
 
-        guid = g_new (GncGUID, 1);
-
-        if (string_to_guid (account_i.account_guid, guid))
-            account = xaccAccountLookup (guid, imap->book);
-
-        g_free (guid);
+        if (string_to_guid (best_guid, &guid))
+            account = xaccAccountLookup (&guid, imap->book);
 
         if (account != NULL)
             LEAVE("Return account is '%s'", xaccAccountGetName (account));
         else
-            LEAVE("Return NULL, account for Guid '%s' can not be found", account_i.account_guid);
+            LEAVE("Return NULL, account for Guid '%s' can not be found", best_guid);
 
         return account;
     }
@@ -5515,6 +6721,10 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
 
         /* change the imap entry for the account */
         change_imap_entry (imap, kvp_path, token_count);
+        if (GET_PRIVATE(imap->acc)->imap_bayes)
+            imap_bayes_table_add (GET_PRIVATE(imap->acc)->imap_bayes,
+                                  current_token->data, guid_string,
+                                  token_count);
 
         g_free (kvp_path);
     }
@@ -5742,6 +6952,8 @@ gnc_account_delete_map_entry (Account *acc, char *full_category, gboolean empty)
 
         PINFO("Account is '%s', path is '%s'", xaccAccountGetName (acc), kvp_path);
 
+        imap_bayes_table_invalidate (acc);
+
         qof_instance_set_dirty (QOF_INSTANCE(acc));
         xaccAccountCommitEdit (acc);
     }
@@ -5829,6 +7041,7 @@ convert_imap_entry (GncImapInfo *imapInfo, Account *map_account)
 
     // change the imap entry of source_account
     change_imap_entry (imap, kvp_path, token_count);
+    imap_bayes_table_invalidate (imapInfo->source_account);
 
     qof_instance_set_dirty (QOF_INSTANCE (imapInfo->source_account));
     xaccAccountCommitEdit (imapInfo->source_account);
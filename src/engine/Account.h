@@ -408,6 +408,21 @@ void xaccAccountRecomputeBalance (Account *);
  */
 void xaccAccountSortSplits (Account *acc, gboolean force);
 
+/** Start a bulk ingest on @a book, e.g. for an import.  Until the
+ *  matching gnc_account_end_bulk_ingest(), splits inserted into the
+ *  book's accounts are appended unsorted, inserting and removing
+ *  splits doesn't generate events, and committing an account edit
+ *  doesn't sort or recompute it.
+ *  Ingests may be nested.
+ */
+void gnc_account_begin_bulk_ingest (QofBook *book);
+/** End a bulk ingest.  When the outermost ingest ends, every account
+ *  that received splits is sorted and has its balances recomputed
+ *  once, and gets a single QOF_EVENT_MODIFY in place of the per-split
+ *  events.
+ */
+void gnc_account_end_bulk_ingest (QofBook *book);
+
 /** The gnc_account_get_full_name routine returns the fully qualified name
  * of the account using the given separator char. The name must be
  * g_free'd after use. The fully qualified name of an account is the
@@ -423,6 +438,14 @@ void xaccAccountSortSplits (Account *acc, gboolean force);
  */
 gchar * gnc_account_get_full_name (const Account *account);
 
+/** Returns the same fully qualified name as gnc_account_get_full_name(),
+ * without copying it.  The string belongs to the account and is only
+ * valid until the account or one of its ancestors is renamed or moved,
+ * or the account separator changes; the caller must not free it.  Code
+ * that walks many accounts, sorting or matching them by full name,
+ * should use this. */
+const char * xaccAccountGetFullName (const Account *account);
+
 /** Retrieve the gains account used by this account for the indicated
  * currency, creating and recording a new one if necessary.
  *
@@ -547,9 +570,16 @@ gnc_numeric xaccAccountGetClearedBalance (const Account *account);
 gnc_numeric xaccAccountGetReconciledBalance (const Account *account);
 gnc_numeric xaccAccountGetPresentBalance (const Account *account);
 gnc_numeric xaccAccountGetProjectedMinimumBalance (const Account *account);
-/** Get the balance of the account as of the date specified */
+/** Get the balance of the account as of the date specified.  When the
+    book's backend doesn't keep every split in memory, it's summed by
+    the backend. */
 gnc_numeric xaccAccountGetBalanceAsOfDate (Account *account,
         time64 date);
+/** Get the last split of the account, in the account's sort order,
+    whose transaction was posted on or before the date specified, or
+    NULL if there is none.  Its xaccSplitGetBalance() is the balance of
+    the account at the end of that date. */
+Split * xaccAccountFindLastSplitAtDate (Account *account, time64 date);
 
 /* These two functions convert a given balance from one commodity to
    another.  The account argument is only used to get the Book, and
@@ -597,6 +627,43 @@ gnc_numeric xaccAccountGetBalanceAsOfDateInCurrency(
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** The xaccAccountGetBalanceChangeForPeriod of each of n_periods
+ *  periods, from starts[i] to ends[i], computed with one pass over the
+ *  splits of the account (and its descendants if recurse is TRUE).
+ *  @return A newly allocated array of n_periods values; g_free it. */
+gnc_numeric *xaccAccountGetBalanceChangesForPeriods (
+    Account *acc, const time64 *starts, const time64 *ends,
+    guint n_periods, gboolean recurse);
+
+/** A matrix of account balances at several dates, for reports that
+ *  need many as-of-date balances.  Building it makes one pass over
+ *  each account's splits instead of one search per account and date.
+ *  The balances are those xaccAccountGetBalanceAsOfDate would return,
+ *  i.e. of the splits posted strictly before each date, in the
+ *  account's own commodity. */
+typedef struct gnc_balance_snapshot_s GncBalanceSnapshot;
+
+/** Take a snapshot of the balances of the accounts in the list (in list
+ *  order) at each of the n_dates dates, which needn't be sorted. */
+GncBalanceSnapshot *gnc_balance_snapshot_new (GList *accounts,
+        const time64 *dates, guint n_dates);
+void gnc_balance_snapshot_free (GncBalanceSnapshot *snapshot);
+
+guint gnc_balance_snapshot_get_n_accounts (const GncBalanceSnapshot *snapshot);
+guint gnc_balance_snapshot_get_n_dates (const GncBalanceSnapshot *snapshot);
+
+/** Balance of the account_index'th account at the date_index'th date. */
+gnc_numeric gnc_balance_snapshot_get_balance (
+    const GncBalanceSnapshot *snapshot, guint account_index, guint date_index);
+/** As gnc_balance_snapshot_get_balance, counting only cleared (and
+ *  reconciled) splits. */
+gnc_numeric gnc_balance_snapshot_get_cleared_balance (
+    const GncBalanceSnapshot *snapshot, guint account_index, guint date_index);
+/** As gnc_balance_snapshot_get_balance, counting only reconciled
+ *  splits. */
+gnc_numeric gnc_balance_snapshot_get_reconciled_balance (
+    const GncBalanceSnapshot *snapshot, guint account_index, guint date_index);
+
 /** @} */
 
 /** @name Account Children and Parents.
@@ -1020,6 +1087,9 @@ void xaccAccountMoveAllSplits (Account *accfrom, Account *accto);
  * every relevant transaction was traversed exactly once.
  * Else the return value is the last non-zero value returned by proc.
  *
+ * The traversal doesn't use the transactions' markers, so @a proc may
+ * itself start another traversal.
+ *
  * \warning For performance reasons, the transaction callback @a proc
  * must never destroy any of the transaction's splits, nor assign any
  * of them to a different account. <b>To do so risks a crash.</b>
@@ -1036,6 +1106,21 @@ gint xaccAccountForEachTransaction(const Account *account,
                                    TransactionCallback proc,
                                    void *data);
 
+/** The xaccAccountForEachSplitInRange() routine calls @a proc on each
+ * split in @a account whose transaction was posted at or after @a
+ * t_start and before @a t_end, in the account's sort order.
+ * Processing will continue if-and-only-if @a proc returns 0; the
+ * non-zero value is returned.
+ *
+ * Unlike xaccAccountGetSplitList() followed by a copy, or
+ * xaccAccountForEachTransaction(), this needs no list copy and doesn't
+ * touch the transactions' traversal markers.  @a proc must not add or
+ * remove splits in @a account.
+ */
+gint xaccAccountForEachSplitInRange (Account *account,
+                                     time64 t_start, time64 t_end,
+                                     SplitCallback proc, gpointer data);
+
 /** Returns a pointer to the transaction, not a copy. */
 Transaction * xaccAccountFindTransByDesc(const Account *account,
         const char *description);
@@ -1082,7 +1167,8 @@ gpointer xaccAccountForEachLot(
 
 /** Find a list of open lots that match the match_func.  Sort according
  * to sort_func.  If match_func is NULL, then all open lots are returned.
- * If sort_func is NULL, then the returned list has no particular order.
+ * If sort_func is NULL, then the returned list is in the reverse order
+ * of the account's lot list.
  * The caller must free to returned list.
  */
 LotList * xaccAccountFindOpenLots (const Account *acc,
@@ -1357,6 +1443,9 @@ int gnc_account_tree_staged_transaction_traversal(const Account *account,
  * transaction was traversed exactly once; otherwise, the return
  * value is the last non-zero value returned by the callback.
  *
+ * The traversal doesn't use the transactions' markers, so @a proc may
+ * itself start another traversal.
+ *
  * \warning For performance reasons, the transaction callback @a proc
  * must never destroy any of the transaction's splits, nor assign any
  * of them to a different account. <b>To do so risks a crash.</b>
@@ -98,6 +98,20 @@ typedef struct AccountPrivate
     Account *parent;    /* back-pointer to parent */
     GList *children;    /* list of sub-accounts */
 
+    /* Cached result of gnc_account_get_full_name().  It is cleared for
+     * the whole subtree when this account or an ancestor is renamed or
+     * moved, and is ignored once the account separator changes. */
+    gchar *full_name;
+    guint full_name_generation;
+
+    /* Lookup indexes for gnc_account_lookup_by_full_name() and
+     * gnc_account_lookup_by_code(), only kept on the top account of a
+     * tree.  They are built on first use and dropped whenever an
+     * account in the tree is renamed, recoded or moved. */
+    GHashTable *full_name_index;    /* full name -> Account* */
+    guint full_name_index_generation;
+    GHashTable *code_index;         /* code -> Account* */
+
     /* protected data - should only be set by backends */
     gnc_numeric starting_balance;
     gnc_numeric starting_cleared_balance;
@@ -109,13 +123,33 @@ typedef struct AccountPrivate
     gnc_numeric reconciled_balance;
 
     gboolean balance_dirty;     /* balances in splits incorrect */
-
+    /* When balance_dirty is set, the running balances of the splits
+     * before this index in split_array are still correct and
+     * xaccAccountRecomputeBalance() only has to redo the rest. */
+    guint balance_dirty_from;
+
+    /* The splits are kept in three synchronized structures: 'splits'
+     * is the GList handed out by xaccAccountGetSplitList() and walked
+     * by the older code, 'split_array' holds the same pointers in
+     * sorted, contiguous order so that positions can be found with a
+     * binary search, and 'split_nodes' maps each split to its node in
+     * 'splits' so membership tests and unlinking don't need a scan.
+     */
     GList *splits;              /* list of split pointers */
+    GPtrArray *split_array;     /* sorted array of split pointers */
+    GHashTable *split_nodes;    /* Split* -> GList node in splits */
     gboolean sort_dirty;        /* sort order of splits is bad */
 
     LotList   *lots;		/* list of lot pointers */
+    /* The lots in 'lots' not known to be closed, so open-lot searches
+     * needn't walk the closed ones.  gnc-lot.c reports transitions. */
+    GHashTable *open_lots;
     GNCPolicy *policy;		/* Cached pointer to policy method */
 
+    /* Compiled copy of the import-map-bayes slots, made on the first
+     * Bayesian lookup in this account's import map. */
+    struct imap_bayes_table *imap_bayes;
+
     /* The "mark" flag can be used by the user to mark this account
      * in any way desired.  Handy for specialty traversals of the
      * account tree. */
@@ -132,6 +166,28 @@ struct account_s
  * call this on an existing account! */
 void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 
+/* Mark the account's balances dirty starting from the position of the
+ * given split, so that the next xaccAccountRecomputeBalance() can
+ * leave the running balances of the earlier splits alone.  Use this
+ * instead of gnc_account_set_balance_dirty() when the change is known
+ * to be confined to one split. */
+void gnc_account_set_balance_dirty_at (Account *acc, const Split *split);
+
+/* Record that a lot in the account became closed, or may have reopened;
+ * called by gnc-lot.c whenever its cached closed state changes. */
+void gnc_account_set_lot_closed (Account *acc, GNCLot *lot, gboolean closed);
+
+/* Like xaccAccountForEachLot(), but only over the lots not known to be
+ * closed, in the same order.  proc may change the lots' state. */
+gpointer gnc_account_foreach_open_lot (const Account *acc,
+                                       gpointer (*proc)(GNCLot *lot, gpointer data),
+                                       gpointer data);
+
+/* Append to usage, a list of QofMemoryUsage, the estimated memory of
+ * the lists, arrays and hash tables private to the accounts of the tree
+ * under root, root included.  Returns the new list head. */
+GList *gnc_account_tree_get_memory_usage (Account *root, GList *usage);
+
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
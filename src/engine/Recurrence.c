@@ -164,6 +164,90 @@ nth_weekday_compare(const GDate *start, const GDate *next, PeriodType pt)
 }
 
 
+/* Step 2 of recurrenceNextInstance(), also used to jump straight to
+   the Nth instance: 'next' is somewhere in or after the period holding
+   the wanted occurrence; move it back onto that occurrence. */
+static void
+recurrence_align_to_phase(const Recurrence *r, GDate *next)
+{
+    PeriodType pt = r->ptype;
+    const GDate *start = &r->start;
+    guint mult = r->mult;
+    WeekendAdjust wadj = r->wadj;
+
+    if (pt == PERIOD_YEAR)
+        mult *= 12;
+    else if (pt == PERIOD_WEEK)
+        mult *= 7;
+
+    /* To ensure forward progress, we never subtract as much as Step 1
+       added (x % mult < mult). */
+    switch (pt)
+    {
+    case PERIOD_YEAR:
+    case PERIOD_MONTH:
+    case PERIOD_NTH_WEEKDAY:
+    case PERIOD_LAST_WEEKDAY:
+    case PERIOD_END_OF_MONTH:
+    {
+        guint dim, n_months;
+
+        n_months = 12 * (g_date_get_year(next) - g_date_get_year(start)) +
+                   (g_date_get_month(next) - g_date_get_month(start));
+        g_date_subtract_months(next, n_months % mult);
+
+        /* Ok, now we're in the right month, so we just have to align
+           the day in one of the three possible ways. */
+        dim = g_date_get_days_in_month(g_date_get_month(next),
+                                       g_date_get_year(next));
+        if (pt == PERIOD_LAST_WEEKDAY || pt == PERIOD_NTH_WEEKDAY)
+        {
+            gint wdresult = nth_weekday_compare(start, next, pt);
+            if (wdresult < 0)
+            {
+                wdresult = -wdresult;
+                g_date_subtract_days(next, wdresult);
+            }
+            else
+                g_date_add_days(next, wdresult);
+        }
+        else if (pt == PERIOD_END_OF_MONTH || g_date_get_day(start) >= dim)
+            g_date_set_day(next, dim);  /* last day in the month */
+        else
+            g_date_set_day(next, g_date_get_day(start)); /*same day as start*/
+
+        /* Adjust for dates on the weekend. */
+        if (pt == PERIOD_YEAR || pt == PERIOD_MONTH || pt == PERIOD_END_OF_MONTH)
+        {
+            if (g_date_get_weekday(next) == G_DATE_SATURDAY || g_date_get_weekday(next) == G_DATE_SUNDAY)
+            {
+                switch (wadj)
+                {
+                case WEEKEND_ADJ_BACK:
+                    g_date_subtract_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 1 : 2);
+                    break;
+                case WEEKEND_ADJ_FORWARD:
+                    g_date_add_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 2 : 1);
+                    break;
+                case WEEKEND_ADJ_NONE:
+                default:
+                    break;
+                }
+            }
+        }
+
+    }
+    break;
+    case PERIOD_WEEK:
+    case PERIOD_DAY:
+        g_date_subtract_days(next, g_date_days_between(start, next) % mult);
+        break;
+    default:
+        PERR("Invalid period type");
+        break;
+    }
+}
+
 /* This is the only real algorithm related to recurrences.  It goes:
    Step 1) Go forward one period from the reference date.
    Step 2) Back up to align to the phase of the start date.
@@ -174,7 +258,6 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     PeriodType pt;
     const GDate *start;
     guint mult;
-    WeekendAdjust wadj;
 
     g_return_if_fail(r);
     g_return_if_fail(ref);
@@ -194,7 +277,6 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     /* Step 1: move FORWARD one period, passing exactly one occurrence. */
     mult = r->mult;
     pt = r->ptype;
-    wadj = r->wadj;
     switch (pt)
     {
     case PERIOD_YEAR:
@@ -295,86 +377,52 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
         break;
     }
 
-    /* Step 2: Back up to align to the base phase. To ensure forward
-       progress, we never subtract as much as we added (x % mult < mult). */
-    switch (pt)
+    /* Step 2: Back up to align to the base phase. */
+    recurrence_align_to_phase(r, next);
+}
+
+/* Zero-based index.  Rather than stepping n times, jump to the period
+   holding the nth occurrence and align to it as Step 2 would. */
+void
+recurrenceNthInstance(const Recurrence *r, guint n, GDate *date)
+{
+    g_return_if_fail(r);
+    g_return_if_fail(date);
+
+    *date = r->start;
+    if (n == 0)
+        return;
+
+    switch (r->ptype)
     {
+    case PERIOD_ONCE:
+        g_date_clear(date, 1);
+        return;
+    case PERIOD_DAY:
+        g_date_add_days(date, n * r->mult);
+        return;
+    case PERIOD_WEEK:
+        g_date_add_days(date, n * r->mult * 7);
+        return;
     case PERIOD_YEAR:
+        g_date_add_months(date, n * r->mult * 12);
+        break;
+    case PERIOD_END_OF_MONTH:
+        /* A start short of the month's end still has that month's end
+           as its first instance after the start. */
+        if (!g_date_is_last_of_month(&r->start))
+            n--;
+        /* fall through */
     case PERIOD_MONTH:
     case PERIOD_NTH_WEEKDAY:
     case PERIOD_LAST_WEEKDAY:
-    case PERIOD_END_OF_MONTH:
-    {
-        guint dim, n_months;
-
-        n_months = 12 * (g_date_get_year(next) - g_date_get_year(start)) +
-                   (g_date_get_month(next) - g_date_get_month(start));
-        g_date_subtract_months(next, n_months % mult);
-
-        /* Ok, now we're in the right month, so we just have to align
-           the day in one of the three possible ways. */
-        dim = g_date_get_days_in_month(g_date_get_month(next),
-                                       g_date_get_year(next));
-        if (pt == PERIOD_LAST_WEEKDAY || pt == PERIOD_NTH_WEEKDAY)
-        {
-            gint wdresult = nth_weekday_compare(start, next, pt);
-            if (wdresult < 0)
-            {
-                wdresult = -wdresult;
-                g_date_subtract_days(next, wdresult);
-            }
-            else
-                g_date_add_days(next, wdresult);
-        }
-        else if (pt == PERIOD_END_OF_MONTH || g_date_get_day(start) >= dim)
-            g_date_set_day(next, dim);  /* last day in the month */
-        else
-            g_date_set_day(next, g_date_get_day(start)); /*same day as start*/
-
-        /* Adjust for dates on the weekend. */
-        if (pt == PERIOD_YEAR || pt == PERIOD_MONTH || pt == PERIOD_END_OF_MONTH)
-        {
-            if (g_date_get_weekday(next) == G_DATE_SATURDAY || g_date_get_weekday(next) == G_DATE_SUNDAY)
-            {
-                switch (wadj)
-                {
-                case WEEKEND_ADJ_BACK:
-                    g_date_subtract_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 1 : 2);
-                    break;
-                case WEEKEND_ADJ_FORWARD:
-                    g_date_add_days(next, g_date_get_weekday(next) == G_DATE_SATURDAY ? 2 : 1);
-                    break;
-                case WEEKEND_ADJ_NONE:
-                default:
-                    break;
-                }
-            }
-        }
-
-    }
-    break;
-    case PERIOD_WEEK:
-    case PERIOD_DAY:
-        g_date_subtract_days(next, g_date_days_between(start, next) % mult);
+        g_date_add_months(date, n * r->mult);
         break;
     default:
         PERR("Invalid period type");
-        break;
-    }
-}
-
-/* Zero-based index */
-void
-recurrenceNthInstance(const Recurrence *r, guint n, GDate *date)
-{
-    GDate ref;
-    guint i;
-
-    for (*date = ref = r->start, i = 0; i < n; i++)
-    {
-        recurrenceNextInstance(r, &ref, date);
-        ref = *date;
+        return;
     }
+    recurrence_align_to_phase(r, date);
 }
 
 time64
@@ -435,6 +483,43 @@ recurrenceListNextInstance(const GList *rlist, const GDate *ref, GDate *next)
     }
 }
 
+GArray *
+recurrenceListInstancesInRange(const GList *rlist, const GDate *range_start,
+                               const GDate *range_end)
+{
+    GArray *dates = g_array_new(FALSE, FALSE, sizeof(GDate));
+    GDate ref, next;
+
+    g_return_val_if_fail(range_start && g_date_valid(range_start), dates);
+    g_return_val_if_fail(range_end && g_date_valid(range_end), dates);
+
+    /* Each recurrence jumps straight to its first date after ref, so
+       only the dates actually in the range are visited. */
+    ref = *range_start;
+    if (g_date_get_julian(&ref) > 1)
+        g_date_subtract_days(&ref, 1);
+    else
+    {
+        /* Nothing comes before day one; take it if it occurs. */
+        const GList *iter;
+        for (iter = rlist; iter; iter = iter->next)
+            if (g_date_compare(&((Recurrence*)iter->data)->start, &ref) == 0)
+            {
+                g_array_append_val(dates, ref);
+                break;
+            }
+    }
+
+    for (recurrenceListNextInstance(rlist, &ref, &next);
+            g_date_valid(&next) && g_date_compare(&next, range_end) <= 0;
+            recurrenceListNextInstance(rlist, &ref, &next))
+    {
+        g_array_append_val(dates, next);
+        ref = next;
+    }
+    return dates;
+}
+
 /* Caller owns the returned memory */
 gchar *
 recurrenceToString(const Recurrence *r)
@@ -130,7 +130,8 @@ WeekendAdjust recurrenceGetWeekendAdjust(const Recurrence *r);
 void recurrenceNextInstance(const Recurrence *r, const GDate *refDate,
                             GDate *nextDate);
 
-/* Zero-based.  n == 1 gets the instance after the start date. */
+/* Zero-based.  n == 1 gets the instance after the start date.
+   Computed directly, without stepping through the earlier instances. */
 void recurrenceNthInstance(const Recurrence *r, guint n, GDate *date);
 
 /* Get a time coresponding to the beginning (or end if 'end' is true)
@@ -148,6 +149,13 @@ gnc_numeric recurrenceGetAccountPeriodValue(const Recurrence *r,
 void recurrenceListNextInstance(const GList *r, const GDate *refDate,
                                 GDate *nextDate);
 
+/** @return a GArray of the GDates, in order, on which any of the
+ * recurrences in the list occurs between range_start and range_end,
+ * inclusive.  Free it with g_array_free(array, TRUE). **/
+GArray *recurrenceListInstancesInRange(const GList *r,
+                                       const GDate *range_start,
+                                       const GDate *range_end);
+
 /* These four functions are only for xml storage, not user presentation. */
 gchar *recurrencePeriodTypeToString(PeriodType pt);
 PeriodType recurrencePeriodTypeFromString(const gchar *str);
@@ -79,6 +79,7 @@ gnc_schedxaction_init(SchedXaction* sx)
     sx->advanceRemindDays = 0;
     sx->instance_num = 0;
     sx->deferredList = NULL;
+    sx->occurrence_cache = NULL;
 }
 
 static void
@@ -90,6 +91,10 @@ gnc_schedxaction_dispose(GObject *sxp)
 static void
 gnc_schedxaction_finalize(GObject* sxp)
 {
+    SchedXaction *sx = GNC_SX(sxp);
+
+    if (sx->occurrence_cache)
+        g_array_free(sx->occurrence_cache, TRUE);
     G_OBJECT_CLASS(gnc_schedxaction_parent_class)->finalize(sxp);
 }
 
@@ -567,6 +572,8 @@ gnc_sx_set_schedule(SchedXaction *sx, GList *schedule)
     g_return_if_fail(sx);
     gnc_sx_begin_edit(sx);
     sx->schedule = schedule;
+    if (sx->occurrence_cache)
+        g_array_set_size(sx->occurrence_cache, 0);
     qof_instance_set_dirty(&sx->inst);
     gnc_sx_commit_edit(sx);
 }
@@ -870,6 +877,56 @@ xaccSchedXactionSetAdvanceReminder( SchedXaction *sx, gint reminderDays )
     gnc_sx_commit_edit(sx);
 }
 
+/* Stepping a schedule one occurrence at a time from the last one is
+ * what the since-last-run and calendar code do over and over, so keep
+ * the chain of occurrences seen so far, up to a bounded horizon.  The
+ * successor of a date depends only on the schedule, so an answer for a
+ * date already in the chain is just the next element. */
+#define SX_OCCURRENCE_CACHE_MAX 1024
+
+static void
+sx_next_occurrence (SchedXaction *sx, const GDate *prev, GDate *next)
+{
+    GArray *cache = sx->occurrence_cache;
+    guint lo = 0, hi = 0;
+    gboolean found = FALSE;
+
+    if (cache && g_date_valid (prev))
+    {
+        hi = cache->len;
+        while (lo < hi)
+        {
+            guint mid = (lo + hi) / 2;
+            if (g_date_compare (&g_array_index (cache, GDate, mid), prev) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        found = (lo < cache->len &&
+                 g_date_compare (&g_array_index (cache, GDate, lo), prev) == 0);
+        if (found && lo + 1 < cache->len)
+        {
+            *next = g_array_index (cache, GDate, lo + 1);
+            return;
+        }
+    }
+
+    recurrenceListNextInstance (sx->schedule, prev, next);
+    if (!g_date_valid (prev) || !g_date_valid (next))
+        return;
+
+    if (!cache)
+        cache = sx->occurrence_cache = g_array_new (FALSE, FALSE, sizeof (GDate));
+    if (!found)
+    {
+        /* Start a new chain from here. */
+        g_array_set_size (cache, 0);
+        g_array_append_val (cache, *prev);
+    }
+    if (cache->len < SX_OCCURRENCE_CACHE_MAX)
+        g_array_append_val (cache, *next);
+}
+
 GDate
 xaccSchedXactionGetNextInstance (const SchedXaction *sx, SXTmpStateData *tsd)
 {
@@ -892,7 +949,7 @@ xaccSchedXactionGetNextInstance (const SchedXaction *sx, SXTmpStateData *tsd)
         g_date_subtract_days( &prev_occur, 1 );
     }
 
-    recurrenceListNextInstance(sx->schedule, &prev_occur, &next_occur);
+    sx_next_occurrence((SchedXaction *)sx, &prev_occur, &next_occur);
 
     if ( xaccSchedXactionHasEndDate( sx ) )
     {
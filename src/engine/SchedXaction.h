@@ -116,6 +116,11 @@ struct _SchedXaction
     /** The list of deferred SX instances.  This list is of SXTmpStateData
      * instances.  */
     GList /* <SXTmpStateData*> */ *deferredList;
+
+    /** Private: a run of consecutive schedule occurrences (GDates), each
+     * the successor of the one before, remembered by
+     * xaccSchedXactionGetNextInstance() until the schedule changes. */
+    GArray          *occurrence_cache;
 };
 
 struct _SchedXactionClass
@@ -1240,6 +1240,47 @@ xaccAccountTreeScrubCommodities (Account *acc)
     gnc_account_foreach_descendant (acc, scrub_account_commodity_helper, NULL);
 }
 
+void
+xaccAccountTreeScrubCommoditiesAndSplits (Account *acc)
+{
+    GList *accounts, *node, *snode;
+
+    if (!acc) return;
+
+    accounts = gnc_account_get_descendants (acc);
+    accounts = g_list_prepend (accounts, acc);
+
+    /* Account commodities first; transaction currencies and split
+     * amounts are derived from them. */
+    for (node = accounts; node; node = node->next)
+        xaccAccountScrubCommodity (node->data);
+
+    /* One walk over the splits: a transaction's currency is fixed when
+     * the first of its splits is reached, before any of them is
+     * scrubbed. */
+    gnc_account_tree_begin_staged_transaction_traversals (acc);
+    for (node = accounts; node; node = node->next)
+    {
+        for (snode = xaccAccountGetSplitList (node->data); snode;
+                snode = snode->next)
+        {
+            Split *split = snode->data;
+            Transaction *trans = xaccSplitGetParent (split);
+
+            if (trans && xaccTransactionTraverse (trans, 1))
+                xaccTransScrubCurrency (trans);
+            xaccSplitScrub (split);
+        }
+    }
+
+    /* The old currency fields are only dropped once every transaction
+     * that might have needed them as a fallback has been seen. */
+    for (node = accounts; node; node = node->next)
+        xaccAccountDeleteOldData (node->data);
+
+    g_list_free (accounts);
+}
+
 /* ================================================================ */
 
 static gboolean
@@ -127,6 +127,16 @@ void xaccAccountScrubCommodity (Account *account);
  * account or any child account. */
 void xaccAccountTreeScrubCommodities (Account *acc);
 
+/** Does the work of xaccAccountTreeScrubCommodities() followed by
+ * xaccAccountTreeScrubSplits(), but visits each split only once, so
+ * not in the same order: the account commodities are fixed first, then
+ * each transaction's currency as the walk reaches its first split,
+ * before any of its splits is scrubbed.  The old commodity fields of
+ * the accounts are deleted at the end, after every transaction could
+ * fall back on them.  xaccAccountTreeScrubCommodities() instead fixes
+ * the transaction currencies before the account commodities. */
+void xaccAccountTreeScrubCommoditiesAndSplits (Account *acc);
+
 /** This routine will migrate the information about price quote
  *  sources from the account data structures to the commodity data
  *  structures.  It first checks to see if this is necessary since,
@@ -39,6 +39,7 @@
 #include "gncInvoice.h"
 #include "Scrub2.h"
 #include "ScrubBusiness.h"
+#include "ScrubBusinessP.h"
 #include "Transaction.h"
 
 #undef G_LOG_DOMAIN
@@ -259,6 +260,29 @@ scrub_start:
     return modified;
 }
 
+/* Up to this many candidate splits the original exhaustive search is
+ * used, so small cases keep matching exactly as they always have. */
+#define SUBSET_EXACT_MAX_SPLITS 8
+/* Bound on the subset-sum table: target amount in units of the
+ * currency's fraction times the number of candidates.  Beyond it only
+ * the greedy match is tried.  gncScrubBusinessSetMaxSubsetCells()
+ * changes it. */
+#define SUBSET_DP_MAX_CELLS (G_GINT64_CONSTANT(1) << 26)
+
+static gint64 subset_dp_max_cells = SUBSET_DP_MAX_CELLS;
+
+void
+gncScrubBusinessSetMaxSubsetCells (gint64 max_cells)
+{
+    subset_dp_max_cells = max_cells;
+}
+
+gint64
+gncScrubBusinessGetMaxSubsetCells (void)
+{
+    return subset_dp_max_cells;
+}
+
 // Note this is a recursive function. It presumes the number of splits
 // in avail_splits is relatively low. With many splits the performance will
 // quickly degrade.
@@ -266,7 +290,7 @@ scrub_start:
 // and with values of opposite sign of target_value
 // Ignoring this can cause unexpected results!
 static SplitList *
-gncSLFindOffsSplits (SplitList *avail_splits, gnc_numeric target_value)
+gncSLFindOffsSplitsExhaustive (SplitList *avail_splits, gnc_numeric target_value)
 {
     gint curr_recurse_level = 0;
     gint max_recurse_level = g_list_length (avail_splits) - 1;
@@ -300,8 +324,8 @@ gncSLFindOffsSplits (SplitList *avail_splits, gnc_numeric target_value)
             {
                 if (gnc_numeric_positive_p (target_value) ==
                     gnc_numeric_positive_p (remaining_value))
-                    match_splits = gncSLFindOffsSplits (split_iter->next,
-                                                        remaining_value);
+                    match_splits = gncSLFindOffsSplitsExhaustive (split_iter->next,
+                                                                  remaining_value);
             }
 
             if (match_splits)
@@ -312,6 +336,129 @@ gncSLFindOffsSplits (SplitList *avail_splits, gnc_numeric target_value)
     return NULL;
 }
 
+/* Exact subset sum over the absolute values as integers in denom units.
+ * reach[s] is the index of the split that first made sum s reachable,
+ * so following it back from the target gives distinct splits in
+ * decreasing index order. */
+static SplitList *
+gncSLFindOffsSplitsDP (Split **splits, const gint64 *amounts, gint n,
+                       gint64 target)
+{
+    gint *reach = g_new (gint, target + 1);
+    SplitList *match = NULL;
+    gint64 s;
+    gint i;
+
+    reach[0] = n;
+    for (s = 1; s <= target; s++)
+        reach[s] = -1;
+
+    for (i = 0; i < n && reach[target] < 0; i++)
+        for (s = target; s >= amounts[i]; s--)
+            if (reach[s] < 0 && reach[s - amounts[i]] >= 0)
+                reach[s] = i;
+
+    if (reach[target] >= 0)
+        for (s = target; s > 0; s -= amounts[reach[s]])
+            match = g_list_prepend (match, splits[reach[s]]);
+
+    g_free (reach);
+    return match;
+}
+
+/* Largest values first, taking each split that still fits. */
+static gint
+split_value_abs_cmp (gconstpointer a, gconstpointer b)
+{
+    gnc_numeric va = gnc_numeric_abs (xaccSplitGetValue ((Split*)a));
+    gnc_numeric vb = gnc_numeric_abs (xaccSplitGetValue ((Split*)b));
+    return gnc_numeric_compare (vb, va);
+}
+
+static SplitList *
+gncSLFindOffsSplitsGreedy (SplitList *avail_splits, gnc_numeric target_value)
+{
+    SplitList *sorted = g_list_sort (g_list_copy (avail_splits),
+                                     split_value_abs_cmp);
+    SplitList *match = NULL, *node;
+    gnc_numeric remaining = gnc_numeric_abs (target_value);
+
+    for (node = sorted; node && !gnc_numeric_zero_p (remaining); node = node->next)
+    {
+        gnc_numeric val = gnc_numeric_abs (xaccSplitGetValue (node->data));
+        if (gnc_numeric_compare (val, remaining) > 0)
+            continue;
+        remaining = gnc_numeric_sub (remaining, val,
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        match = g_list_prepend (match, node->data);
+    }
+    g_list_free (sorted);
+
+    if (!gnc_numeric_zero_p (remaining))
+    {
+        g_list_free (match);
+        return NULL;
+    }
+    return g_list_reverse (match);
+}
+
+// Find a set of splits in avail_splits whose values offset target_value.
+// Small sets are searched exhaustively.  Larger ones are matched exactly
+// by dynamic programming over integer values in units of the fraction of
+// the first split's transaction currency, which is what the values are
+// in, as long as the table stays within gncScrubBusinessGetMaxSubsetCells();
+// otherwise, or if a value isn't representable in that fraction, a greedy
+// match is attempted.
+// The same assumptions as for gncSLFindOffsSplitsExhaustive apply.
+SplitList *
+gncSLFindOffsSplits (SplitList *avail_splits, gnc_numeric target_value)
+{
+    gint n = g_list_length (avail_splits);
+    gnc_numeric abs_target;
+    gint64 denom, target;
+    Split **splits;
+    gint64 *amounts;
+    SplitList *node, *match = NULL;
+    gboolean exact = TRUE;
+    gint i;
+
+    if (n <= SUBSET_EXACT_MAX_SPLITS)
+        return gncSLFindOffsSplitsExhaustive (avail_splits, target_value);
+
+    denom = gnc_commodity_get_fraction (
+                xaccTransGetCurrency (xaccSplitGetParent (avail_splits->data)));
+    abs_target = gnc_numeric_convert (gnc_numeric_abs (target_value), denom,
+                                      GNC_HOW_RND_NEVER);
+    target = gnc_numeric_num (abs_target);
+    if (denom <= 0 || gnc_numeric_check (abs_target) || target <= 0
+            || target > subset_dp_max_cells / n)
+        return gncSLFindOffsSplitsGreedy (avail_splits, target_value);
+
+    splits = g_new (Split*, n);
+    amounts = g_new (gint64, n);
+    for (node = avail_splits, i = 0; node; node = node->next, i++)
+    {
+        gnc_numeric val = gnc_numeric_convert (gnc_numeric_abs (xaccSplitGetValue (node->data)),
+                                               denom, GNC_HOW_RND_NEVER);
+        if (gnc_numeric_check (val))
+        {
+            exact = FALSE;
+            break;
+        }
+        splits[i] = node->data;
+        amounts[i] = gnc_numeric_num (val);
+    }
+
+    if (exact)
+        match = gncSLFindOffsSplitsDP (splits, amounts, n, target);
+    else
+        match = gncSLFindOffsSplitsGreedy (avail_splits, target_value);
+
+    g_free (splits);
+    g_free (amounts);
+    return match;
+}
+
 
 static gboolean
 gncScrubLotDanglingPayments (GNCLot *lot)
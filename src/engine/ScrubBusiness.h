@@ -54,6 +54,18 @@
  */
 gboolean gncScrubBusinessLot (GNCLot *lot);
 
+/** Bounds the search gncScrubBusinessLot() does for the free payment
+ *    splits that offset a dangling lot link.  With more than a handful
+ *    of candidates the splits are matched exactly only if the target
+ *    value, in units of its currency's fraction, times the number of
+ *    candidates is at most max_cells; otherwise the largest splits are
+ *    matched first, which may find no match where an exact search
+ *    would.  The memory used is about four bytes per target unit.
+ *    The default is 2^26; zero or less always matches greedily.
+ */
+void gncScrubBusinessSetMaxSubsetCells (gint64 max_cells);
+gint64 gncScrubBusinessGetMaxSubsetCells (void);
+
 /** The gncScrubBusinessSplit() function will fix all issues found with
  *    the given split.
  *
@@ -0,0 +1,39 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @file ScrubBusinessP.h
+ *
+ * This is the *private* header for the business scrub routines.
+ * No one outside of the engine and its tests should ever include
+ * this file.
+ */
+
+#ifndef GNC_SCRUBBUSINESS_P_H
+#define GNC_SCRUBBUSINESS_P_H
+
+#include "gnc-engine.h"
+#include "Split.h"
+
+/* Returns the splits of avail_splits whose values add up to offset
+ * target_value, or NULL if there are none; g_list_free the result.
+ * All splits must have values of the sign opposite to target_value. */
+SplitList *gncSLFindOffsSplits (SplitList *avail_splits,
+                                gnc_numeric target_value);
+
+#endif /* GNC_SCRUBBUSINESS_P_H */
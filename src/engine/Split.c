@@ -56,6 +56,8 @@
 #include "gnc-lot.h"
 #include "gnc-event.h"
 #include "qofinstance-p.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
 
 const char *void_former_amt_str = "void-former-amount";
 const char *void_former_val_str = "void-former-value";
@@ -113,9 +115,12 @@ gnc_split_init(Split* split)
 
     split->action      = CACHE_INSERT("");
     split->memo        = CACHE_INSERT("");
+    split->memo_sort_key   = NULL;
+    split->action_sort_key = NULL;
     split->reconciled  = NREC;
     split->amount      = gnc_numeric_zero();
     split->value       = gnc_numeric_zero();
+    split->lot_amount  = gnc_numeric_zero();
 
     split->date_reconciled.tv_sec  = 0;
     split->date_reconciled.tv_nsec = 0;
@@ -239,7 +244,10 @@ gnc_split_set_property(GObject         *object,
 
     split = GNC_SPLIT(object);
     if (prop_id < PROP_RUNTIME_0 && split->parent != NULL)
+    {
         g_assert (qof_instance_get_editlevel(split->parent));
+        xaccTransSnapshotSplit (split->parent, split);
+    }
 
     switch (prop_id)
     {
@@ -506,9 +514,9 @@ gnc_split_class_init(SplitClass* klass)
 \********************************************************************/
 
 static void
-xaccInitSplit(Split * split, QofBook *book)
+xaccInitSplit(Split * split, QofBook *book, const GncGUID *guid)
 {
-    qof_instance_init_data(&split->inst, GNC_ID_SPLIT, book);
+    qof_instance_init_data_with_guid(&split->inst, GNC_ID_SPLIT, book, guid);
 }
 
 void
@@ -522,6 +530,7 @@ xaccSplitReinit(Split * split)
 
     CACHE_REPLACE(split->action, "");
     CACHE_REPLACE(split->memo, "");
+    xaccSplitClearSortKeys(split);
     split->reconciled  = NREC;
     split->amount      = gnc_numeric_zero();
     split->value       = gnc_numeric_zero();
@@ -544,12 +553,18 @@ xaccSplitReinit(Split * split)
 
 Split *
 xaccMallocSplit(QofBook *book)
+{
+    return xaccMallocSplitWithGUID (book, NULL);
+}
+
+Split *
+xaccMallocSplitWithGUID(QofBook *book, const GncGUID *guid)
 {
     Split *split;
     g_return_val_if_fail (book, NULL);
 
     split = g_object_new (GNC_TYPE_SPLIT, NULL);
-    xaccInitSplit (split, book);
+    xaccInitSplit (split, book, guid);
 
     return split;
 }
@@ -634,6 +649,7 @@ xaccSplitCloneNoKvp (const Split *s)
 void
 xaccSplitCopyKvp (const Split *from, Split *to)
 {
+    xaccTransSnapshotSplit (to->parent, to);
     qof_instance_copy_kvp (QOF_INSTANCE (to), QOF_INSTANCE (from));
 }
 
@@ -715,6 +731,7 @@ xaccFreeSplit (Split *split)
     }
     CACHE_REMOVE(split->memo);
     CACHE_REMOVE(split->action);
+    xaccSplitClearSortKeys(split);
 
     /* Just in case someone looks up freed memory ... */
     split->memo        = (char *) 1;
@@ -736,15 +753,25 @@ xaccFreeSplit (Split *split)
     g_object_unref(split);
 }
 
+void
+xaccSplitClearSortKeys (Split *s)
+{
+    g_free(s->memo_sort_key);
+    s->memo_sort_key = NULL;
+    g_free(s->action_sort_key);
+    s->action_sort_key = NULL;
+}
+
 void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_set_balance_dirty_at(s->acc, s);
+        gnc_account_set_sort_dirty(s->acc);
     }
 
-    /* set dirty flag on lot too. */
-    if (s->lot) gnc_lot_set_closed_unknown(s->lot);
+    /* keep the lot's cached balance in step with the amount. */
+    if (s->lot) gnc_lot_update_split_amount(s->lot, s);
 }
 
 /*
@@ -941,7 +968,10 @@ xaccSplitSetAccount (Split *s, Account *acc)
 
     trans = s->parent;
     if (trans)
+    {
         xaccTransBeginEdit(trans);
+        xaccTransSnapshotSplit(trans, s);
+    }
 
     s->acc = acc;
     qof_instance_set_dirty(QOF_INSTANCE(s));
@@ -1021,13 +1051,19 @@ xaccSplitCommitEdit(Split *s)
        original and new transactions, for the _next_ begin/commit cycle. */
     s->orig_acc = s->acc;
     s->orig_parent = s->parent;
+
+    /* The split may be freed by the commit below, so record where its
+     * account's balances went stale while it is still valid. */
+    if (acc && !qof_instance_get_destroying(s))
+        gnc_account_set_balance_dirty_at(acc, s);
+
     if (!qof_commit_edit_part2(QOF_INSTANCE(s), commit_err, NULL,
                                (void (*) (QofInstance *)) xaccFreeSplit))
         return;
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_set_sort_dirty(acc);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -1162,6 +1198,7 @@ xaccSplitSetSharePriceAndAmount (Split *s, gnc_numeric price, gnc_numeric amt)
     if (!s) return;
     ENTER (" ");
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
 
     s->amount = gnc_numeric_convert(amt, get_commodity_denom(s),
                                     GNC_HOW_RND_ROUND_HALF_UP);
@@ -1190,6 +1227,7 @@ xaccSplitSetSharePrice (Split *s, gnc_numeric price)
     if (!s) return;
     ENTER (" ");
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
 
     s->value = gnc_numeric_mul(xaccSplitGetAmount(s),
                                price, get_currency_denom(s),
@@ -1215,6 +1253,8 @@ qofSplitSetAmount (Split *split, gnc_numeric amt)
     {
         split->amount = amt;
     }
+    SET_GAINS_ADIRTY(split);
+    mark_split (split);
 }
 
 /* The amount of the split in the _account's_ commodity. */
@@ -1228,6 +1268,7 @@ xaccSplitSetAmount (Split *s, gnc_numeric amt)
            s->amount.num, s->amount.denom, amt.num, amt.denom);
 
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
     if (s->acc)
     {
         s->amount = gnc_numeric_convert(amt, get_commodity_denom(s),
@@ -1266,6 +1307,7 @@ xaccSplitSetValue (Split *s, gnc_numeric amt)
            s->value.num, s->value.denom, amt.num, amt.denom);
 
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
     new_val = gnc_numeric_convert(amt, get_currency_denom(s),
                                   GNC_HOW_RND_ROUND_HALF_UP);
     if (gnc_numeric_check(new_val) == GNC_ERROR_OK &&
@@ -1301,6 +1343,27 @@ xaccSplitGetReconciledBalance (const Split *s)
     return s ? s->reconciled_balance : gnc_numeric_zero();
 }
 
+void
+gnc_commodity_collector_add_splits (GncCommodityCollector *collector,
+                                    SplitList *splits, gboolean use_value)
+{
+    SplitList *node;
+
+    g_return_if_fail (collector);
+
+    for (node = splits; node; node = node->next)
+    {
+        Split *s = node->data;
+
+        if (use_value)
+            gnc_commodity_collector_add_amount
+                (collector, xaccTransGetCurrency (s->parent), s->value);
+        else
+            gnc_commodity_collector_add_amount
+                (collector, xaccAccountGetCommodity (s->acc), s->amount);
+    }
+}
+
 void
 xaccSplitSetBaseValue (Split *s, gnc_numeric value,
                        const gnc_commodity * base_currency)
@@ -1310,6 +1373,7 @@ xaccSplitSetBaseValue (Split *s, gnc_numeric value,
 
     if (!s) return;
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
 
     if (!s->acc)
     {
@@ -1468,6 +1532,7 @@ xaccSplitDestroy (Split *split)
         return FALSE;
 
     xaccTransBeginEdit(trans);
+    xaccTransSnapshotSplit(trans, split);
     ed.node = split;
     ed.idx = xaccTransGetSplitIndex(trans, split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
@@ -1481,13 +1546,32 @@ xaccSplitDestroy (Split *split)
 /********************************************************************\
 \********************************************************************/
 
+/* Compare two strings the way g_utf8_collate() would, using collation
+ * keys cached in *key_a and *key_b.  The strings come out of the
+ * string cache, so identical strings are usually the same pointer and
+ * don't need a key at all. */
+static int
+split_collate_cached (const char *a, char **key_a, const char *b, char **key_b)
+{
+    if (!a) a = "";
+    if (!b) b = "";
+    if (a == b) return 0;
+
+    if (!*key_a)
+        *key_a = g_utf8_collate_key (a, -1);
+    if (!*key_b)
+        *key_b = g_utf8_collate_key (b, -1);
+    return strcmp (*key_a, *key_b);
+}
+
 gint
 xaccSplitOrder (const Split *sa, const Split *sb)
 {
     int retval;
     int comp;
-    char *da, *db;
     gboolean action_for_num;
+    /* The collation keys are a cache, not part of the split's state. */
+    Split *ma = (Split *) sa, *mb = (Split *) sb;
 
     if (sa == sb) return 0;
     /* nothing is always less than something */
@@ -1506,16 +1590,14 @@ xaccSplitOrder (const Split *sa, const Split *sb)
     if (retval) return retval;
 
     /* otherwise, sort on memo strings */
-    da = sa->memo ? sa->memo : "";
-    db = sb->memo ? sb->memo : "";
-    retval = g_utf8_collate (da, db);
+    retval = split_collate_cached (sa->memo, &ma->memo_sort_key,
+                                   sb->memo, &mb->memo_sort_key);
     if (retval)
         return retval;
 
     /* otherwise, sort on action strings */
-    da = sa->action ? sa->action : "";
-    db = sb->action ? sb->action : "";
-    retval = g_utf8_collate (da, db);
+    retval = split_collate_cached (sa->action, &ma->action_sort_key,
+                                   sb->action, &mb->action_sort_key);
     if (retval != 0)
         return retval;
 
@@ -1635,25 +1717,15 @@ xaccSplitGetCorrAccountCode(const Split *sa)
     return xaccAccountGetCode(other_split->acc);
 }
 
-/* TODO: It's not too hard to make this function avoid the malloc/free. */
 int
 xaccSplitCompareAccountFullNames(const Split *sa, const Split *sb)
 {
-    Account *aa, *ab;
-    char *full_a, *full_b;
-    int retval;
     if (!sa && !sb) return 0;
     if (!sa) return -1;
     if (!sb) return 1;
 
-    aa = sa->acc;
-    ab = sb->acc;
-    full_a = gnc_account_get_full_name(aa);
-    full_b = gnc_account_get_full_name(ab);
-    retval = g_utf8_collate(full_a, full_b);
-    g_free(full_a);
-    g_free(full_b);
-    return retval;
+    return g_utf8_collate(xaccAccountGetFullName(sa->acc),
+                          xaccAccountGetFullName(sb->acc));
 }
 
 
@@ -1705,11 +1777,74 @@ xaccSplitCompareOtherAccountCodes(const Split *sa, const Split *sb)
     return g_strcmp0(ca, cb);
 }
 
+/* The period number of the posted date of a split's transaction that
+ * SPLIT_GROUP_WEEK and friends compare.  Weeks are numbered as
+ * gnc:date-to-week does, and only compared within a year. */
+static gint
+split_group_period (const Split *split, SplitGroup group, gint *year)
+{
+    time64 posted = xaccTransGetDate (split->parent);
+    struct tm tm;
+
+    if (!gnc_localtime_r (&posted, &tm))
+        memset (&tm, 0, sizeof (tm));
+    *year = tm.tm_year;
+
+    switch (group)
+    {
+    case SPLIT_GROUP_WEEK:
+        return (gnc_time64_get_day_start (posted) / 86400 - 3) / 7;
+    case SPLIT_GROUP_MONTH:
+        return tm.tm_mon;
+    case SPLIT_GROUP_QUARTER:
+        return tm.tm_mon / 3;
+    default:
+        return 0;
+    }
+}
+
+gboolean
+xaccSplitSameGroup (const Split *sa, const Split *sb, SplitGroup group)
+{
+    gint year_a, year_b, period_a, period_b;
+
+    g_return_val_if_fail (sa && sb, FALSE);
+
+    switch (group)
+    {
+    case SPLIT_GROUP_NONE:
+        return TRUE;
+    case SPLIT_GROUP_ACCOUNT_NAME:
+        /* Sorted splits mostly come in runs of the same account;
+         * don't build its full name for every one of them. */
+        return sa->acc == sb->acc ||
+               xaccSplitCompareAccountFullNames (sa, sb) == 0;
+    case SPLIT_GROUP_ACCOUNT_CODE:
+        return sa->acc == sb->acc ||
+               xaccSplitCompareAccountCodes (sa, sb) == 0;
+    case SPLIT_GROUP_OTHER_ACCOUNT_NAME:
+        return xaccSplitCompareOtherAccountFullNames (sa, sb) == 0;
+    case SPLIT_GROUP_OTHER_ACCOUNT_CODE:
+        return xaccSplitCompareOtherAccountCodes (sa, sb) == 0;
+    case SPLIT_GROUP_WEEK:
+    case SPLIT_GROUP_MONTH:
+    case SPLIT_GROUP_QUARTER:
+    case SPLIT_GROUP_YEAR:
+        period_a = split_group_period (sa, group, &year_a);
+        period_b = split_group_period (sb, group, &year_b);
+        return year_a == year_b && period_a == period_b;
+    default:
+        g_return_val_if_reached (FALSE);
+    }
+}
+
 static void
 qofSplitSetMemo (Split *split, const char* memo)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->memo, memo);
+    g_free(split->memo_sort_key);
+    split->memo_sort_key = NULL;
 }
 
 void
@@ -1717,8 +1852,11 @@ xaccSplitSetMemo (Split *split, const char *memo)
 {
     if (!split || !memo) return;
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
 
     CACHE_REPLACE(split->memo, memo);
+    g_free(split->memo_sort_key);
+    split->memo_sort_key = NULL;
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1729,6 +1867,8 @@ qofSplitSetAction (Split *split, const char *actn)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->action, actn);
+    g_free(split->action_sort_key);
+    split->action_sort_key = NULL;
 }
 
 void
@@ -1736,8 +1876,11 @@ xaccSplitSetAction (Split *split, const char *actn)
 {
     if (!split || !actn) return;
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
 
     CACHE_REPLACE(split->action, actn);
+    g_free(split->action_sort_key);
+    split->action_sort_key = NULL;
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1769,6 +1912,7 @@ xaccSplitSetReconcile (Split *split, char recn)
 {
     if (!split || split->reconciled == recn) return;
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
 
     switch (recn)
     {
@@ -1795,6 +1939,7 @@ xaccSplitSetDateReconciledSecs (Split *split, time64 secs)
 {
     if (!split) return;
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
 
     split->date_reconciled.tv_sec = secs;
     split->date_reconciled.tv_nsec = 0;
@@ -1808,6 +1953,7 @@ xaccSplitSetDateReconciledTS (Split *split, Timespec *ts)
 {
     if (!split || !ts) return;
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
 
     split->date_reconciled = *ts;
     qof_instance_set_dirty(QOF_INSTANCE(split));
@@ -1863,6 +2009,7 @@ xaccSplitSetParent(Split *s, Transaction *t)
     old_trans = s->parent;
 
     xaccTransBeginEdit(old_trans);
+    xaccTransSnapshotSplit(old_trans, s);
 
     ed.node = s;
     if (old_trans)
@@ -1901,6 +2048,7 @@ void
 xaccSplitSetLot(Split* split, GNCLot* lot)
 {
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
     split->lot = lot;
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
@@ -2006,6 +2154,7 @@ xaccSplitMakeStockSplit(Split *s)
 {
     GValue v = G_VALUE_INIT;
     xaccTransBeginEdit (s->parent);
+    xaccTransSnapshotSplit (s->parent, s);
 
     s->value = gnc_numeric_zero();
     g_value_init (&v, G_TYPE_STRING);
@@ -2028,6 +2177,7 @@ xaccSplitAddPeerSplit (Split *split, const Split *other_split,
 
     guid = qof_instance_get_guid (QOF_INSTANCE (other_split));
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
     qof_instance_kvp_add_guid (QOF_INSTANCE (split), "lot-split",
                                timespec_now(), "peer_guid", guid_copy(guid));
     mark_split (split);
@@ -2064,6 +2214,7 @@ xaccSplitRemovePeerSplit (Split *split, const Split *other_split)
 
     guid = qof_instance_get_guid (QOF_INSTANCE (other_split));
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
     qof_instance_kvp_remove_guid (QOF_INSTANCE (split), "lot-split",
                                   "peer_guid", guid);
     mark_split (split);
@@ -2075,6 +2226,7 @@ void
 xaccSplitMergePeerSplits (Split *split, const Split *other_split)
 {
     xaccTransBeginEdit (split->parent);
+    xaccTransSnapshotSplit (split->parent, split);
     qof_instance_kvp_merge_guids (QOF_INSTANCE (split),
                                   QOF_INSTANCE (other_split), "lot-split");
     mark_split (split);
@@ -2097,9 +2249,9 @@ xaccSplitMergePeerSplits (Split *split, const Split *other_split)
 Split *
 xaccSplitGetOtherSplit (const Split *split)
 {
-    int i;
+    GList *node;
     Transaction *trans;
-    int count, num_splits;
+    int count;
     Split *other = NULL;
     gboolean lot_split;
     gboolean trading_accts;
@@ -2109,14 +2261,16 @@ xaccSplitGetOtherSplit (const Split *split)
     if (!trans) return NULL;
 
     trading_accts = xaccTransUseTradingAccounts (trans);
-    num_splits = xaccTransCountSplits(trans);
-    count = num_splits;
+    count = xaccTransCountSplits(trans);
     lot_split = qof_instance_has_slot(QOF_INSTANCE (split), "lot-split");
     if (!lot_split && !trading_accts && (2 != count)) return NULL;
 
-    for (i = 0; i < num_splits; i++)
+    /* Walk the list once rather than looking each split up by index. */
+    for (node = trans->splits; node; node = node->next)
     {
-        Split *s = xaccTransGetSplit(trans, i);
+        Split *s = node->data;
+        if (s->parent != trans || qof_instance_get_destroying(s))
+            continue;
         if (s == split)
         {
             --count;
@@ -2171,6 +2325,7 @@ xaccSplitVoid(Split *split)
     gnc_numeric zero = gnc_numeric_zero(), num;
     GValue v = G_VALUE_INIT;
 
+    xaccTransSnapshotSplit (split->parent, split);
     g_value_init (&v, GNC_TYPE_NUMERIC);
     num =  xaccSplitGetAmount(split);
     g_value_set_boxed (&v, &num);
@@ -2266,6 +2421,206 @@ qofSplitSetAccount(Split *s, QofInstance *ent)
     xaccSplitSetAccount(s, acc);
 }
 
+/* The question nearly every split query asks is "which splits are in
+ * these accounts", so when each OR term of a query requires the split's
+ * account to be one of a list, only the splits of those accounts need
+ * to be checked against it.  The other terms, such as dates or the
+ * reconcile state, are left to the query. */
+static gboolean
+split_query_account_terms (GList *and_terms, QofBook *book,
+                           GHashTable *accounts)
+{
+    GList *node;
+
+    for (node = and_terms; node; node = node->next)
+    {
+        QofQueryTerm *qt = node->data;
+        QofQueryParamList *path = qof_query_term_get_param_path (qt);
+        QofQueryPredData *pd = qof_query_term_get_pred_data (qt);
+        query_guid_t guid_data;
+        GList *guid_node;
+
+        if (qof_query_term_is_inverted (qt) || !pd || !path || !path->next ||
+            path->next->next ||
+            g_strcmp0 (path->data, SPLIT_ACCOUNT) != 0 ||
+            g_strcmp0 (path->next->data, QOF_PARAM_GUID) != 0 ||
+            g_strcmp0 (pd->type_name, QOF_TYPE_GUID) != 0 ||
+            pd->how != QOF_COMPARE_EQUAL)
+            continue;
+        guid_data = (query_guid_t) pd;
+        if (guid_data->options != QOF_GUID_MATCH_ANY)
+            continue;
+
+        for (guid_node = guid_data->guids; guid_node; guid_node = guid_node->next)
+        {
+            Account *acc = xaccAccountLookup (guid_node->data, book);
+            if (acc)
+                g_hash_table_insert (accounts, acc, acc);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* Narrow [*t_start, *t_end) to the posted dates that the AND terms
+ * allow.  The bounds are whole seconds and may let through a few
+ * splits the terms reject; the query tests every split anyway. */
+static void
+split_query_date_terms (GList *and_terms, time64 *t_start, time64 *t_end)
+{
+    GList *node;
+
+    for (node = and_terms; node; node = node->next)
+    {
+        QofQueryTerm *qt = node->data;
+        QofQueryParamList *path = qof_query_term_get_param_path (qt);
+        QofQueryPredData *pd = qof_query_term_get_pred_data (qt);
+        Timespec ts;
+
+        if (qof_query_term_is_inverted (qt) || !pd || !path || !path->next ||
+            path->next->next ||
+            g_strcmp0 (path->data, SPLIT_TRANS) != 0 ||
+            g_strcmp0 (path->next->data, TRANS_DATE_POSTED) != 0 ||
+            !qof_query_date_predicate_get_date (pd, &ts) ||
+            ((query_date_t) pd)->options != QOF_DATE_MATCH_NORMAL)
+            continue;
+
+        if ((pd->how == QOF_COMPARE_GT || pd->how == QOF_COMPARE_GTE ||
+             pd->how == QOF_COMPARE_EQUAL) && ts.tv_sec > *t_start)
+            *t_start = ts.tv_sec;
+        if ((pd->how == QOF_COMPARE_LT || pd->how == QOF_COMPARE_LTE ||
+             pd->how == QOF_COMPARE_EQUAL) && ts.tv_sec < *t_end - 1)
+            *t_end = ts.tv_sec + 1;
+    }
+}
+
+typedef struct
+{
+    QofInstanceForeachCB cb;
+    gpointer user_data;
+} SplitQueryIndexData;
+
+static gint
+split_query_index_cb (Split *split, gpointer user_data)
+{
+    SplitQueryIndexData *data = user_data;
+    data->cb (QOF_INSTANCE (split), data->user_data);
+    return 0;
+}
+
+static gboolean
+split_query_index (QofQuery *q, QofBook *book, QofInstanceForeachCB cb,
+                   gpointer user_data)
+{
+    GList *or_node;
+    GHashTable *accounts;
+    GHashTableIter iter;
+    gpointer acc;
+    time64 t_start = G_MAXINT64, t_end = G_MININT64;
+    SplitQueryIndexData data = { cb, user_data };
+
+    if (!qof_query_get_terms (q))
+        return FALSE;
+
+    accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (or_node = qof_query_get_terms (q); or_node; or_node = or_node->next)
+    {
+        time64 or_start = G_MININT64, or_end = G_MAXINT64;
+
+        if (!split_query_account_terms (or_node->data, book, accounts))
+        {
+            g_hash_table_destroy (accounts);
+            return FALSE;
+        }
+        /* The splits to visit are those of any OR term. */
+        split_query_date_terms (or_node->data, &or_start, &or_end);
+        t_start = MIN (t_start, or_start);
+        t_end = MAX (t_end, or_end);
+    }
+
+    /* A split is in one account only, so none is visited twice.  The
+     * account keeps its splits in posted date order, so only those in
+     * the date range need to be seen. */
+    g_hash_table_iter_init (&iter, accounts);
+    while (g_hash_table_iter_next (&iter, &acc, NULL))
+    {
+        if (t_start == G_MININT64 && t_end == G_MAXINT64)
+        {
+            GList *node;
+            for (node = xaccAccountGetSplitList (acc); node; node = node->next)
+                cb (node->data, user_data);
+        }
+        else if (t_start < t_end)
+            xaccAccountForEachSplitInRange (acc, t_start, t_end,
+                                            split_query_index_cb, &data);
+    }
+    g_hash_table_destroy (accounts);
+    return TRUE;
+}
+
+/* Whether a term or sort of the query looks into the given parameter
+ * of the split beyond its identity. */
+static gboolean
+split_query_path_reads (GSList *path, const char *param)
+{
+    return path && !g_strcmp0 (path->data, param) &&
+           (!path->next || g_strcmp0 (path->next->data, QOF_PARAM_GUID));
+}
+
+static gboolean
+split_query_reads (QofQuery *q, const char *param)
+{
+    QofQuerySort *sorts[3];
+    GList *or_node, *and_node;
+    int i;
+
+    for (or_node = qof_query_get_terms (q); or_node; or_node = or_node->next)
+        for (and_node = or_node->data; and_node; and_node = and_node->next)
+            if (split_query_path_reads (
+                        qof_query_term_get_param_path (and_node->data), param))
+                return TRUE;
+
+    qof_query_get_sorts (q, &sorts[0], &sorts[1], &sorts[2]);
+    for (i = 0; i < 3; i++)
+        if (split_query_path_reads (qof_query_sort_get_param_path (sorts[i]),
+                                    param))
+            return TRUE;
+    return FALSE;
+}
+
+/* The splits whose query parameters may have changed with a change to
+ * another object.  For a transaction, these are its splits.  An
+ * account or lot changes with every split put in or taken out.  So if
+ * the query looks at them, or at the balances and names derived from
+ * them, give up rather than test all of their splits again. */
+static gboolean
+split_query_dependents (QofQuery *q, QofInstance *changed,
+                        QofInstanceForeachCB cb, gpointer user_data)
+{
+    GList *node;
+
+    if (GNC_IS_TRANSACTION (changed))
+    {
+        /* The splits go with their own events */
+        if (qof_instance_get_destroying (changed))
+            return TRUE;
+        for (node = GNC_TRANSACTION (changed)->splits; node; node = node->next)
+            cb (node->data, user_data);
+        return TRUE;
+    }
+    if (GNC_IS_ACCOUNT (changed))
+        return !(split_query_reads (q, SPLIT_ACCOUNT) ||
+                 split_query_reads (q, SPLIT_BALANCE) ||
+                 split_query_reads (q, SPLIT_CLEARED_BALANCE) ||
+                 split_query_reads (q, SPLIT_RECONCILED_BALANCE) ||
+                 split_query_reads (q, SPLIT_ACCT_FULLNAME) ||
+                 split_query_reads (q, SPLIT_CORR_ACCT_NAME) ||
+                 split_query_reads (q, SPLIT_CORR_ACCT_CODE));
+    if (GNC_IS_LOT (changed))
+        return !split_query_reads (q, SPLIT_LOT);
+    return FALSE;
+}
+
 gboolean xaccSplitRegister (void)
 {
     static const QofParam params[] =
@@ -2366,6 +2721,9 @@ gboolean xaccSplitRegister (void)
     qof_class_register (SPLIT_CORR_ACCT_CODE,
                         (QofSortFunc)xaccSplitCompareOtherAccountCodes, NULL);
 
+    qof_query_register_index (GNC_ID_SPLIT, split_query_index);
+    qof_query_register_dependents (GNC_ID_SPLIT, split_query_dependents);
+
     return qof_object_register (&split_object_def);
 }
 
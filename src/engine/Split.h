@@ -88,6 +88,10 @@ gnc_numeric xaccSplitConvertAmount (const Split *split, const Account * account)
 /** Constructor. */
 Split       * xaccMallocSplit (QofBook *book);
 
+/** Constructor for loaders that already know the split's GUID; see
+ *  qof_instance_init_data_with_guid(). */
+Split       * xaccMallocSplitWithGUID (QofBook *book, const GncGUID *guid);
+
 /* Reinit a previously malloc'd split. Split remains in the book it
    was already in, and the QofInstance portions also remain unchanged.
    It's basically the data elements that are reverted to default
@@ -318,6 +322,13 @@ gnc_numeric xaccSplitGetClearedBalance (const Split *split);
  */
 gnc_numeric xaccSplitGetReconciledBalance (const Split *split);
 
+/** Add each split of the list to the collector in one call: its amount
+ * in its account's commodity, or if use_value is TRUE its value in its
+ * transaction's currency. */
+void gnc_commodity_collector_add_splits (GncCommodityCollector *collector,
+                                         SplitList *splits,
+                                         gboolean use_value);
+
 /** @} */
 
 /** @name Split utility functions
@@ -441,6 +452,29 @@ int xaccSplitCompareOtherAccountFullNames(const Split *sa, const Split *sb);
  * other side of a transaction and compare on it. */
 int xaccSplitCompareOtherAccountCodes(const Split *sa, const Split *sb);
 
+/** The keys a sorted list of splits can be grouped by, e.g. to
+ * subtotal a report. */
+typedef enum
+{
+    SPLIT_GROUP_NONE,
+    SPLIT_GROUP_ACCOUNT_NAME,
+    SPLIT_GROUP_ACCOUNT_CODE,
+    SPLIT_GROUP_OTHER_ACCOUNT_NAME,
+    SPLIT_GROUP_OTHER_ACCOUNT_CODE,
+    SPLIT_GROUP_WEEK,
+    SPLIT_GROUP_MONTH,
+    SPLIT_GROUP_QUARTER,
+    SPLIT_GROUP_YEAR
+} SplitGroup;
+
+/** Check whether two splits fall into the same group.  Accounts are
+ * compared as by the functions above, periods are those of the
+ * transactions' posted dates in local time, weeks being counted as in
+ * the reports.  Any two splits are in the same SPLIT_GROUP_NONE
+ * group. */
+gboolean xaccSplitSameGroup(const Split *sa, const Split *sb,
+                            SplitGroup group);
+
 
 /**
  * These functions take a split, get the corresponding split on the
@@ -93,6 +93,12 @@ struct split_s
      */
     char  * action;            /* Buy, Sell, Div, etc.                      */
 
+    /* Collation keys for memo and action, built on demand by
+     * xaccSplitOrder() and thrown away whenever either string changes.
+     * NULL means not yet computed. */
+    char  * memo_sort_key;
+    char  * action_sort_key;
+
     Timespec date_reconciled;  /* date split was reconciled                 */
     char    reconciled;        /* The reconciled field                      */
 
@@ -125,6 +131,10 @@ struct split_s
     gnc_numeric  balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
+
+    /* The amount this split last contributed to its lot's cached
+     * balance, so that an amount change can be applied as a delta. */
+    gnc_numeric  lot_amount;
 };
 
 struct _SplitClass
@@ -152,6 +162,10 @@ void xaccSplitCopyKvp (const Split *from, Split *to);
 Split *xaccDupeSplit (const Split *s);
 void mark_split (Split *s);
 
+/* Drop the cached memo/action collation keys; call this after
+ * changing split->memo or split->action without the setters. */
+void xaccSplitClearSortKeys (Split *s);
+
 void xaccSplitVoid(Split *split);
 void xaccSplitUnvoid(Split *split);
 void xaccSplitCommitEdit(Split *s);
@@ -83,6 +83,7 @@ static QofLogModule log_module = "gnc.translog";
 
 
 static int gen_logs = 1;
+static int log_batch_level = 0; /**< nesting depth of xaccLogBeginBatch */
 static FILE * trans_log = NULL; /**< current log file handle */
 static char * trans_log_name = NULL; /**< current log file name */
 static char * log_base_name = NULL;
@@ -99,6 +100,21 @@ void xaccLogEnable  (void)
     gen_logs = 1;
 }
 
+void
+xaccLogBeginBatch (void)
+{
+    log_batch_level++;
+}
+
+void
+xaccLogEndBatch (void)
+{
+    g_return_if_fail (log_batch_level > 0);
+
+    if (--log_batch_level == 0 && trans_log)
+        fflush (trans_log);
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -301,8 +317,9 @@ xaccTransWriteLog (Transaction *trans, char flag)
 
     fprintf (trans_log, "===== END\n");
 
-    /* get data out to the disk */
-    fflush (trans_log);
+    /* get data out to the disk, unless a batch will do that at its end */
+    if (!log_batch_level)
+        fflush (trans_log);
 }
 
 /************************ END OF ************************************\
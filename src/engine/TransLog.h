@@ -70,6 +70,13 @@ void    xaccLogEnable (void);
 
 /** document me */
 void    xaccLogDisable (void);
+/** Between xaccLogBeginBatch() and the matching xaccLogEndBatch()
+ *    the log is not flushed after every transaction; it is flushed
+ *    once when the outermost batch ends.  Use it around bulk changes
+ *    such as imports.  Batches may be nested.
+ */
+void    xaccLogBeginBatch (void);
+void    xaccLogEndBatch (void);
 
 /** The xaccLogSetBaseName() method sets the base filepath and the
  *    root part of the journal file name.  If the journal file is
@@ -263,6 +263,16 @@ void gen_event_trans (Transaction *trans)
     }
 }
 
+/* Cache the local calendar day of date_posted so that day-granular
+ * consumers don't each pay for a localtime conversion. */
+static void
+trans_update_date_posted_day (Transaction *trans)
+{
+    GDate date = timespec_to_gdate (trans->date_posted);
+    trans->date_posted_day = g_date_valid (&date) ?
+                             g_date_get_julian (&date) : 0;
+}
+
 /* GObject Initialization */
 G_DEFINE_TYPE(Transaction, gnc_transaction, QOF_TYPE_INSTANCE)
 
@@ -273,6 +283,7 @@ gnc_transaction_init(Transaction* trans)
     /* Fill in some sane defaults */
     trans->num         = CACHE_INSERT("");
     trans->description = CACHE_INSERT("");
+    trans->description_sort_key = NULL;
 
     trans->common_currency = NULL;
     trans->splits = NULL;
@@ -282,9 +293,11 @@ gnc_transaction_init(Transaction* trans)
 
     trans->date_posted.tv_sec  = 0;
     trans->date_posted.tv_nsec = 0;
+    trans_update_date_posted_day (trans);
 
     trans->marker = 0;
     trans->orig = NULL;
+    trans->imbalance_value_valid = FALSE;
     LEAVE (" ");
 }
 
@@ -503,10 +516,10 @@ gnc_transaction_class_init(TransactionClass* klass)
 \********************************************************************/
 
 static void
-xaccInitTransaction (Transaction * trans, QofBook *book)
+xaccInitTransaction (Transaction * trans, QofBook *book, const GncGUID *guid)
 {
     ENTER ("trans=%p", trans);
-    qof_instance_init_data (&trans->inst, GNC_ID_TRANS, book);
+    qof_instance_init_data_with_guid (&trans->inst, GNC_ID_TRANS, book, guid);
     LEAVE (" ");
 }
 
@@ -515,13 +528,19 @@ xaccInitTransaction (Transaction * trans, QofBook *book)
 
 Transaction *
 xaccMallocTransaction (QofBook *book)
+{
+    return xaccMallocTransactionWithGUID (book, NULL);
+}
+
+Transaction *
+xaccMallocTransactionWithGUID (QofBook *book, const GncGUID *guid)
 {
     Transaction *trans;
 
     g_return_val_if_fail (book, NULL);
 
     trans = g_object_new(GNC_TYPE_TRANSACTION, NULL);
-    xaccInitTransaction (trans, book);
+    xaccInitTransaction (trans, book, guid);
     qof_event_gen (&trans->inst, QOF_EVENT_CREATE, NULL);
 
     return trans;
@@ -599,27 +618,21 @@ xaccTransSortSplits (Transaction *trans)
 /* This routine is not exposed externally, since it does weird things,
  * like not really owning the splits correctly, and other weirdnesses.
  * This routine is prone to programmer snafu if not used correctly.
- * It is used only by the edit-rollback code.
+ * It is used only by the edit-rollback and clipboard code.
  */
 static Transaction *
-dupe_trans (const Transaction *from)
+dupe_trans_no_splits (const Transaction *from)
 {
     Transaction *to;
-    GList *node;
 
     to = g_object_new (GNC_TYPE_TRANSACTION, NULL);
 
     to->num         = CACHE_INSERT (from->num);
     to->description = CACHE_INSERT (from->description);
 
-    to->splits = g_list_copy (from->splits);
-    for (node = to->splits; node; node = node->next)
-    {
-        node->data = xaccDupeSplit (node->data);
-    }
-
     to->date_entered = from->date_entered;
     to->date_posted = from->date_posted;
+    to->date_posted_day = from->date_posted_day;
     qof_instance_copy_version(to, from);
     to->orig = NULL;
 
@@ -637,6 +650,63 @@ dupe_trans (const Transaction *from)
     return to;
 }
 
+static Transaction *
+dupe_trans (const Transaction *from)
+{
+    Transaction *to;
+    GList *node;
+
+    to = dupe_trans_no_splits (from);
+
+    to->splits = g_list_copy (from->splits);
+    for (node = to->splits; node; node = node->next)
+    {
+        node->data = xaccDupeSplit (node->data);
+    }
+
+    return to;
+}
+
+/* The rollback copy made by xaccTransBeginEdit.  Only the transaction
+ * itself is copied up front; orig->splits gets one empty slot per
+ * split, in the same order as trans->splits, and a slot is filled in
+ * by xaccTransSnapshotSplit just before that split is first changed.
+ * Splits that are never touched during the edit are never copied.
+ */
+static Transaction *
+snapshot_trans (const Transaction *from)
+{
+    Transaction *to;
+    GList *node;
+
+    to = dupe_trans_no_splits (from);
+
+    for (node = from->splits; node; node = node->next)
+        to->splits = g_list_prepend (to->splits, NULL);
+
+    return to;
+}
+
+void
+xaccTransSnapshotSplit (Transaction *trans, const Split *split)
+{
+    GList *node, *onode;
+
+    if (!trans || !trans->orig || !split) return;
+
+    /* Splits added during the edit are appended after the preexisting
+     * ones and have no slot, so they simply fall off the end. */
+    for (node = trans->splits, onode = trans->orig->splits;
+            node && onode; node = node->next, onode = onode->next)
+    {
+        if (node->data != split)
+            continue;
+        if (!onode->data)
+            onode->data = xaccDupeSplit (split);
+        return;
+    }
+}
+
 /********************************************************************\
  * Use this routine to externally duplicate a transaction.  It creates
  * a full fledged transaction with unique guid, splits, etc. and
@@ -654,6 +724,7 @@ xaccTransCloneNoKvp (const Transaction *from)
 
     to->date_entered    = from->date_entered;
     to->date_posted     = from->date_posted;
+    to->date_posted_day = from->date_posted_day;
     to->num             = CACHE_INSERT (from->num);
     to->description     = CACHE_INSERT (from->description);
     to->common_currency = from->common_currency;
@@ -814,6 +885,8 @@ xaccFreeTransaction (Transaction *trans)
     /* free up transaction strings */
     CACHE_REMOVE(trans->num);
     CACHE_REMOVE(trans->description);
+    g_free(trans->description_sort_key);
+    trans->description_sort_key = NULL;
 
     /* Just in case someone looks up freed memory ... */
     trans->num         = (char *) 1;
@@ -1045,12 +1118,24 @@ xaccTransGetImbalanceValue (const Transaction * trans)
     gnc_numeric imbal = gnc_numeric_zero();
     if (!trans) return imbal;
 
+    if (trans->imbalance_value_valid)
+        return trans->imbalance_value;
+
     ENTER("(trans=%p)", trans);
     /* Could use xaccSplitsComputeValue, except that we want to use
        GNC_HOW_DENOM_EXACT */
     FOR_EACH_SPLIT(trans, imbal =
                        gnc_numeric_add(imbal, xaccSplitGetValue(s),
                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT));
+
+    /* An open transaction can change under us without notice, so only
+     * remember the sum of a closed one. */
+    if (!xaccTransIsOpen (trans))
+    {
+        Transaction *t = (Transaction *) trans;
+        t->imbalance_value = imbal;
+        t->imbalance_value_valid = TRUE;
+    }
     LEAVE("(trans=%p) imbal=%s", trans, gnc_num_dbg_to_string(imbal));
     return imbal;
 }
@@ -1072,6 +1157,18 @@ xaccTransGetImbalance (const Transaction * trans)
 
     trading_accts = xaccTransUseTradingAccounts (trans);
 
+    /* Without trading accounts only the value sum matters. */
+    if (!trading_accts)
+    {
+        imbal_value = xaccTransGetImbalanceValue (trans);
+        if (!gnc_numeric_zero_p (imbal_value))
+            imbal_list = gnc_monetary_list_add_value (imbal_list,
+                         trans->common_currency,
+                         imbal_value);
+        LEAVE("(trans=%p), imbal=%p", trans, imbal_list);
+        return imbal_list;
+    }
+
     /* If using trading accounts and there is at least one split that is not
        in the transaction currency or a split that has a price or exchange
        rate other than 1, then compute the balance in each commodity in the
@@ -1443,6 +1540,9 @@ void
 xaccTransBeginEdit (Transaction *trans)
 {
     if (!trans) return;
+    /* Every change to the transaction or its splits happens inside an
+     * edit, so this is where the cached imbalance goes stale. */
+    trans->imbalance_value_valid = FALSE;
     if (!qof_begin_edit(&trans->inst)) return;
 
     if (qof_book_shutting_down(qof_instance_get_book(trans))) return;
@@ -1453,9 +1553,10 @@ xaccTransBeginEdit (Transaction *trans)
         xaccTransWriteLog (trans, 'B');
     }
 
-    /* Make a clone of the transaction; we will use this
-     * in case we need to roll-back the edit. */
-    trans->orig = dupe_trans (trans);
+    /* Make a copy of the transaction; we will use this in case we
+     * need to roll-back the edit.  The splits are copied on demand,
+     * see snapshot_trans. */
+    trans->orig = snapshot_trans (trans);
 }
 
 /********************************************************************\
@@ -1638,6 +1739,39 @@ static void trans_cleanup_commit(Transaction *trans)
     qof_event_gen (&trans->inst, QOF_EVENT_MODIFY, NULL);
 }
 
+/* TRUE if xaccTransScrubImbalance would find nothing to do: every
+ * split has an account with a commodity and valid numbers, splits in
+ * the transaction currency have equal amount and value, and the values
+ * sum to zero.  Books with trading accounts always get the full scrub.
+ * This is one cheap pass over the splits, so commit only pays for the
+ * scrub when there is something to fix. */
+static gboolean
+trans_is_scrub_clean (const Transaction *trans)
+{
+    gnc_numeric imbal = gnc_numeric_zero();
+
+    if (!trans->common_currency || xaccTransUseTradingAccounts (trans))
+        return FALSE;
+
+    FOR_EACH_SPLIT(trans,
+    {
+        gnc_commodity *commodity;
+
+        if (!s->acc || gnc_numeric_check (s->value) ||
+                gnc_numeric_check (s->amount))
+            return FALSE;
+        commodity = xaccAccountGetCommodity (s->acc);
+        if (!commodity)
+            return FALSE;
+        if (gnc_commodity_equiv (commodity, trans->common_currency) &&
+                !gnc_numeric_equal (s->amount, s->value))
+            return FALSE;
+        imbal = gnc_numeric_add (imbal, s->value,
+                                 GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    });
+    return gnc_numeric_zero_p (imbal);
+}
+
 void
 xaccTransCommitEdit (Transaction *trans)
 {
@@ -1675,8 +1809,10 @@ xaccTransCommitEdit (Transaction *trans)
         /* The total value of the transaction should sum to zero.
          * Call the trans scrub routine to fix it. Indirectly, this
          * routine also performs a number of other transaction fixes too.
+         * Most transactions are already clean, so check that first.
          */
-        xaccTransScrubImbalance (trans, NULL, NULL);
+        if (!trans_is_scrub_clean (trans))
+            xaccTransScrubImbalance (trans, NULL, NULL);
         /* Get the cap gains into a consistent state as well. */
 
         /* Lot Scrubbing is temporarily disabled. */
@@ -1743,8 +1879,11 @@ xaccTransRollbackEdit (Transaction *trans)
     orig = trans->orig;
     SWAP(trans->num, orig->num);
     SWAP(trans->description, orig->description);
+    g_free(trans->description_sort_key);
+    trans->description_sort_key = NULL;
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
+    trans->date_posted_day = orig->date_posted_day;
     SWAP(trans->common_currency, orig->common_currency);
     qof_instance_swap_kvp (QOF_INSTANCE (trans), QOF_INSTANCE (orig));
 
@@ -1769,18 +1908,28 @@ xaccTransRollbackEdit (Transaction *trans)
             Split *so = onode->data;
 
             xaccSplitRollbackEdit(s);
-            SWAP(s->action, so->action);
-            SWAP(s->memo, so->memo);
-	    qof_instance_copy_kvp (QOF_INSTANCE (s), QOF_INSTANCE (so));
-            s->reconciled = so->reconciled;
-            s->amount = so->amount;
-            s->value = so->value;
-            s->lot = so->lot;
-            s->gains_split = so->gains_split;
-            //SET_GAINS_A_VDIRTY(s);
-            s->date_reconciled = so->date_reconciled;
+            /* A split that was only marked dirty was never snapshotted
+             * and has no values to restore. */
+            if (so)
+            {
+                SWAP(s->action, so->action);
+                SWAP(s->memo, so->memo);
+                xaccSplitClearSortKeys(s);
+                qof_instance_copy_kvp (QOF_INSTANCE (s), QOF_INSTANCE (so));
+                s->reconciled = so->reconciled;
+                s->amount = so->amount;
+                s->value = so->value;
+                s->lot = so->lot;
+                s->gains_split = so->gains_split;
+                //SET_GAINS_A_VDIRTY(s);
+                s->date_reconciled = so->date_reconciled;
+                xaccFreeSplit(so);
+                onode->data = NULL;
+            }
+            /* The account may have recomputed its running balances
+             * with the edited values; make it redo them. */
+            mark_split(s);
             qof_instance_mark_clean(QOF_INSTANCE(s));
-            xaccFreeSplit(so);
         }
         else
         {
@@ -1807,8 +1956,6 @@ xaccTransRollbackEdit (Transaction *trans)
         }
     }
     g_list_free(slist);
-    g_list_free(orig->splits);
-    orig->splits = NULL;
 
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
@@ -1915,12 +2062,21 @@ xaccTransOrder_num_action (const Transaction *ta, const char *actna,
     /* if dates differ, return */
     DATE_CMP(ta, tb, date_entered);
 
-    /* otherwise, sort on description string */
+    /* otherwise, sort on description string, using the cached
+     * collation keys; identical cached strings need no key at all. */
     da = ta->description ? ta->description : "";
     db = tb->description ? tb->description : "";
-    retval = g_utf8_collate (da, db);
-    if (retval)
-        return retval;
+    if (da != db)
+    {
+        Transaction *ma = (Transaction *) ta, *mb = (Transaction *) tb;
+        if (!ma->description_sort_key)
+            ma->description_sort_key = g_utf8_collate_key (da, -1);
+        if (!mb->description_sort_key)
+            mb->description_sort_key = g_utf8_collate_key (db, -1);
+        retval = strcmp (ta->description_sort_key, tb->description_sort_key);
+        if (retval)
+            return retval;
+    }
 
     /* else, sort on guid - keeps sort stable. */
     return qof_instance_guid_compare(ta, tb);
@@ -1943,6 +2099,8 @@ xaccTransSetDateInternal(Transaction *trans, Timespec *dadate, Timespec val)
     }
 
     *dadate = val;
+    if (dadate == &trans->date_posted)
+        trans_update_date_posted_day (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);
     xaccTransCommitEdit(trans);
@@ -2146,6 +2304,8 @@ xaccTransSetDescription (Transaction *trans, const char *desc)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->description, desc);
+    g_free(trans->description_sort_key);
+    trans->description_sort_key = NULL;
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -2358,10 +2518,11 @@ xaccTransGetDatePostedGDate (const Transaction *trans)
          * shifts. */
 	GValue v = G_VALUE_INIT;
 	qof_instance_get_kvp (QOF_INSTANCE (trans), TRANS_DATE_POSTED, &v);
+        g_date_clear (&result, 1);
         if (G_VALUE_HOLDS_BOXED (&v))
              result = *(GDate*)g_value_get_boxed (&v);
 	if (! g_date_valid (&result))
-            result = timespec_to_gdate(xaccTransRetDatePostedTS(trans));
+            g_date_set_julian (&result, trans->date_posted_day);
     }
     else
     {
@@ -2370,6 +2531,12 @@ xaccTransGetDatePostedGDate (const Transaction *trans)
     return result;
 }
 
+guint32
+xaccTransGetDatePostedDay (const Transaction *trans)
+{
+    return trans ? trans->date_posted_day : 0;
+}
+
 Timespec
 xaccTransRetDateEnteredTS (const Transaction *trans)
 {
@@ -2643,6 +2810,76 @@ xaccTransVoid(Transaction *trans, const char *reason)
     xaccTransCommitEdit(trans);
 }
 
+/* Open every account the transactions in trans_list post to for
+ * editing.  An open account appends new splits without sorting and
+ * doesn't recompute its balances, so the work is done once per
+ * account in trans_list_commit_accounts instead of once per
+ * transaction. */
+static GList *
+trans_list_begin_accounts (GList *trans_list)
+{
+    GHashTable *seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GList *accounts = NULL, *node;
+
+    for (node = trans_list; node; node = node->next)
+    {
+        Transaction *trans = node->data;
+        FOR_EACH_SPLIT(trans,
+        {
+            Account *acc = s->acc;
+            if (acc && !g_hash_table_lookup (seen, acc))
+            {
+                g_hash_table_insert (seen, acc, acc);
+                xaccAccountBeginEdit (acc);
+                accounts = g_list_prepend (accounts, acc);
+            }
+        });
+    }
+    g_hash_table_destroy (seen);
+    return accounts;
+}
+
+static void
+trans_list_commit_accounts (GList *accounts)
+{
+    GList *node;
+
+    for (node = accounts; node; node = node->next)
+        xaccAccountCommitEdit (node->data);
+    g_list_free (accounts);
+}
+
+void
+xaccTransVoidList (GList *trans_list, const char *reason)
+{
+    GList *accounts, *node;
+
+    g_return_if_fail (reason);
+    if (!trans_list) return;
+
+    accounts = trans_list_begin_accounts (trans_list);
+    qof_event_suspend_coalescing ();
+    for (node = trans_list; node; node = node->next)
+        xaccTransVoid (node->data, reason);
+    qof_event_resume ();
+    trans_list_commit_accounts (accounts);
+}
+
+void
+xaccTransUnvoidList (GList *trans_list)
+{
+    GList *accounts, *node;
+
+    if (!trans_list) return;
+
+    accounts = trans_list_begin_accounts (trans_list);
+    qof_event_suspend_coalescing ();
+    for (node = trans_list; node; node = node->next)
+        xaccTransUnvoid (node->data);
+    qof_event_resume ();
+    trans_list_commit_accounts (accounts);
+}
+
 gboolean
 xaccTransGetVoidStatus(const Transaction *trans)
 {
@@ -2742,6 +2979,23 @@ xaccTransReverse (Transaction *orig)
     return trans;
 }
 
+GList *
+xaccTransReverseList (GList *trans_list)
+{
+    GList *accounts, *node, *reversed = NULL;
+
+    if (!trans_list) return NULL;
+
+    accounts = trans_list_begin_accounts (trans_list);
+    qof_event_suspend_coalescing ();
+    for (node = trans_list; node; node = node->next)
+        reversed = g_list_prepend (reversed, xaccTransReverse (node->data));
+    qof_event_resume ();
+    trans_list_commit_accounts (accounts);
+
+    return g_list_reverse (reversed);
+}
+
 Transaction *
 xaccTransGetReversedBy(const Transaction *trans)
 {
@@ -134,6 +134,11 @@ GType gnc_transaction_get_type(void);
  the xaccTransDestroy() method should be called. */
 Transaction * xaccMallocTransaction (QofBook *book);
 
+/** As xaccMallocTransaction(), for loaders that already know the
+ *  transaction's GUID; see qof_instance_init_data_with_guid(). */
+Transaction * xaccMallocTransactionWithGUID (QofBook *book,
+                                             const GncGUID *guid);
+
 /** Destroys a transaction.
  *  Each split in transaction @a trans is removed from its
  *  account and destroyed as well.
@@ -637,6 +642,10 @@ Timespec      xaccTransRetDatePostedTS (const Transaction *trans);
 /** Retrieve the posted date of the transaction. The posted date is
     the date when this transaction was posted at the bank. */
 GDate      xaccTransGetDatePostedGDate (const Transaction *trans);
+/** Retrieve the local calendar day of the posted date as a GDate
+    julian day number, suitable for cheap day-granular comparisons.
+    Returns 0 for a NULL transaction. */
+guint32       xaccTransGetDatePostedDay (const Transaction *trans);
 
 /*################## Added for Reg2 #################*/
 /** Retrieve the date of when the transaction was entered. The entered
@@ -687,6 +696,21 @@ void xaccTransVoid(Transaction *transaction,
  */
 void xaccTransUnvoid(Transaction *transaction);
 
+/** xaccTransVoidList and xaccTransUnvoidList void or unvoid every
+ *  transaction in the list, as xaccTransVoid and xaccTransUnvoid do.
+ *  The accounts involved are held open for the whole batch, so each
+ *  of them is sorted and rebalanced once at the end, and the
+ *  transactions' own events are suppressed; listeners see one modify
+ *  event per account instead.
+ *
+ *  @param trans_list A GList of Transaction*.  It is not modified.
+ *
+ *  @param reason The textual reason why these transactions are being
+ *  voided.
+ */
+void xaccTransVoidList(GList *trans_list, const char *reason);
+void xaccTransUnvoidList(GList *trans_list);
+
 /** xaccTransReverse creates a Transaction that reverses the given
  *  tranaction by inverting all the numerical values in the given
  *  transaction.  This function cancels out the effect of an earlier
@@ -700,6 +724,17 @@ void xaccTransUnvoid(Transaction *transaction);
  */
 Transaction * xaccTransReverse(Transaction *transaction);
 
+/** xaccTransReverseList reverses every transaction in the list, as
+ *  xaccTransReverse does, batching the account updates and events
+ *  like xaccTransVoidList.
+ *
+ *  @param trans_list A GList of Transaction*.  It is not modified.
+ *
+ *  @return A new list of the reversing transactions, in the same
+ *  order.  Free it with g_list_free().
+ */
+GList * xaccTransReverseList(GList *trans_list);
+
 /** Returns the transaction that reversed the given transaction.
  *
  *  @param trans a Transaction that has been reversed
@@ -77,6 +77,7 @@ struct transaction_s
 
     Timespec date_entered;     /* date register entry was made              */
     Timespec date_posted;      /* date transaction was posted at bank       */
+    guint32 date_posted_day;   /* local day of date_posted, as a GDate julian */
 
     /* The num field is a arbitrary user-assigned field.
      * It is intended to store a short id number, typically the check number,
@@ -89,6 +90,11 @@ struct transaction_s
      */
     char * description;
 
+    /* Collation key for the description, built on demand by
+     * xaccTransOrder() and thrown away when the description changes.
+     * NULL means not yet computed. */
+    char * description_sort_key;
+
     /* The common_currency field is the balancing common currency for
      * all the splits in the transaction.  Alternate, better(?) name:
      * "valuation currency": it is the currency in which all of the
@@ -110,6 +116,12 @@ struct transaction_s
      * any changes made if/when the edit is abandoned.
      */
     Transaction *orig;
+
+    /* The sum of the split values, cached by xaccTransGetImbalanceValue.
+     * It is only kept while the transaction is closed: every change
+     * opens the transaction, and xaccTransBeginEdit drops it. */
+    gnc_numeric imbalance_value;
+    gboolean imbalance_value_valid;
 };
 
 struct _TransactionClass
@@ -165,6 +177,13 @@ void xaccEnableDataScrubbing(void);
 void xaccDisableDataScrubbing(void);
 
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
+
+/* The xaccTransSnapshotSplit() routine saves a copy of the split in
+ *    the rollback data of its open transaction, unless one was already
+ *    saved during this edit.  Anything that changes a split must call
+ *    it before making the change, or a rollback cannot restore it.
+ */
+void xaccTransSnapshotSplit (Transaction *trans, const Split *split);
 void check_open (const Transaction *trans);
 
 /* Structure for accessing static functions for testing */
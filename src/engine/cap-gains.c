@@ -157,6 +157,8 @@ finder_helper (GNCLot *lot,  gpointer user_data)
         return NULL;
     }
 
+    /* Of lots opened at the same time, the first in the account's lot
+     * list wins, as it always has. */
     if (els->date_pred (els->ts, trans->date_posted))
     {
         els->ts = trans->date_posted;
@@ -183,7 +185,8 @@ xaccAccountFindOpenLot (Account *acc, gnc_numeric sign,
     if (gnc_numeric_positive_p(sign)) es.numeric_pred = gnc_numeric_negative_p;
     else es.numeric_pred = gnc_numeric_positive_p;
 
-    xaccAccountForEachLot (acc, finder_helper, &es);
+    /* Closed lots can never be chosen; skip them wholesale. */
+    gnc_account_foreach_open_lot (acc, finder_helper, &es);
     return es.lot;
 }
 
@@ -607,6 +610,7 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
         if (!s)
         {
             PERR ("Bad gains-split pointer! .. trying to recover.");
+            xaccTransSnapshotSplit (split->parent, split);
             split->gains_split = xaccSplitGetCapGainsSplit (split);
             s = split->gains_split;
             if (!s) return;
@@ -879,7 +883,11 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
             xaccSplitSetAmount (gain_split, negvalue);
             xaccSplitSetValue (gain_split, negvalue);
 
-            /* Some short-cuts to help avoid the above property lookup. */
+            /* Some short-cuts to help avoid the above property lookup.
+             * The splits may be rolled back with their transactions. */
+            xaccTransSnapshotSplit (split->parent, split);
+            xaccTransSnapshotSplit (trans, lot_split);
+            xaccTransSnapshotSplit (trans, gain_split);
             split->gains = GAINS_STATUS_CLEAN;
             split->gains_split = lot_split;
             lot_split->gains = GAINS_STATUS_GAINS;
@@ -976,4 +984,97 @@ xaccLotComputeCapGains (GNCLot *lot, Account *gain_acc)
     LEAVE("(lot=%p)", lot);
 }
 
+/* ============================================================== */
+
+static gboolean
+split_in_range (const Split *split, time64 start, time64 end)
+{
+    time64 date = xaccTransGetDate (split->parent);
+    return date >= start && date <= end;
+}
+
+void
+xaccAccountComputeCapGainsInRange (Account *acc, Account *gain_acc,
+                                   time64 start, time64 end)
+{
+    GHashTable *seen;
+    GList *trans_list = NULL, *lot_list = NULL, *node;
+
+    if (!acc) return;
+    if (FALSE == xaccAccountHasTrades (acc)) return;
+
+    ENTER ("(acc=%s)", xaccAccountGetName (acc));
+    /* Listeners hear about each changed object once, after the pass,
+     * rather than about every intermediate edit. */
+    qof_event_suspend_coalescing ();
+    xaccAccountBeginEdit (acc);
+
+    /* Open every transaction in range up front; the nested edits made
+     * while assigning and computing gains then just pile up. */
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (node = xaccAccountGetSplitList (acc); node; node = node->next)
+    {
+        Split *split = node->data;
+        Transaction *trans = split->parent;
+
+        if (!split_in_range (split, start, end)) continue;
+        if (g_hash_table_lookup (seen, trans)) continue;
+        g_hash_table_insert (seen, trans, trans);
+        xaccTransBeginEdit (trans);
+        trans_list = g_list_prepend (trans_list, trans);
+    }
+
+    /* Assign lots in split order, as xaccAccountAssignLots does;
+     * splitting a split changes the list, so start over when that
+     * happens. */
+restart_loop:
+    for (node = xaccAccountGetSplitList (acc); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (split->lot) continue;
+        if (!split_in_range (split, start, end)) continue;
+
+        /* Skip voided transactions */
+        if (gnc_numeric_zero_p (split->amount) &&
+                xaccTransGetVoidStatus (split->parent)) continue;
+
+        if (xaccSplitAssign (split)) goto restart_loop;
+    }
+
+    /* Each lot with a split in range, in order of first appearance. */
+    g_hash_table_remove_all (seen);
+    for (node = xaccAccountGetSplitList (acc); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (!split->lot || !split_in_range (split, start, end)) continue;
+        if (g_hash_table_lookup (seen, split->lot)) continue;
+        g_hash_table_insert (seen, split->lot, split->lot);
+        lot_list = g_list_prepend (lot_list, split->lot);
+    }
+    g_hash_table_destroy (seen);
+
+    lot_list = g_list_reverse (lot_list);
+    for (node = lot_list; node; node = node->next)
+        xaccLotComputeCapGains (node->data, gain_acc);
+    g_list_free (lot_list);
+
+    /* One commit per transaction, oldest first. */
+    trans_list = g_list_reverse (trans_list);
+    for (node = trans_list; node; node = node->next)
+        xaccTransCommitEdit (node->data);
+    g_list_free (trans_list);
+
+    xaccAccountCommitEdit (acc);
+    qof_event_resume ();
+    LEAVE ("(acc=%s)", xaccAccountGetName (acc));
+}
+
+void
+xaccAccountComputeCapGains (Account *acc, Account *gain_acc)
+{
+    xaccAccountComputeCapGainsInRange (acc, gain_acc, G_MININT64, G_MAXINT64);
+}
+
 /* =========================== END OF FILE ======================= */
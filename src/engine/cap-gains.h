@@ -205,6 +205,22 @@ Split * xaccSplitAssignToLot (Split *split, GNCLot *lot);
 void xaccSplitComputeCapGains(Split *split, Account *gain_acc);
 void xaccLotComputeCapGains (GNCLot *lot, Account *gain_acc);
 
+/** The xaccAccountComputeCapGains() routine recomputes the gains of a
+ *  whole account in one ordered pass: unassigned splits are assigned
+ *  to lots by the account's policy in split order, then the gains of
+ *  every lot touched are recomputed.  The transactions involved are
+ *  held open throughout, so each is committed, and scrubbed, once
+ *  rather than once per change.  Engine events are coalesced for the
+ *  length of the pass, so listeners get one create or modify event
+ *  per object changed when it ends.
+ *
+ *  xaccAccountComputeCapGainsInRange() restricts the pass to splits
+ *  whose transactions were posted between start and end, inclusive.
+ */
+void xaccAccountComputeCapGains (Account *acc, Account *gain_acc);
+void xaccAccountComputeCapGainsInRange (Account *acc, Account *gain_acc,
+                                        time64 start, time64 end);
+
 #endif /* XACC_CAP_GAINS_H */
 /** @} */
 /** @} */
@@ -34,6 +34,8 @@ static const GncGUID * gncAccountGetGUID(Account *x)
 %typemap(newfree) LotList * "g_list_free($1);"
 %typemap(newfree) CommodityList * "g_list_free($1);"
 
+%newobject gnc_commodity_collector_get_commodities;
+
 %include <Split.h>
 
 AccountList * gnc_account_get_children (const Account *account);
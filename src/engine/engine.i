@@ -202,8 +202,155 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 
 Timespec timespecCanonicalDayTime(Timespec t);
 
+%ignore gnc_budget_get_account_period_actual_values;
 %include <gnc-budget.h>
 
+%inline %{
+/* All of an account's budget actuals as a list, one per period. */
+static SCM
+gnc_budget_get_account_period_actual_value_list (GncBudget *budget,
+                                                 Account *acc)
+{
+    SCM list = SCM_EOL;
+    gnc_numeric *values;
+    guint n;
+
+    values = gnc_budget_get_account_period_actual_values (budget, acc);
+    if (!values)
+        return SCM_EOL;
+    for (n = gnc_budget_get_num_periods (budget); n > 0; n--)
+        list = scm_cons (gnc_numeric_to_scm (values[n - 1]), list);
+    g_free (values);
+    return list;
+}
+%}
+
+%inline %{
+/* The snapshot counts the splits posted strictly before each date; the
+ * report helpers count those posted on or before it. */
+static time64
+gnc_balance_snapshot_date_from_scm (SCM timepair)
+{
+    time64 date = gnc_timepair2timespec (timepair).tv_sec;
+    return date == G_MAXINT64 ? date : date + 1;
+}
+
+/* One list per account of the snapshot's values, optionally as the
+ * differences between consecutive pairs of dates. */
+static SCM
+gnc_balance_snapshot_to_scm (GncBalanceSnapshot *snapshot, gboolean pairs)
+{
+    SCM result = SCM_EOL;
+    guint n_dates = gnc_balance_snapshot_get_n_dates (snapshot);
+    guint i, j;
+
+    for (i = gnc_balance_snapshot_get_n_accounts (snapshot); i > 0; i--)
+    {
+        SCM row = SCM_EOL;
+
+        for (j = n_dates; j > 0; j -= pairs ? 2 : 1)
+        {
+            gnc_numeric value =
+                gnc_balance_snapshot_get_balance (snapshot, i - 1, j - 1);
+
+            if (pairs)
+                value = gnc_numeric_sub (value,
+                                         gnc_balance_snapshot_get_balance (snapshot, i - 1, j - 2),
+                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+            row = scm_cons (gnc_numeric_to_scm (value), row);
+        }
+        result = scm_cons (row, result);
+    }
+    return result;
+}
+
+/* The balance of each account, in its own commodity and without its
+ * children, at each of the list of timepairs, counting the splits
+ * posted on or before the date.  Returns one list of balances per
+ * account, in list order, from one pass over each account's splits. */
+static SCM
+gnc_accounts_get_balances_at_dates (AccountList *accounts, SCM dates)
+{
+    GncBalanceSnapshot *snapshot;
+    time64 *c_dates;
+    guint n_dates = scm_to_uint (scm_length (dates)), i;
+    SCM result;
+
+    c_dates = g_new (time64, n_dates + 1);
+    for (i = 0; i < n_dates; i++, dates = SCM_CDR (dates))
+        c_dates[i] = gnc_balance_snapshot_date_from_scm (SCM_CAR (dates));
+
+    snapshot = gnc_balance_snapshot_new (accounts, c_dates, n_dates);
+    result = gnc_balance_snapshot_to_scm (snapshot, FALSE);
+
+    gnc_balance_snapshot_free (snapshot);
+    g_free (c_dates);
+    g_list_free (accounts);
+    return result;
+}
+
+/* As gnc_accounts_get_balances_at_dates, but the change of each
+ * account's balance over each of a list of (start end) timepair
+ * intervals, counting the splits posted from the start to the end
+ * date inclusive. */
+static SCM
+gnc_accounts_get_balance_changes_for_intervals (AccountList *accounts,
+                                                SCM intervals)
+{
+    GncBalanceSnapshot *snapshot;
+    time64 *c_dates;
+    guint n_intervals = scm_to_uint (scm_length (intervals)), i;
+    SCM result;
+
+    c_dates = g_new (time64, 2 * n_intervals + 1);
+    for (i = 0; i < n_intervals; i++, intervals = SCM_CDR (intervals))
+    {
+        SCM interval = SCM_CAR (intervals);
+
+        c_dates[2 * i] = gnc_timepair2timespec (SCM_CAR (interval)).tv_sec;
+        c_dates[2 * i + 1] =
+            gnc_balance_snapshot_date_from_scm (SCM_CADR (interval));
+    }
+
+    snapshot = gnc_balance_snapshot_new (accounts, c_dates, 2 * n_intervals);
+    result = gnc_balance_snapshot_to_scm (snapshot, TRUE);
+
+    gnc_balance_snapshot_free (snapshot);
+    g_free (c_dates);
+    g_list_free (accounts);
+    return result;
+}
+
+/* Where a sorted list of splits breaks into primary and secondary
+ * groups: one integer per split, 2 if it is the last of its primary
+ * group, otherwise 1 if it is the last of its secondary group, and 0 if
+ * neither.  The last split ends every group that isn't
+ * SPLIT_GROUP_NONE. */
+static SCM
+gnc_split_list_get_group_breaks (SplitList *splits, SplitGroup primary,
+                                 SplitGroup secondary)
+{
+    SCM result = SCM_EOL;
+    GList *node;
+
+    for (node = splits; node; node = node->next)
+    {
+        Split *split = node->data, *next = node->next ? node->next->data : NULL;
+        int group_break = 0;
+
+        if (primary != SPLIT_GROUP_NONE &&
+            (!next || !xaccSplitSameGroup (split, next, primary)))
+            group_break = 2;
+        else if (secondary != SPLIT_GROUP_NONE &&
+                 (!next || !xaccSplitSameGroup (split, next, secondary)))
+            group_break = 1;
+        result = scm_cons (scm_from_int (group_break), result);
+    }
+    g_list_free (splits);
+    return scm_reverse_x (result, SCM_EOL);
+}
+%}
+
 %typemap(in) GList * {
   SCM path_scm = $input;
   GList *path = NULL;
@@ -327,6 +474,16 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("CLEARED-RECONCILED");
     SET_ENUM("CLEARED-VOIDED");
 
+    SET_ENUM("SPLIT-GROUP-NONE");
+    SET_ENUM("SPLIT-GROUP-ACCOUNT-NAME");
+    SET_ENUM("SPLIT-GROUP-ACCOUNT-CODE");
+    SET_ENUM("SPLIT-GROUP-OTHER-ACCOUNT-NAME");
+    SET_ENUM("SPLIT-GROUP-OTHER-ACCOUNT-CODE");
+    SET_ENUM("SPLIT-GROUP-WEEK");
+    SET_ENUM("SPLIT-GROUP-MONTH");
+    SET_ENUM("SPLIT-GROUP-QUARTER");
+    SET_ENUM("SPLIT-GROUP-YEAR");
+
     SET_ENUM("HOOK-REPORT");
     SET_ENUM("HOOK-SAVE-OPTIONS");
 
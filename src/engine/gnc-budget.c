@@ -72,8 +72,20 @@ typedef struct BudgetPrivate
 
     /* Number of periods */
     guint  num_periods;
+
+    /* Dense copy of the per-account period amounts kept in the KVP
+     * frame, keyed by account GUID and filled in on first use. */
+    GHashTable *acct_values;
 } BudgetPrivate;
 
+/* One account's amounts: num_periods cells, read from and written
+ * through to the "guid/period" KVP slots. */
+typedef struct
+{
+    gnc_numeric value;
+    gboolean    is_set;
+} BudgetPeriodValue;
+
 #define GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE((o), GNC_TYPE_BUDGET, BudgetPrivate))
 
@@ -96,6 +108,9 @@ gnc_budget_init(GncBudget* budget)
     priv->description = CACHE_INSERT("");
 
     priv->num_periods = 12;
+    priv->acct_values = g_hash_table_new_full (guid_hash_to_guint,
+                                               guid_g_hash_table_equal,
+                                               (GDestroyNotify)guid_free, g_free);
     gnc_gdate_set_today (&date);
     g_date_subtract_days(&date, g_date_get_day(&date) - 1);
     recurrenceSet(&priv->recurrence, 1, PERIOD_MONTH, &date, WEEKEND_ADJ_NONE);
@@ -110,6 +125,9 @@ gnc_budget_dispose (GObject *budgetp)
 static void
 gnc_budget_finalize(GObject* budgetp)
 {
+    BudgetPrivate* priv = GET_PRIVATE(budgetp);
+
+    g_hash_table_destroy (priv->acct_values);
     G_OBJECT_CLASS(gnc_budget_parent_class)->finalize(budgetp);
 }
 
@@ -460,6 +478,8 @@ gnc_budget_set_num_periods(GncBudget* budget, guint num_periods)
 
     gnc_budget_begin_edit(budget);
     priv->num_periods = num_periods;
+    /* The cached arrays are sized by the old period count. */
+    g_hash_table_remove_all (priv->acct_values);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -485,6 +505,35 @@ make_period_path (const Account *account, guint period_num, char *path)
     bufend = guid_to_string_buff(guid, path);
     g_sprintf(bufend, "/%d", period_num);
 }
+
+/* Return the cached amounts for account, loading them from the KVP
+ * frame the first time the account is asked for. */
+static BudgetPeriodValue *
+get_account_values (const GncBudget *budget, const Account *account)
+{
+    BudgetPrivate *priv = GET_PRIVATE(budget);
+    const GncGUID *guid = xaccAccountGetGUID(account);
+    BudgetPeriodValue *values;
+    gchar path[BUF_SIZE];
+    guint i;
+
+    values = g_hash_table_lookup (priv->acct_values, guid);
+    if (values)
+        return values;
+
+    values = g_new0 (BudgetPeriodValue, MAX (priv->num_periods, 1));
+    for (i = 0; i < priv->num_periods; ++i)
+    {
+        make_period_path (account, i, path);
+        values[i].value = gnc_numeric_zero ();
+        values[i].is_set =
+            qof_instance_kvp_get_numeric (QOF_INSTANCE (budget), path,
+                                          &values[i].value);
+    }
+    g_hash_table_insert (priv->acct_values, guid_copy (guid), values);
+    return values;
+}
+
 /* period_num is zero-based */
 /* What happens when account is deleted, after we have an entry for it? */
 void
@@ -499,6 +548,12 @@ gnc_budget_unset_account_period_value(GncBudget *budget, const Account *account,
 
     gnc_budget_begin_edit(budget);
     qof_instance_set_kvp (QOF_INSTANCE (budget), path, NULL);
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+    {
+        BudgetPeriodValue *values = get_account_values (budget, account);
+        values[period_num].value = gnc_numeric_zero ();
+        values[period_num].is_set = FALSE;
+    }
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -513,6 +568,7 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
                                     guint period_num, gnc_numeric val)
 {
     gchar path[BUF_SIZE];
+    BudgetPeriodValue *values;
 
     /* Watch out for an off-by-one error here:
      * period_num starts from 0 while num_periods starts from 1 */
@@ -526,16 +582,24 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
     g_return_if_fail (account != NULL);
 
     make_period_path (account, period_num, path);
+    values = get_account_values (budget, account);
 
     gnc_budget_begin_edit(budget);
     if (gnc_numeric_check(val))
+    {
         qof_instance_set_kvp (QOF_INSTANCE (budget), path, NULL);
+        values[period_num].value = gnc_numeric_zero ();
+        values[period_num].is_set = FALSE;
+    }
     else
     {
         GValue v = G_VALUE_INIT;
         g_value_init (&v, GNC_TYPE_NUMERIC);
         g_value_set_boxed (&v, &val);
         qof_instance_set_kvp (QOF_INSTANCE (budget), path, &v);
+        g_value_unset (&v);
+        values[period_num].value = val;
+        values[period_num].is_set = TRUE;
     }
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
@@ -552,18 +616,16 @@ gnc_budget_is_account_period_value_set(const GncBudget *budget,
                                        const Account *account,
                                        guint period_num)
 {
-    GValue v = G_VALUE_INIT;
     gchar path[BUF_SIZE];
-    gconstpointer ptr = NULL;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), FALSE);
     g_return_val_if_fail(account, FALSE);
 
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+        return get_account_values (budget, account)[period_num].is_set;
+
     make_period_path (account, period_num, path);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), path, &v);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        ptr = g_value_get_boxed (&v);
-    return (ptr != NULL);
+    return qof_instance_kvp_get_numeric (QOF_INSTANCE (budget), path, NULL);
 }
 
 gnc_numeric
@@ -571,21 +633,18 @@ gnc_budget_get_account_period_value(const GncBudget *budget,
                                     const Account *account,
                                     guint period_num)
 {
-    gnc_numeric *numeric = NULL;
+    gnc_numeric numeric = gnc_numeric_zero();
     gchar path[BUF_SIZE];
-    GValue v = G_VALUE_INIT;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), gnc_numeric_zero());
     g_return_val_if_fail(account, gnc_numeric_zero());
 
-    make_period_path (account, period_num, path);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), path, &v);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        numeric = (gnc_numeric*)g_value_get_boxed (&v);
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+        return get_account_values (budget, account)[period_num].value;
 
-    if (numeric)
-        return *numeric;
-    return gnc_numeric_zero();
+    make_period_path (account, period_num, path);
+    qof_instance_kvp_get_numeric (QOF_INSTANCE (budget), path, &numeric);
+    return numeric;
 }
 
 
@@ -620,6 +679,33 @@ gnc_budget_get_account_period_actual_value(
                                            acc, period_num);
 }
 
+gnc_numeric *
+gnc_budget_get_account_period_actual_values(const GncBudget *budget,
+                                            Account *acc)
+{
+    const Recurrence *r;
+    gnc_numeric *values;
+    time64 *starts, *ends;
+    guint i, n;
+
+    g_return_val_if_fail(GNC_IS_BUDGET(budget) && acc, NULL);
+
+    r = &GET_PRIVATE(budget)->recurrence;
+    n = GET_PRIVATE(budget)->num_periods;
+    starts = g_new (time64, n ? n : 1);
+    ends = g_new (time64, n ? n : 1);
+    for (i = 0; i < n; ++i)
+    {
+        starts[i] = recurrenceGetPeriodTime(r, i, FALSE);
+        ends[i] = recurrenceGetPeriodTime(r, i, TRUE);
+    }
+    values = xaccAccountGetBalanceChangesForPeriods (acc, starts, ends, n,
+                                                     TRUE);
+    g_free (starts);
+    g_free (ends);
+    return values;
+}
+
 GncBudget*
 gnc_budget_lookup (const GncGUID *guid, const QofBook *book)
 {
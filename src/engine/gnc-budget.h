@@ -149,6 +149,11 @@ gnc_numeric gnc_budget_get_account_period_value(
     const GncBudget *budget, const Account *account, guint period_num);
 gnc_numeric gnc_budget_get_account_period_actual_value(
     const GncBudget *budget, Account *account, guint period_num);
+/** The actual value of every period of the budget for the account,
+ *  from one pass over its splits.  Returns a newly allocated array of
+ *  gnc_budget_get_num_periods() values; g_free it. */
+gnc_numeric *gnc_budget_get_account_period_actual_values(
+    const GncBudget *budget, Account *account);
 
 /* Returns some budget in the book, or NULL. */
 GncBudget* gnc_budget_get_default(QofBook *book);
@@ -119,6 +119,7 @@ struct gnc_commodity_table_s
 {
     GHashTable * ns_table;
     GList      * ns_list;
+    GHashTable * commodity_index;
 };
 
 struct gnc_new_iso_code
@@ -143,6 +144,17 @@ struct gnc_new_iso_code
 #define GNC_NEW_ISO_CODES \
         (sizeof(gnc_new_iso_codes) / sizeof(struct gnc_new_iso_code))
 
+/* The commodity index of a table maps each namespace and mnemonic to
+ * its commodity, so a lookup is a single hash probe.  The old ISO codes
+ * above are folded in when a currency is inserted: they are indexed as
+ * aliases of the currency with the new code, and a currency still using
+ * an old code isn't indexed at all, since lookups never find it. */
+typedef struct
+{
+    const char *name_space;
+    const char *mnemonic;
+} CommodityIndexKey;
+
 static gboolean fq_is_installed = FALSE;
 
 struct gnc_quote_source_s
@@ -1709,12 +1721,129 @@ gnc_commodity_table_map_namespace(const char * name_space)
  * make a new commodity table
  ********************************************************************/
 
+static guint
+commodity_index_hash (gconstpointer key)
+{
+    const CommodityIndexKey *k = key;
+    return g_str_hash (k->name_space) * 33 + g_str_hash (k->mnemonic);
+}
+
+static gboolean
+commodity_index_equal (gconstpointer a, gconstpointer b)
+{
+    const CommodityIndexKey *ka = a, *kb = b;
+    return strcmp (ka->mnemonic, kb->mnemonic) == 0 &&
+           strcmp (ka->name_space, kb->name_space) == 0;
+}
+
+static void
+commodity_index_key_free (gpointer data)
+{
+    CommodityIndexKey *key = data;
+    CACHE_REMOVE (key->name_space);
+    CACHE_REMOVE (key->mnemonic);
+    g_free (key);
+}
+
+static void
+commodity_index_insert (gnc_commodity_table *table, const char *name_space,
+                        const char *mnemonic, gnc_commodity *comm)
+{
+    CommodityIndexKey *key = g_new (CommodityIndexKey, 1);
+    key->name_space = CACHE_INSERT (name_space);
+    key->mnemonic = CACHE_INSERT (mnemonic);
+    g_hash_table_insert (table->commodity_index, key, comm);
+}
+
+static void
+commodity_index_remove (gnc_commodity_table *table, const char *name_space,
+                        const char *mnemonic, const gnc_commodity *comm)
+{
+    CommodityIndexKey key;
+    key.name_space = name_space;
+    key.mnemonic = mnemonic;
+    if (g_hash_table_lookup (table->commodity_index, &key) == comm)
+        g_hash_table_remove (table->commodity_index, &key);
+}
+
+/* Calls func for each key under which a commodity with this mnemonic
+ * is indexed in nsp. */
+static void
+commodity_index_foreach_key (const gnc_commodity_namespace *nsp,
+                             const char *mnemonic,
+                             void (*func)(const char *name_space,
+                                          const char *mnemonic,
+                                          gpointer data),
+                             gpointer data)
+{
+    guint i;
+
+    if (!mnemonic) return;
+    if (nsp->iso4217)
+    {
+        for (i = 0; i < GNC_NEW_ISO_CODES; i++)
+            if (strcmp (mnemonic, gnc_new_iso_codes[i].old_code) == 0)
+                return;
+        for (i = 0; i < GNC_NEW_ISO_CODES; i++)
+            if (strcmp (mnemonic, gnc_new_iso_codes[i].new_code) == 0)
+                func (nsp->name, gnc_new_iso_codes[i].old_code, data);
+    }
+    func (nsp->name, mnemonic, data);
+}
+
+typedef struct
+{
+    gnc_commodity_table *table;
+    gnc_commodity *comm;
+} CommodityIndexData;
+
+static void
+commodity_index_insert_key (const char *name_space, const char *mnemonic,
+                            gpointer data)
+{
+    CommodityIndexData *index_data = data;
+    commodity_index_insert (index_data->table, name_space, mnemonic,
+                            index_data->comm);
+}
+
+static void
+commodity_index_remove_key (const char *name_space, const char *mnemonic,
+                            gpointer data)
+{
+    CommodityIndexData *index_data = data;
+    commodity_index_remove (index_data->table, name_space, mnemonic,
+                            index_data->comm);
+}
+
+static void
+commodity_index_add (gnc_commodity_table *table,
+                     const gnc_commodity_namespace *nsp,
+                     const char *mnemonic, gnc_commodity *comm)
+{
+    CommodityIndexData data = { table, comm };
+    commodity_index_foreach_key (nsp, mnemonic, commodity_index_insert_key,
+                                 &data);
+}
+
+static void
+commodity_index_drop (gnc_commodity_table *table,
+                      const gnc_commodity_namespace *nsp,
+                      const char *mnemonic, gnc_commodity *comm)
+{
+    CommodityIndexData data = { table, comm };
+    commodity_index_foreach_key (nsp, mnemonic, commodity_index_remove_key,
+                                 &data);
+}
+
 gnc_commodity_table *
 gnc_commodity_table_new(void)
 {
     gnc_commodity_table * retval = g_new0(gnc_commodity_table, 1);
     retval->ns_table = g_hash_table_new(&g_str_hash, &g_str_equal);
     retval->ns_list = NULL;
+    retval->commodity_index =
+        g_hash_table_new_full (commodity_index_hash, commodity_index_equal,
+                               commodity_index_key_free, NULL);
     return retval;
 }
 
@@ -1793,36 +1922,15 @@ gnc_commodity *
 gnc_commodity_table_lookup(const gnc_commodity_table * table,
                            const char * name_space, const char * mnemonic)
 {
-    gnc_commodity_namespace * nsp = NULL;
-    unsigned int i;
+    CommodityIndexKey key;
 
     if (!table || !name_space || !mnemonic) return NULL;
 
-    nsp = gnc_commodity_table_find_namespace(table, name_space);
-
-    if (nsp)
-    {
-        /*
-         * Backward compatability support for currencies that have
-         * recently changed.
-         */
-        if (nsp->iso4217)
-        {
-            for (i = 0; i < GNC_NEW_ISO_CODES; i++)
-            {
-                if (strcmp(mnemonic, gnc_new_iso_codes[i].old_code) == 0)
-                {
-                    mnemonic = gnc_new_iso_codes[i].new_code;
-                    break;
-                }
-            }
-        }
-        return g_hash_table_lookup(nsp->cm_table, (gpointer)mnemonic);
-    }
-    else
-    {
-        return NULL;
-    }
+    /* Backward compatability support for currencies that have recently
+     * changed is folded into the index, see commodity_index_foreach_key. */
+    key.name_space = gnc_commodity_table_map_namespace(name_space);
+    key.mnemonic = mnemonic;
+    return g_hash_table_lookup(table->commodity_index, &key);
 }
 
 /********************************************************************
@@ -1968,6 +2076,7 @@ gnc_commodity_table_insert(gnc_commodity_table * table,
                         CACHE_INSERT(priv->mnemonic),
                         (gpointer)comm);
     nsp->cm_list = g_list_append(nsp->cm_list, comm);
+    commodity_index_add (table, nsp, priv->mnemonic, comm);
 
     qof_event_gen (&comm->inst, QOF_EVENT_ADD, NULL);
     LEAVE ("(table=%p, comm=%p)", table, comm);
@@ -2003,6 +2112,7 @@ gnc_commodity_table_remove(gnc_commodity_table * table,
 
     nsp->cm_list = g_list_remove(nsp->cm_list, comm);
     g_hash_table_remove (nsp->cm_table, priv->mnemonic);
+    commodity_index_drop (table, nsp, priv->mnemonic, comm);
     /* XXX minor mem leak, should remove the key as well */
 }
 
@@ -2294,10 +2404,19 @@ gnc_commodity_find_commodity_by_guid(const GncGUID *guid, QofBook *book)
  * delete a namespace
  ********************************************************************/
 
+typedef struct
+{
+    gnc_commodity_table *table;
+    gnc_commodity_namespace *ns;
+} NsHelperData;
+
 static int
 ns_helper(gpointer key, gpointer value, gpointer user_data)
 {
     gnc_commodity * c = value;
+    NsHelperData *data = user_data;
+
+    commodity_index_drop (data->table, data->ns, key, c);
     gnc_commodity_destroy(c);
     CACHE_REMOVE(key);  /* key is commodity mnemonic */
     return TRUE;
@@ -2308,6 +2427,7 @@ gnc_commodity_table_delete_namespace(gnc_commodity_table * table,
                                      const char * name_space)
 {
     gnc_commodity_namespace * ns;
+    NsHelperData data;
 
     if (!table) return;
 
@@ -2322,7 +2442,9 @@ gnc_commodity_table_delete_namespace(gnc_commodity_table * table,
     g_list_free(ns->cm_list);
     ns->cm_list = NULL;
 
-    g_hash_table_foreach_remove(ns->cm_table, ns_helper, NULL);
+    data.table = table;
+    data.ns = ns;
+    g_hash_table_foreach_remove(ns->cm_table, ns_helper, &data);
     g_hash_table_destroy(ns->cm_table);
     CACHE_REMOVE(ns->name);
 
@@ -2406,6 +2528,8 @@ gnc_commodity_table_destroy(gnc_commodity_table * t)
     t->ns_list = NULL;
     g_hash_table_destroy(t->ns_table);
     t->ns_table = NULL;
+    g_hash_table_destroy(t->commodity_index);
+    t->commodity_index = NULL;
     g_free(t);
     LEAVE ("table=%p", t);
 }
@@ -2607,4 +2731,121 @@ gnc_monetary_list_free(MonetaryList *list)
     g_list_free(list);
 }
 
+/********************************************************************
+ * Commodity collectors
+ ********************************************************************/
+
+struct gnc_commodity_collector_s
+{
+    GHashTable *totals;         /* gnc_commodity* -> gnc_numeric* */
+    CommodityList *commodities; /* most recently seen first */
+};
+
+GncCommodityCollector *
+gnc_commodity_collector_new (void)
+{
+    GncCommodityCollector *collector = g_new0 (GncCommodityCollector, 1);
+
+    collector->totals = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                               NULL, g_free);
+    return collector;
+}
+
+void
+gnc_commodity_collector_destroy (GncCommodityCollector *collector)
+{
+    if (!collector) return;
+    g_hash_table_destroy (collector->totals);
+    g_list_free (collector->commodities);
+    g_free (collector);
+}
+
+void
+gnc_commodity_collector_add_amount (GncCommodityCollector *collector,
+                                    gnc_commodity *commodity,
+                                    gnc_numeric amount)
+{
+    gnc_numeric *total;
+
+    g_return_if_fail (collector);
+
+    total = g_hash_table_lookup (collector->totals, commodity);
+    if (!total)
+    {
+        total = g_new (gnc_numeric, 1);
+        *total = gnc_numeric_zero ();
+        g_hash_table_insert (collector->totals, commodity, total);
+        collector->commodities = g_list_prepend (collector->commodities,
+                                                 commodity);
+    }
+    *total = gnc_numeric_add (amount, *total, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+}
+
+static void
+commodity_collector_merge (GncCommodityCollector *collector,
+                           const GncCommodityCollector *other,
+                           gboolean negate)
+{
+    GList *node;
+
+    g_return_if_fail (collector && other);
+
+    for (node = other->commodities; node; node = node->next)
+    {
+        gnc_numeric *total = g_hash_table_lookup (other->totals, node->data);
+        gnc_commodity_collector_add_amount (collector, node->data,
+                                            negate ? gnc_numeric_neg (*total)
+                                            : *total);
+    }
+}
+
+void
+gnc_commodity_collector_add_collector (GncCommodityCollector *collector,
+                                       const GncCommodityCollector *other)
+{
+    commodity_collector_merge (collector, other, FALSE);
+}
+
+void
+gnc_commodity_collector_subtract_collector (GncCommodityCollector *collector,
+                                            const GncCommodityCollector *other)
+{
+    commodity_collector_merge (collector, other, TRUE);
+}
+
+void
+gnc_commodity_collector_reset (GncCommodityCollector *collector)
+{
+    g_return_if_fail (collector);
+    g_hash_table_remove_all (collector->totals);
+    g_list_free (collector->commodities);
+    collector->commodities = NULL;
+}
+
+guint
+gnc_commodity_collector_get_n_commodities (const GncCommodityCollector *collector)
+{
+    g_return_val_if_fail (collector, 0);
+    return g_hash_table_size (collector->totals);
+}
+
+gnc_numeric
+gnc_commodity_collector_get_amount (const GncCommodityCollector *collector,
+                                    const gnc_commodity *commodity)
+{
+    gnc_numeric *total;
+
+    g_return_val_if_fail (collector, gnc_numeric_zero ());
+
+    total = g_hash_table_lookup (collector->totals, commodity);
+    return total ? *total : gnc_numeric_zero ();
+}
+
+CommodityList *
+gnc_commodity_collector_get_commodities (const GncCommodityCollector *collector)
+{
+    g_return_val_if_fail (collector, NULL);
+    return g_list_copy (collector->commodities);
+}
+
 /* ========================= END OF FILE ============================== */
@@ -1049,6 +1049,45 @@ MonetaryList *gnc_monetary_list_delete_zeros(MonetaryList *list);
 void gnc_monetary_list_free(MonetaryList *list);
 /** @} */
 
+/** @name Commodity collectors
+
+  A commodity collector accumulates amounts in any number of
+  commodities, one total per commodity.  It is meant for code such as
+  reports that adds up many amounts.
+@{
+*/
+typedef struct gnc_commodity_collector_s GncCommodityCollector;
+
+GncCommodityCollector *gnc_commodity_collector_new (void);
+void gnc_commodity_collector_destroy (GncCommodityCollector *collector);
+
+/** Add an amount to the total of its commodity. */
+void gnc_commodity_collector_add_amount (GncCommodityCollector *collector,
+                                         gnc_commodity *commodity,
+                                         gnc_numeric amount);
+
+/** Add (or, for the subtract variant, subtract) all the totals of
+ *  another collector. */
+void gnc_commodity_collector_add_collector (GncCommodityCollector *collector,
+                                            const GncCommodityCollector *other);
+void gnc_commodity_collector_subtract_collector (GncCommodityCollector *collector,
+                                                 const GncCommodityCollector *other);
+
+/** Forget all totals, including which commodities were seen. */
+void gnc_commodity_collector_reset (GncCommodityCollector *collector);
+
+/** @return The number of commodities with a total. */
+guint gnc_commodity_collector_get_n_commodities (const GncCommodityCollector *collector);
+
+/** @return The total for the commodity, zero if none was added. */
+gnc_numeric gnc_commodity_collector_get_amount (const GncCommodityCollector *collector,
+                                                const gnc_commodity *commodity);
+
+/** @return A newly allocated list of the commodities with a total, the
+ *  most recently seen first.  Free it with g_list_free(). */
+CommodityList *gnc_commodity_collector_get_commodities (const GncCommodityCollector *collector);
+/** @} */
+
 /** @} */
 
 #endif /* GNC_COMMODITY_H */
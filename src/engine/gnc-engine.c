@@ -33,6 +33,7 @@
 #include "TransactionP.h"
 #include "gnc-commodity.h"
 #include "gnc-pricedb-p.h"
+#include "gnc-lot.h"
 
 /** gnc file backend library name */
 #define GNC_LIB_NAME "gncmod-backend-xml"
@@ -207,3 +208,55 @@ gnc_engine_signal_commit_error( QofBackendError errcode )
         (*g_error_cb)( g_error_cb_data, errcode );
     }
 }
+
+/********************************************************************
+ * gnc_book_get_memory_usage
+ * add the engine's lists to the book's memory usage
+ ********************************************************************/
+
+static void
+count_trans_splits (QofInstance *inst, gpointer data)
+{
+    *(gint64*)data += xaccTransCountSplits (GNC_TRANSACTION (inst));
+}
+
+static void
+count_lot_splits (QofInstance *inst, gpointer data)
+{
+    *(gint64*)data += gnc_lot_count_splits (GNC_LOT (inst));
+}
+
+static GList *
+append_list_usage (GList *usage, const char *category, gint64 nodes)
+{
+    return qof_memory_usage_append (usage, category, nodes,
+                                    nodes * sizeof (GList));
+}
+
+GList *
+gnc_book_get_memory_usage (QofBook *book)
+{
+    GList *usage;
+    Account *root;
+    gint64 nodes = 0;
+
+    g_return_val_if_fail (book, NULL);
+
+    usage = qof_book_get_memory_usage (book);
+
+    root = gnc_book_get_root_account (book);
+    if (root)
+        usage = gnc_account_tree_get_memory_usage (root, usage);
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            count_trans_splits, &nodes);
+    usage = append_list_usage (usage, "Transaction split lists", nodes);
+    nodes = 0;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_LOT),
+                            count_lot_splits, &nodes);
+    usage = append_list_usage (usage, "Lot split lists", nodes);
+
+    /* Every price sits in one list of the commodity/currency tables. */
+    return append_list_usage (usage, "Price lists",
+                              gnc_pricedb_get_num_prices (gnc_pricedb_get_db (book)));
+}
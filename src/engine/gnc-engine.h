@@ -251,6 +251,13 @@ void gnc_engine_add_commit_error_callback( EngineCommitErrorCallback cb, gpointe
 
 void gnc_engine_signal_commit_error( QofBackendError errcode );
 
+/** Returns qof_book_get_memory_usage() with the engine's own
+ * containers added: the accounts' split and child lists, split arrays,
+ * split node and open lot tables and the name and code indexes, the
+ * transactions' and lots' split lists and the price database's lists.
+ * Free it with qof_memory_usage_free(). */
+GList *gnc_book_get_memory_usage (QofBook *book);
+
 /** STRING CONSTANTS **********************************************
  * Used to declare constant KVP keys used in more than one class
  */
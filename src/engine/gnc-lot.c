@@ -90,6 +90,12 @@ typedef struct LotPrivate
     signed char is_closed;
 #define LOT_CLOSED_UNKNOWN (-1)
 
+    /* Cached sum of the split amounts, valid when balance_valid is set.
+     * Adding, removing and re-pricing splits adjust it in place; each
+     * split's lot_amount records what it contributed. */
+    gnc_numeric balance;
+    gboolean balance_valid;
+
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
 } LotPrivate;
@@ -118,6 +124,8 @@ gnc_lot_init(GNCLot* lot)
     priv->account = NULL;
     priv->splits = NULL;
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    priv->balance = gnc_numeric_zero();
+    priv->balance_valid = FALSE;
     priv->marker = 0;
 }
 
@@ -191,7 +199,7 @@ gnc_lot_set_property (GObject* object,
     switch (prop_id)
     {
     case PROP_IS_CLOSED:
-        priv->is_closed = g_value_get_int(value);
+        gnc_lot_set_is_closed (lot, priv, g_value_get_int(value));
         break;
     case PROP_MARKER:
         priv->marker = g_value_get_int(value);
@@ -273,6 +281,19 @@ gnc_lot_class_init(GNCLotClass* klass)
                            G_PARAM_READWRITE));
 }
 
+/* Change the cached closed state, telling the account whenever the lot
+ * moves into or out of the known-closed state so its open-lot index
+ * stays current. */
+static void
+gnc_lot_set_is_closed (GNCLot *lot, LotPrivate *priv, signed char is_closed)
+{
+    gboolean was_closed = (priv->is_closed == TRUE);
+
+    priv->is_closed = is_closed;
+    if (priv->account && was_closed != (is_closed == TRUE))
+        gnc_account_set_lot_closed (priv->account, lot, is_closed == TRUE);
+}
+
 GNCLot *
 gnc_lot_new (QofBook *book)
 {
@@ -299,10 +320,15 @@ gnc_lot_free(GNCLot* lot)
     for (node = priv->splits; node; node = node->next)
     {
         Split *s = node->data;
+        xaccTransSnapshotSplit (s->parent, s);
         s->lot = NULL;
     }
     g_list_free (priv->splits);
 
+    /* Don't leave the lot in its account's open-lot index; during
+     * shutdown the account may already be gone. */
+    if (priv->account && !qof_book_shutting_down (qof_instance_get_book (lot)))
+        gnc_account_set_lot_closed (priv->account, lot, TRUE);
     priv->account = NULL;
     priv->is_closed = TRUE;
     /* qof_instance_release (&lot->inst); */
@@ -407,8 +433,52 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     if (lot != NULL)
     {
         priv = GET_PRIVATE(lot);
-        priv->is_closed = LOT_CLOSED_UNKNOWN;
+        priv->balance_valid = FALSE;
+        gnc_lot_set_is_closed (lot, priv, LOT_CLOSED_UNKNOWN);
+    }
+}
+
+/* Fold a change of the cached balance into the closed state; if the
+ * sum can't be kept exactly, fall back to a full recomputation. */
+static void
+gnc_lot_adjust_balance (GNCLot *lot, LotPrivate *priv, gnc_numeric delta)
+{
+    if (!priv->balance_valid)
+    {
+        gnc_lot_set_is_closed (lot, priv, LOT_CLOSED_UNKNOWN);
+        return;
     }
+    priv->balance = gnc_numeric_add_fixed (priv->balance, delta);
+    if (gnc_numeric_check (priv->balance) != GNC_ERROR_OK)
+    {
+        priv->balance_valid = FALSE;
+        gnc_lot_set_is_closed (lot, priv, LOT_CLOSED_UNKNOWN);
+        return;
+    }
+    gnc_lot_set_is_closed (lot, priv, priv->splits != NULL &&
+                           gnc_numeric_zero_p (priv->balance));
+}
+
+void
+gnc_lot_update_split_amount (GNCLot *lot, Split *split)
+{
+    LotPrivate* priv;
+    gnc_numeric delta;
+
+    if (!lot || !split) return;
+    priv = GET_PRIVATE(lot);
+
+    if (!priv->balance_valid)
+    {
+        gnc_lot_set_is_closed (lot, priv, LOT_CLOSED_UNKNOWN);
+        return;
+    }
+    if (gnc_numeric_equal (split->amount, split->lot_amount))
+        return;
+
+    delta = gnc_numeric_sub_fixed (split->amount, split->lot_amount);
+    split->lot_amount = split->amount;
+    gnc_lot_adjust_balance (lot, priv, delta);
 }
 
 SplitList *
@@ -493,9 +563,13 @@ gnc_lot_get_balance (GNCLot *lot)
     priv = GET_PRIVATE(lot);
     if (!priv->splits)
     {
-        priv->is_closed = FALSE;
+        priv->balance = zero;
+        priv->balance_valid = TRUE;
+        gnc_lot_set_is_closed (lot, priv, FALSE);
         return zero;
     }
+    if (priv->balance_valid)
+        return priv->balance;
 
     /* Sum over splits; because they all belong to same account
      * they will have same denominator.
@@ -506,17 +580,13 @@ gnc_lot_get_balance (GNCLot *lot)
         gnc_numeric amt = xaccSplitGetAmount (s);
         baln = gnc_numeric_add_fixed (baln, amt);
         g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+        s->lot_amount = amt;
     }
+    priv->balance = baln;
+    priv->balance_valid = TRUE;
 
     /* cache a zero balance as a closed lot */
-    if (gnc_numeric_equal (baln, zero))
-    {
-        priv->is_closed = TRUE;
-    }
-    else
-    {
-        priv->is_closed = FALSE;
-    }
+    gnc_lot_set_is_closed (lot, priv, gnc_numeric_equal (baln, zero));
 
     return baln;
 }
@@ -617,8 +687,8 @@ gnc_lot_add_split (GNCLot *lot, Split *split)
 
     priv->splits = g_list_append (priv->splits, split);
 
-    /* for recomputation of is-closed */
-    priv->is_closed = LOT_CLOSED_UNKNOWN;
+    split->lot_amount = split->amount;
+    gnc_lot_adjust_balance (lot, priv, split->amount);
     gnc_lot_commit_edit(lot);
 
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -637,7 +707,7 @@ gnc_lot_remove_split (GNCLot *lot, Split *split)
     qof_instance_set_dirty(QOF_INSTANCE(lot));
     priv->splits = g_list_remove (priv->splits, split);
     xaccSplitSetLot(split, NULL);
-    priv->is_closed = LOT_CLOSED_UNKNOWN;   /* force an is-closed computation */
+    gnc_lot_adjust_balance (lot, priv, gnc_numeric_neg (split->lot_amount));
 
     if (NULL == priv->splits)
     {
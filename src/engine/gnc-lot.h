@@ -159,6 +159,10 @@ Split * gnc_lot_get_latest_split (GNCLot *lot);
 /** Reset closed flag so that it will be recalculated. */
 void gnc_lot_set_closed_unknown(GNCLot*);
 
+/** Apply a change of the split's amount to the lot's cached balance and
+ *  closed flag.  Called from the split code whenever a split changes. */
+void gnc_lot_update_split_amount(GNCLot *lot, Split *split);
+
 /** Get and set the account title, or the account notes, or the marker. */
 const char * gnc_lot_get_title (const GNCLot *);
 const char * gnc_lot_get_notes (const GNCLot *);
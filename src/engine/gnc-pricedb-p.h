@@ -30,6 +30,9 @@
 #include "gnc-engine.h"
 #include "gnc-pricedb.h"
 
+/* A pricedb can hold millions of these, so the fields are ordered to
+ * leave no padding on 64-bit platforms; keep it that way when adding
+ * any. */
 struct gnc_price_s
 {
     /* 'public' data fields */
@@ -39,9 +42,9 @@ struct gnc_price_s
     gnc_commodity *commodity;
     gnc_commodity *currency;
     Timespec tmspec;
-    PriceSource source;
-    char *type;
     gnc_numeric value;
+    char *type;                    /* shared through the string cache */
+    PriceSource source;
 
     /* 'private' object management fields */
     guint32  refcount;             /* garbage collection reference count */
@@ -57,6 +60,22 @@ struct gnc_price_db_s
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
+    guint generation;              /* changes when any price is added,
+                                    * removed or edited */
+    /* Conversion graph and the shortest routes found in it so far,
+     * both valid for graph_generation only. */
+    GHashTable *conversion_graph;
+    GHashTable *conversion_routes;
+    guint graph_generation;
+    /* The commodity/currency pairs in the order of stable traversals,
+     * or NULL until they are next needed. */
+    GPtrArray *sorted_pairs;
+    /* Lazy loading, see gnc_pricedb_set_lazy_window(): the pairs whose
+     * prices before lazy_since have been loaded, most recently used
+     * first. */
+    gboolean lazy;
+    Timespec lazy_since;
+    GQueue *lazy_loaded;
 };
 
 struct _GncPriceDBClass
@@ -78,6 +97,20 @@ typedef enum
     LOOKUP_EARLIEST_AFTER
 } PriceLookupType;
 
+/* The request passed to QofBackend's price_lookup.  The only type
+ * used is LOOKUP_ALL, asking the backend to add to prdb all the prices
+ * dated before date that involve commodity, or the pair of commodity
+ * and currency in either order.  A NULL commodity means all prices.
+ * The backend must skip prices that are already loaded. */
+typedef struct gnc_price_lookup_s
+{
+    PriceLookupType type;
+    GNCPriceDB *prdb;
+    const gnc_commodity *commodity;
+    const gnc_commodity *currency;
+    Timespec date;
+} GNCPriceLookup;
+
 typedef struct gnc_price_lookup_helper_s
 {
     GList    **return_list;
@@ -90,6 +123,14 @@ void     gnc_pricedb_substitute_commodity(GNCPriceDB *db,
         gnc_commodity *old_c,
         gnc_commodity *new_c);
 
+/** Put the pricedb in lazy mode, for backends that load it partially.
+ * The backend must have loaded every price dated at or after since and,
+ * for each commodity/currency pair, the newest price before it.  Older
+ * prices are then requested through the backend's price_lookup when a
+ * lookup needs them, and the older prices of pairs not used for a while
+ * are dropped from memory again. */
+void gnc_pricedb_set_lazy_window (GNCPriceDB *db, Timespec since);
+
 /** register the pricedb object with the gncObject system */
 gboolean gnc_pricedb_register (void);
 
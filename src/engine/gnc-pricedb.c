@@ -39,7 +39,7 @@ static GNCPrice *lookup_nearest_in_time(GNCPriceDB *db, const gnc_commodity *c,
                                         Timespec t, gboolean sameday);
 static gboolean
 pricedb_pricelist_traversal(GNCPriceDB *db,
-                            gboolean (*f)(GList *p, gpointer user_data),
+                            gboolean (*f)(GPtrArray *p, gpointer user_data),
                             gpointer user_data);
 
 enum
@@ -53,37 +53,27 @@ enum
     PROP_VALUE,		/* Table, 2 fields (numeric) */
 };
 
+/* An entry of the sorted pair index used for stable traversals. */
 typedef struct
 {
-     gpointer key;
-     gpointer value;
-} HashEntry;
-
-static void
-hash_entry_insert(gpointer key, gpointer val, gpointer user_data)
-{
-    GSList **result = (GSList **) user_data;
-    HashEntry *entry = g_new(HashEntry, 1);
-
-    entry->key = key;
-    entry->value = val;
-    *result = g_slist_prepend(*result, entry);
-}
+    gnc_commodity *commodity;
+    gnc_commodity *currency;
+    GPtrArray *series;
+} PricePair;
 
-static GSList *
-hash_table_to_list(GHashTable *table)
+/* A pair whose prices before the lazy window are loaded, see below. */
+typedef struct
 {
-    GSList *result_list = NULL;
-    g_hash_table_foreach(table, hash_entry_insert, &result_list);
-    return result_list;
-}
+    const gnc_commodity *commodity;
+    const gnc_commodity *currency;  /* NULL for any currency */
+} LazyPair;
 
-static void
-hash_entry_free_gfunc(gpointer data, G_GNUC_UNUSED gpointer user_data)
-{
-    HashEntry *entry = (HashEntry *) data;
-    g_free(entry);
-}
+static void pricedb_pairs_changed (GNCPriceDB *db);
+static GPtrArray *pricedb_get_sorted_pairs (GNCPriceDB *db);
+static void pricedb_lazy_load (GNCPriceDB *db, const gnc_commodity *c,
+                               const gnc_commodity *currency,
+                               const Timespec *t);
+static void conversion_graph_clear (GNCPriceDB *db);
 
 /* GObject Initialization */
 G_DEFINE_TYPE(GNCPrice, gnc_price, QOF_TYPE_INSTANCE);
@@ -449,6 +439,8 @@ static void
 gnc_price_set_dirty (GNCPrice *p)
 {
     qof_instance_set_dirty(&p->inst);
+    if (p->db)
+        p->db->generation++;
     qof_event_gen(&p->inst, QOF_EVENT_MODIFY, NULL);
 }
 
@@ -709,24 +701,30 @@ typedef struct
     gboolean isDupl;
 } PriceListIsDuplStruct;
 
-static void
-price_list_is_duplicate( gpointer data, gpointer user_data )
+static gboolean
+prices_are_duplicates (const GNCPrice *a, const GNCPrice *b)
 {
-    GNCPrice* pPrice = (GNCPrice*)data;
-    PriceListIsDuplStruct* pStruct = (PriceListIsDuplStruct*)user_data;
     Timespec time_a, time_b;
 
-    time_a = timespecCanonicalDayTime( gnc_price_get_time( pPrice ) );
-    time_b = timespecCanonicalDayTime( gnc_price_get_time( pStruct->pPrice ) );
+    time_a = timespecCanonicalDayTime( gnc_price_get_time( a ) );
+    time_b = timespecCanonicalDayTime( gnc_price_get_time( b ) );
 
     /* If the date, currency, commodity and price match, it's a duplicate */
-    if ( !gnc_numeric_equal( gnc_price_get_value( pPrice ),  gnc_price_get_value( pStruct->pPrice ) ) ) return;
-    if ( gnc_price_get_commodity( pPrice ) != gnc_price_get_commodity( pStruct->pPrice ) ) return;
-    if ( gnc_price_get_currency( pPrice ) != gnc_price_get_currency( pStruct->pPrice ) ) return;
+    if ( !gnc_numeric_equal( gnc_price_get_value( a ),  gnc_price_get_value( b ) ) ) return FALSE;
+    if ( gnc_price_get_commodity( a ) != gnc_price_get_commodity( b ) ) return FALSE;
+    if ( gnc_price_get_currency( a ) != gnc_price_get_currency( b ) ) return FALSE;
+
+    return timespec_cmp( &time_a, &time_b ) == 0;
+}
 
-    if ( timespec_cmp( &time_a, &time_b ) != 0 ) return;
+static void
+price_list_is_duplicate( gpointer data, gpointer user_data )
+{
+    GNCPrice* pPrice = (GNCPrice*)data;
+    PriceListIsDuplStruct* pStruct = (PriceListIsDuplStruct*)user_data;
 
-    pStruct->isDupl = TRUE;
+    if ( prices_are_duplicates( pPrice, pStruct->pPrice ) )
+        pStruct->isDupl = TRUE;
 }
 
 gboolean
@@ -818,13 +816,144 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* Price series
+
+   Inside the price DB the prices of one commodity/currency pair are
+   kept in a GPtrArray, in the same newest-first order as a PriceList
+   (see compare_prices_by_date), so that lookups by time can bisect
+   instead of walking a list.  The series holds a reference to each of
+   its prices and is never left empty in the DB.
+ */
+
+/* Returns the index of the first price in the series that is older
+ * than t, or also at t if include_t is set; series->len if there is
+ * no such price. */
+static guint
+price_series_bisect (const GPtrArray *series, Timespec t, gboolean include_t)
+{
+    guint lo = 0, hi = series->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Timespec price_t = gnc_price_get_time (g_ptr_array_index (series, mid));
+        gint cmp = timespec_cmp (&price_t, &t);
+
+        if (cmp > 0 || (cmp == 0 && !include_t))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Returns the index at which p sorts into the series. */
+static guint
+price_series_position (const GPtrArray *series, const GNCPrice *p)
+{
+    guint lo = 0, hi = series->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (compare_prices_by_date (g_ptr_array_index (series, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Prices on the same day are next to each other, so only the
+ * neighbours of p's position have to be checked. */
+static gboolean
+price_series_has_duplicate (const GPtrArray *series, const GNCPrice *p,
+                            guint index)
+{
+    Timespec day = timespecCanonicalDayTime (gnc_price_get_time (p));
+    guint i;
+
+    for (i = index; i < series->len; i++)
+    {
+        GNCPrice *other = g_ptr_array_index (series, i);
+        Timespec other_day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&other_day, &day))
+            break;
+        if (prices_are_duplicates (other, p))
+            return TRUE;
+    }
+    for (i = index; i > 0; i--)
+    {
+        GNCPrice *other = g_ptr_array_index (series, i - 1);
+        Timespec other_day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&other_day, &day))
+            break;
+        if (prices_are_duplicates (other, p))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Adds p to the series, taking a reference.  Returns FALSE and leaves
+ * the series alone if check_dupl is set and p duplicates a price
+ * already in it. */
+static gboolean
+price_series_insert (GPtrArray *series, GNCPrice *p, gboolean check_dupl)
+{
+    guint index = price_series_position (series, p);
+    guint i;
+
+    if (check_dupl && price_series_has_duplicate (series, p, index))
+        return FALSE;
+
+    gnc_price_ref (p);
+    g_ptr_array_add (series, NULL);
+    for (i = series->len - 1; i > index; i--)
+        g_ptr_array_index (series, i) = g_ptr_array_index (series, i - 1);
+    g_ptr_array_index (series, index) = p;
+    return TRUE;
+}
+
+/* Removes p from the series and drops the series' reference to it. */
+static void
+price_series_remove (GPtrArray *series, GNCPrice *p)
+{
+    guint index = price_series_position (series, p);
+
+    if (index >= series->len || g_ptr_array_index (series, index) != p)
+    {
+        /* The price isn't where its date says it should be; look for
+         * it the hard way. */
+        for (index = 0; index < series->len; index++)
+            if (g_ptr_array_index (series, index) == p)
+                break;
+        if (index == series->len)
+            return;
+    }
+    g_ptr_array_remove_index (series, index);
+    gnc_price_unref (p);
+}
+
+/* Returns a PriceList of the series.  The list doesn't hold references
+ * to the prices; free it with g_list_free(). */
+static PriceList *
+price_series_to_list (const GPtrArray *series)
+{
+    PriceList *list = NULL;
+    guint i;
+
+    for (i = series->len; i > 0; i--)
+        list = g_list_prepend (list, g_ptr_array_index (series, i - 1));
+    return list;
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
    Structurally a GNCPriceDB contains a hash mapping price commodities
    (of type gnc_commodity*) to hashes mapping price currencies (of
-   type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
-   description of GNCPrice lists).  The top-level key is the commodity
+   type gnc_commodity*) to price series (see "Price series" above).  The top-level key is the commodity
    you want the prices for, and the second level key is the commodity
    that the value is expressed in terms of.
  */
@@ -885,18 +1014,18 @@ destroy_pricedb_currency_hash_data(gpointer key,
                                    gpointer data,
                                    gpointer user_data)
 {
-    GList *price_list = (GList *) data;
-    GList *node;
-    GNCPrice *p;
+    GPtrArray *series = (GPtrArray *) data;
+    guint i;
 
-    for (node = price_list; node; node = node->next)
+    for (i = 0; i < series->len; i++)
     {
-        p = node->data;
+        GNCPrice *p = g_ptr_array_index (series, i);
 
         p->db = NULL;
+        gnc_price_unref (p);
     }
 
-    gnc_price_list_destroy(price_list);
+    g_ptr_array_free (series, TRUE);
 }
 
 static void
@@ -924,6 +1053,14 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    conversion_graph_clear (db);
+    pricedb_pairs_changed (db);
+    if (db->lazy_loaded)
+    {
+        while (!g_queue_is_empty (db->lazy_loaded))
+            g_slice_free (LazyPair, g_queue_pop_head (db->lazy_loaded));
+        g_queue_free (db->lazy_loaded);
+    }
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1006,7 +1143,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
     GNCPriceDBEqualData *equal_data = user_data;
     gnc_commodity *currency = key;
-    GList *price_list1 = val;
+    GList *price_list1 = price_series_to_list (val);
     GList *price_list2;
 
     price_list2 = gnc_pricedb_get_prices (equal_data->db2,
@@ -1016,6 +1153,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
     if (!gnc_price_list_equal (price_list1, price_list2))
         equal_data->equal = FALSE;
 
+    g_list_free (price_list1);
     gnc_price_list_destroy (price_list2);
 }
 
@@ -1065,7 +1203,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
 {
     /* This function will use p, adding a ref, so treat p as read-only
        if this function succeeds. */
-    GList *price_list;
+    GPtrArray *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1103,6 +1241,28 @@ add_price(GNCPriceDB *db, GNCPrice *p)
         return FALSE;
     }
 
+/* Check for an existing price on the same day. If there is no existing price,
+ * add this one. If this price is of equal or better precedence than the old
+ * one, copy this one over the old one.  This is done before looking up
+ * the series, since removing the old price may remove its series.
+ */
+    if (!db->bulk_update)
+    {
+        old_price = gnc_pricedb_lookup_day (db, p->commodity, p->currency,
+                                            p->tmspec);
+        if (old_price != NULL && old_price != p)
+        {
+            if (p->source > old_price->source)
+            {
+                gnc_price_unref(old_price);
+                LEAVE ("Better price already in DB.");
+                return FALSE;
+            }
+            gnc_pricedb_remove_price(db, old_price);
+        }
+        gnc_price_unref(old_price);
+    }
+
     currency_hash = g_hash_table_lookup(db->commodity_hash, commodity);
     if (!currency_hash)
     {
@@ -1110,37 +1270,20 @@ add_price(GNCPriceDB *db, GNCPrice *p)
         g_hash_table_insert(db->commodity_hash, commodity, currency_hash);
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
-    {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
-    }
-
-    if (!price_list)
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
-        LEAVE (" no price list");
-        return FALSE;
+        series = g_ptr_array_new();
+        g_hash_table_insert(currency_hash, currency, series);
+        pricedb_pairs_changed(db);
     }
-
-/* Check for an existing price on the same day. If there is no existing price,
- * add this one. If this price is of equal or better precedence than the old
- * one, copy this one over the old one.
- */
-    old_price = gnc_pricedb_lookup_day (db, p->commodity, p->currency,
-                                        p->tmspec);
-    if (!db->bulk_update && old_price != NULL)
+    if (!price_series_insert(series, p, !db->bulk_update))
     {
-        if (p->source > old_price->source)
-        {
-            gnc_price_unref(p);
-            LEAVE ("Better price already in DB.");
-            return FALSE;
-        }
-        gnc_pricedb_remove_price(db, old_price);
+        LEAVE ("duplicate price");
+        return TRUE;
     }
-    g_hash_table_insert(currency_hash, currency, price_list);
     p->db = db;
+    db->generation++;
 
     qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
 
@@ -1183,6 +1326,202 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* Batch ingestion, for quote feeds and imports that add many prices at
+ * once.  The new prices of each pair are sorted once and merged into
+ * its series in a single pass, and the pricedb is committed once.
+ */
+
+/* Merges batch, which is sorted like a series, into series from the
+ * old end, taking a reference to each new price. */
+static void
+price_series_merge (GPtrArray *series, const GPtrArray *batch)
+{
+    guint i = series->len, j = batch->len, k;
+
+    g_ptr_array_set_size (series, series->len + batch->len);
+    k = series->len;
+    while (j > 0)
+    {
+        GNCPrice *p = g_ptr_array_index (batch, j - 1);
+        if (i > 0 &&
+                compare_prices_by_date (g_ptr_array_index (series, i - 1), p) > 0)
+        {
+            g_ptr_array_index (series, --k) = g_ptr_array_index (series, --i);
+        }
+        else
+        {
+            gnc_price_ref (p);
+            g_ptr_array_index (series, --k) = p;
+            j--;
+        }
+    }
+}
+
+static gint
+compare_prices_by_pair_and_date (gconstpointer a, gconstpointer b)
+{
+    const GNCPrice *pa = a, *pb = b;
+    guintptr ca = (guintptr) pa->commodity, cb = (guintptr) pb->commodity;
+    guintptr ua = (guintptr) pa->currency, ub = (guintptr) pb->currency;
+
+    if (ca != cb)
+        return ca < cb ? -1 : 1;
+    if (ua != ub)
+        return ua < ub ? -1 : 1;
+    return compare_prices_by_date (a, b);
+}
+
+static gboolean
+price_can_be_added (GNCPriceDB *db, GNCPrice *p)
+{
+    if (p->db == db)
+        return FALSE;
+    if (!qof_instance_books_equal (db, p))
+    {
+        PERR ("attempted to mix up prices across different books");
+        return FALSE;
+    }
+    if (!gnc_price_get_commodity (p) || !gnc_price_get_currency (p))
+    {
+        PWARN ("no commodity or currency");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Applies add_price's same-day rules to a batch of new prices for one
+ * pair, removing the old prices they replace, and drops the new prices
+ * that lose. */
+static void
+price_batch_resolve_same_day (GNCPriceDB *db, GPtrArray *batch)
+{
+    guint i, kept = 0;
+
+    for (i = 0; i < batch->len; i++)
+    {
+        GNCPrice *p = g_ptr_array_index (batch, i);
+
+        if (kept > 0)
+        {
+            GNCPrice *last = g_ptr_array_index (batch, kept - 1);
+            Timespec day = timespecCanonicalDayTime (p->tmspec);
+            Timespec last_day = timespecCanonicalDayTime (last->tmspec);
+            if (timespec_equal (&day, &last_day))
+            {
+                if (p->source < last->source)
+                    g_ptr_array_index (batch, kept - 1) = p;
+                continue;
+            }
+        }
+        g_ptr_array_index (batch, kept++) = p;
+    }
+    g_ptr_array_set_size (batch, kept);
+
+    for (i = 0, kept = 0; i < batch->len; i++)
+    {
+        GNCPrice *p = g_ptr_array_index (batch, i);
+        GNCPrice *old_price = gnc_pricedb_lookup_day (db, p->commodity,
+                                                      p->currency, p->tmspec);
+        if (old_price != NULL)
+        {
+            gboolean better = (p->source > old_price->source);
+            if (!better)
+                gnc_pricedb_remove_price (db, old_price);
+            gnc_price_unref (old_price);
+            if (better)
+                continue;
+        }
+        g_ptr_array_index (batch, kept++) = p;
+    }
+    g_ptr_array_set_size (batch, kept);
+}
+
+guint
+gnc_pricedb_add_prices (GNCPriceDB *db, PriceList *prices)
+{
+    GList *sorted = NULL, *added = NULL, *node;
+    GPtrArray *batch;
+    guint count = 0;
+
+    if (!db || !db->commodity_hash) return 0;
+    ENTER ("db=%p", db);
+
+    for (node = prices; node; node = node->next)
+        if (node->data && price_can_be_added (db, node->data))
+            sorted = g_list_prepend (sorted, node->data);
+    sorted = g_list_sort (sorted, compare_prices_by_pair_and_date);
+
+    qof_event_suspend ();
+    batch = g_ptr_array_new ();
+    node = sorted;
+    while (node)
+    {
+        GNCPrice *first = node->data;
+        GHashTable *currency_hash;
+        GPtrArray *series;
+        guint i;
+
+        g_ptr_array_set_size (batch, 0);
+        for (; node; node = node->next)
+        {
+            GNCPrice *p = node->data;
+            if (p->commodity != first->commodity ||
+                    p->currency != first->currency)
+                break;
+            g_ptr_array_add (batch, p);
+        }
+        if (!db->bulk_update)
+            price_batch_resolve_same_day (db, batch);
+        if (batch->len == 0)
+            continue;
+
+        /* Look the series up only now, since replacing old prices may
+         * have removed it. */
+        currency_hash = g_hash_table_lookup (db->commodity_hash,
+                                             first->commodity);
+        if (!currency_hash)
+        {
+            currency_hash = g_hash_table_new (NULL, NULL);
+            g_hash_table_insert (db->commodity_hash, first->commodity,
+                                 currency_hash);
+        }
+        series = g_hash_table_lookup (currency_hash, first->currency);
+        if (!series)
+        {
+            series = g_ptr_array_new ();
+            g_hash_table_insert (currency_hash, first->currency, series);
+            pricedb_pairs_changed (db);
+        }
+        price_series_merge (series, batch);
+
+        for (i = 0; i < batch->len; i++)
+        {
+            GNCPrice *p = g_ptr_array_index (batch, i);
+            p->db = db;
+            added = g_list_prepend (added, p);
+        }
+        count += batch->len;
+    }
+    g_ptr_array_free (batch, TRUE);
+    g_list_free (sorted);
+
+    if (count > 0)
+    {
+        db->generation++;
+        gnc_pricedb_begin_edit (db);
+        qof_instance_set_dirty (&db->inst);
+        gnc_pricedb_commit_edit (db);
+    }
+    qof_event_resume ();
+
+    if (count > 0)
+        qof_event_gen (&db->inst, QOF_EVENT_MODIFY, added);
+    g_list_free (added);
+    LEAVE ("added %u prices", count);
+    return count;
+}
+
 /* remove_price() is a utility; its only function is to remove the price
  * from the double-hash tables.
  */
@@ -1190,7 +1529,7 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
 {
-    GList *price_list;
+    GPtrArray *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1226,24 +1565,20 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     }
 
     qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
-    price_list = g_hash_table_lookup(currency_hash, currency);
+    db->generation++;
+    series = g_hash_table_lookup(currency_hash, currency);
     gnc_price_ref(p);
-    if (!gnc_price_list_remove(&price_list, p))
-    {
-        gnc_price_unref(p);
-        LEAVE (" cannot remove price list");
-        return FALSE;
-    }
+    if (series)
+        price_series_remove(series, p);
 
-    /* if the price list is empty, then remove this currency from the
+    /* if the price series is empty, then remove this currency from the
        commodity hash */
-    if (price_list)
-    {
-        g_hash_table_insert(currency_hash, currency, price_list);
-    }
-    else
+    if (!series || series->len == 0)
     {
         g_hash_table_remove(currency_hash, currency);
+        if (series)
+            g_ptr_array_free(series, TRUE);
+        pricedb_pairs_changed(db);
 
         if (cleanup)
         {
@@ -1264,6 +1599,153 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     return TRUE;
 }
 
+/* Lazy loading.  In lazy mode only the prices from lazy_since on and
+ * the newest price of each pair before it are known to be loaded; the
+ * older prices are asked for on first use and remembered per pair, or
+ * per commodity for lookups against any currency.  Only the most
+ * recently used PRICEDB_LAZY_MAX_LOADED of those are kept. */
+
+#define PRICEDB_LAZY_MAX_LOADED 32
+
+static gboolean
+lazy_pair_covers (const LazyPair *lp, const gnc_commodity *c,
+                  const gnc_commodity *currency)
+{
+    if (!lp->currency)
+        return c == lp->commodity || currency == lp->commodity;
+    if (!currency)
+        return FALSE;
+    return (c == lp->commodity && currency == lp->currency) ||
+           (c == lp->currency && currency == lp->commodity);
+}
+
+static gboolean
+lazy_pairs_overlap (const LazyPair *a, const LazyPair *b)
+{
+    if (!a->currency)
+        return lazy_pair_covers (a, b->commodity, b->currency);
+    return lazy_pair_covers (b, a->commodity, a->currency);
+}
+
+/* Drops the prices of a series older than its newest one before
+ * lazy_since, unless something besides the series holds them. */
+static void
+pricedb_lazy_trim_series (GNCPriceDB *db, GPtrArray *series)
+{
+    guint index = price_series_bisect (series, db->lazy_since, FALSE);
+    GList *victims = NULL, *node;
+    guint i;
+
+    for (i = index + 1; i < series->len; i++)
+    {
+        GNCPrice *p = g_ptr_array_index (series, i);
+        if (p->refcount == 1)
+            victims = g_list_prepend (victims, p);
+    }
+    for (node = victims; node; node = node->next)
+        remove_price (db, node->data, FALSE);
+    g_list_free (victims);
+}
+
+static void
+pricedb_lazy_evict (GNCPriceDB *db, LazyPair *lp)
+{
+    GPtrArray *pairs;
+    GList *node, *next;
+    guint i;
+
+    /* Removing prices from memory isn't a change anyone needs to hear
+     * about; the prices are still in the database. */
+    qof_event_suspend ();
+    pairs = g_ptr_array_ref (pricedb_get_sorted_pairs (db));
+    for (i = 0; i < pairs->len; i++)
+    {
+        PricePair *pair = g_ptr_array_index (pairs, i);
+        if (lazy_pair_covers (lp, pair->commodity, pair->currency))
+            pricedb_lazy_trim_series (db, pair->series);
+    }
+    g_ptr_array_unref (pairs);
+    qof_event_resume ();
+
+    /* Whatever else was loaded along with these prices is gone too. */
+    for (node = db->lazy_loaded->head; node; node = next)
+    {
+        next = node->next;
+        if (lazy_pairs_overlap (lp, node->data))
+        {
+            g_slice_free (LazyPair, node->data);
+            g_queue_delete_link (db->lazy_loaded, node);
+        }
+    }
+    g_slice_free (LazyPair, lp);
+}
+
+/* Makes sure the prices of commodity c against currency, or against
+ * any currency if that is NULL, are all loaded for a lookup at t, or
+ * for a lookup at any time if t is NULL.  A NULL c loads everything. */
+static void
+pricedb_lazy_load (GNCPriceDB *db, const gnc_commodity *c,
+                   const gnc_commodity *currency, const Timespec *t)
+{
+    QofBackend *be;
+    GNCPriceLookup lookup;
+    LazyPair *lp;
+    GList *node;
+
+    if (!db || !db->lazy) return;
+    if (t && timespec_cmp (t, &db->lazy_since) >= 0) return;
+
+    for (node = db->lazy_loaded->head; c && node; node = node->next)
+    {
+        if (lazy_pair_covers (node->data, c, currency))
+        {
+            g_queue_unlink (db->lazy_loaded, node);
+            g_queue_push_head_link (db->lazy_loaded, node);
+            return;
+        }
+    }
+
+    ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
+    be = qof_book_get_backend (qof_instance_get_book (db));
+    if (be && be->price_lookup)
+    {
+        lookup.type = LOOKUP_ALL;
+        lookup.prdb = db;
+        lookup.commodity = c;
+        lookup.currency = currency;
+        lookup.date = db->lazy_since;
+        (be->price_lookup) (be, &lookup);
+    }
+
+    if (!c)
+    {
+        /* Everything is in memory now, there's no window any more. */
+        db->lazy = FALSE;
+        while (!g_queue_is_empty (db->lazy_loaded))
+            g_slice_free (LazyPair, g_queue_pop_head (db->lazy_loaded));
+        LEAVE ("all prices loaded");
+        return;
+    }
+
+    lp = g_slice_new (LazyPair);
+    lp->commodity = c;
+    lp->currency = currency;
+    g_queue_push_head (db->lazy_loaded, lp);
+    while (g_queue_get_length (db->lazy_loaded) > PRICEDB_LAZY_MAX_LOADED)
+        pricedb_lazy_evict (db, g_queue_pop_tail (db->lazy_loaded));
+    LEAVE (" ");
+}
+
+void
+gnc_pricedb_set_lazy_window (GNCPriceDB *db, Timespec since)
+{
+    if (!db) return;
+    db->lazy = TRUE;
+    db->lazy_since = since;
+    if (!db->lazy_loaded)
+        db->lazy_loaded = g_queue_new ();
+}
+
 gboolean
 gnc_pricedb_remove_price(GNCPriceDB *db, GNCPrice *p)
 {
@@ -1295,66 +1777,77 @@ typedef struct
     Timespec cutoff;
     gboolean delete_user;
     gboolean delete_last;
+    gboolean cut;
     GSList *list;
 } remove_info;
 
-static gboolean
-check_one_price_date (GNCPrice *price, gpointer user_data)
+/* Finds the prices older than the cutoff at the end of the series,
+ * less the most recent price unless delete_last and the prices that
+ * aren't automatic quotes unless delete_user.  They are added to
+ * data->list or, if data->cut is set, cut out of the series in one
+ * piece, leaving their references to the caller. */
+static void
+pricedb_remove_old_from_series (GPtrArray *series, remove_info *data)
 {
-    remove_info *data = user_data;
-    PriceSource source;
-    Timespec pt;
+    guint start = price_series_bisect (series, data->cutoff, FALSE);
+    guint i, kept;
 
-    ENTER("price %p (%s), data %p", price,
-          gnc_commodity_get_mnemonic(gnc_price_get_commodity(price)),
-          user_data);
-    if (!data->delete_user)
+    /* The most recent price is the first in the series */
+    if (!data->delete_last && start == 0)
+        start = 1;
+
+    for (i = kept = start; i < series->len; i++)
     {
-        source = gnc_price_get_source (price);
-        if (source != PRICE_SOURCE_FQ)
+        GNCPrice *price = g_ptr_array_index (series, i);
+        if (!data->delete_user &&
+                gnc_price_get_source (price) != PRICE_SOURCE_FQ)
         {
-            LEAVE("Not an automatic quote");
-            return TRUE;
+            if (data->cut)
+                g_ptr_array_index (series, kept) = price;
+            kept++;
         }
+        else if (!data->cut)
+            data->list = g_slist_prepend (data->list, price);
     }
+    if (data->cut)
+        g_ptr_array_set_size (series, kept);
+}
 
-    pt = gnc_price_get_time (price);
-    {
-        gchar buf[40];
-        gnc_timespec_to_iso8601_buff(pt , buf);
-        DEBUG("checking date %s", buf);
-    }
-    if (timespec_cmp (&pt, &data->cutoff) < 0)
-    {
-        data->list = g_slist_prepend(data->list, price);
-        DEBUG("will delete");
-    }
-    LEAVE(" ");
-    return TRUE;
+static void
+pricedb_find_old_foreach_pricelist (gpointer key, gpointer val,
+                                    gpointer user_data)
+{
+    pricedb_remove_old_from_series ((GPtrArray *) val,
+                                    (remove_info *) user_data);
 }
 
 static void
+pricedb_find_old_foreach_currencies_hash (gpointer key, gpointer val,
+                                          gpointer user_data)
+{
+    g_hash_table_foreach ((GHashTable *) val,
+                          pricedb_find_old_foreach_pricelist, user_data);
+}
+
+static gboolean
 pricedb_remove_foreach_pricelist (gpointer key,
                                   gpointer val,
                                   gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *series = (GPtrArray *) val;
     remove_info *data = (remove_info *) user_data;
 
     ENTER("key %p, value %p, data %p", key, val, user_data);
-
-    /* The most recent price is the first in the list */
-    if (!data->delete_last)
-        node = g_list_next(node);
-
-    /* now check each item in the list */
-    g_list_foreach(node, (GFunc)check_one_price_date, data);
-
+    pricedb_remove_old_from_series (series, data);
     LEAVE(" ");
+    if (series->len > 0)
+        return FALSE;
+    g_ptr_array_free (series, TRUE);
+    pricedb_pairs_changed (data->db);
+    return TRUE;
 }
 
-static void
+static gboolean
 pricedb_remove_foreach_currencies_hash (gpointer key,
                                         gpointer val,
                                         gpointer user_data)
@@ -1362,9 +1855,13 @@ pricedb_remove_foreach_currencies_hash (gpointer key,
     GHashTable *currencies_hash = (GHashTable *) val;
 
     ENTER("key %p, value %p, data %p", key, val, user_data);
-    g_hash_table_foreach(currencies_hash,
-                         pricedb_remove_foreach_pricelist, user_data);
+    g_hash_table_foreach_remove(currencies_hash,
+                                pricedb_remove_foreach_pricelist, user_data);
     LEAVE(" ");
+    if (g_hash_table_size (currencies_hash) > 0)
+        return FALSE;
+    g_hash_table_destroy (currencies_hash);
+    return TRUE;
 }
 
 
@@ -1381,7 +1878,9 @@ gnc_pricedb_remove_old_prices(GNCPriceDB *db,
     data.cutoff = cutoff;
     data.delete_user = delete_user;
     data.delete_last = delete_last;
+    data.cut = FALSE;
     data.list = NULL;
+    pricedb_lazy_load (db, NULL, NULL, NULL);
 
     ENTER("db %p, delet_user %d, delete_last %d", db, delete_user, delete_last);
     {
@@ -1393,16 +1892,42 @@ gnc_pricedb_remove_old_prices(GNCPriceDB *db,
     /* Traverse the database once building up an external list of prices
      * to be deleted */
     g_hash_table_foreach(db->commodity_hash,
-                         pricedb_remove_foreach_currencies_hash,
+                         pricedb_find_old_foreach_currencies_hash,
                          &data);
 
     if (data.list == NULL)
+    {
+        LEAVE(" nothing to remove");
         return FALSE;
+    }
+
+    /* Announce the removals while the prices can still be found */
+    for (item = data.list; item; item = g_slist_next(item))
+        qof_event_gen (&((GNCPrice *) item->data)->inst, QOF_EVENT_REMOVE, NULL);
+
+    /* Then cut the same prices out of every series in one piece each,
+     * dropping the series and commodities that are left empty. */
+    data.cut = TRUE;
+    g_hash_table_foreach_remove(db->commodity_hash,
+                                pricedb_remove_foreach_currencies_hash,
+                                &data);
+
+    db->generation++;
+    gnc_pricedb_begin_edit(db);
+    qof_instance_set_dirty(&db->inst);
+    gnc_pricedb_commit_edit(db);
 
-    /* Now run this external list deleting prices */
+    /* Now invoke the backend to delete them; the references the series
+     * held are dropped with them. */
     for (item = data.list; item; item = g_slist_next(item))
     {
-        gnc_pricedb_remove_price(db, item->data);
+        GNCPrice *p = item->data;
+
+        gnc_price_begin_edit (p);
+        qof_instance_set_destroying(p, TRUE);
+        gnc_price_commit_edit (p);
+        p->db = NULL;
+        gnc_price_unref(p);
     }
 
     g_slist_free(data.list);
@@ -1419,30 +1944,33 @@ static void
 hash_values_helper(gpointer key, gpointer value, gpointer data)
 {
     GList ** l = data;
+    GList *prices = price_series_to_list (value);
     if (*l)
     {
         GList *new_l;
-        new_l = pricedb_price_list_merge(*l, value);
+        new_l = pricedb_price_list_merge(*l, prices);
         g_list_free (*l);
+        g_list_free (prices);
         *l = new_l;
     }
     else
-        *l = g_list_copy (value);
+        *l = prices;
 }
 
 static PriceList *
 price_list_from_hashtable (GHashTable *hash, const gnc_commodity *currency)
 {
-    GList *price_list = NULL, *result = NULL ;
+    GPtrArray *series;
+    GList *result = NULL;
     if (currency)
     {
-        price_list = g_hash_table_lookup(hash, currency);
-        if (!price_list)
+        series = g_hash_table_lookup(hash, currency);
+        if (!series)
         {
             LEAVE (" no price list");
             return NULL;
         }
-        result = g_list_copy (price_list);
+        result = price_series_to_list (series);
     }
     else
     {
@@ -1531,26 +2059,95 @@ pricedb_get_prices_internal(GNCPriceDB *db, const gnc_commodity *commodity,
     return forward_list;
 }
 
+/* The single-pair lookups below work directly on the stored series of
+ * the pair in both directions, as if they had been merged into one
+ * newest-first list like pricedb_get_prices_internal returns, but
+ * without building that list. */
+
+static GPtrArray *
+pricedb_get_series (GNCPriceDB *db, const gnc_commodity *commodity,
+                    const gnc_commodity *currency)
+{
+    GHashTable *currency_hash = g_hash_table_lookup (db->commodity_hash,
+                                                     commodity);
+    return currency_hash ? g_hash_table_lookup (currency_hash, currency) : NULL;
+}
+
+/* Of two prices, the one that comes first in a merged list; either
+ * may be NULL. */
+static GNCPrice *
+price_sorts_first (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) < 0 ? a : b;
+}
+
+static GNCPrice *
+price_sorts_last (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) < 0 ? b : a;
+}
+
+/* Finds the prices of the series on either side of t: the oldest one
+ * newer than t and the newest one not newer than t. */
+static void
+price_series_around (const GPtrArray *series, Timespec t,
+                     GNCPrice **newer, GNCPrice **not_newer)
+{
+    guint index;
+
+    *newer = *not_newer = NULL;
+    if (!series) return;
+    index = price_series_bisect (series, t, TRUE);
+    if (index > 0)
+        *newer = g_ptr_array_index (series, index - 1);
+    if (index < series->len)
+        *not_newer = g_ptr_array_index (series, index);
+}
+
+/* Like price_series_around, for the merged forward and reverse
+ * series of a pair. */
+static void
+price_pair_around (const GPtrArray *forward, const GPtrArray *reverse,
+                   Timespec t, GNCPrice **newer, GNCPrice **not_newer)
+{
+    GNCPrice *fwd_newer, *fwd_not_newer, *rev_newer, *rev_not_newer;
+
+    price_series_around (forward, t, &fwd_newer, &fwd_not_newer);
+    price_series_around (reverse, t, &rev_newer, &rev_not_newer);
+    *newer = price_sorts_last (fwd_newer, rev_newer);
+    *not_newer = price_sorts_first (fwd_not_newer, rev_not_newer);
+}
+
 GNCPrice *
 gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
-    GNCPrice *result;
-    GHashTable *currency_hash;
+    GPtrArray *forward, *reverse;
+    GNCPrice *result = NULL;
 
     if (!db || !commodity || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return NULL;
     /* This works magically because prices are inserted in date-sorted
      * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+     * first in either series.  */
+    forward = pricedb_get_series (db, commodity, currency);
+    reverse = pricedb_get_series (db, currency, commodity);
+    if (forward && forward->len)
+        result = g_ptr_array_index (forward, 0);
+    if (reverse && reverse->len)
+        result = price_sorts_first (result, g_ptr_array_index (reverse, 0));
+    if (!result)
+    {
+        LEAVE (" no prices");
+        return NULL;
+    }
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE(" ");
     return result;
 }
@@ -1560,13 +2157,13 @@ static void
 lookup_latest(gpointer key, gpointer val, gpointer user_data)
 {
     //gnc_commodity *currency = (gnc_commodity *)key;
-    GList *price_list = (GList *)val;
+    GPtrArray *series = (GPtrArray *)val;
     GList **return_list = (GList **)user_data;
 
-    if (!price_list) return;
+    if (!series || !series->len) return;
 
-    /* the latest price is the first in list */
-    gnc_price_list_insert(return_list, price_list->data, FALSE);
+    /* the latest price is the first in the series */
+    gnc_price_list_insert(return_list, g_ptr_array_index(series, 0), FALSE);
 }
 
 typedef struct
@@ -1587,54 +2184,49 @@ typedef struct
 */
  
 static gboolean
-price_list_scan_any_currency(GList *price_list, gpointer data)
+price_list_scan_any_currency(GPtrArray *series, gpointer data)
 {
     UsesCommodity *helper = (UsesCommodity*)data;
-    GList *node = price_list;
+    GNCPrice *price;
     gnc_commodity *com;
     gnc_commodity *cur;
+    guint index;
     
-    if (!price_list)
+    if (!series || !series->len)
         return TRUE;
 
-    com = gnc_price_get_commodity(node->data);
-    cur = gnc_price_get_currency(node->data);
+    price = g_ptr_array_index(series, 0);
+    com = gnc_price_get_commodity(price);
+    cur = gnc_price_get_currency(price);
     
     /* if this price list isn't for the commodity we are interested in,
        ignore it. */
     if (com != helper->com && cur != helper->com)
         return TRUE;
     
-    /* The price list is sorted in decreasing order of time.  Find the first
-       price on it that is older than the requested time and add it and the
+    /* The series is sorted in decreasing order of time.  Find the first
+       price in it that is older than the requested time and add it and the
        previous price to the result list. */
-    while (node != NULL)
+    index = price_series_bisect(series, helper->t, FALSE);
+    if (index < series->len)
     {
-        GNCPrice *price = node->data;
-        Timespec price_t = gnc_price_get_time(price);
-        if (timespec_cmp(&price_t, &helper->t) < 0)
-        {
-            /* If there is a previous price add it to the results. */
-            if (node->prev)
-            {
-                GNCPrice *prev_price = node->prev->data;
-                gnc_price_ref(prev_price);
-                *helper->list = g_list_prepend(*helper->list, prev_price);
-            }
-            /* Add the first price before the desired time */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
-            /* No point in looking further, they will all be older */
-            break;
-        }
-        else if (node->next == NULL)
+        /* If there is a previous price add it to the results. */
+        if (index > 0)
         {
-            /* The last price is later than given time, add it */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
+            GNCPrice *prev_price = g_ptr_array_index(series, index - 1);
+            gnc_price_ref(prev_price);
+            *helper->list = g_list_prepend(*helper->list, prev_price);
         }
-        node = node->next;
+        /* Add the first price before the desired time */
+        price = g_ptr_array_index(series, index);
+    }
+    else
+    {
+        /* The last price is later than given time, add it */
+        price = g_ptr_array_index(series, series->len - 1);
     }
+    gnc_price_ref(price);
+    *helper->list = g_list_prepend(*helper->list, price);
 
     return TRUE;
 }
@@ -1799,6 +2391,7 @@ gnc_pricedb_lookup_nearest_in_time_any_currency(GNCPriceDB *db,
 
     if (!db || !commodity) return NULL;
     ENTER ("db=%p commodity=%p", db, commodity);
+    pricedb_lazy_load (db, commodity, NULL, &t);
 
     pricedb_pricelist_traversal(db, price_list_scan_any_currency,
                                        &helper);
@@ -1820,6 +2413,7 @@ gnc_pricedb_lookup_latest_before_any_currency(GNCPriceDB *db,
 
     if (!db || !commodity) return NULL;
     ENTER ("db=%p commodity=%p", db, commodity);
+    pricedb_lazy_load (db, commodity, NULL, &t);
 
     pricedb_pricelist_traversal(db, price_list_scan_any_currency,
                                        &helper);
@@ -1839,7 +2433,7 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
                        const gnc_commodity *commodity,
                        const gnc_commodity *currency)
 {
-    GList *price_list;
+    GPtrArray *series;
     GHashTable *currency_hash;
     gint size;
 
@@ -1854,8 +2448,8 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
 
     if (currency)
     {
-        price_list = g_hash_table_lookup(currency_hash, currency);
-        if (price_list)
+        series = g_hash_table_lookup(currency_hash, currency);
+        if (series)
         {
             LEAVE("yes");
             return TRUE;
@@ -1884,6 +2478,7 @@ gnc_pricedb_get_prices(GNCPriceDB *db,
 
     if (!db || !commodity) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
+    pricedb_lazy_load (db, commodity, currency, NULL);
     result = pricedb_get_prices_internal (db, commodity, currency, FALSE);
     if (!result) return NULL;
     for (node = result; node; node = node->next)
@@ -1899,9 +2494,9 @@ static void
 price_count_helper(gpointer key, gpointer value, gpointer data)
 {
     int *result = data;
-    GList *price_list = value;
+    GPtrArray *series = value;
     
-    *result += g_list_length(price_list);
+    *result += series->len;
 }
 
 int
@@ -1913,6 +2508,7 @@ gnc_pricedb_num_prices(GNCPriceDB *db,
     
     if (!db || !c) return 0;
     ENTER ("db=%p commodity=%p", db, c);
+    pricedb_lazy_load (db, c, NULL, NULL);
 
     currency_hash = g_hash_table_lookup(db->commodity_hash, c);
     if (currency_hash)
@@ -1936,6 +2532,7 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
     
     if (!db || !c || n < 0) return NULL;
     ENTER ("db=%p commodity=%p index=%d", db, c, n);
+    pricedb_lazy_load (db, c, NULL, NULL);
     
     currency_hash = g_hash_table_lookup(db->commodity_hash, c);
     if (currency_hash)
@@ -1950,16 +2547,17 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
             g_hash_table_iter_init(&iter, currency_hash);
             if (g_hash_table_iter_next(&iter, &key, &value))
             {
-                PriceList *prices = value;
-                result = g_list_nth_data(prices, n);
+                GPtrArray *series = value;
+                if ((guint) n < series->len)
+                    result = g_ptr_array_index(series, n);
             }
         }
         else if (num_currencies > 1)
         {
             /* Prices for multiple currencies, must find the nth entry in the
                merged currency list. */
-            GList **price_array = (GList **)g_new(gpointer, num_currencies);
-            GList **next_list;
+            GPtrArray **series = g_new(GPtrArray *, num_currencies);
+            guint *next = g_new0(guint, num_currencies);
             int i, j;
             GHashTableIter iter;
             gpointer key, value;
@@ -1969,41 +2567,43 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
                  g_hash_table_iter_next(&iter, &key, &value) && i < num_currencies;
                  i++)
             {
-                price_array[i] = value;
+                series[i] = value;
             }
             
             /* Iterate n times to get the nth price, each time finding the currency
                with the latest price */
             for (i = 0; i <= n; i++)
             {
-                next_list = NULL;
+                int latest = -1;
                 for (j = 0; j < num_currencies; j++)
                 {
                     /* Save this entry if it's the first one or later than
                        the saved one. */
-                    if (price_array[j] != NULL &&
-                        (next_list == NULL || *next_list == NULL ||
-                        compare_prices_by_date((*next_list)->data, (price_array[j])->data) > 0))
+                    if (next[j] < series[j]->len &&
+                        (latest < 0 ||
+                         compare_prices_by_date(g_ptr_array_index(series[latest], next[latest]),
+                                                g_ptr_array_index(series[j], next[j])) > 0))
                     {
-                        next_list = &price_array[j];
+                        latest = j;
                     }
                 }
-                /* next_list points to the list with the latest price unless all
-                   the lists are empty */
-                if (next_list && *next_list)
+                /* latest is the series with the latest price unless all
+                   the series are used up */
+                if (latest >= 0)
                 {
-                    result = (*next_list)->data;
-                    *next_list = (*next_list)->next;
+                    result = g_ptr_array_index(series[latest], next[latest]);
+                    next[latest]++;
                 }
                 else
                 {
-                    /* all the lists are empty, "n" is greater than the number
-                       of prices for this commodity. */
+                    /* all the series are used up, "n" is greater than the
+                       number of prices for this commodity. */
                     result = NULL;
                     break;
                 }
             }
-            g_free(price_array);
+            g_free(next);
+            g_free(series);
         }
     }
 
@@ -2026,27 +2626,24 @@ gnc_pricedb_lookup_at_time(GNCPriceDB *db,
                            const gnc_commodity *currency,
                            Timespec t)
 {
-    GList *price_list;
-    GList *item = NULL;
-    GHashTable *currency_hash;
+    GNCPrice *newer, *p;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    pricedb_lazy_load (db, c, currency, &t);
+    price_pair_around (pricedb_get_series (db, c, currency),
+                       pricedb_get_series (db, currency, c),
+                       t, &newer, &p);
+    if (p)
     {
-        GNCPrice *p = item->data;
         Timespec price_time = gnc_price_get_time(p);
         if (timespec_equal(&price_time, &t))
         {
             gnc_price_ref(p);
-            g_list_free (price_list);
+            LEAVE (" ");
             return p;
         }
-        item = item->next;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2058,36 +2655,28 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        Timespec t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
-    GHashTable *currency_hash;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
+    pricedb_lazy_load (db, c, currency, &t);
 
-    /* default answer */
-    current_price = item->data;
-
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
+    /* current_price is the last price newer than t and next_price the
+       first one that isn't.  Remember that prices are in
+       most-recent-first order. */
+    price_pair_around (pricedb_get_series (db, c, currency),
+                       pricedb_get_series (db, currency, c),
+                       t, &current_price, &next_price);
+    if (!current_price && !next_price)
     {
-        GNCPrice *p = item->data;
-        Timespec price_time = gnc_price_get_time(p);
-        if (timespec_cmp(&price_time, &t) <= 0)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
+        LEAVE (" no prices");
+        return NULL;
     }
+    /* default answer, when no price is newer than t */
+    if (!current_price)
+        current_price = next_price;
 
     if (current_price)      /* How can this be null??? */
     {
@@ -2159,7 +2748,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2179,33 +2767,197 @@ gnc_pricedb_lookup_latest_before (GNCPriceDB *db,
                                   gnc_commodity *currency,
                                   Timespec t)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    GHashTable *currency_hash;
-    Timespec price_time;
+    GNCPrice *newer = NULL;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time (item->data);
-        if (timespec_cmp(&price_time, &t) <= 0)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (timespec_cmp(&price_time, &t) > 0 && item);
+    pricedb_lazy_load (db, c, currency, &t);
+    price_pair_around (pricedb_get_series (db, c, currency),
+                       pricedb_get_series (db, currency, c),
+                       t, &newer, &current_price);
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
 
+static gnc_numeric
+convert_balance_by_price (gnc_numeric bal, const gnc_commodity *from,
+                          const gnc_commodity *to, GNCPrice *price)
+{
+    if (gnc_price_get_commodity(price) == from)
+        return gnc_numeric_mul (bal, gnc_price_get_value (price),
+                                gnc_commodity_get_fraction (to),
+                                GNC_HOW_RND_ROUND);
+    return gnc_numeric_div (bal, gnc_price_get_value (price),
+                            gnc_commodity_get_fraction (to),
+                            GNC_HOW_RND_ROUND);
+}
+
+static GNCPrice *
+lookup_direct_price (GNCPriceDB *db, const gnc_commodity *from,
+                     const gnc_commodity *to, const Timespec *t)
+{
+    if (t != NULL)
+        return gnc_pricedb_lookup_nearest_in_time(db, from, to, *t);
+    return gnc_pricedb_lookup_latest(db, from, to);
+}
+
+/* ==================================================================== */
+/* The conversion graph.  Its nodes are commodities, with an edge
+ * between any two that have prices for each other in either direction.
+ * The shortest routes from a commodity to all the others are found by
+ * a breadth-first search the first time they are needed, and both are
+ * kept until the pricedb's generation changes.
+ */
+
+static void
+conversion_graph_add_edge (GHashTable *graph, gpointer a, gpointer b)
+{
+    GHashTable *neighbours = g_hash_table_lookup (graph, a);
+    if (!neighbours)
+    {
+        neighbours = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (graph, a, neighbours);
+    }
+    g_hash_table_insert (neighbours, b, b);
+}
+
+static void
+conversion_graph_clear (GNCPriceDB *db)
+{
+    if (db->conversion_graph)
+        g_hash_table_destroy (db->conversion_graph);
+    if (db->conversion_routes)
+        g_hash_table_destroy (db->conversion_routes);
+    db->conversion_graph = NULL;
+    db->conversion_routes = NULL;
+}
+
+static void
+conversion_graph_build (GNCPriceDB *db)
+{
+    GHashTableIter commodity_iter, currency_iter;
+    gpointer commodity, currency_hash, currency, series;
+
+    db->conversion_graph =
+        g_hash_table_new_full (NULL, NULL, NULL,
+                               (GDestroyNotify) g_hash_table_destroy);
+    db->conversion_routes =
+        g_hash_table_new_full (NULL, NULL, NULL,
+                               (GDestroyNotify) g_hash_table_destroy);
+    db->graph_generation = db->generation;
+
+    g_hash_table_iter_init (&commodity_iter, db->commodity_hash);
+    while (g_hash_table_iter_next (&commodity_iter, &commodity, &currency_hash))
+    {
+        g_hash_table_iter_init (&currency_iter, currency_hash);
+        while (g_hash_table_iter_next (&currency_iter, &currency, &series))
+        {
+            if (((GPtrArray *) series)->len == 0)
+                continue;
+            conversion_graph_add_edge (db->conversion_graph, commodity, currency);
+            conversion_graph_add_edge (db->conversion_graph, currency, commodity);
+        }
+    }
+}
+
+/* Maps every commodity reachable from "from" to the one before it on a
+ * shortest route; "from" maps to itself. */
+static GHashTable *
+conversion_graph_routes (GNCPriceDB *db, const gnc_commodity *from)
+{
+    GHashTable *previous;
+    GQueue queue = G_QUEUE_INIT;
+
+    if (db->conversion_graph && db->graph_generation != db->generation)
+        conversion_graph_clear (db);
+    if (!db->conversion_graph)
+        conversion_graph_build (db);
+
+    previous = g_hash_table_lookup (db->conversion_routes, from);
+    if (previous)
+        return previous;
+
+    previous = g_hash_table_new (NULL, NULL);
+    g_hash_table_insert (previous, (gpointer) from, (gpointer) from);
+    g_queue_push_tail (&queue, (gpointer) from);
+    while (!g_queue_is_empty (&queue))
+    {
+        gpointer node = g_queue_pop_head (&queue), next;
+        GHashTable *neighbours = g_hash_table_lookup (db->conversion_graph,
+                                                      node);
+        GHashTableIter iter;
+
+        if (!neighbours)
+            continue;
+        g_hash_table_iter_init (&iter, neighbours);
+        while (g_hash_table_iter_next (&iter, &next, NULL))
+        {
+            if (g_hash_table_lookup (previous, next))
+                continue;
+            g_hash_table_insert (previous, next, node);
+            g_queue_push_tail (&queue, next);
+        }
+    }
+    g_hash_table_insert (db->conversion_routes, (gpointer) from, previous);
+    return previous;
+}
+
+static gboolean
+conversion_graph_has_route (GNCPriceDB *db, const gnc_commodity *from,
+                            const gnc_commodity *to)
+{
+    return g_hash_table_lookup (conversion_graph_routes (db, from), to) != NULL;
+}
+
+/* Multiplies together the prices along the shortest route from one
+ * commodity to the other, giving the amount of "to" per unit of
+ * "from".  Returns FALSE if there is no route or a price along it is
+ * missing or unusable. */
+static gboolean
+route_conversion_rate (GNCPriceDB *db, const gnc_commodity *from,
+                       const gnc_commodity *to, const Timespec *t,
+                       gnc_numeric *rate)
+{
+    GHashTable *previous = conversion_graph_routes (db, from);
+    const gnc_commodity *node = to;
+    int no_round = GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER;
+
+    *rate = gnc_numeric_create (1, 1);
+    if (!g_hash_table_lookup (previous, to))
+        return FALSE;
+
+    /* Walk the route backwards; the product doesn't care. */
+    while (node != from)
+    {
+        const gnc_commodity *prev = g_hash_table_lookup (previous, node);
+        GNCPrice *price = lookup_direct_price (db, prev, node, t);
+        gnc_numeric hop;
+
+        if (!price)
+            return FALSE;
+        hop = gnc_price_get_value (price);
+        if (gnc_price_get_commodity (price) != prev)
+            hop = gnc_numeric_div (gnc_numeric_create (1, 1), hop,
+                                   GNC_DENOM_AUTO, no_round);
+        gnc_price_unref (price);
+        *rate = gnc_numeric_mul (*rate, hop, GNC_DENOM_AUTO, no_round);
+        if (gnc_numeric_check (*rate) || gnc_numeric_zero_p (*rate))
+            return FALSE;
+        node = prev;
+    }
+    return TRUE;
+}
+
+static gnc_numeric
+convert_balance_by_rate (gnc_numeric bal, const gnc_commodity *to,
+                         gnc_numeric rate)
+{
+    return gnc_numeric_mul (bal, rate, gnc_commodity_get_fraction (to),
+                            GNC_HOW_RND_ROUND);
+}
+
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
                            const gnc_commodity *from, const gnc_commodity *to,
@@ -2217,20 +2969,10 @@ direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
         return retval;
     if (gnc_numeric_zero_p(bal))
         return retval;
-    if (t != NULL)
-        price = gnc_pricedb_lookup_nearest_in_time(db, from, to, *t);
-    else
-        price = gnc_pricedb_lookup_latest(db, from, to);
+    price = lookup_direct_price(db, from, to, t);
     if (price == NULL)
         return retval;
-    if (gnc_price_get_commodity(price) == from)
-        retval = gnc_numeric_mul (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
-    else
-        retval = gnc_numeric_div (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
+    retval = convert_balance_by_price (bal, from, to, price);
     gnc_price_unref (price);
     return retval;
 
@@ -2311,18 +3053,13 @@ convert_balance(gnc_numeric bal, const gnc_commodity *from,
                            fraction, GNC_HOW_RND_ROUND);
 
 }
-static gnc_numeric
-indirect_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
-                             const gnc_commodity *from, const gnc_commodity *to,
-                             Timespec *t )
+static PriceTuple
+lookup_common_prices (GNCPriceDB *db, const gnc_commodity *from,
+                      const gnc_commodity *to, const Timespec *t)
 {
     GList *from_prices = NULL, *to_prices = NULL;
-    PriceTuple tuple;
-    gnc_numeric zero = gnc_numeric_zero();
-    if (from == NULL || to == NULL)
-        return zero;
-    if (gnc_numeric_zero_p(bal))
-        return zero;
+    PriceTuple tuple = {NULL, NULL};
+
     if (t == NULL)
     {
         from_prices = gnc_pricedb_lookup_latest_any_currency(db, from);
@@ -2340,12 +3077,43 @@ indirect_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
                                                                     to, *t);
     }
     if (from_prices == NULL || to_prices == NULL)
-        return zero;
+    {
+        gnc_price_list_destroy(from_prices);
+        return tuple;
+    }
     tuple = extract_common_prices(from_prices, to_prices);
     gnc_price_list_destroy(from_prices);
     gnc_price_list_destroy(to_prices);
+    return tuple;
+}
+
+static gnc_numeric
+indirect_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
+                             const gnc_commodity *from, const gnc_commodity *to,
+                             Timespec *t )
+{
+    PriceTuple tuple;
+    gnc_numeric rate;
+    gnc_numeric zero = gnc_numeric_zero();
+    if (from == NULL || to == NULL)
+        return zero;
+    if (gnc_numeric_zero_p(bal))
+        return zero;
+    /* Don't bother looking for common prices if nothing connects the
+     * two commodities. */
+    if (!conversion_graph_has_route(db, from, to))
+        return zero;
+    tuple = lookup_common_prices(db, from, to, t);
     if (tuple.from)
-        return convert_balance(bal, from, to, tuple);
+    {
+        gnc_numeric retval = convert_balance(bal, from, to, tuple);
+        gnc_price_unref(tuple.from);
+        gnc_price_unref(tuple.to);
+        return retval;
+    }
+    /* The commodities are further apart than one intermediate. */
+    if (route_conversion_rate(db, from, to, t, &rate))
+        return convert_balance_by_rate(bal, to, rate);
     return zero;
 }
 
@@ -2406,6 +3174,264 @@ gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
                                        new_currency, &t);
 }
 
+gnc_numeric
+gnc_pricedb_convert_collector_nearest_price(GNCPriceDB *pdb,
+        const GncCommodityCollector *collector,
+        const gnc_commodity *new_currency,
+        Timespec t)
+{
+    CommodityList *commodities, *node;
+    gnc_numeric total = gnc_numeric_zero ();
+
+    g_return_val_if_fail (collector, total);
+
+    commodities = gnc_commodity_collector_get_commodities (collector);
+    for (node = commodities; node; node = node->next)
+    {
+        gnc_numeric amount =
+            gnc_commodity_collector_get_amount (collector, node->data);
+        amount = gnc_pricedb_convert_balance_nearest_price (pdb, amount,
+                 node->data, new_currency, t);
+        total = gnc_numeric_add (total, amount, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_LCD);
+    }
+    g_list_free (commodities);
+    return total;
+}
+
+
+/* ==================================================================== */
+/* Resolved conversions, for converting many balances between the same
+ * two commodities.  The prices are looked up once; applying the
+ * conversion gives the same result as the convert_balance functions
+ * above would for each balance.
+ */
+
+struct gnc_price_conversion_s
+{
+    GNCPriceDB *db;
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+    gboolean use_time;
+    Timespec time;
+    GNCPrice *direct;
+    gboolean have_tuple;
+    PriceTuple tuple;
+    gboolean have_route;
+    gboolean route_ok;
+    gnc_numeric route_rate;
+};
+
+GNCPriceConversion *
+gnc_pricedb_conversion_new (GNCPriceDB *pdb,
+                            const gnc_commodity *balance_currency,
+                            const gnc_commodity *new_currency,
+                            const Timespec *t)
+{
+    GNCPriceConversion *conv = g_new0 (GNCPriceConversion, 1);
+
+    conv->db = pdb;
+    conv->from = balance_currency;
+    conv->to = new_currency;
+    conv->use_time = (t != NULL);
+    if (t)
+        conv->time = *t;
+    if (pdb && balance_currency && new_currency &&
+            !gnc_commodity_equiv (balance_currency, new_currency))
+        conv->direct = lookup_direct_price (pdb, balance_currency,
+                                            new_currency, t);
+    return conv;
+}
+
+gnc_numeric
+gnc_price_conversion_apply (GNCPriceConversion *conv, gnc_numeric balance)
+{
+    gnc_numeric new_value;
+
+    g_return_val_if_fail (conv, gnc_numeric_zero ());
+
+    if (gnc_numeric_zero_p (balance) ||
+            gnc_commodity_equiv (conv->from, conv->to))
+        return balance;
+    if (conv->db == NULL || conv->from == NULL || conv->to == NULL)
+        return gnc_numeric_zero ();
+
+    if (conv->direct)
+    {
+        new_value = convert_balance_by_price (balance, conv->from, conv->to,
+                                              conv->direct);
+        if (!gnc_numeric_zero_p (new_value))
+            return new_value;
+    }
+
+    /* The indirect prices are only needed when there's no direct price
+     * or it rounds the balance to zero, so look them up lazily. */
+    if (!conv->have_tuple)
+    {
+        if (conversion_graph_has_route (conv->db, conv->from, conv->to))
+            conv->tuple = lookup_common_prices (conv->db, conv->from, conv->to,
+                                                conv->use_time ? &conv->time : NULL);
+        conv->have_tuple = TRUE;
+    }
+    if (conv->tuple.from)
+        return convert_balance (balance, conv->from, conv->to, conv->tuple);
+
+    if (!conv->have_route)
+    {
+        conv->route_ok = route_conversion_rate (conv->db, conv->from, conv->to,
+                                                conv->use_time ? &conv->time : NULL,
+                                                &conv->route_rate);
+        conv->have_route = TRUE;
+    }
+    if (conv->route_ok)
+        return convert_balance_by_rate (balance, conv->to, conv->route_rate);
+    return gnc_numeric_zero ();
+}
+
+void
+gnc_price_conversion_free (GNCPriceConversion *conv)
+{
+    if (!conv) return;
+    if (conv->direct)
+        gnc_price_unref (conv->direct);
+    if (conv->tuple.from)
+        gnc_price_unref (conv->tuple.from);
+    if (conv->tuple.to)
+        gnc_price_unref (conv->tuple.to);
+    g_free (conv);
+}
+
+/* ==================================================================== */
+/* Conversion caches, for converting many balances between many pairs
+ * of commodities on a few days, as reports do.  Each (from, to, day)
+ * gets one GNCPriceConversion, all of which are dropped as soon as the
+ * pricedb's generation shows that a price has changed.
+ */
+
+typedef struct
+{
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+    gboolean latest;
+    gint64 day;
+} ConversionKey;
+
+struct gnc_price_conversion_cache_s
+{
+    GNCPriceDB *db;
+    guint generation;
+    GHashTable *conversions;
+};
+
+static guint
+conversion_key_hash (gconstpointer key)
+{
+    const ConversionKey *k = key;
+    return g_direct_hash (k->from) ^ (g_direct_hash (k->to) * 31) ^
+           g_int64_hash (&k->day);
+}
+
+static gboolean
+conversion_key_equal (gconstpointer a, gconstpointer b)
+{
+    const ConversionKey *ka = a, *kb = b;
+    return ka->from == kb->from && ka->to == kb->to &&
+           ka->latest == kb->latest && ka->day == kb->day;
+}
+
+GNCPriceConversionCache *
+gnc_price_conversion_cache_new (GNCPriceDB *pdb)
+{
+    GNCPriceConversionCache *cache = g_new0 (GNCPriceConversionCache, 1);
+
+    cache->db = pdb;
+    cache->generation = pdb ? pdb->generation : 0;
+    cache->conversions =
+        g_hash_table_new_full (conversion_key_hash, conversion_key_equal,
+                               g_free,
+                               (GDestroyNotify) gnc_price_conversion_free);
+    return cache;
+}
+
+void
+gnc_price_conversion_cache_free (GNCPriceConversionCache *cache)
+{
+    if (!cache) return;
+    g_hash_table_destroy (cache->conversions);
+    g_free (cache);
+}
+
+static GNCPriceConversion *
+conversion_cache_lookup (GNCPriceConversionCache *cache,
+                         const gnc_commodity *from, const gnc_commodity *to,
+                         const Timespec *t)
+{
+    ConversionKey key, *new_key;
+    GNCPriceConversion *conv;
+    Timespec day = {0, 0};
+
+    if (cache->db && cache->generation != cache->db->generation)
+    {
+        g_hash_table_remove_all (cache->conversions);
+        cache->generation = cache->db->generation;
+    }
+
+    key.from = from;
+    key.to = to;
+    key.latest = (t == NULL);
+    if (t)
+    {
+        day = timespecCanonicalDayTime (*t);
+        key.day = day.tv_sec;
+    }
+    else
+        key.day = 0;
+
+    conv = g_hash_table_lookup (cache->conversions, &key);
+    if (conv)
+        return conv;
+
+    conv = gnc_pricedb_conversion_new (cache->db, from, to, t ? &day : NULL);
+    new_key = g_new (ConversionKey, 1);
+    *new_key = key;
+    g_hash_table_insert (cache->conversions, new_key, conv);
+    return conv;
+}
+
+gnc_numeric
+gnc_price_conversion_cache_convert_latest (GNCPriceConversionCache *cache,
+                                           gnc_numeric balance,
+                                           const gnc_commodity *balance_currency,
+                                           const gnc_commodity *new_currency)
+{
+    g_return_val_if_fail (cache, gnc_numeric_zero ());
+
+    if (gnc_numeric_zero_p (balance) ||
+            gnc_commodity_equiv (balance_currency, new_currency))
+        return balance;
+    return gnc_price_conversion_apply (
+               conversion_cache_lookup (cache, balance_currency,
+                                        new_currency, NULL),
+               balance);
+}
+
+gnc_numeric
+gnc_price_conversion_cache_convert_nearest (GNCPriceConversionCache *cache,
+                                            gnc_numeric balance,
+                                            const gnc_commodity *balance_currency,
+                                            const gnc_commodity *new_currency,
+                                            Timespec t)
+{
+    g_return_val_if_fail (cache, gnc_numeric_zero ());
+
+    if (gnc_numeric_zero_p (balance) ||
+            gnc_commodity_equiv (balance_currency, new_currency))
+        return balance;
+    return gnc_price_conversion_apply (
+               conversion_cache_lookup (cache, balance_currency,
+                                        new_currency, &t),
+               balance);
+}
 
 /* ==================================================================== */
 /* gnc_pricedb_foreach_price infrastructure
@@ -2421,16 +3447,15 @@ typedef struct
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *series = (GPtrArray *) val;
     GNCPriceDBForeachData *foreach_data = (GNCPriceDBForeachData *) user_data;
+    guint i;
 
     /* stop traversal when func returns FALSE */
-    while (foreach_data->ok && node)
+    for (i = 0; foreach_data->ok && i < series->len; i++)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = (GNCPrice *) g_ptr_array_index (series, i);
         foreach_data->ok = foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
@@ -2467,14 +3492,14 @@ unstable_price_traversal(GNCPriceDB *db,
 typedef struct
 {
     gboolean ok;
-    gboolean (*func)(GList *p, gpointer user_data);
+    gboolean (*func)(GPtrArray *p, gpointer user_data);
     gpointer user_data;
 } GNCPriceListForeachData;
 
 static void
 pricedb_pricelist_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
+    GPtrArray *price_list = (GPtrArray *) val;
     GNCPriceListForeachData *foreach_data = (GNCPriceListForeachData *) user_data;
     if (foreach_data->ok)
     {
@@ -2491,7 +3516,7 @@ pricedb_pricelist_foreach_currencies_hash(gpointer key, gpointer val, gpointer u
 
 static gboolean
 pricedb_pricelist_traversal(GNCPriceDB *db,
-                         gboolean (*f)(GList *p, gpointer user_data),
+                         gboolean (*f)(GPtrArray *p, gpointer user_data),
                          gpointer user_data)
 {
     GNCPriceListForeachData foreach_data;
@@ -2512,21 +3537,11 @@ pricedb_pricelist_traversal(GNCPriceDB *db,
 }
 
 static gint
-compare_hash_entries_by_commodity_key(gconstpointer a, gconstpointer b)
+compare_commodities_by_name (const gnc_commodity *ca, const gnc_commodity *cb)
 {
-    HashEntry *he_a = (HashEntry *) a;
-    HashEntry *he_b = (HashEntry *) b;
-    gnc_commodity *ca;
-    gnc_commodity *cb;
     int cmp_result;
 
-    if (a == b) return 0;
-    if (!a && !b) return 0;
-    if (!a) return -1;
-    if (!b) return 1;
-
-    ca = (gnc_commodity *) he_a->key;
-    cb = (gnc_commodity *) he_b->key;
+    if (ca == cb) return 0;
 
     cmp_result = g_strcmp0(gnc_commodity_get_namespace(ca),
                            gnc_commodity_get_namespace(cb));
@@ -2537,57 +3552,88 @@ compare_hash_entries_by_commodity_key(gconstpointer a, gconstpointer b)
                      gnc_commodity_get_mnemonic(cb));
 }
 
+static gint
+compare_price_pairs (gconstpointer a, gconstpointer b)
+{
+    const PricePair *pa = *(PricePair * const *) a;
+    const PricePair *pb = *(PricePair * const *) b;
+    int cmp_result = compare_commodities_by_name (pa->commodity, pb->commodity);
+
+    if (cmp_result != 0) return cmp_result;
+    return compare_commodities_by_name (pa->currency, pb->currency);
+}
+
+/* Drops the sorted pair index; called whenever a series is created or
+ * destroyed. */
+static void
+pricedb_pairs_changed (GNCPriceDB *db)
+{
+    if (db->sorted_pairs)
+        g_ptr_array_unref (db->sorted_pairs);
+    db->sorted_pairs = NULL;
+}
+
+/* Returns the index of all commodity/currency pairs, sorted by the
+ * names of the commodities, building it if it was dropped. */
+static GPtrArray *
+pricedb_get_sorted_pairs (GNCPriceDB *db)
+{
+    GHashTableIter commodity_iter, currency_iter;
+    gpointer commodity, currency_hash, currency, series;
+
+    if (db->sorted_pairs)
+        return db->sorted_pairs;
+
+    db->sorted_pairs = g_ptr_array_new_with_free_func (g_free);
+    g_hash_table_iter_init (&commodity_iter, db->commodity_hash);
+    while (g_hash_table_iter_next (&commodity_iter, &commodity, &currency_hash))
+    {
+        g_hash_table_iter_init (&currency_iter, currency_hash);
+        while (g_hash_table_iter_next (&currency_iter, &currency, &series))
+        {
+            PricePair *pair = g_new (PricePair, 1);
+            pair->commodity = commodity;
+            pair->currency = currency;
+            pair->series = series;
+            g_ptr_array_add (db->sorted_pairs, pair);
+        }
+    }
+    g_ptr_array_sort (db->sorted_pairs, compare_price_pairs);
+    return db->sorted_pairs;
+}
+
 static gboolean
 stable_price_traversal(GNCPriceDB *db,
                        gboolean (*f)(GNCPrice *p, gpointer user_data),
                        gpointer user_data)
 {
-    GSList *currency_hashes = NULL;
+    GPtrArray *pairs;
     gboolean ok = TRUE;
-    GSList *i = NULL;
+    guint i;
 
     if (!db || !f) return FALSE;
+    if (db->commodity_hash == NULL) return FALSE;
 
-    currency_hashes = hash_table_to_list(db->commodity_hash);
-    currency_hashes = g_slist_sort(currency_hashes,
-                                   compare_hash_entries_by_commodity_key);
-
-    for (i = currency_hashes; i; i = i->next)
+    /* Hold on to the index in case f changes the pairs. */
+    pairs = g_ptr_array_ref (pricedb_get_sorted_pairs (db));
+    for (i = 0; ok && i < pairs->len; i++)
     {
-        HashEntry *entry = (HashEntry *) i->data;
-        GHashTable *currency_hash = (GHashTable *) entry->value;
-        GSList *price_lists = hash_table_to_list(currency_hash);
-        GSList *j;
+        PricePair *pair = g_ptr_array_index (pairs, i);
+        guint k;
 
-        price_lists = g_slist_sort(price_lists, compare_hash_entries_by_commodity_key);
-        for (j = price_lists; j; j = j->next)
+        for (k = 0; k < pair->series->len; k++)
         {
-            HashEntry *pricelist_entry = (HashEntry *) j->data;
-            GList *price_list = (GList *) pricelist_entry->value;
-            GList *node;
+            GNCPrice *price = (GNCPrice *) g_ptr_array_index (pair->series, k);
 
-            for (node = (GList *) price_list; node; node = node->next)
+            /* stop traversal when f returns FALSE */
+            if (!f(price, user_data))
             {
-                GNCPrice *price = (GNCPrice *) node->data;
-
-                /* stop traversal when f returns FALSE */
-                if (FALSE == ok) break;
-                if (!f(price, user_data)) ok = FALSE;
+                ok = FALSE;
+                break;
             }
         }
-        if (price_lists)
-        {
-            g_slist_foreach(price_lists, hash_entry_free_gfunc, NULL);
-            g_slist_free(price_lists);
-            price_lists = NULL;
-        }
-    }
-
-    if (currency_hashes)
-    {
-        g_slist_foreach(currency_hashes, hash_entry_free_gfunc, NULL);
-        g_slist_free(currency_hashes);
     }
+    g_ptr_array_unref (pairs);
     return ok;
 }
 
@@ -2598,6 +3644,7 @@ gnc_pricedb_foreach_price(GNCPriceDB *db,
                           gboolean stable_order)
 {
     ENTER ("db=%p f=%p", db, f);
+    pricedb_lazy_load (db, NULL, NULL, NULL);
     if (stable_order)
     {
         LEAVE (" stable order found");
@@ -2788,15 +3835,14 @@ VoidGNCPriceDBForeachData;
 static void
 void_pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *series = (GPtrArray *) val;
     VoidGNCPriceDBForeachData *foreach_data = (VoidGNCPriceDBForeachData *) user_data;
+    guint i;
 
-    while (node)
+    for (i = 0; i < series->len; i++)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = (GNCPrice *) g_ptr_array_index (series, i);
         foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
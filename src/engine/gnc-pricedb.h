@@ -364,6 +364,23 @@ void gnc_pricedb_set_bulk_update(GNCPriceDB *db, gboolean bulk_update);
  */
 gboolean     gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p);
 
+/** @brief Add many prices to the pricedb at once, as from a quote feed.
+ *
+ * The prices are grouped by commodity and currency, and each group is
+ * merged into the pricedb in one pass.  Outside bulk update mode an
+ * older price on the same day is replaced as by gnc_pricedb_add_price();
+ * of several new prices for one commodity, currency and day only the
+ * one with the best source, or the latest of those, is added.  The
+ * pricedb is committed once and, instead of an event for each price,
+ * one QOF_EVENT_MODIFY event is generated for the pricedb with the list
+ * of added prices as its event data.
+ * @param db The pricedb
+ * @param prices The prices to add.  As with gnc_pricedb_add_price(), the
+ * callers may drop their references afterwards.
+ * @return The number of prices added.
+ */
+guint        gnc_pricedb_add_prices(GNCPriceDB *db, PriceList *prices);
+
 /** @brief Remove a price from the pricedb and unref the price.
  * @param db The Pricedb
  * @param p The price to remove.
@@ -566,6 +583,89 @@ gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
                                           const gnc_commodity *new_currency,
                                           Timespec t);
 
+/** @brief Convert all the totals of a commodity collector to one
+ * currency using the prices nearest to the given time, and add them up.
+ * @param pdb The pricedb
+ * @param collector The totals to be converted
+ * @param new_currency The commodity to which they should be converted
+ * @param t The time nearest to which prices should be used.
+ * @return The sum; a total for which no price is available adds zero,
+ * as with gnc_pricedb_convert_balance_nearest_price().
+ */
+gnc_numeric
+gnc_pricedb_convert_collector_nearest_price(GNCPriceDB *pdb,
+                                            const GncCommodityCollector *collector,
+                                            const gnc_commodity *new_currency,
+                                            Timespec t);
+
+/** A conversion between two commodities whose prices have been looked
+ * up once, for converting many balances the same way. */
+typedef struct gnc_price_conversion_s GNCPriceConversion;
+
+/** @brief Look up the prices for converting balances from one commodity
+ * to another.
+ * @param pdb The pricedb
+ * @param balance_currency The commodity in which balances are expressed
+ * @param new_currency The commodity to which they should be converted
+ * @param t The time nearest to which prices should be used, or NULL for
+ * the latest prices.
+ * @return A new conversion, to be freed with gnc_price_conversion_free().
+ */
+GNCPriceConversion *
+gnc_pricedb_conversion_new (GNCPriceDB *pdb,
+                            const gnc_commodity *balance_currency,
+                            const gnc_commodity *new_currency,
+                            const Timespec *t);
+
+/** @brief Convert a balance with a conversion made by
+ * gnc_pricedb_conversion_new().  The result is the same as that of
+ * gnc_pricedb_convert_balance_latest_price() or
+ * gnc_pricedb_convert_balance_nearest_price() for the same arguments,
+ * provided the pricedb hasn't changed since.
+ */
+gnc_numeric
+gnc_price_conversion_apply (GNCPriceConversion *conv, gnc_numeric balance);
+
+void gnc_price_conversion_free (GNCPriceConversion *conv);
+
+/** A cache of conversions between any pairs of commodities, for code
+ * such as reports that converts many balances on a few days.  The
+ * cached prices are dropped whenever a price in the pricedb is added,
+ * removed or changed, so they are never stale.  Conversions at the
+ * latest prices match gnc_pricedb_convert_balance_latest_price();
+ * those nearest to a time are made for the canonical time of its day
+ * instead, so they match gnc_pricedb_convert_balance_nearest_price()
+ * only when given that time.  The cache must be freed before its
+ * pricedb is destroyed. */
+typedef struct gnc_price_conversion_cache_s GNCPriceConversionCache;
+
+GNCPriceConversionCache *
+gnc_price_conversion_cache_new (GNCPriceDB *pdb);
+
+void gnc_price_conversion_cache_free (GNCPriceConversionCache *cache);
+
+/** @brief Convert a balance using the most recent prices, as
+ * gnc_pricedb_convert_balance_latest_price() does.
+ */
+gnc_numeric
+gnc_price_conversion_cache_convert_latest (GNCPriceConversionCache *cache,
+                                           gnc_numeric balance,
+                                           const gnc_commodity *balance_currency,
+                                           const gnc_commodity *new_currency);
+
+/** @brief Convert a balance using the prices nearest to a day.  All
+ * times on one day share the conversion
+ * gnc_pricedb_convert_balance_nearest_price() makes for that day's
+ * canonical time (see timespecCanonicalDayTime()), so where a day has
+ * several prices the result may differ from converting at t itself.
+ */
+gnc_numeric
+gnc_price_conversion_cache_convert_nearest (GNCPriceConversionCache *cache,
+                                            gnc_numeric balance,
+                                            const gnc_commodity *balance_currency,
+                                            const gnc_commodity *new_currency,
+                                            Timespec t);
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
@@ -89,6 +89,98 @@ GList * gncBusinessGetOwnerList (QofBook *book, const char *type_name,
     return data.result;
 }
 
+/* The ID index is a table of type name -> (ID -> GList of objects),
+ * kept as book data so it goes away with the book. */
+#define GNC_BUSINESS_ID_INDEX "gnc-business-id-index"
+
+static void id_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    g_hash_table_destroy (data);
+}
+
+static void id_list_free (gpointer data)
+{
+    g_list_free (data);
+}
+
+static GHashTable * id_index_for_type (QofBook *book, QofIdTypeConst type_name,
+                                       gboolean create)
+{
+    GHashTable *types, *ids;
+
+    types = qof_book_get_data (book, GNC_BUSINESS_ID_INDEX);
+    if (!types)
+    {
+        if (!create) return NULL;
+        types = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                       (GDestroyNotify)g_hash_table_destroy);
+        qof_book_set_data_fin (book, GNC_BUSINESS_ID_INDEX, types,
+                               id_index_free);
+    }
+
+    ids = g_hash_table_lookup (types, type_name);
+    if (!ids && create)
+    {
+        ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                     id_list_free);
+        g_hash_table_insert (types, (gpointer)type_name, ids);
+    }
+    return ids;
+}
+
+void gncBusinessUpdateIDIndex (QofInstance *inst, const char *old_id,
+                               const char *new_id)
+{
+    QofBook *book;
+    GHashTable *ids;
+    GList *list;
+    gchar *key;
+
+    g_return_if_fail (QOF_IS_INSTANCE (inst));
+
+    book = qof_instance_get_book (inst);
+    /* The whole index is freed with the book; don't touch it while
+     * the book's objects are being torn down. */
+    if (!book || qof_book_shutting_down (book)) return;
+    ids = id_index_for_type (book, inst->e_type, TRUE);
+
+    if (old_id && g_hash_table_lookup_extended (ids, old_id, (gpointer *)&key,
+                                                (gpointer *)&list))
+    {
+        /* The list head may change, so take the entry out to edit it. */
+        g_hash_table_steal (ids, old_id);
+        list = g_list_remove (list, inst);
+        if (list)
+            g_hash_table_insert (ids, key, list);
+        else
+            g_free (key);
+    }
+
+    if (new_id)
+    {
+        list = g_hash_table_lookup (ids, new_id);
+        if (list)
+            /* Appending keeps the head, so the table needn't change. */
+            list = g_list_append (list, inst);
+        else
+            g_hash_table_insert (ids, g_strdup (new_id),
+                                 g_list_prepend (NULL, inst));
+    }
+}
+
+GList * gncBusinessLookupID (QofBook *book, QofIdTypeConst type_name,
+                             const char *id)
+{
+    GHashTable *ids;
+
+    g_return_val_if_fail (book, NULL);
+    g_return_val_if_fail (type_name, NULL);
+    g_return_val_if_fail (id, NULL);
+
+    ids = id_index_for_type (book, type_name, FALSE);
+    return ids ? g_hash_table_lookup (ids, id) : NULL;
+}
+
 gboolean gncBusinessIsPaymentAcctType (GNCAccountType type)
 {
     if (xaccAccountIsAssetLiabType(type) ||
@@ -92,5 +92,17 @@ OwnerList * gncBusinessGetOwnerList (QofBook *book, QofIdTypeConst type_name,
  * liabilities and equity accounts. */
 gboolean gncBusinessIsPaymentAcctType (GNCAccountType type);
 
+/** Moves inst from old_id to new_id in its book's index of business
+ * IDs (CUSTOMER_ID, VENDOR_ID, INVOICE_ID).  Either ID may be NULL.
+ * Called by the objects' ID setters, creators and destructors. */
+void gncBusinessUpdateIDIndex (QofInstance *inst, const char *old_id,
+                               const char *new_id);
+
+/** Returns the objects of the given type_name in the given book whose
+ * business ID is exactly id.  The list belongs to the index and must
+ * not be modified or freed. */
+GList * gncBusinessLookupID (QofBook *book, QofIdTypeConst type_name,
+                             const char *id);
+
 
 #endif /* GNC_BUSINESS_H_ */
@@ -319,6 +319,7 @@ GncCustomer *gncCustomerCreate (QofBook *book)
     qof_instance_init_data (&cust->inst, _GNC_MOD_NAME, book);
 
     cust->id = CACHE_INSERT ("");
+    gncBusinessUpdateIDIndex (&cust->inst, NULL, cust->id);
     cust->name = CACHE_INSERT ("");
     cust->notes = CACHE_INSERT ("");
     cust->addr = gncAddressCreate (book, &cust->inst);
@@ -354,6 +355,7 @@ static void gncCustomerFree (GncCustomer *cust)
 
     qof_event_gen (&cust->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessUpdateIDIndex (&cust->inst, cust->id, NULL);
     CACHE_REMOVE (cust->id);
     CACHE_REMOVE (cust->name);
     CACHE_REMOVE (cust->notes);
@@ -391,6 +393,8 @@ void gncCustomerSetID (GncCustomer *cust, const char *id)
 {
     if (!cust) return;
     if (!id) return;
+    if (!g_strcmp0 (cust->id, id)) return;
+    gncBusinessUpdateIDIndex (&cust->inst, cust->id, id);
     SET_STR(cust, cust->id, id);
     mark_customer (cust);
     gncCustomerCommitEdit (cust);
@@ -36,6 +36,8 @@
 #include "gncEntryP.h"
 #include "gnc-features.h"
 #include "gncInvoice.h"
+#include "gncInvoiceP.h"
+#include "gncTaxTableP.h"
 #include "gncOrder.h"
 
 struct _gncEntry
@@ -203,6 +205,8 @@ gboolean gncEntryPaymentStringToType (const char *str, GncEntryPaymentType *type
 G_INLINE_FUNC void mark_entry (GncEntry *entry);
 void mark_entry (GncEntry *entry)
 {
+    gncInvoiceInvalidateTotals (entry->invoice);
+    gncInvoiceInvalidateTotals (entry->bill);
     qof_instance_set_dirty(&entry->inst);
     qof_event_gen (&entry->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -1111,8 +1115,8 @@ void gncEntryComputeValue (gnc_numeric qty, gnc_numeric price,
     gnc_numeric result;
     gnc_numeric tax;
     gnc_numeric percent = gnc_numeric_create (100, 1);
-    gnc_numeric tpercent = gnc_numeric_zero ();
-    gnc_numeric tvalue = gnc_numeric_zero ();
+    gnc_numeric tpercent;
+    gnc_numeric tvalue;
 
     GList     * entries = gncTaxTableGetEntries (tax_table);
     GList     * node;
@@ -1123,30 +1127,9 @@ void gncEntryComputeValue (gnc_numeric qty, gnc_numeric price,
 
     /* Step 2: compute the pre-tax aggregate */
 
-    /* First, compute the aggregate tpercent and tvalue numbers */
-    for (node = entries; node; node = node->next)
-    {
-        GncTaxTableEntry *entry = node->data;
-        gnc_numeric amount = gncTaxTableEntryGetAmount (entry);
-
-        switch (gncTaxTableEntryGetType (entry))
-        {
-        case GNC_AMT_TYPE_VALUE:
-            tvalue = gnc_numeric_add (tvalue, amount, GNC_DENOM_AUTO,
-                                      GNC_HOW_DENOM_LCD);
-            break;
-        case GNC_AMT_TYPE_PERCENT:
-            tpercent = gnc_numeric_add (tpercent, amount, GNC_DENOM_AUTO,
-                                        GNC_HOW_DENOM_LCD);
-            break;
-        default:
-            g_warning ("Unknown tax type: %d", gncTaxTableEntryGetType (entry));
-            break;
-        }
-    }
-    /* now we need to convert from 5% -> .05 */
-    tpercent = gnc_numeric_div (tpercent, percent, GNC_DENOM_AUTO,
-                                GNC_HOW_DENOM_LCD);
+    /* First, get the aggregate tpercent (as a fraction) and tvalue
+     * numbers; the tax table keeps them between changes. */
+    gncTaxTableGetRates (tax_table, &tpercent, &tvalue);
 
     /* Next, actually compute the pre-tax aggregate value based on the
      * taxincluded flag.
@@ -36,6 +36,7 @@
 #include "Transaction.h"
 #include "Account.h"
 #include "gncBillTermP.h"
+#include "gncBusiness.h"
 #include "gncEntry.h"
 #include "gncEntryP.h"
 #include "gnc-features.h"
@@ -43,6 +44,7 @@
 #include "gncInvoice.h"
 #include "gncInvoiceP.h"
 #include "gncOwnerP.h"
+#include "gncTaxTableP.h"
 #include "engine-helpers.h"
 
 struct _gncInvoice
@@ -71,6 +73,14 @@ struct _gncInvoice
     Account       *posted_acc;
     Transaction   *posted_txn;
     GNCLot        *posted_lot;
+
+    /* Entry values and taxes summed by payment type (slot 0 holds any
+     * other type); valid until mark_invoice, a change to one of the
+     * entries, or a change to any tax table. */
+    gboolean      totals_valid;
+    guint         totals_taxtable_gen;
+    gnc_numeric   total_value[GNC_PAYMENT_CARD + 1];
+    gnc_numeric   total_tax[GNC_PAYMENT_CARD + 1];
 };
 
 struct _gncInvoiceClass
@@ -98,6 +108,7 @@ static void mark_invoice (GncInvoice *invoice);
 static void
 mark_invoice (GncInvoice *invoice)
 {
+    invoice->totals_valid = FALSE;
     qof_instance_set_dirty(&invoice->inst);
     qof_event_gen (&invoice->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -320,6 +331,7 @@ GncInvoice *gncInvoiceCreate (QofBook *book)
     qof_instance_init_data (&invoice->inst, _GNC_MOD_NAME, book);
 
     invoice->id = CACHE_INSERT ("");
+    gncBusinessUpdateIDIndex (&invoice->inst, NULL, invoice->id);
     invoice->notes = CACHE_INSERT ("");
     invoice->billing_id = CACHE_INSERT ("");
 
@@ -350,6 +362,7 @@ GncInvoice *gncInvoiceCopy (const GncInvoice *from)
     gncInvoiceBeginEdit(invoice);
 
     invoice->id = CACHE_INSERT (from->id);
+    gncBusinessUpdateIDIndex (&invoice->inst, NULL, invoice->id);
     invoice->notes = CACHE_INSERT (from->notes);
     invoice->billing_id = CACHE_INSERT (from->billing_id);
     invoice->active = from->active;
@@ -416,6 +429,7 @@ static void gncInvoiceFree (GncInvoice *invoice)
 
     qof_event_gen (&invoice->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessUpdateIDIndex (&invoice->inst, invoice->id, NULL);
     CACHE_REMOVE (invoice->id);
     CACHE_REMOVE (invoice->notes);
     CACHE_REMOVE (invoice->billing_id);
@@ -437,6 +451,8 @@ static void gncInvoiceFree (GncInvoice *invoice)
 void gncInvoiceSetID (GncInvoice *invoice, const char *id)
 {
     if (!invoice || !id) return;
+    if (!g_strcmp0 (invoice->id, id)) return;
+    gncBusinessUpdateIDIndex (&invoice->inst, invoice->id, id);
     SET_STR (invoice, invoice->id, id);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
@@ -606,6 +622,17 @@ void gncInvoiceSetPostedTxn (GncInvoice *invoice, Transaction *txn)
     gncInvoiceCommitEdit (invoice);
 }
 
+void gncInvoiceReplacePostedTxn (GncInvoice *invoice, Transaction *txn)
+{
+    if (!invoice || invoice->posted_txn == txn) return;
+    g_return_if_fail (invoice->posted_txn != NULL);
+
+    gncInvoiceBeginEdit (invoice);
+    invoice->posted_txn = txn;
+    mark_invoice (invoice);
+    gncInvoiceCommitEdit (invoice);
+}
+
 void gncInvoiceSetPostedLot (GncInvoice *invoice, GNCLot *lot)
 {
     if (!invoice) return;
@@ -862,16 +889,24 @@ GncOwnerType gncInvoiceGetOwnerType (const GncInvoice *invoice)
     return (gncOwnerGetType (owner));
 }
 
-static gnc_numeric
-gncInvoiceGetTotalInternal (GncInvoice *invoice, gboolean use_value,
-                            gboolean use_tax,
-                            gboolean use_payment_type, GncEntryPaymentType type)
+void gncInvoiceInvalidateTotals (GncInvoice *invoice)
+{
+    if (!invoice) return;
+    invoice->totals_valid = FALSE;
+}
+
+static void
+gncInvoiceComputeTotals (GncInvoice *invoice)
 {
     GList *node;
-    gnc_numeric total = gnc_numeric_zero();
     gboolean is_cust_doc, is_cn;
+    int i;
 
-    g_return_val_if_fail (invoice, total);
+    for (i = 0; i <= GNC_PAYMENT_CARD; i++)
+    {
+        invoice->total_value[i] = gnc_numeric_zero();
+        invoice->total_tax[i] = gnc_numeric_zero();
+    }
 
     /* Is the current document an invoice/credit note related to a customer or a vendor/employee ?
      * The GncEntry code needs to know to return the proper entry amounts
@@ -882,28 +917,58 @@ gncInvoiceGetTotalInternal (GncInvoice *invoice, gboolean use_value,
     for (node = gncInvoiceGetEntries(invoice); node; node = node->next)
     {
         GncEntry *entry = node->data;
+        GncEntryPaymentType type = gncEntryGetBillPayment (entry);
         gnc_numeric value, tax;
 
-        if (use_payment_type && gncEntryGetBillPayment (entry) != type)
-            continue;
+        if (type != GNC_PAYMENT_CASH && type != GNC_PAYMENT_CARD)
+            type = 0;
 
         value = gncEntryGetDocValue (entry, FALSE, is_cust_doc, is_cn);
         if (gnc_numeric_check (value) == GNC_ERROR_OK)
-        {
-            if (use_value)
-                total = gnc_numeric_add (total, value, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-        }
+            invoice->total_value[type] =
+                gnc_numeric_add (invoice->total_value[type], value,
+                                 GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
         else
             g_warning ("bad value in our entry");
 
+        tax = gncEntryGetDocTaxValue (entry, FALSE, is_cust_doc, is_cn);
+        if (gnc_numeric_check (tax) == GNC_ERROR_OK)
+            invoice->total_tax[type] =
+                gnc_numeric_add (invoice->total_tax[type], tax,
+                                 GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        else
+            g_warning ("bad tax-value in our entry");
+    }
+
+    invoice->totals_taxtable_gen = gncTaxTableGetGeneration ();
+    invoice->totals_valid = TRUE;
+}
+
+static gnc_numeric
+gncInvoiceGetTotalInternal (GncInvoice *invoice, gboolean use_value,
+                            gboolean use_tax,
+                            gboolean use_payment_type, GncEntryPaymentType type)
+{
+    gnc_numeric total = gnc_numeric_zero();
+    int i;
+
+    g_return_val_if_fail (invoice, total);
+
+    if (!invoice->totals_valid ||
+            invoice->totals_taxtable_gen != gncTaxTableGetGeneration ())
+        gncInvoiceComputeTotals (invoice);
+
+    for (i = 0; i <= GNC_PAYMENT_CARD; i++)
+    {
+        /* Slot 0 collects unknown types, which never match a request. */
+        if (use_payment_type && (i == 0 || i != type))
+            continue;
+        if (use_value)
+            total = gnc_numeric_add (total, invoice->total_value[i],
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
         if (use_tax)
-        {
-            tax = gncEntryGetDocTaxValue (entry, FALSE, is_cust_doc, is_cn);
-            if (gnc_numeric_check (tax) == GNC_ERROR_OK)
-                total = gnc_numeric_add (total, tax, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            else
-                g_warning ("bad tax-value in our entry");
-        }
+            total = gnc_numeric_add (total, invoice->total_tax[i],
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
     }
     return total;
 }
@@ -1623,6 +1688,100 @@ Transaction * gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
     return txn;
 }
 
+/* Collect every account posting this invoice can touch, so a batch
+ * can hold them all open while it works. */
+static void
+gncInvoicePostCollectAccounts (GncInvoice *invoice, GHashTable *accounts)
+{
+    gboolean is_cust_doc;
+    GList *iter;
+
+    is_cust_doc = (gncInvoiceGetOwnerType (invoice) == GNC_OWNER_CUSTOMER);
+    if (gncInvoiceGetOwnerType (invoice) == GNC_OWNER_EMPLOYEE)
+    {
+        const GncOwner *owner = gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+        Account *ccard_acct = gncEmployeeGetCCard (gncOwnerGetEmployee (owner));
+        if (ccard_acct)
+            g_hash_table_insert (accounts, ccard_acct, ccard_acct);
+    }
+
+    for (iter = gncInvoiceGetEntries (invoice); iter; iter = iter->next)
+    {
+        GncEntry *entry = iter->data;
+        Account *this_acc;
+        GncTaxTable *table;
+        GList *tax_iter;
+
+        this_acc = (is_cust_doc ? gncEntryGetInvAccount (entry) :
+                    gncEntryGetBillAccount (entry));
+        if (this_acc)
+            g_hash_table_insert (accounts, this_acc, this_acc);
+
+        table = (is_cust_doc ? gncEntryGetInvTaxTable (entry) :
+                 gncEntryGetBillTaxTable (entry));
+        if (!table)
+            continue;
+        for (tax_iter = gncTaxTableGetEntries (table); tax_iter;
+                tax_iter = tax_iter->next)
+        {
+            Account *tax_acc = gncTaxTableEntryGetAccount (tax_iter->data);
+            if (tax_acc)
+                g_hash_table_insert (accounts, tax_acc, tax_acc);
+        }
+    }
+}
+
+GList *
+gncInvoicePostListToAccount (GList *invoices, Account *acc,
+                             Timespec *post_date, Timespec *due_date,
+                             const char *memo, gboolean accumulatesplits,
+                             gboolean autopay)
+{
+    GHashTable *accounts;
+    GList *iter, *edited, *failed = NULL;
+    QofBackend *be;
+
+    if (!acc) return g_list_copy (invoices);
+
+    accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (accounts, acc, acc);
+    for (iter = invoices; iter; iter = iter->next)
+        if (iter->data && !gncInvoiceIsPosted (iter->data))
+            gncInvoicePostCollectAccounts (iter->data, accounts);
+
+    /* Let an SQL backend store the whole batch in one transaction. */
+    be = qof_book_get_backend (qof_instance_get_book (acc));
+    qof_backend_begin_group_commit (be);
+
+    /* Nested edits defer each account's commit, and with it the
+     * backend write and balance recomputation, to the very end. */
+    edited = g_hash_table_get_keys (accounts);
+    for (iter = edited; iter; iter = iter->next)
+        xaccAccountBeginEdit (iter->data);
+
+    /* Let the GUI catch up with one event per invoice, account,
+     * transaction and lot instead of one per split and entry. */
+    qof_event_suspend_coalescing ();
+    for (iter = invoices; iter; iter = iter->next)
+    {
+        GncInvoice *invoice = iter->data;
+
+        if (!invoice ||
+                !gncInvoicePostToAccount (invoice, acc, post_date, due_date,
+                                          memo, accumulatesplits, autopay))
+            failed = g_list_prepend (failed, invoice);
+    }
+
+    for (iter = edited; iter; iter = iter->next)
+        xaccAccountCommitEdit (iter->data);
+    qof_backend_end_group_commit (be);
+    qof_event_resume ();
+
+    g_list_free (edited);
+    g_hash_table_destroy (accounts);
+    return g_list_reverse (failed);
+}
+
 gboolean
 gncInvoiceUnpost (GncInvoice *invoice, gboolean reset_tax_tables)
 {
@@ -213,6 +213,25 @@ gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
                          const char *memo, gboolean accumulatesplits,
                          gboolean autopay);
 
+/**
+ * Post each invoice in the list to the given account, as
+ * gncInvoicePostToAccount() would, but as one batch: events are held
+ * back until the end, every account the invoices post to is kept open
+ * for editing so that it is committed only once, and a backend that
+ * supports it stores the whole batch at once (see
+ * qof_backend_begin_group_commit()).  Each object created or changed
+ * generates a single event afterwards.
+ *
+ * Returns the list of invoices that could not be posted (already
+ * posted, or no splits could be created), or NULL if all of them were.
+ * The caller must free the returned list with g_list_free().
+ */
+GList *
+gncInvoicePostListToAccount (GList *invoices, Account *acc,
+                             Timespec *posted_date, Timespec *due_date,
+                             const char *memo, gboolean accumulatesplits,
+                             gboolean autopay);
+
 /**
  * Unpost this invoice.  This will destroy the posted transaction and
  * return the invoice to its unposted state.  It may leave empty lots
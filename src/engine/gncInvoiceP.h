@@ -39,6 +39,11 @@ gchar *gncInvoiceNextID (QofBook *book, const GncOwner *owner);
 void gncInvoiceSetPostedAcc (GncInvoice *invoice, Account *acc);
 void gncInvoiceSetPostedTxn (GncInvoice *invoice, Transaction *txn);
 void gncInvoiceSetPostedLot (GncInvoice *invoice, GNCLot *lot);
+/* Points a posted invoice at a new copy of its posted transaction, for
+ * backends replacing the transaction wholesale. */
+void gncInvoiceReplacePostedTxn (GncInvoice *invoice, Transaction *txn);
+/* Forget the cached totals; called by gncEntry when an entry changes. */
+void gncInvoiceInvalidateTotals (GncInvoice *invoice);
 //void gncInvoiceSetPaidTxn (GncInvoice *invoice, Transaction *txn);
 
 #define gncInvoiceSetGUID(I,G) qof_instance_set_guid(QOF_INSTANCE(I),(G))
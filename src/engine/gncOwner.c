@@ -1506,6 +1506,175 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
 }
 
 
+/* ============================================================== */
+/* Aging */
+
+#define AGING_BUCKET_SECS (30 * 24 * 60 * 60)
+
+typedef struct
+{
+    GncOwner owner;
+    gnc_numeric buckets[GNC_OWNER_AGING_BUCKETS];
+} OwnerAgingRow;
+
+struct _gncOwnerAging
+{
+    /* End owner's GUID -> OwnerAgingRow */
+    GHashTable *rows;
+};
+
+static gint
+aging_bucket_for (time64 date, time64 as_of)
+{
+    gint bucket;
+
+    /* Bucket i < 4 holds dates before as_of - (3 - i) * 30 days. */
+    for (bucket = 0; bucket < GNC_OWNER_AGING_BUCKETS - 1; bucket++)
+        if (date < as_of - (GNC_OWNER_AGING_BUCKETS - 2 - bucket) *
+                (time64)AGING_BUCKET_SECS)
+            return bucket;
+    return GNC_OWNER_AGING_BUCKETS - 1;
+}
+
+/* The lot's balance counting only the splits posted by as_of. */
+static gnc_numeric
+aging_lot_balance (GNCLot *lot, time64 as_of)
+{
+    gnc_numeric balance = gnc_numeric_zero ();
+    SplitList *node;
+
+    for (node = gnc_lot_get_split_list (lot); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (xaccTransGetDate (xaccSplitGetParent (split)) > as_of)
+            continue;
+        balance = gnc_numeric_add (balance, xaccSplitGetAmount (split),
+                                   GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    }
+    return balance;
+}
+
+GncOwnerAging *
+gncOwnerAgingNew (Account *account, time64 as_of, gboolean use_due_date)
+{
+    GncOwnerAging *aging;
+    GList *lots, *node;
+
+    g_return_val_if_fail (account, NULL);
+
+    aging = g_new0 (GncOwnerAging, 1);
+    aging->rows = g_hash_table_new_full (guid_hash_to_guint,
+                                         guid_g_hash_table_equal,
+                                         NULL, g_free);
+
+    /* Lots closed since as_of were still open then, so look at them
+     * all. */
+    lots = xaccAccountGetLotList (account);
+    for (node = lots; node; node = node->next)
+    {
+        GNCLot *lot = node->data;
+        GncOwner lot_owner;
+        const GncOwner *end_owner;
+        const GncGUID *guid;
+        GncInvoice *invoice;
+        OwnerAgingRow *row;
+        Split *split;
+        gnc_numeric balance;
+        time64 date;
+        gint bucket;
+
+        split = gnc_lot_get_earliest_split (lot);
+        if (!split || xaccTransGetDate (xaccSplitGetParent (split)) > as_of)
+            continue;
+        if (!gncOwnerGetOwnerFromLot (lot, &lot_owner))
+            continue;
+        end_owner = gncOwnerGetEndOwner (&lot_owner);
+        guid = gncOwnerGetGUID (end_owner);
+        if (!guid)
+            continue;
+
+        row = g_hash_table_lookup (aging->rows, guid);
+        if (!row)
+        {
+            gint i;
+            row = g_new (OwnerAgingRow, 1);
+            gncOwnerCopy (end_owner, &row->owner);
+            for (i = 0; i < GNC_OWNER_AGING_BUCKETS; i++)
+                row->buckets[i] = gnc_numeric_zero ();
+            g_hash_table_insert (aging->rows,
+                                 (gpointer)gncOwnerGetGUID (&row->owner), row);
+        }
+
+        /* Owners whose lots were all paid off by as_of still get a
+         * row, for reports listing zero balances. */
+        balance = aging_lot_balance (lot, as_of);
+        if (gnc_numeric_zero_p (balance))
+            continue;
+
+        invoice = gncInvoiceGetInvoiceFromLot (lot);
+        if (invoice)
+            date = timespecToTime64 (use_due_date ?
+                                     gncInvoiceGetDateDue (invoice) :
+                                     gncInvoiceGetDatePosted (invoice));
+        else
+            date = xaccTransGetDate (xaccSplitGetParent (split));
+
+        bucket = aging_bucket_for (date, as_of);
+        row->buckets[bucket] = gnc_numeric_add (row->buckets[bucket], balance,
+                                                GNC_DENOM_AUTO,
+                                                GNC_HOW_DENOM_LCD);
+    }
+    g_list_free (lots);
+
+    return aging;
+}
+
+void
+gncOwnerAgingDestroy (GncOwnerAging *aging)
+{
+    if (!aging) return;
+    g_hash_table_destroy (aging->rows);
+    g_free (aging);
+}
+
+OwnerList *
+gncOwnerAgingGetOwners (const GncOwnerAging *aging)
+{
+    GList *owners = NULL, *rows, *node;
+
+    g_return_val_if_fail (aging, NULL);
+
+    rows = g_hash_table_get_values (aging->rows);
+    for (node = rows; node; node = node->next)
+    {
+        OwnerAgingRow *row = node->data;
+        GncOwner *owner = gncOwnerNew ();
+
+        gncOwnerCopy (&row->owner, owner);
+        owners = g_list_prepend (owners, owner);
+    }
+    g_list_free (rows);
+    return owners;
+}
+
+gnc_numeric
+gncOwnerAgingGetBucket (const GncOwnerAging *aging, const GncOwner *owner,
+                        gint bucket)
+{
+    OwnerAgingRow *row;
+    const GncGUID *guid;
+
+    g_return_val_if_fail (aging, gnc_numeric_zero ());
+    g_return_val_if_fail (owner, gnc_numeric_zero ());
+    g_return_val_if_fail (bucket >= 0 && bucket < GNC_OWNER_AGING_BUCKETS,
+                          gnc_numeric_zero ());
+
+    guid = gncOwnerGetGUID (gncOwnerGetEndOwner (owner));
+    row = guid ? g_hash_table_lookup (aging->rows, guid) : NULL;
+    return row ? row->buckets[bucket] : gnc_numeric_zero ();
+}
+
 /* XXX: Yea, this is broken, but it should work fine for Queries.
  * We're single-threaded, right?
  */
@@ -55,6 +55,7 @@ typedef enum
 #include "gncInvoice.h"
 #include "Account.h"
 #include "gnc-lot.h"
+#include "gncBusiness.h"
 
 /** \name QOF handling
 
@@ -314,6 +315,39 @@ gnc_numeric
 gncOwnerGetBalanceInCurrency (const GncOwner *owner,
                               const gnc_commodity *report_currency);
 
+/** @name Aging
+ *  Business lot balances of an A/R or A/P account as they stood on a
+ *  report date, grouped by owner and bucketed by age the way the aging
+ *  reports do:  more than 90 days, 61-90, 31-60 and 0-30 days before
+ *  the report date, and current (on or after the report date).
+ *  @{ */
+#define GNC_OWNER_AGING_BUCKETS 5
+
+typedef struct _gncOwnerAging GncOwnerAging;
+
+/** Computes the aging of account's lots as of as_of, in a single pass
+ *  over the account's lots.  A lot's balance counts only the splits
+ *  posted by as_of, so a lot paid off since then still shows, and one
+ *  opened later doesn't.  Invoice lots are aged by the invoice's due
+ *  date if use_due_date is TRUE and by its posted date otherwise;
+ *  payment lots by their opening transaction's posted date.  The
+ *  result is a snapshot: it doesn't follow later changes. */
+GncOwnerAging * gncOwnerAgingNew (Account *account, time64 as_of,
+                                  gboolean use_due_date);
+void gncOwnerAgingDestroy (GncOwnerAging *aging);
+
+/** Returns the end owners (customers, vendors, employees) with lots
+ *  posted by the report date, including those that had paid them all
+ *  off by then.  The caller must free each owner with gncOwnerFree()
+ *  and the list with g_list_free(). */
+OwnerList * gncOwnerAgingGetOwners (const GncOwnerAging *aging);
+
+/** Returns the sum of owner's lot balances in the given bucket,
+ *  oldest first; 0 <= bucket < GNC_OWNER_AGING_BUCKETS. */
+gnc_numeric gncOwnerAgingGetBucket (const GncOwnerAging *aging,
+                                    const GncOwner *owner, gint bucket);
+/** @} */
+
 #define OWNER_TYPE        "type"
 #define OWNER_TYPE_STRING "type-string"  /**< Allows the type to be handled externally. */
 #define OWNER_CUSTOMER    "customer"
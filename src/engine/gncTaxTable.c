@@ -41,6 +41,12 @@ struct _gncTaxTable
     GncTaxTableEntryList*  entries;
     Timespec        modtime;      /* internal date of last modtime */
 
+    /* The entries' percent (as a fraction) and value amounts summed,
+     * recomputed on demand after mod_table. */
+    gboolean        rates_valid;
+    gnc_numeric     rate_percent;
+    gnc_numeric     rate_value;
+
     /* See src/doc/business.txt for an explanation of the following */
     /* Code that handles this is *identical* to that in gncBillTerm */
     gint64          refcount;
@@ -162,10 +168,70 @@ maybe_resort_list (GncTaxTable *table)
     bi->tables = g_list_sort (bi->tables, (GCompareFunc)gncTaxTableCompare);
 }
 
+/* Bumped on every change to any tax table, so cached invoice totals
+ * can tell they are stale without walking their entries. */
+static guint taxtable_generation = 0;
+
 static inline void
 mod_table (GncTaxTable *table)
 {
     timespecFromTime64 (&table->modtime, gnc_time (NULL));
+    table->rates_valid = FALSE;
+    taxtable_generation++;
+}
+
+guint gncTaxTableGetGeneration (void)
+{
+    return taxtable_generation;
+}
+
+void gncTaxTableGetRates (const GncTaxTable *table, gnc_numeric *percent,
+                          gnc_numeric *value)
+{
+    GncTaxTable *t = (GncTaxTable *)table;
+    GList *node;
+
+    if (!table)
+    {
+        *percent = gnc_numeric_zero ();
+        *value = gnc_numeric_zero ();
+        return;
+    }
+
+    if (!t->rates_valid)
+    {
+        t->rate_percent = gnc_numeric_zero ();
+        t->rate_value = gnc_numeric_zero ();
+        for (node = t->entries; node; node = node->next)
+        {
+            GncTaxTableEntry *entry = node->data;
+
+            switch (entry->type)
+            {
+            case GNC_AMT_TYPE_VALUE:
+                t->rate_value = gnc_numeric_add (t->rate_value, entry->amount,
+                                                 GNC_DENOM_AUTO,
+                                                 GNC_HOW_DENOM_LCD);
+                break;
+            case GNC_AMT_TYPE_PERCENT:
+                t->rate_percent = gnc_numeric_add (t->rate_percent, entry->amount,
+                                                   GNC_DENOM_AUTO,
+                                                   GNC_HOW_DENOM_LCD);
+                break;
+            default:
+                g_warning ("Unknown tax type: %d", entry->type);
+                break;
+            }
+        }
+        /* now we need to convert from 5% -> .05 */
+        t->rate_percent = gnc_numeric_div (t->rate_percent,
+                                           gnc_numeric_create (100, 1),
+                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        t->rates_valid = TRUE;
+    }
+
+    *percent = t->rate_percent;
+    *value = t->rate_value;
 }
 
 static inline void addObj (GncTaxTable *table)
@@ -802,18 +868,14 @@ GncTaxTable* gncTaxTableEntryGetTable( const GncTaxTableEntry* entry )
 
 int gncTaxTableEntryCompare (const GncTaxTableEntry *a, const GncTaxTableEntry *b)
 {
-    char *name_a, *name_b;
     int retval;
 
     if (!a && !b) return 0;
     if (!a) return -1;
     if (!b) return 1;
 
-    name_a = gnc_account_get_full_name (a->account);
-    name_b = gnc_account_get_full_name (b->account);
-    retval = g_strcmp0(name_a, name_b);
-    g_free(name_a);
-    g_free(name_b);
+    retval = g_strcmp0 (xaccAccountGetFullName (a->account),
+                        xaccAccountGetFullName (b->account));
 
     if (retval)
         return retval;
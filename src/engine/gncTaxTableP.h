@@ -40,6 +40,14 @@ void gncTaxTableMakeInvisible (GncTaxTable *table);
 
 gboolean gncTaxTableGetInvisible (const GncTaxTable *table);
 
+/* A counter bumped whenever any tax table changes. */
+guint gncTaxTableGetGeneration (void);
+
+/* The table's percent entries summed as a fraction (5% -> .05) and its
+ * value entries summed, cached until the table next changes. */
+void gncTaxTableGetRates (const GncTaxTable *table, gnc_numeric *percent,
+                          gnc_numeric *value);
+
 GncTaxTable* gncTaxTableEntryGetTable( const GncTaxTableEntry* entry );
 
 #define gncTaxTableSetGUID(E,G) qof_instance_set_guid(QOF_INSTANCE(E),(G))
@@ -34,6 +34,7 @@
 
 #include "gnc-commodity.h"
 #include "gncAddressP.h"
+#include "gncBusiness.h"
 #include "gncBillTermP.h"
 #include "gncInvoice.h"
 #include "gncJobP.h"
@@ -467,6 +468,7 @@ GncVendor *gncVendorCreate (QofBook *book)
     qof_instance_init_data (&vendor->inst, _GNC_MOD_NAME, book);
 
     vendor->id = CACHE_INSERT ("");
+    gncBusinessUpdateIDIndex (&vendor->inst, NULL, vendor->id);
     vendor->name = CACHE_INSERT ("");
     vendor->notes = CACHE_INSERT ("");
     vendor->addr = gncAddressCreate (book, &vendor->inst);
@@ -497,6 +499,7 @@ static void gncVendorFree (GncVendor *vendor)
 
     qof_event_gen (&vendor->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessUpdateIDIndex (&vendor->inst, vendor->id, NULL);
     CACHE_REMOVE (vendor->id);
     CACHE_REMOVE (vendor->name);
     CACHE_REMOVE (vendor->notes);
@@ -530,6 +533,8 @@ void gncVendorSetID (GncVendor *vendor, const char *id)
 {
     if (!vendor) return;
     if (!id) return;
+    if (!g_strcmp0 (vendor->id, id)) return;
+    gncBusinessUpdateIDIndex (&vendor->inst, vendor->id, id);
     SET_STR(vendor, vendor->id, id);
     mark_vendor (vendor);
     gncVendorCommitEdit (vendor);
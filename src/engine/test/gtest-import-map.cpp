@@ -270,6 +270,26 @@ TEST_F(ImapBayesTest, FindAccountBayes)
     EXPECT_EQ(nullptr, account);
 }
 
+TEST_F(ImapBayesTest, FindAccountBayesAfterAdd)
+{
+    // The first lookup compiles the (empty) map; later additions must be
+    // seen by subsequent lookups without recompiling it.
+    qof_instance_increase_editlevel(QOF_INSTANCE(t_bank_account));
+    EXPECT_EQ(nullptr, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account1);
+    EXPECT_EQ(t_expense_account1,
+              gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    EXPECT_EQ(nullptr, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    EXPECT_EQ(t_expense_account2,
+              gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    EXPECT_EQ(nullptr, gnc_account_imap_find_account_bayes(t_imap, t_list2));
+    qof_instance_reset_editlevel(QOF_INSTANCE(t_bank_account));
+}
+
 TEST_F(ImapBayesTest, AddAccountBayes)
 {
     // prevent the embedded beginedit/commitedit from doing anything
@@ -181,6 +181,106 @@ test_commodity(void)
         }
     }
 
+    {
+        gnc_commodity_table *tbl;
+        gnc_commodity *rub;
+        QofBook *book;
+
+        book = qof_book_new ();
+        tbl = gnc_commodity_table_new ();
+        rub = gnc_commodity_new(book, "Russian Ruble", GNC_COMMODITY_NS_CURRENCY,
+                                "RUB", "643", 100);
+        do_test(gnc_commodity_table_insert(tbl, rub) == rub,
+                "insert currency");
+        do_test(gnc_commodity_table_lookup(tbl, GNC_COMMODITY_NS_CURRENCY,
+                                           "RUB") == rub,
+                "lookup currency");
+        do_test(gnc_commodity_table_lookup(tbl, GNC_COMMODITY_NS_ISO,
+                                           "RUB") == rub,
+                "lookup currency in legacy namespace");
+        do_test(gnc_commodity_table_lookup(tbl, GNC_COMMODITY_NS_CURRENCY,
+                                           "RUR") == rub,
+                "lookup currency by old ISO code");
+        do_test(gnc_commodity_table_lookup_unique(tbl, "CURRENCY::RUR") == rub,
+                "lookup unique currency by old ISO code");
+        gnc_commodity_table_remove(tbl, rub);
+        do_test(gnc_commodity_table_lookup(tbl, GNC_COMMODITY_NS_CURRENCY,
+                                           "RUB") == NULL,
+                "lookup removed currency");
+        do_test(gnc_commodity_table_lookup(tbl, GNC_COMMODITY_NS_CURRENCY,
+                                           "RUR") == NULL,
+                "lookup removed currency by old ISO code");
+        gnc_commodity_table_destroy (tbl);
+        qof_book_destroy (book);
+    }
+
+}
+
+static void
+test_collector(void)
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity *usd = gnc_commodity_new (book, "US Dollar", "ISO4217",
+                                            "USD", "840", 100);
+    gnc_commodity *eur = gnc_commodity_new (book, "Euro", "ISO4217",
+                                            "EUR", "978", 100);
+    GncCommodityCollector *collector = gnc_commodity_collector_new ();
+    GncCommodityCollector *other = gnc_commodity_collector_new ();
+    CommodityList *commodities;
+
+    do_test (gnc_commodity_collector_get_n_commodities (collector) == 0 &&
+             gnc_numeric_zero_p (gnc_commodity_collector_get_amount (collector,
+                                                                     usd)),
+             "collector starts empty");
+
+    gnc_commodity_collector_add_amount (collector, usd,
+                                        gnc_numeric_create (150, 100));
+    gnc_commodity_collector_add_amount (collector, eur,
+                                        gnc_numeric_create (3, 1));
+    gnc_commodity_collector_add_amount (collector, usd,
+                                        gnc_numeric_create (25, 10));
+    do_test (gnc_commodity_collector_get_n_commodities (collector) == 2,
+             "collector keeps one total per commodity");
+    do_test (gnc_numeric_equal (gnc_commodity_collector_get_amount (collector,
+                                                                    usd),
+                                gnc_numeric_create (4, 1)),
+             "collector adds amounts of the same commodity");
+    commodities = gnc_commodity_collector_get_commodities (collector);
+    do_test (g_list_length (commodities) == 2 &&
+             commodities->data == eur && commodities->next->data == usd,
+             "collector lists the most recently seen commodity first");
+    g_list_free (commodities);
+
+    gnc_commodity_collector_add_amount (other, usd,
+                                        gnc_numeric_create (1, 1));
+    gnc_commodity_collector_add_collector (collector, other);
+    do_test (gnc_numeric_equal (gnc_commodity_collector_get_amount (collector,
+                                                                    usd),
+                                gnc_numeric_create (5, 1)),
+             "collector adds another collector");
+    gnc_commodity_collector_subtract_collector (collector, other);
+    gnc_commodity_collector_subtract_collector (collector, other);
+    do_test (gnc_numeric_equal (gnc_commodity_collector_get_amount (collector,
+                                                                    usd),
+                                gnc_numeric_create (3, 1)) &&
+             gnc_numeric_equal (gnc_commodity_collector_get_amount (collector,
+                                                                    eur),
+                                gnc_numeric_create (3, 1)),
+             "collector subtracts another collector");
+
+    gnc_commodity_collector_reset (collector);
+    commodities = gnc_commodity_collector_get_commodities (collector);
+    do_test (gnc_commodity_collector_get_n_commodities (collector) == 0 &&
+             commodities == NULL &&
+             gnc_numeric_zero_p (gnc_commodity_collector_get_amount (collector,
+                                                                     eur)),
+             "collector reset forgets all totals");
+
+    gnc_commodity_collector_destroy (other);
+    gnc_commodity_collector_destroy (collector);
+    gnc_commodity_destroy (eur);
+    gnc_commodity_destroy (usd);
+    qof_book_destroy (book);
 }
 
 int
@@ -192,6 +292,7 @@ main (int argc, char **argv)
     gnc_commodity_table_register();
 
     test_commodity();
+    test_collector();
 
     print_test_results();
 
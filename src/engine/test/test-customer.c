@@ -31,6 +31,7 @@
 
 #include "cashobjects.h"
 #include "gncCustomerP.h"
+#include "gncIDSearch.h"
 #include "gncInvoiceP.h"
 #include "gncJobP.h"
 #include "test-stuff.h"
@@ -132,6 +133,29 @@ test_customer (void)
         do_test (gncCustomerLookup (book, guid) == customer, "Entity Table");
     }
 
+    /* Test the ID index */
+    {
+        GncCustomer *other = gncCustomerCreate (book);
+
+        gncCustomerSetID (customer, "C-100");
+        gncCustomerSetID (other, "C-100x");
+        do_test (gnc_search_customer_on_id (book, "C-100") == customer,
+                 "ID search exact");
+        do_test (gnc_search_customer_on_id (book, "C-10") == NULL,
+                 "ID search no prefix match");
+
+        gncCustomerSetID (customer, "C-200");
+        do_test (gnc_search_customer_on_id (book, "C-100") == NULL,
+                 "ID search old id dropped");
+        do_test (gnc_search_customer_on_id (book, "C-200") == customer,
+                 "ID search new id");
+
+        gncCustomerBeginEdit (other);
+        gncCustomerDestroy (other);
+        do_test (gnc_search_customer_on_id (book, "C-100x") == NULL,
+                 "ID search after destroy");
+    }
+
     /* Note: JobList is tested from the Job tests */
     qof_book_destroy (book);
 }
@@ -30,6 +30,8 @@ extern void test_suite_account();
 extern void test_suite_budget();
 extern void test_suite_gncEntry();
 extern void test_suite_gncInvoice();
+extern void test_suite_scrub();
+extern void test_suite_scrub_business();
 extern void test_suite_transaction();
 extern void test_suite_split();
 extern void test_suite_engine_kvp_properties (void);
@@ -51,6 +53,8 @@ main (int   argc,
     test_suite_budget();
     test_suite_gncEntry();
     test_suite_gncInvoice();
+    test_suite_scrub();
+    test_suite_scrub_business();
     test_suite_transaction();
     test_suite_split();
     test_suite_engine_kvp_properties ();
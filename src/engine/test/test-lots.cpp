@@ -36,11 +36,188 @@ extern "C"
 #include "test-stuff.h"
 #include "test-engine-stuff.h"
 #include "Transaction.h"
+#include "gnc-lot.h"
+#include "cap-gains.h"
 }
 
 static gint transaction_num = 320;
 static gint	max_iterate = 10;
 
+/* The cached lot balance must agree with a fresh sum of the splits. */
+static gpointer
+check_lot_balance (GNCLot *lot, gpointer data)
+{
+    gnc_numeric sum = gnc_numeric_zero ();
+    SplitList *node;
+
+    for (node = gnc_lot_get_split_list (lot); node; node = node->next)
+        sum = gnc_numeric_add_fixed (sum, xaccSplitGetAmount (static_cast<Split*>(node->data)));
+    if (!gnc_numeric_equal (sum, gnc_lot_get_balance (lot)))
+        *static_cast<gboolean*>(data) = FALSE;
+    return NULL;
+}
+
+static void
+check_account_lot_balances (Account *acc, gpointer data)
+{
+    xaccAccountForEachLot (acc, check_lot_balance, data);
+}
+
+/* Negates the first split's amount the way the QOF setter does. */
+static gpointer
+negate_lot_split (GNCLot *lot, gpointer data)
+{
+    QofSetterFunc set_amount = *static_cast<QofSetterFunc*>(data);
+    SplitList *splits = gnc_lot_get_split_list (lot);
+    Split *split;
+
+    if (!splits) return NULL;
+    split = static_cast<Split*>(splits->data);
+    reinterpret_cast<void(*)(Split*, gnc_numeric)>(set_amount)
+        (split, gnc_numeric_neg (xaccSplitGetAmount (split)));
+    return NULL;
+}
+
+static void
+negate_account_lot_splits (Account *acc, gpointer data)
+{
+    xaccAccountForEachLot (acc, negate_lot_split, data);
+}
+
+static void
+compute_account_gains (Account *acc, gpointer data)
+{
+    xaccAccountComputeCapGains (acc, NULL);
+}
+
+static Account *
+make_account (QofBook *book, const char *name, GNCAccountType type,
+              gnc_commodity *commodity)
+{
+    Account *acc = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetType (acc, type);
+    xaccAccountSetCommodity (acc, commodity);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (gnc_book_get_root_account (book), acc);
+    return acc;
+}
+
+/* Trades shares for cash in whole currency units; returns the stock split. */
+static Split *
+make_trade (QofBook *book, Account *stock, Account *cash,
+            gnc_commodity *currency, gint day, gint64 shares, gint64 value)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *stock_split = xaccMallocSplit (book);
+    Split *cash_split = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans,
+                                          gnc_dmy2timespec (day, 1, 2015).tv_sec);
+    xaccSplitSetParent (stock_split, trans);
+    xaccSplitSetParent (cash_split, trans);
+    xaccSplitSetAccount (stock_split, stock);
+    xaccSplitSetAccount (cash_split, cash);
+    xaccSplitSetAmount (stock_split, gnc_numeric_create (shares, 1));
+    xaccSplitSetValue (stock_split, gnc_numeric_create (value, 1));
+    xaccSplitSetAmount (cash_split, gnc_numeric_create (-value, 1));
+    xaccSplitSetValue (cash_split, gnc_numeric_create (-value, 1));
+    xaccTransCommitEdit (trans);
+    return stock_split;
+}
+
+struct EventCount
+{
+    QofInstance *watched;
+    gint modified;
+};
+
+static void
+count_modify_events (QofInstance *ent, QofEventId event_type,
+                     gpointer handler_data, gpointer event_data)
+{
+    EventCount *count = static_cast<EventCount*>(handler_data);
+
+    if (ent == count->watched && event_type == QOF_EVENT_MODIFY)
+        count->modified++;
+}
+
+/* Buying 10 shares for 100.00 and selling 4 of them for 60.00 realizes
+ * a gain of 20.00: the sale's share of the lot's cost is 40.00. */
+static void
+test_gains_values (void)
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity_table *table = gnc_commodity_table_get_table (book);
+    gnc_commodity *usd, *shares;
+    Account *stock, *cash;
+    Split *buy, *sell, *gains, *other;
+    GNCLot *lot;
+    EventCount count;
+    gint handler;
+
+    usd = gnc_commodity_new (book, "US Dollar", "ISO4217", "USD", "840", 100);
+    usd = gnc_commodity_table_insert (table, usd);
+    shares = gnc_commodity_new (book, "Shares", "FUND", "SHR", "", 1);
+    shares = gnc_commodity_table_insert (table, shares);
+    stock = make_account (book, "Stock", ACCT_TYPE_STOCK, shares);
+    cash = make_account (book, "Cash", ACCT_TYPE_BANK, usd);
+
+    buy = make_trade (book, stock, cash, usd, 5, 10, 100);
+    sell = make_trade (book, stock, cash, usd, 6, -4, -60);
+
+    count.watched = QOF_INSTANCE (xaccSplitGetParent (sell));
+    count.modified = 0;
+    handler = qof_event_register_handler (count_modify_events, &count);
+    xaccAccountComputeCapGains (stock, NULL);
+    qof_event_unregister_handler (handler);
+    do_test (count.modified == 1,
+             "the sale's transaction is reported modified once");
+
+    lot = xaccSplitGetLot (buy);
+    do_test (lot != NULL && xaccSplitGetLot (sell) == lot,
+             "the sale is assigned to the purchase's lot");
+    do_test (lot != NULL &&
+             gnc_numeric_equal (gnc_lot_get_balance (lot),
+                                gnc_numeric_create (6, 1)),
+             "six shares are left in the lot");
+
+    gains = xaccSplitGetCapGainsSplit (sell);
+    do_test (gains != NULL, "the sale has a gains split");
+    if (gains)
+    {
+        do_test (gnc_numeric_equal (xaccSplitGetValue (gains),
+                                    gnc_numeric_create (20, 1)) &&
+                 gnc_numeric_zero_p (xaccSplitGetAmount (gains)),
+                 "the gains split records a 20.00 gain and no shares");
+        do_test (xaccSplitGetAccount (gains) == stock &&
+                 xaccSplitGetLot (gains) == lot,
+                 "the gains split is in the stock's lot");
+        other = xaccSplitGetOtherSplit (gains);
+        do_test (other != NULL &&
+                 xaccSplitGetAccount (other) != stock &&
+                 gnc_numeric_equal (xaccSplitGetValue (other),
+                                    gnc_numeric_create (-20, 1)) &&
+                 gnc_numeric_equal (xaccSplitGetAmount (other),
+                                    gnc_numeric_create (-20, 1)),
+                 "the gains account is credited 20.00");
+    }
+
+    /* A second pass finds the gains already right and changes nothing. */
+    xaccAccountComputeCapGains (stock, NULL);
+    do_test (xaccSplitGetCapGainsSplit (sell) == gains &&
+             gains != NULL &&
+             gnc_numeric_equal (xaccSplitGetValue (gains),
+                                gnc_numeric_create (20, 1)),
+             "recomputing keeps the same gains");
+
+    qof_book_destroy (book);
+}
+
 static void
 run_test (void)
 {
@@ -60,6 +237,38 @@ run_test (void)
     root = gnc_book_get_root_account (book);
     xaccAccountTreeScrubLots (root);
 
+    {
+        gboolean balances_ok = TRUE;
+        gnc_account_foreach_descendant (root, check_account_lot_balances,
+                                        &balances_ok);
+        do_test (balances_ok, "cached lot balances match their splits");
+    }
+
+    /* Setting an amount through the object's parameters, as the query
+     * and merge code do, must keep the lots' balances too. */
+    {
+        gboolean balances_ok = TRUE;
+        QofSetterFunc set_amount =
+            qof_class_get_parameter_setter (GNC_ID_SPLIT, SPLIT_AMOUNT);
+        gnc_account_foreach_descendant (root, negate_account_lot_splits,
+                                        &set_amount);
+        gnc_account_foreach_descendant (root, check_account_lot_balances,
+                                        &balances_ok);
+        do_test (balances_ok, "lot balances follow the amount setter");
+        /* Put the amounts back for the gains pass. */
+        gnc_account_foreach_descendant (root, negate_account_lot_splits,
+                                        &set_amount);
+    }
+
+    /* The batch gains pass must leave the lots consistent too. */
+    {
+        gboolean balances_ok = TRUE;
+        gnc_account_foreach_descendant (root, compute_account_gains, NULL);
+        gnc_account_foreach_descendant (root, check_account_lot_balances,
+                                        &balances_ok);
+        do_test (balances_ok, "lot balances consistent after batch cap gains");
+    }
+
     /* --------------------------------------------------------- */
     /* In the second test, we create an account with unrealized gains,
      * and see if that gets fixed correctly, with the correct balances,
@@ -93,6 +302,7 @@ main (int argc, char **argv)
         fflush(stdout);
         run_test ();
     }
+    test_gains_values ();
     /* 'erase' the recurring tag line with dummy spaces. */
     fprintf(stdout, "Lots: Test series complete.         \n");
     fflush(stdout);
@@ -396,6 +396,56 @@ check_neg (void)
 
 /* ======================================================= */
 
+static void
+check_string_conversion (void)
+{
+    struct
+    {
+        const char *str;
+        gint64 num;
+        gint64 denom;
+    } cases[] =
+    {
+        { "12345/100", 12345, 100 },
+        { "-7/1", -7, 1 },
+        { "+3/4", 3, 4 },
+        { "0/1", 0, 1 },
+        { "999999999999999999/1", G_GINT64_CONSTANT(999999999999999999), 1 },
+        { "9223372036854775807/1", G_MAXINT64, 1 },
+        { "-9223372036854775807/100", -G_MAXINT64, 100 },
+        { " 42/10", 42, 10 },
+        { "0x10/010", 16, 8 },
+        { "5/2 trailing", 5, 2 },
+    };
+    gnc_numeric n;
+    unsigned int i;
+
+    for (i = 0; i < G_N_ELEMENTS (cases); i++)
+    {
+        n = gnc_numeric_zero ();
+        do_test (string_to_gnc_numeric (cases[i].str, &n),
+                 "string_to_gnc_numeric parses");
+        do_test (n.num == cases[i].num && n.denom == cases[i].denom,
+                 "string_to_gnc_numeric value");
+    }
+
+    do_test (!string_to_gnc_numeric ("12345", &n),
+             "string_to_gnc_numeric needs a denominator");
+    do_test (!string_to_gnc_numeric (NULL, &n),
+             "string_to_gnc_numeric rejects NULL");
+
+    n = gnc_numeric_create (-123456789, 1000);
+    {
+        gchar *str = gnc_numeric_to_string (n);
+        gnc_numeric m;
+        do_test (string_to_gnc_numeric (str, &m) && gnc_numeric_equal (n, m),
+                 "string_to_gnc_numeric round trip");
+        g_free (str);
+    }
+}
+
+/* ======================================================= */
+
 static void
 check_add_subtract (void)
 {
@@ -446,6 +496,38 @@ check_add_subtract (void)
                      gnc_numeric_sub(a, b, 100, GNC_HOW_RND_ROUND),
                      a, b, "expected %s got %s = %s - %s for sub 100ths (banker's)");
 
+    /* ------------------------------------------------------------ */
+    /* Operands with the same denominator */
+    c = gnc_numeric_create(1234, 100);
+    d = gnc_numeric_create(-34, 100);
+    check_binary_op (gnc_numeric_create(1200, 100),
+                     gnc_numeric_add(c, d, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED),
+                     c, d, "expected %s got %s = %s + %s for add same denom");
+
+    check_binary_op (gnc_numeric_create(12, 1),
+                     gnc_numeric_add(c, d, GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE),
+                     c, d, "expected %s got %s = %s + %s for add same denom reduce");
+
+    check_binary_op (gnc_numeric_create(1268, 100),
+                     gnc_numeric_sub(c, d, 100, GNC_HOW_RND_NEVER),
+                     c, d, "expected %s got %s = %s - %s for sub same denom");
+
+    c = gnc_numeric_create(INT64_MAX - 10, 100);
+    d = gnc_numeric_create(11, 100);
+    do_test (gnc_numeric_check (gnc_numeric_add(c, d, GNC_DENOM_AUTO,
+                                                GNC_HOW_DENOM_FIXED)) != 0,
+             "same denom add overflow");
+
+    d = gnc_numeric_create(3, 1);
+    check_binary_op (gnc_numeric_create(-102, 100),
+                     gnc_numeric_mul(gnc_numeric_create(-34, 100), d,
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT),
+                     gnc_numeric_create(-34, 100), d,
+                     "expected %s got %s = %s * %s for mul by integer");
+    do_test (gnc_numeric_check (gnc_numeric_mul(c, d, GNC_DENOM_AUTO,
+                                                GNC_HOW_DENOM_EXACT)) != 0,
+             "mul by integer overflow");
+
     /* ------------------------------------------------------------ */
     /* This test has failed before */
     c = gnc_numeric_neg (a);
@@ -990,6 +1072,7 @@ run_test (void)
     check_rounding();
     check_double();
     check_neg();
+    check_string_conversion ();
     check_add_subtract();
     check_add_subtract_overflow ();
     check_mult_div ();
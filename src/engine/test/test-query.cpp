@@ -27,6 +27,8 @@ extern "C"
 #include "qof.h"
 #include "cashobjects.h"
 #include "Transaction.h"
+#include "Query.h"
+#include "qofquery-p.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
 #include "test-engine-stuff.h"
@@ -61,12 +63,255 @@ test_trans_query (Transaction *trans, gpointer data)
     }
 
     success ("found right transaction");
+    g_list_free (list);
+
+    /* A parallel scan must come to the same answer; a new generation
+     * keeps the cached results of the serial one from answering it. */
+    qof_query_set_parallel (q, TRUE);
+    qof_book_bump_generation (book);
+    list = xaccQueryGetTransactions (q, QUERY_TXN_MATCH_ANY);
+    if (g_list_length (list) != 1 || list->data != trans)
+    {
+        failure ("parallel query found the wrong transactions");
+        qof_query_destroy (q);
+        g_list_free (list);
+        return 13;
+    }
     qof_query_destroy (q);
     g_list_free (list);
 
     return 0;
 }
 
+/* Account queries are answered from the account's own split list,
+ * they must find the same splits a scan would. */
+static void
+test_account_query (Account *acc, gpointer data)
+{
+    QofBook *book = QOF_BOOK(data);
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *splits = xaccAccountGetSplitList (acc), *found, *node;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    found = qof_query_run (q);
+    if (g_list_length (found) != g_list_length (splits))
+    {
+        failure_args ("account query", __FILE__, __LINE__,
+                      "found %d splits instead of %d", g_list_length (found),
+                      g_list_length (splits));
+        qof_query_destroy (q);
+        return;
+    }
+    for (node = found; node; node = node->next)
+    {
+        if (xaccSplitGetAccount (static_cast<Split*>(node->data)) != acc)
+        {
+            failure ("account query found a split of another account");
+            break;
+        }
+    }
+    qof_query_destroy (q);
+
+    /* The same, from the posted date of its middle split on */
+    if (splits)
+    {
+        Split *mid = static_cast<Split*>(g_list_nth_data (splits,
+                                         g_list_length (splits) / 2));
+        Timespec start = xaccTransRetDatePostedTS (xaccSplitGetParent (mid));
+        guint expected = 0;
+        Timespec ets = {0, 0};
+
+        for (node = splits; node; node = node->next)
+        {
+            Transaction *trans = xaccSplitGetParent (static_cast<Split*>(node->data));
+            Timespec posted = xaccTransRetDatePostedTS (trans);
+            if (timespec_cmp (&posted, &start) >= 0)
+                expected++;
+        }
+
+        q = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (q, book);
+        xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+        xaccQueryAddDateMatchTS (q, TRUE, start, FALSE, ets, QOF_QUERY_AND);
+        found = qof_query_run (q);
+        if (g_list_length (found) != expected)
+            failure_args ("account date query", __FILE__, __LINE__,
+                          "found %d splits instead of %d",
+                          g_list_length (found), expected);
+        qof_query_destroy (q);
+    }
+}
+
+/* A small max_results must give the tail of the fully sorted list. */
+static void
+test_max_results (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *all, *top, *node;
+    guint count;
+
+    qof_query_set_book (q, book);
+    all = g_list_copy (qof_query_run (q));
+    count = g_list_length (all);
+    qof_query_set_max_results (q, 3);
+    top = qof_query_run (q);
+    if (count >= 12 && g_list_length (top) != 3)
+    {
+        failure_args ("max results", __FILE__, __LINE__,
+                      "%d of %d splits returned", g_list_length (top), count);
+        g_list_free (all);
+        qof_query_destroy (q);
+        return;
+    }
+    for (node = count >= 12 ? g_list_nth (all, count - 3) : NULL; node; node = node->next, top = top->next)
+    {
+        if (node->data != top->data)
+        {
+            failure ("max results differs from the sorted tail");
+            break;
+        }
+    }
+    g_list_free (all);
+    qof_query_destroy (q);
+}
+
+/* A live query must follow edits without being searched again. */
+static void
+test_live_query (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    Transaction *trans = get_random_transaction (book);
+    Split *split = xaccTransGetSplit (trans, 0);
+    GList *list;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddMemoMatch (q, "live query memo", TRUE, FALSE,
+                           QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    qof_query_set_live (q, TRUE);
+    do_test (qof_query_run (q) == NULL, "live query starts empty");
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "a live query memo");
+    xaccTransCommitEdit (trans);
+    list = qof_query_run (q);
+    do_test (g_list_length (list) == 1 && list->data == split,
+             "live query picks up the edited split");
+
+    /* No event tells of these, the query must search again. */
+    qof_event_suspend ();
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "no query memo");
+    xaccTransCommitEdit (trans);
+    qof_event_resume ();
+    do_test (qof_query_run (q) == NULL,
+             "live query sees the edit made with events suspended");
+
+    qof_event_suspend ();
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "a live query memo");
+    xaccTransCommitEdit (trans);
+    qof_event_resume ();
+    list = qof_query_run (q);
+    do_test (g_list_length (list) == 1 && list->data == split,
+             "live query sees the match made with events suspended");
+
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    do_test (qof_query_run (q) == NULL, "live query drops the destroyed split");
+
+    qof_query_destroy (q);
+}
+
+/* An equal query must only get cached results while nothing changed */
+static void
+test_cached_query (QofBook *book)
+{
+    QofQuery *q1 = qof_query_create_for (GNC_ID_SPLIT), *q2;
+    Transaction *trans = get_random_transaction (book);
+    Split *split = xaccTransGetSplit (trans, 0);
+    guint64 generation;
+
+    qof_query_set_book (q1, book);
+    xaccQueryAddMemoMatch (q1, "cached query memo", TRUE, FALSE,
+                           QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    q2 = qof_query_copy (q1);
+    do_test (qof_query_run (q1) == NULL, "cached query starts empty");
+
+    generation = qof_book_get_generation (book);
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "a cached query memo");
+    xaccTransCommitEdit (trans);
+    do_test (qof_book_get_generation (book) != generation,
+             "an edit changes the book generation");
+    do_test (g_list_length (qof_query_run (q2)) == 1,
+             "an equal query sees the edit");
+    do_test (g_list_length (qof_query_run (q1)) == 1,
+             "the first query sees the edit");
+
+    qof_query_destroy (q1);
+    qof_query_destroy (q2);
+}
+
+/* A parallel scan must find the same splits as a serial one, in the
+ * same order. */
+static void
+test_parallel_query (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *serial, *parallel, *node, *pnode;
+    gboolean same = TRUE;
+
+    qof_query_set_book (q, book);
+    serial = g_list_copy (qof_query_run (q));
+    qof_query_set_parallel (q, TRUE);
+    qof_book_bump_generation (book);
+    parallel = qof_query_run (q);
+    for (node = serial, pnode = parallel; node && pnode;
+         node = node->next, pnode = pnode->next)
+    {
+        if (node->data != pnode->data)
+            same = FALSE;
+    }
+    do_test (same && node == NULL && pnode == NULL && serial != NULL,
+             "parallel query finds the serial results");
+
+    g_list_free (serial);
+    qof_query_destroy (q);
+}
+
+/* A cursor must yield the results of a run, in the same order */
+static void
+test_query_cursor (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    QofQueryCursor *cursor;
+    GList *all, *batch, *node, *expect;
+    gboolean same = TRUE;
+
+    qof_query_set_book (q, book);
+    all = qof_query_run (q);
+    cursor = qof_query_cursor_new (q, 7);
+    expect = all;
+    while ((batch = qof_query_cursor_next (cursor)))
+    {
+        if (g_list_length (batch) > 7)
+            same = FALSE;
+        for (node = batch; node; node = node->next)
+        {
+            if (!expect || expect->data != node->data)
+                same = FALSE;
+            expect = expect ? expect->next : NULL;
+        }
+        g_list_free (batch);
+    }
+    do_test (same && expect == NULL, "cursor yields the query results");
+
+    qof_query_cursor_free (cursor);
+    qof_query_destroy (q);
+}
+
 static void
 run_test (void)
 {
@@ -81,6 +326,12 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    gnc_account_foreach_descendant (root, test_account_query, book);
+    test_max_results (book);
+    test_live_query (book);
+    test_cached_query (book);
+    test_query_cursor (book);
+    test_parallel_query (book);
 
     qof_session_end (session);
 }
@@ -103,6 +354,11 @@ main (int argc, char **argv)
         goto cleanup;
     }
 
+    /* The random books are far smaller than a parallel scan needs, and
+     * the machine may have a single processor: hand any scan, however
+     * small, to four threads. */
+    qof_query_set_parallel_limits (1, 4);
+
     /* Loop the test. */
     for (i = 0; i < 10; i++)
     {
@@ -325,6 +325,48 @@ static void test_some()
     test_specific(PERIOD_DAY, 7,    4, 1, 2000,    4, 8, 2000,  4, 15, 2000);
 }
 
+/* The closed-form nth instance and the range listing must agree with
+   stepping through recurrenceNextInstance() one instance at a time. */
+static void test_nth_closed_form()
+{
+    Recurrence r;
+    GDate d_start, d_step, d_nth, d_end;
+    PeriodType pt;
+    WeekendAdjust wadj;
+    guint16 mult;
+    gint32 j;
+    guint n;
+
+    for (pt = PERIOD_DAY; pt < NUM_PERIOD_TYPES; pt++)
+        for (wadj = WEEKEND_ADJ_NONE; wadj < NUM_WEEKEND_ADJS; wadj++)
+            for (j = JULIAN_START; j < JULIAN_START + 2 * 366; j += 3)
+                for (mult = 1; mult <= 3; mult++)
+                {
+                    GList *rlist;
+                    GArray *dates;
+
+                    g_date_set_julian(&d_start, j);
+                    recurrenceSet(&r, mult, pt, &d_start, wadj);
+                    d_step = d_start;
+                    for (n = 1; n <= 24; n++)
+                    {
+                        GDate ref = d_step;
+                        recurrenceNextInstance(&r, &ref, &d_step);
+                        recurrenceNthInstance(&r, n, &d_nth);
+                        if (!test_equal(&d_nth, &d_step))
+                            return;
+                    }
+
+                    /* d_step is now the 24th instance after the start */
+                    d_end = d_step;
+                    rlist = g_list_append(NULL, &r);
+                    dates = recurrenceListInstancesInRange(rlist, &d_start, &d_end);
+                    do_test(dates->len == 25, "range holds start and 24 more");
+                    g_array_free(dates, TRUE);
+                    g_list_free(rlist);
+                }
+}
+
 static void test_use()
 {
     Recurrence *r;
@@ -345,6 +387,8 @@ static void test_main()
 
     test_all();
 
+    test_nth_closed_form();
+
     qof_book_destroy (book);
 }
 
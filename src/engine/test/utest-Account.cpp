@@ -1157,6 +1157,11 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     /* Now add a second split to the account and check that sort_dirty isn't set. We have to bump the editlevel to force this. */
     g_assert (gnc_account_insert_split (fixture->acct, split2));
     g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->split_array->len, == , 2);
+    g_assert (g_list_nth_data (priv->splits, 0) ==
+              g_ptr_array_index (priv->split_array, 0));
+    g_assert (g_list_nth_data (priv->splits, 1) ==
+              g_ptr_array_index (priv->split_array, 1));
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 2);
@@ -1179,6 +1184,8 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
                             split3);
     g_assert (gnc_account_remove_split (fixture->acct, split3));
     g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->split_array->len, == , 2);
+    g_assert_cmpuint (g_hash_table_size (priv->split_nodes), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1196,6 +1203,57 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     test_signal_free (sig3);
     test_signal_free (sig1);
 }
+/* gnc_account_begin_bulk_ingest
+void
+gnc_account_begin_bulk_ingest (QofBook *book)
+*/
+static void
+test_gnc_account_bulk_ingest (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    Split *split1 = xaccMallocSplit (book);
+    Split *split2 = xaccMallocSplit (book);
+    TestSignal sig1, sig2;
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+
+    sig1 = test_signal_new (&fixture->acct->inst, QOF_EVENT_MODIFY, NULL);
+    sig2 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_ADDED, NULL);
+
+    gnc_account_begin_bulk_ingest (book);
+    /* Nesting is allowed; only the outermost end does the work. */
+    gnc_account_begin_bulk_ingest (book);
+    g_assert (gnc_account_insert_split (fixture->acct, split1));
+    g_assert (gnc_account_insert_split (fixture->acct, split2));
+    gnc_account_end_bulk_ingest (book);
+    g_assert_cmpuint (priv->split_array->len, == , 2);
+    g_assert_cmpuint (g_hash_table_size (priv->split_nodes), == , 2);
+    g_assert (priv->sort_dirty);
+    g_assert (priv->balance_dirty);
+    test_signal_assert_hits (sig1, 0);
+    test_signal_assert_hits (sig2, 0);
+
+    gnc_account_end_bulk_ingest (book);
+    g_assert (!priv->sort_dirty);
+    g_assert (!priv->balance_dirty);
+    g_assert (g_list_nth_data (priv->splits, 0) ==
+              g_ptr_array_index (priv->split_array, 0));
+    g_assert (g_list_nth_data (priv->splits, 1) ==
+              g_ptr_array_index (priv->split_array, 1));
+    test_signal_assert_hits (sig1, 1);
+    test_signal_assert_hits (sig2, 0);
+
+    /* An account only marked for sorting during the ingest, say by a
+     * changed split date, is sorted at its end too. */
+    gnc_account_begin_bulk_ingest (book);
+    gnc_account_set_sort_dirty (fixture->acct);
+    g_assert (priv->sort_dirty);
+    gnc_account_end_bulk_ingest (book);
+    g_assert (!priv->sort_dirty);
+    test_signal_assert_hits (sig1, 2);
+
+    test_signal_free (sig2);
+    test_signal_free (sig1);
+}
 /* xaccAccountSortSplits
 void
 xaccAccountSortSplits (Account *acc, gboolean force)// C: 4 in 2
@@ -1348,6 +1406,17 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_numeric_eq (priv->cleared_balance, clr_bal));
     g_assert (gnc_numeric_eq (priv->reconciled_balance, rec_bal));
     g_assert (!priv->balance_dirty);
+    /* With the watermark past the last split only the account totals are
+     * refreshed, from the last split's running balances. */
+    priv->balance = gnc_numeric_zero ();
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = priv->split_array->len;
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert (gnc_numeric_eq (priv->balance, bal));
+    g_assert (gnc_numeric_eq (priv->cleared_balance, clr_bal));
+    g_assert (gnc_numeric_eq (priv->reconciled_balance, rec_bal));
+    g_assert (!priv->balance_dirty);
+    g_assert_cmpuint (priv->balance_dirty_from, ==, 0);
 }
 
 /* xaccAccountOrder
@@ -1763,6 +1832,15 @@ test_gnc_account_lookup_by_full_name (Fixture *fixture, gconstpointer pData)
     target = gnc_account_lookup_by_full_name (root, names3);
     g_assert (target == NULL);
     g_free (code);
+    /* The lookup index must follow renames and code changes */
+    target = gnc_account_lookup_by_full_name (root, "income:exempt");
+    g_assert (target != NULL);
+    xaccAccountSetName (target, "nontaxable");
+    g_assert (gnc_account_lookup_by_full_name (root, names2) == NULL);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:nontaxable:int")
+              != NULL);
+    xaccAccountSetCode (target, "4299");
+    g_assert (gnc_account_lookup_by_code (root, "4299") == target);
 }
 
 static void
@@ -1888,9 +1966,30 @@ test_gnc_account_get_full_name (Fixture *fixture, gconstpointer pData)
     g_assert (result != NULL);
     g_assert_cmpstr (result, == , "foo:baz:waldo");
     g_free (result);
+    /* The cached name must follow a rename of an ancestor. */
+    xaccAccountSetName (gnc_account_get_parent (fixture->acct), "qux");
+    result = gnc_account_get_full_name (fixture->acct);
+    g_assert_cmpstr (result, == , "foo:qux:waldo");
+    g_free (result);
 
 }
 
+static void
+test_xaccAccountGetFullName (Fixture *fixture, gconstpointer pData)
+{
+    const char *name;
+    g_assert_cmpstr (xaccAccountGetFullName (NULL), == , "");
+    g_assert_cmpstr (xaccAccountGetFullName (gnc_account_get_root (fixture->acct)),
+                     == , "");
+    name = xaccAccountGetFullName (fixture->acct);
+    g_assert_cmpstr (name, == , "foo:baz:waldo");
+    /* The same string each time, until an ancestor is renamed. */
+    g_assert (xaccAccountGetFullName (fixture->acct) == name);
+    xaccAccountSetName (gnc_account_get_parent (fixture->acct), "qux");
+    g_assert_cmpstr (xaccAccountGetFullName (fixture->acct), == ,
+                     "foo:qux:waldo");
+}
+
 /* DxaccAccountGetCurrency
 gnc_commodity *
 DxaccAccountGetCurrency (const Account *acc)// C: 9 in 5
@@ -1953,6 +2052,109 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountFindLastSplitAtDate
+Split *
+xaccAccountFindLastSplitAtDate (Account *acc, time64 date)*/
+static void
+test_xaccAccountFindLastSplitAtDate (Fixture *fixture, gconstpointer pData)
+{
+    GList *node;
+    Split *split;
+    time64 first = 0;
+
+    xaccAccountRecomputeBalance (fixture->acct);
+    for (node = xaccAccountGetSplitList (fixture->acct); node; node = node->next)
+    {
+        time64 posted = xaccTransGetDate (xaccSplitGetParent (node->data));
+
+        if (node->prev == NULL)
+            first = posted;
+        split = xaccAccountFindLastSplitAtDate (fixture->acct, posted);
+        g_assert (split != NULL);
+        /* The split's running balance includes everything posted that day. */
+        g_assert (gnc_numeric_equal (xaccSplitGetBalance (split),
+                                     xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                                    posted + 1)));
+        g_assert_cmpint (xaccTransGetDate (xaccSplitGetParent (split)), ==, posted);
+    }
+    g_assert (xaccAccountFindLastSplitAtDate (fixture->acct, first - 1) == NULL);
+    split = xaccAccountFindLastSplitAtDate (fixture->acct, G_MAXINT64);
+    g_assert (split == g_list_last (xaccAccountGetSplitList (fixture->acct))->data);
+}
+/* gnc_balance_snapshot_new
+GncBalanceSnapshot *
+gnc_balance_snapshot_new (GList *accounts, const time64 *dates, guint n_dates)
+*/
+static void
+test_gnc_balance_snapshot (Fixture *fixture, gconstpointer pData)
+{
+    time64 now = gnc_time (NULL);
+    const time64 day = 24 * 3600;
+    /* Deliberately out of order */
+    time64 dates[] = { now - 3 * day, now + 30 * day, 0, now - 7 * day };
+    guint n_dates = G_N_ELEMENTS (dates);
+    Account *root = gnc_account_get_root (fixture->acct);
+    GList *accounts = g_list_prepend (NULL, root);
+    GncBalanceSnapshot *snapshot;
+    guint k;
+
+    accounts = g_list_prepend (accounts, fixture->acct);
+    snapshot = gnc_balance_snapshot_new (accounts, dates, n_dates);
+    g_assert_cmpint (gnc_balance_snapshot_get_n_accounts (snapshot), ==, 2);
+    g_assert_cmpint (gnc_balance_snapshot_get_n_dates (snapshot), ==, n_dates);
+    for (k = 0; k < n_dates; k++)
+    {
+        gnc_numeric expect = xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                            dates[k]);
+        gnc_numeric got = gnc_balance_snapshot_get_balance (snapshot, 0, k);
+        g_assert (gnc_numeric_equal (expect, got));
+        expect = xaccAccountGetBalanceAsOfDate (root, dates[k]);
+        got = gnc_balance_snapshot_get_balance (snapshot, 1, k);
+        g_assert (gnc_numeric_equal (expect, got));
+    }
+    /* Everything posted before the last date is counted */
+    g_assert (gnc_numeric_equal (gnc_balance_snapshot_get_balance (snapshot, 0, 1),
+                                 xaccAccountGetBalance (fixture->acct)));
+    g_assert (gnc_numeric_equal (gnc_balance_snapshot_get_reconciled_balance (snapshot, 0, 1),
+                                 xaccAccountGetReconciledBalance (fixture->acct)));
+    g_assert (gnc_numeric_zero_p (gnc_balance_snapshot_get_cleared_balance (snapshot, 0, 2)));
+    gnc_balance_snapshot_free (snapshot);
+    g_list_free (accounts);
+}
+/* xaccAccountGetBalanceChangesForPeriods
+gnc_numeric *
+xaccAccountGetBalanceChangesForPeriods (Account *acc, const time64 *starts,
+                                        const time64 *ends, guint n_periods,
+                                        gboolean recurse)
+*/
+static void
+test_xaccAccountGetBalanceChangesForPeriods (Fixture *fixture, gconstpointer pData)
+{
+    time64 now = gnc_time (NULL);
+    const time64 day = 24 * 3600;
+    /* Overlapping and out of order, as periods may be. */
+    time64 starts[] = { 0, now - 7 * day, now - 3 * day, now - 30 * day };
+    time64 ends[] = { now - 7 * day, now + 30 * day, now + day, now - 3 * day };
+    guint n_periods = G_N_ELEMENTS (starts);
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *accts[] = { fixture->acct, root };
+    guint a, i;
+
+    for (a = 0; a < G_N_ELEMENTS (accts); a++)
+    {
+        gnc_numeric *changes =
+            xaccAccountGetBalanceChangesForPeriods (accts[a], starts, ends,
+                                                    n_periods, TRUE);
+        for (i = 0; i < n_periods; i++)
+        {
+            gnc_numeric expect =
+                xaccAccountGetBalanceChangeForPeriod (accts[a], starts[i],
+                                                      ends[i], TRUE);
+            g_assert (gnc_numeric_equal (expect, changes[i]));
+        }
+        g_free (changes);
+    }
+}
 /* xaccAccountGetPresentBalance
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)// C: 4 in 2 */
@@ -2059,6 +2261,49 @@ test_xaccAccountFindOpenLots (Fixture *fixture, gconstpointer pData)
     count_sorts = 0;
 }
 
+static void
+test_xaccAccountFindOpenLots_index (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *acct = gnc_account_lookup_by_name (root, "baz");
+    QofBook *book = gnc_account_get_book (acct);
+    GNCLot *lot = gnc_lot_new (book);
+    LotList *lots, *all, *node, *anode;
+
+    g_assert (acct);
+    /* A new lot without splits is open */
+    xaccAccountInsertLot (acct, lot);
+    lots = xaccAccountFindOpenLots (acct, NULL, NULL, NULL);
+    g_assert_cmpuint (g_list_length (lots), == , 3);
+    g_assert (g_list_find (lots, lot));
+    /* Unsorted, they come in the reverse order of the lot list */
+    all = g_list_reverse (xaccAccountGetLotList (acct));
+    for (anode = all, node = lots; anode; anode = anode->next)
+    {
+        if (gnc_lot_is_closed (GNC_LOT (anode->data)))
+            continue;
+        g_assert (node && node->data == anode->data);
+        node = node->next;
+    }
+    g_assert (node == NULL);
+    g_list_free (all);
+    g_list_free (lots);
+    /* Moving it takes it out of this account's open lots */
+    xaccAccountInsertLot (fixture->acct, lot);
+    lots = xaccAccountFindOpenLots (acct, NULL, NULL, NULL);
+    g_assert_cmpuint (g_list_length (lots), == , 2);
+    g_list_free (lots);
+    lots = xaccAccountFindOpenLots (fixture->acct, NULL, NULL, NULL);
+    g_assert (g_list_find (lots, lot));
+    g_list_free (lots);
+    /* And removing it drops it entirely */
+    xaccAccountRemoveLot (fixture->acct, lot);
+    lots = xaccAccountFindOpenLots (fixture->acct, NULL, NULL, NULL);
+    g_assert (g_list_find (lots, lot) == NULL);
+    g_list_free (lots);
+    gnc_lot_destroy (lot);
+}
+
 static gpointer
 bogus_for_each_lot_func (GNCLot *lot, gpointer data)
 {
@@ -2083,6 +2328,84 @@ test_xaccAccountForEachLot (Fixture *fixture, gconstpointer pData)
     xaccAccountForEachLot (acct, bogus_for_each_lot_func, &count_calls);
     g_assert_cmpint (count_calls, == , 5);
 }
+
+static gpointer
+collect_lot_func (GNCLot *lot, gpointer data)
+{
+    auto lots = static_cast<GList**>(data);
+    *lots = g_list_append (*lots, lot);
+    return NULL;
+}
+
+static void
+test_gnc_account_foreach_open_lot (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *acct = gnc_account_lookup_by_name (root, "baz");
+    GList *all = NULL, *open = NULL, *node, *onode;
+
+    g_assert (acct);
+    /* The open lots come in the order of the lot list, which the lot
+     * searches of cap-gains.c rely on to break ties. */
+    xaccAccountForEachLot (acct, collect_lot_func, &all);
+    gnc_account_foreach_open_lot (acct, collect_lot_func, &open);
+    g_assert_cmpuint (g_list_length (open), == , 2);
+    for (node = all, onode = open; node; node = node->next)
+    {
+        if (gnc_lot_is_closed (GNC_LOT (node->data)))
+            continue;
+        g_assert (onode && node->data == onode->data);
+        onode = onode->next;
+    }
+    g_assert (onode == NULL);
+    g_list_free (all);
+    g_list_free (open);
+}
+static gint64
+memory_usage_count (GList *usage, const char *category)
+{
+    for (GList *node = usage; node; node = node->next)
+    {
+        auto mu = static_cast<QofMemoryUsage*>(node->data);
+        if (!g_strcmp0 (mu->category, category))
+            return mu->count;
+    }
+    g_assert_not_reached ();
+    return -1;
+}
+
+static void
+test_gnc_account_tree_get_memory_usage (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    GList *accounts = gnc_account_get_descendants (root), *usage;
+    gint64 splits = 0, open_lots = 0;
+
+    for (GList *node = accounts; node; node = node->next)
+    {
+        auto acct = static_cast<Account*>(node->data);
+        GList *lots = xaccAccountGetLotList (acct);
+        splits += g_list_length (xaccAccountGetSplitList (acct));
+        for (GList *lnode = lots; lnode; lnode = lnode->next)
+            if (!gnc_lot_is_closed (GNC_LOT (lnode->data)))
+                open_lots++;
+        g_list_free (lots);
+    }
+    /* Build the name index of the tree. */
+    g_assert (gnc_account_lookup_by_full_name (root, "expense"));
+
+    usage = gnc_account_tree_get_memory_usage (root, NULL);
+    g_assert_cmpint (memory_usage_count (usage, "Account split lists"), ==, splits);
+    g_assert_cmpint (memory_usage_count (usage, "Account split arrays"), ==, splits);
+    g_assert_cmpint (memory_usage_count (usage, "Account split nodes"), ==, splits);
+    g_assert_cmpint (memory_usage_count (usage, "Account open lots"), ==, open_lots);
+    g_assert_cmpint (memory_usage_count (usage, "Account child lists"), ==,
+                     g_list_length (accounts));
+    g_assert_cmpint (memory_usage_count (usage, "Account name and code indexes"),
+                     ==, g_list_length (accounts));
+    qof_memory_usage_free (usage);
+    g_list_free (accounts);
+}
 /* These getters and setters look in KVP, so I guess their delegators instead:
  * xaccAccountGetTaxRelated
  * xaccAccountSetTaxRelated
@@ -2485,6 +2808,16 @@ thunk3 (Transaction *txn, gpointer data)
     return 0;
 }
 
+static gint
+nested_thunk (Transaction *txn, gpointer data)
+{
+    Thunkdata *td = (Thunkdata*)data;
+    Account *root = gnc_account_get_root (
+        xaccSplitGetAccount (xaccTransGetSplit (txn, 0)));
+    ++(td->count);
+    return xaccAccountTreeForEachTransaction (root, thunk3, td);
+}
+
 /* xaccAccountTreeForEachTransaction
 int
 xaccAccountTreeForEachTransaction (Account *acc, TransactionCallback proc,
@@ -2504,6 +2837,13 @@ test_xaccAccountTreeForEachTransaction (Fixture *fixture, gconstpointer pData )
     g_assert_cmpint (td.count, == , result);
     g_assert_cmpint (result, < , 9);
     g_free(td.name);
+    /* A traversal started from inside another one sees every
+     * transaction and leaves the outer one undisturbed. */
+    td.count = 0;
+    td.name = NULL;
+    result = xaccAccountTreeForEachTransaction (root, nested_thunk, &td);
+    g_assert_cmpint (result, == , 0);
+    g_assert_cmpint (td.count, == , 9 * 10);
 }
 /* xaccAccountForEachTransaction
 gint
@@ -2529,6 +2869,55 @@ test_xaccAccountForEachTransaction (Fixture *fixture, gconstpointer pData )
     g_free(td.name);
 }
 
+/* xaccAccountForEachSplitInRange
+gint
+xaccAccountForEachSplitInRange (Account *acc, time64 t_start, time64 t_end,
+*/
+static gint
+count_splits (Split *s, gpointer data)
+{
+    gint *counter = static_cast<gint*>(data);
+    g_assert (GNC_IS_SPLIT (s));
+    return ++(*counter) == 3 ? -1 : 0;
+}
+
+static void
+test_xaccAccountForEachSplitInRange (Fixture *fixture, gconstpointer pData )
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *money = gnc_account_lookup_by_name (root, "money");
+    GList *node;
+    gint count = 0, result, before_last = 0;
+    time64 first, last;
+
+    g_assert (money);
+    node = xaccAccountGetSplitList (money);
+    g_assert (node);
+    first = xaccTransGetDate (xaccSplitGetParent (static_cast<Split*>(node->data)));
+    last = xaccTransGetDate (xaccSplitGetParent (static_cast<Split*>(g_list_last (node)->data)));
+    /* An empty range */
+    result = xaccAccountForEachSplitInRange (money, last + 1, last + 1,
+                                             count_splits, &count);
+    g_assert_cmpint (result, == , 0);
+    g_assert_cmpint (count, == , 0);
+    /* The callback stops the traversal at the third split */
+    result = xaccAccountForEachSplitInRange (money, first, last + 1,
+                                             count_splits, &count);
+    g_assert_cmpint (result, == , -1);
+    g_assert_cmpint (count, == , 3);
+    /* The splits posted on the last date are excluded by the end of the
+     * range, all the others are visited */
+    for (; node; node = node->next)
+        if (xaccTransGetDate (xaccSplitGetParent (static_cast<Split*>(node->data))) < last)
+            ++before_last;
+    g_assert_cmpint (before_last, < , xaccAccountCountSplits (money, FALSE));
+    count = 4;
+    result = xaccAccountForEachSplitInRange (money, first, last,
+                                             count_splits, &count);
+    g_assert_cmpint (result, == , 0);
+    g_assert_cmpint (count, == , 4 + before_last);
+}
+
 
 void
 test_suite_account (void)
@@ -2551,6 +2940,7 @@ test_suite_account (void)
 // GNC_TEST_ADD (suitename, "xaccAcctChildrenEqual", Fixture, NULL, setup, test_xaccAcctChildrenEqual,  teardown );
 // GNC_TEST_ADD (suitename, "xaccAccountEqual", Fixture, NULL, setup, test_xaccAccountEqual,  teardown );
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account bulk ingest", Fixture, NULL, setup, test_gnc_account_bulk_ingest,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
@@ -2569,11 +2959,18 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account foreach descendant", Fixture, &complex, setup, test_gnc_account_foreach_descendant,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant until", Fixture, &complex, setup, test_gnc_account_foreach_descendant_until,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetFullName", Fixture, &good_data, setup, test_xaccAccountGetFullName,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountFindLastSplitAtDate", Fixture, &some_data, setup, test_xaccAccountFindLastSplitAtDate,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_balance_snapshot", Fixture, &some_data, setup, test_gnc_balance_snapshot,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetBalanceChangesForPeriods", Fixture, &some_data, setup, test_xaccAccountGetBalanceChangesForPeriods,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots index", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots_index,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_account_foreach_open_lot", Fixture, &complex_data, setup, test_gnc_account_foreach_open_lot,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_account_tree_get_memory_usage", Fixture, &complex_data, setup, test_gnc_account_tree_get_memory_usage,  teardown );
 
     GNC_TEST_ADD (suitename, "xaccAccountHasAncestor", Fixture, &complex, setup, test_xaccAccountHasAncestor,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "AccountType Stuff", test_xaccAccountType_Stuff );
@@ -2583,6 +2980,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account join children", Fixture, &complex, setup, test_gnc_account_join_children,  teardown );
     GNC_TEST_ADD (suitename, "gnc account merge children", Fixture, &complex_data, setup, test_gnc_account_merge_children,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountForEachTransaction,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountForEachSplitInRange", Fixture, &complex_data, setup, test_xaccAccountForEachSplitInRange,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountTreeForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountTreeForEachTransaction,  teardown );
 
 
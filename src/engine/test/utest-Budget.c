@@ -2577,6 +2577,54 @@ test_gnc_set_budget_account_period_value()
     qof_book_destroy(book);
 }
 
+static void
+test_gnc_budget_account_period_value_cache()
+{
+    QofBook *book = qof_book_new();
+    GncBudget* budget = gnc_budget_new(book);
+    GncBudget* clone;
+    Account *acc, *acc2;
+
+    acc = gnc_account_create_root(book);
+    acc2 = xaccMallocAccount(book);
+    gnc_account_append_child(acc, acc2);
+
+    gnc_budget_set_account_period_value(budget, acc, 3, gnc_numeric_create(25,1));
+    gnc_budget_set_account_period_value(budget, acc2, 3, gnc_numeric_create(7,1));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 2));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc, 3),
+                               gnc_numeric_create(25,1)));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc2, 3),
+                               gnc_numeric_create(7,1)));
+
+    gnc_budget_unset_account_period_value(budget, acc, 3);
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 3));
+    g_assert(gnc_numeric_zero_p(gnc_budget_get_account_period_value(budget, acc, 3)));
+
+    /* Growing the budget keeps the stored amounts and adds empty periods. */
+    gnc_budget_set_account_period_value(budget, acc, 11, gnc_numeric_create(5,1));
+    gnc_budget_set_num_periods(budget, 14);
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 11));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 13));
+    gnc_budget_set_account_period_value(budget, acc, 13, gnc_numeric_create(9,1));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc, 13),
+                               gnc_numeric_create(9,1)));
+
+    /* Cloning copies the child account's amounts, including the new
+     * period. */
+    gnc_budget_set_account_period_value(budget, acc2, 13, gnc_numeric_create(4,1));
+    clone = gnc_budget_clone(budget);
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(clone, acc2, 3),
+                               gnc_numeric_create(7,1)));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(clone, acc2, 13),
+                               gnc_numeric_create(4,1)));
+    g_assert(!gnc_budget_is_account_period_value_set(clone, acc2, 11));
+
+    gnc_budget_destroy(clone);
+    gnc_budget_destroy(budget);
+    qof_book_destroy(book);
+}
+
 void
 test_suite_budget(void)
 {
@@ -2586,6 +2634,7 @@ test_suite_budget(void)
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_num_periods()", test_gnc_set_budget_num_periods);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_recurrence()", test_gnc_set_budget_recurrence);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_account_period_value()", test_gnc_set_budget_account_period_value);
+    GNC_TEST_ADD_FUNC(suitename, "gnc_budget account period value cache", test_gnc_budget_account_period_value_cache);
 
 #if 0
     GNC_TEST_ADD_FUNC (suitename, "gnc set account separator", test_gnc_set_account_separator);
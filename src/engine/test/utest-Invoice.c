@@ -88,8 +88,204 @@ test_invoice_post ( Fixture *fixture, gconstpointer pData )
     g_assert(!gncInvoiceIsPosted(invoice));
 }
 
+static void
+test_invoice_totals ( Fixture *fixture, gconstpointer pData )
+{
+    GncInvoice *invoice = gncInvoiceCreate(fixture->book);
+    GncEntry *cash = gncEntryCreate(fixture->book);
+    GncEntry *card = gncEntryCreate(fixture->book);
+
+    gncInvoiceSetCurrency(invoice, fixture->commodity);
+    gncInvoiceSetOwner(invoice, &fixture->owner);
+
+    gncEntrySetQuantity(cash, gnc_numeric_create(2, 1));
+    gncEntrySetInvPrice(cash, gnc_numeric_create(1000, 100));
+    gncEntrySetInvTaxable(cash, FALSE);
+    gncEntrySetBillPayment(cash, GNC_PAYMENT_CASH);
+    gncEntrySetQuantity(card, gnc_numeric_create(1, 1));
+    gncEntrySetInvPrice(card, gnc_numeric_create(500, 100));
+    gncEntrySetInvTaxable(card, FALSE);
+    gncEntrySetBillPayment(card, GNC_PAYMENT_CARD);
+
+    g_assert(gnc_numeric_zero_p(gncInvoiceGetTotal(invoice)));
+    gncInvoiceAddEntry(invoice, cash);
+    gncInvoiceAddEntry(invoice, card);
+    g_assert(gnc_numeric_equal(gncInvoiceGetTotal(invoice),
+                               gnc_numeric_create(25, 1)));
+    g_assert(gnc_numeric_equal(gncInvoiceGetTotalOf(invoice, GNC_PAYMENT_CARD),
+                               gnc_numeric_create(5, 1)));
+    g_assert(gnc_numeric_zero_p(gncInvoiceGetTotalTax(invoice)));
+
+    /* Changing an entry must show through the cached totals */
+    gncEntrySetQuantity(card, gnc_numeric_create(3, 1));
+    g_assert(gnc_numeric_equal(gncInvoiceGetTotalSubtotal(invoice),
+                               gnc_numeric_create(35, 1)));
+    g_assert(gnc_numeric_equal(gncInvoiceGetTotalOf(invoice, GNC_PAYMENT_CASH),
+                               gnc_numeric_create(20, 1)));
+
+    gncInvoiceRemoveEntry(invoice, cash);
+    g_assert(gnc_numeric_equal(gncInvoiceGetTotal(invoice),
+                               gnc_numeric_create(15, 1)));
+}
+
+static GncInvoice *
+make_invoice (Fixture *fixture, Account *income, gint64 amount)
+{
+    GncInvoice *invoice = gncInvoiceCreate(fixture->book);
+    GncEntry *entry = gncEntryCreate(fixture->book);
+
+    gncInvoiceSetCurrency(invoice, fixture->commodity);
+    gncInvoiceSetOwner(invoice, &fixture->owner);
+    gncEntrySetQuantity(entry, gnc_numeric_create(1, 1));
+    gncEntrySetInvPrice(entry, gnc_numeric_create(amount, 1));
+    gncEntrySetInvTaxable(entry, FALSE);
+    gncEntrySetInvAccount(entry, income);
+    gncInvoiceAddEntry(invoice, entry);
+    return invoice;
+}
+
+static void
+test_invoice_post_list ( Fixture *fixture, gconstpointer pData )
+{
+    Account *income = xaccMallocAccount(fixture->book);
+    GncInvoice *first, *second, *posted;
+    GList *invoices, *failed;
+    Timespec ts1 = timespec_now(), ts2 = ts1;
+    TestSignal acc_sig, income_sig;
+
+    xaccAccountSetCommodity(income, fixture->commodity);
+    first = make_invoice(fixture, income, 10);
+    second = make_invoice(fixture, income, 20);
+    posted = make_invoice(fixture, income, 40);
+    gncInvoicePostToAccount(posted, fixture->account, &ts1, &ts2, "memo",
+                            TRUE, FALSE);
+    invoices = g_list_append(NULL, first);
+    invoices = g_list_append(invoices, posted);
+    invoices = g_list_append(invoices, second);
+
+    acc_sig = test_signal_new(QOF_INSTANCE(fixture->account),
+                              QOF_EVENT_MODIFY, NULL);
+    income_sig = test_signal_new(QOF_INSTANCE(income), QOF_EVENT_MODIFY, NULL);
+    failed = gncInvoicePostListToAccount(invoices, fixture->account, &ts1,
+                                         &ts2, "memo", TRUE, FALSE);
+
+    /* Only the invoice already posted is handed back */
+    g_assert_cmpuint(g_list_length(failed), ==, 1);
+    g_assert(failed->data == posted);
+    g_assert(gncInvoiceIsPosted(first));
+    g_assert(gncInvoiceIsPosted(second));
+    g_assert(gncInvoiceGetPostedAcc(first) == fixture->account);
+    g_assert(gnc_numeric_equal(xaccAccountGetBalance(fixture->account),
+                               gnc_numeric_create(70, 1)));
+    g_assert(gnc_numeric_equal(xaccAccountGetBalance(income),
+                               gnc_numeric_create(-70, 1)));
+    /* and every account touched hears of it just once */
+    test_signal_assert_hits(acc_sig, 1);
+    test_signal_assert_hits(income_sig, 1);
+
+    test_signal_free(acc_sig);
+    test_signal_free(income_sig);
+    g_list_free(failed);
+    g_list_free(invoices);
+}
+
+static Timespec
+days_ago (time64 now, gint days)
+{
+    Timespec ts = { now - days * 24 * 60 * 60, 0 };
+    return ts;
+}
+
+static void
+assert_aging (GncOwnerAging *aging, const GncOwner *owner,
+              const gint64 expected[GNC_OWNER_AGING_BUCKETS])
+{
+    gint i;
+
+    for (i = 0; i < GNC_OWNER_AGING_BUCKETS; i++)
+        g_assert(gnc_numeric_equal(gncOwnerAgingGetBucket(aging, owner, i),
+                                   gnc_numeric_create(expected[i], 1)));
+}
+
+static void
+test_owner_aging ( Fixture *fixture, gconstpointer pData )
+{
+    Account *income = xaccMallocAccount(fixture->book);
+    Account *bank = xaccMallocAccount(fixture->book);
+    GncInvoice *old_invoice, *new_invoice;
+    GncOwnerAging *aging;
+    GList *lots, *owners;
+    time64 now = gnc_time(NULL);
+    Timespec posted, paid = days_ago(now, 5);
+    const gint64 today[] = { 0, 0, 0, 40, 0 };
+    const gint64 week_ago[] = { 100, 0, 0, 40, 0 };
+    const gint64 fifty_days_ago[] = { 0, 0, 100, 0, 0 };
+    const gint64 paid_off[] = { 0, 0, 0, 0, 0 };
+
+    xaccAccountSetCommodity(income, fixture->commodity);
+    xaccAccountSetCommodity(bank, fixture->commodity);
+    old_invoice = make_invoice(fixture, income, 100);
+    new_invoice = make_invoice(fixture, income, 40);
+    posted = days_ago(now, 100);
+    gncInvoicePostToAccount(old_invoice, fixture->account, &posted, &posted,
+                            "memo", TRUE, FALSE);
+    posted = days_ago(now, 10);
+    gncInvoicePostToAccount(new_invoice, fixture->account, &posted, &posted,
+                            "memo", TRUE, FALSE);
+
+    /* Paid off five days ago */
+    lots = g_list_append(NULL, gncInvoiceGetPostedLot(old_invoice));
+    gncOwnerApplyPayment(&fixture->owner, NULL, lots, fixture->account, bank,
+                         gnc_numeric_create(100, 1), gnc_numeric_create(1, 1),
+                         paid, "", "", FALSE);
+    g_list_free(lots);
+    g_assert(gnc_lot_is_closed(gncInvoiceGetPostedLot(old_invoice)));
+
+    aging = gncOwnerAgingNew(fixture->account, now, FALSE);
+    owners = gncOwnerAgingGetOwners(aging);
+    g_assert_cmpuint(g_list_length(owners), ==, 1);
+    g_assert(gncOwnerEqual(owners->data, &fixture->owner));
+    g_list_free_full(owners, (GDestroyNotify)gncOwnerFree);
+    assert_aging(aging, &fixture->owner, today);
+    gncOwnerAgingDestroy(aging);
+
+    /* Before the payment the paid invoice was still owed */
+    aging = gncOwnerAgingNew(fixture->account, days_ago(now, 7).tv_sec, FALSE);
+    assert_aging(aging, &fixture->owner, week_ago);
+    gncOwnerAgingDestroy(aging);
+
+    /* and the new one wasn't posted yet */
+    aging = gncOwnerAgingNew(fixture->account, days_ago(now, 50).tv_sec, FALSE);
+    assert_aging(aging, &fixture->owner, fifty_days_ago);
+    gncOwnerAgingDestroy(aging);
+
+    /* Nothing was owed before the first invoice */
+    aging = gncOwnerAgingNew(fixture->account, days_ago(now, 200).tv_sec, FALSE);
+    owners = gncOwnerAgingGetOwners(aging);
+    g_assert(owners == NULL);
+    gncOwnerAgingDestroy(aging);
+
+    /* Once everything is paid the customer is still listed, owing
+     * nothing */
+    paid = days_ago(now, 1);
+    lots = g_list_append(NULL, gncInvoiceGetPostedLot(new_invoice));
+    gncOwnerApplyPayment(&fixture->owner, NULL, lots, fixture->account, bank,
+                         gnc_numeric_create(40, 1), gnc_numeric_create(1, 1),
+                         paid, "", "", FALSE);
+    g_list_free(lots);
+    aging = gncOwnerAgingNew(fixture->account, now, FALSE);
+    owners = gncOwnerAgingGetOwners(aging);
+    g_assert_cmpuint(g_list_length(owners), ==, 1);
+    g_list_free_full(owners, (GDestroyNotify)gncOwnerFree);
+    assert_aging(aging, &fixture->owner, paid_off);
+    gncOwnerAgingDestroy(aging);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
     GNC_TEST_ADD( suitename, "post", Fixture, NULL, setup, test_invoice_post, teardown );
+    GNC_TEST_ADD( suitename, "totals", Fixture, NULL, setup, test_invoice_totals, teardown );
+    GNC_TEST_ADD( suitename, "post list", Fixture, NULL, setup, test_invoice_post_list, teardown );
+    GNC_TEST_ADD( suitename, "owner aging", Fixture, NULL, setup, test_owner_aging, teardown );
 }
@@ -0,0 +1,156 @@
+/********************************************************************
+ * utest-Scrub.c: GLib g_test test suite for Scrub.c.               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+#include "config.h"
+#include <string.h>
+#include <glib.h>
+#include <qof.h>
+#include <unittest-support.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../TransactionP.h"
+#include "../Scrub.h"
+
+static const gchar *suitename = "/engine/Scrub";
+void test_suite_scrub ( void );
+
+typedef struct
+{
+    QofBook *book;
+    gnc_commodity *usd;
+    Account *acc_a;
+    Account *acc_b;
+    Transaction *mismatched;
+    Transaction *no_currency;
+} Fixture;
+
+typedef struct
+{
+    void (*scrub) (Account *root);
+} ScrubData;
+
+static Account *
+make_account (Fixture *fixture, const char *name)
+{
+    Account *acc = xaccMallocAccount (fixture->book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetCommodity (acc, fixture->usd);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (gnc_book_get_root_account (fixture->book), acc);
+    return acc;
+}
+
+static Transaction *
+make_trans (Fixture *fixture, gnc_commodity *currency, gint64 value,
+            gint64 amount_a)
+{
+    Transaction *trans = xaccMallocTransaction (fixture->book);
+    Split *split_a = xaccMallocSplit (fixture->book);
+    Split *split_b = xaccMallocSplit (fixture->book);
+
+    xaccTransBeginEdit (trans);
+    if (currency)
+        xaccTransSetCurrency (trans, currency);
+    xaccSplitSetParent (split_a, trans);
+    xaccSplitSetParent (split_b, trans);
+    xaccSplitSetAccount (split_a, fixture->acc_a);
+    xaccSplitSetAccount (split_b, fixture->acc_b);
+    xaccSplitSetValue (split_a, gnc_numeric_create (value, 1));
+    xaccSplitSetAmount (split_a, gnc_numeric_create (amount_a, 1));
+    xaccSplitSetValue (split_b, gnc_numeric_create (-value, 1));
+    xaccSplitSetAmount (split_b, gnc_numeric_create (-value, 1));
+    xaccTransCommitEdit (trans);
+    return trans;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gnc_commodity_table *table;
+
+    fixture->book = qof_book_new ();
+    table = gnc_commodity_table_get_table (fixture->book);
+    fixture->usd = gnc_commodity_new (fixture->book, "US Dollar", "ISO4217",
+                                      "USD", "840", 100);
+    fixture->usd = gnc_commodity_table_insert (table, fixture->usd);
+    fixture->acc_a = make_account (fixture, "A");
+    fixture->acc_b = make_account (fixture, "B");
+
+    /* The account's commodity was also kept in the old field. */
+    xaccAccountBeginEdit (fixture->acc_a);
+    DxaccAccountSetCurrency (fixture->acc_a, fixture->usd);
+
+    /* Like a file from an old or broken version: committing mustn't
+     * repair the transactions before the scrub gets to them. */
+    xaccDisableDataScrubbing ();
+    fixture->mismatched = make_trans (fixture, fixture->usd, 10, 0);
+    fixture->no_currency = make_trans (fixture, NULL, 5, 5);
+    xaccEnableDataScrubbing ();
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    qof_book_destroy (fixture->book);
+}
+
+static void
+test_tree_scrub_commodities_and_splits (Fixture *fixture, gconstpointer pData)
+{
+    const ScrubData *data = pData;
+    Split *split_a;
+
+    g_assert (DxaccAccountGetCurrency (fixture->acc_a) == fixture->usd);
+    g_assert (xaccTransGetCurrency (fixture->no_currency) == NULL);
+
+    data->scrub (gnc_book_get_root_account (fixture->book));
+
+    /* The transaction without a currency gets that of its accounts. */
+    g_assert (xaccTransGetCurrency (fixture->no_currency) == fixture->usd);
+    /* An amount not matching the value in the same currency is fixed. */
+    split_a = xaccTransFindSplitByAccount (fixture->mismatched, fixture->acc_a);
+    g_assert (gnc_numeric_equal (xaccSplitGetAmount (split_a),
+                                 gnc_numeric_create (10, 1)));
+    split_a = xaccTransFindSplitByAccount (fixture->no_currency, fixture->acc_a);
+    g_assert (gnc_numeric_equal (xaccSplitGetAmount (split_a),
+                                 gnc_numeric_create (5, 1)));
+    /* And the old commodity fields are gone. */
+    g_assert (DxaccAccountGetCurrency (fixture->acc_a) == NULL);
+    g_assert (xaccAccountGetCommodity (fixture->acc_a) == fixture->usd);
+}
+
+static void
+scrub_separately (Account *root)
+{
+    xaccAccountTreeScrubCommodities (root);
+    xaccAccountTreeScrubSplits (root);
+}
+
+static ScrubData fused = { xaccAccountTreeScrubCommoditiesAndSplits };
+static ScrubData separate = { scrub_separately };
+
+void
+test_suite_scrub ( void )
+{
+    GNC_TEST_ADD (suitename, "xaccAccountTreeScrubCommoditiesAndSplits", Fixture, &fused, setup, test_tree_scrub_commodities_and_splits, teardown);
+    GNC_TEST_ADD (suitename, "separate commodity and split scrubs", Fixture, &separate, setup, test_tree_scrub_commodities_and_splits, teardown);
+}
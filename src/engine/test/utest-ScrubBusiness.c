@@ -0,0 +1,192 @@
+/********************************************************************
+ * utest-ScrubBusiness.c: GLib g_test test suite for ScrubBusiness.c *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+#include "config.h"
+#include <string.h>
+#include <glib.h>
+#include <qof.h>
+#include <unittest-support.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../ScrubBusiness.h"
+#include "../ScrubBusinessP.h"
+
+static const gchar *suitename = "/engine/ScrubBusiness";
+void test_suite_scrub_business ( void );
+
+typedef struct
+{
+    QofBook *book;
+    gnc_commodity *currency;
+    gnc_commodity *shares;
+    Account *account;
+    Transaction *trans;
+    gint64 max_cells;
+} Fixture;
+
+static void
+setup( Fixture *fixture, gconstpointer pData )
+{
+    fixture->book = qof_book_new();
+    fixture->currency = gnc_commodity_new(fixture->book, "US Dollar",
+                                          "ISO4217", "USD", "840", 100);
+    /* The account's SCU is coarser than the currency's fraction, which
+     * the values are in. */
+    fixture->shares = gnc_commodity_new(fixture->book, "Shares", "FUND",
+                                        "SHR", "", 1);
+
+    fixture->account = xaccMallocAccount(fixture->book);
+    xaccAccountBeginEdit(fixture->account);
+    xaccAccountSetCommodity(fixture->account, fixture->shares);
+    xaccAccountCommitEdit(fixture->account);
+
+    /* The splits don't balance, so the transaction stays open. */
+    fixture->trans = xaccMallocTransaction(fixture->book);
+    xaccTransBeginEdit(fixture->trans);
+    xaccTransSetCurrency(fixture->trans, fixture->currency);
+
+    fixture->max_cells = gncScrubBusinessGetMaxSubsetCells();
+}
+
+static void
+teardown( Fixture *fixture, gconstpointer pData )
+{
+    gncScrubBusinessSetMaxSubsetCells(fixture->max_cells);
+
+    xaccTransDestroy(fixture->trans);
+    xaccTransCommitEdit(fixture->trans);
+
+    xaccAccountBeginEdit(fixture->account);
+    xaccAccountDestroy(fixture->account);
+    gnc_commodity_destroy(fixture->shares);
+    gnc_commodity_destroy(fixture->currency);
+
+    qof_book_destroy( fixture->book );
+}
+
+/* Adds a split of each value, in cents, and returns them in order. */
+static SplitList *
+make_splits (Fixture *fixture, const gint64 *cents, guint n)
+{
+    SplitList *splits = NULL;
+    guint i;
+
+    for (i = 0; i < n; ++i)
+    {
+        Split *split = xaccMallocSplit(fixture->book);
+        gnc_numeric value = gnc_numeric_create(cents[i], 100);
+
+        xaccSplitSetParent(split, fixture->trans);
+        xaccSplitSetAccount(split, fixture->account);
+        xaccSplitSetValue(split, value);
+        splits = g_list_append(splits, split);
+    }
+    return splits;
+}
+
+/* Checks that match holds the splits at the given indices of splits,
+ * in list order. */
+static void
+assert_match (SplitList *match, SplitList *splits, const guint *indices,
+              guint n)
+{
+    guint i;
+
+    g_assert_cmpint(g_list_length(match), ==, n);
+    for (i = 0; i < n; ++i, match = match->next)
+        g_assert(match->data == g_list_nth_data(splits, indices[i]));
+}
+
+/* The largest value first leaves a remainder nothing fits, so only the
+ * exact search finds 3.25 + 3.25.  The target isn't a whole number of
+ * the account's SCU. */
+static const gint64 greedy_misses[] =
+{ 400, 325, 325, 300, 300, 300, 300, 300, 300 };
+
+static void
+test_find_offs_splits_dp ( Fixture *fixture, gconstpointer pData )
+{
+    SplitList *splits = make_splits(fixture, greedy_misses,
+                                    G_N_ELEMENTS (greedy_misses));
+    SplitList *match = gncSLFindOffsSplits(splits,
+                                           gnc_numeric_create(-650, 100));
+    const guint expected[] = { 1, 2 };
+
+    assert_match(match, splits, expected, G_N_ELEMENTS (expected));
+    g_list_free(match);
+
+    /* No subset adds up to 6.51. */
+    g_assert(gncSLFindOffsSplits(splits, gnc_numeric_create(-651, 100))
+             == NULL);
+    g_list_free(splits);
+}
+
+static void
+test_find_offs_splits_greedy ( Fixture *fixture, gconstpointer pData )
+{
+    const gint64 greedy_hits[] =
+    { 500, 250, 250, 100, 80, 80, 80, 80, 80 };
+    SplitList *splits = make_splits(fixture, greedy_misses,
+                                    G_N_ELEMENTS (greedy_misses));
+    SplitList *hits, *match;
+    const guint expected[] = { 0, 3 };
+
+    /* A table of 650 units times nine candidates is too big. */
+    gncScrubBusinessSetMaxSubsetCells(650 * G_N_ELEMENTS (greedy_misses) - 1);
+    g_assert(gncSLFindOffsSplits(splits, gnc_numeric_create(-650, 100))
+             == NULL);
+    gncScrubBusinessSetMaxSubsetCells(650 * G_N_ELEMENTS (greedy_misses));
+    g_assert(gncSLFindOffsSplits(splits, gnc_numeric_create(-650, 100))
+             != NULL);
+    g_list_free(splits);
+
+    /* The greedy match takes 5.00 and then 1.00. */
+    gncScrubBusinessSetMaxSubsetCells(0);
+    hits = make_splits(fixture, greedy_hits, G_N_ELEMENTS (greedy_hits));
+    match = gncSLFindOffsSplits(hits, gnc_numeric_create(-600, 100));
+    assert_match(match, hits, expected, G_N_ELEMENTS (expected));
+    g_list_free(match);
+    g_list_free(hits);
+}
+
+static void
+test_find_offs_splits_exhaustive ( Fixture *fixture, gconstpointer pData )
+{
+    /* Few enough candidates for the exhaustive search, whatever the
+     * bound. */
+    const gint64 cents[] = { 400, 325, 325, 300 };
+    SplitList *splits = make_splits(fixture, cents, G_N_ELEMENTS (cents));
+    SplitList *match;
+    const guint expected[] = { 1, 2 };
+
+    gncScrubBusinessSetMaxSubsetCells(0);
+    match = gncSLFindOffsSplits(splits, gnc_numeric_create(-650, 100));
+    assert_match(match, splits, expected, G_N_ELEMENTS (expected));
+    g_list_free(match);
+    g_list_free(splits);
+}
+
+void
+test_suite_scrub_business ( void )
+{
+    GNC_TEST_ADD (suitename, "find offsetting splits dp", Fixture, NULL, setup, test_find_offs_splits_dp, teardown);
+    GNC_TEST_ADD (suitename, "find offsetting splits greedy", Fixture, NULL, setup, test_find_offs_splits_greedy, teardown);
+    GNC_TEST_ADD (suitename, "find offsetting splits exhaustive", Fixture, NULL, setup, test_find_offs_splits_exhaustive, teardown);
+}
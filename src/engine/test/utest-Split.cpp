@@ -401,11 +401,13 @@ test_xaccSplitEqualCheckBal (Fixture *fixture, gconstpointer pData)
 
     hdlr = g_log_set_handler ("gnc.engine", loglevel,
                               (GLogFunc)test_checked_handler, &check);
+    qof_log_set_level ("gnc.engine", QOF_LOG_INFO);
 
     g_assert_cmpint (fixture->func->xaccSplitEqualCheckBal ("test ", foo, foo), ==, TRUE);
     g_assert_cmpint (fixture->func->xaccSplitEqualCheckBal ("test ", foo, bar), ==, FALSE);
     g_assert_cmpint (check.hits, ==, 1);
     g_log_remove_handler ("gnc.engine", hdlr);
+    qof_log_set_level ("gnc.engine", QOF_LOG_WARNING);
 
 }
 /* xaccSplitEqual
@@ -446,6 +448,7 @@ test_xaccSplitEqual (Fixture *fixture, gconstpointer pData)
 
     hdlr  = g_log_set_handler (logdomain, loglevel,
                                (GLogFunc)test_list_handler, &checkA);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     /* Note that check_splits is just passed through to xaccTransEqual, so we don't vary it here. */
     /* Test that a NULL comparison fails */
     g_assert (xaccSplitEqual (fixture->split, NULL, TRUE, TRUE, TRUE) == FALSE);
@@ -531,6 +534,7 @@ test_xaccSplitEqual (Fixture *fixture, gconstpointer pData)
     g_log_remove_handler (logdomain, hdlr);
 
     g_free (msg03);
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
 }
 /* xaccSplitGetAccount
  * xaccSplitSetAccount
@@ -1621,6 +1625,73 @@ test_xaccSplitCompareOtherAccountCodes (Fixture *fixture, gconstpointer pData)
     test_destroy (acc1);
 }
 
+/* xaccSplitSameGroup
+gboolean
+xaccSplitSameGroup(const Split *sa, const Split *sb, SplitGroup group)
+*/
+static void
+set_date_posted (Transaction *txn, gint day, gint month, gint year)
+{
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecsNormalized (txn, gnc_dmy2timespec (day, month, year).tv_sec);
+    xaccTransCommitEdit (txn);
+}
+
+static void
+test_xaccSplitSameGroup (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = xaccSplitGetBook (fixture->split);
+    Account *acc = fixture->split->acc;
+    Account *acc1 = xaccMallocAccount (book);
+    Transaction *txn = fixture->split->parent;
+    Transaction *txn1 = xaccMallocTransaction (book);
+    Split *split = fixture->split;
+    Split *split1 = xaccMallocSplit (book);
+
+    xaccAccountSetCommodity (acc1, fixture->curr);
+    xaccAccountSetName (acc, "foo");
+    xaccAccountSetName (acc1, "bar");
+    xaccAccountSetCode (acc, "1000");
+    xaccAccountSetCode (acc1, "1000");
+    split1->acc = acc;
+    split1->value = gnc_numeric_create (456, 240);
+
+    xaccTransBeginEdit (txn1);
+    xaccTransSetCurrency (txn1, fixture->curr);
+    xaccSplitSetParent (split1, txn1);
+    xaccTransCommitEdit (txn1);
+
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_ACCOUNT_NAME));
+    split1->acc = acc1;
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_ACCOUNT_NAME));
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_ACCOUNT_CODE));
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_NONE));
+    split1->acc = acc;
+
+    /* Wednesday and Friday of the same week. */
+    set_date_posted (txn, 14, 5, 2014);
+    set_date_posted (txn1, 16, 5, 2014);
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_WEEK));
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_MONTH));
+
+    set_date_posted (txn1, 20, 5, 2014);
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_WEEK));
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_MONTH));
+
+    set_date_posted (txn1, 1, 7, 2014);
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_MONTH));
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_QUARTER));
+    g_assert (xaccSplitSameGroup (split, split1, SPLIT_GROUP_YEAR));
+
+    set_date_posted (txn1, 14, 5, 2015);
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_MONTH));
+    g_assert (!xaccSplitSameGroup (split, split1, SPLIT_GROUP_YEAR));
+
+    test_destroy (split1);
+    test_destroy (txn1);
+    test_destroy (acc1);
+}
+
 /* xaccSplitSetParent
 void
 xaccSplitSetParent(Split *s, Transaction *t)// C: 10 in 7 SCM: 6 in 2 Local: 3:0:0
@@ -1937,6 +2008,7 @@ test_suite_split (void)
     GNC_TEST_ADD (suitename, "xaccSplitCompareAccountCodes", Fixture, NULL, setup, test_xaccSplitCompareAccountCodes, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitCompareOtherAccountFullNames", Fixture, NULL, setup, test_xaccSplitCompareOtherAccountFullNames, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitCompareOtherAccountCodes", Fixture, NULL, setup, test_xaccSplitCompareOtherAccountCodes, teardown);
+    GNC_TEST_ADD (suitename, "xaccSplitSameGroup", Fixture, NULL, setup, test_xaccSplitSameGroup, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitSetParent", Fixture, NULL, setup, test_xaccSplitSetParent, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitGetSharePrice", Fixture, NULL, setup, test_xaccSplitGetSharePrice, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitMakeStockSplit", Fixture, NULL, setup, test_xaccSplitMakeStockSplit, teardown);
@@ -429,6 +429,7 @@ test_gnc_transaction_set_get_property (Fixture *fixture, gconstpointer pData)
                      (GLogFunc)test_checked_handler);
     fixture->hdlrs = test_log_set_handler (fixture->hdlrs, check2,
                                            (GLogFunc)test_checked_handler);
+    qof_log_set_level ("gnc.engine", QOF_LOG_INFO);
     g_assert_cmpstr (txn->num, ==, "");
     g_assert_cmpstr (txn->description, ==, "");
     g_assert (txn->common_currency == NULL);
@@ -452,6 +453,11 @@ test_gnc_transaction_set_get_property (Fixture *fixture, gconstpointer pData)
     g_assert (txn->common_currency == curr);
     g_assert (timespec_equal (&(txn->date_entered), &now));
     g_assert (timespec_equal (&(txn->date_posted), &now));
+    {
+        GDate today = timespec_to_gdate (now);
+        g_assert_cmpuint (xaccTransGetDatePostedDay (txn), ==,
+                          g_date_get_julian (&today));
+    }
     g_assert_cmpint (check1->hits, ==, 1);
     g_assert_cmpint (check2->hits, ==, 2);
 
@@ -478,6 +484,7 @@ test_gnc_transaction_set_get_property (Fixture *fixture, gconstpointer pData)
     test_destroy (curr);
     qof_book_destroy (book);
     g_free (t_entered);
+    qof_log_set_level ("gnc.engine", QOF_LOG_WARNING);
 }
 /* gnc_transaction_class_init
  * xaccInitTransaction
@@ -811,6 +818,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
 
     fixture->hdlrs = test_log_set_handler (fixture->hdlrs, check,
                                            (GLogFunc)test_list_handler);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     /* Booleans are check_guids, check_splits, check_balances, assume_ordered */
     g_assert (xaccTransEqual (NULL, NULL, TRUE, TRUE, TRUE, TRUE));
     g_assert (!xaccTransEqual (txn0, NULL, TRUE, TRUE, TRUE, TRUE));
@@ -972,6 +980,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     }
     g_free (check3->msg);
     g_free (check2->msg);
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
 }
 /* xaccTransUseTradingAccounts
 xaccTransUseTradingAccounts
@@ -1013,6 +1022,14 @@ test_xaccTransGetImbalanceValue (Fixture *fixture, gconstpointer pData)
 
     g_assert (gnc_numeric_equal (xaccTransGetImbalanceValue (fixture->txn),
                                  split1->value));
+    g_assert (!fixture->txn->imbalance_value_valid);
+    xaccTransCommitEdit (fixture->txn);
+
+    /* A closed transaction keeps its sum until it is opened again. */
+    xaccTransGetImbalanceValue (fixture->txn);
+    g_assert (fixture->txn->imbalance_value_valid);
+    xaccTransBeginEdit (fixture->txn);
+    g_assert (!fixture->txn->imbalance_value_valid);
     xaccTransCommitEdit (fixture->txn);
 }
 /* xaccTransGetImbalance
@@ -1351,6 +1368,7 @@ test_xaccTransBeginEdit ()
     auto check2 = test_error_struct_new (logdomain, loglevel, msg2);
     guint hdlr = g_log_set_handler (logdomain, loglevel,
                                     (GLogFunc)test_list_handler, NULL);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     test_add_error (check1);
     test_add_error (check2);
 
@@ -1395,6 +1413,7 @@ test_xaccTransBeginEdit ()
     test_error_struct_free (check2);
     /* qof_book_destroy has already removed enough of the innards that
        trying to unref the txn and book crashes. */
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
 }
 /* xaccTransDestroy
 void
@@ -1706,15 +1725,22 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     txn->inst.kvp_data = NULL;
     txn->date_entered = new_entered;
     txn->date_posted = new_post;
-    txn->splits->data = split_01;
-    txn->splits->next->data = split_00;
+    /* Splits are only copied when they're about to change. */
+    g_assert_cmpuint (g_list_length (orig->splits), ==, 2);
+    g_assert (orig->splits->data == NULL);
+    g_assert (orig->splits->next->data == NULL);
+    auto split_10 = xaccDupeSplit(split_00);
+    g_object_ref (split_10);
+    auto split_11 = xaccDupeSplit(split_01);
+    g_object_ref (split_11);
+    xaccTransSnapshotSplit (txn, split_01);
+    g_assert (orig->splits->data == NULL);
+    g_assert (orig->splits->next->data != NULL);
+    split_01->amount = gnc_numeric_create (1, 1);
+    split_01->value = gnc_numeric_create (1, 1);
     qof_instance_set_dirty (QOF_INSTANCE (split_01));
     xaccSplitSetParent (split_02, txn);
     g_object_ref (split_02);
-    auto split_10 = xaccDupeSplit(static_cast<Split*>(orig->splits->data));
-    g_object_ref (split_10);
-    auto split_11 = xaccDupeSplit(static_cast<Split*>(orig->splits->next->data));
-    g_object_ref (split_11);
     qof_instance_increase_editlevel (QOF_INSTANCE (txn)); /* So it's 2 */
     xaccTransRollbackEdit (txn);
     g_assert (txn->orig == orig);
@@ -1737,7 +1763,7 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     g_assert (xaccSplitEqual (static_cast<Split*>(txn->splits->data), split_10,
                               FALSE, FALSE, FALSE));
     g_assert (xaccSplitEqual (static_cast<Split*>(txn->splits->next->data),
-                              split_10, FALSE, FALSE, FALSE));
+                              split_11, FALSE, FALSE, FALSE));
     g_assert_cmpstr (mbe->last_call, ==, "rollback");
     g_assert_cmpuint (qof_instance_get_editlevel (QOF_INSTANCE (txn)), ==, 0);
     g_assert (qof_instance_get_destroying (txn) == FALSE);
@@ -1922,6 +1948,31 @@ test_xaccTransVoid (Fixture *fixture, gconstpointer pData)
     g_free (txn_notes);
 
 }
+static void
+test_xaccTransVoidList (Fixture *fixture, gconstpointer pData)
+{
+    GList *list = g_list_prepend (NULL, fixture->txn);
+    gnc_numeric balance = xaccAccountGetBalance (fixture->acc2);
+    auto modified = test_signal_new (QOF_INSTANCE (fixture->txn),
+                                     QOF_EVENT_MODIFY, NULL);
+
+    g_assert (!gnc_numeric_zero_p (balance));
+    xaccTransVoidList (list, "Voided for Unit Test");
+    g_assert (xaccTransGetVoidStatus (fixture->txn));
+    test_signal_assert_hits (modified, 1);
+    g_assert_cmpint (qof_instance_get_editlevel (fixture->acc1), ==, 0);
+    g_assert_cmpint (qof_instance_get_editlevel (fixture->acc2), ==, 0);
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalance (fixture->acc2)));
+
+    xaccTransUnvoidList (list);
+    g_assert (!xaccTransGetVoidStatus (fixture->txn));
+    test_signal_assert_hits (modified, 2);
+    test_signal_free (modified);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalance (fixture->acc2),
+                                 balance));
+    g_list_free (list);
+}
+
 /* xaccTransReverse
 Transaction *
 xaccTransReverse (Transaction *orig)// C: 2 in 2  Local: 0:0:0
@@ -1956,6 +2007,36 @@ test_xaccTransReverse (Fixture *fixture, gconstpointer pData)
 
     fixture->func->xaccFreeTransaction (rev);
 }
+
+static void
+test_xaccTransReverseList (Fixture *fixture, gconstpointer pData)
+{
+    GList *list = g_list_prepend (NULL, fixture->txn);
+    auto created = test_signal_new (NULL, QOF_EVENT_CREATE, NULL);
+    auto modified = test_signal_new (QOF_INSTANCE (fixture->txn),
+                                     QOF_EVENT_MODIFY, NULL);
+    GList *reversed = xaccTransReverseList (list);
+    auto rev = static_cast<Transaction*>(reversed->data);
+    auto frame = fixture->txn->inst.kvp_data;
+
+    /* The events are coalesced, not dropped. */
+    g_assert_cmpint (test_signal_return_hits (created), >, 0);
+    test_signal_assert_hits (modified, 1);
+    test_signal_free (created);
+    test_signal_free (modified);
+
+    g_assert_cmpuint (g_list_length (reversed), ==, 1);
+    g_assert (guid_equal (frame->get_slot(TRANS_REVERSED_BY)->get<GncGUID*>(),
+                          xaccTransGetGUID (rev)));
+    g_assert_cmpint (qof_instance_get_editlevel (fixture->acc2), ==, 0);
+    /* The reversal cancels the original in both accounts. */
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalance (fixture->acc1)));
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalance (fixture->acc2)));
+
+    fixture->func->xaccFreeTransaction (rev);
+    g_list_free (reversed);
+    g_list_free (list);
+}
 /* xaccTransGetReversedBy C: 2 in 2  Local: 0:0:0
  * Trivial getter.
  */
@@ -2082,7 +2163,9 @@ test_suite_transaction (void)
     GNC_TEST_ADD (suitename, "xaccTransOrder_num_action", Fixture, NULL, setup, test_xaccTransOrder_num_action, teardown);
     GNC_TEST_ADD (suitename, "xaccTransGetTxnType", Fixture, NULL, setup, test_xaccTransGetTxnType, teardown);
     GNC_TEST_ADD (suitename, "xaccTransVoid", Fixture, NULL, setup, test_xaccTransVoid, teardown);
+    GNC_TEST_ADD (suitename, "xaccTransVoidList", Fixture, NULL, setup, test_xaccTransVoidList, teardown);
     GNC_TEST_ADD (suitename, "xaccTransReverse", Fixture, NULL, setup, test_xaccTransReverse, teardown);
+    GNC_TEST_ADD (suitename, "xaccTransReverseList", Fixture, NULL, setup, test_xaccTransReverseList, teardown);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_no_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_no_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_base_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_base_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_gains_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_gains_dirty, teardown_with_gains);
@@ -28,6 +28,8 @@
 /* Add specific headers for this class */
 #include <gnc-pricedb.h>
 #include <gnc-pricedb-p.h>
+#include <qofbackend-p.h>
+#include <qofinstance-p.h>
 
 static const gchar *suitename = "/engine/gnc-pricedb";
 void test_suite_gnc_pricedb ( void );
@@ -693,10 +695,94 @@ test_add_price (Fixture *fixture, gconstpointer pData)
 gboolean
 gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)// C: 7 in 7 SCM: 1  Local: 0:0:0
 */
-/* static void
-test_gnc_pricedb_add_price (Fixture *fixture, gconstpointer pData)
+static void
+test_gnc_pricedb_add_price (PriceDBFixture *fixture, gconstpointer pData)
 {
-}*/
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    Commodities *c = fixture->com;
+    int count = gnc_pricedb_num_prices (db, c->gbp);
+    Timespec t = gnc_dmy2timespec (15, 1, 2012);
+    GNCPrice *p, *prev;
+    int i;
+
+    /* A second price on a day with one already replaces it. */
+    p = construct_price (book, c->gbp, c->usd, gnc_dmy2timespec (20, 7, 2011),
+                         PRICE_SOURCE_FQ, gnc_numeric_create (161643, 100000));
+    g_assert (gnc_pricedb_add_price (db, p));
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->gbp), ==, count);
+
+    /* A new date sorts into the middle of the series. */
+    p = construct_price (book, c->gbp, c->usd, t, PRICE_SOURCE_FQ,
+                         gnc_numeric_create (160000, 100000));
+    g_assert (gnc_pricedb_add_price (db, p));
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->gbp), ==, count + 1);
+    g_assert (gnc_pricedb_lookup_at_time (db, c->gbp, c->usd, t) == p);
+    gnc_price_unref (p);
+    prev = gnc_pricedb_nth_price (db, c->gbp, 0);
+    for (i = 1; i <= count; i++)
+    {
+        GNCPrice *next = gnc_pricedb_nth_price (db, c->gbp, i);
+        Timespec prev_t = gnc_price_get_time (prev);
+        Timespec next_t = gnc_price_get_time (next);
+        g_assert_cmpint (timespec_cmp (&prev_t, &next_t), >=, 0);
+        prev = next;
+    }
+
+    g_assert (gnc_pricedb_remove_price (db, p));
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->gbp), ==, count);
+    g_assert (gnc_pricedb_lookup_at_time (db, c->gbp, c->usd, t) == NULL);
+}
+static void
+test_gnc_pricedb_add_prices (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    Commodities *c = fixture->com;
+    int gbp_count = gnc_pricedb_num_prices (db, c->gbp);
+    int aud_count = gnc_pricedb_num_prices (db, c->aud);
+    Timespec t1 = gnc_dmy2timespec (15, 1, 2012);
+    Timespec t2 = gnc_dmy2timespec (15, 1, 2015);
+    GNCPrice *p1, *p2, *p3, *p4, *p5, *found;
+    GList *prices = NULL, *node;
+
+    /* Replaces the price of 20 July 2011 */
+    p1 = construct_price (book, c->gbp, c->usd, gnc_dmy2timespec (20, 7, 2011),
+                          PRICE_SOURCE_FQ, gnc_numeric_create (161000, 100000));
+    p2 = construct_price (book, c->gbp, c->usd, t1, PRICE_SOURCE_FQ,
+                          gnc_numeric_create (160000, 100000));
+    p3 = construct_price (book, c->gbp, c->usd, t2, PRICE_SOURCE_FQ,
+                          gnc_numeric_create (155000, 100000));
+    /* Same pair and day as p3 but a worse source */
+    p4 = construct_price (book, c->gbp, c->usd, t2, PRICE_SOURCE_TEMP,
+                          gnc_numeric_create (150000, 100000));
+    p5 = construct_price (book, c->aud, c->usd, t1, PRICE_SOURCE_FQ,
+                          gnc_numeric_create (103000, 100000));
+    prices = g_list_prepend (prices, p5);
+    prices = g_list_prepend (prices, p4);
+    prices = g_list_prepend (prices, p1);
+    prices = g_list_prepend (prices, p3);
+    prices = g_list_prepend (prices, p2);
+
+    g_assert_cmpuint (gnc_pricedb_add_prices (db, prices), ==, 4);
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->gbp), ==, gbp_count + 2);
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->aud), ==, aud_count + 1);
+    found = gnc_pricedb_lookup_latest (db, c->gbp, c->usd);
+    g_assert (found == p3);
+    gnc_price_unref (found);
+    found = gnc_pricedb_lookup_at_time (db, c->gbp, c->usd, t1);
+    g_assert (found == p2);
+    gnc_price_unref (found);
+    g_assert (p4->db == NULL);
+
+    /* Adding them again changes nothing */
+    g_assert_cmpuint (gnc_pricedb_add_prices (db, prices), ==, 0);
+    g_assert_cmpint (gnc_pricedb_num_prices (db, c->gbp), ==, gbp_count + 2);
+
+    for (node = prices; node; node = node->next)
+        gnc_price_unref (node->data);
+    g_list_free (prices);
+}
 /* remove_price
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)// Local: 4:0:0
@@ -705,6 +791,414 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)// Local: 4:0:0
 test_remove_price (Fixture *fixture, gconstpointer pData)
 {
 }*/
+/* pricedb_lazy_load
+static void
+pricedb_lazy_load (GNCPriceDB *db, const gnc_commodity *c,// Local: 11:0:0
+*/
+/* A price stored in the mock database. */
+typedef struct
+{
+    gnc_commodity *commodity;
+    gnc_commodity *currency;
+    Timespec date;
+    gint64 num;
+    GncGUID guid;
+} LazyRow;
+
+/* A backend that, like the SQL one, loads the prices the pricedb asks
+ * for through price_lookup from its own table, skipping those that
+ * are already in memory. */
+typedef struct
+{
+    QofBackend be;
+    GArray *rows;
+    guint lookups;
+    const gnc_commodity *last_commodity;
+    const gnc_commodity *last_currency;
+} LazyBackend;
+
+typedef struct
+{
+    GNCPriceDB *pricedb;
+    Commodities *com;
+    LazyBackend *lbe;
+    Timespec since;
+} LazyFixture;
+
+/* The same as PRICEDB_LAZY_MAX_LOADED in gnc-pricedb.c. */
+#define LAZY_MAX_LOADED 32
+
+static gboolean
+lazy_row_matches (const LazyRow *row, const GNCPriceLookup *lookup)
+{
+    if (!lookup->commodity)
+        return TRUE;
+    if (!lookup->currency)
+        return row->commodity == lookup->commodity ||
+               row->currency == lookup->commodity;
+    return (row->commodity == lookup->commodity &&
+            row->currency == lookup->currency) ||
+           (row->commodity == lookup->currency &&
+            row->currency == lookup->commodity);
+}
+
+static void
+lazy_load_row (GNCPriceDB *db, const LazyRow *row)
+{
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    GNCPrice *p;
+
+    if (gnc_price_lookup (&row->guid, book))
+        return;
+    p = construct_price (book, row->commodity, row->currency, row->date,
+                         PRICE_SOURCE_FQ,
+                         gnc_numeric_create (row->num, 100000));
+    qof_instance_set_guid (p, &row->guid);
+    gnc_pricedb_add_price (db, p);
+    gnc_price_unref (p);
+}
+
+static void
+lazy_price_lookup (QofBackend *be, gpointer data)
+{
+    LazyBackend *lbe = (LazyBackend*)be;
+    GNCPriceLookup *lookup = data;
+    guint i;
+
+    g_assert_cmpint (lookup->type, ==, LOOKUP_ALL);
+    lbe->lookups++;
+    lbe->last_commodity = lookup->commodity;
+    lbe->last_currency = lookup->currency;
+    gnc_pricedb_set_bulk_update (lookup->prdb, TRUE);
+    for (i = 0; i < lbe->rows->len; i++)
+    {
+        LazyRow *row = &g_array_index (lbe->rows, LazyRow, i);
+        if (timespec_cmp (&row->date, &lookup->date) < 0 &&
+            lazy_row_matches (row, lookup))
+            lazy_load_row (lookup->prdb, row);
+    }
+    gnc_pricedb_set_bulk_update (lookup->prdb, FALSE);
+}
+
+static void
+lazy_add_row (LazyFixture *fixture, gnc_commodity *commodity,
+              gnc_commodity *currency, Timespec date, gint64 num)
+{
+    LazyRow row;
+
+    row.commodity = commodity;
+    row.currency = currency;
+    row.date = date;
+    row.num = num;
+    guid_replace (&row.guid);
+    g_array_append_val (fixture->lbe->rows, row);
+}
+
+/* Finds the stored price of a pair at a date. */
+static const LazyRow *
+lazy_find_row (LazyFixture *fixture, gnc_commodity *commodity, Timespec date)
+{
+    guint i;
+
+    for (i = 0; i < fixture->lbe->rows->len; i++)
+    {
+        LazyRow *row = &g_array_index (fixture->lbe->rows, LazyRow, i);
+        if (row->commodity == commodity && timespec_equal (&row->date, &date))
+            return row;
+    }
+    return NULL;
+}
+
+/* Loads what the SQL backend loads when the book is opened: every
+ * price from since on and the newest older one of each pair. */
+static void
+lazy_open (LazyFixture *fixture)
+{
+    GArray *rows = fixture->lbe->rows;
+    guint i, j;
+
+    gnc_pricedb_set_bulk_update (fixture->pricedb, TRUE);
+    for (i = 0; i < rows->len; i++)
+    {
+        LazyRow *row = &g_array_index (rows, LazyRow, i);
+        gboolean newest_before = TRUE;
+
+        if (timespec_cmp (&row->date, &fixture->since) < 0)
+        {
+            for (j = 0; j < rows->len; j++)
+            {
+                LazyRow *other = &g_array_index (rows, LazyRow, j);
+                if (other->commodity == row->commodity &&
+                    other->currency == row->currency &&
+                    timespec_cmp (&other->date, &fixture->since) < 0 &&
+                    timespec_cmp (&other->date, &row->date) > 0)
+                    newest_before = FALSE;
+            }
+        }
+        if (newest_before)
+            lazy_load_row (fixture->pricedb, row);
+    }
+    gnc_pricedb_set_bulk_update (fixture->pricedb, FALSE);
+    gnc_pricedb_set_lazy_window (fixture->pricedb, fixture->since);
+}
+
+static void
+setup_lazy (LazyFixture *fixture, gconstpointer data)
+{
+    QofBook *book;
+    Commodities *c;
+
+    gnc_pricedb_register ();
+    book = qof_book_new ();
+    fixture->com = c = setup_commodities (book);
+    fixture->pricedb = gnc_pricedb_get_db (book);
+    fixture->since = gnc_dmy2timespec (1, 1, 2013);
+    fixture->lbe = g_new0 (LazyBackend, 1);
+    fixture->lbe->be.price_lookup = lazy_price_lookup;
+    fixture->lbe->rows = g_array_new (FALSE, FALSE, sizeof (LazyRow));
+    qof_book_set_backend (book, &fixture->lbe->be);
+
+    lazy_add_row (fixture, c->gbp, c->usd, gnc_dmy2timespec (11, 4, 2009), 166651);
+    lazy_add_row (fixture, c->gbp, c->usd, gnc_dmy2timespec (21, 8, 2010), 159037);
+    lazy_add_row (fixture, c->gbp, c->usd, gnc_dmy2timespec (20, 7, 2011), 161643);
+    lazy_add_row (fixture, c->gbp, c->usd, gnc_dmy2timespec (17, 11, 2012), 158855);
+    lazy_add_row (fixture, c->gbp, c->usd, gnc_dmy2timespec (12, 11, 2014), 157658);
+    lazy_add_row (fixture, c->amzn, c->usd, gnc_dmy2timespec (13, 4, 2009), 7805000);
+    lazy_add_row (fixture, c->amzn, c->usd, gnc_dmy2timespec (23, 8, 2010), 12664000);
+    lazy_add_row (fixture, c->amzn, c->usd, gnc_dmy2timespec (19, 11, 2012), 23988000);
+    lazy_add_row (fixture, c->amzn, c->usd, gnc_dmy2timespec (12, 11, 2014), 31151000);
+}
+
+static void
+teardown_lazy (LazyFixture *fixture, gconstpointer data)
+{
+    QofBook *book = qof_instance_get_book (fixture->pricedb);
+
+    qof_book_set_backend (book, NULL);
+    qof_book_destroy (book);
+    g_array_free (fixture->lbe->rows, TRUE);
+    g_free (fixture->lbe);
+    g_free (fixture->com);
+}
+
+/* The prices in memory.  gnc_pricedb_get_num_prices would load all of
+ * them first. */
+static guint
+lazy_loaded_prices (LazyFixture *fixture)
+{
+    QofBook *book = qof_instance_get_book (fixture->pricedb);
+    return qof_collection_count (qof_book_get_collection (book, GNC_ID_PRICE));
+}
+
+static gint64
+price_num (GNCPrice *p, gint64 denom)
+{
+    return gnc_numeric_convert (gnc_price_get_value (p), denom,
+                                GNC_HOW_RND_NEVER).num;
+}
+
+static void
+test_pricedb_lazy_load_window (LazyFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    Commodities *c = fixture->com;
+    GNCPrice *p;
+
+    lazy_open (fixture);
+    g_assert_cmpuint (lazy_loaded_prices (fixture), ==, 4);
+
+    /* Lookups from the start of the window on are answered from
+     * memory, those just inside it by the newest older price. */
+    p = gnc_pricedb_lookup_latest_before (db, c->gbp, c->usd,
+                                          gnc_dmy2timespec (1, 12, 2014));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 157658);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_latest_before (db, c->gbp, c->usd,
+                                          gnc_dmy2timespec (1, 2, 2013));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 158855);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_nearest_in_time (db, c->amzn, c->usd,
+                                            gnc_dmy2timespec (1, 10, 2014));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100), ==, 31151);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 0);
+    g_assert_cmpuint (lazy_loaded_prices (fixture), ==, 4);
+}
+
+static void
+test_pricedb_lazy_load_pair (LazyFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    Commodities *c = fixture->com;
+    GNCPrice *p;
+    PriceList *prices;
+
+    lazy_open (fixture);
+
+    /* Reaching before the window loads the pair's older prices. */
+    p = gnc_pricedb_lookup_latest_before (db, c->gbp, c->usd,
+                                          gnc_dmy2timespec (1, 1, 2010));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 166651);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+    g_assert (fixture->lbe->last_commodity == c->gbp);
+    g_assert (fixture->lbe->last_currency == c->usd);
+    g_assert_cmpuint (lazy_loaded_prices (fixture), ==, 7);
+
+    /* Only once: the pair, in either order, is remembered. */
+    p = gnc_pricedb_lookup_latest_before (db, c->usd, c->gbp,
+                                          gnc_dmy2timespec (1, 1, 2011));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 159037);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+
+    /* The other pair is still the way it was loaded. */
+    prices = gnc_pricedb_get_prices (db, c->amzn, c->usd);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 2);
+    g_assert (fixture->lbe->last_commodity == c->amzn);
+    g_assert (fixture->lbe->last_currency == c->usd);
+    g_assert_cmpint (g_list_length (prices), ==, 4);
+    g_assert_cmpint (price_num (prices->data, 100), ==, 31151);
+    g_assert_cmpint (price_num (g_list_last (prices)->data, 100), ==, 7805);
+    gnc_price_list_destroy (prices);
+    g_assert_cmpuint (lazy_loaded_prices (fixture), ==, 9);
+}
+
+static void
+test_pricedb_lazy_load_any_currency (LazyFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    Commodities *c = fixture->com;
+    PriceList *prices, *node;
+
+    lazy_open (fixture);
+
+    /* The prices against any currency are those the usd takes part in. */
+    prices = gnc_pricedb_lookup_latest_before_any_currency (db, c->usd,
+             gnc_dmy2timespec (1, 1, 2010));
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+    g_assert (fixture->lbe->last_commodity == c->usd);
+    g_assert (fixture->lbe->last_currency == NULL);
+    g_assert_cmpint (g_list_length (prices), ==, 2);
+    for (node = prices; node; node = node->next)
+    {
+        GNCPrice *p = node->data;
+        if (gnc_price_get_commodity (p) == c->gbp)
+            g_assert_cmpint (price_num (p, 100000), ==, 166651);
+        else
+            g_assert_cmpint (price_num (p, 100), ==, 7805);
+    }
+    gnc_price_list_destroy (prices);
+    g_assert_cmpuint (lazy_loaded_prices (fixture), ==, 9);
+
+    /* The pairs of the usd are covered by that. */
+    prices = gnc_pricedb_get_prices (db, c->gbp, c->usd);
+    g_assert_cmpint (g_list_length (prices), ==, 5);
+    gnc_price_list_destroy (prices);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+}
+
+static gboolean
+lazy_count_price (GNCPrice *p, gpointer data)
+{
+    ++*(gint*)data;
+    return TRUE;
+}
+
+static void
+test_pricedb_lazy_load_all (LazyFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    Commodities *c = fixture->com;
+    GNCPrice *p;
+    gint count = 0;
+
+    lazy_open (fixture);
+
+    /* Traversing the whole database loads all of it and ends the
+     * window. */
+    g_assert (gnc_pricedb_foreach_price (db, lazy_count_price, &count, TRUE));
+    g_assert_cmpint (count, ==, 9);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+    g_assert (fixture->lbe->last_commodity == NULL);
+    g_assert (!db->lazy);
+
+    p = gnc_pricedb_lookup_latest_before (db, c->amzn, c->usd,
+                                          gnc_dmy2timespec (1, 1, 2010));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100), ==, 7805);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, 1);
+}
+
+static void
+test_pricedb_lazy_load_evict (LazyFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    Commodities *c = fixture->com;
+    gnc_commodity *funds[LAZY_MAX_LOADED];
+    const LazyRow *old;
+    GNCPrice *p, *held;
+    PriceList *prices;
+    guint i;
+
+    for (i = 0; i < LAZY_MAX_LOADED; i++)
+    {
+        gchar *mnemonic = g_strdup_printf ("FND%u", i);
+        funds[i] = gnc_commodity_new (book, mnemonic, "FUND", mnemonic, "", 100);
+        lazy_add_row (fixture, funds[i], c->usd, gnc_dmy2timespec (1, 6, 2008), 100000);
+        lazy_add_row (fixture, funds[i], c->usd, gnc_dmy2timespec (1, 6, 2012), 200000);
+        g_free (mnemonic);
+    }
+    lazy_open (fixture);
+
+    prices = gnc_pricedb_get_prices (db, c->gbp, c->usd);
+    g_assert_cmpint (g_list_length (prices), ==, 5);
+    gnc_price_list_destroy (prices);
+    old = lazy_find_row (fixture, c->gbp, gnc_dmy2timespec (21, 8, 2010));
+    g_assert (gnc_price_lookup (&old->guid, book));
+    /* Something else holding on to an old price keeps it in memory. */
+    held = gnc_price_lookup (&lazy_find_row (fixture, c->gbp,
+                                             gnc_dmy2timespec (11, 4, 2009))->guid,
+                             book);
+    gnc_price_ref (held);
+
+    /* Using as many other pairs drops the gbp's older prices, except
+     * the newest one before the window and the one held. */
+    for (i = 0; i < LAZY_MAX_LOADED; i++)
+    {
+        p = gnc_pricedb_lookup_latest_before (db, funds[i], c->usd,
+                                              gnc_dmy2timespec (1, 1, 2010));
+        g_assert (p);
+        g_assert_cmpint (price_num (p, 100000), ==, 100000);
+        gnc_price_unref (p);
+    }
+    g_assert_cmpuint (fixture->lbe->lookups, ==, LAZY_MAX_LOADED + 1);
+    g_assert (gnc_price_lookup (&old->guid, book) == NULL);
+    g_assert (gnc_price_lookup (qof_instance_get_guid (held), book) == held);
+    p = gnc_pricedb_lookup_latest_before (db, c->gbp, c->usd,
+                                          gnc_dmy2timespec (1, 2, 2013));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 158855);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, LAZY_MAX_LOADED + 1);
+
+    /* They are loaded again when needed. */
+    p = gnc_pricedb_lookup_latest_before (db, c->gbp, c->usd,
+                                          gnc_dmy2timespec (1, 1, 2011));
+    g_assert (p);
+    g_assert_cmpint (price_num (p, 100000), ==, 159037);
+    gnc_price_unref (p);
+    g_assert_cmpuint (fixture->lbe->lookups, ==, LAZY_MAX_LOADED + 2);
+    g_assert (gnc_price_lookup (&old->guid, book));
+    gnc_price_unref (held);
+}
 /* gnc_pricedb_remove_price
 gboolean
 gnc_pricedb_remove_price(GNCPriceDB *db, GNCPrice *p)// C: 2 in 2  Local: 1:0:0
@@ -744,10 +1238,22 @@ gnc_pricedb_remove_old_prices(GNCPriceDB *db,// C: 1  Local: 0:0:0
 static void test_gnc_pricedb_remove_old_prices (PriceDBFixture *fixture, gconstpointer pData)
 {
     Timespec t = gnc_dmy2timespec(1, 1, 2013);
+    Timespec latest = gnc_dmy2timespec(12, 11, 2014);
+    Timespec price_time;
+    GNCPrice *price;
     g_assert(gnc_pricedb_remove_old_prices(fixture->pricedb, t, FALSE, FALSE));
     g_assert_cmpint(gnc_pricedb_get_num_prices(fixture->pricedb), ==, 11);
     g_assert(gnc_pricedb_remove_old_prices(fixture->pricedb, t, FALSE, TRUE));
     g_assert_cmpint(gnc_pricedb_get_num_prices(fixture->pricedb), ==, 10);
+    /* Only the pruned end of each series is gone */
+    price = gnc_pricedb_lookup_latest(fixture->pricedb, fixture->com->aud,
+                                      fixture->com->usd);
+    price_time = gnc_price_get_time(price);
+    g_assert(timespec_equal(&price_time, &latest));
+    gnc_price_unref(price);
+    g_assert(gnc_pricedb_lookup_latest_before(fixture->pricedb,
+                                              fixture->com->gbp,
+                                              fixture->com->usd, t) == NULL);
 }
 /* price_list_from_hashtable
 static PriceList *
@@ -1017,11 +1523,40 @@ test_gnc_pricedb_lookup_nearest_in_time (PriceDBFixture *fixture, gconstpointer
     g_assert_cmpstr(GET_CUR_NAME(price), ==, "AUD");
     g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
 }
-// Not Used
 /* gnc_pricedb_lookup_latest_before
 GNCPrice *
 gnc_pricedb_lookup_latest_before (GNCPriceDB *db,// Local: 0:0:0
 */
+static void
+test_gnc_pricedb_lookup_latest_before (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Timespec t1 = gnc_dmy2timespec(1, 1, 2012);
+    Timespec t2 = gnc_dmy2timespec(1, 1, 2010);
+    Timespec t3 = gnc_dmy2timespec(1, 1, 2009);
+    Timespec t = gnc_dmy2timespec(20, 7, 2011);
+    Timespec price_time;
+    GNCPrice *price =
+        gnc_pricedb_lookup_latest_before(fixture->pricedb, fixture->com->usd,
+                                         fixture->com->aud, t1);
+    /* The newest price before t1 is stored in the reverse direction. */
+    price_time = gnc_price_get_time(price);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "AUD");
+    g_assert_cmpstr(GET_CUR_NAME(price), ==, "USD");
+    g_assert(timespec_equal(&price_time, &t));
+    gnc_price_unref(price);
+    price =
+        gnc_pricedb_lookup_latest_before(fixture->pricedb, fixture->com->aud,
+                                         fixture->com->usd, t2);
+    t = gnc_dmy2timespec(11, 4, 2009);
+    price_time = gnc_price_get_time(price);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
+    g_assert_cmpstr(GET_CUR_NAME(price), ==, "AUD");
+    g_assert(timespec_equal(&price_time, &t));
+    gnc_price_unref(price);
+    g_assert(gnc_pricedb_lookup_latest_before(fixture->pricedb,
+                                              fixture->com->usd,
+                                              fixture->com->aud, t3) == NULL);
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1090,6 +1625,111 @@ test_gnc_pricedb_convert_balance_latest_price (PriceDBFixture *fixture, gconstpo
     g_assert_cmpint(result.denom, ==, 100);
 
 
+}
+/* gnc_pricedb_conversion_new
+GNCPriceConversion *
+gnc_pricedb_conversion_new (GNCPriceDB *pdb,
+*/
+static void
+test_gnc_pricedb_conversion (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Timespec t = gnc_dmy2timespec(15, 8, 2011);
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    GNCPriceConversion *conv =
+        gnc_pricedb_conversion_new(fixture->pricedb, fixture->com->usd,
+                                   fixture->com->aud, NULL);
+    gnc_numeric result = gnc_price_conversion_apply(conv, from);
+    g_assert_cmpint(result.num, ==, 11478);
+    g_assert_cmpint(result.denom, ==, 100);
+    /* Applying it again must not depend on the first use */
+    result = gnc_price_conversion_apply(conv, from);
+    g_assert_cmpint(result.num, ==, 11478);
+    gnc_price_conversion_free(conv);
+    /* No direct price, so goes through the indirect prices */
+    conv = gnc_pricedb_conversion_new(fixture->pricedb, fixture->com->gbp,
+                                      fixture->com->dkk, NULL);
+    result = gnc_price_conversion_apply(conv, from);
+    g_assert_cmpint(result.num, ==, 94389);
+    g_assert_cmpint(result.denom, ==, 100);
+    gnc_price_conversion_free(conv);
+    conv = gnc_pricedb_conversion_new(fixture->pricedb, fixture->com->amzn,
+                                      fixture->com->aud, &t);
+    result = gnc_price_conversion_apply(conv, from);
+    g_assert_cmpint(result.num, ==, 2089782);
+    g_assert_cmpint(result.denom, ==, 100);
+    gnc_price_conversion_free(conv);
+}
+static void
+test_gnc_pricedb_convert_balance_routed (PriceDBFixture *fixture, gconstpointer pData)
+{
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    GNCPriceConversion *conv;
+    /* AMZN is only priced in USD and EUR only against GBP, so this
+     * takes the route AMZN -> USD -> GBP -> EUR. */
+    gnc_numeric result =
+        gnc_pricedb_convert_balance_latest_price(fixture->pricedb, from,
+                                                 fixture->com->amzn,
+                                                 fixture->com->eur);
+    g_assert_cmpint(result.num, ==, 2506101);
+    g_assert_cmpint(result.denom, ==, 100);
+    conv = gnc_pricedb_conversion_new(fixture->pricedb, fixture->com->amzn,
+                                      fixture->com->eur, NULL);
+    result = gnc_price_conversion_apply(conv, from);
+    g_assert_cmpint(result.num, ==, 2506101);
+    gnc_price_conversion_free(conv);
+    /* Nothing prices BGN */
+    result = gnc_pricedb_convert_balance_latest_price(fixture->pricedb, from,
+                                                      fixture->com->amzn,
+                                                      fixture->com->bgn);
+    g_assert(gnc_numeric_zero_p(result));
+}
+static void
+test_gnc_price_conversion_cache (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Timespec t = gnc_dmy2timespec(15, 8, 2011);
+    Timespec day = timespecCanonicalDayTime(t);
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(fixture->pricedb));
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    GNCPriceConversionCache *cache =
+        gnc_price_conversion_cache_new(fixture->pricedb);
+    gnc_numeric result =
+        gnc_price_conversion_cache_convert_latest(cache, from,
+                                                  fixture->com->usd,
+                                                  fixture->com->aud);
+    gnc_numeric expected;
+    GNCPrice *price;
+    g_assert_cmpint(result.num, ==, 11478);
+    g_assert_cmpint(result.denom, ==, 100);
+    result = gnc_price_conversion_cache_convert_latest(cache, from,
+                                                       fixture->com->gbp,
+                                                       fixture->com->dkk);
+    g_assert_cmpint(result.num, ==, 94389);
+    expected = gnc_pricedb_convert_balance_nearest_price(fixture->pricedb,
+                                                         from,
+                                                         fixture->com->amzn,
+                                                         fixture->com->aud,
+                                                         day);
+    result = gnc_price_conversion_cache_convert_nearest(cache, from,
+                                                        fixture->com->amzn,
+                                                        fixture->com->aud, t);
+    g_assert(gnc_numeric_equal(result, expected));
+    /* A new price must replace the cached conversion */
+    price = construct_price(book, fixture->com->usd, fixture->com->aud,
+                            gnc_dmy2timespec(1, 1, 2015), PRICE_SOURCE_FQ,
+                            gnc_numeric_create(2, 1));
+    gnc_pricedb_add_price(fixture->pricedb, price);
+    result = gnc_price_conversion_cache_convert_latest(cache, from,
+                                                       fixture->com->usd,
+                                                       fixture->com->aud);
+    g_assert_cmpint(result.num, ==, 20000);
+    g_assert_cmpint(result.denom, ==, 100);
+    gnc_pricedb_remove_price(fixture->pricedb, price);
+    result = gnc_price_conversion_cache_convert_latest(cache, from,
+                                                       fixture->com->usd,
+                                                       fixture->com->aud);
+    g_assert_cmpint(result.num, ==, 11478);
+    gnc_price_unref(price);
+    gnc_price_conversion_cache_free(cache);
 }
 /* gnc_pricedb_convert_balance_nearest_price
 gnc_numeric
@@ -1128,6 +1768,34 @@ test_gnc_pricedb_convert_balance_nearest_price (PriceDBFixture *fixture, gconstp
     g_assert_cmpint(result.denom, ==, 100);
 
 }
+/* gnc_pricedb_convert_collector_nearest_price
+gnc_numeric
+gnc_pricedb_convert_collector_nearest_price(GNCPriceDB *pdb,// C: 1  SCM: 1
+*/
+static void
+test_gnc_pricedb_convert_collector_nearest_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Timespec t = gnc_dmy2timespec(15, 8, 2011);
+    GncCommodityCollector *collector = gnc_commodity_collector_new ();
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    gnc_numeric result;
+
+    result = gnc_pricedb_convert_collector_nearest_price(fixture->pricedb,
+                                                         collector,
+                                                         fixture->com->aud, t);
+    g_assert(gnc_numeric_zero_p(result));
+
+    gnc_commodity_collector_add_amount (collector, fixture->com->usd, from);
+    gnc_commodity_collector_add_amount (collector, fixture->com->amzn, from);
+    gnc_commodity_collector_add_amount (collector, fixture->com->aud, from);
+    result = gnc_pricedb_convert_collector_nearest_price(fixture->pricedb,
+                                                         collector,
+                                                         fixture->com->aud, t);
+    /* 93.91 + 20897.82 + 100.00 */
+    g_assert_cmpint(result.num, ==, 2109173);
+    g_assert_cmpint(result.denom, ==, 100);
+    gnc_commodity_collector_destroy (collector);
+}
 /* pricedb_foreach_pricelist
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1172,10 +1840,49 @@ test_stable_price_traversal (Fixture *fixture, gconstpointer pData)
 gboolean
 gnc_pricedb_foreach_price(GNCPriceDB *db,// C: 2 in 2  Local: 6:0:0
 */
-/* static void
-test_gnc_pricedb_foreach_price (Fixture *fixture, gconstpointer pData)
+static gboolean
+collect_price (GNCPrice *p, gpointer data)
 {
-}*/
+    GList **list = data;
+    *list = g_list_prepend (*list, p);
+    return TRUE;
+}
+
+static void
+test_gnc_pricedb_foreach_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    GList *first = NULL, *second = NULL, *node;
+    GNCPrice *p;
+
+    g_assert (gnc_pricedb_foreach_price (db, collect_price, &first, TRUE));
+    g_assert (gnc_pricedb_foreach_price (db, collect_price, &second, TRUE));
+    g_assert_cmpint (g_list_length (first), ==,
+                     gnc_pricedb_get_num_prices (db));
+    for (node = first; node && node->next; node = node->next)
+    {
+        gnc_commodity *c1 = gnc_price_get_commodity (node->next->data);
+        gnc_commodity *c2 = gnc_price_get_commodity (node->data);
+        g_assert_cmpint (g_strcmp0 (gnc_commodity_get_unique_name (c1),
+                                    gnc_commodity_get_unique_name (c2)), <=, 0);
+    }
+    g_assert (gnc_price_list_equal (first, second));
+    g_list_free (second);
+    second = NULL;
+
+    /* A new pair must show up in the next traversal */
+    p = construct_price (book, fixture->com->eur, fixture->com->dkk,
+                         gnc_dmy2timespec (1, 1, 2014), PRICE_SOURCE_FQ,
+                         gnc_numeric_create (745, 100));
+    gnc_pricedb_add_price (db, p);
+    g_assert (gnc_pricedb_foreach_price (db, collect_price, &second, TRUE));
+    g_assert_cmpint (g_list_length (second), ==, g_list_length (first) + 1);
+    g_assert (g_list_find (second, p));
+    gnc_price_unref (p);
+    g_list_free (first);
+    g_list_free (second);
+}
 /* add_price_to_list
 static gboolean
 add_price_to_list (GNCPrice *p, gpointer data)// Local: 0:1:0
@@ -1353,8 +2060,14 @@ test_suite_gnc_pricedb (void)
 // GNC_TEST_ADD (suitename, "pricedb equal foreach currencies hash", Fixture, NULL, setup, test_pricedb_equal_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "insert or replace price", Fixture, NULL, setup, test_insert_or_replace_price, teardown);
 // GNC_TEST_ADD (suitename, "add price", Fixture, NULL, setup, test_add_price, teardown);
-// GNC_TEST_ADD (suitename, "gnc pricedb add price", Fixture, NULL, setup, test_gnc_pricedb_add_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb add price", PriceDBFixture, NULL, setup, test_gnc_pricedb_add_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb add prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_add_prices, teardown);
 // GNC_TEST_ADD (suitename, "remove price", Fixture, NULL, setup, test_remove_price, teardown);
+    GNC_TEST_ADD (suitename, "pricedb lazy load window", LazyFixture, NULL, setup_lazy, test_pricedb_lazy_load_window, teardown_lazy);
+    GNC_TEST_ADD (suitename, "pricedb lazy load pair", LazyFixture, NULL, setup_lazy, test_pricedb_lazy_load_pair, teardown_lazy);
+    GNC_TEST_ADD (suitename, "pricedb lazy load any currency", LazyFixture, NULL, setup_lazy, test_pricedb_lazy_load_any_currency, teardown_lazy);
+    GNC_TEST_ADD (suitename, "pricedb lazy load all", LazyFixture, NULL, setup_lazy, test_pricedb_lazy_load_all, teardown_lazy);
+    GNC_TEST_ADD (suitename, "pricedb lazy load evict", LazyFixture, NULL, setup_lazy, test_pricedb_lazy_load_evict, teardown_lazy);
 // GNC_TEST_ADD (suitename, "gnc pricedb remove price", Fixture, NULL, setup, test_gnc_pricedb_remove_price, teardown);
 // GNC_TEST_ADD (suitename, "check one price date", Fixture, NULL, setup, test_check_one_price_date, teardown);
 // GNC_TEST_ADD (suitename, "pricedb remove foreach pricelist", Fixture, NULL, setup, test_pricedb_remove_foreach_pricelist, teardown);
@@ -1378,18 +2091,23 @@ test_suite_gnc_pricedb (void)
     GNC_TEST_ADD (suitename, "gnc pricedb lookup day", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_day, teardown);
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup latest before", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_before, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);
 // GNC_TEST_ADD (suitename, "indirect balance conversion", Fixture, NULL, setup, test_indirect_balance_conversion, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert collector nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_collector_nearest_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb conversion", PriceDBFixture, NULL, setup, test_gnc_pricedb_conversion, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balance routed", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_routed, teardown);
+    GNC_TEST_ADD (suitename, "gnc price conversion cache", PriceDBFixture, NULL, setup, test_gnc_price_conversion_cache, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach pricelist", Fixture, NULL, setup, test_pricedb_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach currencies hash", Fixture, NULL, setup, test_pricedb_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "unstable price traversal", Fixture, NULL, setup, test_unstable_price_traversal, teardown);
 // GNC_TEST_ADD (suitename, "compare kvpairs by commodity key", Fixture, NULL, setup, test_compare_kvpairs_by_commodity_key, teardown);
 // GNC_TEST_ADD (suitename, "stable price traversal", Fixture, NULL, setup, test_stable_price_traversal, teardown);
-// GNC_TEST_ADD (suitename, "gnc pricedb foreach price", Fixture, NULL, setup, test_gnc_pricedb_foreach_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb foreach price", PriceDBFixture, NULL, setup, test_gnc_pricedb_foreach_price, teardown);
 // GNC_TEST_ADD (suitename, "add price to list", Fixture, NULL, setup, test_add_price_to_list, teardown);
 // GNC_TEST_ADD (suitename, "gnc price fixup legacy commods", Fixture, NULL, setup, test_gnc_price_fixup_legacy_commods, teardown);
 // GNC_TEST_ADD (suitename, "gnc price print", Fixture, NULL, setup, test_gnc_price_print, teardown);
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <gmodule.h>
+#include <glib/gstdio.h>
 #include <sys/types.h>
 #ifdef HAVE_DIRENT_H
 # include <dirent.h>
@@ -64,6 +65,18 @@ typedef struct
 
 static GNCModuleInfo * gnc_module_get_info(const char * lib_path);
 
+/* The module index caches what gnc_module_get_info found out about
+ * each library, so that only new or changed libraries have to be
+ * opened at startup.  It is a key file with one group per library,
+ * named by its full path. */
+#define INDEX_MTIME       "MTime"
+#define INDEX_SIZE        "Size"
+#define INDEX_MODULE      "Module"
+#define INDEX_DESCRIPTION "Description"
+#define INDEX_INTERFACE   "Interface"
+#define INDEX_AGE         "Age"
+#define INDEX_REVISION    "Revision"
+
 /*************************************************************
  * gnc_module_system_search_dirs
  * return a list of dirs to look in for gnc_module libraries
@@ -140,6 +153,136 @@ gnc_module_system_search_dirs(void)
     return list;
 }
 
+/*************************************************************
+ * gnc_module_index_filename
+ * return the file caching the module index, or NULL if there
+ * is none.  GNC_MODULE_INDEX overrides the default, and an empty
+ * GNC_MODULE_INDEX turns the cache off.
+ *************************************************************/
+
+static gchar *
+gnc_module_index_filename(void)
+{
+    const char *filename = g_getenv("GNC_MODULE_INDEX");
+
+    if (filename)
+        return *filename ? g_strdup(filename) : NULL;
+    return g_build_filename(g_get_user_cache_dir(), PACKAGE, "module-index",
+                            (char*)NULL);
+}
+
+/*************************************************************
+ * gnc_module_index_lookup
+ * return the cached info for the library if it hasn't changed
+ * since it was indexed.
+ *************************************************************/
+
+static GNCModuleInfo *
+gnc_module_index_lookup(GKeyFile *index, const char *fullpath,
+                        const GStatBuf *st)
+{
+    GNCModuleInfo *info;
+    GError *error = NULL;
+    gint64 mtime, size;
+
+    if (!g_key_file_has_group(index, fullpath))
+        return NULL;
+    mtime = g_key_file_get_int64(index, fullpath, INDEX_MTIME, NULL);
+    size = g_key_file_get_int64(index, fullpath, INDEX_SIZE, NULL);
+    if (mtime != (gint64)st->st_mtime || size != (gint64)st->st_size)
+        return NULL;
+
+    info = g_new0(GNCModuleInfo, 1);
+    info->module_path = g_key_file_get_string(index, fullpath, INDEX_MODULE,
+                                              &error);
+    if (!error)
+        info->module_description =
+            g_key_file_get_string(index, fullpath, INDEX_DESCRIPTION, &error);
+    if (!error)
+        info->module_interface =
+            g_key_file_get_integer(index, fullpath, INDEX_INTERFACE, &error);
+    if (!error)
+        info->module_age =
+            g_key_file_get_integer(index, fullpath, INDEX_AGE, &error);
+    if (!error)
+        info->module_revision =
+            g_key_file_get_integer(index, fullpath, INDEX_REVISION, &error);
+    if (error)
+    {
+        PWARN("Ignoring the index entry for '%s': %s", fullpath,
+              error->message);
+        g_error_free(error);
+        g_free(info->module_path);
+        g_free(info->module_description);
+        g_free(info);
+        return NULL;
+    }
+    info->module_filepath = g_strdup(fullpath);
+    return info;
+}
+
+static void
+gnc_module_index_store(GKeyFile *index, const GNCModuleInfo *info,
+                       const GStatBuf *st)
+{
+    const char *group = info->module_filepath;
+
+    g_key_file_remove_group(index, group, NULL);
+    g_key_file_set_int64(index, group, INDEX_MTIME, st->st_mtime);
+    g_key_file_set_int64(index, group, INDEX_SIZE, st->st_size);
+    g_key_file_set_string(index, group, INDEX_MODULE, info->module_path);
+    g_key_file_set_string(index, group, INDEX_DESCRIPTION,
+                          info->module_description ?
+                          info->module_description : "");
+    g_key_file_set_integer(index, group, INDEX_INTERFACE,
+                           info->module_interface);
+    g_key_file_set_integer(index, group, INDEX_AGE, info->module_age);
+    g_key_file_set_integer(index, group, INDEX_REVISION,
+                           info->module_revision);
+}
+
+/*************************************************************
+ * gnc_module_index_save
+ * drop the entries of libraries that are gone and write the
+ * index out.
+ *************************************************************/
+
+static void
+gnc_module_index_save(GKeyFile *index, const char *filename,
+                      GHashTable *seen, gboolean changed)
+{
+    gchar **groups, **group;
+    gchar *dirname, *data;
+    GError *error = NULL;
+    gsize length;
+
+    groups = g_key_file_get_groups(index, NULL);
+    for (group = groups; *group; group++)
+    {
+        if (!g_hash_table_lookup(seen, *group) &&
+                !g_file_test(*group, G_FILE_TEST_EXISTS))
+        {
+            g_key_file_remove_group(index, *group, NULL);
+            changed = TRUE;
+        }
+    }
+    g_strfreev(groups);
+    if (!changed)
+        return;
+
+    dirname = g_path_get_dirname(filename);
+    g_mkdir_with_parents(dirname, 0700);
+    g_free(dirname);
+    data = g_key_file_to_data(index, &length, NULL);
+    if (!g_file_set_contents(filename, data, length, &error))
+    {
+        PWARN("Unable to write the module index %s: %s", filename,
+              error->message);
+        g_error_free(error);
+    }
+    g_free(data);
+}
+
 /*************************************************************
  * gnc_module_system_init
  * initialize the module system
@@ -169,6 +312,10 @@ gnc_module_system_refresh(void)
 {
     GList * search_dirs;
     GList * current;
+    gchar * index_file;
+    GKeyFile * index;
+    GHashTable * seen;
+    gboolean index_changed = FALSE;
 
     if (!loaded_modules)
     {
@@ -178,6 +325,12 @@ gnc_module_system_refresh(void)
     /* get the GNC_MODULE_PATH and split it into directories */
     search_dirs = gnc_module_system_search_dirs();
 
+    index_file = gnc_module_index_filename();
+    index = g_key_file_new();
+    if (index_file)
+        g_key_file_load_from_file(index, index_file, G_KEY_FILE_NONE, NULL);
+    seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
     /* look in each search directory */
     for (current = search_dirs; current; current = current->next)
     {
@@ -207,20 +360,46 @@ gnc_module_system_refresh(void)
             {
                 /* get the full path name, then dlopen the library and see
                  * if it has the appropriate symbols to be a gnc_module */
+                GStatBuf st;
+
                 fullpath = g_build_filename((const gchar *)(current->data),
                                             dent, (char*)NULL);
-                info     = gnc_module_get_info(fullpath);
+                if (g_stat(fullpath, &st) != 0)
+                {
+                    g_free(fullpath);
+                    continue;
+                }
+                info = gnc_module_index_lookup(index, fullpath, &st);
+                if (!info)
+                {
+                    info = gnc_module_get_info(fullpath);
+                    if (info)
+                    {
+                        gnc_module_index_store(index, info, &st);
+                        index_changed = TRUE;
+                    }
+                    else if (g_key_file_remove_group(index, fullpath, NULL))
+                    {
+                        index_changed = TRUE;
+                    }
+                }
 
                 if (info)
                 {
                     module_info = g_list_prepend(module_info, info);
                 }
-                g_free(fullpath);
+                g_hash_table_insert(seen, fullpath, GINT_TO_POINTER(TRUE));
             }
         }
         g_dir_close(d);
 
     }
+    if (index_file)
+        gnc_module_index_save(index, index_file, seen, index_changed);
+    g_hash_table_destroy(seen);
+    g_key_file_free(index);
+    g_free(index_file);
+
     /* free the search dir strings */
     for (current = search_dirs; current; current = current->next)
     {
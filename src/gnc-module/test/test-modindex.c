@@ -0,0 +1,125 @@
+/*********************************************************************
+ * test-modindex.c
+ * test that the module index is written and that refreshing the
+ * module database uses it for unchanged libraries
+ *********************************************************************/
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <libguile.h>
+#include <unittest-support.h>
+
+#include "gnc-module.h"
+
+/* Renames gnucash/foo in the index, so that finding the new name
+ * after a refresh shows that the index was used. */
+static gboolean
+rename_foo (const char *index_file)
+{
+    GKeyFile *index = g_key_file_new ();
+    gchar **groups, **group, *data;
+    gboolean found = FALSE;
+    gsize length;
+
+    if (!g_key_file_load_from_file (index, index_file, G_KEY_FILE_NONE, NULL))
+    {
+        g_key_file_free (index);
+        return FALSE;
+    }
+    groups = g_key_file_get_groups (index, NULL);
+    for (group = groups; *group; group++)
+    {
+        gchar *module = g_key_file_get_string (index, *group, "Module", NULL);
+        if (g_strcmp0 (module, "gnucash/foo") == 0)
+        {
+            g_key_file_set_string (index, *group, "Module",
+                                   "gnucash/foo-indexed");
+            found = TRUE;
+        }
+        g_free (module);
+    }
+    g_strfreev (groups);
+    data = g_key_file_to_data (index, &length, NULL);
+    if (!g_file_set_contents (index_file, data, length, NULL))
+        found = FALSE;
+    g_free (data);
+    g_key_file_free (index);
+    return found;
+}
+
+static void
+guile_main(void *closure, int argc, char ** argv)
+{
+    GNCModule foo;
+    gchar *msg = "Module '../../../src/gnc-module/test/misc-mods/.libs/libgncmod_futuremodsys.so' requires newer module system\n";
+    gchar *logdomain = "gnc.module";
+    gchar *name, *index_file;
+    guint loglevel = G_LOG_LEVEL_WARNING;
+    TestErrorStruct check = { loglevel, logdomain, msg };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    g_test_message("  test-modindex.c: testing the module index ... ");
+
+    name = g_strdup_printf ("test-modindex-%d", (int)getpid ());
+    index_file = g_build_filename (g_get_tmp_dir (), name, NULL);
+    g_free (name);
+    g_setenv ("GNC_MODULE_INDEX", index_file, TRUE);
+
+    gnc_module_system_init();
+
+    if (!rename_foo (index_file))
+    {
+        g_test_message("  The index doesn't list gnucash/foo\n");
+        g_unlink (index_file);
+        exit(-1);
+    }
+
+    gnc_module_system_refresh();
+    foo = gnc_module_load("gnucash/foo-indexed", 0);
+    g_unlink (index_file);
+
+    if (!foo)
+    {
+        g_test_message("  Refreshing didn't use the index\n");
+        exit(-1);
+    }
+
+    if (!gnc_module_unload(foo))
+    {
+        g_test_message("  Failed to unload foo\n");
+        exit(-1);
+    }
+    g_test_message(" successful.\n");
+
+    exit(0);
+}
+
+int
+main(int argc, char ** argv)
+{
+    scm_boot_guile(argc, argv, guile_main, NULL);
+    return 0;
+}
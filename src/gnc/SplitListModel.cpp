@@ -58,9 +58,51 @@ SplitListModel::SplitListModel(const Glib::RefPtr<Account> acc, QUndoStack* undo
 void SplitListModel::recreateCache()
 {
     SplitQList newSplits = Split::from_glist(m_account->get_split_list());
-    bool doReset = (newSplits.size() != m_list.size());
-
-    m_list = newSplits;
+    const int oldSize = m_list.size();
+    const int newSize = newSplits.size();
+
+    // Find the range of rows that differs between the old and the new
+    // list, so that only those are announced to the views.
+    int prefix = 0;
+    while (prefix < oldSize && prefix < newSize
+            && m_list[prefix] == newSplits[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldSize - prefix && suffix < newSize - prefix
+            && m_list[oldSize - 1 - suffix] == newSplits[newSize - 1 - suffix])
+        ++suffix;
+    const int oldChanged = oldSize - prefix - suffix;
+    const int newChanged = newSize - prefix - suffix;
+
+    if (oldChanged == 0 && newChanged > 0)
+    {
+        beginInsertRows(QModelIndex(), prefix, prefix + newChanged - 1);
+        m_list = newSplits;
+        m_rowCache.insert(prefix, newChanged, RowCache());
+        endInsertRows();
+    }
+    else if (newChanged == 0 && oldChanged > 0)
+    {
+        beginRemoveRows(QModelIndex(), prefix, prefix + oldChanged - 1);
+        m_list = newSplits;
+        m_rowCache.remove(prefix, oldChanged);
+        endRemoveRows();
+    }
+    else if (oldChanged == newChanged)
+    {
+        m_list = newSplits;
+        for (int k = prefix; k < prefix + newChanged; ++k)
+            m_rowCache[k] = RowCache();
+        if (newChanged > 0)
+            Q_EMIT dataChanged(index(prefix, 0),
+                               index(prefix + newChanged - 1, columnCount() - 1));
+    }
+    else
+    {
+        m_list = newSplits;
+        m_rowCache.fill(RowCache(), newSize);
+        reset();
+    }
 
     // Cache the mapping of transactions to split in the m_hash
     m_hash.clear();
@@ -69,8 +111,79 @@ void SplitListModel::recreateCache()
         m_hash.insert(Glib::wrap(m_list[k])->get_parent()->gobj(), k);
     }
 
-    if (doReset)
-        reset();
+    // All rows after the first change have a different running
+    // balance now.
+    invalidateBalances(prefix);
+}
+
+const SplitListModel::RowCache& SplitListModel::cachedRow(int row) const
+{
+    RowCache& cache = m_rowCache[row];
+    if (cache.valid && cache.accountValid && cache.balanceValid)
+        return cache;
+
+    Glib::RefPtr<Split> split = Glib::wrap(m_list.at(row));
+    PrintAmountInfo printInfo(split, false);
+
+    if (!cache.valid)
+    {
+        Glib::RefPtr<Transaction> trans(split->get_parent());
+        Numeric amount = split->get_value(); // Alternatively: xaccSplitConvertAmount(split.gobj(), split.getAccount().gobj());
+
+        cache.values[COLUMN_DATE] = g2q(trans->get_date_posted());
+        cache.values[COLUMN_NUM] = g2q(trans->get_num());
+        cache.values[COLUMN_DESC] = g2q(trans->get_description());
+        cache.values[COLUMN_RECONCILE] = QString::fromUtf8(gnc_get_reconcile_str(split->get_reconcile()));
+        if (amount.positive_p())
+        {
+            cache.values[COLUMN_INCREASE] = g2q(amount.printAmount(printInfo));
+            cache.values[COLUMN_DECREASE] = QString();
+        }
+        else
+        {
+            cache.values[COLUMN_INCREASE] = QString();
+            cache.values[COLUMN_DECREASE] = g2q(amount.neg().printAmount(printInfo));
+        }
+        cache.valid = true;
+    }
+
+    if (!cache.accountValid)
+    {
+        Glib::RefPtr<Transaction> trans(split->get_parent());
+        if (trans->get_num_splits() == 2)
+            cache.values[COLUMN_ACCOUNT] = QVariant::fromValue(split->get_other_split()->get_account()->gobj());
+        else
+            cache.values[COLUMN_ACCOUNT] = g2q(split->get_corr_account_full_name());
+        cache.accountValid = true;
+    }
+
+    if (!cache.balanceValid)
+    {
+        // The engine keeps the running balance in the split itself.
+        Numeric balance = split->get_balance();
+        cache.values[COLUMN_BALANCE] = g2q(balance.printAmount(printInfo));
+        cache.balanceNegative = balance.negative_p();
+        cache.balanceValid = true;
+    }
+    return cache;
+}
+
+void SplitListModel::invalidateBalances(int firstRow)
+{
+    for (int k = firstRow; k < m_rowCache.size(); ++k)
+        m_rowCache[k].balanceValid = false;
+    if (firstRow < m_list.size())
+        Q_EMIT dataChanged(index(firstRow, COLUMN_BALANCE),
+                           index(m_list.size() - 1, COLUMN_BALANCE));
+}
+
+void SplitListModel::invalidateAccounts()
+{
+    for (int k = 0; k < m_rowCache.size(); ++k)
+        m_rowCache[k].accountValid = false;
+    if (!m_list.isEmpty())
+        Q_EMIT dataChanged(index(0, COLUMN_ACCOUNT),
+                           index(m_list.size() - 1, COLUMN_ACCOUNT));
 }
 
 void SplitListModel::recreateTmpTrans()
@@ -126,8 +239,8 @@ bool SplitListModel::removeRows(int position, int rows, const QModelIndex &index
         QUndoCommand* cmd = cmd::destroyTransaction(t);
         m_undoStack->push(cmd);
     }
-    // No beginInsertRows/endInsertRows because reset() is called in
-    // recreateCache() anyway.
+    // No beginRemoveRows/endRemoveRows because recreateCache() emits
+    // them once the engine has removed the splits.
     return true;
 }
 
@@ -271,82 +384,22 @@ QVariant SplitListModel::data(const QModelIndex& index, int role) const
         // Normal case: We are in a row that displays a normal
         // transaction and split
 
-        Glib::RefPtr<Split> split = Glib::wrap(static_cast< ::Split*>(index.internalPointer()));
-        Glib::RefPtr<Transaction> trans(split->get_parent());
-        Numeric amount = split->get_value(); // Alternatively: xaccSplitConvertAmount(split.gobj(), split.getAccount().gobj());
-        PrintAmountInfo printInfo(split, false);
+        const RowCache& cache = cachedRow(index.row());
 
         switch (index.column())
         {
         case COLUMN_DATE:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                return g2q(trans->get_date_posted());
-            default:
-                return QVariant();
-            }
         case COLUMN_NUM:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                return g2q(trans->get_num());
-            default:
-                return QVariant();
-            }
         case COLUMN_DESC:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                return g2q(trans->get_description());
-            default:
-                return QVariant();
-            }
         case COLUMN_ACCOUNT:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                if (trans->get_num_splits() == 2)
-                    return QVariant::fromValue(split->get_other_split()->get_account()->gobj());
-                else
-                    return g2q(split->get_corr_account_full_name());
-            default:
-                return QVariant();
-            }
         case COLUMN_RECONCILE:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                return QString::fromUtf8(gnc_get_reconcile_str(split->get_reconcile()));
-            default:
-                return QVariant();
-            }
         case COLUMN_INCREASE:
-            switch (role)
-            {
-            case Qt::DisplayRole:
-            case Qt::EditRole:
-                if (amount.positive_p())
-                    return g2q(amount.printAmount(printInfo));
-                else
-                    return QString();
-            default:
-                return QVariant();
-            }
         case COLUMN_DECREASE:
             switch (role)
             {
             case Qt::DisplayRole:
             case Qt::EditRole:
-                if (amount.positive_p())
-                    return QString();
-                else
-                    return g2q(amount.neg().printAmount(printInfo));
+                return cache.values[index.column()];
             default:
                 return QVariant();
             }
@@ -354,9 +407,9 @@ QVariant SplitListModel::data(const QModelIndex& index, int role) const
             switch (role)
             {
             case Qt::DisplayRole:
-                return g2q(split->get_balance().printAmount(printInfo));
+                return cache.values[COLUMN_BALANCE];
             case Qt::ForegroundRole:
-                return split->get_balance().negative_p()
+                return cache.balanceNegative
                        ? QBrush(Qt::red)
                        : QBrush();
             default:
@@ -660,7 +713,10 @@ void SplitListModel::transactionEvent( ::Transaction* trans, QofEventId event_ty
         if (m_hash.contains(trans))
         {
             int row = m_hash.value(trans);
-            Q_EMIT dataChanged(index(row, 0), index(row, columnCount() - 1));
+            m_rowCache[row].valid = false;
+            m_rowCache[row].accountValid = false;
+            Q_EMIT dataChanged(index(row, 0), index(row, COLUMN_BALANCE - 1));
+            invalidateBalances(row);
         }
         break;
     case GNC_EVENT_ITEM_REMOVED:
@@ -683,7 +739,13 @@ void SplitListModel::transactionEvent( ::Transaction* trans, QofEventId event_ty
 void SplitListModel::accountEvent( ::Account* acc, QofEventId event_type)
 {
     if (acc != m_account->gobj())
+    {
+        // Renaming any account, even a parent of the ones shown here,
+        // can change the names in the account column.
+        if (event_type == QOF_EVENT_MODIFY)
+            invalidateAccounts();
         return;
+    }
     //qDebug() << "SplitListModel::accountEvent, id=" << qofEventToString(event_type);
 
     switch (event_type)
@@ -38,6 +38,7 @@ extern "C"
 #include <QAbstractItemModel>
 #include <QAbstractItemDelegate>
 #include <QHash>
+#include <QVector>
 class QUndoStack;
 
 namespace gnc
@@ -90,12 +91,30 @@ private:
     void recreateCache();
     void recreateTmpTrans();
 
+    /** The display values of one row of an existing split. The
+     * balance is kept apart because it changes for all following
+     * rows whenever one split changes, and the account because it
+     * changes for all rows whenever any account is renamed. */
+    struct RowCache
+    {
+        RowCache() : valid(false), accountValid(false), balanceValid(false), balanceNegative(false) {}
+        QVariant values[COLUMN_LAST];
+        bool valid;
+        bool accountValid;
+        bool balanceValid;
+        bool balanceNegative;
+    };
+    const RowCache& cachedRow(int row) const;
+    void invalidateBalances(int firstRow);
+    void invalidateAccounts();
+
 protected:
     Glib::RefPtr<Account> m_account;
     SplitQList m_list;
     QUndoStack* m_undoStack;
     typedef QHash< ::Transaction*, int> TransactionRowHash;
     TransactionRowHash m_hash;
+    mutable QVector<RowCache> m_rowCache;
 
     /** The wrapper for receiving events from gnc. */
     QofEventWrapper<SplitListModel, ::Transaction*> m_eventWrapper;
@@ -116,6 +116,7 @@ struct _GNCSearchWindow
     /* Our query status */
     QofQuery                 *q;
     QofQuery                 *start_q;      /* The query to start from, if any */
+    gboolean                  parallel;     /* sw->q may be run on several threads */
 
     /* The list of criteria */
     GNCSearchParam           *last_param;
@@ -459,6 +460,33 @@ create_query_fragment (QofIdTypeConst search_for, GNCSearchParam *param, QofQuer
     return q;
 }
 
+/* The split memo and transaction description getters only read the
+ * objects, so queries on them alone may be scanned in parallel. */
+static gboolean
+search_param_parallel_safe (GNCSearchParam *param)
+{
+    GList *plist;
+
+    if (gnc_search_param_get_kind (param) == SEARCH_PARAM_ELEM)
+    {
+        GSList *path = gnc_search_param_get_param_path (GNC_SEARCH_PARAM_SIMPLE (param));
+
+        if (!path)
+            return FALSE;
+        if (!g_strcmp0 (path->data, SPLIT_MEMO))
+            return path->next == NULL;
+        return (!g_strcmp0 (path->data, SPLIT_TRANS) && path->next &&
+                !g_strcmp0 (path->next->data, TRANS_DESCRIPTION) &&
+                path->next->next == NULL);
+    }
+
+    plist = gnc_search_param_get_search (GNC_SEARCH_PARAM_COMPOUND (param));
+    for ( ; plist; plist = plist->next)
+        if (!search_param_parallel_safe (plist->data))
+            return FALSE;
+    return TRUE;
+}
+
 static void
 search_update_query (GNCSearchWindow *sw)
 {
@@ -466,6 +494,7 @@ search_update_query (GNCSearchWindow *sw)
     QofQuery *q, *q2, *new_q;
     GList *node;
     QofQueryOp op;
+    gboolean parallel;
 
     if (sw->grouping == GNC_SEARCH_MATCH_ANY)
         op = QOF_QUERY_OR;
@@ -490,12 +519,21 @@ search_update_query (GNCSearchWindow *sw)
     /* Now create a new query to work from */
     q = qof_query_create_for (sw->search_for);
 
+    /* Split searches on the memo or description alone may be run on
+     * several threads; narrowing or extending an earlier search is only
+     * safe if that search was too. */
+    parallel = (!g_strcmp0 (sw->search_for, GNC_ID_SPLIT) && sw->crit_list &&
+                (sw->search_type == 0 || sw->parallel));
+
     /* Walk the list of criteria */
     for (node = sw->crit_list; node; node = node->next)
     {
         struct _crit_data *data = node->data;
         QofQueryPredData* pdata;
 
+        if (!search_param_parallel_safe (GNC_SEARCH_PARAM (data->param)))
+            parallel = FALSE;
+
         pdata = gnc_search_core_type_get_predicate (data->element);
         if (pdata)
         {
@@ -541,12 +579,15 @@ search_update_query (GNCSearchWindow *sw)
         active_params = NULL;
     }
 
+    qof_query_set_parallel (new_q, parallel);
+
     /* Destroy the old query */
     if (sw->q)
         qof_query_destroy (sw->q);
 
     /* And save the new one */
     sw->q = new_q;
+    sw->parallel = parallel;
 }
 
 
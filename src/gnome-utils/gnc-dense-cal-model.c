@@ -142,3 +142,29 @@ gnc_dense_cal_model_get_instance(GncDenseCalModel *model, guint tag, gint instan
 {
     (*GNC_DENSE_CAL_MODEL_GET_INTERFACE(model)->get_instance)(model, tag, instance_index, date);
 }
+
+GArray*
+gnc_dense_cal_model_get_instances_in_range(GncDenseCalModel *model, guint tag, const GDate *start, const GDate *end)
+{
+    GncDenseCalModelIface *iface = GNC_DENSE_CAL_MODEL_GET_INTERFACE(model);
+    GArray *dates;
+    gint num_instances, idx;
+
+    if (iface->get_instances_in_range != NULL)
+        return (*iface->get_instances_in_range)(model, tag, start, end);
+
+    dates = g_array_new(FALSE, FALSE, sizeof(GDate));
+    num_instances = gnc_dense_cal_model_get_instance_count(model, tag);
+    for (idx = 0; idx < num_instances; idx++)
+    {
+        GDate date;
+        g_date_clear(&date, 1);
+        gnc_dense_cal_model_get_instance(model, tag, idx, &date);
+        if (!g_date_valid(&date) || g_date_compare(&date, start) < 0)
+            continue;
+        if (g_date_compare(&date, end) > 0)
+            break;
+        g_array_append_val(dates, date);
+    }
+    return dates;
+}
@@ -50,6 +50,8 @@ typedef struct _GncDenseCalModelIface
     gchar* (*get_info)(GncDenseCalModel *model, guint tag);
     gint (*get_instance_count)(GncDenseCalModel *model, guint tag);
     void (*get_instance)(GncDenseCalModel *model, guint tag, gint instance_index, GDate *date);
+    /* optional; falls back to get_instance_count and get_instance. */
+    GArray* (*get_instances_in_range)(GncDenseCalModel *model, guint tag, const GDate *start, const GDate *end);
 } GncDenseCalModelIface;
 
 GType gnc_dense_cal_model_get_type(void);
@@ -60,6 +62,9 @@ gchar* gnc_dense_cal_model_get_name(GncDenseCalModel *model, guint tag);
 gchar* gnc_dense_cal_model_get_info(GncDenseCalModel *model, guint tag);
 gint gnc_dense_cal_model_get_instance_count(GncDenseCalModel *model, guint tag);
 void gnc_dense_cal_model_get_instance(GncDenseCalModel *model, guint tag, gint instance_index, GDate *date);
+/** @return Caller-owned GArray of the GDates of the tag's instances
+ * falling in [start, end], in date order. **/
+GArray* gnc_dense_cal_model_get_instances_in_range(GncDenseCalModel *model, guint tag, const GDate *start, const GDate *end);
 
 G_END_DECLS
 
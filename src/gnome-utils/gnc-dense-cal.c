@@ -140,10 +140,10 @@ static void month_coords(GncDenseCal *dcal, int monthOfCal, GList **outList);
 static void doc_coords(GncDenseCal *dcal, int dayOfCal,
                        int *x1, int *y1, int *x2, int *y2);
 
-static void gdc_mark_add(GncDenseCal *dcal, guint tag, gchar *name, gchar *info, guint size, GDate **dateArray);
+static void gdc_mark_add(GncDenseCal *dcal, guint tag, gchar *name, gchar *info, GArray *dates, gboolean redraw);
 static void gdc_mark_remove(GncDenseCal *dcal, guint mark_to_remove, gboolean redraw);
 
-static void gdc_add_tag_markings(GncDenseCal *cal, guint tag);
+static void gdc_add_tag_markings(GncDenseCal *cal, guint tag, gboolean redraw);
 static void gdc_add_markings(GncDenseCal *cal);
 static void gdc_remove_markings(GncDenseCal *cal);
 
@@ -1712,12 +1712,12 @@ gdc_get_doc_offset(GncDenseCal *dcal, GDate *d)
 }
 
 static void
-gdc_add_tag_markings(GncDenseCal *cal, guint tag)
+gdc_add_tag_markings(GncDenseCal *cal, guint tag, gboolean redraw)
 {
     gchar *name, *info;
-    gint num_marks, idx;
-    GDate **dates;
-    GDate *calDate;
+    gint num_marks;
+    GArray *dates;
+    GDate first, calDate, calEnd;
 
     // copy the values into the old marking function.
     name = gnc_dense_cal_model_get_name(cal->model, tag);
@@ -1727,35 +1727,31 @@ gdc_add_tag_markings(GncDenseCal *cal, guint tag)
     if (num_marks == 0)
         goto cleanup;
 
-    dates = g_new0(GDate*, num_marks);
-    calDate = g_date_new_dmy(1, cal->month, cal->year);
-
-    for (idx = 0; idx < num_marks; idx++)
-    {
-        dates[idx] = g_date_new();
-        gnc_dense_cal_model_get_instance(cal->model, tag, idx, dates[idx]);
-
-    }
-    if (g_date_valid(dates[0]))
+    g_date_clear(&first, 1);
+    gnc_dense_cal_model_get_instance(cal->model, tag, 0, &first);
+    g_date_clear(&calDate, 1);
+    g_date_set_dmy(&calDate, 1, cal->month, cal->year);
+    if (g_date_valid(&first))
     {
-	 if (g_date_get_julian(dates[0]) < g_date_get_julian(calDate))
+	 if (g_date_get_julian(&first) < g_date_get_julian(&calDate))
 	 {
-	      _gnc_dense_cal_set_month(cal, g_date_get_month(dates[0]), FALSE);
-	      _gnc_dense_cal_set_year(cal, g_date_get_year(dates[0]), FALSE);
+	      _gnc_dense_cal_set_month(cal, g_date_get_month(&first), FALSE);
+	      _gnc_dense_cal_set_year(cal, g_date_get_year(&first), FALSE);
+	      g_date_set_dmy(&calDate, 1, cal->month, cal->year);
 	 }
     }
     else
     {
 	 g_warning("Bad date, skipped.");
     }
-    gdc_mark_add(cal, tag, name, info, num_marks, dates);
 
-    for (idx = 0; idx < num_marks; idx++)
-    {
-        g_date_free(dates[idx]);
-    }
-    g_free(dates);
-    g_date_free(calDate);
+    /* Only the instances in the visible months can be marked. */
+    calEnd = calDate;
+    g_date_add_months(&calEnd, cal->numMonths);
+    g_date_subtract_days(&calEnd, 1);
+    dates = gnc_dense_cal_model_get_instances_in_range(cal->model, tag, &calDate, &calEnd);
+    gdc_mark_add(cal, tag, name, info, dates, redraw);
+    g_array_free(dates, TRUE);
 
 cleanup:
     g_free(info);
@@ -1769,9 +1765,12 @@ gdc_add_markings(GncDenseCal *cal)
     for (; tags != NULL; tags = tags->next)
     {
         guint tag = GPOINTER_TO_UINT(tags->data);
-        gdc_add_tag_markings(cal, tag);
+        gdc_add_tag_markings(cal, tag, FALSE);
     }
     g_list_free(tags);
+    /* Draw once for all tags rather than once per tag. */
+    gnc_dense_cal_draw_to_buffer(cal);
+    gtk_widget_queue_draw(GTK_WIDGET(cal->cal_drawing_area));
 }
 
 static void
@@ -1792,7 +1791,7 @@ gdc_model_added_cb(GncDenseCalModel *model, guint added_tag, gpointer user_data)
 {
     GncDenseCal *cal = GNC_DENSE_CAL(user_data);
     g_debug("gdc_model_added_cb update\n");
-    gdc_add_tag_markings(cal, added_tag);
+    gdc_add_tag_markings(cal, added_tag, TRUE);
 }
 
 static void
@@ -1801,7 +1800,7 @@ gdc_model_update_cb(GncDenseCalModel *model, guint update_tag, gpointer user_dat
     GncDenseCal *cal = GNC_DENSE_CAL(user_data);
     g_debug("gdc_model_update_cb update for tag [%d]\n", update_tag);
     gdc_mark_remove(cal, update_tag, FALSE);
-    gdc_add_tag_markings(cal, update_tag);
+    gdc_add_tag_markings(cal, update_tag, TRUE);
 
 }
 
@@ -1832,27 +1831,21 @@ gnc_dense_cal_set_model(GncDenseCal *cal, GncDenseCalModel *model)
 }
 
 /**
- * Marks the given array of GDate*s on the calendar with the given name.
+ * Marks the given array of GDates on the calendar with the given name.
  **/
 static void
 gdc_mark_add(GncDenseCal *dcal,
              guint tag,
              gchar *name,
              gchar *info,
-             guint size,
-             GDate **dateArray)
+             GArray *dates,
+             gboolean redraw)
 {
     guint i;
     gint doc;
     gdc_mark_data *newMark;
     GDate *d;
 
-    if (size == 0)
-    {
-        g_error("0 size not allowed\n");
-        return;
-    }
-
     newMark = g_new0(gdc_mark_data, 1);
     newMark->name = NULL;
     if (name)
@@ -1864,9 +1857,9 @@ gdc_mark_add(GncDenseCal *dcal,
     newMark->ourMarks = NULL;
     g_debug("saving mark with tag [%d]\n", newMark->tag);
 
-    for (i = 0; i < size; i++)
+    for (i = 0; i < dates->len; i++)
     {
-        d = dateArray[i];
+        d = &g_array_index(dates, GDate, i);
         doc = gdc_get_doc_offset(dcal, d);
         if (doc < 0)
             continue;
@@ -1881,8 +1874,11 @@ gdc_mark_add(GncDenseCal *dcal,
                                           GINT_TO_POINTER(doc));
     }
     dcal->markData = g_list_append(dcal->markData, (gpointer)newMark);
-    gnc_dense_cal_draw_to_buffer(dcal);
-    gtk_widget_queue_draw(GTK_WIDGET(dcal->cal_drawing_area));
+    if (redraw)
+    {
+        gnc_dense_cal_draw_to_buffer(dcal);
+        gtk_widget_queue_draw(GTK_WIDGET(dcal->cal_drawing_area));
+    }
 }
 
 static void
@@ -165,6 +165,7 @@ static void gnc_main_window_cmd_window_raise (GtkAction *action, GtkRadioAction
 static void gnc_main_window_cmd_help_tutorial (GtkAction *action, GncMainWindow *window);
 static void gnc_main_window_cmd_help_contents (GtkAction *action, GncMainWindow *window);
 static void gnc_main_window_cmd_help_about (GtkAction *action, GncMainWindow *window);
+static void gnc_main_window_cmd_help_profile (GtkAction *action, GncMainWindow *window);
 
 static void do_popup_menu(GncPluginPage *page, GdkEventButton *event);
 static gboolean gnc_main_window_popup_menu_cb (GtkWidget *widget, GncPluginPage *page);
@@ -382,6 +383,11 @@ static GtkActionEntry gnc_menu_actions [] =
         N_("About GnuCash"),
         G_CALLBACK (gnc_main_window_cmd_help_about)
     },
+    {
+        "HelpProfileAction", NULL, N_("Performance _Trace"), NULL,
+        N_("Start recording where GnuCash spends its time, or save what was recorded"),
+        G_CALLBACK (gnc_main_window_cmd_help_profile)
+    },
 };
 /** The number of actions provided by the main window. */
 static guint gnc_menu_n_actions = G_N_ELEMENTS (gnc_menu_actions);
@@ -4354,6 +4360,44 @@ url_signal_cb (GtkAboutDialog *dialog, gchar *uri, gpointer data)
     return TRUE;
 }
 
+/** Start recording a performance trace or, if one is being recorded,
+ *  save it to a file that can be sent along with a bug report.
+ *
+ *  @param action The GtkAction for the "trace" menu item.
+ *
+ *  @param window The main window whose menu item was activated.
+ */
+static void
+gnc_main_window_cmd_help_profile (GtkAction *action, GncMainWindow *window)
+{
+    GError *error = NULL;
+    char *filename;
+
+    if (!QOF_PROFILE_IS_ACTIVE ())
+    {
+        qof_profile_set_active (TRUE);
+        gnc_info_dialog (GTK_WIDGET (window), "%s",
+                         _("Recording has started. Do whatever is slow, then "
+                           "choose Performance Trace again to save the trace."));
+        return;
+    }
+
+    filename = gnc_file_dialog (_("Save Performance Trace"), NULL, NULL,
+                                GNC_FILE_DIALOG_SAVE);
+    if (!filename)
+        return;
+    if (!qof_profile_dump (filename, &error))
+    {
+        gnc_error_dialog (GTK_WIDGET (window),
+                          _("Unable to save the trace to %s: %s"),
+                          filename, error->message);
+        g_error_free (error);
+    }
+    else
+        qof_profile_set_active (FALSE);
+    g_free (filename);
+}
+
 /** Create and display the "about" dialog for gnucash.
  *
  *  @param action The GtkAction for the "about" menu item.
@@ -46,6 +46,7 @@ static gchar* gsidca_get_name(GncDenseCalModel *model, guint tag);
 static gchar* gsidca_get_info(GncDenseCalModel *model, guint tag);
 static gint gsidca_get_instance_count(GncDenseCalModel *model, guint tag);
 static void gsidca_get_instance(GncDenseCalModel *model, guint tag, gint instance_index, GDate *date);
+static GArray* gsidca_get_instances_in_range(GncDenseCalModel *model, guint tag, const GDate *start, const GDate *end);
 
 static GObjectClass *parent_class = NULL;
 
@@ -88,6 +89,7 @@ gnc_sx_instance_dense_cal_adapter_interface_init(gpointer g_iface, gpointer ifac
     iface->get_info = gsidca_get_info;
     iface->get_instance_count = gsidca_get_instance_count;
     iface->get_instance = gsidca_get_instance;
+    iface->get_instances_in_range = gsidca_get_instances_in_range;
 }
 
 static void
@@ -253,6 +255,31 @@ gsidca_get_instance(GncDenseCalModel *model, guint tag, gint instance_index, GDa
     g_date_valid(date);
 }
 
+static GArray*
+gsidca_get_instances_in_range(GncDenseCalModel *model, guint tag, const GDate *start, const GDate *end)
+{
+    GncSxInstanceDenseCalAdapter *adapter = GNC_SX_INSTANCE_DENSE_CAL_ADAPTER(model);
+    GArray *dates = g_array_new(FALSE, FALSE, sizeof(GDate));
+    GList *found, *iter;
+
+    found = g_list_find_custom(adapter->instances->sx_instance_list, GUINT_TO_POINTER(tag), gsidca_find_sx_with_tag);
+    if (found == NULL)
+        return dates;
+
+    /* The instance list is in date order; walk it once instead of
+     * looking up every index. */
+    for (iter = ((GncSxInstances*)found->data)->instance_list; iter != NULL; iter = iter->next)
+    {
+        GncSxInstance *inst = (GncSxInstance*)iter->data;
+        if (g_date_compare(&inst->date, start) < 0)
+            continue;
+        if (g_date_compare(&inst->date, end) > 0)
+            break;
+        g_array_append_val(dates, inst->date);
+    }
+    return dates;
+}
+
 static void
 gnc_sx_instance_dense_cal_adapter_dispose(GObject *obj)
 {
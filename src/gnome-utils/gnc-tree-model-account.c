@@ -32,12 +32,14 @@
 #include "gnc-tree-model-account.h"
 #include "gnc-component-manager.h"
 #include "Account.h"
+#include "Transaction.h"
 #include "gnc-accounting-period.h"
 #include "gnc-commodity.h"
 #include "gnc-prefs.h"
 #include "gnc-engine.h"
 #include "gnc-event.h"
 #include "gnc-gobject-utils.h"
+#include "gnc-pricedb.h"
 #include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 
@@ -97,8 +99,22 @@ typedef struct GncTreeModelAccountPrivate
     Account *root;
     gint event_handler_id;
     const gchar *negative_color;
+
+    /** Formatted balance strings already computed for each account,
+     *  keyed by account.  Entries are dropped when the engine reports a
+     *  change to the account, and the whole table is emptied when the
+     *  day rolls over or a preference affecting the display changes. */
+    GHashTable *balance_cache;
+    time64 balance_cache_expires;
 } GncTreeModelAccountPrivate;
 
+/** One formatted balance held in the balance cache. */
+typedef struct
+{
+    gchar *string;
+    gboolean negative;
+} GncTreeModelAccountBalance;
+
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
    (G_TYPE_INSTANCE_GET_PRIVATE ((o), GNC_TYPE_TREE_MODEL_ACCOUNT, GncTreeModelAccountPrivate))
 
@@ -126,6 +142,58 @@ gnc_tree_model_account_update_color (gpointer gsettings, gchar *key, gpointer us
     use_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED);
     priv->negative_color = use_red ? "red" : NULL;
 }
+
+static void
+gnc_tree_model_account_balances_free (gpointer data)
+{
+    GncTreeModelAccountBalance *balances = data;
+    gint i;
+
+    for (i = 0; i < GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; i++)
+        g_free (balances[i].string);
+    g_free (balances);
+}
+
+/** Forget every cached balance.  Used when something that affects
+ *  all accounts changes, e.g. a price or a display preference.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
+{
+    GncTreeModelAccountPrivate *priv;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    if (priv->balance_cache)
+        g_hash_table_remove_all (priv->balance_cache);
+    priv->balance_cache_expires = gnc_time64_get_today_end ();
+}
+
+/** Forget the cached balances of an account and of all its
+ *  ancestors, since their subtree totals include this account.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_invalidate (GncTreeModelAccount *model,
+                                   Account *account)
+{
+    GncTreeModelAccountPrivate *priv;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    for ( ; account; account = gnc_account_get_parent (account))
+        g_hash_table_remove (priv->balance_cache, account);
+}
+
+static void
+gnc_tree_model_account_prefs_changed (gpointer prefs, gchar *pref,
+                                      gpointer user_data)
+{
+    g_return_if_fail(GNC_IS_TREE_MODEL_ACCOUNT(user_data));
+    gnc_tree_model_account_clear_cache (GNC_TREE_MODEL_ACCOUNT(user_data));
+}
+
 /************************************************************/
 /*               g_object required functions                */
 /************************************************************/
@@ -206,10 +274,21 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     priv->book = NULL;
     priv->root = NULL;
     priv->negative_color = red ? "red" : NULL;
+    priv->balance_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                          NULL, gnc_tree_model_account_balances_free);
+    priv->balance_cache_expires = gnc_time64_get_today_end ();
 
     gnc_prefs_register_cb(GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                           gnc_tree_model_account_update_color,
                           model);
+    /* Amount formatting, report currency and the accounting period
+     * all live in these groups. */
+    gnc_prefs_register_cb(GNC_PREFS_GROUP_GENERAL, NULL,
+                          gnc_tree_model_account_prefs_changed, model);
+    gnc_prefs_register_cb(GNC_PREFS_GROUP_GENERAL_REPORT, NULL,
+                          gnc_tree_model_account_prefs_changed, model);
+    gnc_prefs_register_cb(GNC_PREFS_GROUP_ACCT_SUMMARY, NULL,
+                          gnc_tree_model_account_prefs_changed, model);
 
     LEAVE(" ");
 }
@@ -229,6 +308,11 @@ gnc_tree_model_account_finalize (GObject *object)
     priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
 
     priv->book = NULL;
+    if (priv->balance_cache)
+    {
+        g_hash_table_destroy (priv->balance_cache);
+        priv->balance_cache = NULL;
+    }
 
     if (G_OBJECT_CLASS (parent_class)->finalize)
         G_OBJECT_CLASS(parent_class)->finalize (object);
@@ -258,6 +342,12 @@ gnc_tree_model_account_dispose (GObject *object)
     gnc_prefs_remove_cb_by_func(GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                 gnc_tree_model_account_update_color,
                                 model);
+    gnc_prefs_remove_cb_by_func(GNC_PREFS_GROUP_GENERAL, NULL,
+                                gnc_tree_model_account_prefs_changed, model);
+    gnc_prefs_remove_cb_by_func(GNC_PREFS_GROUP_GENERAL_REPORT, NULL,
+                                gnc_tree_model_account_prefs_changed, model);
+    gnc_prefs_remove_cb_by_func(GNC_PREFS_GROUP_ACCT_SUMMARY, NULL,
+                                gnc_tree_model_account_prefs_changed, model);
 
     if (G_OBJECT_CLASS (parent_class)->dispose)
         G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -598,6 +688,107 @@ gnc_tree_model_account_compute_period_balance(GncTreeModelAccount *model,
     return g_strdup(xaccPrintAmount(b3, gnc_account_print_info(acct, TRUE)));
 }
 
+/** Return the formatted balance shown in a balance column of an
+ *  account, computing it only if it is not already in the cache.  The
+ *  returned string belongs to the cache.
+ *
+ *  @internal
+ */
+static const gchar *
+gnc_tree_model_account_get_balance (GncTreeModelAccount *model,
+                                    Account *account,
+                                    gint column,
+                                    gboolean *negative)
+{
+    GncTreeModelAccountPrivate *priv;
+    GncTreeModelAccountBalance *balances, *balance;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    /* Present and period balances depend on today's date. */
+    if (gnc_time (NULL) > priv->balance_cache_expires)
+        gnc_tree_model_account_clear_cache (model);
+
+    balances = g_hash_table_lookup (priv->balance_cache, account);
+    if (!balances)
+    {
+        balances = g_new0 (GncTreeModelAccountBalance,
+                           GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS);
+        g_hash_table_insert (priv->balance_cache, account, balances);
+    }
+    balance = &balances[column];
+    if (balance->string)
+    {
+        *negative = balance->negative;
+        return balance->string;
+    }
+
+    switch (column)
+    {
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetPresentBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetPresentBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
+                          account, FALSE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
+                          account, FALSE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
+        balance->string = gnc_tree_model_account_compute_period_balance(model,
+                          account, FALSE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetClearedBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetClearedBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetReconciledBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetReconciledBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
+        balance->string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
+        balance->string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
+                          account, TRUE, &balance->negative);
+        break;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
+        balance->string = gnc_tree_model_account_compute_period_balance(model,
+                          account, TRUE, &balance->negative);
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    *negative = balance->negative;
+    return balance->string;
+}
+
 static void
 gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
                                   GtkTreeIter *iter,
@@ -608,7 +799,6 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
     GncTreeModelAccountPrivate *priv;
     Account *account;
     gboolean negative; /* used to set "deficit style" also known as red numbers */
-    gchar *string;
     time64 last_date;
 
     g_return_if_fail (GNC_IS_TREE_MODEL_ACCOUNT (model));
@@ -652,86 +842,84 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_PRESENT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_PRESENT, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_BALANCE, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_BALANCE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, FALSE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, FALSE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_CLEARED, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_CLEARED, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_DATE:
         g_value_init (value, G_TYPE_STRING);
@@ -743,61 +931,59 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_TOTAL, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_TOTAL, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, TRUE, &negative);
-        g_value_take_string (value, string);
+        g_value_set_string (value,
+            gnc_tree_model_account_get_balance (model, account,
+                    GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD, &negative));
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_ACCOUNT:
@@ -1260,6 +1446,46 @@ propagate_change(GtkTreeModel *model, GtkTreePath *path, gint toggle_if_num)
     }
 }
 
+/** Drop the cached balances that an engine event may have changed.
+ *  Account, split and transaction events invalidate the accounts
+ *  involved and their ancestors; a price change, or the price database
+ *  event announcing a bulk update, can alter any balance shown in
+ *  another currency so it empties the whole cache.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_invalidate_cached (GncTreeModelAccount *model,
+        QofInstance *entity,
+        QofEventId event_type,
+        GncEventData *ed)
+{
+    GList *node;
+
+    if (GNC_IS_ACCOUNT(entity))
+    {
+        gnc_tree_model_account_invalidate (model, GNC_ACCOUNT(entity));
+        if (event_type == QOF_EVENT_REMOVE && ed && ed->node)
+            gnc_tree_model_account_invalidate (model, GNC_ACCOUNT(ed->node));
+    }
+    else if (GNC_IS_SPLIT(entity))
+    {
+        gnc_tree_model_account_invalidate (model,
+                                           xaccSplitGetAccount (GNC_SPLIT(entity)));
+    }
+    else if (GNC_IS_TRANS(entity))
+    {
+        for (node = xaccTransGetSplitList (GNC_TRANS(entity)); node;
+                node = g_list_next (node))
+            gnc_tree_model_account_invalidate (model,
+                                               xaccSplitGetAccount (node->data));
+    }
+    else if (GNC_IS_PRICE(entity) || GNC_IS_PRICEDB(entity))
+    {
+        gnc_tree_model_account_clear_cache (model);
+    }
+}
+
 /** This function is the handler for all event messages from the
  *  engine.  Its purpose is to update the account tree model any time
  *  an account is added to the engine or deleted from the engine.
@@ -1301,6 +1527,7 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
     Account *account, *parent;
 
     g_return_if_fail(model);	/* Required */
+    gnc_tree_model_account_invalidate_cached (model, entity, event_type, ed);
     if (!GNC_IS_ACCOUNT(entity))
         return;
 
@@ -552,8 +552,10 @@ gtm_sr_remove_all_rows (GncTreeModelSplitReg *model)
     g_list_free (rr_list);
 }
 
+/* Copy up to num_of_rows transactions of the full_tlist, starting at
+ * tlist_start, into the tlist. */
 static void
-gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update, gint num_of_rows)
+gtm_sr_copy_view (GncTreeModelSplitReg *model, gint num_of_rows)
 {
     GncTreeModelSplitRegPrivate *priv;
     GList *node;
@@ -561,52 +563,42 @@ gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_u
 
     priv = model->priv;
 
-    if (model_update == VIEW_HOME)
+    for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
     {
-        priv->tlist_start = 0;
+        Transaction *trans = node->data;
 
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
-        {
-            Transaction *trans = node->data;
+        priv->tlist = g_list_prepend (priv->tlist, trans);
+        rows++;
 
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
-
-            if (rows == num_of_rows)
-                break;
-        } 
+        if (rows == num_of_rows)
+            break;
     }
-    
-    if (model_update == VIEW_END)
-    {
-        priv->tlist_start = g_list_length (priv->full_tlist) - num_of_rows;
+    priv->tlist = g_list_reverse (priv->tlist);
+}
 
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
-        {
-            Transaction *trans = node->data;
+static void
+gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update, gint num_of_rows)
+{
+    GncTreeModelSplitRegPrivate *priv;
 
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
+    priv = model->priv;
 
-            if (rows == num_of_rows)
-                break;
-        } 
+    if (model_update == VIEW_HOME)
+    {
+        priv->tlist_start = 0;
+        gtm_sr_copy_view (model, num_of_rows);
+    }
+
+    if (model_update == VIEW_END)
+    {
+        priv->tlist_start = model->number_of_trans_in_full_tlist - num_of_rows;
+        gtm_sr_copy_view (model, num_of_rows);
     }
 
     if (model_update == VIEW_GOTO)
     {
         priv->tlist_start = num_of_rows - NUM_OF_TRANS*1.5;
-
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
-        {
-            Transaction *trans = node->data;
-
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
-
-            if (rows == (NUM_OF_TRANS*3))
-                break;
-        } 
+        gtm_sr_copy_view (model, NUM_OF_TRANS*3);
     }
 }
 
@@ -625,38 +617,29 @@ gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Accoun
 
     /* Clear the treeview */
     gtm_sr_remove_all_rows (model);
+    g_list_free (priv->full_tlist);
     priv->full_tlist = NULL;
+    g_list_free (priv->tlist);
     priv->tlist = NULL;
 
     if (model->current_trans == NULL)
         model->current_trans = priv->btrans;
 
-    if (model->sort_direction == GTK_SORT_ASCENDING)
-    {
-        /* Get a list of Unique Transactions from an slist */
-        priv->full_tlist = xaccSplitListGetUniqueTransactions (slist);
-
-        /* Add the blank transaction to the full_tlist */
-        priv->full_tlist = g_list_append (priv->full_tlist, priv->btrans);
-    }
-    else
-    {
-        /* Get a list of Unique Transactions from an slist */
-        priv->full_tlist = xaccSplitListGetUniqueTransactions (slist);
-
-        /* Add the blank transaction to the full_tlist */
-        priv->full_tlist = g_list_append (priv->full_tlist, priv->btrans);
+    /* Get a list of Unique Transactions from an slist, with the blank
+     * transaction at the end. It is built in reverse so the blank
+     * transaction can be added without walking the list. */
+    priv->full_tlist = g_list_reverse (xaccSplitListGetUniqueTransactions (slist));
+    priv->full_tlist = g_list_prepend (priv->full_tlist, priv->btrans);
 
-        /* Reverse the full_tlist */
+    if (model->sort_direction == GTK_SORT_ASCENDING)
         priv->full_tlist = g_list_reverse (priv->full_tlist);
-    }
 
     // Update the scrollbar
     gnc_tree_model_split_reg_sync_scrollbar (model);
 
     model->number_of_trans_in_full_tlist = g_list_length (priv->full_tlist);
 
-    if (g_list_length (priv->full_tlist) < NUM_OF_TRANS*3)
+    if (model->number_of_trans_in_full_tlist < NUM_OF_TRANS*3)
     {
         // Copy the full_tlist to tlist
         priv->tlist = g_list_copy (priv->full_tlist);
@@ -665,14 +648,14 @@ gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Accoun
     {
         if (model->position_of_trans_in_full_tlist < (NUM_OF_TRANS*3))
             gtm_sr_reg_load (model, VIEW_HOME, NUM_OF_TRANS*3);
-        else if (model->position_of_trans_in_full_tlist > g_list_length (priv->full_tlist) - (NUM_OF_TRANS*3))
+        else if (model->position_of_trans_in_full_tlist > model->number_of_trans_in_full_tlist - (NUM_OF_TRANS*3))
             gtm_sr_reg_load (model, VIEW_END, NUM_OF_TRANS*3);
         else
             gtm_sr_reg_load (model, VIEW_GOTO, model->position_of_trans_in_full_tlist);
     }
 
     PINFO("#### Register for Account '%s' has %d transactions and %d splits and tlist is %d ####",
-          default_account ? xaccAccountGetName (default_account) : "NULL", g_list_length (priv->full_tlist), g_list_length (slist), g_list_length (priv->tlist));
+          default_account ? xaccAccountGetName (default_account) : "NULL", model->number_of_trans_in_full_tlist, g_list_length (slist), g_list_length (priv->tlist));
 
     /* Update the completion model liststores */
     g_idle_add ((GSourceFunc) gnc_tree_model_split_reg_update_completion, model);
@@ -696,7 +679,7 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
     priv = model->priv;
 
     // if list is not long enougth, return
-    if (g_list_length (priv->full_tlist) < NUM_OF_TRANS*3)
+    if (model->number_of_trans_in_full_tlist < NUM_OF_TRANS*3)
         return;
 
     if ((model_update == VIEW_UP) && (model->current_row < NUM_OF_TRANS) && (priv->tlist_start > 0))
@@ -744,7 +727,7 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
         g_signal_emit_by_name (model, "refresh_view");
     }
 
-    if ((model_update == VIEW_DOWN) && (model->current_row > NUM_OF_TRANS*2) && (priv->tlist_start < (g_list_length (priv->full_tlist) - NUM_OF_TRANS*3 )))
+    if ((model_update == VIEW_DOWN) && (model->current_row > NUM_OF_TRANS*2) && (priv->tlist_start < (model->number_of_trans_in_full_tlist - NUM_OF_TRANS*3 )))
     {
         gint dblock_end = 0;
         gint iblock_start = priv->tlist_start + NUM_OF_TRANS*3;
@@ -754,8 +737,8 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
         if (iblock_start < 0)
             iblock_start = 0;
 
-        if (iblock_end > g_list_length (priv->full_tlist))
-            iblock_end = g_list_length (priv->full_tlist) - 1;
+        if (iblock_end > model->number_of_trans_in_full_tlist)
+            iblock_end = model->number_of_trans_in_full_tlist - 1;
 
         icount = iblock_end - iblock_start + 1;
 
@@ -1404,16 +1387,11 @@ gnc_tree_model_split_reg_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
         gtk_tree_path_append_index (path, 0); /* Add the Level 2 part */
         gtk_tree_path_append_index (path, spos);
     }
-
-    {
-        gchar *path_string = gtk_tree_path_to_string (path);
-        //LEAVE("get path  %s", path_string);
-        g_free (path_string);
-    }
     return path;
 
  fail:
     //LEAVE("No Valid Path");
+    gtk_tree_path_free (path);
     return NULL;
 }
 
@@ -2273,15 +2251,28 @@ gnc_tree_model_split_reg_sort_iter_compare_func (GtkTreeModel *tm,
                           gpointer      user_data)
 {
     GncTreeModelSplitReg *model = GNC_TREE_MODEL_SPLIT_REG (tm);
+    GtkTreePath *path_a, *path_b;
+    gint result;
+
+    /* This is really a dummy sort function, it leaves the list as is.
+     * The tlist is already in sorted order, so the row paths are all
+     * that is compared; nothing is looked up in the engine. */
+    path_a = gnc_tree_model_split_reg_get_path (tm, a);
+    path_b = gnc_tree_model_split_reg_get_path (tm, b);
+
+    if (!path_a || !path_b)
+        result = (path_a ? 1 : 0) - (path_b ? 1 : 0);
+    else if (model->sort_direction == GTK_SORT_ASCENDING)
+        result = gtk_tree_path_compare (path_a, path_b);
+    else
+        result = gtk_tree_path_compare (path_b, path_a);
 
-    /* This is really a dummy sort function, it leaves the list as is. */
+    if (path_a)
+        gtk_tree_path_free (path_a);
+    if (path_b)
+        gtk_tree_path_free (path_b);
 
-    if (model->sort_direction == GTK_SORT_ASCENDING)
-        return gtk_tree_path_compare (gnc_tree_model_split_reg_get_path (tm, a),
-                                      gnc_tree_model_split_reg_get_path (tm, b));
-    else
-        return gtk_tree_path_compare (gnc_tree_model_split_reg_get_path (tm, b),
-                                      gnc_tree_model_split_reg_get_path (tm, a));
+    return result;
 }
 
 /*##########################################################################*/
@@ -34,6 +34,7 @@
 #include "gnc-tree-view-account.h"
 
 #include "Account.h"
+#include "Transaction.h"
 #include "gnc-accounting-period.h"
 #include "gnc-commodity.h"
 #include "gnc-component-manager.h"
@@ -41,6 +42,7 @@
 #include "gnc-glib-utils.h"
 #include "gnc-gobject-utils.h"
 #include "gnc-prefs.h"
+#include "gnc-pricedb.h"
 #include "gnc-hooks.h"
 #include "gnc-session.h"
 #include "gnc-icons.h"
@@ -1889,6 +1891,129 @@ gnc_tree_view_account_add_custom_column(GncTreeViewAccount *account_view,
 /* BEGIN FILTER FUNCTIONS */
 #define FILTER_TREE_VIEW "types_tree_view"
 
+static gboolean
+account_filter_evaluate (AccountFilterDialog *fd, Account *account,
+                         gboolean used)
+{
+    GNCAccountType acct_type;
+    gnc_numeric total;
+
+    if (!fd->show_hidden && xaccAccountIsHidden (account))
+        return FALSE;
+
+    if (!fd->show_zero_total)
+    {
+        /* An account tree without any splits can only total zero. */
+        if (!used)
+            return FALSE;
+        total = xaccAccountGetBalanceInCurrency (account, NULL, TRUE);
+        if (gnc_numeric_zero_p(total))
+            return FALSE;
+    }
+
+    if (!fd->show_unused && !used)
+        return FALSE;
+
+    acct_type = xaccAccountGetType(account);
+    return (fd->visible_types & (1 << acct_type)) ? TRUE : FALSE;
+}
+
+/** Evaluate the filter for an account and all of its descendants,
+ *  children first, so that whether a subtree is used is computed once
+ *  instead of recounting the splits of every descendant at each
+ *  level.
+ *
+ *  @return TRUE if the account or any descendant has splits. */
+static gboolean
+account_filter_cache_fill (AccountFilterDialog *fd, Account *account)
+{
+    GList *children, *node;
+    gboolean used;
+
+    used = (xaccAccountGetSplitList (account) != NULL);
+    children = gnc_account_get_children (account);
+    for (node = children; node; node = g_list_next (node))
+    {
+        if (account_filter_cache_fill (fd, node->data))
+            used = TRUE;
+    }
+    g_list_free (children);
+
+    g_hash_table_insert (fd->filter_cache, account,
+                         GINT_TO_POINTER(account_filter_evaluate (fd, account, used)));
+    return used;
+}
+
+static void
+account_filter_cache_clear (AccountFilterDialog *fd)
+{
+    if (fd->filter_cache)
+    {
+        g_hash_table_destroy (fd->filter_cache);
+        fd->filter_cache = NULL;
+    }
+}
+
+/** Re-evaluate the filter for the whole tree, recomputing the cached
+ *  results in the first visibility check. */
+static void
+account_filter_refilter (AccountFilterDialog *fd, GncTreeViewAccount *view)
+{
+    account_filter_cache_clear (fd);
+    gnc_tree_view_account_refilter (view);
+}
+
+static gboolean
+account_filter_idle_refilter (gpointer user_data)
+{
+    AccountFilterDialog *fd = user_data;
+
+    fd->filter_idle_id = 0;
+    account_filter_refilter (fd, fd->tree_view);
+    return FALSE;
+}
+
+/** Engine changes can alter the balance or split count of any
+ *  ancestor of the changed account, so drop all cached results and
+ *  rebuild them once the current batch of events is over.  Until
+ *  then the filter computes results directly. */
+static void
+account_filter_event_handler (QofInstance *entity,
+                              QofEventId event_type,
+                              gpointer user_data,
+                              gpointer event_data)
+{
+    AccountFilterDialog *fd = user_data;
+
+    if (!GNC_IS_ACCOUNT(entity) && !GNC_IS_SPLIT(entity) &&
+            !GNC_IS_TRANS(entity) && !GNC_IS_PRICE(entity))
+        return;
+
+    if (!fd->filter_cache || g_hash_table_size (fd->filter_cache) == 0)
+        return;
+
+    g_hash_table_remove_all (fd->filter_cache);
+    if (fd->filter_idle_id == 0)
+        fd->filter_idle_id = g_idle_add (account_filter_idle_refilter, fd);
+}
+
+static void
+account_filter_view_destroy_cb (GtkWidget *view, AccountFilterDialog *fd)
+{
+    if (fd->filter_event_handler_id)
+    {
+        qof_event_unregister_handler (fd->filter_event_handler_id);
+        fd->filter_event_handler_id = 0;
+    }
+    if (fd->filter_idle_id)
+    {
+        g_source_remove (fd->filter_idle_id);
+        fd->filter_idle_id = 0;
+    }
+    account_filter_cache_clear (fd);
+    fd->tree_view = NULL;
+}
+
 /** This function tells the account tree view whether or not to filter
  *  out a particular account.  Accounts may be filtered if the user
  *  has decided not to display that particular account type, or if the
@@ -1905,39 +2030,35 @@ gnc_plugin_page_account_tree_filter_accounts (Account *account,
         gpointer user_data)
 {
     AccountFilterDialog *fd = user_data;
-    GNCAccountType acct_type;
-    gnc_numeric total;
+    gpointer value;
     gboolean result;
 
     ENTER("account %p:%s", account, xaccAccountGetName(account));
 
-    if (!fd->show_hidden && xaccAccountIsHidden (account))
-    {
-        LEAVE(" hide: hidden");
-        return FALSE;
-    }
-
-    if (!fd->show_zero_total)
+    /* Without a view there is nothing to tie the cache's lifetime to. */
+    if (fd->tree_view && !fd->filter_cache)
     {
-        total = xaccAccountGetBalanceInCurrency (account, NULL, TRUE);
-        if (gnc_numeric_zero_p(total))
+        if (!fd->filter_event_handler_id)
         {
-            LEAVE(" hide: zero balance");
-            return FALSE;
+            fd->filter_event_handler_id =
+                qof_event_register_handler (account_filter_event_handler, fd);
+            g_signal_connect (fd->tree_view, "destroy",
+                              G_CALLBACK(account_filter_view_destroy_cb), fd);
         }
+        fd->filter_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+        account_filter_cache_fill (fd, gnc_account_get_root (account));
     }
 
-    if (!fd->show_unused)
+    if (fd->filter_cache &&
+            g_hash_table_lookup_extended (fd->filter_cache, account, NULL, &value))
     {
-        if (xaccAccountCountSplits(account, TRUE) == 0)
-        {
-            LEAVE(" hide: unused");
-            return FALSE;
-        }
+        result = GPOINTER_TO_INT(value);
+        LEAVE(" %s (cached)", result ? "show" : "hide");
+        return result;
     }
 
-    acct_type = xaccAccountGetType(account);
-    result = (fd->visible_types & (1 << acct_type)) ? TRUE : FALSE;
+    result = account_filter_evaluate (fd, account,
+                                      xaccAccountCountSplits (account, TRUE) != 0);
     LEAVE(" %s", result ? "show" : "hide");
     return result;
 }
@@ -1957,7 +2078,7 @@ gppat_filter_show_hidden_toggled_cb (GtkToggleButton *button,
 
     ENTER("button %p", button);
     fd->show_hidden = gtk_toggle_button_get_active(button);
-    gnc_tree_view_account_refilter(fd->tree_view);
+    account_filter_refilter(fd, fd->tree_view);
     LEAVE("show_hidden %d", fd->show_hidden);
 }
 
@@ -1976,7 +2097,7 @@ gppat_filter_show_zero_toggled_cb (GtkToggleButton *button,
 
     ENTER("button %p", button);
     fd->show_zero_total = gtk_toggle_button_get_active(button);
-    gnc_tree_view_account_refilter(fd->tree_view);
+    account_filter_refilter(fd, fd->tree_view);
     LEAVE("show_zero %d", fd->show_zero_total);
 }
 
@@ -1995,7 +2116,7 @@ gppat_filter_show_unused_toggled_cb (GtkToggleButton *button,
 
     ENTER("button %p", button);
     fd->show_unused = gtk_toggle_button_get_active(button);
-    gnc_tree_view_account_refilter(fd->tree_view);
+    account_filter_refilter(fd, fd->tree_view);
     LEAVE("show_unused %d", fd->show_unused);
 }
 
@@ -2016,7 +2137,7 @@ gppat_filter_clear_all_cb (GtkWidget *button,
     ENTER("button %p", button);
     fd->visible_types = 0;
     gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(fd->model));
-    gnc_tree_view_account_refilter(fd->tree_view);
+    account_filter_refilter(fd, fd->tree_view);
     LEAVE("types 0x%x", fd->visible_types);
 }
 
@@ -2035,7 +2156,7 @@ gppat_filter_select_all_cb (GtkWidget *button,
     ENTER("button %p", button);
     fd->visible_types = -1;
     gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(fd->model));
-    gnc_tree_view_account_refilter(fd->tree_view);
+    account_filter_refilter(fd, fd->tree_view);
     LEAVE("types 0x%x", fd->visible_types);
 }
 
@@ -2105,7 +2226,7 @@ gppat_filter_visible_toggled_cb (GtkCellRendererToggle *renderer,
     {
         gtk_tree_model_get(model, &iter, GNC_TREE_MODEL_ACCOUNT_TYPES_COL_TYPE, &type, -1);
         fd->visible_types ^= (1 << type);
-        gnc_tree_view_account_refilter(fd->tree_view);
+        account_filter_refilter(fd, fd->tree_view);
     }
     gtk_tree_path_free(path);
     LEAVE("types 0x%x", fd->visible_types);
@@ -2138,7 +2259,7 @@ gppat_filter_response_cb (GtkWidget *dialog,
         fd->show_hidden = fd->original_show_hidden;
         fd->show_zero_total = fd->original_show_zero_total;
         fd->show_unused = fd->original_show_unused;
-        gnc_tree_view_account_refilter(fd->tree_view);
+        account_filter_refilter(fd, fd->tree_view);
     }
 
     /* Clean up and delete dialog */
@@ -2483,7 +2604,7 @@ gnc_tree_view_account_restore(GncTreeViewAccount *view,
     }
 
     /* Update tree view for any changes */
-    gnc_tree_view_account_refilter(view);
+    account_filter_refilter(fd, view);
 }
 
 // @@fixme -- factor this app-not-gui-specific-logic out.
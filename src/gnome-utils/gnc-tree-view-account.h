@@ -86,6 +86,11 @@ typedef	struct
     gboolean             original_show_zero_total;
     gboolean             show_unused;
     gboolean             original_show_unused;
+    /* Account -> visibility, filled in one pass over the whole tree
+     * the first time the filter runs after a change. */
+    GHashTable          *filter_cache;
+    gint                 filter_event_handler_id;
+    guint                filter_idle_id;
 } AccountFilterDialog;
 
 void account_filter_dialog_create(AccountFilterDialog *fd,
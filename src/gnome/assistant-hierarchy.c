@@ -423,7 +423,9 @@ account_categories_tree_view_prepare (hierarchy_data  *data)
 
     gnc_accounts_dir = gnc_path_get_accountsdir ();
     locale_dir = gnc_get_ea_locale_dir (gnc_accounts_dir);
-    list = gnc_load_example_account_list (locale_dir);
+    /* Only the titles and descriptions are needed to fill the list; the
+     * account trees are read when a category is shown or used. */
+    list = gnc_load_example_account_header_list (locale_dir);
     g_free (gnc_accounts_dir);
     g_free (locale_dir);
 
@@ -555,6 +557,9 @@ categories_tree_selection_changed (GtkTreeSelection *selection,
                                  gea->long_description :
                                  _("No description provided."), -1);
 
+        if (!gnc_example_account_load_tree (gea))
+            return;
+
         tree_view = gnc_tree_view_account_new_with_root (gea->root, FALSE);
         /* Override the normal fixed (user settable) sizing */
         column = gtk_tree_view_get_column(GTK_TREE_VIEW(tree_view), 0);
@@ -707,7 +712,8 @@ hierarchy_merge_accounts (GSList *dalist, gnc_commodity *com)
     {
         GncExampleAccount *xea = mark->data;
 
-        add_new_accounts_with_random_guids (ret, xea->root, com);
+        if (gnc_example_account_load_tree (xea))
+            add_new_accounts_with_random_guids (ret, xea->root, com);
     }
 
     return ret;
@@ -265,6 +265,55 @@ gnc_reconcile_view_construct (GNCReconcileView *view, Query *query)
 }
 
 
+static void
+gnc_reconcile_view_mark_split (GNCReconcileView *view, Split *split)
+{
+    g_hash_table_insert (view->reconciled, split, split);
+    view->reconciled_balance = gnc_numeric_add_fixed (view->reconciled_balance,
+                               xaccSplitGetAmount (split));
+}
+
+
+static void
+gnc_reconcile_view_unmark_split (GNCReconcileView *view, Split *split)
+{
+    g_hash_table_remove (view->reconciled, split);
+    view->reconciled_balance = gnc_numeric_sub_fixed (view->reconciled_balance,
+                               xaccSplitGetAmount (split));
+}
+
+
+/* Mark the cleared splits of an account posted on or before the
+ * statement date.  The account's split list is sorted by date, so
+ * the walk stops at the first later split.  These are the criteria of
+ * the view's query, restricted to cleared splits. */
+static void
+gnc_reconcile_view_auto_check (GNCReconcileView *view, Account *account)
+{
+    GList *node;
+
+    for (node = xaccAccountGetSplitList (account); node; node = node->next)
+    {
+        Split *split = node->data;
+        gnc_numeric value;
+
+        if (gnc_difftime (xaccTransGetDate (xaccSplitGetParent (split)),
+                          view->statement_date) > 0)
+            break;
+
+        if (xaccSplitGetReconcile (split) != CREC)
+            continue;
+
+        value = xaccSplitGetValue (split);
+        if (view->view_type == RECLIST_CREDIT ?
+                gnc_numeric_positive_p (value) : gnc_numeric_negative_p (value))
+            continue;
+
+        gnc_reconcile_view_mark_split (view, split);
+    }
+}
+
+
 GtkWidget *
 gnc_reconcile_view_new (Account *account, GNCReconcileViewType type,
                        time64 statement_date)
@@ -273,7 +322,7 @@ gnc_reconcile_view_new (Account *account, GNCReconcileViewType type,
     GtkListStore     *liststore;
     gboolean          include_children, auto_check;
     GList            *accounts = NULL;
-    GList            *splits;
+    GList            *node;
     Query            *query;
 
     g_return_val_if_fail (account, NULL);
@@ -305,8 +354,6 @@ gnc_reconcile_view_new (Account *account, GNCReconcileViewType type,
 
     xaccQueryAddAccountMatch (query, accounts, QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
 
-    g_list_free (accounts);
-
     /* limit the matches to CREDITs and DEBITs only, depending on the type */
     if (type == RECLIST_CREDIT)
         xaccQueryAddValueMatch(query, gnc_numeric_zero (),
@@ -328,20 +375,10 @@ gnc_reconcile_view_new (Account *account, GNCReconcileViewType type,
 
     if (auto_check)
     {
-        for (splits = qof_query_run (query); splits; splits = splits->next)
-        {
-            Split *split = splits->data;
-            char recn = xaccSplitGetReconcile (split);
-            time64 trans_date = xaccTransGetDate (xaccSplitGetParent (split));
-
-            /* Just an extra verification that our query is correct ;) */
-            g_assert (recn == NREC || recn == CREC);
-
-            if (recn == CREC &&
-		gnc_difftime (trans_date, statement_date) <= 0)
-		g_hash_table_insert (view->reconciled, split, split);
-        }
+        for (node = accounts; node; node = node->next)
+            gnc_reconcile_view_auto_check (view, node->data);
     }
+    g_list_free (accounts);
 
     /* Free the query -- we don't need it anymore */
     qof_query_destroy (query);
@@ -359,6 +396,7 @@ gnc_reconcile_view_init (GNCReconcileView *view)
                 qof_book_use_split_action_for_num_field(gnc_get_current_book());
 
     view->reconciled = g_hash_table_new (NULL, NULL);
+    view->reconciled_balance = gnc_numeric_zero ();
     view->account = NULL;
     view->sibling = NULL;
 
@@ -454,9 +492,9 @@ gnc_reconcile_view_toggle_split (GNCReconcileView *view, Split *split)
     current = g_hash_table_lookup (view->reconciled, split);
 
     if (current == NULL)
-        g_hash_table_insert (view->reconciled, split, split);
+        gnc_reconcile_view_mark_split (view, split);
     else
-        g_hash_table_remove (view->reconciled, split);
+        gnc_reconcile_view_unmark_split (view, split);
 }
 
 
@@ -795,20 +833,32 @@ gnc_reconcile_view_is_reconciled (gpointer item, gpointer user_data)
  * Args: view - view to refresh                                     *
  * Returns: nothing                                                 *
 \********************************************************************/
-static void
+static gboolean
 grv_refresh_helper (gpointer key, gpointer value, gpointer user_data)
 {
-    GNCReconcileView *view = user_data;
-    GNCQueryView *qview = GNC_QUERY_VIEW (view);
+    GHashTable *in_view = user_data;
+
+    return g_hash_table_lookup (in_view, key) == NULL;
+}
+
+static void
+grv_balance_hash_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    Split *split = key;
+    gnc_numeric *total = user_data;
 
-    if (!gnc_query_view_item_in_view (qview, key))
-        g_hash_table_remove (view->reconciled, key);
+    *total = gnc_numeric_add_fixed (*total, xaccSplitGetAmount (split));
 }
 
 void
 gnc_reconcile_view_refresh (GNCReconcileView *view)
 {
     GNCQueryView *qview;
+    GtkTreeModel *model;
+    GtkTreeIter   iter;
+    GHashTable   *in_view;
+    gboolean      valid;
+    gpointer      pointer;
 
     g_return_if_fail (view != NULL);
     g_return_if_fail (GNC_IS_RECONCILE_VIEW (view));
@@ -816,9 +866,25 @@ gnc_reconcile_view_refresh (GNCReconcileView *view)
     qview = GNC_QUERY_VIEW (view);
     gnc_query_view_refresh (qview);
 
+    if (!view->reconciled)
+        return;
+
     /* Now verify that everything in the reconcile hash is still in qview */
-    if (view->reconciled)
-        g_hash_table_foreach (view->reconciled, grv_refresh_helper, view);
+    in_view = g_hash_table_new (NULL, NULL);
+    model = gtk_tree_view_get_model (GTK_TREE_VIEW (qview));
+    for (valid = gtk_tree_model_get_iter_first (model, &iter); valid;
+            valid = gtk_tree_model_iter_next (model, &iter))
+    {
+        gtk_tree_model_get (model, &iter, 0, &pointer, -1);
+        g_hash_table_insert (in_view, pointer, pointer);
+    }
+    g_hash_table_foreach_remove (view->reconciled, grv_refresh_helper, in_view);
+    g_hash_table_destroy (in_view);
+
+    /* The refresh may come from an edit of a marked split's amount. */
+    view->reconciled_balance = gnc_numeric_zero ();
+    g_hash_table_foreach (view->reconciled, grv_balance_hash_helper,
+                          &view->reconciled_balance);
 }
 
 
@@ -829,15 +895,6 @@ gnc_reconcile_view_refresh (GNCReconcileView *view)
  * Args: view - view to get reconciled balance of                   *
  * Returns: reconciled balance (gnc_numeric)                        *
 \********************************************************************/
-static void
-grv_balance_hash_helper (gpointer key, gpointer value, gpointer user_data)
-{
-    Split *split = key;
-    gnc_numeric *total = user_data;
-
-    *total = gnc_numeric_add_fixed (*total, xaccSplitGetAmount (split));
-}
-
 gnc_numeric
 gnc_reconcile_view_reconciled_balance (GNCReconcileView *view)
 {
@@ -849,9 +906,7 @@ gnc_reconcile_view_reconciled_balance (GNCReconcileView *view)
     if (view->reconciled == NULL)
         return total;
 
-    g_hash_table_foreach (view->reconciled, grv_balance_hash_helper, &total);
-
-    return gnc_numeric_abs (total);
+    return gnc_numeric_abs (view->reconciled_balance);
 }
 
 
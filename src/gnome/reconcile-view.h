@@ -49,6 +49,7 @@ struct GNCReconcileView
     GNCQueryView         qview;
 
     GHashTable          *reconciled;
+    gnc_numeric          reconciled_balance; /* sum of reconciled amounts */
     Account             *account;
     GList               *column_list;
 
@@ -1038,8 +1038,12 @@ gnc_ab_import_context(AB_IMEXPORTER_CONTEXT *context,
 
     /* Import transactions */
     if (!(awaiting & IGNORE_TRANSACTIONS))
+    {
         AB_ImExporterContext_AccountInfoForEach(context, txn_accountinfo_cb,
                                                 data);
+        if (data->generic_importer)
+            gnc_gen_trans_list_create_matches (data->generic_importer);
+    }
 
     /* Check balances */
     if (!(awaiting & IGNORE_BALANCES))
@@ -69,7 +69,8 @@ typedef struct
     CsvExportType   export_type;
     CsvExportDate   csvd;
     CsvExportAcc    csva;
-    GList          *trans_list;
+    GHashTable     *trans_hash;     /* Transactions already exported */
+    GHashTable     *account_names;  /* Account -> full name, during export */
 
     Query          *query;
     Account        *account;
@@ -51,6 +51,9 @@ static QofLogModule log_module = GNC_MOD_ASSISTANT;
 #endif
 
 
+/* Size of the stdio buffer the export is written through */
+#define CSV_EXPORT_BUFFER_SIZE (64 * 1024)
+
 enum GncCsvLineType {TRANS_SIMPLE,
                      TRANS_COMPLEX,
                      SPLIT_LINE};
@@ -60,83 +63,96 @@ enum GncCsvLineType {TRANS_SIMPLE,
 /*******************************************************
  * write_line_to_file
  *
- * write a text string to a file pointer, return TRUE if
- * successfull.
+ * write the contents of the line buffer to a file
+ * pointer, return TRUE if successfull.
  *******************************************************/
 static
-gboolean write_line_to_file (FILE *fh, char * line)
+gboolean write_line_to_file (FILE *fh, GString *line)
 {
-    int len, written;
-    DEBUG("Account String: %s", line);
+    gsize written;
+    DEBUG("Account String: %s", line->str);
 
     /* Write account line */
-    len = strlen (line);
-    written = fwrite (line, 1, len, fh);
+    written = fwrite (line->str, 1, line->len, fh);
 
-    if (written != len)
-        return FALSE;
-    else
-        return TRUE;
+    return written == line->len;
 }
 
 
 /*******************************************************
- * csv_txn_test_field_string
+ * csv_txn_add_field_string
  *
- * Test the field string for ," and new lines
+ * Append a field to the line, doubling any " in it and
+ * quoting it if it contains the separator, a new
+ * line or a ", followed by the separator in sep.
  *******************************************************/
-static
-gchar *csv_txn_test_field_string (CsvExportInfo *info, const gchar *string_in)
+static void
+csv_txn_add_field_string (GString *line, CsvExportInfo *info,
+                          const gchar *string_in, const gchar *sep)
 {
-    gboolean need_quote = FALSE;
-    gchar **parts;
-    gchar *string_parts;
-    gchar *string_out;
+    gboolean need_quote;
+    const gchar *p;
+
+    if (string_in == NULL)
+        string_in = "";
+
+    /* A field containing " is always quoted, so the quote doubling
+     * cannot change whether the field needs quoting. */
+    need_quote = (strchr (string_in, '"') != NULL ||
+                  strchr (string_in, '\n') != NULL ||
+                  g_strrstr (string_in, info->separator_str) != NULL);
+
+    if (!info->use_quotes && need_quote)
+        g_string_append_c (line, '"');
 
     /* Check for " and then "" them */
-    parts = g_strsplit (string_in, "\"", -1);
-    string_parts = g_strjoinv ("\"\"", parts);
-    g_strfreev (parts);
-
-    /* Check for separator string and \n and " in field,
-       if so quote field if not allready quoted */
-    if (g_strrstr (string_parts, info->separator_str) != NULL)
-        need_quote = TRUE;
-    if (g_strrstr (string_parts, "\n") != NULL)
-        need_quote = TRUE;
-    if (g_strrstr (string_parts, "\"") != NULL)
-        need_quote = TRUE;
+    for (p = string_in; *p; p++)
+    {
+        if (*p == '"')
+            g_string_append_c (line, '"');
+        g_string_append_c (line, *p);
+    }
 
     if (!info->use_quotes && need_quote)
-        string_out = g_strconcat ("\"", string_parts, "\"", NULL);
-    else
-        string_out = g_strdup (string_parts);
+        g_string_append_c (line, '"');
 
-    g_free (string_parts);
-    return string_out;
+    g_string_append (line, sep);
 }
 
 /******************** Helper functions *********************/
 
+/* The full names of the accounts seen so far during the export,
+ * so each is only built once. */
+static const gchar*
+get_account_full_name (Account *account, CsvExportInfo *info)
+{
+    gchar *name = g_hash_table_lookup (info->account_names, account);
+
+    if (name == NULL)
+    {
+        name = gnc_account_get_full_name (account);
+        g_hash_table_insert (info->account_names, account, name);
+    }
+    return name;
+}
+
 // Transaction line starts with Date
-static gchar*
-begin_trans_string (Transaction *trans, CsvExportInfo *info)
+static void
+begin_trans_string (GString *line, Transaction *trans, CsvExportInfo *info)
 {
     gchar *date = qof_print_date (xaccTransGetDate (trans));
-    gchar *result = g_strconcat (info->end_sep, date, info->mid_sep, NULL);
+    g_string_append (line, info->end_sep);
+    g_string_append (line, date);
+    g_string_append (line, info->mid_sep);
     g_free (date);
-    return result;
 }
 
 
 // Split line start
-static gchar*
-begin_split_string (Transaction *trans, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+begin_split_string (GString *line, Transaction *trans, Split *split, gboolean t_void, CsvExportInfo *info)
 {
     const gchar *str_rec_date;
-    const gchar *start;
-    gchar       *conv;
-    gchar       *result;
     Timespec     ts = {0,0};
 
     if (xaccSplitGetReconcile (split) == YREC)
@@ -147,78 +163,58 @@ begin_split_string (Transaction *trans, Split *split, gboolean t_void, CsvExport
     else
         str_rec_date = "";
 
+    g_string_append (line, info->end_sep);
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, str_rec_date);
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, info->mid_sep);
     if (t_void)
-    {
-        start = xaccTransGetVoidReason (trans) ? xaccTransGetVoidReason (trans) : "" ;
-        conv = csv_txn_test_field_string (info, start);
-        result = g_strconcat (info->end_sep, info->mid_sep, info->mid_sep, str_rec_date,
-                              info->mid_sep, info->mid_sep, info->mid_sep, info->mid_sep, conv, info->mid_sep, NULL);
-        g_free (conv);
-    }
+        csv_txn_add_field_string (line, info, xaccTransGetVoidReason (trans), info->mid_sep);
     else
-         result = g_strconcat (info->end_sep, info->mid_sep, info->mid_sep, str_rec_date,
-                               info->mid_sep, info->mid_sep, info->mid_sep, info->mid_sep, info->mid_sep, NULL);
-
-    return result;
+        g_string_append (line, info->mid_sep);
 }
 
 
 // Transaction Type
-static gchar*
-add_type (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_type (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    gchar       *result;
-    char         type;
-    static char  ss[2];
-
-    type = xaccTransGetTxnType (trans);
+    char type = xaccTransGetTxnType (trans);
 
     if (type == TXN_TYPE_NONE)
         type = ' ';
-    ss[0] = type;
-    ss[1] = '\0';
-    result = g_strconcat (so_far, ss, info->mid_sep, NULL);
-    g_free (so_far);
-    return result;
+    g_string_append_c (line, type);
+    g_string_append (line, info->mid_sep);
 }
 
 // Second Date
-static gchar*
-add_second_date (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_second_date (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    gchar       *result;
-    const gchar *second_date;
-    char         type;
-    Timespec     ts = {0,0};
-
-    type = xaccTransGetTxnType (trans);
+    Timespec ts = {0,0};
 
-    if (type == TXN_TYPE_INVOICE)
+    if (xaccTransGetTxnType (trans) == TXN_TYPE_INVOICE)
     {
         xaccTransGetDateDueTS (trans, &ts);
-        second_date = gnc_print_date (ts);
-        result = g_strconcat (so_far, second_date, info->mid_sep, NULL);
+        g_string_append (line, gnc_print_date (ts));
     }
-    else
-        result = g_strconcat (so_far, info->mid_sep, NULL);
-
-    g_free (so_far);
-    return result;
+    g_string_append (line, info->mid_sep);
 }
 
 // Account Name short or Long
-static gchar*
-add_account_name (gchar *so_far, Account *acc, Split *split, gboolean full, CsvExportInfo *info)
+static void
+add_account_name (GString *line, Account *acc, Split *split, gboolean full, CsvExportInfo *info)
 {
-    gchar       *name = NULL;
-    gchar       *conv;
-    gchar       *result;
+    const gchar *name = NULL;
     Account     *account = NULL;
 
     if (split == NULL)
     {
         if (acc == NULL)
-            name = g_strdup (" ");
+            name = " ";
         else
             account = acc;
     }
@@ -228,205 +224,117 @@ add_account_name (gchar *so_far, Account *acc, Split *split, gboolean full, CsvE
     if (account != NULL)
     {
         if (full)
-            name = gnc_account_get_full_name (account);
+            name = get_account_full_name (account, info);
         else
-            name = g_strdup (xaccAccountGetName (account));
+            name = xaccAccountGetName (account);
     }
-    conv = csv_txn_test_field_string (info, name);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (name);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, name, info->mid_sep);
 }
 
 // Number
-static gchar*
-add_number (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_number (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *num;
-    gchar       *conv;
-    gchar       *result;
-
-    num = xaccTransGetNum (trans) ? xaccTransGetNum (trans) : "" ;
-    conv = csv_txn_test_field_string (info, num);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, xaccTransGetNum (trans), info->mid_sep);
 }
 
 // Description
-static gchar*
-add_description (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_description (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *desc;
-    gchar       *conv;
-    gchar       *result;
-
-    desc = xaccTransGetDescription (trans) ? xaccTransGetDescription (trans) : "" ;
-    conv = csv_txn_test_field_string (info, desc);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, xaccTransGetDescription (trans), info->mid_sep);
 }
 
 // Notes
-static gchar*
-add_notes (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_notes (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *notes;
-    gchar       *conv;
-    gchar       *result;
-
-    notes = xaccTransGetNotes (trans) ? xaccTransGetNotes (trans) : "" ;
-    conv = csv_txn_test_field_string (info, notes);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, xaccTransGetNotes (trans), info->mid_sep);
 }
 
 // Memo
-static gchar*
-add_memo (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_memo (GString *line, Split *split, CsvExportInfo *info)
 {
-    const gchar *memo;
-    gchar       *conv;
-    gchar       *result;
-
-    memo = xaccSplitGetMemo (split) ? xaccSplitGetMemo (split) : "" ;
-    conv = csv_txn_test_field_string (info, memo);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, xaccSplitGetMemo (split), info->mid_sep);
 }
 
 // Full Category Path or Not
-static gchar*
-add_category (gchar *so_far, Split *split, gboolean full, CsvExportInfo *info)
+static void
+add_category (GString *line, Split *split, gboolean full, CsvExportInfo *info)
 {
-    gchar       *cat;
-    gchar       *conv;
-    gchar       *result;
-
     if (full)
-        cat = xaccSplitGetCorrAccountFullName (split);
+    {
+        gchar *cat = xaccSplitGetCorrAccountFullName (split);
+        csv_txn_add_field_string (line, info, cat, info->mid_sep);
+        g_free (cat);
+    }
     else
-        cat = g_strdup(xaccSplitGetCorrAccountName (split));
-
-    conv = csv_txn_test_field_string (info, cat);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (cat);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+        csv_txn_add_field_string (line, info, xaccSplitGetCorrAccountName (split), info->mid_sep);
 }
 
 // Line Type
-static gchar*
-add_line_type (gchar *so_far, gint line_type, CsvExportInfo *info)
+static void
+add_line_type (GString *line, gint line_type, CsvExportInfo *info)
 {
-    gchar *result;
-
-    if (line_type == SPLIT_LINE)
-        result = g_strconcat (so_far, "S", info->mid_sep, NULL);
-    else
-        result = g_strconcat (so_far, "T", info->mid_sep, NULL);
-
-    g_free (so_far);
-    return result;
+    g_string_append (line, line_type == SPLIT_LINE ? "S" : "T");
+    g_string_append (line, info->mid_sep);
 }
 
 // Action
-static gchar*
-add_action (gchar *so_far, Split *split, gint line_type, CsvExportInfo *info)
+static void
+add_action (GString *line, Split *split, gint line_type, CsvExportInfo *info)
 {
-    const gchar *action;
-    gchar       *conv;
-    gchar       *result;
-
     if ((line_type == TRANS_COMPLEX)||(line_type == TRANS_SIMPLE))
-        result = g_strconcat (so_far, "", info->mid_sep, NULL);
+        g_string_append (line, info->mid_sep);
     else
-    {
-        action = xaccSplitGetAction (split);
-        conv = csv_txn_test_field_string (info, action);
-        result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-        g_free (conv);
-    }
-    g_free (so_far);
-    return result;
+        csv_txn_add_field_string (line, info, xaccSplitGetAction (split), info->mid_sep);
 }
 
 // Reconcile
-static gchar*
-add_reconcile (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_reconcile (GString *line, Split *split, CsvExportInfo *info)
 {
-    const gchar *recon;
-    gchar       *conv;
-    gchar       *result;
-
-    recon = gnc_get_reconcile_str (xaccSplitGetReconcile (split));
-    conv = csv_txn_test_field_string (info, recon);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, gnc_get_reconcile_str (xaccSplitGetReconcile (split)),
+                              info->mid_sep);
 }
 
 // Commodity Mnemonic
-static gchar*
-add_comm_mnemonic (gchar *so_far, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+add_comm_mnemonic (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     const gchar *comm_m;
-    gchar       *conv;
-    gchar       *result;
 
     if (split == NULL)
         comm_m = gnc_commodity_get_mnemonic (xaccTransGetCurrency (trans));
     else
         comm_m = gnc_commodity_get_mnemonic (xaccAccountGetCommodity (xaccSplitGetAccount(split)));
 
-    conv = csv_txn_test_field_string (info, comm_m);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, comm_m, info->mid_sep);
 }
 
 // Commodity Namespace
-static gchar*
-add_comm_namespace (gchar *so_far, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+add_comm_namespace (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     const gchar *comm_n;
-    gchar       *conv;
-    gchar       *result;
 
     if (split == NULL)
         comm_n = gnc_commodity_get_namespace (xaccTransGetCurrency (trans));
     else
         comm_n = gnc_commodity_get_namespace (xaccAccountGetCommodity (xaccSplitGetAccount(split)));
 
-    conv = csv_txn_test_field_string (info, comm_n);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, comm_n, info->mid_sep);
 }
 
 // Amount with Symbol or not
-static gchar*
-add_amount (gchar *so_far, Split *split, gboolean t_void, gboolean symbol, gint line_type, CsvExportInfo *info)
+static void
+add_amount (GString *line, Split *split, gboolean t_void, gboolean symbol, gint line_type, CsvExportInfo *info)
 {
     const gchar *amt;
-    gchar       *conv;
-    gchar       *result;
 
     if (line_type == TRANS_COMPLEX)
-        result = g_strconcat (so_far, "", info->mid_sep, NULL);
+        g_string_append (line, info->mid_sep);
     else
     {
         if (symbol)
@@ -443,41 +351,30 @@ add_amount (gchar *so_far, Split *split, gboolean t_void, gboolean symbol, gint
             else
                 amt = xaccPrintAmount (xaccSplitGetAmount (split), gnc_split_amount_print_info (split, FALSE));
         }
-        conv = csv_txn_test_field_string (info, amt);
-        result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-        g_free (conv);
+        csv_txn_add_field_string (line, info, amt, info->mid_sep);
     }
-    g_free (so_far);
-    return result;
 }
 
 // Share Price / Conversion factor
-static gchar*
-add_rate (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+add_rate (GString *line, Split *split, gboolean t_void, CsvExportInfo *info)
 {
     const gchar *amt;
-    gchar       *conv;
-    gchar       *result;
 
     if (t_void)
         amt = xaccPrintAmount (gnc_numeric_zero(), gnc_split_amount_print_info (split, FALSE));
     else
         amt = xaccPrintAmount (xaccSplitGetSharePrice (split), gnc_split_amount_print_info (split, FALSE));
 
-    conv = csv_txn_test_field_string (info, amt);
-    result = g_strconcat (so_far, conv, info->end_sep, EOLSTR, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_add_field_string (line, info, amt, info->end_sep);
+    g_string_append (line, EOLSTR);
 }
 
 // Share Price / Conversion factor
-static gchar*
-add_price (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+add_price (GString *line, Split *split, gboolean t_void, CsvExportInfo *info)
 {
     const gchar *string_amount;
-    gchar       *conv;
-    gchar       *result;
 
     if (t_void)
     {
@@ -488,84 +385,78 @@ add_price (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
     else
         string_amount = xaccPrintAmount (xaccSplitGetSharePrice (split), gnc_split_amount_print_info (split, FALSE));
 
-    conv = csv_txn_test_field_string (info, string_amount);
-    result = g_strconcat (so_far, conv, info->end_sep, EOLSTR, NULL);
-    g_free (conv);
-    return result;
+    csv_txn_add_field_string (line, info, string_amount, info->end_sep);
+    g_string_append (line, EOLSTR);
 }
 
 // Transaction End of Line
-static gchar*
-add_trans_eol (gchar *so_far, CsvExportInfo *info)
+static void
+add_trans_eol (GString *line, CsvExportInfo *info)
 {
-    gchar *result = g_strconcat (so_far, "", info->mid_sep, "", info->end_sep, EOLSTR, NULL);
-
-    g_free (so_far);
-    return result;
+    g_string_append (line, info->mid_sep);
+    g_string_append (line, info->end_sep);
+    g_string_append (line, EOLSTR);
 }
 
 /******************************************************************************/
 
-static gchar*
-make_simple_trans_line (Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_simple_trans_line (GString *line, Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     gboolean t_void = xaccTransGetVoidStatus (trans);
 
-    gchar *result = begin_trans_string (trans, info);
-    result = add_account_name (result, acc, NULL, TRUE, info);
-    result = add_number (result, trans, info);
-    result = add_description (result, trans, info);
-    result = add_category (result, split, TRUE, info);
-    result = add_reconcile (result, split, info);
-    result = add_amount (result, split, t_void, TRUE, TRANS_SIMPLE, info);
-    result = add_amount (result, split, t_void, FALSE, TRANS_SIMPLE, info);
-    result = add_rate (result, split, t_void, info);
-    return result;
+    begin_trans_string (line, trans, info);
+    add_account_name (line, acc, NULL, TRUE, info);
+    add_number (line, trans, info);
+    add_description (line, trans, info);
+    add_category (line, split, TRUE, info);
+    add_reconcile (line, split, info);
+    add_amount (line, split, t_void, TRUE, TRANS_SIMPLE, info);
+    add_amount (line, split, t_void, FALSE, TRANS_SIMPLE, info);
+    add_rate (line, split, t_void, info);
 }
 
-static gchar*
-make_complex_trans_line (Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_complex_trans_line (GString *line, Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     gboolean t_void = xaccTransGetVoidStatus (trans);
 
-    gchar *result = begin_trans_string (trans, info);
-    result = add_type (result, trans, info);
-    result = add_second_date (result, trans, info);
-    result = add_account_name (result, acc, NULL, FALSE, info);
-    result = add_number (result, trans, info);
-    result = add_description (result, trans, info);
-    result = add_notes (result, trans, info);
-    result = add_memo (result, split, info);
-    result = add_category (result, split, TRUE, info);
-    result = add_category (result, split, FALSE, info);
-    result = add_line_type (result, TRANS_COMPLEX, info);
-    result = add_action (result,split, TRANS_COMPLEX, info);
-    result = add_reconcile (result, split, info);
-    result = add_amount (result, split, t_void, TRUE, TRANS_COMPLEX, info);
-    result = add_comm_mnemonic (result, trans, NULL, info);
-    result = add_comm_namespace (result, trans, NULL, info);
-    result = add_trans_eol (result, info);
-    return result;
+    begin_trans_string (line, trans, info);
+    add_type (line, trans, info);
+    add_second_date (line, trans, info);
+    add_account_name (line, acc, NULL, FALSE, info);
+    add_number (line, trans, info);
+    add_description (line, trans, info);
+    add_notes (line, trans, info);
+    add_memo (line, split, info);
+    add_category (line, split, TRUE, info);
+    add_category (line, split, FALSE, info);
+    add_line_type (line, TRANS_COMPLEX, info);
+    add_action (line, split, TRANS_COMPLEX, info);
+    add_reconcile (line, split, info);
+    add_amount (line, split, t_void, TRUE, TRANS_COMPLEX, info);
+    add_comm_mnemonic (line, trans, NULL, info);
+    add_comm_namespace (line, trans, NULL, info);
+    add_trans_eol (line, info);
 }
 
-static gchar*
-make_complex_split_line (Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_complex_split_line (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     gboolean t_void = xaccTransGetVoidStatus (trans);
 
-    gchar *result = begin_split_string (trans, split, t_void, info);
-    result = add_memo (result, split, info);
-    result = add_account_name (result, NULL, split, TRUE, info);
-    result = add_account_name (result, NULL, split, FALSE, info);
-    result = add_line_type (result, SPLIT_LINE, info);
-    result = add_action (result,split, SPLIT_LINE, info);
-    result = add_reconcile (result, split, info);
-    result = add_amount (result, split, t_void, TRUE, SPLIT_LINE, info);
-    result = add_comm_mnemonic (result, trans, split, info);
-    result = add_comm_namespace (result, trans, split, info);
-    result = add_amount (result, split, t_void, FALSE, SPLIT_LINE, info);
-    result = add_price (result, split, t_void, info);
-    return result;
+    begin_split_string (line, trans, split, t_void, info);
+    add_memo (line, split, info);
+    add_account_name (line, NULL, split, TRUE, info);
+    add_account_name (line, NULL, split, FALSE, info);
+    add_line_type (line, SPLIT_LINE, info);
+    add_action (line, split, SPLIT_LINE, info);
+    add_reconcile (line, split, info);
+    add_amount (line, split, t_void, TRUE, SPLIT_LINE, info);
+    add_comm_mnemonic (line, trans, split, info);
+    add_comm_namespace (line, trans, split, info);
+    add_amount (line, split, t_void, FALSE, SPLIT_LINE, info);
+    add_price (line, split, t_void, info);
 }
 
 
@@ -576,11 +467,12 @@ make_complex_split_line (Transaction *trans, Split *split, CsvExportInfo *info)
  * send them to a file
  *******************************************************/
 static
-void account_splits (CsvExportInfo *info, Account *acc, FILE *fh )
+void account_splits (CsvExportInfo *info, Account *acc, FILE *fh, GString *line)
 {
     GSList  *p1, *p2;
-    GList   *splits;
+    GList   *batch, *splits;
     QofBook *book;
+    QofQueryCursor *cursor;
 
     // Setup the query for normal transaction export
     if (info->export_type == XML_EXPORT_TRANS)
@@ -599,80 +491,77 @@ void account_splits (CsvExportInfo *info, Account *acc, FILE *fh )
         xaccQueryAddDateMatchTT (info->query, TRUE, info->csvd.start_time, TRUE, info->csvd.end_time, QOF_QUERY_AND);
     }
 
-    /* Run the query */
-    for (splits = qof_query_run (info->query); splits; splits = splits->next)
+    /* Run the query, a batch of splits at a time */
+    cursor = qof_query_cursor_new (info->query, 0);
+    while (!info->failed && (batch = qof_query_cursor_next (cursor)))
     {
-        Split       *split;
-        Transaction *trans;
-        SplitList   *s_list;
-        GList       *node;
-        Split       *t_split;
-        int          nSplits;
-        int          cnt;
-        gchar       *line;
-
-        split = splits->data;
-        trans = xaccSplitGetParent (split);
-        nSplits = xaccTransCountSplits (trans);
-        s_list = xaccTransGetSplitList (trans);
-
-        // Look for trans already exported in trans_list
-        if (g_list_find (info->trans_list, trans) != NULL)
-            continue;
-
-        // Look for blank split
-        if (xaccSplitGetAccount (split) == NULL)
-            continue;
-
-        // This will be a simple layout equivalent to a single line register view.
-        if (info->simple_layout)
+        for (splits = batch; splits; splits = splits->next)
         {
-            line = make_simple_trans_line (acc, trans, split, info);
-
-            /* Write to file */
-            if (!write_line_to_file (fh, line))
+            Split       *split;
+            Transaction *trans;
+            SplitList   *s_list;
+            GList       *node;
+            Split       *t_split;
+            int          nSplits;
+            int          cnt;
+
+            split = splits->data;
+            trans = xaccSplitGetParent (split);
+            nSplits = xaccTransCountSplits (trans);
+            s_list = xaccTransGetSplitList (trans);
+
+            // Look for trans already exported in trans_hash
+            if (g_hash_table_lookup (info->trans_hash, trans))
+                continue;
+
+            // Look for blank split
+            if (xaccSplitGetAccount (split) == NULL)
+                continue;
+
+            g_string_truncate (line, 0);
+
+            // This will be a simple layout equivalent to a single line register view.
+            if (info->simple_layout)
             {
-                info->failed = TRUE;
-                break;
+                make_simple_trans_line (line, acc, trans, split, info);
+
+                /* Write to file */
+                if (!write_line_to_file (fh, line))
+                {
+                    info->failed = TRUE;
+                    break;
+                }
+                continue;
             }
-            g_free (line);
-            continue;
-        }
 
-        // Complex Transaction Line.
-        line = make_complex_trans_line (acc, trans, split, info);
-
-        /* Write to file */
-        if (!write_line_to_file (fh, line))
-        {
-            info->failed = TRUE;
-            break;
-        }
-        g_free (line);
+            // Complex Transaction Line, followed by a Complex Split Line
+            // for each of the splits of the Transaction.
+            make_complex_trans_line (line, acc, trans, split, info);
 
-        /* Loop through the list of splits for the Transaction */
-        node = s_list;
-        cnt = 0;
-        while ((cnt < nSplits) && (info->failed == FALSE))
-        {
-            t_split = node->data;
+            node = s_list;
+            cnt = 0;
+            while (cnt < nSplits)
+            {
+                t_split = node->data;
+                make_complex_split_line (line, trans, t_split, info);
 
-            // Complex Split Line.
-            line = make_complex_split_line (trans, t_split, info);
+                cnt++;
+                node = node->next;
+            }
 
+            /* Write to file */
             if (!write_line_to_file (fh, line))
+            {
                 info->failed = TRUE;
-
-            g_free (line);
-
-            cnt++;
-            node = node->next;
+                break;
+            }
+            g_hash_table_insert (info->trans_hash, trans, trans); // add trans to trans_hash
         }
-        info->trans_list = g_list_prepend (info->trans_list, trans); // add trans to trans_list
+        g_list_free (batch);
     }
+    qof_query_cursor_free (cursor);
     if (info->export_type == XML_EXPORT_TRANS)
         qof_query_destroy (info->query);
-    g_list_free (splits);
 }
 
 
@@ -710,8 +599,12 @@ void csv_transactions_export (CsvExportInfo *info)
     if (fh != NULL)
     {
         gchar *header;
+        GString *line;
         int i;
 
+        /* Hand the rows to the file in large blocks. */
+        setvbuf (fh, NULL, _IOFBF, CSV_EXPORT_BUFFER_SIZE);
+
         /* Header string */
         if (info->simple_layout)
         {
@@ -737,13 +630,19 @@ void csv_transactions_export (CsvExportInfo *info)
         DEBUG("Header String: %s", header);
 
         /* Write header line */
-        if (!write_line_to_file (fh, header))
+        line = g_string_new (header);
+        g_free (header);
+        if (!write_line_to_file (fh, line))
         {
             info->failed = TRUE;
-            g_free (header);
+            g_string_free (line, TRUE);
+            fclose (fh);
             return;
         }
-        g_free (header);
+
+        info->trans_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+        info->account_names = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                     NULL, g_free);
 
         if (info->export_type == XML_EXPORT_TRANS)
         {
@@ -752,18 +651,23 @@ void csv_transactions_export (CsvExportInfo *info)
             {
                 acc = ptr->data;
                 DEBUG("Account being processed is : %s", xaccAccountGetName (acc));
-                account_splits (info, acc, fh);
+                account_splits (info, acc, fh, line);
             }
         }
         else
-            account_splits (info, info->account, fh);
+            account_splits (info, info->account, fh, line);
 
-        g_list_free (info->trans_list); // free trans_list
+        g_hash_table_destroy (info->trans_hash);
+        info->trans_hash = NULL;
+        g_hash_table_destroy (info->account_names);
+        info->account_names = NULL;
+        g_string_free (line, TRUE);
     }
     else
         info->failed = TRUE;
-    if (fh)
-        fclose (fh);
+    /* With the large buffer the last rows are only written here. */
+    if (fh && fclose (fh) != 0)
+        info->failed = TRUE;
     LEAVE("");
 }
 
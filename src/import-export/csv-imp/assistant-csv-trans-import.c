@@ -2621,6 +2621,7 @@ csv_import_trans_assistant_match_page_prepare (GtkAssistant *assistant,
                 transactions = g_list_next (transactions);
             }
             g_list_free (transactions);
+            gnc_gen_trans_list_create_matches (info->gnc_csv_importer_gui);
         }
     }
     /* Enable the Forward Assistant Button */
@@ -98,6 +98,38 @@ static StfParseOptions_t* default_parse_options (void)
     return options;
 }
 
+/* The date regular expressions are compiled once and shared by every
+ * cell parsed, rather than being recompiled for each date. */
+static regex_t date_regex;     /* A date with a year */
+static regex_t date_md_regex;  /* A date without a year */
+static gboolean regex_compiled = FALSE;
+
+static void
+compile_regex (void)
+{
+    regcomp (&date_regex, "^ *([0-9]+) *[-/.'] *([0-9]+) *[-/.'] *([0-9]+).*$|^ *([0-9][0-9][0-9][0-9][0-9][0-9][0-9][0-9]).*$", REG_EXTENDED);
+    regcomp (&date_md_regex, "^ *([0-9]+) *[-/.'] *([0-9]+).*$", REG_EXTENDED);
+    regex_compiled = TRUE;
+}
+
+/** Converts the digits of one matched date segment into an integer
+ * without copying it out of the date string first.
+ * @param date_str The string containing a date being parsed
+ * @param match The part of date_str holding the segment
+ * @return The value of the segment or -1 if it is too long to be one
+ */
+static int parse_date_segment (const char* date_str, const regmatch_t* match)
+{
+    int value = 0;
+    regoff_t i;
+
+    if (match->rm_eo - match->rm_so > 4)
+        return -1;
+    for (i = match->rm_so; i < match->rm_eo; i++)
+        value = value * 10 + g_ascii_digit_value (date_str[i]);
+    return value;
+}
+
 /** Parses a string into a date, given a format. The format must
  * include the year. This function should only be called by
  * parse_date.
@@ -110,24 +142,15 @@ static time64 parse_date_with_year (const char* date_str, int format)
     time64 rawtime; /* The integer time */
     struct tm retvalue, test_retvalue; /* The time in a broken-down structure */
 
-    int i, j, mem_length, orig_year = -1, orig_month = -1, orig_day = -1;
-
-    /* Buffer for containing individual parts (e.g. year, month, day) of a date */
-    char date_segment[5];
-
-    /* The compiled regular expression */
-    regex_t preg = {0};
+    int i, j, orig_year = -1, orig_month = -1, orig_day = -1;
 
     /* An array containing indices specifying the matched substrings in date_str */
     regmatch_t pmatch[4] = { {0}, {0}, {0}, {0} };
 
-    /* The regular expression for parsing dates */
-    const char* regex = "^ *([0-9]+) *[-/.'] *([0-9]+) *[-/.'] *([0-9]+).*$|^ *([0-9][0-9][0-9][0-9][0-9][0-9][0-9][0-9]).*$";
-
     /* We get our matches using the regular expression. */
-    regcomp (&preg, regex, REG_EXTENDED);
-    regexec (&preg, date_str, 4, pmatch, 0);
-    regfree (&preg);
+    if (!regex_compiled)
+        compile_regex ();
+    regexec (&date_regex, date_str, 4, pmatch, 0);
 
     /* If there wasn't a match, there was an error. */
     if (pmatch[0].rm_eo == 0)
@@ -184,19 +207,15 @@ static time64 parse_date_with_year (const char* date_str, int format)
         /* Only do something if this is a meaningful character */
         if (segment_type == 'y' || segment_type == 'm' || segment_type == 'd')
         {
-            /* Copy the matching substring into date_segment so that we can
-             * convert it into an integer. */
-            mem_length = pmatch[j].rm_eo - pmatch[j].rm_so;
-            memcpy (date_segment, date_str + pmatch[j].rm_so, mem_length);
-            date_segment[mem_length] = '\0';
-
             /* Set the appropriate member of retvalue. Save the original
              * values so that we can check if they change when we use gnc_mktime
              * below. */
             switch (segment_type)
             {
             case 'y':
-                retvalue.tm_year = atoi (date_segment);
+                retvalue.tm_year = parse_date_segment (date_str, &pmatch[j]);
+                if (retvalue.tm_year < 0)
+                    return -1;
 
                 /* Handle two-digit years. */
                 if (retvalue.tm_year < 100)
@@ -211,11 +230,11 @@ static time64 parse_date_with_year (const char* date_str, int format)
                 break;
 
             case 'm':
-                orig_month = retvalue.tm_mon = atoi (date_segment) - 1;
+                orig_month = retvalue.tm_mon = parse_date_segment (date_str, &pmatch[j]) - 1;
                 break;
 
             case 'd':
-                orig_day = retvalue.tm_mday = atoi (date_segment);
+                orig_day = retvalue.tm_mday = parse_date_segment (date_str, &pmatch[j]);
                 break;
             }
             j++;
@@ -255,24 +274,15 @@ static time64 parse_date_without_year (const char* date_str, int format)
     time64 rawtime; /* The integer time */
     struct tm retvalue, test_retvalue; /* The time in a broken-down structure */
 
-    int i, j, mem_length, orig_year = -1, orig_month = -1, orig_day = -1;
-
-    /* Buffer for containing individual parts (e.g. year, month, day) of a date */
-    gchar* date_segment;
-
-    /* The compiled regular expression */
-    regex_t preg = {0};
+    int i, j, orig_year = -1, orig_month = -1, orig_day = -1;
 
     /* An array containing indices specifying the matched substrings in date_str */
     regmatch_t pmatch[3] = { {0}, {0}, {0} };
 
-    /* The regular expression for parsing dates */
-    const char* regex = "^ *([0-9]+) *[-/.'] *([0-9]+).*$";
-
     /* We get our matches using the regular expression. */
-    regcomp (&preg, regex, REG_EXTENDED);
-    regexec (&preg, date_str, 3, pmatch, 0);
-    regfree (&preg);
+    if (!regex_compiled)
+        compile_regex ();
+    regexec (&date_md_regex, date_str, 3, pmatch, 0);
 
     /* If there wasn't a match, there was an error. */
     if (pmatch[0].rm_eo == 0)
@@ -299,27 +309,19 @@ static time64 parse_date_without_year (const char* date_str, int format)
         /* Only do something if this is a meaningful character */
         if (segment_type == 'm' || segment_type == 'd')
         {
-            /* Copy the matching substring into date_segment so that we can
-             * convert it into an integer. */
-            mem_length = pmatch[j].rm_eo - pmatch[j].rm_so;
-            date_segment = g_new (gchar, mem_length);
-            memcpy(date_segment, date_str + pmatch[j].rm_so, mem_length);
-            date_segment[mem_length] = '\0';
-
             /* Set the appropriate member of retvalue. Save the original
              * values so that we can check if they change when we use gnc_mktime
              * below. */
             switch (segment_type)
             {
             case 'm':
-                orig_month = retvalue.tm_mon = atoi (date_segment) - 1;
+                orig_month = retvalue.tm_mon = parse_date_segment (date_str, &pmatch[j]) - 1;
                 break;
 
             case 'd':
-                orig_day = retvalue.tm_mday = atoi (date_segment);
+                orig_day = retvalue.tm_mday = parse_date_segment (date_str, &pmatch[j]);
                 break;
             }
-            g_free (date_segment);
             j++;
         }
     }
@@ -400,7 +402,7 @@ void gnc_csv_parse_data_free (GncCsvParseData* parse_data)
         g_mapped_file_unref (parse_data->raw_mapping);
     }
 
-    if (parse_data->file_str.begin != NULL)
+    if (parse_data->file_str.begin != parse_data->raw_str.begin)
         g_free (parse_data->file_str.begin);
 
     if (parse_data->orig_lines != NULL)
@@ -448,13 +450,36 @@ int gnc_csv_convert_encoding (GncCsvParseData* parse_data, const char* encoding,
                              GError** error)
 {
     gsize bytes_read, bytes_written;
+    const gchar* invalid;
 
     /* If parse_data->file_str has already been initialized it must be
      * freed first. (This should always be the case, since
      * gnc_csv_load_file should always be called before this
-     * function.) */
-    if (parse_data->file_str.begin != NULL)
+     * function.) A file_str that shares the raw data is not ours to
+     * free. */
+    if (parse_data->file_str.begin != parse_data->raw_str.begin)
         g_free(parse_data->file_str.begin);
+    parse_data->file_str.begin = parse_data->file_str.end = NULL;
+
+    /* Data that is already valid UTF-8 is parsed straight out of the
+     * mapped file instead of being copied, which would double the
+     * memory an import of a large file needs. */
+    if (g_ascii_strcasecmp (encoding, "UTF-8") == 0 ||
+        g_ascii_strcasecmp (encoding, "UTF8") == 0)
+    {
+        if (!g_utf8_validate (parse_data->raw_str.begin,
+                              parse_data->raw_str.end - parse_data->raw_str.begin,
+                              &invalid))
+        {
+            g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+                         "%s", _("Invalid byte sequence in conversion input"));
+            return 1;
+        }
+        parse_data->file_str.begin = parse_data->raw_str.begin;
+        parse_data->file_str.end = parse_data->raw_str.end;
+        parse_data->encoding = (gchar*)encoding;
+        return 0;
+    }
 
     /* Do the actual translation to UTF-8. */
     parse_data->file_str.begin = g_convert (parse_data->raw_str.begin,
@@ -489,6 +514,14 @@ int gnc_csv_load_file (GncCsvParseData* parse_data, const char* filename,
 {
     const char* guess_enc = NULL;
 
+    /* Drop the data of a file loaded earlier. The converted data may
+     * point into its mapping, so it has to go first. */
+    if (parse_data->file_str.begin != parse_data->raw_str.begin)
+        g_free (parse_data->file_str.begin);
+    parse_data->file_str.begin = parse_data->file_str.end = NULL;
+    if (parse_data->raw_mapping != NULL)
+        g_mapped_file_unref (parse_data->raw_mapping);
+
     /* Get the raw data first and handle an error if one occurs. */
     parse_data->raw_mapping = g_mapped_file_new (filename, FALSE, NULL);
     if (parse_data->raw_mapping == NULL)
@@ -689,8 +722,6 @@ static gboolean trans_property_set (TransProperty* prop, char* str)
 {
     char *endptr, *possible_currency_symbol, *str_dupe;
     gnc_numeric val;
-    int reti;
-    regex_t regex;
     switch (prop->type)
     {
     case GNC_CSV_DATE:
@@ -715,9 +746,7 @@ static gboolean trans_property_set (TransProperty* prop, char* str)
     case GNC_CSV_WITHDRAWAL:
         str_dupe = g_strdup (str); /* First, we make a copy so we can't mess up real data. */
         /* If a cell is empty or just spaces make its value = "0" */
-        reti = regcomp(&regex, "[0-9]", 0);
-        reti = regexec(&regex, str_dupe, 0, NULL, 0);
-        if (reti == REG_NOMATCH)
+        if (strpbrk (str_dupe, "0123456789") == NULL)
         {
             g_free (str_dupe);
             str_dupe = g_strdup ("0");
@@ -837,18 +837,9 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                  TRUE, download_time + match_date_hardlimit * 86400,
                                  QOF_QUERY_AND);
         list_element = qof_query_run (query);
-        /* Sigh. Doesnt help too much. We still create and run one query
-           for each imported transaction. Maybe it would improve
-           performance further if there is one single (master-)query at
-           the beginning, matching the full date range and all accounts in
-           question. However, this doesnt quite work because this function
-           here is called from each gnc_gen_trans_list_add_trans(), which
-           is called one at a time. Therefore the whole importer would
-           have to change its behaviour: Accept the imported txns via
-           gnc_gen_trans_list_add_trans(), and only when
-           gnc_gen_trans_list_run() is called, then calculate all the
-           different match candidates. That's too much work for now.
-        */
+        /* This still runs one query per imported transaction; a whole
+           statement is better matched at once with
+           gnc_import_TransInfo_list_init_matches(). */
     }
 
     /* Traverse that list, calling split_find_match on each one. Note
@@ -865,6 +856,151 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
 }
 
 
+static gint
+compare_split_date (gconstpointer a, gconstpointer b)
+{
+    time64 ta = xaccTransGetDate (xaccSplitGetParent (*(Split * const *)a));
+    time64 tb = xaccTransGetDate (xaccSplitGetParent (*(Split * const *)b));
+    return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static gint
+compare_trans_info_date (gconstpointer a, gconstpointer b)
+{
+    GNCImportTransInfo *ia = *(GNCImportTransInfo * const *)a;
+    GNCImportTransInfo *ib = *(GNCImportTransInfo * const *)b;
+    time64 ta = xaccTransGetDate (gnc_import_TransInfo_get_trans (ia));
+    time64 tb = xaccTransGetDate (gnc_import_TransInfo_get_trans (ib));
+    return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/** /brief Find the matching splits of every TransInfo in the list.
+   This gives the same candidates as calling gnc_import_find_split_matches
+   on each of them, but runs a single query over all the import accounts
+   and the whole date range of the statement.  Each account's splits and
+   TransInfos are then sorted by date and joined in one sweep, so every
+   TransInfo only looks at the splits inside its own date window. */
+static void
+gnc_import_find_split_matches_list (GList *trans_info_list,
+                                    gint process_threshold,
+                                    double fuzzy_amount_difference,
+                                    gint match_date_hardlimit)
+{
+    const time64 window = (time64)match_date_hardlimit * 86400;
+    GHashTable *infos_by_account, *splits_by_account;
+    GHashTableIter hash_iter;
+    gpointer key, value;
+    GList *node, *accounts, *splits;
+    time64 min_time = G_MAXINT64, max_time = G_MININT64;
+    Query *query;
+
+    /* Group the imported transactions by the account they came in. */
+    infos_by_account = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                       NULL, (GDestroyNotify)g_ptr_array_unref);
+    for (node = trans_info_list; node; node = node->next)
+    {
+        GNCImportTransInfo *trans_info = node->data;
+        Account *account =
+            xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (trans_info));
+        time64 download_time =
+            xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+        GPtrArray *infos;
+
+        if (!account)
+            continue;
+        infos = g_hash_table_lookup (infos_by_account, account);
+        if (!infos)
+        {
+            infos = g_ptr_array_new ();
+            g_hash_table_insert (infos_by_account, account, infos);
+        }
+        g_ptr_array_add (infos, trans_info);
+        min_time = MIN (min_time, download_time);
+        max_time = MAX (max_time, download_time);
+    }
+
+    if (g_hash_table_size (infos_by_account) == 0)
+    {
+        g_hash_table_destroy (infos_by_account);
+        return;
+    }
+
+    /* One query covering every account and the whole date range. */
+    accounts = g_hash_table_get_keys (infos_by_account);
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, gnc_get_current_book ());
+    xaccQueryAddAccountMatch (query, accounts, QOF_GUID_MATCH_ANY,
+                              QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (query, TRUE, min_time - window,
+                             TRUE, max_time + window, QOF_QUERY_AND);
+    splits = qof_query_run (query);
+    g_list_free (accounts);
+
+    splits_by_account = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                        NULL, (GDestroyNotify)g_ptr_array_unref);
+    for (node = splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        Account *account = xaccSplitGetAccount (split);
+        GPtrArray *account_splits;
+
+        /* Just downloaded; split_find_match would skip it anyway. */
+        if (xaccTransIsOpen (xaccSplitGetParent (split)))
+            continue;
+        account_splits = g_hash_table_lookup (splits_by_account, account);
+        if (!account_splits)
+        {
+            account_splits = g_ptr_array_new ();
+            g_hash_table_insert (splits_by_account, account, account_splits);
+        }
+        g_ptr_array_add (account_splits, split);
+    }
+
+    g_hash_table_iter_init (&hash_iter, infos_by_account);
+    while (g_hash_table_iter_next (&hash_iter, &key, &value))
+    {
+        GPtrArray *infos = value;
+        GPtrArray *account_splits = g_hash_table_lookup (splits_by_account, key);
+        guint i, first = 0;
+
+        if (!account_splits)
+            continue;
+        g_ptr_array_sort (account_splits, compare_split_date);
+        g_ptr_array_sort (infos, compare_trans_info_date);
+
+        /* Both are in date order, so the start of each window only
+           ever moves forward. */
+        for (i = 0; i < infos->len; i++)
+        {
+            GNCImportTransInfo *trans_info = g_ptr_array_index (infos, i);
+            time64 download_time =
+                xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+            guint j;
+
+            while (first < account_splits->len &&
+                    xaccTransGetDate (xaccSplitGetParent (
+                                          g_ptr_array_index (account_splits, first)))
+                    < download_time - window)
+                first++;
+
+            for (j = first; j < account_splits->len; j++)
+            {
+                Split *split = g_ptr_array_index (account_splits, j);
+                if (xaccTransGetDate (xaccSplitGetParent (split))
+                        > download_time + window)
+                    break;
+                split_find_match (trans_info, split,
+                                  process_threshold, fuzzy_amount_difference);
+            }
+        }
+    }
+
+    g_hash_table_destroy (splits_by_account);
+    g_hash_table_destroy (infos_by_account);
+    qof_query_destroy (query);
+}
+
+
 /***********************************************************************
  */
 
@@ -1083,46 +1219,157 @@ gnc_import_process_trans_item (GncImportMatchMap *matchmap,
 }
 
 /********************************************************************\
- * check_trans_online_id() Callback function used by
- * gnc_import_exists_online_id.  Takes pointers to transaction and split,
- * returns 0 if their online_ids  do NOT match, or if the split
- * belongs to the transaction
+ * Online ID index
+ *
+ * For each account that has been checked for duplicates, a map from
+ * online_id to the transactions in the account carrying it.  It is
+ * built the first time the account is checked and then kept up to
+ * date from the QOF events of committed and destroyed transactions.
+ * Transactions that are still being imported are added by
+ * gnc_import_exists_online_id itself, since they raise no event until
+ * they are committed.
 \********************************************************************/
-static gint check_trans_online_id(Transaction *trans1, void *user_data)
+
+typedef struct
 {
     Account *account;
-    Split *split1;
-    Split *split2 = user_data;
-    const gchar *online_id1;
-    const gchar *online_id2;
-
-    account = xaccSplitGetAccount(split2);
-    split1 = xaccTransFindSplitByAccount(trans1, account);
-    if (split1 == split2)
-        return 0;
+    GHashTable *trans_by_id;    /* online_id -> GList of Transaction */
+    GHashTable *id_by_trans;    /* Transaction -> online_id */
+} OnlineIdIndex;
+
+static GHashTable *online_id_indexes = NULL; /* Account -> OnlineIdIndex */
+static gint online_id_event_handler_id = 0;
+
+static void
+online_id_index_free (OnlineIdIndex *index)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    g_hash_table_iter_init (&iter, index->trans_by_id);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+        g_list_free (value);
+    g_hash_table_destroy (index->trans_by_id);
+    g_hash_table_destroy (index->id_by_trans);
+    g_free (index);
+}
+
+/* The online_id a transaction has in the account: that of its split
+   there, or else the transaction's own, as check_trans_online_id used
+   to compare them. */
+static const gchar *
+online_id_for_account (Transaction *trans, Account *account)
+{
+    Split *split = xaccTransFindSplitByAccount (trans, account);
+
+    if (!split)
+        return NULL;
+    if (gnc_import_split_has_online_id (split))
+        return gnc_import_get_split_online_id (split);
+    return gnc_import_get_trans_online_id (trans);
+}
 
-    /* hack - we really want to iterate over the _splits_ of the account
-       instead of the transactions */
-    g_assert(split1 != NULL);
+static void
+online_id_index_remove (OnlineIdIndex *index, Transaction *trans)
+{
+    gchar *online_id = g_hash_table_lookup (index->id_by_trans, trans);
+    GList *list;
 
-    if (gnc_import_split_has_online_id(split1))
-        online_id1 = gnc_import_get_split_online_id(split1);
+    if (!online_id)
+        return;
+    list = g_hash_table_lookup (index->trans_by_id, online_id);
+    list = g_list_remove (list, trans);
+    if (list)
+        g_hash_table_insert (index->trans_by_id, g_strdup (online_id), list);
     else
-        online_id1 = gnc_import_get_trans_online_id(trans1);
+        g_hash_table_remove (index->trans_by_id, online_id);
+    g_hash_table_remove (index->id_by_trans, trans);
+}
 
-    online_id2 = gnc_import_get_split_online_id(split2);
+static void
+online_id_index_add (OnlineIdIndex *index, Transaction *trans)
+{
+    const gchar *online_id = online_id_for_account (trans, index->account);
+    GList *list;
+
+    online_id_index_remove (index, trans);
+    if (!online_id)
+        return;
+    list = g_hash_table_lookup (index->trans_by_id, online_id);
+    g_hash_table_insert (index->trans_by_id, g_strdup (online_id),
+                         g_list_prepend (list, trans));
+    g_hash_table_insert (index->id_by_trans, trans, g_strdup (online_id));
+}
+
+static gint
+online_id_index_add_cb (Transaction *trans, void *user_data)
+{
+    online_id_index_add (user_data, trans);
+    return 0;
+}
+
+static void
+online_id_event_handler (QofInstance *ent, QofEventId event_type,
+                         gpointer handler_data, gpointer event_data)
+{
+    GHashTableIter iter;
+    gpointer value;
 
-    if ((online_id1 == NULL) ||
-            (online_id2 == NULL) ||
-            (strcmp(online_id1, online_id2) != 0))
+    if (GNC_IS_ACCOUNT (ent))
     {
-        return 0;
+        if (event_type & QOF_EVENT_DESTROY)
+            g_hash_table_remove (online_id_indexes, ent);
+        return;
     }
-    else
+    if (!GNC_IS_TRANS (ent) ||
+            !(event_type & (QOF_EVENT_MODIFY | QOF_EVENT_DESTROY)))
+        return;
+
+    /* Still being edited; it is looked at again when committed. */
+    if (!(event_type & QOF_EVENT_DESTROY) && xaccTransIsOpen ((Transaction*)ent))
+        return;
+
+    /* The transaction's splits may have moved between accounts, so
+       look it up in every index.  There is one per import account. */
+    g_hash_table_iter_init (&iter, online_id_indexes);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        OnlineIdIndex *index = value;
+
+        if (event_type & QOF_EVENT_DESTROY)
+            online_id_index_remove (index, (Transaction*)ent);
+        else
+            online_id_index_add (index, (Transaction*)ent);
+    }
+}
+
+static OnlineIdIndex *
+online_id_index_get (Account *account)
+{
+    OnlineIdIndex *index;
+
+    if (!online_id_indexes)
     {
-        /*printf("test_trans_online_id(): Duplicate found\n");*/
-        return 1;
+        online_id_indexes =
+            g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                   (GDestroyNotify)online_id_index_free);
+        online_id_event_handler_id =
+            qof_event_register_handler (online_id_event_handler, NULL);
     }
+
+    index = g_hash_table_lookup (online_id_indexes, account);
+    if (index)
+        return index;
+
+    index = g_new0 (OnlineIdIndex, 1);
+    index->account = account;
+    index->trans_by_id = g_hash_table_new_full (g_str_hash, g_str_equal,
+                         g_free, NULL);
+    index->id_by_trans = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                         NULL, g_free);
+    xaccAccountForEachTransaction (account, online_id_index_add_cb, index);
+    g_hash_table_insert (online_id_indexes, account, index);
+    return index;
 }
 
 /** Checks whether the given transaction's online_id already exists in
@@ -1132,6 +1379,8 @@ gboolean gnc_import_exists_online_id (Transaction *trans)
     gboolean online_id_exists = FALSE;
     Account *dest_acct;
     Split *source_split;
+    OnlineIdIndex *index;
+    const gchar *online_id;
 
     /* Look for an online_id in the first split */
     source_split = xaccTransGetSplit(trans, 0);
@@ -1139,9 +1388,19 @@ gboolean gnc_import_exists_online_id (Transaction *trans)
 
     /* DEBUG("%s%d%s","Checking split ",i," for duplicates"); */
     dest_acct = xaccSplitGetAccount(source_split);
-    online_id_exists = xaccAccountForEachTransaction(dest_acct,
-                       check_trans_online_id,
-                       source_split);
+    index = online_id_index_get (dest_acct);
+    online_id = gnc_import_get_split_online_id(source_split);
+    if (online_id)
+    {
+        GList *node = g_hash_table_lookup (index->trans_by_id, online_id);
+
+        for (; node; node = node->next)
+            if (node->data != trans)
+            {
+                online_id_exists = TRUE;
+                break;
+            }
+    }
 
     /* If it does, abort the process for this transaction, since it is
        already in the system. */
@@ -1151,6 +1410,12 @@ gboolean gnc_import_exists_online_id (Transaction *trans)
         xaccTransDestroy(trans);
         xaccTransCommitEdit(trans);
     }
+    else
+    {
+        /* Later transactions of the same import are checked against
+           this one too. */
+        online_id_index_add (index, trans);
+    }
     return online_id_exists;
 }
 
@@ -1191,23 +1456,14 @@ static gint compare_probability (gconstpointer a,
            ((GNCImportMatchInfo *)a)->probability);
 }
 
-/** Iterates through all splits of the originating account of
- * trans_info. Sorts the resulting list and sets the selected_match
- * and action fields in the trans_info.
+/** Sorts the match list of trans_info and sets the selected_match and
+ * action fields from it.
  */
-void
-gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
-                                   GNCImportSettings *settings)
+static void
+gnc_import_TransInfo_select_best_match (GNCImportTransInfo *trans_info,
+                                        GNCImportSettings *settings)
 {
     GNCImportMatchInfo * best_match = NULL;
-    g_assert (trans_info);
-
-
-    /* Find all split matches in originating account. */
-    gnc_import_find_split_matches(trans_info,
-                                  gnc_import_Settings_get_display_threshold (settings),
-                                  gnc_import_Settings_get_fuzzy_amount (settings),
-                                  gnc_import_Settings_get_match_date_hardlimit (settings));
 
     if (trans_info->match_list != NULL)
     {
@@ -1258,6 +1514,38 @@ gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
     trans_info->previous_action = trans_info->action;
 }
 
+/** Iterates through all splits of the originating account of
+ * trans_info. Sorts the resulting list and sets the selected_match
+ * and action fields in the trans_info.
+ */
+void
+gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
+                                   GNCImportSettings *settings)
+{
+    g_assert (trans_info);
+
+    /* Find all split matches in originating account. */
+    gnc_import_find_split_matches(trans_info,
+                                  gnc_import_Settings_get_display_threshold (settings),
+                                  gnc_import_Settings_get_fuzzy_amount (settings),
+                                  gnc_import_Settings_get_match_date_hardlimit (settings));
+    gnc_import_TransInfo_select_best_match (trans_info, settings);
+}
+
+void
+gnc_import_TransInfo_list_init_matches (GList *trans_info_list,
+                                        GNCImportSettings *settings)
+{
+    GList *node;
+
+    gnc_import_find_split_matches_list (trans_info_list,
+                                        gnc_import_Settings_get_display_threshold (settings),
+                                        gnc_import_Settings_get_fuzzy_amount (settings),
+                                        gnc_import_Settings_get_match_date_hardlimit (settings));
+    for (node = trans_info_list; node; node = node->next)
+        gnc_import_TransInfo_select_best_match (node->data, settings);
+}
+
 
 /* Try to automatch a transaction to a destination account if the */
 /* transaction hasn't already been manually assigned to another account */
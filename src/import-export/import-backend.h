@@ -100,6 +100,18 @@ void
 gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
                                    GNCImportSettings *settings);
 
+/** Does gnc_import_TransInfo_init_matches for every TransInfo in the
+ * list, finding the candidate splits of all of them with a single
+ * query instead of one query per transaction.
+ *
+ * @param trans_info_list A GList of GNCImportTransInfo.
+ *
+ * @param settings The structure that holds all the user preferences.
+ */
+void
+gnc_import_TransInfo_list_init_matches (GList *trans_info_list,
+                                        GNCImportSettings *settings);
+
 /** This function is intended to be called when the importer dialog is
  * finished. It should be called once for each imported transaction
  * and processes each ImportTransInfo according to its selected action:
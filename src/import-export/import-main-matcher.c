@@ -43,6 +43,8 @@
 #include "gnc-ui.h"
 #include "gnc-ui-util.h"
 #include "gnc-engine.h"
+#include "Account.h"
+#include "TransLog.h"
 #include "import-settings.h"
 #include "import-match-picker.h"
 #include "import-backend.h"
@@ -63,6 +65,8 @@ struct _main_matcher_info
     int selected_row;
     GNCTransactionProcessedCB transaction_processed_cb;
     gpointer user_data;
+    /* Transactions added but not matched yet, newest first. */
+    GList *temp_trans_list;
 };
 
 enum downloaded_cols
@@ -108,6 +112,7 @@ void gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
     GtkTreeModel *model;
     GtkTreeIter iter;
     GNCImportTransInfo *trans_info;
+    GList *iter_node;
 
     if (info == NULL)
         return;
@@ -133,6 +138,19 @@ void gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
         while (gtk_tree_model_iter_next (model, &iter));
     }
 
+    for (iter_node = info->temp_trans_list; iter_node; iter_node = iter_node->next)
+    {
+        trans_info = iter_node->data;
+        if (info->transaction_processed_cb)
+        {
+            info->transaction_processed_cb(trans_info,
+                                           FALSE,
+                                           info->user_data);
+        }
+        gnc_import_TransInfo_delete(trans_info);
+    }
+    g_list_free (info->temp_trans_list);
+
 
     if (!(info->dialog == NULL))
     {
@@ -152,6 +170,7 @@ on_matcher_ok_clicked (GtkButton *button,
     GtkTreeModel *model;
     GtkTreeIter iter;
     GNCImportTransInfo *trans_info;
+    QofBackend *be;
 
     g_assert (info);
 
@@ -164,6 +183,15 @@ on_matcher_ok_clicked (GtkButton *button,
     /* Don't run any queries and/or split sorts while processing the matcher
     results. */
     gnc_suspend_gui_refresh();
+    /* Let an SQL backend store the whole import in one transaction. */
+    be = qof_book_get_backend (gnc_get_current_book ());
+    qof_backend_begin_group_commit (be);
+    /* Sort the affected accounts and recompute their balances once,
+       after the whole statement has been applied, instead of once per
+       transaction. */
+    gnc_account_begin_bulk_ingest (gnc_get_current_book ());
+    /* Flush the transaction log once for the statement, too. */
+    xaccLogBeginBatch ();
 
     do
     {
@@ -183,6 +211,9 @@ on_matcher_ok_clicked (GtkButton *button,
     }
     while (gtk_tree_model_iter_next (model, &iter));
 
+    xaccLogEndBatch ();
+    gnc_account_end_bulk_ingest (gnc_get_current_book ());
+    qof_backend_end_group_commit (be);
     /* Allow GUI refresh again. */
     gnc_resume_gui_refresh();
 
@@ -639,6 +670,7 @@ GNCImportMainMatcher * gnc_gen_trans_assist_new (GtkWidget *parent,
 
 void gnc_gen_trans_assist_start (GNCImportMainMatcher *info)
 {
+    gnc_gen_trans_list_create_matches (info);
     on_matcher_ok_clicked (NULL, info);
 }
 
@@ -659,6 +691,7 @@ gboolean gnc_gen_trans_list_run (GNCImportMainMatcher *info)
     gboolean result;
 
     /* DEBUG("Begin"); */
+    gnc_gen_trans_list_create_matches (info);
     result = gtk_dialog_run (GTK_DIALOG (info->dialog));
     /* DEBUG("Result was %d", result); */
 
@@ -903,16 +936,39 @@ void gnc_gen_trans_list_add_trans_with_ref_id(GNCImportMainMatcher *gui, Transac
         transaction_info = gnc_import_TransInfo_new(trans, NULL);
         gnc_import_TransInfo_set_ref_id(transaction_info, ref_id);
 
-        gnc_import_TransInfo_init_matches(transaction_info,
-                                          gui->user_settings);
-
-        model = gtk_tree_view_get_model(gui->view);
-        gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-        refresh_model_row (gui, model, &iter, transaction_info);
+        /* Matching is done for all of them at once, in
+           gnc_gen_trans_list_create_matches(). */
+        gui->temp_trans_list = g_list_prepend (gui->temp_trans_list,
+                                               transaction_info);
     }
     return;
 }/* end gnc_import_add_trans_with_ref_id() */
 
+void gnc_gen_trans_list_create_matches (GNCImportMainMatcher *gui)
+{
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    GList *node;
+    g_assert (gui);
+
+    if (gui->temp_trans_list == NULL)
+        return;
+
+    /* Keep the rows in the order the transactions were added. */
+    gui->temp_trans_list = g_list_reverse (gui->temp_trans_list);
+    gnc_import_TransInfo_list_init_matches (gui->temp_trans_list,
+                                            gui->user_settings);
+
+    model = gtk_tree_view_get_model(gui->view);
+    for (node = gui->temp_trans_list; node; node = node->next)
+    {
+        gtk_list_store_append(GTK_LIST_STORE(model), &iter);
+        refresh_model_row (gui, model, &iter, node->data);
+    }
+    g_list_free (gui->temp_trans_list);
+    gui->temp_trans_list = NULL;
+}
+
 /* Iterate through the rows of the clist and try to automatch each of them */
 static void
 automatch_store_transactions (GNCImportMainMatcher *info,
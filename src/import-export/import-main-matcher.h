@@ -166,6 +166,18 @@ void gnc_gen_trans_list_add_trans(GNCImportMainMatcher *gui, Transaction *trans)
 void gnc_gen_trans_list_add_trans_with_ref_id(GNCImportMainMatcher *gui, Transaction *trans, guint32 ref_id);
 
 
+/** Find the matches of all the transactions added since the last call
+ * and show them in the list.  This is done with one query for all of
+ * them, so callers should add the whole statement first.  It is done
+ * automatically by gnc_gen_trans_list_run() and
+ * gnc_gen_trans_assist_start(); a non-modal matcher must call it once
+ * its transactions have been added.
+ *
+ * @param gui The Transaction Importer to use.
+ */
+void gnc_gen_trans_list_create_matches (GNCImportMainMatcher *gui);
+
+
 /** Run this dialog and return only after the user pressed Ok, Cancel,
   or closed the window. This means that all actual importing will
   have been finished upon returning.
@@ -42,6 +42,7 @@
 #include "qof.h"
 #include "gnc-ui-util.h"
 #include "gnc-gui-query.h"
+#include "gnc-component-manager.h"
 
 #define GNC_PREFS_GROUP "dialogs.log-replay"
 
@@ -634,6 +635,15 @@ void gnc_file_log_replay (void)
                     }
                     else
                     {
+                        QofBook *book = gnc_get_current_book();
+                        QofBackend *be = qof_book_get_backend(book);
+
+                        /* Replay the whole log as one batch: no GUI
+                         * refreshes, one backend transaction, and each
+                         * account sorted and rebalanced once at the end. */
+                        gnc_suspend_gui_refresh();
+                        qof_backend_begin_group_commit(be);
+                        gnc_account_begin_bulk_ingest(book);
                         do
                         {
                             read_retval = fgets(read_buf, sizeof(read_buf), log_file);
@@ -644,6 +654,9 @@ void gnc_file_log_replay (void)
                             }
                         }
                         while (feof(log_file) == 0);
+                        gnc_account_end_bulk_ingest(book);
+                        qof_backend_end_group_commit(be);
+                        gnc_resume_gui_refresh();
                     }
                 }
                 fclose(log_file);
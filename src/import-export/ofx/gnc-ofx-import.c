@@ -1013,6 +1013,9 @@ void gnc_file_ofx_import (void)
         DEBUG("Opening selected file");
         libofx_proc_file(libofx_context, selected_filename, AUTODETECT);
         g_free(selected_filename);
+
+        /* Match the whole statement now that it has been read. */
+        gnc_gen_trans_list_create_matches (gnc_ofx_importer_gui);
     }
 
     if (ofx_created_commodites)
@@ -3649,9 +3649,18 @@ gnc_ui_qif_import_assistant_close_handler( gpointer user_data )
 void
 gnc_file_qif_import(void)
 {
+    static gboolean scm_loaded = FALSE;
     QIFImportWindow *qif_win;
     gint component_id;
 
+    /* Loading the importer's Scheme code takes a while, so it isn't
+     * done at startup but when it is first used. */
+    if (!scm_loaded)
+    {
+        scm_c_eval_string("(use-modules (gnucash import-export qif-import))");
+        scm_loaded = TRUE;
+    }
+
     qif_win = g_new0 (QIFImportWindow, 1);
 
     /* pop up the QIF File Import dialog box */
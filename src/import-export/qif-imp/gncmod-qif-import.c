@@ -86,8 +86,8 @@ libgncmod_qif_import_gnc_module_init(int refcount)
         ((void (*)())gnc_file_qif_import);
     }
 
-    scm_c_eval_string("(use-modules (gnucash import-export qif-import))");
-
+    /* The Scheme side is loaded by gnc_file_qif_import, the first time
+     * it is needed. */
     gnc_plugin_qif_import_create_plugin();
 
     return TRUE;
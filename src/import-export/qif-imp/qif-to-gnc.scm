@@ -373,16 +373,32 @@
       (if progress-dialog
           (gnc-progress-dialog-set-sub progress-dialog
                                     (_ "Matching transfers between accounts")))
+      ;; A transaction can only match one that was recorded in the
+      ;; account it transfers to, so index the candidates by their
+      ;; account instead of scanning all of them for every split.
+      ;; Each list is kept in markable-xtns order and a transaction
+      ;; is popped off its list when the loop reaches it, so the index
+      ;; only ever holds the transactions after the current one.
       (if (> (length markable-xtns) 1)
-          (let xloop ((xtn (car markable-xtns))
-                      (rest (cdr markable-xtns)))
-            ;; Update the progress.
-            (update-progress)
-
-            (if (not (qif-xtn:mark xtn))
-                (qif-import:mark-matching-xtns xtn rest))
-            (if (not (null? (cdr rest)))
-                (xloop (car rest) (cdr rest)))))
+          (let ((xtn-index (make-hash-table)))
+            (for-each
+             (lambda (xtn)
+               (let ((acct (qif-xtn:from-acct xtn)))
+                 (hash-set! xtn-index acct
+                            (cons xtn (hash-ref xtn-index acct '())))))
+             (reverse markable-xtns))
+
+            (let xloop ((xtn (car markable-xtns))
+                        (rest (cdr markable-xtns)))
+              ;; Update the progress.
+              (update-progress)
+
+              (let ((acct (qif-xtn:from-acct xtn)))
+                (hash-set! xtn-index acct (cdr (hash-ref xtn-index acct))))
+              (if (not (qif-xtn:mark xtn))
+                  (qif-import:mark-matching-xtns xtn xtn-index))
+              (if (not (null? (cdr rest)))
+                  (xloop (car rest) (cdr rest))))))
 
       ;; Iterate over files. Going in the sort order by number of
       ;; transactions should give us a small speed advantage.
@@ -816,10 +832,12 @@
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  qif-import:mark-matching-xtns
 ;;  find transactions that are the "opposite half" of xtn and
-;;  mark them so they won't be imported.
+;;  mark them so they won't be imported.  candidate-index maps
+;;  each QIF account name to the candidate transactions recorded
+;;  in that account.
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
-(define (qif-import:mark-matching-xtns xtn candidate-xtns)
+(define (qif-import:mark-matching-xtns xtn candidate-index)
   (let splitloop ((splits-left (qif-xtn:splits xtn)))
 
     ;; splits-left starts out as all the splits of this transaction.
@@ -831,7 +849,7 @@
                  (qif-split:category-is-account? (car splits-left)))
             (set! splits-left
                   (qif-import:mark-some-splits
-                   splits-left xtn candidate-xtns))
+                   splits-left xtn candidate-index))
             (set! splits-left (cdr splits-left))))
 
     (if (not (null? splits-left))
@@ -844,7 +862,7 @@
 ;; don't get imported.
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
-(define (qif-import:mark-some-splits splits xtn candidate-xtns)
+(define (qif-import:mark-some-splits splits xtn candidate-index)
   (let* ((n- (lambda (n) (gnc-numeric-neg n)))
          (nsub (lambda (a b) (gnc-numeric-sub a b 0 GNC-DENOM-LCD)))
          (n+ (lambda (a b) (gnc-numeric-add a b 0 GNC-DENOM-LCD)))
@@ -916,11 +934,11 @@
                 ((xout)
                  (set! amount (n- amount)))))))
 
-    ;; this is the grind loop.  Go over every unmarked transaction in
-    ;; the candidate-xtns list.
-    (let xtn-loop ((xtns candidate-xtns))
-      (if (and (not (qif-xtn:mark (car xtns)))
-               (string=? (qif-xtn:from-acct (car xtns)) far-acct-name))
+    ;; this is the grind loop.  Go over every unmarked candidate
+    ;; transaction from the far account.
+    (let xtn-loop ((xtns (hash-ref candidate-index far-acct-name '())))
+      (if (and (not (null? xtns))
+               (not (qif-xtn:mark (car xtns))))
           (begin
             (set! how
                   (qif-import:xtn-has-matches? (car xtns) near-acct-name
@@ -932,6 +950,7 @@
                   (set! done #t)))))
       ;; iterate with the next transaction
       (if (and (not done)
+               (not (null? xtns))
                (not (null? (cdr xtns))))
           (xtn-loop (cdr xtns))))
 
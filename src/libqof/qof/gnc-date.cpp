@@ -114,7 +114,7 @@ gnc_localtime_r (const time64 *secs, struct tm* time)
 {
     try
     {
-	*time = static_cast<struct tm>(GncDateTime(*secs));
+	*time = GncDateTime::local_tm(*secs);
 	return time;
     }
     catch(std::invalid_argument)
@@ -204,8 +204,7 @@ gnc_mktime (struct tm* time)
     try
     {
 	normalize_struct_tm (time);
-	GncDateTime gncdt(*time);
-	return static_cast<time64>(gncdt) - gncdt.offset();
+	return GncDateTime::local_time64(*time);
     }
     catch(std::invalid_argument)
     {
@@ -1142,11 +1141,99 @@ gnc_date_timestamp (void)
  */
 
 #define ISO_DATE_FORMAT "%d-%d-%d %d:%d:%lf%s"
+
+/* The backends read and write every timestamp in a book, always in the
+ * same few shapes, so those are parsed and printed by hand here; only
+ * other input goes through GncDateTime's stream parser. */
+
+/* Days from 1970-01-01 to the proleptic Gregorian date, after
+ * H. Hinnant's days-from-civil algorithm; year must be positive. */
+static time64
+iso8601_days_from_civil (int year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+    const int era = year / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return static_cast<time64>(era) * 146097 + doe - 719468;
+}
+
+static bool
+iso8601_digits (const char*& p, int count, int& value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p)
+    {
+        if (*p < '0' || *p > '9')
+            return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+/* Parse "YYYY-MM-DD HH:MM:SS", with optional fractional seconds, which
+ * are dropped, and an optional " +HHMM", " +HH:MM" or " +HH" offset;
+ * without one the time is UTC.  Returns false for anything else. */
+static bool
+iso8601_parse_fast (const char* p, time64& secs)
+{
+    int year, month, day, hour, min, sec, off_hour = 0, off_min = 0;
+
+    if (!(iso8601_digits (p, 4, year) && *p++ == '-' &&
+          iso8601_digits (p, 2, month) && *p++ == '-' &&
+          iso8601_digits (p, 2, day) && *p++ == ' ' &&
+          iso8601_digits (p, 2, hour) && *p++ == ':' &&
+          iso8601_digits (p, 2, min) && *p++ == ':' &&
+          iso8601_digits (p, 2, sec)))
+        return false;
+    if (*p == '.')
+        for (++p; *p >= '0' && *p <= '9'; ++p)
+            ;
+    if (*p == ' ')
+    {
+        ++p;
+        int sign = *p == '-' ? -1 : *p == '+' ? 1 : 0;
+        if (!sign || !iso8601_digits (++p, 2, off_hour))
+            return false;
+        if (*p == ':')
+            ++p;
+        if (*p && !iso8601_digits (p, 2, off_min))
+            return false;
+        off_hour *= sign;
+        off_min *= sign;
+    }
+    if (*p)
+        return false;
+
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    static const int mdays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1400 || month < 1 || month > 12 || day < 1 ||
+        day > mdays[month - 1] + (month == 2 && leap ? 1 : 0) ||
+        hour > 23 || min > 59 || sec > 59 || off_hour > 14 ||
+        off_hour < -14 || off_min > 59 || off_min < -59)
+        return false;
+
+    secs = iso8601_days_from_civil (year, month, day) * 86400 +
+           hour * 3600 + min * 60 + sec - off_hour * 3600 - off_min * 60;
+    return true;
+}
+
+static char*
+iso8601_put_digits (char* p, int value, int count)
+{
+    for (int i = count - 1; i >= 0; --i, value /= 10)
+        p[i] = '0' + value % 10;
+    return p + count;
+}
+
 Timespec
 gnc_iso8601_to_timespec_gmt(const char *cstr)
 {
     time64 time;
     if (!cstr) return {0, 0};
+    if (iso8601_parse_fast (cstr, time))
+        return {time, 0};
     try
     {
         GncDateTime gncdt(cstr);
@@ -1169,6 +1256,34 @@ gnc_timespec_to_iso8601_buff (Timespec ts, char * buff)
 
     if (! buff) return NULL;
 
+    struct tm tm;
+    if (gnc_localtime_r (&ts.tv_sec, &tm))
+    {
+        /* "YYYY-MM-DD HH:MM:SS.000000 +HHMM", as the format below gives */
+        auto offset = iso8601_days_from_civil (tm.tm_year + 1900,
+                                               tm.tm_mon + 1, tm.tm_mday) * 86400 +
+                      tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec - ts.tv_sec;
+        auto p = iso8601_put_digits (buff, tm.tm_year + 1900, 4);
+        *p++ = '-';
+        p = iso8601_put_digits (p, tm.tm_mon + 1, 2);
+        *p++ = '-';
+        p = iso8601_put_digits (p, tm.tm_mday, 2);
+        *p++ = ' ';
+        p = iso8601_put_digits (p, tm.tm_hour, 2);
+        *p++ = ':';
+        p = iso8601_put_digits (p, tm.tm_min, 2);
+        *p++ = ':';
+        p = iso8601_put_digits (p, tm.tm_sec, 2);
+        memcpy (p, ".000000 ", 8);
+        p += 8;
+        *p++ = offset < 0 ? '-' : '+';
+        offset = offset < 0 ? -offset : offset;
+        p = iso8601_put_digits (p, offset / 3600, 2);
+        p = iso8601_put_digits (p, offset % 3600 / 60, 2);
+        *p = '\0';
+        return p;
+    }
+
     GncDateTime gncdt(ts.tv_sec);
     auto sstr = gncdt.format(format);
 
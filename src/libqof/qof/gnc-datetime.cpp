@@ -29,7 +29,9 @@ extern "C"
 }
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <sstream>
 #include "gnc-timezone.hpp"
@@ -129,6 +131,95 @@ LDT_from_struct_tm(const struct tm tm)
     }
 }
 
+/* The offsets of the local time zone for one year: the zone that
+ * tzp.get() gives for the year, with its daylight-saving rule evaluated
+ * for that year.  The DST bounds are in local standard time, which is
+ * how boost::local_time decides whether DST is in effect.
+ */
+struct TZYear
+{
+    std::atomic<bool> ready;
+    bool has_dst;
+    long base;
+    long dst;
+    time64 dst_start;
+    time64 dst_end;
+};
+
+static constexpr int tz_min_year = 1400;
+static constexpr int tz_max_year = 9999;
+static TZYear tz_years[tz_max_year - tz_min_year + 1];
+static std::mutex tz_years_mutex;
+
+/* The proleptic Gregorian year of seconds from the POSIX epoch, after
+ * H. Hinnant's days-to-civil algorithm. */
+static int
+unix_year(const time64 time)
+{
+    auto days = time / 86400 - (time % 86400 < 0 ? 1 : 0) + 719468;
+    auto era = (days >= 0 ? days : days - 146096) / 146097;
+    auto doe = days - era * 146097;
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    return static_cast<int>(yoe + era * 400 + (mp >= 10 ? 1 : 0));
+}
+
+static const TZYear&
+tz_year(const int year)
+{
+    if (year < tz_min_year || year > tz_max_year)
+        throw(std::invalid_argument("Time value is outside the supported year range."));
+    auto& zone = tz_years[year - tz_min_year];
+    if (zone.ready.load(std::memory_order_acquire))
+        return zone;
+
+    std::lock_guard<std::mutex> lock(tz_years_mutex);
+    if (!zone.ready.load(std::memory_order_relaxed))
+    {
+        auto tz = tzp.get(year);
+        zone.base = tz->base_utc_offset().total_seconds();
+        zone.has_dst = tz->has_dst();
+        if (zone.has_dst)
+        {
+            zone.dst = tz->dst_offset().total_seconds();
+            zone.dst_start = (tz->dst_local_start_time(year) -
+                              unix_epoch).total_seconds();
+            zone.dst_end = (tz->dst_local_end_time(year) -
+                            unix_epoch).total_seconds() - zone.dst;
+        }
+        zone.ready.store(true, std::memory_order_release);
+    }
+    return zone;
+}
+
+/* The UTC offset that an LDT for time would have, and whether it is
+ * daylight-saving time. */
+static long
+local_offset(const time64 time, bool& is_dst)
+{
+    auto year = unix_year(time);
+    auto& zone = tz_year(year);
+    is_dst = false;
+    if (!zone.has_dst)
+        return zone.base;
+
+    auto local = time + zone.base;
+    /* Within a few hours of New Year boost evaluates the DST rule for
+     * the other year; leave that to it. */
+    if (unix_year(local) != year)
+    {
+        auto ldt = LDT_from_unix_local(time);
+        is_dst = ldt.is_dst();
+        return (ldt.local_time() - ldt.utc_time()).total_seconds();
+    }
+    if (zone.dst_start <= zone.dst_end)
+        is_dst = local >= zone.dst_start && local < zone.dst_end;
+    else // Southern hemisphere, DST spans the new year
+        is_dst = local >= zone.dst_start || local < zone.dst_end;
+    return is_dst ? zone.base + zone.dst : zone.base;
+}
+
 class GncDateTimeImpl
 {
 public:
@@ -304,6 +395,40 @@ GncDateTime::utc_tm() const
     return m_impl->utc_tm();
 }
 
+struct tm
+GncDateTime::local_tm(const time64 time)
+{
+    bool is_dst;
+    auto offset = local_offset(time, is_dst);
+    auto local = time + offset;
+    struct tm tm = to_tm(PTime(unix_epoch.date(),
+                               boost::posix_time::hours(local / 3600) +
+                               boost::posix_time::seconds(local % 3600)));
+    tm.tm_isdst = is_dst ? 1 : 0;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = offset;
+#endif
+    return tm;
+}
+
+time64
+GncDateTime::local_time64(const struct tm& tm)
+{
+    try
+    {
+        auto tdate = boost::gregorian::date_from_tm(tm);
+        auto tdur = boost::posix_time::time_duration(tm.tm_hour, tm.tm_min,
+                                                     tm.tm_sec, 0);
+        auto secs = (PTime(tdate, tdur) - unix_epoch).total_seconds();
+        bool is_dst;
+        return secs - local_offset(secs, is_dst);
+    }
+    catch(boost::gregorian::bad_year)
+    {
+        throw(std::invalid_argument("Time value is outside the supported year range."));
+    }
+}
+
 GncDate
 GncDateTime::date() const
 {
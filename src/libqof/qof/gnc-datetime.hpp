@@ -144,6 +144,22 @@ public:
  * @return struct tm
  */
     struct tm utc_tm() const;
+/** Convert seconds from the POSIX epoch to a struct tm in the current
+ * timezone, giving the same result as casting GncDateTime(time) to a
+ * struct tm. The UTC offset comes from a table of the timezone's
+ * per-year offsets and daylight-saving transitions that is filled on
+ * first use, so no GncDateTime is constructed.
+ * @param time: Seconds from the POSIX epoch.
+ * @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static struct tm local_tm(const time64 time);
+/** The inverse of local_tm: convert a struct tm in the current timezone
+ * to seconds from the POSIX epoch, as the time64 of GncDateTime(tm)
+ * less its offset(), from the same table.
+ * @param tm: A normalized struct tm; the timezone fields are ignored.
+ * @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static time64 local_time64(const struct tm& tm);
 /** Obtain the date from the time, as a GncDate, in the current timezone.
  *  @return GncDate represented by the GncDateTime.
  */
@@ -42,6 +42,22 @@ namespace {
     static const unsigned int sublegs = GncInt128::numlegs * 2;
     static const unsigned int sublegbits = GncInt128::legbits / 2;
     static const uint64_t sublegmask = (UINT64_C(1) << sublegbits) - 1;
+
+/* GCC and Clang provide a native 128-bit integer on 64-bit targets; the
+ * compiler then emits the hardware multiply and the runtime's 128/64
+ * division in place of the Knuth algorithms below, which remain for
+ * other compilers.
+ */
+#if defined(__SIZEOF_INT128__) && !defined(GNC_INT128_PORTABLE)
+#define GNC_INT128_NATIVE 1
+    __extension__ typedef unsigned __int128 native_uint128;
+
+    inline native_uint128
+    to_native (uint64_t hi, uint64_t lo) noexcept
+    {
+        return (static_cast<native_uint128>(hi) << GncInt128::legbits) | lo;
+    }
+#endif
 }
 
 GncInt128::GncInt128 () : m_flags {}, m_hi {0}, m_lo {0}{}
@@ -417,6 +433,14 @@ GncInt128::operator*= (const GncInt128& b) noexcept
         return *this;
     }
 
+#ifdef GNC_INT128_NATIVE
+    /* The bit count check above guarantees the product fits. */
+    auto prod = to_native (m_hi, m_lo) * to_native (b.m_hi, b.m_lo);
+    m_hi = static_cast<uint64_t>(prod >> legbits);
+    m_lo = static_cast<uint64_t>(prod);
+    return *this;
+#else
+
 /* This is Knuth's "classical" multi-precision multiplication algorithm
  * truncated to a GncInt128 result with the loop unrolled for clarity and with
  * overflow and zero checks beforehand to save time. See Donald Knuth, "The Art
@@ -474,8 +498,10 @@ GncInt128::operator*= (const GncInt128& b) noexcept
         return *this;
     }
     return *this;
+#endif
 }
 
+#ifndef GNC_INT128_NATIVE
 namespace {
 /* Algorithm from Knuth (full citation at operator*=) p272ff.  Again, there
  * are faster algorithms out there, but they require much larger numbers to
@@ -603,6 +629,7 @@ div_single_leg (uint64_t* u, size_t m, uint64_t v, GncInt128& q, GncInt128& r) n
 }
 
 }// namespace
+#endif
 
  void
 GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) noexcept
@@ -651,6 +678,15 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) noexcept
         return;
     }
 
+#ifdef GNC_INT128_NATIVE
+    auto u = to_native (m_hi, m_lo), v = to_native (b.m_hi, b.m_lo);
+    auto qn = u / v, rn = u % v;
+    q.m_hi = static_cast<uint64_t>(qn >> legbits);
+    q.m_lo = static_cast<uint64_t>(qn);
+    r.m_hi = static_cast<uint64_t>(rn >> legbits);
+    r.m_lo = static_cast<uint64_t>(rn);
+#else
+
     uint64_t u[sublegs + 2] {(m_lo & sublegmask), (m_lo >> sublegbits),
             (m_hi & sublegmask), (m_hi >> sublegbits), 0, 0};
     uint64_t v[sublegs] {(b.m_lo & sublegmask), (b.m_lo >> sublegbits),
@@ -663,6 +699,7 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) noexcept
         return div_single_leg (u, m, v[0], q, r);
 
     return div_multi_leg (u, m, v, n, q, r);
+#endif
 }
 
 GncInt128&
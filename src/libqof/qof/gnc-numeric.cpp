@@ -37,6 +37,7 @@ extern "C"
 }
 #endif
 #include <stdint.h>
+#include <utility>
 
 #include "gnc-numeric.h"
 #include "gnc-rational.hpp"
@@ -244,6 +245,100 @@ gnc_numeric_same(gnc_numeric a, gnc_numeric b, gint64 denom,
 }
 
 
+/* *******************************************************************
+ *  Fast paths
+ *
+ *  Most amounts in a book share their commodity's denominator and are
+ *  far from the int64 limits.  The sums and products of such values
+ *  need none of the 128-bit rational machinery, so they are done here
+ *  with overflow-checked int64 arithmetic.  Anything else, including
+ *  an int64 overflow, falls through to GncNumeric.
+ ********************************************************************/
+
+static inline bool
+int64_add_overflows (gint64 a, gint64 b, gint64 *result)
+{
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+    return __builtin_add_overflow (a, b, result);
+#else
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+        return true;
+    *result = a + b;
+    return false;
+#endif
+}
+
+static inline bool
+int64_mul_overflows (gint64 a, gint64 b, gint64 *result)
+{
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+    return __builtin_mul_overflow (a, b, result);
+#else
+    if (a == INT64_MIN || b == INT64_MIN)
+        return a != 0 && b != 0;
+    if (a != 0 && b != 0 &&
+        ((a > 0) == (b > 0) ? ABS (a) > INT64_MAX / ABS (b)
+         : ABS (a) > -(INT64_MIN / ABS (b))))
+        return true;
+    *result = a * b;
+    return false;
+#endif
+}
+
+/* Whether a result computed over the positive denominator den may keep
+ * it, which is when denom and how would choose den anyway. */
+static inline bool
+denom_keeps (gint64 den, gint64 denom, gint how)
+{
+    if (denom == den)
+        return true;
+    if (denom != GNC_DENOM_AUTO)
+        return false;
+    switch (how & GNC_NUMERIC_DENOM_MASK)
+    {
+    case GNC_HOW_DENOM_EXACT:
+    case GNC_HOW_DENOM_LCD:
+    case GNC_HOW_DENOM_FIXED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* INT64_MIN has no int64 negation, and GncNumeric reports it as an
+ * overflow, so leave it to that. */
+static inline bool
+add_fast (gnc_numeric a, gnc_numeric b, gint64 denom, gint how,
+          gnc_numeric *result)
+{
+    gint64 num;
+
+    if (a.denom != b.denom || a.denom <= 0 ||
+        !denom_keeps (a.denom, denom, how) ||
+        int64_add_overflows (a.num, b.num, &num) || num == INT64_MIN)
+        return false;
+    *result = gnc_numeric_create (num, a.denom);
+    return true;
+}
+
+/* A product with an integer keeps the other operand's denominator. */
+static inline bool
+mul_fast (gnc_numeric a, gnc_numeric b, gint64 denom, gint how,
+          gnc_numeric *result)
+{
+    gint64 num;
+
+    if (a.denom == 1)
+        std::swap (a, b);
+    if (b.denom != 1 || a.denom <= 0 ||
+        (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_FIXED ||
+        !denom_keeps (a.denom, denom, how) ||
+        int64_mul_overflows (a.num, b.num, &num) || num == INT64_MIN)
+        return false;
+    *result = gnc_numeric_create (num, a.denom);
+    return true;
+}
+
 /* *******************************************************************
  *  gnc_numeric_add
  ********************************************************************/
@@ -252,10 +347,14 @@ gnc_numeric
 gnc_numeric_add(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
+    gnc_numeric result;
+
     if (gnc_numeric_check(a) || gnc_numeric_check(b))
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    if (add_fast (a, b, denom, how, &result))
+        return result;
 
     GncNumeric an (a), bn (b);
     GncDenom new_denom (an, bn, denom, how);
@@ -293,10 +392,14 @@ gnc_numeric
 gnc_numeric_mul(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
+    gnc_numeric result;
+
     if (gnc_numeric_check(a) || gnc_numeric_check(b))
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    if (mul_fast (a, b, denom, how, &result))
+        return result;
 
     GncNumeric an (a), bn (b);
     GncDenom new_denom (an, bn, denom, how);
@@ -715,14 +818,53 @@ gnc_num_dbg_to_string(gnc_numeric n)
     return p;
 }
 
+/* Parse a plain decimal integer as written by gnc_numeric_to_string.
+ * Anything g_ascii_strtoll would read differently -- leading blanks,
+ * octal or hex prefixes, or more digits than can be summed without
+ * overflow -- is rejected so that the caller can fall back to it. */
+static const gchar *
+parse_canonical_int64 (const gchar *str, gint64 *val)
+{
+    bool neg = false;
+    guint64 acc = 0;
+    const gchar *start;
+
+    if (*str == '-' || *str == '+')
+        neg = (*str++ == '-');
+    if (*str == '0' && (g_ascii_isdigit (str[1]) || str[1] == 'x' ||
+                        str[1] == 'X'))
+        return NULL;
+    start = str;
+    while (g_ascii_isdigit (*str))
+    {
+        if (str - start == 18)
+            return NULL;
+        acc = acc * 10 + static_cast<guint64>(*str++ - '0');
+    }
+    if (str == start)
+        return NULL;
+    *val = neg ? -static_cast<gint64>(acc) : static_cast<gint64>(acc);
+    return str;
+}
+
 gboolean
 string_to_gnc_numeric(const gchar* str, gnc_numeric *n)
 {
     gint64 tmpnum;
     gint64 tmpdenom;
+    const gchar *p;
 
     if (!str) return FALSE;
 
+    /* Fast path for the canonical "num/denom" form. */
+    p = parse_canonical_int64 (str, &tmpnum);
+    if (p && *p == '/' && parse_canonical_int64 (p + 1, &tmpdenom))
+    {
+        n->num = tmpnum;
+        n->denom = tmpdenom;
+        return TRUE;
+    }
+
     tmpnum = g_ascii_strtoll (str, NULL, 0);
     str = strchr (str, '/');
     if (!str) return FALSE;
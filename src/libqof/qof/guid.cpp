@@ -129,15 +129,45 @@ guid_copy (const GncGUID *guid)
     return reinterpret_cast<GncGUID*> (ret);
 }
 
+/* Each thread draws its GUIDs from its own generator, so that none of
+ * them share unprotected state, in blocks of GUID_BLOCK_SIZE which are
+ * then handed out one at a time. */
+#define GUID_BLOCK_SIZE 64
+
+namespace
+{
+struct GuidBlock
+{
+    boost::uuids::random_generator gen;
+    boost::uuids::uuid guids[GUID_BLOCK_SIZE];
+    unsigned next {GUID_BLOCK_SIZE};
+
+    const boost::uuids::uuid& take ()
+    {
+        if (next == GUID_BLOCK_SIZE)
+        {
+            for (auto& guid : guids)
+                guid = gen ();
+            next = 0;
+        }
+        return guids[next++];
+    }
+};
+}
+
+static GuidBlock&
+guid_block (void)
+{
+    static thread_local GuidBlock block;
+    return block;
+}
+
 /*Takes an allocated guid pointer and constructs it in place*/
 void
 guid_replace (GncGUID *guid)
 {
-    static boost::uuids::random_generator gen;
     boost::uuids::uuid * val {reinterpret_cast<boost::uuids::uuid*> (guid)};
-    val->boost::uuids::uuid::~uuid ();
-    boost::uuids::uuid temp (gen ());
-    val->swap (temp);
+    *val = guid_block ().take ();
 }
 
 GncGUID *
@@ -174,18 +204,33 @@ guid_to_string (const GncGUID * guid)
     return ret;
 }
 
+/* GUIDs are converted to and from strings for every object the
+ * backends save or load, so the conversions below work on the bytes
+ * directly, without allocating or throwing.  The accepted syntax is the
+ * one boost's string_generator accepts: 32 hex digits, optionally with
+ * the dashes of the 8-4-4-4-12 form and optionally in braces. */
+static const char hex_digits[] = "0123456789abcdef";
+
+static inline int
+hex_digit_value (unsigned char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
 gchar *
 guid_to_string_buff (const GncGUID * guid, gchar *str)
 {
     if (!str || !guid) return NULL;
 
-    boost::uuids::uuid const & tempg = *reinterpret_cast<boost::uuids::uuid const *> (guid);
-    unsigned destspot {0};
-    string const & val {to_string (tempg)};
-    for (auto val_char : val)
-        if (val_char != '-')
-            str [destspot++] = val_char;
-
+    for (unsigned i = 0; i < GUID_DATA_SIZE; ++i)
+    {
+        unsigned char byte {guid->reserved[i]};
+        str[2 * i] = hex_digits[byte >> 4];
+        str[2 * i + 1] = hex_digits[byte & 0xf];
+    }
     str[GUID_ENCODING_LENGTH] = '\0';
     return &str[GUID_ENCODING_LENGTH];
 }
@@ -196,16 +241,41 @@ string_to_guid (const char * str, GncGUID * guid)
     if (!guid || !str)
         return false;
 
-    try 
+    const char * p {str};
+    bool braced {*p == '{'};
+    if (braced)
+        ++p;
+
+    GncGUID result;
+    bool dashed {false};
+    for (unsigned i = 0; i < GUID_DATA_SIZE; ++i)
     {
-        static boost::uuids::string_generator strgen;
-        boost::uuids::uuid * converted {reinterpret_cast<boost::uuids::uuid*> (guid)};
-        new (converted) boost::uuids::uuid (strgen (str));
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+        {
+            if (i == 4)
+                dashed = (*p == '-');
+            if (dashed)
+            {
+                if (*p != '-')
+                    return false;
+                ++p;
+            }
+        }
+        int high {hex_digit_value (p[0])};
+        if (high < 0)
+            return false;
+        int low {hex_digit_value (p[1])};
+        if (low < 0)
+            return false;
+        result.reserved[i] = static_cast<unsigned char> ((high << 4) | low);
+        p += 2;
     }
-    catch (...)
-    {
+    if (braced && *p++ != '}')
         return false;
-    }
+    if (*p != '\0')
+        return false;
+
+    *guid = result;
     return true;
 }
 
@@ -231,8 +301,12 @@ guid_compare (const GncGUID *guid_1, const GncGUID *guid_2)
     return 1;
 }
 
-guint
-guid_hash_to_guint (gconstpointer ptr)
+/* Folds the two 64-bit halves of the GUID together and mixes the
+ * result with multiply-xorshift rounds (the MurmurHash3 finalizer), so
+ * that every bit of the GUID affects every bit of the hash, whatever
+ * part of it the table ends up using. */
+guint64
+guid_hash_to_guint64 (gconstpointer ptr)
 {
     const boost::uuids::uuid * guid = reinterpret_cast<const boost::uuids::uuid*> (ptr);
 
@@ -242,14 +316,28 @@ guid_hash_to_guint (gconstpointer ptr)
         return 0;
     }
 
-    guint hash {0};
-    unsigned retspot {0};
-    for (auto guidspot : *guid)
+    uint64_t lo, hi;
+    memcpy (&lo, guid->data, sizeof(lo));
+    memcpy (&hi, guid->data + sizeof(lo), sizeof(hi));
+    uint64_t hash {lo ^ (hi * UINT64_C(0x9e3779b97f4a7c15))};
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+    hash ^= hash >> 33;
+    return hash;
+}
+
+guint
+guid_hash_to_guint (gconstpointer ptr)
+{
+    if (!ptr)
     {
-        hash <<= 4;
-        hash |= guidspot;
+        PERR ("received NULL guid pointer.");
+        return 0;
     }
-    return hash;
+    guint64 hash {guid_hash_to_guint64 (ptr)};
+    return static_cast<guint> (hash ^ (hash >> 32));
 }
 
 gint
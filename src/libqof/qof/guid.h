@@ -164,6 +164,9 @@ gint     guid_compare(const GncGUID *g1, const GncGUID *g2);
 /** Hash function for a GUID. Given a GncGUID *, hash it to a guint */
 guint guid_hash_to_guint(gconstpointer ptr);
 
+/** Like guid_hash_to_guint, for tables that use a 64-bit hash. */
+guint64 guid_hash_to_guint64(gconstpointer ptr);
+
 /** Equality function for two GUIDs in a GHashTable. */
 gint guid_g_hash_table_equal (gconstpointer guid_a, gconstpointer guid_b);
 
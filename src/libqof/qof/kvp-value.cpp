@@ -383,6 +383,37 @@ KvpValueImpl::~KvpValueImpl() noexcept
     boost::apply_visitor(d, datastore);
 }
 
+size_t
+KvpValueImpl::memory_usage() const noexcept
+{
+    size_t bytes = sizeof(*this);
+
+    if (datastore.type() == typeid(const gchar *))
+    {
+        auto str = get<const gchar *>();
+        if (str)
+            bytes += strlen(str) + 1;
+    }
+    else if (datastore.type() == typeid(GncGUID*))
+        bytes += sizeof(GncGUID);
+    else if (datastore.type() == typeid(GList*))
+    {
+        for (auto node = get<GList *>(); node; node = node->next)
+        {
+            bytes += sizeof(GList);
+            if (node->data)
+                bytes += static_cast<KvpValue*>(node->data)->memory_usage();
+        }
+    }
+    else if (datastore.type() == typeid(KvpFrame*))
+    {
+        auto frame = get<KvpFrame *>();
+        if (frame)
+            bytes += frame->memory_usage();
+    }
+    return bytes;
+}
+
 void
 KvpValueImpl::duplicate(const KvpValueImpl& other) noexcept
 {
@@ -139,6 +139,12 @@ struct KvpValueImpl
 
     char * to_string() const noexcept;
 
+    /**
+     * The bytes taken by this KvpValueImpl and what it owns, frames and
+     * lists included; an estimate, since allocator overhead isn't known.
+     */
+    size_t memory_usage() const noexcept;
+
     template <typename T>
     T get() const noexcept;
 
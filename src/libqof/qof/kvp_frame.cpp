@@ -46,12 +46,13 @@ static const char delim = '/';
 
 KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 {
+    m_valuemap.reserve(rhs.m_valuemap.size());
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
         {
             auto key = static_cast<char *>(qof_string_cache_insert(a.first));
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            this->m_valuemap.push_back({key,val});
         }
     );
 }
@@ -83,6 +84,40 @@ make_vector(std::string key)
     return path;
 }
 
+KvpPath::KvpPath(const char* path) : m_keys(make_vector(path ? path : ""))
+{
+}
+
+KvpPath::KvpPath(const Path& path)
+{
+    for (auto key : path)
+    {
+        auto keys = make_vector(key);
+        m_keys.insert(m_keys.end(), keys.begin(), keys.end());
+    }
+}
+
+/* The first slot whose key doesn't sort before key. */
+KvpFrameImpl::map_type::iterator
+KvpFrameImpl::find_spot(const char* key) noexcept
+{
+    return std::lower_bound(m_valuemap.begin(), m_valuemap.end(), key,
+        [](const map_type::value_type& a, const char* b)
+        {
+            return std::strcmp(a.first, b) < 0;
+        });
+}
+
+/* The slot with key, or end(). */
+KvpFrameImpl::map_type::const_iterator
+KvpFrameImpl::find_key(const char* key) const noexcept
+{
+    auto spot = const_cast<KvpFrameImpl*>(this)->find_spot(key);
+    if (spot != m_valuemap.end() && std::strcmp(spot->first, key) == 0)
+        return spot;
+    return m_valuemap.end();
+}
+
 KvpValue*
 KvpFrameImpl::set(const char* key, KvpValue* value) noexcept
 {
@@ -90,19 +125,25 @@ KvpFrameImpl::set(const char* key, KvpValue* value) noexcept
     if (strchr(key, delim))
         return set(make_vector(key), value);
     KvpValue* ret {nullptr};
-    auto spot = m_valuemap.find(key);
-    if (spot != m_valuemap.end())
+    auto spot = find_spot(key);
+    if (spot != m_valuemap.end() && std::strcmp(spot->first, key) == 0)
     {
-        qof_string_cache_remove(spot->first);
         ret = spot->second;
+        if (value)
+        {
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove(spot->first);
         m_valuemap.erase(spot);
+        return ret;
     }
 
     if (value)
     {
         auto cachedkey =
             static_cast<const char *>(qof_string_cache_insert(key));
-        m_valuemap.insert({cachedkey,value});
+        m_valuemap.insert(spot, {cachedkey,value});
     }
 
     return ret;
@@ -178,6 +219,27 @@ KvpFrameImpl::set_path(Path path, KvpValue* value) noexcept
     return cur_frame->set(last_key.c_str(), value);
 }
 
+KvpValue*
+KvpFrameImpl::set_path(const KvpPath& path, KvpValue* value) noexcept
+{
+    if (path.empty()) return nullptr;
+    auto& keys = path.keys();
+    auto cur_frame = this;
+    for (auto key = keys.begin(); key + 1 != keys.end(); ++key)
+    {
+        auto slot = cur_frame->get_slot(key->c_str());
+        if (slot == nullptr || slot->get_type() != KvpValue::Type::FRAME)
+        {
+            auto new_frame = new KvpFrame;
+            delete cur_frame->set(key->c_str(), new KvpValue{new_frame});
+            cur_frame = new_frame;
+            continue;
+        }
+        cur_frame = slot->get<KvpFrame*>();
+    }
+    return cur_frame->set(keys.back().c_str(), value);
+}
+
 std::string
 KvpFrameImpl::to_string() const noexcept
 {
@@ -201,6 +263,18 @@ KvpFrameImpl::to_string() const noexcept
     return ret.str();
 }
 
+size_t
+KvpFrameImpl::memory_usage() const noexcept
+{
+    size_t bytes = sizeof(*this) +
+        m_valuemap.capacity() * sizeof(map_type::value_type);
+
+    for (const auto& slot : m_valuemap)
+        if (slot.second)
+            bytes += slot.second->memory_usage();
+    return bytes;
+}
+
 std::vector<std::string>
 KvpFrameImpl::get_keys() const noexcept
 {
@@ -234,12 +308,32 @@ KvpFrameImpl::get_slot(const char * key) const noexcept
     if (!key) return nullptr;
     if (strchr(key, delim))
         return get_slot(make_vector(key));
-    auto spot = m_valuemap.find(key);
+    auto spot = find_key(key);
     if (spot == m_valuemap.end())
         return nullptr;
     return spot->second;
 }
 
+KvpValueImpl *
+KvpFrameImpl::get_slot(const KvpPath& path) const noexcept
+{
+    if (path.empty()) return nullptr;
+    auto& keys = path.keys();
+    auto cur_frame = this;
+    for (auto key = keys.begin(); key + 1 != keys.end(); ++key)
+    {
+        auto spot = cur_frame->find_key(key->c_str());
+        if (spot == cur_frame->m_valuemap.end() ||
+            spot->second->get_type() != KvpValue::Type::FRAME)
+            return nullptr;
+        cur_frame = spot->second->get<KvpFrame*>();
+    }
+    auto spot = cur_frame->find_key(keys.back().c_str());
+    if (spot == cur_frame->m_valuemap.end())
+        return nullptr;
+    return spot->second;
+}
+
 KvpValueImpl *
 KvpFrameImpl::get_slot(Path path) const noexcept
 {
@@ -273,7 +367,7 @@ int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
     for (const auto & a : one.m_valuemap)
     {
-        auto otherspot = two.m_valuemap.find(a.first);
+        auto otherspot = two.find_key(a.first);
         if (otherspot == two.m_valuemap.end())
         {
             return 1;
@@ -89,17 +89,39 @@
 #define GNC_KVP_FRAME_TYPE
 
 #include "kvp-value.hpp"
-#include <map>
+#include <utility>
 #include <string>
 #include <vector>
 #include <cstring>
 using Path = std::vector<std::string>;
 
+/**
+ * A path of keys split once, for lookups that are repeated often enough
+ * that splitting a '/'-delimited string each time shows: keep one around,
+ * e.g. as a static, and pass it to KvpFrameImpl::get_slot or set_path.
+ */
+class KvpPath
+{
+public:
+    /** Split a '/'-delimited path, ignoring empty keys. */
+    explicit KvpPath(const char* path);
+    /** Flatten a path whose elements may themselves contain '/'. */
+    explicit KvpPath(const Path& path);
+    const Path& keys() const noexcept { return m_keys; }
+    bool empty() const noexcept { return m_keys.empty(); }
+private:
+    Path m_keys;
+};
+
 /** Implements KvpFrame.
  *  It's a struct because QofInstance needs to use the typename to declare a
  *  KvpFrame* member, and QofInstance's API is C until its children are all
  *  rewritten in C++.
  *
+ *  The slots are kept in a vector sorted by key and found by binary search,
+ *  so iterating over them visits the keys in strcmp order.  Paths can be
+ *  given as strings, as a Path or as a pre-split KvpPath.
+ *
  * N.B.**  Writes to KvpFrames must** be wrapped in BeginEdit and Commit
  * for the containing QofInstance and the QofInstance must be marked dirty. This
  * is not** done by the KvpFrame API. In general Kvp items should be
@@ -109,17 +131,10 @@ using Path = std::vector<std::string>;
  */
 struct KvpFrameImpl
 {
-    class cstring_comparer
-    {
-    public:
-	/* Returns true if one is less than two. */
-	bool operator()(const char * one, const char * two) const
-	    {
-		auto ret = std::strcmp(one, two) < 0;
-		return ret;
-	    }
-    };
-    using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
+    /* The slots, kept sorted by key in a flat vector: frames are small,
+     * so searching a contiguous array beats walking a tree.  The keys
+     * are owned by the qof string cache. */
+    using map_type = std::vector<std::pair<const char *, KvpValue*>>;
 
     public:
     KvpFrameImpl() noexcept {};
@@ -182,6 +197,13 @@ struct KvpFrameImpl
      * @return The old value if there was one or nullptr.
      */
     KvpValue* set_path(Path path, KvpValue* newvalue) noexcept;
+    /**
+     * As set_path, with a path that has already been split.
+     * @param path: The path of subframes and the key to insert/replace.
+     * @param newvalue: The value to set at key.
+     * @return The old value if there was one or nullptr.
+     */
+    KvpValue* set_path(const KvpPath& path, KvpValue* newvalue) noexcept;
     /**
      * Make a string representation of the frame. Mostly useful for debugging.
      * @return A std::string representing the frame and all its children.
@@ -194,6 +216,13 @@ struct KvpFrameImpl
      */
     std::vector<std::string> get_keys() const noexcept;
 
+    /**
+     * The bytes taken by the frame, its slot array and its values,
+     * subframes included.  The keys belong to the string cache and
+     * aren't counted.
+     */
+    size_t memory_usage() const noexcept;
+
     /** Get the value for the key or nullptr if it doesn't exist.
      * @param key: The key.
      * @return The value at the key or nullptr.
@@ -204,6 +233,12 @@ struct KvpFrameImpl
      * @return The value at the key or nullptr.
      */
     KvpValue* get_slot(Path keys) const noexcept;
+    /** Get the value for the tail of a pre-split path or nullptr if it
+     * doesn't exist.
+     * @param path: Path of keys leading to the desired value.
+     * @return The value at the key or nullptr.
+     */
+    KvpValue* get_slot(const KvpPath& path) const noexcept;
     /** Convenience wrapper for std::for_each, which should be preferred.
      */
     void for_each_slot(void (*proc)(const char *key, KvpValue *value,
@@ -217,6 +252,8 @@ struct KvpFrameImpl
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     private:
+    map_type::iterator find_spot(const char* key) noexcept;
+    map_type::const_iterator find_key(const char* key) const noexcept;
     map_type m_valuemap;
 };
 
@@ -49,12 +49,24 @@ static QofLogModule log_module = QOF_MOD_UTIL;
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is a GHashTable whose values are entries holding the     */
+/* string together with its ref count, in one allocation; the key is  */
+/* the entry's string.  Interned strings live in a GStringChunk until */
+/* the cache is destroyed.  Both are guarded by one lock so that the  */
+/* loaders may use them from several threads.                         */
 /* =================================================================== */
 
+typedef struct
+{
+    guint refcount;
+    gchar str[1];
+} CacheEntry;
+
+G_LOCK_DEFINE_STATIC(qof_string_cache);
 static GHashTable* qof_string_cache = NULL;
+static GStringChunk* qof_string_atoms = NULL;
 
+/* Call with the lock held */
 static GHashTable*
 qof_get_string_cache(void)
 {
@@ -63,7 +75,7 @@ qof_get_string_cache(void)
         qof_string_cache = g_hash_table_new_full(
                                g_str_hash,               /* hash_func          */
                                g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
+                               NULL,                     /* key_destroy_func   */
                                g_free);                  /* value_destroy_func */
     }
     return qof_string_cache;
@@ -72,17 +84,26 @@ qof_get_string_cache(void)
 void
 qof_string_cache_init(void)
 {
+    G_LOCK(qof_string_cache);
     (void)qof_get_string_cache();
+    G_UNLOCK(qof_string_cache);
 }
 
 void
 qof_string_cache_destroy (void)
 {
+    G_LOCK(qof_string_cache);
     if (qof_string_cache)
     {
         g_hash_table_destroy(qof_string_cache);
     }
     qof_string_cache = NULL;
+    if (qof_string_atoms)
+    {
+        g_string_chunk_free(qof_string_atoms);
+    }
+    qof_string_atoms = NULL;
+    G_UNLOCK(qof_string_cache);
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -92,21 +113,21 @@ qof_string_cache_remove(gconstpointer key)
 {
     if (key)
     {
+        G_LOCK(qof_string_cache);
         GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
+        auto entry = static_cast<CacheEntry*>(g_hash_table_lookup(cache, key));
+        if (entry)
         {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
+            if (entry->refcount == 1)
             {
                 g_hash_table_remove(cache, key);
             }
             else
             {
-                --(*refcount);
+                --entry->refcount;
             }
         }
+        G_UNLOCK(qof_string_cache);
     }
 }
 
@@ -117,25 +138,65 @@ qof_string_cache_insert(gconstpointer key)
 {
     if (key)
     {
+        G_LOCK(qof_string_cache);
         GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
+        auto entry = static_cast<CacheEntry*>(g_hash_table_lookup(cache, key));
+        if (entry)
         {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return cache_key;
+            ++entry->refcount;
         }
         else
         {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return new_key;
+            auto len = strlen(static_cast<const char*>(key));
+            entry = static_cast<CacheEntry*>(
+                g_malloc(G_STRUCT_OFFSET(CacheEntry, str) + len + 1));
+            entry->refcount = 1;
+            memcpy(entry->str, key, len + 1);
+            g_hash_table_insert(cache, entry->str, entry);
         }
+        G_UNLOCK(qof_string_cache);
+        return entry->str;
     }
     return NULL;
 }
 
+const gchar*
+qof_string_cache_intern(const gchar* str)
+{
+    const gchar* atom;
+    if (!str)
+        return NULL;
+    G_LOCK(qof_string_cache);
+    if (!qof_string_atoms)
+        qof_string_atoms = g_string_chunk_new(4096);
+    atom = g_string_chunk_insert_const(qof_string_atoms, str);
+    G_UNLOCK(qof_string_cache);
+    return atom;
+}
+
+void
+qof_string_cache_get_usage(gint64 *count, gint64 *bytes)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    gint64 total = 0;
+    guint n;
+
+    G_LOCK(qof_string_cache);
+    GHashTable* cache = qof_get_string_cache();
+    n = g_hash_table_size(cache);
+    g_hash_table_iter_init(&iter, cache);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+        total += G_STRUCT_OFFSET(CacheEntry, str) +
+            strlen(static_cast<const char*>(key)) + 1;
+    G_UNLOCK(qof_string_cache);
+
+    /* A hash, a key and a value per slot. */
+    total += n * (sizeof(guint) + 2 * sizeof(gpointer));
+    if (count)
+        *count = n;
+    if (bytes)
+        *bytes = total;
+}
+
 /* ************************ END OF FILE ***************************** */
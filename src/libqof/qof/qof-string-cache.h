@@ -66,7 +66,8 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The string cache is demand-created on first use.  It is safe to use
+ * from several threads.
  *
  **/
 
@@ -86,6 +87,20 @@ void qof_string_cache_remove(gconstpointer key);
 */
 gpointer qof_string_cache_insert(gconstpointer key);
 
+/** Returns the interned copy of str, shared by every caller asking for
+ * an equal string, so that interned strings can be compared by
+ * address.  Interned strings are not reference counted: they stay
+ * until qof_string_cache_destroy, so use this for bounded sets of
+ * strings such as keys, and qof_string_cache_insert for data.
+ */
+const gchar* qof_string_cache_intern(const gchar* str);
+
+/** Reports the number of reference-counted strings in the cache and
+ * the bytes they and their hash table take, for memory accounting.
+ * Interned strings aren't included.
+ */
+void qof_string_cache_get_usage(gint64 *count, gint64 *bytes);
+
 #define CACHE_INSERT(str) qof_string_cache_insert((gconstpointer)(str))
 #define CACHE_REMOVE(str) qof_string_cache_remove((str))
 
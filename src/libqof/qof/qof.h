@@ -71,6 +71,7 @@
 #include <glib.h>
 #include "qofid.h"
 #include "qoflog.h"
+#include "qofprofile.h"
 #include "gnc-date.h"
 #include "gnc-numeric.h"
 #include "qofutil.h"
@@ -114,6 +114,11 @@
  *    to ERR_BACKEND_MOD_DESTROY from this routine, so that the
  *    engine can properly clean up.
  *
+ * The begin_group() and end_group() routines bracket a run of commits
+ *    that the backend may store together, e.g. in one database
+ *    transaction.  Groups nest; only the outermost end_group() needs to
+ *    write anything.  Either may be NULL.
+ *
  * The compile_query() method compiles a QOF query object into
  *    a backend-specific data structure and returns the compiled
  *    query. For an SQL backend, the contents of the query object
@@ -298,6 +303,9 @@ struct QofBackend_s
     void (*commit) (QofBackend *, QofInstance *);
     void (*rollback) (QofBackend *, QofInstance *);
 
+    void (*begin_group) (QofBackend *);
+    void (*end_group) (QofBackend *);
+
     gpointer (*compile_query) (QofBackend *, QofQuery *);
     void (*free_query) (QofBackend *, gpointer);
     void (*run_query) (QofBackend *, gpointer);
@@ -331,6 +339,20 @@ struct QofBackend_s
      */
     void (*price_lookup) (QofBackend *, gpointer);
 
+    /** Sums the amounts of an account's splits in transactions posted
+     * from start to end, both included, without loading them.  Either
+     * date may be NULL to leave that end open.  Backends that don't
+     * keep every split in memory set it, and the engine then asks them
+     * for dated balances instead of summing the splits it has.
+     *
+     * Note the correct signature for this call is
+     * gboolean (*balance_lookup) (QofBackend *, Account *, ...);
+     * we use QofInstance to avoid an unwanted include file dependency.
+     */
+    gboolean (*balance_lookup) (QofBackend *, QofInstance *,
+                                const Timespec *start, const Timespec *end,
+                                gnc_numeric *balance);
+
     /** \deprecated Export should really _NOT_ be here, but is left here for now.
      * I'm not sure where this should be going to. It should be
      * removed ASAP.   This is a temporary hack-around until period-closing
@@ -138,6 +138,8 @@ qof_backend_init(QofBackend *be)
     be->begin = NULL;
     be->commit = NULL;
     be->rollback = NULL;
+    be->begin_group = NULL;
+    be->end_group = NULL;
 
     be->compile_query = NULL;
     be->free_query = NULL;
@@ -156,6 +158,7 @@ qof_backend_init(QofBackend *be)
 
     /* to be removed */
     be->price_lookup = NULL;
+    be->balance_lookup = NULL;
     be->export_fn = NULL;
 }
 
@@ -225,6 +228,20 @@ qof_backend_commit_exists(const QofBackend *be)
     }
 }
 
+void
+qof_backend_begin_group_commit(QofBackend *be)
+{
+    if (be && be->begin_group)
+        (be->begin_group) (be);
+}
+
+void
+qof_backend_end_group_commit(QofBackend *be)
+{
+    if (be && be->end_group)
+        (be->end_group) (be);
+}
+
 static GSList* backend_module_list = NULL;
 
 gboolean
@@ -159,6 +159,15 @@ gboolean qof_backend_begin_exists(const QofBackend *be);
 void qof_backend_run_commit(QofBackend *be, QofInstance *inst);
 
 gboolean qof_backend_commit_exists(const QofBackend *be);
+
+/** Lets the backend store the commits made until the matching
+ *  qof_backend_end_group_commit() together, e.g. in one database
+ *  transaction instead of one per commit.  Meant for importers and
+ *  other bulk edits.  Calls may nest.
+ */
+void qof_backend_begin_group_commit(QofBackend *be);
+
+void qof_backend_end_group_commit(QofBackend *be);
 //@}
 
 /** The qof_backend_set_error() routine pushes an error code onto the error
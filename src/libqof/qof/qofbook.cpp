@@ -55,6 +55,7 @@ extern "C"
 #include "qofbackend-p.h"
 #include "qofbook-p.h"
 #include "qofid-p.h"
+#include "qofinstance-p.h"
 #include "qofobject-p.h"
 #include "qofbookslots.h"
 #include "kvp_frame.hpp"
@@ -121,6 +122,7 @@ qof_book_init (QofBook *book)
     book->read_only = FALSE;
     book->session_dirty = FALSE;
     book->version = 0;
+    book->cached_options_valid = FALSE;
 }
 
 static void
@@ -204,6 +206,7 @@ qof_book_set_property (GObject      *object,
     g_return_if_fail (QOF_IS_BOOK (object));
     book = QOF_BOOK (object);
     g_assert (qof_instance_get_editlevel(book));
+    qof_book_invalidate_option_cache (book);
 
     switch (prop_id)
     {
@@ -614,6 +617,117 @@ qof_book_foreach_collection (const QofBook *book,
 
 /* ====================================================================== */
 
+GList *
+qof_memory_usage_append (GList *usage, const char *category,
+                         gint64 count, gint64 bytes)
+{
+    QofMemoryUsage *mu = g_new (QofMemoryUsage, 1);
+
+    mu->category = g_strdup (category);
+    mu->count = count;
+    mu->bytes = bytes;
+    return g_list_append (usage, mu);
+}
+
+static void
+free_memory_usage (gpointer data)
+{
+    QofMemoryUsage *mu = static_cast<QofMemoryUsage*>(data);
+
+    g_free (mu->category);
+    g_free (mu);
+}
+
+void
+qof_memory_usage_free (GList *usage)
+{
+    g_list_free_full (usage, free_memory_usage);
+}
+
+struct _memory_usage
+{
+    gint64 instance_size;
+    gint64 frames;
+    gint64 kvp_bytes;
+};
+
+static void
+instance_memory_usage (QofInstance *inst, gpointer data)
+{
+    auto mu = static_cast<struct _memory_usage*>(data);
+    KvpFrame *frame = qof_instance_get_slots (inst);
+
+    if (!mu->instance_size)
+    {
+        GTypeQuery query;
+        g_type_query (G_OBJECT_TYPE (inst), &query);
+        mu->instance_size = query.instance_size;
+    }
+    if (frame && !frame->empty ())
+    {
+        mu->frames++;
+        mu->kvp_bytes += frame->memory_usage ();
+    }
+}
+
+static void
+collection_memory_usage (QofCollection *col, gpointer data)
+{
+    GList **usage = static_cast<GList**>(data);
+    struct _memory_usage mu = { 0, 0, 0 };
+    QofIdTypeConst type = qof_collection_get_type (col);
+    gint64 count = qof_collection_count (col);
+    gchar *category;
+
+    if (!count)
+        return;
+    qof_collection_foreach (col, instance_memory_usage, &mu);
+
+    category = g_strdup_printf ("%s instances", type);
+    *usage = qof_memory_usage_append (*usage, category, count,
+                                      count * mu.instance_size);
+    g_free (category);
+    /* The index is a hash table of GUIDs: a hash, a key and a value
+     * per slot, and the GUID itself is part of the instance. */
+    category = g_strdup_printf ("%s index", type);
+    *usage = qof_memory_usage_append (*usage, category, count,
+                                      count * (sizeof (guint) +
+                                               2 * sizeof (gpointer)));
+    g_free (category);
+    category = g_strdup_printf ("%s kvp", type);
+    *usage = qof_memory_usage_append (*usage, category, mu.frames,
+                                      mu.kvp_bytes);
+    g_free (category);
+}
+
+static gint
+compare_memory_usage (gconstpointer a, gconstpointer b)
+{
+    return g_strcmp0 (static_cast<const QofMemoryUsage*>(a)->category,
+                      static_cast<const QofMemoryUsage*>(b)->category);
+}
+
+GList *
+qof_book_get_memory_usage (const QofBook *book)
+{
+    GList *usage = NULL;
+    KvpFrame *frame;
+    gint64 count, bytes;
+
+    g_return_val_if_fail (book, NULL);
+
+    qof_book_foreach_collection (book, collection_memory_usage, &usage);
+    /* The collections come out of a hash table; keep runs comparable. */
+    usage = g_list_sort (usage, compare_memory_usage);
+    frame = qof_instance_get_slots (QOF_INSTANCE (const_cast<QofBook*>(book)));
+    usage = qof_memory_usage_append (usage, "Book kvp", frame ? 1 : 0,
+                                     frame ? frame->memory_usage () : 0);
+    qof_string_cache_get_usage (&count, &bytes);
+    return qof_memory_usage_append (usage, "String cache", count, bytes);
+}
+
+/* ====================================================================== */
+
 void qof_book_mark_closed (QofBook *book)
 {
     if (!book)
@@ -1019,17 +1133,74 @@ qof_book_get_default_gains_policy (QofBook *book)
 }
 
 
+/* Read a Scheme-boolean ('t' or NULL) string option. */
+static gboolean
+book_get_boolean_option (const QofBook *book, const char *prop_name)
+{
+    char *opt = NULL;
+    gboolean retval;
+    qof_instance_get (QOF_INSTANCE (book),
+		      prop_name, &opt,
+		      NULL);
+    retval = (opt && opt[0] == 't' && opt[1] == 0);
+    g_free (opt);
+    return retval;
+}
+
+/* The options below are read on every split comparison, so they're
+ * fetched through the property system once and kept on the book until
+ * its KVP changes. */
+static const QofBook *
+book_cache_options (const QofBook *book)
+{
+    auto cache = const_cast<QofBook*>(book);
+    double days = 0;
+
+    if (book->cached_options_valid)
+        return book;
+
+    cache->cached_trading_accts =
+        book_get_boolean_option (book, "trading-accts");
+    cache->cached_split_action_for_num =
+        book_get_boolean_option (book, "split-action-num-field");
+    qof_instance_get (QOF_INSTANCE (book),
+		      "autoreadonly-days", &days,
+		      NULL);
+    cache->cached_num_days_autoreadonly = (gint) days;
+    cache->cached_options_valid = TRUE;
+    return book;
+}
+
+void
+qof_book_invalidate_option_cache (QofBook *book)
+{
+    if (!book) return;
+    book->cached_options_valid = FALSE;
+}
+
+/* The last generation handed out to any book */
+static guint64 book_generation = 0;
+
+guint64
+qof_book_get_generation (const QofBook *book)
+{
+    if (!book) return 0;
+    return book->generation;
+}
+
+void
+qof_book_bump_generation (QofBook *book)
+{
+    if (!book) return;
+    book->generation = ++book_generation;
+}
+
 /* Determine whether this book uses trading accounts */
 gboolean
 qof_book_use_trading_accounts (const QofBook *book)
 {
-    const char *opt = NULL;
-    qof_instance_get (QOF_INSTANCE (book),
-		      "trading-accts", &opt,
-		      NULL);
-    if (opt && opt[0] == 't' && opt[1] == 0)
-        return TRUE;
-    return FALSE;
+    g_return_val_if_fail (book, FALSE);
+    return book_cache_options (book)->cached_trading_accts;
 }
 
 /* Returns TRUE if this book uses split action field as the 'Num' field, FALSE
@@ -1037,14 +1208,8 @@ qof_book_use_trading_accounts (const QofBook *book)
 gboolean
 qof_book_use_split_action_for_num_field (const QofBook *book)
 {
-    const char *opt = NULL;
-    qof_instance_get (QOF_INSTANCE (book),
-		      "split-action-num-field", &opt,
-		      NULL);
-
-    if (opt && opt[0] == 't' && opt[1] == 0)
-        return TRUE;
-    return FALSE;
+    g_return_val_if_fail (book, FALSE);
+    return book_cache_options (book)->cached_split_action_for_num;
 }
 
 gboolean qof_book_uses_autoreadonly (const QofBook *book)
@@ -1056,11 +1221,7 @@ gboolean qof_book_uses_autoreadonly (const QofBook *book)
 gint qof_book_get_num_days_autoreadonly (const QofBook *book)
 {
     g_assert(book);
-    double tmp;
-    qof_instance_get (QOF_INSTANCE (book),
-		      "autoreadonly-days", &tmp,
-		      NULL);
-    return (gint) tmp;
+    return book_cache_options (book)->cached_num_days_autoreadonly;
 }
 
 GDate* qof_book_get_autoreadonly_gdate (const QofBook *book)
@@ -1170,6 +1331,7 @@ static void noop (QofInstance *inst) {}
 void
 qof_book_commit_edit(QofBook *book)
 {
+    qof_book_invalidate_option_cache (book);
     if (!qof_commit_edit (QOF_INSTANCE(book))) return;
     qof_commit_edit_part2 (&book->inst, commit_err, noop, noop/*lot_free*/);
 }
@@ -1183,6 +1345,7 @@ qof_book_set_option (QofBook *book, KvpValue *value, GSList *path)
         path_v.push_back(static_cast<const char*>(item->data));
     qof_book_begin_edit (book);
     delete root->set_path(path_v, value);
+    qof_book_invalidate_option_cache (book);
     qof_instance_set_dirty (QOF_INSTANCE (book));
     qof_book_commit_edit (book);
 }
@@ -1202,6 +1365,7 @@ qof_book_options_delete (QofBook *book)
 {
     KvpFrame *root = qof_instance_get_slots(QOF_INSTANCE (book));
     delete root->set_path(KVP_OPTION_PATH, nullptr);
+    qof_book_invalidate_option_cache (book);
 }
 
 /* QofObject function implementation and registration */
@@ -141,6 +141,19 @@ struct _QofBook
     /* version number, used for tracking multiuser updates */
     gint32  version;
 
+    /* Cached copies of the book options that are consulted in hot
+     * paths such as xaccSplitOrder().  They are only meaningful while
+     * cached_options_valid is TRUE; anything that changes the book's
+     * KVP clears it, see qof_book_invalidate_option_cache(). */
+    gboolean cached_options_valid;
+    gboolean cached_trading_accts;
+    gboolean cached_split_action_for_num;
+    gint     cached_num_days_autoreadonly;
+
+    /* Changes whenever an object of the book is created, edited or
+     * committed, see qof_book_get_generation(). */
+    guint64 generation;
+
     /* To be technically correct, backends belong to sessions and
      * not books.  So the pointer below "really shouldn't be here",
      * except that it provides a nice convenience, avoiding a lookup
@@ -219,6 +232,31 @@ QofCollection  * qof_book_get_collection (const QofBook *, QofIdType);
 typedef void (*QofCollectionForeachCB) (QofCollection *, gpointer user_data);
 void qof_book_foreach_collection (const QofBook *, QofCollectionForeachCB, gpointer);
 
+/** One category of the memory a book takes, see
+ *  qof_book_get_memory_usage(). */
+typedef struct
+{
+    gchar *category;
+    gint64 count;
+    gint64 bytes;
+} QofMemoryUsage;
+
+/** Walks the book and returns a GList of QofMemoryUsage, estimating
+ *  the bytes taken by each collection's instances ("Trans instances"),
+ *  its index of them ("Trans index") and its instances' kvp frames
+ *  ("Trans kvp"), by the book's own kvp ("Book kvp") and by the
+ *  string cache ("String cache"), which all books share.
+ *  The figures exclude allocator overhead.  Free the list with
+ *  qof_memory_usage_free().
+ */
+GList *qof_book_get_memory_usage (const QofBook *book);
+
+/** Appends a category to a list of QofMemoryUsage, for code adding
+ *  figures that only it knows how to collect. */
+GList *qof_memory_usage_append (GList *usage, const char *category,
+                                gint64 count, gint64 bytes);
+void qof_memory_usage_free (GList *usage);
+
 /** The qof_book_set_data() allows arbitrary pointers to structs
  *    to be stored in QofBook. This is the "preferred" method for
  *    extending QofBook to hold new data types.  This is also
@@ -285,6 +323,25 @@ GDate* qof_book_get_autoreadonly_gdate (const QofBook *book);
  *  if it uses transaction number field */
 gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
 
+/** Discard the cached values of the trading-accounts, num-field-source
+ *  and auto-read-only options so that they are re-read from the book's
+ *  KVP on next use.  The book's own option setters do this themselves;
+ *  code that writes the book's KVP frame directly (e.g. a backend
+ *  loading the book slots) must call it afterwards. */
+void qof_book_invalidate_option_cache (QofBook *book);
+
+/** Return the book's generation, a number that changes whenever an
+ *  object of the book is created, edited or committed.  The numbers are
+ *  drawn from one counter for all books, so a saved generation is never
+ *  that of another book, or of a later state of the same one.  Caches
+ *  of results computed from the book's objects can keep it to tell
+ *  whether they are still good. */
+guint64 qof_book_get_generation (const QofBook *book);
+
+/** Give the book a new generation; done by QofInstance on every
+ *  change, so only needed for changes made behind its back. */
+void qof_book_bump_generation (QofBook *book);
+
 /** Is the book shutting down? */
 gboolean qof_book_shutting_down (const QofBook *book);
 
@@ -34,8 +34,25 @@ typedef struct
     gpointer user_data;
 
     gint handler_id;
+
+    /* Only events of this entity type (any if NULL) and matching this
+     * mask are dispatched to the handler. */
+    QofIdTypeConst type;
+    QofEventId event_mask;
+
+    /* Delivered later from the main loop, see
+     * qof_event_register_async_handler. */
+    gboolean async;
+
+    /* Calls and the time spent in them while profiling is active. */
+    gint64 calls;
+    gint64 usec;
 } HandlerInfo;
 
+/* The event statistics of the profiling summary, see qofprofile.h. */
+void qof_event_reset_stats (void);
+void qof_event_report_stats (GString *summary);
+
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
@@ -39,11 +39,52 @@ extern "C"
 
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
+static guint   dropped_events    = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
 static GList   *handlers  =   NULL;
 
+/* The entities created or modified while coalescing events, in order,
+ * with coalesced mapping each to its index in the array plus one. */
+typedef struct
+{
+    QofInstance *entity;
+    QofEventId events;
+} CoalescedEvent;
+
+static gboolean   coalescing = FALSE;
+static GArray    *coalesced_entities = NULL;
+static GHashTable *coalesced = NULL;
+
+/* Events waiting for the asynchronous handlers, delivered in order
+ * from an idle callback; see qof_event_register_async_handler. */
+typedef struct
+{
+    QofInstance *entity;
+    QofEventId event_id;
+} AsyncEvent;
+
+static guint   async_handlers = 0;
+static GQueue  async_queue = G_QUEUE_INIT;
+static guint   async_source = 0;
+
+/* Event statistics, kept while profiling is active: the events
+ * dispatched per entity type and event, and per entity, and the ones
+ * dropped because events were suspended. */
+typedef struct
+{
+    gchar *name;
+    gint64 count;
+} EventCount;
+
+static GHashTable *type_counts = NULL;
+static GHashTable *entity_counts = NULL;
+static gint64 suspended_events = 0;
+
+/* The entities and handlers the summary lists at most. */
+#define MAX_REPORTED 20
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -78,13 +119,15 @@ find_next_handler_id(void)
     return handler_id;
 }
 
-gint
-qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+static gint
+register_handler (QofEventHandler handler, gpointer user_data,
+                  QofIdTypeConst type, QofEventId event_mask, gboolean async)
 {
     HandlerInfo *hi;
     gint handler_id;
 
-    ENTER ("(handler=%p, data=%p)", handler, user_data);
+    ENTER ("(handler=%p, data=%p, type=%s, mask=%x)", handler, user_data,
+           type ? type : "(any)", event_mask);
 
     /* sanity check */
     if (!handler)
@@ -102,12 +145,42 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     hi->handler = handler;
     hi->user_data = user_data;
     hi->handler_id = handler_id;
+    hi->type = type;
+    hi->event_mask = event_mask;
+    hi->async = async;
+    if (async)
+        async_handlers++;
 
     handlers = g_list_prepend (handlers, hi);
     LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
     return handler_id;
 }
 
+gint
+qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    /* all bits, QOF_EVENT_ALL leaves out the application's events */
+    return register_handler (handler, user_data, NULL, ~0, FALSE);
+}
+
+gint
+qof_event_register_filtered_handler (QofEventHandler handler,
+                                     gpointer user_data,
+                                     QofIdTypeConst type,
+                                     QofEventId event_mask)
+{
+    return register_handler (handler, user_data, type, event_mask, FALSE);
+}
+
+gint
+qof_event_register_async_handler (QofEventHandler handler,
+                                  gpointer user_data,
+                                  QofIdTypeConst type,
+                                  QofEventId event_mask)
+{
+    return register_handler (handler, user_data, type, event_mask, TRUE);
+}
+
 void
 qof_event_unregister_handler (gint handler_id)
 {
@@ -131,6 +204,8 @@ qof_event_unregister_handler (gint handler_id)
                    hi->handler, hi->user_data);
 
         /* safety -- clear the handler in case we're running events now */
+        if (hi->handler && hi->async)
+            async_handlers--;
         hi->handler = NULL;
 
         if (handler_run_level == 0)
@@ -150,6 +225,12 @@ qof_event_unregister_handler (gint handler_id)
     PERR ("no such handler: %d", handler_id);
 }
 
+guint
+qof_event_get_dropped_count (void)
+{
+    return dropped_events;
+}
+
 void
 qof_event_suspend (void)
 {
@@ -161,6 +242,49 @@ qof_event_suspend (void)
     }
 }
 
+void
+qof_event_suspend_coalescing (void)
+{
+    qof_event_suspend ();
+    if (!coalescing)
+    {
+        coalescing = TRUE;
+        coalesced_entities = g_array_new (FALSE, FALSE,
+                                          sizeof (CoalescedEvent));
+        coalesced = g_hash_table_new (g_direct_hash, g_direct_equal);
+    }
+}
+
+static void
+coalesce_event (QofInstance *entity, QofEventId event_id)
+{
+    guint index = GPOINTER_TO_UINT (g_hash_table_lookup (coalesced, entity));
+
+    if (event_id == QOF_EVENT_CREATE || event_id == QOF_EVENT_MODIFY)
+    {
+        if (!index)
+        {
+            CoalescedEvent ce = { entity, 0 };
+            g_array_append_val (coalesced_entities, ce);
+            index = coalesced_entities->len;
+            g_hash_table_insert (coalesced, entity, GUINT_TO_POINTER (index));
+        }
+        g_array_index (coalesced_entities, CoalescedEvent, index - 1).events
+            |= event_id;
+    }
+    else if (event_id == QOF_EVENT_DESTROY && index)
+    {
+        /* Don't deliver anything to an entity that is going away. */
+        g_array_index (coalesced_entities, CoalescedEvent, index - 1).entity
+            = NULL;
+        g_hash_table_remove (coalesced, entity);
+    }
+}
+
+static void qof_event_generate_internal (QofInstance *entity,
+                                         QofEventId event_id,
+                                         gpointer event_data);
+
 void
 qof_event_resume (void)
 {
@@ -171,25 +295,206 @@ qof_event_resume (void)
     }
 
     suspend_counter--;
+
+    if (suspend_counter == 0 && coalescing)
+    {
+        GArray *entities = coalesced_entities;
+        guint i;
+
+        coalescing = FALSE;
+        g_hash_table_destroy (coalesced);
+        coalesced = NULL;
+        coalesced_entities = NULL;
+        for (i = 0; i < entities->len; i++)
+        {
+            CoalescedEvent *ce = &g_array_index (entities, CoalescedEvent, i);
+            if (!ce->entity)
+                continue;
+            if (ce->events & QOF_EVENT_CREATE)
+                qof_event_generate_internal (ce->entity, QOF_EVENT_CREATE, NULL);
+            qof_event_generate_internal (ce->entity, QOF_EVENT_MODIFY, NULL);
+        }
+        g_array_free (entities, TRUE);
+    }
+}
+
+static const char *
+event_name (QofEventId event_id)
+{
+    switch (event_id)
+    {
+    case QOF_EVENT_CREATE:
+        return "create";
+    case QOF_EVENT_MODIFY:
+        return "modify";
+    case QOF_EVENT_DESTROY:
+        return "destroy";
+    case QOF_EVENT_ADD:
+        return "add";
+    case QOF_EVENT_REMOVE:
+        return "remove";
+    default:
+        return NULL;
+    }
 }
 
 static void
-qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
-                             gpointer event_data)
+free_event_count (gpointer data)
+{
+    EventCount *ec = static_cast<EventCount*>(data);
+
+    g_free (ec->name);
+    g_free (ec);
+}
+
+static void
+count_event (GHashTable *counts, gchar *key, gchar *name)
+{
+    EventCount *ec = static_cast<EventCount*>(g_hash_table_lookup (counts, key));
+
+    if (ec)
+    {
+        g_free (key);
+        g_free (name);
+    }
+    else
+    {
+        ec = g_new0 (EventCount, 1);
+        ec->name = name;
+        g_hash_table_insert (counts, key, ec);
+    }
+    ec->count++;
+}
+
+static void
+record_event (QofInstance *entity, QofEventId event_id)
+{
+    const char *ename = event_name (event_id);
+    gchar *type_event, guidstr[GUID_ENCODING_LENGTH + 1];
+
+    if (!type_counts)
+    {
+        type_counts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, free_event_count);
+        entity_counts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, free_event_count);
+    }
+    type_event = ename ?
+        g_strdup_printf ("%s %s", entity->e_type, ename) :
+        g_strdup_printf ("%s event %d", entity->e_type, event_id);
+    count_event (type_counts, g_strdup (type_event), type_event);
+    guid_to_string_buff (qof_instance_get_guid (entity), guidstr);
+    count_event (entity_counts, g_strdup (guidstr),
+                 g_strdup_printf ("%s %s", entity->e_type, guidstr));
+}
+
+void
+qof_event_reset_stats (void)
 {
     GList *node;
-    GList *next_node = NULL;
 
-    g_return_if_fail(entity);
+    if (type_counts)
+    {
+        g_hash_table_remove_all (type_counts);
+        g_hash_table_remove_all (entity_counts);
+    }
+    suspended_events = 0;
+    for (node = handlers; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        hi->calls = hi->usec = 0;
+    }
+}
 
-    switch (event_id)
+static gint
+compare_counts (gconstpointer a, gconstpointer b)
+{
+    gint64 ca = (*static_cast<EventCount* const*>(a))->count;
+    gint64 cb = (*static_cast<EventCount* const*>(b))->count;
+
+    return ca < cb ? 1 : ca > cb ? -1 : 0;
+}
+
+static gint
+compare_handler_usec (gconstpointer a, gconstpointer b)
+{
+    gint64 ua = (*static_cast<HandlerInfo* const*>(a))->usec;
+    gint64 ub = (*static_cast<HandlerInfo* const*>(b))->usec;
+
+    return ua < ub ? 1 : ua > ub ? -1 : 0;
+}
+
+/* Appends the counts sorted by decreasing count, at most max of them. */
+static void
+report_counts (GString *summary, GHashTable *counts, guint max)
+{
+    GPtrArray *sorted = g_ptr_array_new ();
+    GHashTableIter iter;
+    gpointer key, value;
+    guint i;
+
+    if (counts)
     {
-    case QOF_EVENT_NONE:
+        g_hash_table_iter_init (&iter, counts);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            g_ptr_array_add (sorted, value);
+    }
+    g_ptr_array_sort (sorted, compare_counts);
+    for (i = 0; i < sorted->len && i < max; ++i)
     {
-        /* if none, don't log, just return. */
-        return;
+        EventCount *ec = static_cast<EventCount*>(g_ptr_array_index (sorted, i));
+        g_string_append_printf (summary, "  %10" G_GINT64_FORMAT "  %s\n",
+                                ec->count, ec->name);
+    }
+    if (sorted->len > max)
+        g_string_append_printf (summary, "  (%u more)\n", sorted->len - max);
+    g_ptr_array_free (sorted, TRUE);
+}
+
+void
+qof_event_report_stats (GString *summary)
+{
+    GPtrArray *sorted = g_ptr_array_new ();
+    GList *node;
+    guint i;
+
+    g_string_append (summary, "Events by type:\n");
+    report_counts (summary, type_counts, G_MAXUINT);
+    g_string_append_printf (summary, "  %10" G_GINT64_FORMAT
+                            "  dropped while suspended\n", suspended_events);
+    g_string_append (summary, "Events by entity:\n");
+    report_counts (summary, entity_counts, MAX_REPORTED);
+
+    /* Handlers are listed as their id and function address, which the
+     * debugger can turn into a name. */
+    for (node = handlers; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        if (hi->handler && hi->calls)
+            g_ptr_array_add (sorted, hi);
     }
+    g_ptr_array_sort (sorted, compare_handler_usec);
+    g_string_append (summary, "Event handlers by time:\n");
+    for (i = 0; i < sorted->len && i < MAX_REPORTED; ++i)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(g_ptr_array_index (sorted, i));
+        g_string_append_printf (summary, "  %10" G_GINT64_FORMAT " us %10"
+                                G_GINT64_FORMAT " calls  handler %d (%p)%s\n",
+                                hi->usec, hi->calls, hi->handler_id,
+                                (gpointer)hi->handler,
+                                hi->async ? " async" : "");
     }
+    g_ptr_array_free (sorted, TRUE);
+}
+
+/* Runs the synchronous or the asynchronous handlers interested in the
+ * event. */
+static void
+run_handlers (QofInstance *entity, QofEventId event_id, gpointer event_data,
+              gboolean async)
+{
+    GList *node;
+    GList *next_node = NULL;
 
     handler_run_level++;
     for (node = handlers; node; node = next_node)
@@ -197,11 +502,21 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
         HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
 
         next_node = node->next;
-        if (hi->handler)
+        if (hi->handler && hi->async == async &&
+            (hi->event_mask & event_id) &&
+            (!hi->type || g_strcmp0 (hi->type, entity->e_type) == 0))
         {
             PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
                   hi->handler, event_data);
-            hi->handler (entity, event_id, hi->user_data, event_data);
+            if (G_UNLIKELY (QOF_PROFILE_IS_ACTIVE ()))
+            {
+                gint64 start = g_get_monotonic_time ();
+                hi->handler (entity, event_id, hi->user_data, event_data);
+                hi->usec += g_get_monotonic_time () - start;
+                hi->calls++;
+            }
+            else
+                hi->handler (entity, event_id, hi->user_data, event_data);
         }
     }
     handler_run_level--;
@@ -227,6 +542,67 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
 }
 
+void
+qof_event_flush_async (void)
+{
+    if (async_source)
+    {
+        g_source_remove (async_source);
+        async_source = 0;
+    }
+    /* Handlers may generate more events, deliver those too. */
+    while (!g_queue_is_empty (&async_queue))
+    {
+        auto ev = static_cast<AsyncEvent*>(g_queue_pop_head (&async_queue));
+        if (async_handlers)
+            run_handlers (ev->entity, ev->event_id, NULL, TRUE);
+        g_object_unref (ev->entity);
+        g_slice_free (AsyncEvent, ev);
+    }
+}
+
+static gboolean
+async_flush_idle (gpointer unused)
+{
+    async_source = 0;
+    qof_event_flush_async ();
+    return FALSE;
+}
+
+static void
+qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
+                             gpointer event_data)
+{
+    QOF_PROFILE_BEGIN (start);
+
+    g_return_if_fail(entity);
+
+    switch (event_id)
+    {
+    case QOF_EVENT_NONE:
+    {
+        /* if none, don't log, just return. */
+        return;
+    }
+    }
+
+    if (G_UNLIKELY (QOF_PROFILE_IS_ACTIVE ()))
+        record_event (entity, event_id);
+    run_handlers (entity, event_id, event_data, FALSE);
+    QOF_PROFILE_END (start, "event-dispatch");
+
+    if (async_handlers)
+    {
+        /* The entity is kept alive until the event is delivered. */
+        AsyncEvent *ev = g_slice_new (AsyncEvent);
+        ev->entity = QOF_INSTANCE (g_object_ref (entity));
+        ev->event_id = event_id;
+        g_queue_push_tail (&async_queue, ev);
+        if (!async_source)
+            async_source = g_idle_add (async_flush_idle, NULL);
+    }
+}
+
 void
 qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data)
 {
@@ -243,7 +619,18 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
         return;
 
     if (suspend_counter)
+    {
+        if (G_UNLIKELY (QOF_PROFILE_IS_ACTIVE ()))
+            suspended_events++;
+        /* Coalescing replays creations and modifications on resume;
+         * anything else is lost to the handlers. */
+        if (coalescing)
+            coalesce_event (entity, event_id);
+        if (!coalescing ||
+                (event_id != QOF_EVENT_CREATE && event_id != QOF_EVENT_MODIFY))
+            dropped_events++;
         return;
+    }
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
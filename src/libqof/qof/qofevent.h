@@ -98,6 +98,46 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for some events only.
+ *
+ * The handler is only invoked for events of entities of the given type
+ * whose id shares a bit with event_mask, sparing it the filtering.
+ *
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ * @param type:  the entity type of interest, or NULL for all types
+ * @param event_mask: the events of interest, for example
+ *        QOF_EVENT_MODIFY | QOF_EVENT_DESTROY
+ *
+ * @return id identifying handler, to unregister it as any other
+ */
+gint qof_event_register_filtered_handler (QofEventHandler handler,
+                                          gpointer handler_data,
+                                          QofIdTypeConst type,
+                                          QofEventId event_mask);
+
+/** \brief Register a handler to be invoked after the fact.
+ *
+ * For subscribers such as logs and scripting hooks which needn't see
+ * events while the engine generates them: the events are queued, in
+ * the order they were generated, and delivered from an idle callback of
+ * the GLib main loop, or by qof_event_flush_async.  The entity is kept
+ * alive until then, but may have changed again, and the event_data
+ * passed to the handler is always NULL since it only lives as long as
+ * the generating call.
+ *
+ * Parameters and return value are as for
+ * qof_event_register_filtered_handler.
+ */
+gint qof_event_register_async_handler (QofEventHandler handler,
+                                       gpointer handler_data,
+                                       QofIdTypeConst type,
+                                       QofEventId event_mask);
+
+/** \brief Deliver the queued events to the asynchronous handlers now,
+ * for example before shutting down or where no main loop runs. */
+void qof_event_flush_async (void);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -136,9 +176,28 @@ void qof_event_gen (QofInstance *entity, QofEventId event_type,
  */
 void qof_event_suspend (void);
 
+/** \brief Suspend engine events, but keep modifications.
+ *
+ *   Like qof_event_suspend, except that the entities for which
+ *   QOF_EVENT_CREATE or QOF_EVENT_MODIFY events are generated until
+ *   events are resumed are remembered.  When the outermost
+ *   qof_event_resume call is made each of those still alive gets one
+ *   QOF_EVENT_CREATE event, if it was created in between, and one
+ *   QOF_EVENT_MODIFY event, both with NULL event data.  Other events
+ *   are dropped as usual.
+ */
+void qof_event_suspend_coalescing (void);
+
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** Return the number of events dropped so far because events were
+ *  suspended.  The QOF_EVENT_CREATE and QOF_EVENT_MODIFY events a
+ *  coalescing suspension replays on resume don't count.  Anything that
+ *  keeps itself up to date from events can compare this with its value
+ *  when it was last rebuilt to tell whether it missed a change. */
+guint qof_event_get_dropped_count (void);
+
 #ifdef __cplusplus
 }
 #endif
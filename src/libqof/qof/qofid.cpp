@@ -39,6 +39,7 @@ extern "C"
 #include "qof.h"
 #include "qofid-p.h"
 #include "qofinstance-p.h"
+#include <vector>
 
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -47,6 +48,9 @@ struct QofCollection_s
     QofIdType    e_type;
     gboolean     is_dirty;
 
+    /* The entities, in no particular order, for scans; hash_of_entities
+     * maps each GUID to its index in the array plus one. */
+    GPtrArray  * entities;
     GHashTable * hash_of_entities;
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
@@ -59,6 +63,7 @@ qof_collection_new (QofIdType type)
     QofCollection *col;
     col = g_new0(QofCollection, 1);
     col->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
+    col->entities = g_ptr_array_new();
     col->hash_of_entities = guid_hash_table_new();
     col->data = NULL;
     return col;
@@ -69,7 +74,9 @@ qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
     g_hash_table_destroy(col->hash_of_entities);
+    g_ptr_array_free(col->entities, TRUE);
     col->e_type = NULL;
+    col->entities = NULL;
     col->hash_of_entities = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
     g_free (col);
@@ -86,6 +93,52 @@ qof_collection_get_type (const QofCollection *col)
 
 /* =============================================================== */
 
+static inline guint
+collection_index (const QofCollection *col, const GncGUID *guid)
+{
+    return GPOINTER_TO_UINT (g_hash_table_lookup (col->hash_of_entities, guid));
+}
+
+/* Stores ent under its GUID, replacing any entity with the same GUID. */
+static void
+collection_put (QofCollection *col, QofInstance *ent)
+{
+    const GncGUID *guid = qof_instance_get_guid(ent);
+    guint index = collection_index (col, guid);
+
+    if (index)
+    {
+        g_ptr_array_index (col->entities, index - 1) = ent;
+    }
+    else
+    {
+        g_ptr_array_add (col->entities, ent);
+        index = col->entities->len;
+    }
+    /* replace rather than insert, the key must be ent's own GUID */
+    g_hash_table_replace (col->hash_of_entities, (gpointer)guid,
+                          GUINT_TO_POINTER (index));
+}
+
+/* Removes the entity with guid by moving the last one into its slot. */
+static void
+collection_drop (QofCollection *col, const GncGUID *guid)
+{
+    guint index = collection_index (col, guid);
+
+    if (!index) return;
+    g_hash_table_remove (col->hash_of_entities, guid);
+    g_ptr_array_remove_index_fast (col->entities, index - 1);
+    if (index - 1 < col->entities->len)
+    {
+        QofInstance *moved = QOF_INSTANCE (g_ptr_array_index (col->entities,
+                                                              index - 1));
+        g_hash_table_insert (col->hash_of_entities,
+                             (gpointer)qof_instance_get_guid(moved),
+                             GUINT_TO_POINTER (index));
+    }
+}
+
 void
 qof_collection_remove_entity (QofInstance *ent)
 {
@@ -96,7 +149,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    collection_drop (col, guid);
     qof_instance_set_collection(ent, NULL);
 }
 
@@ -110,7 +163,7 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    collection_put (col, ent);
     qof_instance_set_collection(ent, col);
 }
 
@@ -136,7 +189,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    collection_put (coll, ent);
     return TRUE;
 }
 
@@ -220,12 +273,34 @@ qof_collection_compare (QofCollection *target, QofCollection *merge)
 QofInstance *
 qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
 {
-    QofInstance *ent;
+    guint index;
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = static_cast<QofInstance*>(g_hash_table_lookup (col->hash_of_entities,
-							 guid));
-    return ent;
+    index = collection_index (col, guid);
+    if (!index) return NULL;
+    return static_cast<QofInstance*>(g_ptr_array_index (col->entities,
+                                                        index - 1));
+}
+
+guint
+qof_collection_lookup_entities (const QofCollection *col,
+                                const GncGUID *guids, guint n,
+                                QofInstance **entities)
+{
+    guint found = 0;
+    g_return_val_if_fail (col, 0);
+    g_return_val_if_fail (guids || n == 0, 0);
+    g_return_val_if_fail (entities || n == 0, 0);
+
+    for (guint i = 0; i < n; ++i)
+    {
+        guint index = collection_index (col, &guids[i]);
+        entities[i] = index ? static_cast<QofInstance*>(
+            g_ptr_array_index (col->entities, index - 1)) : NULL;
+        if (entities[i])
+            ++found;
+    }
+    return found;
 }
 
 QofCollection *
@@ -252,7 +327,7 @@ qof_collection_count (const QofCollection *col)
 {
     guint c;
 
-    c = g_hash_table_size(col->hash_of_entities);
+    c = col->entities->len;
     return c;
 }
 
@@ -309,40 +384,22 @@ qof_collection_set_data (QofCollection *col, gpointer user_data)
 
 /* =============================================================== */
 
-struct _iterate
-{
-    QofInstanceForeachCB      fcn;
-    gpointer                data;
-};
-
-static void
-foreach_cb (gpointer item, gpointer arg)
-{
-    struct _iterate *iter = static_cast<_iterate*>(arg);
-    QofInstance *ent = static_cast<QofInstance*>(item);
-
-    iter->fcn (ent, iter->data);
-}
-
 void
 qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb_func,
                         gpointer user_data)
 {
-    struct _iterate iter;
-    GList *entries;
-
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    iter.fcn = cb_func;
-    iter.data = user_data;
-
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s before is %d", col->e_type, col->entities->len);
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
-    g_list_foreach (entries, foreach_cb, &iter);
-    g_list_free (entries);
+    /* The callback may add or remove entities, which reorders the
+     * array, so walk a copy of it. */
+    auto first = reinterpret_cast<QofInstance**>(col->entities->pdata);
+    std::vector<QofInstance*> entries (first, first + col->entities->len);
+    for (auto ent : entries)
+        cb_func (ent, user_data);
 
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s after is %d", col->e_type, col->entities->len);
 }
 /* =============================================================== */
@@ -164,6 +164,14 @@ QofIdType qof_collection_get_type (const QofCollection *);
 /*@ dependent @*/
 QofInstance * qof_collection_lookup_entity (const QofCollection *, const GncGUID *);
 
+/** Look up @a n entities at once, for loaders resolving many
+ *  references in a row.  @a entities[i] is set to the entity with
+ *  GUID @a guids[i], or NULL if there is none.
+ *  @return The number of entities found. */
+guint qof_collection_lookup_entities (const QofCollection *col,
+                                      const GncGUID *guids, guint n,
+                                      QofInstance **entities);
+
 /** Callback type for qof_collection_foreach */
 typedef void (*QofInstanceForeachCB) (QofInstance *, gpointer user_data);
 
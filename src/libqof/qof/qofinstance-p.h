@@ -31,6 +31,7 @@
 #define QOF_INSTANCE_P_H
 
 #include "qofinstance.h"
+#include "gnc-numeric.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -130,6 +131,24 @@ void qof_instance_set_kvp (QofInstance *inst, const gchar *key, const GValue *va
  */
 void qof_instance_get_kvp (const QofInstance *inst, const gchar *key, GValue
 *value);
+/** Typed accessors reading a KVP slot in place, without going through a
+ * GValue, for getters called often enough for the copy to matter.
+ * @param inst: The QofInstance
+ * @param key: The key of or '/'-delimited path to the slot.
+ * @param value: Where to store the value; left alone if the slot is
+ *               missing or holds another type.
+ * @return TRUE if the slot exists and holds the requested type.
+ */
+gboolean qof_instance_kvp_get_int64 (const QofInstance *inst, const gchar *key,
+                                     gint64 *value);
+gboolean qof_instance_kvp_get_numeric (const QofInstance *inst,
+                                       const gchar *key, gnc_numeric *value);
+/** @return The string in the slot, owned by the instance, or NULL. */
+const char* qof_instance_kvp_get_string (const QofInstance *inst,
+                                         const gchar *key);
+/** @return The GncGUID in the slot, owned by the instance, or NULL. */
+const GncGUID* qof_instance_kvp_get_guid (const QofInstance *inst,
+                                          const gchar *key);
 /** @} Close out the DOxygen ingroup */
 /* Functions to isolate the KVP mechanism inside QOF for cases where
 GValue * operations won't work.
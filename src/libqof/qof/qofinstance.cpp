@@ -271,6 +271,13 @@ qof_instance_init (QofInstance *inst)
 
 void
 qof_instance_init_data (QofInstance *inst, QofIdType type, QofBook *book)
+{
+    qof_instance_init_data_with_guid (inst, type, book, NULL);
+}
+
+void
+qof_instance_init_data_with_guid (QofInstance *inst, QofIdType type,
+                                  QofBook *book, const GncGUID *guid)
 {
     QofInstancePrivate *priv;
     QofCollection *col;
@@ -281,6 +288,7 @@ qof_instance_init_data (QofInstance *inst, QofIdType type, QofBook *book)
     g_return_if_fail(!priv->book);
 
     priv->book = book;
+    qof_book_bump_generation (book);
     col = qof_book_get_collection (book, type);
     g_return_if_fail(col != NULL);
 
@@ -296,7 +304,10 @@ qof_instance_init_data (QofInstance *inst, QofIdType type, QofBook *book)
     priv = GET_PRIVATE(inst);
     inst->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
 
-    do
+    if (guid && !guid_equal (guid, guid_null ()) &&
+        NULL == qof_collection_lookup_entity (col, guid))
+        priv->guid = *guid;
+    else do
     {
         guid_replace(&priv->guid);
 
@@ -670,6 +681,8 @@ qof_instance_set_dirty_flag (gconstpointer inst, gboolean flag)
 {
     g_return_if_fail(QOF_IS_INSTANCE(inst));
     GET_PRIVATE(inst)->dirty = flag;
+    if (flag)
+        qof_book_bump_generation (GET_PRIVATE(inst)->book);
 }
 
 void
@@ -716,6 +729,7 @@ qof_instance_set_dirty(QofInstance* inst)
 
     priv = GET_PRIVATE(inst);
     priv->dirty = TRUE;
+    qof_book_bump_generation (priv->book);
 }
 
 gboolean
@@ -1003,6 +1017,8 @@ qof_commit_edit_part2(QofInstance *inst,
     QofBackend * be;
 
     priv = GET_PRIVATE(inst);
+    qof_book_bump_generation (priv->book);
+    QOF_PROFILE_COUNT ("commit");
 
     if (priv->dirty &&
         !(priv->infant && priv->do_free)) {
@@ -1015,6 +1031,7 @@ qof_commit_edit_part2(QofInstance *inst,
     if (be && qof_backend_commit_exists(be))
     {
         QofBackendError errcode;
+        QOF_PROFILE_BEGIN (start);
 
         /* clear errors */
         do
@@ -1024,6 +1041,7 @@ qof_commit_edit_part2(QofInstance *inst,
         while (ERR_BACKEND_NO_ERR != errcode);
 
         qof_backend_run_commit(be, inst);
+        QOF_PROFILE_END (start, "backend-commit");
         errcode = qof_backend_get_error(be);
         if (ERR_BACKEND_NO_ERR != errcode)
         {
@@ -1079,6 +1097,56 @@ qof_instance_get_kvp (const QofInstance *inst, const gchar *key, GValue *value)
     }
 }
 
+/* The slot at key if it holds a value of type, else nullptr. */
+static KvpValue*
+kvp_slot_of_type (const QofInstance *inst, const gchar *key,
+                  KvpValue::Type type)
+{
+    if (!inst || !key) return nullptr;
+    auto slot = inst->kvp_data->get_slot(key);
+    if (slot == nullptr || slot->get_type() != type)
+        return nullptr;
+    return slot;
+}
+
+gboolean
+qof_instance_kvp_get_int64 (const QofInstance *inst, const gchar *key,
+                            gint64 *value)
+{
+    auto slot = kvp_slot_of_type (inst, key, KvpValue::Type::INT64);
+    if (slot == nullptr)
+        return FALSE;
+    if (value)
+        *value = slot->get<int64_t>();
+    return TRUE;
+}
+
+gboolean
+qof_instance_kvp_get_numeric (const QofInstance *inst, const gchar *key,
+                              gnc_numeric *value)
+{
+    auto slot = kvp_slot_of_type (inst, key, KvpValue::Type::NUMERIC);
+    if (slot == nullptr)
+        return FALSE;
+    if (value)
+        *value = slot->get<gnc_numeric>();
+    return TRUE;
+}
+
+const char*
+qof_instance_kvp_get_string (const QofInstance *inst, const gchar *key)
+{
+    auto slot = kvp_slot_of_type (inst, key, KvpValue::Type::STRING);
+    return slot ? slot->get<const char*>() : nullptr;
+}
+
+const GncGUID*
+qof_instance_kvp_get_guid (const QofInstance *inst, const gchar *key)
+{
+    auto slot = kvp_slot_of_type (inst, key, KvpValue::Type::GUID);
+    return slot ? slot->get<GncGUID*>() : nullptr;
+}
+
 void
 qof_instance_copy_kvp (QofInstance *to, const QofInstance *from)
 {
@@ -92,6 +92,14 @@ GType qof_instance_get_type(void);
 /** Initialise the settings associated with an instance */
 void qof_instance_init_data (QofInstance *, QofIdType, QofBook *);
 
+/** As qof_instance_init_data, but give the instance @a guid rather
+ *  than generating a new one.  This is for loaders that already know
+ *  the GUID and would otherwise generate one only to replace it.  If
+ *  @a guid is NULL or already in use in the collection, a new GUID is
+ *  generated as usual. */
+void qof_instance_init_data_with_guid (QofInstance *, QofIdType, QofBook *,
+                                       const GncGUID *guid);
+
 /** Return the book pointer */
 /*@ dependent @*/
 QofBook *qof_instance_get_book (gconstpointer);
@@ -72,6 +72,9 @@ static gint qof_log_num_spaces = 0;
 static GHashTable *log_table = NULL;
 static GLogFunc previous_handler = NULL;
 
+/* Starts above zero so that every QOF_LOG_SITE_CHECK looks stale at first. */
+guint qof_log_generation = 1;
+
 void
 qof_log_indent(void)
 {
@@ -225,6 +228,7 @@ qof_log_shutdown (void)
     {
         g_hash_table_destroy(log_table);
         log_table = NULL;
+        qof_log_generation++;
     }
 
     if (previous_handler != NULL)
@@ -246,6 +250,7 @@ qof_log_set_level(QofLogModule log_module, QofLogLevel level)
         log_table = g_hash_table_new(g_str_hash, g_str_equal);
     }
     g_hash_table_insert(log_table, g_strdup((gchar*)log_module), GINT_TO_POINTER((gint)level));
+    qof_log_generation++;
 }
 
 const char *
@@ -171,6 +171,23 @@ gboolean qof_log_check(QofLogModule log_module, QofLogLevel log_level);
 /** Set the default level for QOF-related log paths. **/
 void qof_log_set_default(QofLogLevel log_level);
 
+/** Bumped whenever the configured log levels change; see
+ * QOF_LOG_SITE_CHECK. **/
+extern guint qof_log_generation;
+
+/** Declares a static @a enabled flag holding whether log_module logs at
+ * @a log_level.  The flag is kept at the call site and recomputed with
+ * qof_log_check() only when the log levels have changed since, so a
+ * disabled log statement costs a single compare.  Must open a block. **/
+#define QOF_LOG_SITE_CHECK(log_level, enabled) \
+    static guint enabled##_generation = 0; \
+    static gboolean enabled = FALSE; \
+    if (G_UNLIKELY(enabled##_generation != qof_log_generation)) \
+    { \
+        enabled = qof_log_check(log_module, (QofLogLevel)(log_level)); \
+        enabled##_generation = qof_log_generation; \
+    }
+
 #define PRETTY_FUNC_NAME qof_log_prettify(G_STRFUNC)
 
 #ifdef _MSC_VER
@@ -197,19 +214,24 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print an informational note */
 #define PINFO(format, ...) do { \
-    g_log (log_module, G_LOG_LEVEL_INFO, \
-      "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_INFO, qof_log_site_enabled) \
+    if (qof_log_site_enabled) \
+      g_log (log_module, G_LOG_LEVEL_INFO, \
+        "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
 } while (0)
 
 /** Print a debugging message */
 #define DEBUG(format, ...) do { \
-    g_log (log_module, G_LOG_LEVEL_DEBUG, \
-      "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) \
+      g_log (log_module, G_LOG_LEVEL_DEBUG, \
+        "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
 } while (0)
 
 /** Print a function entry debugging message */
 #define ENTER(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , __VA_ARGS__); \
@@ -219,7 +241,8 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
@@ -249,19 +272,24 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print an informational note */
 #define PINFO(format, args...) do { \
-    g_log (log_module, G_LOG_LEVEL_INFO, \
-      "[%s] " format, PRETTY_FUNC_NAME , ## args); \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_INFO, qof_log_site_enabled) \
+    if (qof_log_site_enabled) \
+      g_log (log_module, G_LOG_LEVEL_INFO, \
+        "[%s] " format, PRETTY_FUNC_NAME , ## args); \
 } while (0)
 
 /** Print a debugging message */
 #define DEBUG(format, args...) do { \
-    g_log (log_module, G_LOG_LEVEL_DEBUG, \
-      "[%s] " format, PRETTY_FUNC_NAME , ## args); \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) \
+      g_log (log_module, G_LOG_LEVEL_DEBUG, \
+        "[%s] " format, PRETTY_FUNC_NAME , ## args); \
 } while (0)
 
 /** Print a function entry debugging message */
 #define ENTER(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , ## args); \
@@ -271,7 +299,8 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_CHECK(G_LOG_LEVEL_DEBUG, qof_log_site_enabled) \
+    if (qof_log_site_enabled) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
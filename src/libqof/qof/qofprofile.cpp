@@ -0,0 +1,324 @@
+/********************************************************************\
+ * qofprofile.cpp -- Counters and timers for the hot paths          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include "config.h"
+#include <glib.h>
+#include <glib/gstdio.h>
+}
+
+#include "qof.h"
+#include "qofprofile.h"
+#include "qofevent-p.h"
+
+static QofLogModule log_module = "qof.profile";
+
+/* Only the most recent timed scopes are kept, so that a long session
+ * can't run out of memory; the counters keep the totals. */
+#define MAX_EVENTS 65536
+
+typedef struct
+{
+    QofProfileCounter *counter;
+    gint64 start;
+    gint64 usec;
+} ProfileEvent;
+
+gint qof_profile_active = 0;
+
+/* Guards the counters, the recent scopes and profile_start, so that
+ * marks can come from any thread. */
+G_LOCK_DEFINE_STATIC(qof_profile);
+
+static QofProfileCounter *counters = NULL;
+static ProfileEvent *events = NULL;
+static guint num_events = 0;
+static guint next_event = 0;
+static gint64 profile_start = 0;
+static gchar *profile_file = NULL;
+
+typedef struct
+{
+    QofProfileResetFunc reset;
+    QofProfileReportFunc report;
+} ProfileReport;
+
+static GList *reports = NULL;
+
+/* Called with the lock held. */
+static void
+profile_count (QofProfileCounter *counter)
+{
+    if (!counter->registered)
+    {
+        counter->registered = TRUE;
+        counter->next = counters;
+        counters = counter;
+    }
+    counter->count++;
+}
+
+void
+qof_profile_count (QofProfileCounter *counter)
+{
+    G_LOCK(qof_profile);
+    profile_count (counter);
+    G_UNLOCK(qof_profile);
+}
+
+gint64
+qof_profile_begin (void)
+{
+    return g_get_monotonic_time ();
+}
+
+void
+qof_profile_end (QofProfileCounter *counter, gint64 start)
+{
+    gint64 usec = g_get_monotonic_time () - start;
+    ProfileEvent *event;
+
+    G_LOCK(qof_profile);
+    /* Profiling might have been restarted or stopped inside the scope. */
+    if (!QOF_PROFILE_IS_ACTIVE () || start < profile_start)
+    {
+        G_UNLOCK(qof_profile);
+        return;
+    }
+
+    profile_count (counter);
+    counter->usec += usec;
+
+    event = &events[next_event];
+    event->counter = counter;
+    event->start = start;
+    event->usec = usec;
+    next_event = (next_event + 1) % MAX_EVENTS;
+    if (num_events < MAX_EVENTS)
+        num_events++;
+    G_UNLOCK(qof_profile);
+}
+
+void
+qof_profile_register_report (QofProfileResetFunc reset,
+                             QofProfileReportFunc report)
+{
+    ProfileReport *pr;
+    GList *node;
+
+    g_return_if_fail (report);
+    for (node = reports; node; node = node->next)
+        if (static_cast<ProfileReport*>(node->data)->report == report)
+            return;
+    pr = g_new (ProfileReport, 1);
+    pr->reset = reset;
+    pr->report = report;
+    reports = g_list_append (reports, pr);
+}
+
+void
+qof_profile_unregister_report (QofProfileReportFunc report)
+{
+    GList *node;
+
+    for (node = reports; node; node = node->next)
+    {
+        ProfileReport *pr = static_cast<ProfileReport*>(node->data);
+        if (pr->report == report)
+        {
+            reports = g_list_delete_link (reports, node);
+            g_free (pr);
+            return;
+        }
+    }
+}
+
+gchar *
+qof_profile_summary (void)
+{
+    GString *summary = g_string_new (NULL);
+    GList *node;
+
+    for (node = reports; node; node = node->next)
+        static_cast<ProfileReport*>(node->data)->report (summary);
+    return g_string_free (summary, FALSE);
+}
+
+void
+qof_profile_set_active (gboolean active)
+{
+    QofProfileCounter *counter;
+    GList *node;
+
+    if (active)
+    {
+        for (node = reports; node; node = node->next)
+        {
+            ProfileReport *pr = static_cast<ProfileReport*>(node->data);
+            if (pr->reset)
+                pr->reset ();
+        }
+        G_LOCK(qof_profile);
+        for (counter = counters; counter; counter = counter->next)
+        {
+            counter->count = 0;
+            counter->usec = 0;
+        }
+        if (!events)
+            events = g_new (ProfileEvent, MAX_EVENTS);
+        num_events = next_event = 0;
+        profile_start = g_get_monotonic_time ();
+        g_atomic_int_set (&qof_profile_active, 1);
+        G_UNLOCK(qof_profile);
+    }
+    else
+        g_atomic_int_set (&qof_profile_active, 0);
+    PINFO ("profiling %s", active ? "started" : "stopped");
+}
+
+static void
+append_string (GString *json, const char *str)
+{
+    gchar *escaped = g_strescape (str, NULL);
+    g_string_append_printf (json, "\"%s\"", escaped);
+    g_free (escaped);
+}
+
+gboolean
+qof_profile_dump (const char *filename, GError **error)
+{
+    GString *json = g_string_new ("{\"traceEvents\":[");
+    GHashTable *totals = g_hash_table_new (g_str_hash, g_str_equal);
+    QofProfileCounter *counter;
+    GHashTableIter iter;
+    gpointer key, value;
+    gint64 now;
+    guint i, first;
+    gchar *summary, **lines, **line;
+    gboolean ok;
+
+    G_LOCK(qof_profile);
+    now = g_get_monotonic_time () - profile_start;
+    first = (next_event + MAX_EVENTS - num_events) % MAX_EVENTS;
+    for (i = 0; i < num_events; ++i)
+    {
+        ProfileEvent *event = &events[(first + i) % MAX_EVENTS];
+
+        g_string_append (json, i ? ",\n{\"name\":" : "\n{\"name\":");
+        append_string (json, event->counter->name);
+        g_string_append_printf (json, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                                "\"ts\":%" G_GINT64_FORMAT
+                                ",\"dur\":%" G_GINT64_FORMAT "}",
+                                event->start - profile_start, event->usec);
+    }
+
+    /* Call sites sharing a name are reported as one counter. */
+    for (counter = counters; counter; counter = counter->next)
+    {
+        QofProfileCounter *total =
+            static_cast<QofProfileCounter*>(g_hash_table_lookup (totals, counter->name));
+        if (!total)
+        {
+            total = g_new0 (QofProfileCounter, 1);
+            total->name = counter->name;
+            g_hash_table_insert (totals, (gpointer)counter->name, total);
+        }
+        total->count += counter->count;
+        total->usec += counter->usec;
+    }
+    g_hash_table_iter_init (&iter, totals);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        QofProfileCounter *total = static_cast<QofProfileCounter*>(value);
+
+        g_string_append (json, json->str[json->len - 1] == '['
+                         ? "\n{\"name\":" : ",\n{\"name\":");
+        append_string (json, total->name);
+        g_string_append_printf (json, ",\"ph\":\"C\",\"pid\":1,\"tid\":1,"
+                                "\"ts\":%" G_GINT64_FORMAT ",\"args\":"
+                                "{\"count\":%" G_GINT64_FORMAT
+                                ",\"usec\":%" G_GINT64_FORMAT "}}",
+                                now, total->count, total->usec);
+        g_free (total);
+    }
+    g_hash_table_destroy (totals);
+    G_UNLOCK(qof_profile);
+
+    summary = qof_profile_summary ();
+    lines = g_strsplit (summary, "\n", -1);
+    for (line = lines; *line; ++line)
+        if (**line)
+            PINFO ("%s", *line);
+    g_strfreev (lines);
+    g_string_append (json, "\n],\"displayTimeUnit\":\"ms\",\"metadata\":{\"summary\":");
+    append_string (json, summary);
+    g_free (summary);
+    g_string_append (json, "}}\n");
+    ok = g_file_set_contents (filename, json->str, json->len, error);
+    g_string_free (json, TRUE);
+    return ok;
+}
+
+void
+qof_profile_init (void)
+{
+    const gchar *filename = g_getenv ("GNC_PROFILE");
+
+    qof_profile_register_report (qof_event_reset_stats,
+                                 qof_event_report_stats);
+    if (!filename || !*filename || profile_file)
+        return;
+    profile_file = g_strdup (filename);
+    qof_profile_set_active (TRUE);
+}
+
+void
+qof_profile_write (void)
+{
+    GError *error = NULL;
+
+    if (!profile_file || !QOF_PROFILE_IS_ACTIVE ())
+        return;
+    if (!qof_profile_dump (profile_file, &error))
+    {
+        PWARN ("Unable to write the profile to %s: %s", profile_file,
+               error->message);
+        g_error_free (error);
+    }
+    qof_profile_set_active (FALSE);
+}
+
+void
+qof_profile_shutdown (void)
+{
+    qof_profile_write ();
+    g_atomic_int_set (&qof_profile_active, 0);
+    g_free (profile_file);
+    profile_file = NULL;
+    G_LOCK(qof_profile);
+    g_free (events);
+    events = NULL;
+    num_events = next_event = 0;
+    G_UNLOCK(qof_profile);
+    g_list_free_full (reports, g_free);
+    reports = NULL;
+}
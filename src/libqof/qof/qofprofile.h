@@ -0,0 +1,159 @@
+/********************************************************************\
+ * qofprofile.h -- Counters and timers for the hot paths            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @addtogroup Utilities
+    @{ */
+/** @file qofprofile.h
+    @brief Named counters and scoped timers for finding slow subsystems.
+
+    Code marks the operations worth watching with QOF_PROFILE_COUNT, or
+    with a QOF_PROFILE_BEGIN / QOF_PROFILE_END pair around a scope that
+    should also be timed.  Nothing is recorded until profiling is made
+    active, either by setting the GNC_PROFILE environment variable to a
+    file name, in which case the results are written there by
+    qof_profile_write() or at the latest by qof_close(), or with
+    qof_profile_set_active(); while it is inactive each mark costs one
+    compare.  Defining QOF_PROFILE_DISABLE compiles the marks out
+    altogether.
+
+    The results are written in the Chrome trace-event format, so they
+    can be loaded into chrome://tracing or any viewer reading it: one
+    complete event per timed scope, for the most recent ones, and a
+    counter event with the totals of each name.
+
+    Subsystems keeping statistics that don't fit a counter, like the
+    event system, register a report with qof_profile_register_report();
+    the reports make up a plain-text summary that is written into the
+    trace's metadata and, at the info level of the qof.profile log
+    module, to the log.
+
+    Marks may be made from any thread: the gate is read atomically and
+    the counters and the recent scopes are kept under a lock, which is
+    only taken while profiling is active.
+*/
+
+#ifndef QOF_PROFILE_H
+#define QOF_PROFILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** The totals for one call site.  Sites with the same name are added
+ * together in the output. */
+typedef struct QofProfileCounter
+{
+    const char *name;
+    gint64 count;
+    gint64 usec;
+    gboolean registered;
+    struct QofProfileCounter *next;
+} QofProfileCounter;
+
+/** Non-zero while profiling is active.  Read it through
+ * QOF_PROFILE_IS_ACTIVE(), never directly. */
+extern gint qof_profile_active;
+
+/** Whether profiling is active, read atomically. */
+#define QOF_PROFILE_IS_ACTIVE() g_atomic_int_get (&qof_profile_active)
+
+/** Makes profiling active if GNC_PROFILE is set; called by qof_init(). */
+void qof_profile_init (void);
+
+/** Writes the trace to the GNC_PROFILE file, if it was set and
+ * profiling is still active, and stops profiling.  Applications call it
+ * before tearing down the subsystems whose reports go into the summary;
+ * otherwise qof_profile_shutdown() does. */
+void qof_profile_write (void);
+
+/** Calls qof_profile_write() and releases what was recorded; called by
+ * qof_close(). */
+void qof_profile_shutdown (void);
+
+/** Starts or stops recording.  Starting discards whatever was recorded
+ * before. */
+void qof_profile_set_active (gboolean active);
+
+/** Writes what was recorded so far as Chrome trace-event JSON. */
+gboolean qof_profile_dump (const char *filename, GError **error);
+
+/** Clears a subsystem's statistics; called when profiling starts. */
+typedef void (*QofProfileResetFunc) (void);
+
+/** Appends a subsystem's statistics, as lines of text, to the summary. */
+typedef void (*QofProfileReportFunc) (GString *summary);
+
+/** Adds a report to the summary.  Both functions are called only on the
+ * main thread, from qof_profile_set_active() and qof_profile_dump(). */
+void qof_profile_register_report (QofProfileResetFunc reset,
+                                  QofProfileReportFunc report);
+void qof_profile_unregister_report (QofProfileReportFunc report);
+
+/** Returns the reports of all subsystems; g_free it. */
+gchar *qof_profile_summary (void);
+
+void qof_profile_count (QofProfileCounter *counter);
+gint64 qof_profile_begin (void);
+void qof_profile_end (QofProfileCounter *counter, gint64 start);
+
+#ifdef QOF_PROFILE_DISABLE
+
+#define QOF_PROFILE_COUNT(counter_name) do { } while (0)
+#define QOF_PROFILE_BEGIN(start) gint64 start = 0
+#define QOF_PROFILE_END(start, counter_name) do { (void)(start); } while (0)
+
+#else /* QOF_PROFILE_DISABLE */
+
+/** Counts one occurrence of counter_name, a string literal. */
+#define QOF_PROFILE_COUNT(counter_name) do { \
+    if (G_UNLIKELY(QOF_PROFILE_IS_ACTIVE())) { \
+        static QofProfileCounter qof_profile_site = \
+            { counter_name, 0, 0, FALSE, NULL }; \
+        qof_profile_count (&qof_profile_site); \
+    } \
+} while (0)
+
+/** Declares start and, if profiling is active, notes the time in it.
+ * Being a declaration it has to come first in its block. */
+#define QOF_PROFILE_BEGIN(start) \
+    gint64 start = G_UNLIKELY(QOF_PROFILE_IS_ACTIVE()) ? qof_profile_begin () : 0
+
+/** Counts one occurrence of counter_name and the time since the
+ * matching QOF_PROFILE_BEGIN. */
+#define QOF_PROFILE_END(start, counter_name) do { \
+    if (G_UNLIKELY(start)) { \
+        static QofProfileCounter qof_profile_site = \
+            { counter_name, 0, 0, FALSE, NULL }; \
+        qof_profile_end (&qof_profile_site, start); \
+    } \
+} while (0)
+
+#endif /* QOF_PROFILE_DISABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QOF_PROFILE_H */
+/** @} */
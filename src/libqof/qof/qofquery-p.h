@@ -36,6 +36,13 @@ extern "C"
 
 /* Functions to get Query information */
 int qof_query_get_max_results (const QofQuery *q);
+gboolean qof_query_get_parallel (const QofQuery *q);
+
+/* Parallel queries scan on threads from min_objects objects on, with
+ * n_threads threads or one per processor if it is 0.  The defaults
+ * are 10000 and 0; the tests lower them to reach the threads with a
+ * small book. */
+void qof_query_set_parallel_limits (guint min_objects, guint n_threads);
 
 
 /* Functions to get and look at QueryTerms */
@@ -45,6 +45,11 @@ extern "C"
 #include "qofquery-p.h"
 #include "qofquerycore-p.h"
 
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
 static QofLogModule log_module = QOF_MOD_QUERY;
 
 struct _QofQueryTerm
@@ -60,8 +65,17 @@ struct _QofQueryTerm
      */
     GSList *                param_fcns;
     QofQueryPredicateFunc   pred_fcn;
+
+    /* The number of conversions in param_fcns before the getter, and
+     * how many of them are the same as those of the term evaluated
+     * just before this one, whose results can be reused. */
+    guint                   conv_depth;
+    guint                   conv_shared;
 };
 
+/* The longest conversion chain check_object keeps results of */
+#define QUERY_MAX_CONV 8
+
 struct _QofQuerySort
 {
     QofQueryParamList * param_list;
@@ -79,6 +93,19 @@ struct _QofQuerySort
     QofCompareFunc      comp_fcn;       /* When you are comparing core types */
 };
 
+/* A live query keeps every match, sorted, between runs and patches
+ * them from the engine events instead of searching again. */
+typedef struct
+{
+    gint              handler_id;
+    GSequence *       matches;    /* NULL until the first run */
+    GHashTable *      iters;      /* object -> its iter in matches */
+    gboolean          stale;      /* a change couldn't be applied */
+    gboolean          dirty;      /* results need rebuilding */
+    guint             dropped;    /* qof_event_get_dropped_count() at the
+                                     last search */
+} QofQueryLive;
+
 /* The QUERY structure */
 struct _QofQuery
 {
@@ -99,6 +126,12 @@ struct _QofQuery
     /* The maximum number of results to return */
     gint              max_results;
 
+    /* Whether the predicates may be evaluated on worker threads */
+    gboolean          parallel;
+
+    /* The state of a live query, NULL if it isn't one */
+    QofQueryLive *    live;
+
     /* list of books that will be participating in the query */
     GList *           books;
 
@@ -116,9 +149,28 @@ typedef struct _QofQueryCB
 {
     QofQuery *        query;
     GList *           list;
+    GPtrArray *       array;      /* collects instead of list if set */
     gint              count;
 } QofQueryCB;
 
+struct _QofQueryCursor
+{
+    GPtrArray *       matches;
+    guint             next;
+    guint             batch_size;
+};
+
+/* Add a match: the list is built backwards, the array in order */
+static void
+query_cb_add (QofQueryCB *qcb, gpointer object)
+{
+    if (qcb->array)
+        g_ptr_array_add (qcb->array, object);
+    else
+        qcb->list = g_list_prepend (qcb->list, object);
+    qcb->count++;
+}
+
 /* initial_term will be owned by the new Query */
 static void query_init (QofQuery *q, QofQueryTerm *initial_term)
 {
@@ -362,6 +414,59 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
     }
 }
 
+/* Select the last max_results objects of the sorted list without
+ * sorting all of it.  The full sort is stable, so ties are broken by
+ * the position in the input list; a min-heap of max_results entries
+ * keyed that way keeps exactly the tail the full sort would leave,
+ * which is then sorted and returned in the same order.
+ */
+typedef std::pair<gpointer, guint> QueryRank;
+
+static GList *
+query_select_top (QofQuery *q, GList *objects, gint max_results)
+{
+    std::vector<QueryRank> heap;
+    guint pos = 0;
+    GList *result = NULL;
+    /* "Greater" puts the smallest kept object on top of the heap. */
+    auto later = [q](const QueryRank& a, const QueryRank& b)
+    {
+        int rc = sort_func (a.first, b.first, q);
+        return rc != 0 ? rc > 0 : a.second > b.second;
+    };
+
+    heap.reserve (max_results);
+    for (GList *node = objects; node; node = node->next, ++pos)
+    {
+        QueryRank rank (node->data, pos);
+        if (heap.size () < static_cast<size_t>(max_results))
+        {
+            heap.push_back (rank);
+            std::push_heap (heap.begin (), heap.end (), later);
+        }
+        else if (later (rank, heap.front ()))
+        {
+            std::pop_heap (heap.begin (), heap.end (), later);
+            heap.back () = rank;
+            std::push_heap (heap.begin (), heap.end (), later);
+        }
+    }
+    g_list_free (objects);
+
+    /* Descending order, so prepending yields the ascending list. */
+    std::sort (heap.begin (), heap.end (), later);
+    for (auto& rank : heap)
+        result = g_list_prepend (result, rank.first);
+    return result;
+}
+
+static gboolean
+query_is_sorted (const QofQuery *q)
+{
+    return q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+           (q->primary_sort.use_default && q->defaultSort);
+}
+
 /* ==================================================================== */
 /* This is the main workhorse for performing the query.  For each
  * object, it walks over all of the query terms to see if the
@@ -375,22 +480,33 @@ check_object (const QofQuery *q, gpointer object)
     const GList     * or_ptr;
     const QofQueryTerm * qt;
     int       and_terms_ok = 1;
+    /* conv[i] is the object after the first i conversions of the
+     * previous term's path, valid for i <= conv_valid. */
+    gpointer  conv[QUERY_MAX_CONV + 1];
+    guint     conv_valid;
 
+    conv[0] = object;
     for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
     {
         and_terms_ok = 1;
+        conv_valid = 0;
         for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
 	     and_ptr = static_cast<GList*>(and_ptr->next))
         {
             qt = (QofQueryTerm *)(and_ptr->data);
             if (qt->param_fcns && qt->pred_fcn)
             {
-                const GSList *node;
+                const GSList *node = qt->param_fcns;
                 QofParam *param = NULL;
-                gpointer conv_obj = object;
+                guint depth = MIN (qt->conv_shared, conv_valid);
+                gpointer conv_obj = conv[depth];
 
-                /* iterate through the conversions */
-                for (node = qt->param_fcns; node; node = node->next)
+                /* skip the conversions already done for the last term */
+                for (guint i = 0; i < depth; i++)
+                    node = node->next;
+
+                /* iterate through the remaining conversions */
+                for (; node; node = node->next)
                 {
                     param = static_cast<QofParam*>(node->data);
 
@@ -398,7 +514,10 @@ check_object (const QofQuery *q, gpointer object)
                     if (!node->next) break;
 
                     conv_obj = param->param_getfcn (conv_obj, param);
+                    if (++depth <= QUERY_MAX_CONV)
+                        conv[depth] = conv_obj;
                 }
+                conv_valid = MIN (qt->conv_depth, QUERY_MAX_CONV);
 
                 if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
                 {
@@ -524,6 +643,8 @@ static void compile_terms (QofQuery *q)
      */
     for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
     {
+        const QofQueryTerm* prev = NULL;
+
         for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
 	     and_ptr = static_cast<GList*>(and_ptr->next))
         {
@@ -545,6 +666,27 @@ static void compile_terms (QofQuery *q)
                 qt->pred_fcn = qof_query_core_get_predicate (resObj->param_type);
             else
                 qt->pred_fcn = NULL;
+
+            /* Note how much of the path is shared with the previous
+             * term check_object will evaluate, so that it can reuse
+             * those conversions instead of repeating them. */
+            qt->conv_depth = qt->param_fcns ?
+                             g_slist_length (qt->param_fcns) - 1 : 0;
+            qt->conv_shared = 0;
+            if (!qt->param_fcns || !qt->pred_fcn)
+                continue;
+            if (prev)
+            {
+                const GSList *a = qt->param_fcns, *b = prev->param_fcns;
+                while (qt->conv_shared < MIN (qt->conv_depth, prev->conv_depth)
+                        && a->data == b->data)
+                {
+                    qt->conv_shared++;
+                    a = a->next;
+                    b = b->next;
+                }
+            }
+            prev = qt;
         }
     }
 
@@ -579,8 +721,7 @@ static void check_item_cb (gpointer object, gpointer user_data)
 
     if (check_object (ql->query, object))
     {
-        ql->list = g_list_prepend (ql->list, object);
-        ql->count++;
+        query_cb_add (ql, object);
     }
     return;
 }
@@ -732,6 +873,7 @@ static GList * qof_query_run_internal (QofQuery *q,
 {
     GList *matching_objects = NULL;
     int        object_count = 0;
+    QOF_PROFILE_BEGIN (start);
 
     if (!q) return NULL;
     g_return_val_if_fail (q->search_for, NULL);
@@ -775,11 +917,19 @@ static GList * qof_query_run_internal (QofQuery *q,
      */
     matching_objects = g_list_reverse(matching_objects);
 
-    /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
+    /* Now sort the matching objects based on the search criteria.  When
+     * only a few of many results are wanted, select them directly. */
+    if (query_is_sorted (q))
     {
-        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
+        if (q->max_results > 0 && q->max_results < object_count / 4)
+        {
+            matching_objects = query_select_top (q, matching_objects,
+                                                 q->max_results);
+            object_count = q->max_results;
+        }
+        else
+            matching_objects = g_list_sort_with_data(matching_objects,
+                                                     sort_func, q);
     }
 
     /* Crop the list to limit the number of splits. */
@@ -814,17 +964,103 @@ static GList * qof_query_run_internal (QofQuery *q,
     g_list_free(q->results);
     q->results = matching_objects;
 
+    QOF_PROFILE_END (start, "query-run");
     LEAVE (" q=%p", q);
     return matching_objects;
 }
 
+/* The index functions registered for each searched-for type */
+static GHashTable *query_indexes = NULL;
+
+void
+qof_query_register_index (QofIdTypeConst obj_type, QofQueryIndexFunc index_fcn)
+{
+    g_return_if_fail (obj_type);
+    if (!query_indexes)
+        query_indexes = g_hash_table_new (g_str_hash, g_str_equal);
+    if (index_fcn)
+        g_hash_table_insert (query_indexes, (gpointer)obj_type,
+                             (gpointer)index_fcn);
+    else
+        g_hash_table_remove (query_indexes, obj_type);
+}
+
+/* Below this many objects a scan isn't worth handing out to threads */
+static guint query_parallel_min = 10000;
+/* The number of threads to hand it out to, 0 for one per processor */
+static guint query_parallel_threads = 0;
+
+void
+qof_query_set_parallel_limits (guint min_objects, guint n_threads)
+{
+    query_parallel_min = min_objects;
+    query_parallel_threads = n_threads;
+}
+
+static void collect_item_cb (gpointer object, gpointer user_data)
+{
+    static_cast<std::vector<gpointer>*>(user_data)->push_back (object);
+}
+
+/* Evaluate the query terms over the book's objects in contiguous
+ * chunks, one per worker thread.  The threads only read the compiled
+ * terms and the objects; the matches are merged afterwards in chunk
+ * order so that the result is the same as that of the serial scan.
+ */
+static void
+check_items_parallel (QofQueryCB* qcb, QofBook* book)
+{
+    std::vector<gpointer> objects;
+    guint n_threads = query_parallel_threads ? query_parallel_threads
+                      : g_get_num_processors ();
+
+    qof_object_foreach (qcb->query->search_for, book,
+                        (QofInstanceForeachCB) collect_item_cb, &objects);
+    if (n_threads < 2 || objects.size () < query_parallel_min)
+    {
+        for (auto object : objects)
+            check_item_cb (object, qcb);
+        return;
+    }
+
+    std::vector<std::vector<gpointer>> matches (n_threads);
+    std::vector<std::thread> workers;
+    size_t chunk = (objects.size () + n_threads - 1) / n_threads;
+    const QofQuery* query = qcb->query;
+
+    for (guint i = 0; i < n_threads; ++i)
+    {
+        size_t begin = std::min (i * chunk, objects.size ());
+        size_t end = std::min (begin + chunk, objects.size ());
+        workers.emplace_back ([&, i, begin, end]()
+        {
+            for (size_t j = begin; j < end; ++j)
+                if (objects[j] && check_object (query, objects[j]))
+                    matches[i].push_back (objects[j]);
+        });
+    }
+    for (auto& worker : workers)
+        worker.join ();
+
+    for (auto& chunk_matches : matches)
+        for (auto object : chunk_matches)
+        {
+            query_cb_add (qcb, object);
+        }
+}
+
 static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 {
+    QofQueryIndexFunc index_fcn = NULL;
     GList *node;
 
     (void)cb_arg; /* unused */
     g_return_if_fail(qcb);
 
+    if (query_indexes)
+        index_fcn = reinterpret_cast<QofQueryIndexFunc>(
+            g_hash_table_lookup (query_indexes, qcb->query->search_for));
+
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
@@ -842,16 +1078,412 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 
-        /* And then iterate over all the objects */
+        /* And then iterate over the candidates from the index if there
+         * is one fit for the query, or else over all the objects */
+        if (index_fcn && index_fcn (qcb->query, book,
+                                    (QofInstanceForeachCB) check_item_cb, qcb))
+            continue;
+        if (qcb->query->parallel)
+        {
+            check_items_parallel (qcb, book);
+            continue;
+        }
         qof_object_foreach (qcb->query->search_for, book,
                             (QofInstanceForeachCB) check_item_cb, qcb);
     }
 }
 
+/* The dependents functions registered for each searched-for type */
+static GHashTable *query_dependents = NULL;
+
+void
+qof_query_register_dependents (QofIdTypeConst obj_type,
+                               QofQueryDependentsFunc dep_fcn)
+{
+    g_return_if_fail (obj_type);
+    if (!query_dependents)
+        query_dependents = g_hash_table_new (g_str_hash, g_str_equal);
+    if (dep_fcn)
+        g_hash_table_insert (query_dependents, (gpointer)obj_type,
+                             reinterpret_cast<gpointer>(dep_fcn));
+    else
+        g_hash_table_remove (query_dependents, obj_type);
+}
+
+/* Build the result list: the last max_results of the matches */
+static GList *
+query_live_results (const QofQuery *q)
+{
+    GSequenceIter *iter = g_sequence_get_end_iter (q->live->matches);
+    gint count = g_sequence_get_length (q->live->matches);
+    GList *list = NULL;
+
+    if (q->max_results > -1 && count > q->max_results)
+        count = q->max_results;
+    while (count-- > 0)
+    {
+        iter = g_sequence_iter_prev (iter);
+        list = g_list_prepend (list, g_sequence_get (iter));
+    }
+    return list;
+}
+
+static void
+query_live_insert (QofQuery *q, gpointer object)
+{
+    QofQueryLive *live = q->live;
+    GSequenceIter *iter;
+
+    if (query_is_sorted (q))
+        iter = g_sequence_insert_sorted (live->matches, object, sort_func, q);
+    else
+        iter = g_sequence_append (live->matches, object);
+    g_hash_table_insert (live->iters, object, iter);
+}
+
+static void collect_changed_cb (gpointer object, gpointer user_data)
+{
+    g_ptr_array_add (static_cast<GPtrArray*>(user_data), object);
+}
+
+static void
+query_live_event_cb (QofInstance *ent, QofEventId event_type,
+                     gpointer handler_data, gpointer event_data)
+{
+    QofQuery *q = static_cast<QofQuery*>(handler_data);
+    QofQueryLive *live = q->live;
+    GPtrArray *changed;
+
+    /* Nothing to patch, or the next run searches again anyway.  After
+     * dropped events the matches may even hold destroyed objects. */
+    if (live->dropped != qof_event_get_dropped_count ())
+        live->stale = TRUE;
+    if (!live->matches || live->stale || q->changed)
+        return;
+    if (!g_list_find (q->books, qof_instance_get_book (ent)))
+        return;
+
+    changed = g_ptr_array_new ();
+    if (!g_strcmp0 (ent->e_type, q->search_for))
+    {
+        g_ptr_array_add (changed, ent);
+    }
+    else
+    {
+        QofQueryDependentsFunc dep_fcn = NULL;
+
+        if (query_dependents)
+            dep_fcn = reinterpret_cast<QofQueryDependentsFunc>(
+                g_hash_table_lookup (query_dependents, q->search_for));
+        if (!dep_fcn || !dep_fcn (q, ent,
+                                  (QofInstanceForeachCB) collect_changed_cb,
+                                  changed))
+        {
+            live->stale = TRUE;
+            g_ptr_array_free (changed, TRUE);
+            return;
+        }
+    }
+
+    /* Take all of them out before putting any back, the order of the
+     * rest must hold while looking for the place of each. */
+    for (guint i = 0; i < changed->len; i++)
+    {
+        gpointer object = g_ptr_array_index (changed, i);
+        GSequenceIter *iter = static_cast<GSequenceIter*>(
+            g_hash_table_lookup (live->iters, object));
+        if (!iter) continue;
+        g_sequence_remove (iter);
+        g_hash_table_remove (live->iters, object);
+        live->dirty = TRUE;
+    }
+    for (guint i = 0; i < changed->len; i++)
+    {
+        gpointer object = g_ptr_array_index (changed, i);
+        if ((object == ent && (event_type & QOF_EVENT_DESTROY)) ||
+                qof_instance_get_destroying (object) ||
+                g_hash_table_lookup (live->iters, object))
+            continue;
+        if (check_object (q, object))
+        {
+            query_live_insert (q, object);
+            live->dirty = TRUE;
+        }
+    }
+    g_ptr_array_free (changed, TRUE);
+}
+
+static GList *
+query_live_run (QofQuery *q)
+{
+    QofQueryLive *live = q->live;
+    GList *all, *node;
+    gint max_results;
+
+    /* Events dropped while they were suspended may have been about
+     * any of the matches. */
+    if (live->dropped != qof_event_get_dropped_count ())
+        live->stale = TRUE;
+
+    if (live->matches && !live->stale && !q->changed)
+    {
+        if (live->dirty)
+        {
+            g_list_free (q->results);
+            q->results = query_live_results (q);
+            live->dirty = FALSE;
+        }
+        return q->results;
+    }
+
+    /* Search without cropping, the matches past max_results are
+     * needed when later ones go away. */
+    max_results = q->max_results;
+    q->max_results = -1;
+    all = qof_query_run_internal (q, qof_query_run_cb, NULL);
+    q->max_results = max_results;
+
+    if (live->matches)
+        g_sequence_free (live->matches);
+    g_hash_table_remove_all (live->iters);
+    live->matches = g_sequence_new (NULL);
+    for (node = all; node; node = node->next)
+        g_hash_table_insert (live->iters, node->data,
+                             g_sequence_append (live->matches, node->data));
+
+    g_list_free (q->results);
+    q->results = query_live_results (q);
+    live->stale = FALSE;
+    live->dirty = FALSE;
+    live->dropped = qof_event_get_dropped_count ();
+    return q->results;
+}
+
+void
+qof_query_set_live (QofQuery *q, gboolean live)
+{
+    if (!q || !live == !q->live) return;
+
+    if (live)
+    {
+        q->live = g_new0 (QofQueryLive, 1);
+        q->live->iters = g_hash_table_new (g_direct_hash, g_direct_equal);
+        q->live->handler_id = qof_event_register_filtered_handler (
+            query_live_event_cb, q, NULL,
+            QOF_EVENT_CREATE | QOF_EVENT_MODIFY | QOF_EVENT_DESTROY |
+            QOF_EVENT_ADD | QOF_EVENT_REMOVE);
+        return;
+    }
+
+    qof_event_unregister_handler (q->live->handler_id);
+    if (q->live->matches)
+        g_sequence_free (q->live->matches);
+    g_hash_table_destroy (q->live->iters);
+    g_free (q->live);
+    q->live = NULL;
+}
+
+/* Results of recently run queries, reused by an equal query as long as
+ * none of the books has changed since.  The most recently used entry
+ * is at the head. */
+#define QUERY_CACHE_SIZE 16
+
+typedef struct
+{
+    guint             fingerprint;
+    QofQuery *        query;          /* a copy of the query run */
+    guint64 *         generations;    /* of query->books, in order */
+    GList *           results;
+} QueryCacheEntry;
+
+static GQueue query_cache = G_QUEUE_INIT;
+
+/* A hash of what qof_query_equal compares, to skip most candidates */
+static guint
+query_fingerprint (const QofQuery *q)
+{
+    guint hash = g_str_hash (q->search_for ? q->search_for : "");
+
+    hash = hash * 31 + q->max_results;
+    for (GList *or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        hash = hash * 31 + 1;
+        for (GList *and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+                and_ptr = and_ptr->next)
+        {
+            QofQueryTerm *qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            for (GSList *node = qt->param_list; node; node = node->next)
+                hash = hash * 31 + g_str_hash (node->data);
+            hash = hash * 31 + qt->pdata->how + qt->invert;
+        }
+    }
+    return hash;
+}
+
+static void
+query_cache_entry_free (QueryCacheEntry *entry)
+{
+    qof_query_destroy (entry->query);
+    g_free (entry->generations);
+    g_list_free (entry->results);
+    g_free (entry);
+}
+
+/* The books are compared, and their generations read, through q only:
+ * those of an entry may be gone. */
+static GList *
+query_cache_find (const QofQuery *q, guint fingerprint, gboolean *fresh)
+{
+    for (GList *node = query_cache.head; node; node = node->next)
+    {
+        QueryCacheEntry *entry = static_cast<QueryCacheEntry*>(node->data);
+        GList *b1, *b2;
+        guint i;
+
+        if (entry->fingerprint != fingerprint ||
+                g_strcmp0 (entry->query->search_for, q->search_for) ||
+                !qof_query_equal (entry->query, q))
+            continue;
+        for (b1 = entry->query->books, b2 = q->books; b1 && b2;
+                b1 = b1->next, b2 = b2->next)
+            if (b1->data != b2->data)
+                break;
+        if (b1 || b2)
+            continue;
+
+        *fresh = TRUE;
+        for (b2 = q->books, i = 0; b2; b2 = b2->next, i++)
+            if (entry->generations[i] !=
+                    qof_book_get_generation (static_cast<QofBook*>(b2->data)))
+                *fresh = FALSE;
+        return node;
+    }
+    return NULL;
+}
+
+static void
+query_cache_store (QofQuery *q, guint fingerprint, GList *old)
+{
+    QueryCacheEntry *entry;
+    GList *node;
+    guint i;
+
+    if (old)
+    {
+        query_cache_entry_free (static_cast<QueryCacheEntry*>(old->data));
+        g_queue_delete_link (&query_cache, old);
+    }
+    while (query_cache.length >= QUERY_CACHE_SIZE)
+        query_cache_entry_free (static_cast<QueryCacheEntry*>(
+                                    g_queue_pop_tail (&query_cache)));
+
+    entry = g_new0 (QueryCacheEntry, 1);
+    entry->fingerprint = fingerprint;
+    entry->query = qof_query_copy (q);
+    entry->generations = g_new (guint64, g_list_length (q->books) + 1);
+    for (node = q->books, i = 0; node; node = node->next, i++)
+        entry->generations[i] =
+            qof_book_get_generation (static_cast<QofBook*>(node->data));
+    entry->results = g_list_copy (q->results);
+    g_queue_push_head (&query_cache, entry);
+}
+
 GList * qof_query_run (QofQuery *q)
 {
-    /* Just a wrapper */
-    return qof_query_run_internal(q, qof_query_run_cb, NULL);
+    GList *cached;
+    gboolean fresh = FALSE;
+    guint fingerprint;
+
+    if (q && q->live)
+        return query_live_run (q);
+    if (!q || !q->search_for || !q->books)
+        return qof_query_run_internal(q, qof_query_run_cb, NULL);
+
+    /* Hand back the results of an equal query if nothing has changed */
+    fingerprint = query_fingerprint (q);
+    cached = query_cache_find (q, fingerprint, &fresh);
+    if (cached && fresh)
+    {
+        QueryCacheEntry *entry = static_cast<QueryCacheEntry*>(cached->data);
+
+        g_queue_unlink (&query_cache, cached);
+        g_queue_push_head_link (&query_cache, cached);
+        g_list_free (q->results);
+        q->results = g_list_copy (entry->results);
+        QOF_PROFILE_COUNT ("query-cache-hit");
+        return q->results;
+    }
+
+    qof_query_run_internal(q, qof_query_run_cb, NULL);
+    query_cache_store (q, fingerprint, cached);
+    return q->results;
+}
+
+static gint
+sort_ptr_func (gconstpointer a, gconstpointer b, gpointer q)
+{
+    return sort_func (*(gconstpointer*)a, *(gconstpointer*)b, q);
+}
+
+QofQueryCursor *
+qof_query_cursor_new (QofQuery *q, guint batch_size)
+{
+    QofQueryCursor *cursor;
+    QofQueryCB qcb;
+    guint count;
+
+    g_return_val_if_fail (q, NULL);
+    g_return_val_if_fail (q->search_for, NULL);
+    g_return_val_if_fail (q->books, NULL);
+    ENTER (" q=%p", q);
+
+    /* Compile as a run would, but leave q->changed for the next run */
+    query_clear_compiles (q);
+    compile_terms (q);
+
+    memset (&qcb, 0, sizeof (qcb));
+    qcb.query = q;
+    qcb.array = g_ptr_array_new ();
+    qof_query_run_cb (&qcb, NULL);
+
+    /* g_ptr_array_sort is stable, as the list sort of a run */
+    if (query_is_sorted (q))
+        g_ptr_array_sort_with_data (qcb.array, sort_ptr_func, q);
+
+    cursor = g_new0 (QofQueryCursor, 1);
+    cursor->matches = qcb.array;
+    cursor->batch_size = batch_size ? batch_size : 1000;
+
+    /* Keep the last max_results, as a run does */
+    count = cursor->matches->len;
+    if (q->max_results > -1 && count > (guint)q->max_results)
+        cursor->next = count - q->max_results;
+
+    LEAVE (" q=%p, %u matches", q, count - cursor->next);
+    return cursor;
+}
+
+GList *
+qof_query_cursor_next (QofQueryCursor *cursor)
+{
+    GList *batch = NULL;
+    guint end;
+
+    g_return_val_if_fail (cursor, NULL);
+
+    end = MIN (cursor->next + cursor->batch_size, cursor->matches->len);
+    for (guint i = end; i > cursor->next; i--)
+        batch = g_list_prepend (batch, g_ptr_array_index (cursor->matches, i - 1));
+    cursor->next = end;
+    return batch;
+}
+
+void
+qof_query_cursor_free (QofQueryCursor *cursor)
+{
+    if (!cursor) return;
+    g_ptr_array_free (cursor->matches, TRUE);
+    g_free (cursor);
 }
 
 static void qof_query_run_subq_cb(QofQueryCB* qcb, gpointer cb_arg)
@@ -995,6 +1627,7 @@ GSList * qof_query_get_term_type (QofQuery *q, QofQueryParamList *term_param)
 void qof_query_destroy (QofQuery *q)
 {
     if (!q) return;
+    qof_query_set_live (q, FALSE);
     free_members (q);
     query_clear_compiles (q);
     g_hash_table_destroy (q->be_compiled);
@@ -1014,6 +1647,7 @@ QofQuery * qof_query_copy (QofQuery *q)
     memcpy (copy, q, sizeof (QofQuery));
 
     copy->be_compiled = ht;
+    copy->live = NULL;
     copy->terms = copy_or_terms (q->terms);
     copy->books = g_list_copy (q->books);
     copy->results = g_list_copy (q->results);
@@ -1053,6 +1687,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 0:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel = q->parallel;
         break;
 
         /* This is the DeMorgan expansion for a single AND expression. */
@@ -1060,6 +1695,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 1:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel = q->parallel;
         retval->books = g_list_copy (q->books);
         retval->search_for = q->search_for;
         retval->changed = 1;
@@ -1093,6 +1729,7 @@ QofQuery * qof_query_invert (QofQuery *q)
         retval = qof_query_merge(iright, ileft, QOF_QUERY_AND);
         retval->books          = g_list_copy (q->books);
         retval->max_results    = q->max_results;
+        retval->parallel       = q->parallel;
         retval->search_for     = q->search_for;
         retval->changed        = 1;
 
@@ -1153,6 +1790,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
             g_list_concat(copy_or_terms(q1->terms), copy_or_terms(q2->terms));
         retval->books           = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel;
         retval->changed        = 1;
         break;
 
@@ -1160,6 +1798,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
         retval = qof_query_create();
         retval->books          = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel;
         retval->changed        = 1;
 
         /* g_list_append() can take forever, so let's build the list in
@@ -1260,6 +1899,8 @@ void qof_query_set_sort_options (QofQuery *q, gint prim_op, gint sec_op,
     q->primary_sort.options = prim_op;
     q->secondary_sort.options = sec_op;
     q->tertiary_sort.options = tert_op;
+    if (q->live)
+        q->live->stale = TRUE;
 }
 
 void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
@@ -1269,12 +1910,22 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
     q->primary_sort.increasing = prim_inc;
     q->secondary_sort.increasing = sec_inc;
     q->tertiary_sort.increasing = tert_inc;
+    if (q->live)
+        q->live->stale = TRUE;
 }
 
 void qof_query_set_max_results (QofQuery *q, int n)
 {
     if (!q) return;
     q->max_results = n;
+    if (q->live)
+        q->live->dirty = TRUE;
+}
+
+void qof_query_set_parallel (QofQuery *q, gboolean parallel)
+{
+    if (!q) return;
+    q->parallel = parallel;
 }
 
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
@@ -1352,10 +2003,19 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    while (!g_queue_is_empty (&query_cache))
+        query_cache_entry_free (static_cast<QueryCacheEntry*>(
+                                    g_queue_pop_head (&query_cache)));
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+gboolean qof_query_get_parallel (const QofQuery *q)
+{
+    if (!q) return FALSE;
+    return q->parallel;
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
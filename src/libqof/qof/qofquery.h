@@ -89,6 +89,9 @@ extern "C"
 /** A Query */
 typedef struct _QofQuery QofQuery;
 
+/** A position in the results of a query, see qof_query_cursor_new() */
+typedef struct _QofQueryCursor QofQueryCursor;
+
 /** Query Term Operators, for combining Query Terms */
 typedef enum
 {
@@ -221,12 +224,77 @@ void qof_query_add_boolean_match (QofQuery *q,
  */
 GList * qof_query_run (QofQuery *query);
 
+/** A function that enumerates candidates for a query from an index of
+ *  its own, instead of the whole collection of the searched-for type.
+ *  It returns FALSE, without calling cb, if the terms of the query
+ *  give it nothing to go by.  Otherwise it calls cb with user_data for
+ *  every object of book that may match the query, each once, and
+ *  returns TRUE; the query terms are still checked on each of them.
+ */
+typedef gboolean (*QofQueryIndexFunc) (QofQuery *query, QofBook *book,
+                                       QofInstanceForeachCB cb,
+                                       gpointer user_data);
+
+/** Register an index function for queries searching for obj_type.
+ *  @see QofQueryIndexFunc */
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryIndexFunc index_fcn);
+
+/** A function that finds the objects of its type whose parameters, as
+ *  the query looks at them, may have changed with a change to another
+ *  object, such as the splits of a transaction.  It calls cb with
+ *  user_data for each of them and returns TRUE, or returns FALSE if it
+ *  can't tell.
+ */
+typedef gboolean (*QofQueryDependentsFunc) (QofQuery *query,
+                                            QofInstance *changed,
+                                            QofInstanceForeachCB cb,
+                                            gpointer user_data);
+
+/** Register the dependents function used by live queries searching
+ *  for obj_type.  @see qof_query_set_live */
+void qof_query_register_dependents (QofIdTypeConst obj_type,
+                                    QofQueryDependentsFunc dep_fcn);
+
+/** Make a query live, or stop it being live.  A live query follows
+ *  the engine events after it has been run: each object that changes
+ *  is tested again and moved to its sorted place among the results,
+ *  so that qof_query_run() needn't search again until the terms,
+ *  sort order or books of the query change.  A change to an object
+ *  of another type is followed through the dependents function of
+ *  the searched-for type; without one, or if it can't tell, the
+ *  next run searches again.  So does the run after any event was
+ *  lost to qof_event_suspend(), see qof_event_get_dropped_count().
+ *  Objects that compare equal in the sort may come in another order
+ *  than a search would give.
+ */
+void qof_query_set_live (QofQuery *q, gboolean live);
+
 /** Return the results of the last query, without causing the query to
  *  be re-run.  Do NOT free the resulting list.  This list is managed
  *  internally by QofQuery.
  */
 GList * qof_query_last_run (QofQuery *query);
 
+/** Run the query for a caller that only needs to see its results a
+ *  batch at a time, in order, such as an exporter.  The matches are
+ *  found and sorted as by qof_query_run(), but only kept as a compact
+ *  array, and neither the query's own result list nor its result
+ *  cache is touched.  The objects must not be destroyed while the
+ *  cursor is in use.
+ *
+ *  @param batch_size  the number of objects qof_query_cursor_next()
+ *                     returns at a time, or 0 for a default
+ */
+QofQueryCursor * qof_query_cursor_new (QofQuery *query, guint batch_size);
+
+/** Return the next batch of results from the cursor, or NULL once they
+ *  are all returned.  The list must be freed with g_list_free(). */
+GList * qof_query_cursor_next (QofQueryCursor *cursor);
+
+/** Free the cursor. */
+void qof_query_cursor_free (QofQueryCursor *cursor);
+
 /** Perform a subquery, return the results.
  *  Instead of running over a book, the subquery runs over the results
  *  of the primary query.
@@ -360,6 +428,16 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/** Allow qof_query_run() to evaluate the query terms over large
+ * collections on several threads at once.  Only set this when all
+ * the parameter getters used by the terms are safe to call from
+ * another thread, i.e. they only read the objects, and the objects
+ * are not changed while the query runs.  The results are the same
+ * as those of a serial run.  The find dialog sets it for split
+ * searches on the memo or the transaction description.
+ */
+void qof_query_set_parallel (QofQuery *q, gboolean parallel);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
@@ -69,6 +69,8 @@ typedef struct
     gboolean		is_regex;
     gchar *		matchstring;
     regex_t		compiled;
+    gchar *		matchstring_folded; /* casefolded and normalized */
+    gboolean		folded_is_ascii;
 } query_string_def, *query_string_t;
 
 typedef struct
@@ -90,6 +92,7 @@ typedef struct
     QofQueryPredData	pd;
     QofGuidMatch	options;
     GList *	guids;
+    GHashTable *	guid_set;	/* the guids, for long lists */
 } query_guid_def, *query_guid_t;
 
 typedef struct
@@ -25,6 +25,7 @@
 
 #include <glib.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "qof.h"
 #include "qofquerycore-p.h"
@@ -124,6 +125,37 @@ static GHashTable *predEqualTable = NULL;
 
 /* QOF_TYPE_STRING */
 
+/* Case-insensitive substring search against the pattern that was
+ * folded once when the predicate was built.  Most engine strings are
+ * plain ASCII; for those, folding and normalizing amount to lowering
+ * the case, which is done into a scratch buffer so that the libc
+ * strstr can do the search.  Anything else is folded the slow way.
+ */
+static gboolean
+string_contains_nocase (const char *s, const query_string_t pdata)
+{
+    char buf[256], *lower = buf;
+    gboolean ret;
+    size_t len = 0;
+
+    for (const char *c = s; *c; c++, len++)
+        if (static_cast<unsigned char>(*c) & 0x80)
+            return qof_utf8_substr_nocase (s, pdata->matchstring);
+
+    /* An ASCII string can't contain a pattern that folds to more */
+    if (!pdata->folded_is_ascii)
+        return FALSE;
+
+    if (len >= sizeof (buf))
+        lower = static_cast<char*>(g_malloc (len + 1));
+    for (size_t i = 0; i <= len; i++)
+        lower[i] = g_ascii_tolower (s[i]);
+    ret = strstr (lower, pdata->matchstring_folded) != NULL;
+    if (lower != buf)
+        g_free (lower);
+    return ret;
+}
+
 static int
 string_match_predicate (gpointer object,
                         QofParam *getter,
@@ -141,8 +173,7 @@ string_match_predicate (gpointer object,
 
     if (pdata->is_regex)
     {
-        regmatch_t match;
-        if (!regexec (&pdata->compiled, s, 1, &match, 0))
+        if (!regexec (&pdata->compiled, s, 0, NULL, 0))
             ret = 1;
     }
     else
@@ -151,7 +182,7 @@ string_match_predicate (gpointer object,
         {
             if (pd->how == QOF_COMPARE_CONTAINS || pd->how == QOF_COMPARE_NCONTAINS)
             {
-                if (qof_utf8_substr_nocase (s, pdata->matchstring)) //uses strstr
+                if (string_contains_nocase (s, pdata))
                     ret = 1;
             }
             else
@@ -248,6 +279,7 @@ string_free_pdata (QofQueryPredData *pd)
         regfree (&pdata->compiled);
 
     g_free (pdata->matchstring);
+    g_free (pdata->matchstring_folded);
     g_free (pdata);
 }
 
@@ -292,10 +324,24 @@ qof_query_string_predicate (QofQueryCompare how,
     pdata->options = options;
     pdata->matchstring = g_strdup (str);
 
+    if (options == QOF_STRING_MATCH_CASEINSENSITIVE && !is_regex)
+    {
+        gchar *folded = g_utf8_casefold (str, -1);
+        pdata->matchstring_folded = g_utf8_normalize (folded, -1,
+                                                      G_NORMALIZE_ALL);
+        g_free (folded);
+        pdata->folded_is_ascii = pdata->matchstring_folded != NULL;
+        for (const gchar *c = pdata->matchstring_folded; c && *c; c++)
+            if (static_cast<guchar>(*c) & 0x80)
+                pdata->folded_is_ascii = FALSE;
+    }
+
     if (is_regex)
     {
         int rc;
-        int flags = REG_EXTENDED;
+        /* Only whether it matches is wanted, which lets regexec skip
+         * tracking subexpressions. */
+        int flags = REG_EXTENDED | REG_NOSUB;
         if (options == QOF_STRING_MATCH_CASEINSENSITIVE)
             flags |= REG_ICASE;
 
@@ -303,6 +349,7 @@ qof_query_string_predicate (QofQueryCompare how,
         if (rc)
         {
             g_free(pdata->matchstring);
+            g_free(pdata->matchstring_folded);
             g_free(pdata);
             return NULL;
         }
@@ -330,6 +377,19 @@ date_compare (Timespec ta, Timespec tb, QofDateMatch options)
 
     if (options == QOF_DATE_MATCH_DAY)
     {
+        /* Compare the local calendar days directly rather than
+         * normalizing both sides to noon, which would cost an extra
+         * mktime per operand. */
+        struct tm tm_a, tm_b;
+        time64 sa = ta.tv_sec, sb = tb.tv_sec;
+        if (gnc_localtime_r (&sa, &tm_a) && gnc_localtime_r (&sb, &tm_b))
+        {
+            if (tm_a.tm_year != tm_b.tm_year)
+                return tm_a.tm_year < tm_b.tm_year ? -1 : 1;
+            if (tm_a.tm_yday != tm_b.tm_yday)
+                return tm_a.tm_yday < tm_b.tm_yday ? -1 : 1;
+            return 0;
+        }
         ta = timespecCanonicalDayTime (ta);
         tb = timespecCanonicalDayTime (tb);
     }
@@ -593,6 +653,9 @@ debcred_to_string (gpointer object, QofParam *getter)
 
 /* QOF_TYPE_GUID =================================================== */
 
+/* The length from which a guid list is also kept as a hash set */
+#define QUERY_GUID_SET_MIN 8
+
 static int
 guid_match_predicate (gpointer object, QofParam *getter,
                       QofQueryPredData *pd)
@@ -680,6 +743,12 @@ guid_match_predicate (gpointer object, QofParam *getter,
          */
 
         guid = ((query_guid_getter)getter->param_getfcn) (object, getter);
+        if (pdata->guid_set)
+        {
+            node = guid && g_hash_table_lookup (pdata->guid_set, guid) ?
+                   pdata->guids : NULL;
+            break;
+        }
         for (node = pdata->guids; node; node = node->next)
         {
             if (guid_equal (static_cast<GncGUID*>(node->data), guid))
@@ -717,6 +786,8 @@ guid_free_pdata (QofQueryPredData *pd)
         guid_free (static_cast<GncGUID*>(node->data));
     }
     g_list_free (pdata->guids);
+    if (pdata->guid_set)
+        g_hash_table_destroy (pdata->guid_set);
     g_free (pdata);
 }
 
@@ -768,6 +839,17 @@ qof_query_guid_predicate (QofGuidMatch options, GList *guid_list)
         *guid = *((GncGUID *)node->data);
         node->data = guid;
     }
+
+    /* A register on a big account tree matches against many accounts;
+     * look those up in a hash set rather than walking the list. */
+    if ((options == QOF_GUID_MATCH_ANY || options == QOF_GUID_MATCH_NONE) &&
+        g_list_nth (pdata->guids, QUERY_GUID_SET_MIN - 1))
+    {
+        pdata->guid_set = g_hash_table_new (guid_hash_to_guint,
+                                            guid_g_hash_table_equal);
+        for (node = pdata->guids; node; node = node->next)
+            g_hash_table_insert (pdata->guid_set, node->data, node->data);
+    }
     return ((QofQueryPredData*)pdata);
 }
 
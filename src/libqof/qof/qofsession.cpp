@@ -729,14 +729,15 @@ qof_session_end (QofSession *session)
     ENTER ("sess=%p book_id=%s", session, session->book_id
            ? session->book_id : "(null)");
 
-    /* close down the backend first */
+    qof_session_clear_error (session);
+
+    /* close down the backend first; whatever goes wrong with that is
+     * left for qof_session_get_error */
     if (session->backend && session->backend->session_end)
     {
         (session->backend->session_end)(session->backend);
     }
 
-    qof_session_clear_error (session);
-
     g_free (session->book_id);
     session->book_id = NULL;
 
@@ -249,7 +249,9 @@ void     qof_session_safe_save (QofSession *session,
  *    this method acts as an "abort" or "rollback" primitive.  However,
  *    for other backends, such as the sql backend, the data would have
  *    been written out before this, and so this routines wouldn't
- *    roll-back anything; it would just shut the connection.
+ *    roll-back anything; it would just shut the connection.  An error
+ *    the backend meets while ending, such as a pending background save
+ *    of the file backend that fails, is left for qof_session_get_error().
  */
 void     qof_session_end  (QofSession *session);
 
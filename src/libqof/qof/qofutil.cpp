@@ -262,6 +262,7 @@ qof_init (void)
     g_type_init(); /* Automatic as of GLib 2.36 */
 #endif
     qof_log_init();
+    qof_profile_init();
     qof_string_cache_init();
     qof_object_initialize ();
     qof_query_init ();
@@ -275,6 +276,7 @@ qof_close(void)
     qof_object_shutdown ();
     qof_finalize_backend_libraries();
     qof_string_cache_destroy ();
+    qof_profile_shutdown ();
     qof_log_shutdown();
 }
 
@@ -87,3 +87,22 @@ TEST(gnc_datetime_functions, test_date)
     EXPECT_EQ(ymd.month, 11);
     EXPECT_EQ(ymd.day, 13);
 }
+
+/* The cached conversions must agree with GncDateTime, including around
+ * the daylight-saving transitions of whatever the local timezone is. */
+TEST(gnc_datetime_functions, test_local_tm)
+{
+    for (time64 time = 788918400; time < 1893456000; time += 4567 * 7) //1995-2030
+    {
+        GncDateTime atime(time);
+        const struct tm tm = static_cast<struct tm>(atime);
+        const struct tm tm1 = GncDateTime::local_tm(time);
+        EXPECT_EQ(tm1.tm_year, tm.tm_year);
+        EXPECT_EQ(tm1.tm_yday, tm.tm_yday);
+        EXPECT_EQ(tm1.tm_hour, tm.tm_hour);
+        EXPECT_EQ(tm1.tm_min, tm.tm_min);
+        EXPECT_EQ(tm1.tm_isdst, tm.tm_isdst);
+        EXPECT_EQ(GncDateTime::local_time64(tm),
+                  static_cast<time64>(GncDateTime(tm)) - GncDateTime(tm).offset());
+    }
+}
@@ -183,6 +183,69 @@ static void test_gnc_guid_from_string (void) {
     const char * good {"0123456789abcdef1234567890abcdef"};
     g_assert (string_to_guid (good, guid));
 
+    /* The other spellings boost accepts give the same GUID. */
+    GncGUID * other {guid_malloc ()};
+    g_assert (string_to_guid ("{01234567-89AB-CDEF-1234-567890ABCDEF}", other));
+    g_assert (guid_equal (guid, other));
+    g_assert (string_to_guid ("01234567-89ab-cdef-1234-567890abcdef", other));
+    g_assert (guid_equal (guid, other));
+    gchar encoded[GUID_ENCODING_LENGTH + 1];
+    guid_to_string_buff (other, encoded);
+    g_assert_cmpstr (encoded, ==, good);
+
+    /* Short, long, unbalanced or oddly dashed strings aren't GUIDs. */
+    g_assert (!string_to_guid ("0123456789abcdef1234567890abcde", other));
+    g_assert (!string_to_guid ("0123456789abcdef1234567890abcdef0", other));
+    g_assert (!string_to_guid ("{0123456789abcdef1234567890abcdef", other));
+    g_assert (!string_to_guid ("01234567-89abcdef-1234-567890abcdef", other));
+    guid_free (other);
+
+    guid_free (guid);
+}
+
+/* New GUIDs are distinct, also across the blocks the generator
+ * fills. */
+static void test_gnc_guid_new_blocks (void)
+{
+    const guint count {200};
+    GncGUID * guids {g_new (GncGUID, count)};
+    GHashTable * seen {guid_hash_table_new ()};
+    for (guint i = 0; i < count; ++i)
+    {
+        guid_replace (&guids[i]);
+        g_assert (!guid_equal (&guids[i], guid_null ()));
+        g_assert (g_hash_table_lookup (seen, &guids[i]) == nullptr);
+        g_hash_table_insert (seen, &guids[i], &guids[i]);
+    }
+    g_hash_table_destroy (seen);
+    g_free (guids);
+}
+
+/**
+ * Equal GUIDs must hash equal, and GUIDs that differ in a single byte
+ * should still spread over the buckets of a small table.
+ */
+static void test_gnc_guid_hash (void)
+{
+    GncGUID * guid {guid_malloc ()};
+    guid_replace (guid);
+    GncGUID * copy {guid_copy (guid)};
+    g_assert_cmpuint (guid_hash_to_guint (guid), ==, guid_hash_to_guint (copy));
+    g_assert_cmpuint (guid_hash_to_guint64 (guid), ==, guid_hash_to_guint64 (copy));
+
+    bool buckets[256] {};
+    unsigned used {0};
+    for (unsigned i = 0; i < 256; ++i)
+    {
+        copy->reserved[0] = static_cast<unsigned char> (i);
+        auto bucket = guid_hash_to_guint (copy) & 0xff;
+        if (!buckets[bucket])
+            ++used;
+        buckets[bucket] = true;
+    }
+    g_assert_cmpuint (used, >, 128);
+
+    guid_free (copy);
     guid_free (guid);
 }
 
@@ -195,5 +258,7 @@ void test_suite_gnc_guid (void)
     GNC_TEST_ADD_FUNC (suitename, "gnc guid string roundtrip", test_gnc_guid_roundtrip);
     GNC_TEST_ADD_FUNC (suitename, "gnc guid from string", test_gnc_guid_from_string);
     GNC_TEST_ADD_FUNC (suitename, "gnc guid replace", test_gnc_guid_replace);
+    GNC_TEST_ADD_FUNC (suitename, "gnc guid hash", test_gnc_guid_hash);
+    GNC_TEST_ADD_FUNC (suitename, "gnc guid new blocks", test_gnc_guid_new_blocks);
 }
 
@@ -201,3 +201,59 @@ TEST_F (KvpFrameTest, Empty)
     EXPECT_TRUE(f1.empty());
     EXPECT_FALSE(f2.empty());
 }
+
+TEST_F (KvpFrameTest, KvpPath)
+{
+    KvpPath path1 {"/top/second/twenty/twenty-first"};
+    KvpPath path2 {Path {"top", "second/twenty", "twenty-first"}};
+    KvpPath path3 {"top/third/thirty-first"};
+    auto v1 = new KvpValueImpl {15.0};
+
+    EXPECT_EQ (4u, path1.keys().size());
+    EXPECT_EQ (path1.keys(), path2.keys());
+    EXPECT_EQ (t_int_val, t_root.get_slot(KvpPath {"top/first"}));
+    EXPECT_EQ (nullptr, t_root.get_slot(path1));
+    EXPECT_EQ (nullptr, t_root.set_path(path1, v1));
+    EXPECT_EQ (v1, t_root.get_slot(path2));
+    EXPECT_EQ (v1, t_root.get_slot("top/second/twenty/twenty-first"));
+    /* thirty-first would be below a string, not a frame. */
+    EXPECT_EQ (nullptr, t_root.get_slot(path3));
+    EXPECT_EQ (nullptr, t_root.get_slot(KvpPath {""}));
+}
+
+TEST_F (KvpFrameTest, KeysStaySorted)
+{
+    KvpFrameImpl f1;
+    f1.set("delta", new KvpValue {INT64_C(4)});
+    f1.set("alpha", new KvpValue {INT64_C(1)});
+    f1.set("charlie", new KvpValue {INT64_C(3)});
+    f1.set("bravo", new KvpValue {INT64_C(2)});
+    delete f1.set("charlie", nullptr);
+
+    std::vector<std::string> expected {"alpha", "bravo", "delta"};
+    EXPECT_EQ (expected, f1.get_keys());
+    EXPECT_EQ (2, f1.get_slot("bravo")->get<int64_t>());
+    EXPECT_EQ (nullptr, f1.get_slot("charlie"));
+
+    KvpFrameImpl f2 {f1};
+    EXPECT_EQ (0, compare(f1, f2));
+}
+
+TEST_F (KvpFrameTest, MemoryUsage)
+{
+    KvpFrameImpl f1;
+    auto empty = f1.memory_usage();
+    EXPECT_LE (sizeof(KvpFrameImpl), empty);
+
+    f1.set("int", new KvpValue {INT64_C(4)});
+    auto with_int = f1.memory_usage();
+    EXPECT_LE (empty + sizeof(KvpValueImpl), with_int);
+
+    f1.set("string", new KvpValue {g_strdup("some string")});
+    EXPECT_LE (with_int + sizeof(KvpValueImpl) + strlen("some string") + 1,
+               f1.memory_usage());
+
+    /* Subframes are counted with their slots. */
+    EXPECT_LT (t_root.get_slot("top")->get<KvpFrame*>()->memory_usage(),
+               t_root.memory_usage());
+}
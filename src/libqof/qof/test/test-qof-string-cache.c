@@ -77,8 +77,34 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_intern( void )
+{
+    /* Interned strings are shared by address, independently of the
+     * reference counted ones. */
+    gchar str[100];
+    const gchar* atom1;
+    const gchar* atom2;
+    gchar* cached;
+
+    strncpy(str, "atom", sizeof(str));
+    atom1 = qof_string_cache_intern(str);
+    g_assert(atom1 != str);
+    g_assert_cmpstr(atom1, ==, "atom");
+    atom2 = qof_string_cache_intern("atom");
+    g_assert(atom1 == atom2);
+    g_assert(qof_string_cache_intern("other") != atom1);
+    g_assert(qof_string_cache_intern(NULL) == NULL);
+
+    cached = qof_string_cache_insert(str);
+    g_assert(cached != atom1);
+    qof_string_cache_remove(cached);
+    g_assert(qof_string_cache_intern(str) == atom1);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache intern", test_qof_string_cache_intern);
 }
@@ -31,6 +31,8 @@ extern void test_suite_qofobject();
 extern void test_suite_qofsession();
 extern void test_suite_gnc_date();
 extern void test_suite_qof_string_cache();
+extern void test_suite_qoflog();
+extern void test_suite_qofprofile();
 extern void test_suite_gnc_guid ( void );
 
 int
@@ -50,6 +52,8 @@ main (int   argc,
     test_suite_qofsession();
     test_suite_gnc_date();
     test_suite_qof_string_cache();
+    test_suite_qoflog();
+    test_suite_qofprofile();
 
     return g_test_run( );
 }
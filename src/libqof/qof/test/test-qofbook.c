@@ -807,6 +807,60 @@ test_book_foreach_collection( Fixture *fixture, gconstpointer pData )
     g_assert( col_struct.col2_called );
 }
 
+static const QofMemoryUsage *
+find_memory_usage( GList *usage, const char *category )
+{
+    GList *node;
+
+    for ( node = usage; node; node = node->next )
+    {
+        QofMemoryUsage *mu = node->data;
+        if ( g_strcmp0( mu->category, category ) == 0 )
+            return mu;
+    }
+    return NULL;
+}
+
+static void
+test_book_get_memory_usage( Fixture *fixture, gconstpointer pData )
+{
+    QofIdType my_type = "my_type";
+    QofInstance *inst1, *inst2;
+    const QofMemoryUsage *mu;
+    gpointer cached;
+    GList *usage;
+
+    inst1 = g_object_new( QOF_TYPE_INSTANCE, NULL );
+    inst2 = g_object_new( QOF_TYPE_INSTANCE, NULL );
+    qof_instance_init_data( inst1, my_type, fixture->book );
+    qof_instance_init_data( inst2, my_type, fixture->book );
+    cached = qof_string_cache_insert( "test_book_get_memory_usage" );
+
+    g_test_message( "Testing the collection's categories" );
+    usage = qof_book_get_memory_usage( fixture->book );
+    mu = find_memory_usage( usage, "my_type instances" );
+    g_assert( mu != NULL );
+    g_assert_cmpint( mu->count, ==, 2 );
+    g_assert_cmpint( mu->bytes, >=, 2 * sizeof( QofInstance ) );
+    mu = find_memory_usage( usage, "my_type index" );
+    g_assert( mu != NULL );
+    g_assert_cmpint( mu->count, ==, 2 );
+    mu = find_memory_usage( usage, "my_type kvp" );
+    g_assert( mu != NULL );
+    g_assert_cmpint( mu->count, ==, 0 );
+
+    g_test_message( "Testing the string cache" );
+    mu = find_memory_usage( usage, "String cache" );
+    g_assert( mu != NULL );
+    g_assert_cmpint( mu->count, >=, 1 );
+    g_assert_cmpint( mu->bytes, >, strlen( "test_book_get_memory_usage" ) );
+    qof_memory_usage_free( usage );
+
+    qof_string_cache_remove( cached );
+    g_object_unref( inst1 );
+    g_object_unref( inst2 );
+}
+
 static void
 test_book_set_data_fin( void )
 {
@@ -922,6 +976,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "set get data", Fixture, NULL, setup, test_book_set_get_data, teardown );
     GNC_TEST_ADD( suitename, "get collection", Fixture, NULL, setup, test_book_get_collection, teardown );
     GNC_TEST_ADD( suitename, "foreach collection", Fixture, NULL, setup, test_book_foreach_collection, teardown );
+    GNC_TEST_ADD( suitename, "get memory usage", Fixture, NULL, setup, test_book_get_memory_usage, teardown );
     GNC_TEST_ADD_FUNC( suitename, "set data finalizers", test_book_set_data_fin );
     GNC_TEST_ADD( suitename, "mark closed", Fixture, NULL, setup, test_book_mark_closed, teardown );
     GNC_TEST_ADD_FUNC( suitename, "book new and destroy", test_book_new_destroy );
@@ -26,6 +26,7 @@ extern "C"
 #include <unittest-support.h>
 #include "../qof.h"
 #include "../qofbackend-p.h"
+#include "../qofinstance-p.h"
 }
 #include "../kvp_frame.hpp"
 static const gchar *suitename = "/qof/qofinstance";
@@ -234,6 +235,162 @@ test_instance_init_data( void )
     qof_book_destroy( book );
 }
 
+static void
+test_instance_init_data_with_guid( void )
+{
+    QofInstance *inst, *inst2;
+    QofIdType test_type = "test type";
+    QofBook *book = qof_book_new();
+    QofCollection *col;
+    GncGUID guid;
+
+    guid_replace( &guid );
+    inst = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    qof_instance_init_data_with_guid( inst, test_type, book, &guid );
+    g_assert( guid_equal( qof_instance_get_guid( inst ), &guid ) );
+    col = qof_book_get_collection( book, test_type );
+    g_assert( qof_collection_lookup_entity( col, &guid ) == inst );
+
+    g_test_message( "A GUID already in use is replaced by a new one" );
+    inst2 = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    qof_instance_init_data_with_guid( inst2, test_type, book, &guid );
+    g_assert( !guid_equal( qof_instance_get_guid( inst2 ), &guid ) );
+    g_assert( qof_collection_lookup_entity( col, &guid ) == inst );
+    g_assert( qof_collection_lookup_entity( col, qof_instance_get_guid( inst2 ) ) == inst2 );
+
+    g_test_message( "Batch lookup" );
+    {
+        GncGUID guids[3];
+        QofInstance *found[3];
+        guids[0] = *qof_instance_get_guid( inst2 );
+        guid_replace( &guids[1] );
+        guids[2] = guid;
+        g_assert_cmpuint( qof_collection_lookup_entities( col, guids, 3, found ), ==, 2 );
+        g_assert( found[0] == inst2 );
+        g_assert( found[1] == NULL );
+        g_assert( found[2] == inst );
+    }
+
+    /* clean up */
+    g_object_unref( inst2 );
+    g_object_unref( inst );
+    qof_book_destroy( book );
+}
+
+static void
+count_event_handler( QofInstance *ent, QofEventId event_type,
+                     gpointer handler_data, gpointer event_data )
+{
+    ++*static_cast<gint*>(handler_data);
+}
+
+static void
+test_instance_filtered_coalesced_events( void )
+{
+    QofBook *book = qof_book_new();
+    auto inst = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    auto other = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    auto gone = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    gint all = 0, modified = 0;
+    guint dropped;
+    gint all_id, modified_id;
+
+    qof_instance_init_data( inst, "test type", book );
+    qof_instance_init_data( other, "other type", book );
+    qof_instance_init_data( gone, "test type", book );
+    all_id = qof_event_register_handler( count_event_handler, &all );
+    modified_id = qof_event_register_filtered_handler( count_event_handler,
+                                                       &modified, "test type",
+                                                       QOF_EVENT_MODIFY );
+
+    g_test_message( "Filtered handlers only get the events asked for" );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( inst, QOF_EVENT_ADD, NULL );
+    qof_event_gen( other, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( inst, QOF_MAKE_EVENT(QOF_EVENT_BASE), NULL );
+    g_assert_cmpint( all, ==, 4 );
+    g_assert_cmpint( modified, ==, 1 );
+
+    g_test_message( "Modifications are delivered once when coalescing" );
+    all = modified = 0;
+    qof_event_suspend_coalescing();
+    qof_event_suspend();
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( gone, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( gone, QOF_EVENT_DESTROY, NULL );
+    qof_event_gen( inst, QOF_EVENT_ADD, NULL );
+    qof_event_resume();
+    g_assert_cmpint( all, ==, 0 );
+    qof_event_resume();
+    g_assert_cmpint( all, ==, 1 );
+    g_assert_cmpint( modified, ==, 1 );
+
+    g_test_message( "Creations are delivered before the modification" );
+    all = modified = 0;
+    qof_event_suspend_coalescing();
+    qof_event_gen( inst, QOF_EVENT_CREATE, NULL );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( other, QOF_EVENT_CREATE, NULL );
+    qof_event_resume();
+    g_assert_cmpint( all, ==, 4 );
+    g_assert_cmpint( modified, ==, 1 );
+
+    g_test_message( "Only events not replayed on resume count as dropped" );
+    dropped = qof_event_get_dropped_count();
+    qof_event_suspend_coalescing();
+    qof_event_gen( inst, QOF_EVENT_CREATE, NULL );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_resume();
+    g_assert_cmpuint( qof_event_get_dropped_count(), ==, dropped );
+    qof_event_suspend_coalescing();
+    qof_event_gen( inst, QOF_EVENT_ADD, NULL );
+    qof_event_gen( gone, QOF_EVENT_DESTROY, NULL );
+    qof_event_resume();
+    g_assert_cmpuint( qof_event_get_dropped_count(), ==, dropped + 2 );
+    qof_event_suspend();
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_resume();
+    g_assert_cmpuint( qof_event_get_dropped_count(), ==, dropped + 3 );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    g_assert_cmpuint( qof_event_get_dropped_count(), ==, dropped + 3 );
+
+    qof_event_unregister_handler( modified_id );
+    qof_event_unregister_handler( all_id );
+    g_object_unref( gone );
+    g_object_unref( other );
+    g_object_unref( inst );
+    qof_book_destroy( book );
+}
+
+static void
+test_instance_async_events( void )
+{
+    QofBook *book = qof_book_new();
+    auto inst = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    gint count = 0;
+    gint id;
+
+    qof_instance_init_data( inst, "test type", book );
+    id = qof_event_register_async_handler( count_event_handler, &count,
+                                           "test type", QOF_EVENT_MODIFY );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( inst, QOF_EVENT_ADD, NULL );
+    g_assert_cmpint( count, ==, 0 );
+    qof_event_flush_async();
+    g_assert_cmpint( count, ==, 2 );
+
+    g_test_message( "Nothing is delivered after unregistering" );
+    qof_event_gen( inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_unregister_handler( id );
+    qof_event_flush_async();
+    g_assert_cmpint( count, ==, 2 );
+
+    g_object_unref( inst );
+    qof_book_destroy( book );
+}
+
 static void
 test_instance_get_set_slots( Fixture *fixture, gconstpointer pData )
 {
@@ -263,6 +420,39 @@ test_instance_get_set_slots( Fixture *fixture, gconstpointer pData )
 
 }
 
+static void
+test_instance_kvp_typed_getters( Fixture *fixture, gconstpointer pData )
+{
+    auto frame = qof_instance_get_slots( fixture->inst );
+    auto guid = guid_new ();
+    gint64 ival = 0;
+    gnc_numeric nval = gnc_numeric_zero ();
+
+    frame->set_path( "a/int", new KvpValue{INT64_C(42)} );
+    frame->set_path( "a/num", new KvpValue{gnc_numeric_create(7, 2)} );
+    frame->set_path( "a/str", new KvpValue{g_strdup("text")} );
+    frame->set_path( "a/guid", new KvpValue{guid_copy(guid)} );
+
+    g_assert( qof_instance_kvp_get_int64( fixture->inst, "a/int", &ival ) );
+    g_assert_cmpint( ival, ==, 42 );
+    g_assert( qof_instance_kvp_get_numeric( fixture->inst, "a/num", &nval ) );
+    g_assert( gnc_numeric_equal( nval, gnc_numeric_create(7, 2) ) );
+    g_assert_cmpstr( qof_instance_kvp_get_string( fixture->inst, "a/str" ),
+                     ==, "text" );
+    g_assert( guid_equal( qof_instance_kvp_get_guid( fixture->inst, "a/guid" ),
+                          guid ) );
+
+    g_test_message( "Missing slots and other types leave the value alone" );
+    ival = 3;
+    g_assert( !qof_instance_kvp_get_int64( fixture->inst, "a/num", &ival ) );
+    g_assert( !qof_instance_kvp_get_int64( fixture->inst, "a/none", &ival ) );
+    g_assert_cmpint( ival, ==, 3 );
+    g_assert( !qof_instance_kvp_get_numeric( fixture->inst, "a/int", NULL ) );
+    g_assert( qof_instance_kvp_get_string( fixture->inst, "a/int" ) == NULL );
+    g_assert( qof_instance_kvp_get_guid( fixture->inst, "a/str" ) == NULL );
+    guid_free (guid);
+}
+
 static void
 test_instance_version_cmp( void )
 {
@@ -1043,7 +1233,11 @@ test_suite_qofinstance ( void )
     GNC_TEST_ADD( suitename, "set get guid", Fixture, NULL, setup, test_instance_set_get_guid, teardown );
     GNC_TEST_ADD_FUNC( suitename, "instance new and destroy", test_instance_new_destroy );
     GNC_TEST_ADD_FUNC( suitename, "init data", test_instance_init_data );
+    GNC_TEST_ADD_FUNC( suitename, "init data with guid", test_instance_init_data_with_guid );
     GNC_TEST_ADD( suitename, "get set slots", Fixture, NULL, setup, test_instance_get_set_slots, teardown );
+    GNC_TEST_ADD( suitename, "kvp typed getters", Fixture, NULL, setup, test_instance_kvp_typed_getters, teardown );
+    GNC_TEST_ADD_FUNC( suitename, "filtered and coalesced events", test_instance_filtered_coalesced_events );
+    GNC_TEST_ADD_FUNC( suitename, "asynchronous events", test_instance_async_events );
     GNC_TEST_ADD_FUNC( suitename, "version compare", test_instance_version_cmp );
     GNC_TEST_ADD( suitename, "get set dirty", Fixture, NULL, setup, test_instance_get_set_dirty, teardown );
     GNC_TEST_ADD( suitename, "display name", Fixture, NULL, setup, test_instance_display_name, teardown );
@@ -0,0 +1,89 @@
+/********************************************************************
+ * test-qoflog.c: GLib g_test test suite for the logging macros.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include "config.h"
+#include <glib.h>
+#include <unittest-support.h>
+#include "qof.h"
+
+static const gchar *suitename = "/qof/qoflog";
+static QofLogModule log_module = "test.qoflog";
+void test_suite_qoflog ( void );
+
+static void
+log_info (void)
+{
+    PINFO ("info %d", 1);
+}
+
+static void
+log_enter_leave (void)
+{
+    ENTER ("");
+    LEAVE ("");
+}
+
+static void
+test_qof_log_site_check (void)
+{
+    TestErrorStruct check = { G_LOG_LEVEL_INFO, "test.qoflog", NULL, 0 };
+    guint hdlr = g_log_set_handler ("test.qoflog", G_LOG_LEVEL_INFO,
+                                    (GLogFunc)test_checked_handler, &check);
+
+    /* Not enabled by default, so never reaches the handler. */
+    log_info ();
+    g_assert_cmpint (check.hits, ==, 0);
+    /* Changing the level has to be seen by a call site that has
+     * already cached its answer. */
+    qof_log_set_level ("test", QOF_LOG_INFO);
+    log_info ();
+    g_assert_cmpint (check.hits, ==, 1);
+    qof_log_set_level ("test.qoflog", QOF_LOG_WARNING);
+    log_info ();
+    g_assert_cmpint (check.hits, ==, 1);
+    g_log_remove_handler ("test.qoflog", hdlr);
+}
+
+static void
+test_qof_log_enter_leave (void)
+{
+    TestErrorStruct check = { G_LOG_LEVEL_DEBUG, "test.qoflog", NULL, 0 };
+    guint hdlr = g_log_set_handler ("test.qoflog", G_LOG_LEVEL_DEBUG,
+                                    (GLogFunc)test_checked_handler, &check);
+
+    qof_log_set_level ("test.qoflog", QOF_LOG_WARNING);
+    log_enter_leave ();
+    g_assert_cmpint (check.hits, ==, 0);
+    qof_log_set_level ("test.qoflog", QOF_LOG_DEBUG);
+    log_enter_leave ();
+    g_assert_cmpint (check.hits, ==, 2);
+    qof_log_set_level ("test.qoflog", QOF_LOG_WARNING);
+    log_enter_leave ();
+    g_assert_cmpint (check.hits, ==, 2);
+    g_log_remove_handler ("test.qoflog", hdlr);
+}
+
+void
+test_suite_qoflog ( void )
+{
+    GNC_TEST_ADD_FUNC (suitename, "log site check", test_qof_log_site_check);
+    GNC_TEST_ADD_FUNC (suitename, "enter leave", test_qof_log_enter_leave);
+}
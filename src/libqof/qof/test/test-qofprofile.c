@@ -0,0 +1,195 @@
+/********************************************************************
+ * test-qofprofile.c: GLib g_test test suite for qofprofile.cpp.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include "config.h"
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unittest-support.h>
+#include "qof.h"
+#include "qofprofile.h"
+
+static const gchar *suitename = "/qof/qofprofile";
+void test_suite_qofprofile ( void );
+
+#define NUM_THREADS 4
+#define NUM_MARKS 1000
+
+static void
+count_mark (void)
+{
+    QOF_PROFILE_COUNT ("test.count");
+}
+
+static void
+scope_mark (void)
+{
+    QOF_PROFILE_BEGIN (start);
+    QOF_PROFILE_END (start, "test.scope");
+}
+
+/* Dumps the profile and returns the trace; g_free it. */
+static gchar *
+dump_profile (void)
+{
+    gchar *name = g_strdup_printf ("test-qofprofile-%d", (int)getpid ());
+    gchar *filename = g_build_filename (g_get_tmp_dir (), name, NULL);
+    gchar *contents = NULL;
+    GError *error = NULL;
+
+    g_assert (qof_profile_dump (filename, &error));
+    g_assert_no_error (error);
+    g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+    g_unlink (filename);
+    g_free (filename);
+    g_free (name);
+    return contents;
+}
+
+/* The total the trace's counter event gives for name, or -1 if there is
+ * none. */
+static gint64
+counter_total (const gchar *trace, const gchar *name)
+{
+    gchar *key = g_strdup_printf ("{\"name\":\"%s\",\"ph\":\"C\"", name);
+    const gchar *event = strstr (trace, key);
+    gint64 count = -1;
+
+    g_free (key);
+    if (event)
+    {
+        const gchar *args = strstr (event, "\"count\":");
+        g_assert (args);
+        count = g_ascii_strtoll (args + strlen ("\"count\":"), NULL, 10);
+    }
+    return count;
+}
+
+/* The number of timed scopes the trace holds for name. */
+static guint
+scope_events (const gchar *trace, const gchar *name)
+{
+    gchar *key = g_strdup_printf ("{\"name\":\"%s\",\"ph\":\"X\"", name);
+    const gchar *event;
+    guint count = 0;
+
+    for (event = strstr (trace, key); event; event = strstr (event + 1, key))
+        ++count;
+    g_free (key);
+    return count;
+}
+
+static void
+test_qof_profile_inactive (void)
+{
+    gchar *trace;
+
+    qof_profile_set_active (TRUE);
+    count_mark ();
+    qof_profile_set_active (FALSE);
+    g_assert (!QOF_PROFILE_IS_ACTIVE ());
+    count_mark ();
+    scope_mark ();
+    trace = dump_profile ();
+    g_assert_cmpint (counter_total (trace, "test.count"), ==, 1);
+    g_assert_cmpint (scope_events (trace, "test.scope"), ==, 0);
+    g_free (trace);
+}
+
+static void
+test_qof_profile_restart (void)
+{
+    gchar *trace;
+
+    qof_profile_set_active (TRUE);
+    count_mark ();
+    count_mark ();
+    scope_mark ();
+    trace = dump_profile ();
+    g_assert_cmpint (counter_total (trace, "test.count"), ==, 2);
+    g_assert_cmpint (counter_total (trace, "test.scope"), ==, 1);
+    g_assert_cmpint (scope_events (trace, "test.scope"), ==, 1);
+    g_free (trace);
+
+    /* Starting again discards what was recorded before. */
+    qof_profile_set_active (TRUE);
+    count_mark ();
+    trace = dump_profile ();
+    g_assert_cmpint (counter_total (trace, "test.count"), ==, 1);
+    g_assert_cmpint (counter_total (trace, "test.scope"), ==, 0);
+    g_assert_cmpint (scope_events (trace, "test.scope"), ==, 0);
+    g_free (trace);
+    qof_profile_set_active (FALSE);
+}
+
+static gpointer
+mark_thread (gpointer data)
+{
+    int i;
+
+    for (i = 0; i < NUM_MARKS; ++i)
+    {
+        count_mark ();
+        scope_mark ();
+    }
+    return NULL;
+}
+
+static void
+test_qof_profile_threads (void)
+{
+    GThread *threads[NUM_THREADS];
+    gchar *trace;
+    int i;
+
+    qof_profile_set_active (TRUE);
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+#ifndef HAVE_GLIB_2_32
+        threads[i] = g_thread_create (mark_thread, NULL, TRUE, NULL);
+#else
+        threads[i] = g_thread_new ("profile_test", mark_thread, NULL);
+#endif
+        g_assert (threads[i]);
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+        g_thread_join (threads[i]);
+    trace = dump_profile ();
+    qof_profile_set_active (FALSE);
+
+    /* No mark is lost, whichever thread made it. */
+    g_assert_cmpint (counter_total (trace, "test.count"), ==,
+                     NUM_THREADS * NUM_MARKS);
+    g_assert_cmpint (counter_total (trace, "test.scope"), ==,
+                     NUM_THREADS * NUM_MARKS);
+    g_assert_cmpint (scope_events (trace, "test.scope"), ==,
+                     NUM_THREADS * NUM_MARKS);
+    g_free (trace);
+}
+
+void
+test_suite_qofprofile ( void )
+{
+    GNC_TEST_ADD_FUNC( suitename, "inactive", test_qof_profile_inactive);
+    GNC_TEST_ADD_FUNC( suitename, "restart", test_qof_profile_restart);
+    GNC_TEST_ADD_FUNC( suitename, "threads", test_qof_profile_threads);
+}
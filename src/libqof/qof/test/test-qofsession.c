@@ -544,6 +544,7 @@ static struct
 {
     QofBackend *be;
     gboolean called;
+    QofBackendError error;
 } session_end_struct;
 
 static void
@@ -552,6 +553,8 @@ mock_session_end (QofBackend *be)
     g_assert (be);
     g_assert (session_end_struct.be == be);
     session_end_struct.called = TRUE;
+    if (session_end_struct.error != ERR_BACKEND_NO_ERR)
+        qof_backend_set_error (be, session_end_struct.error);
 }
 
 static void
@@ -568,10 +571,18 @@ test_qof_session_end (Fixture *fixture, gconstpointer pData)
     fixture->session->book_id = g_strdup ("my book");
     session_end_struct.called = FALSE;
     session_end_struct.be = be;
+    session_end_struct.error = ERR_BACKEND_NO_ERR;
     qof_session_end (fixture->session);
     g_assert (session_end_struct.called);
     g_assert_cmpint (qof_session_get_error (fixture->session), == , ERR_BACKEND_NO_ERR);
     g_assert (!fixture->session->book_id);
+
+    g_test_message ("Test an error met while closing the backend is kept");
+    session_end_struct.called = FALSE;
+    session_end_struct.error = ERR_FILEIO_WRITE_ERROR;
+    qof_session_end (fixture->session);
+    g_assert (session_end_struct.called);
+    g_assert_cmpint (qof_session_get_error (fixture->session), == , ERR_FILEIO_WRITE_ERROR);
 }
 
 static struct
@@ -350,6 +350,19 @@ Invoice.decorate_functions(
     decorate_to_return_instance_instead_of_owner,
     'GetOwner', 'GetBillTo')
 
+def post_invoices_to_account(invoices, account, post_date, due_date, memo,
+                             accumulate_splits, autopay):
+    """Post the invoices to the account in one batch
+
+    Each invoice is posted as by Invoice.PostToAccount, but the accounts
+    involved are committed and the GUI notified only once for the whole
+    list. Returns the invoices that could not be posted.
+    """
+    failed = gnucash_core_c.gncInvoicePostListToAccount(
+        [invoice.instance for invoice in invoices], account.instance,
+        post_date, due_date, memo, accumulate_splits, autopay)
+    return [Invoice(instance=instance) for instance in failed]
+
 # Entry
 Entry.add_constructor_and_methods_with_prefix('gncEntry', 'Create')
 
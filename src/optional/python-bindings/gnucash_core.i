@@ -189,6 +189,36 @@
     gncOwnerFree($1);
 }
 
+/* A Python list of invoices for gncInvoicePostListToAccount */
+%typemap(in) GList *invoices {
+    int i, size;
+    $1 = NULL;
+    if (!PyList_Check($input)) {
+        PyErr_SetString(PyExc_TypeError, "not a list");
+        return NULL;
+    }
+    size = PyList_Size($input);
+    for (i = size-1; i >= 0; i--) {
+        void * pointer_to_real_thing;
+        if ((SWIG_ConvertPtr(PyList_GetItem($input, i), &pointer_to_real_thing,
+                             $descriptor(GncInvoice *),
+                             SWIG_POINTER_EXCEPTION)) != 0) {
+            PyErr_SetString(PyExc_TypeError, "list must contain invoices");
+            g_list_free($1);
+            return NULL;
+        }
+        $1 = g_list_prepend($1, pointer_to_real_thing);
+    }
+}
+
+%typemap(freearg) GList *invoices {
+    g_list_free($1);
+}
+
+/* and the list of those it couldn't post */
+%newobject gncInvoicePostListToAccount;
+%typemap(newfree) GList * "g_list_free($1);"
+
 static const GncGUID * gncEntryGetGUID(GncEntry *x);
 
 %include <gnc-lot.h>
@@ -215,6 +245,211 @@ static const GncGUID * gncEntryGetGUID(GncEntry *x);
 %include <cap-gains.h>
 %include <Scrub3.h>
 
+/* Bulk access to splits, for scripts analysing many of them.  Instead of
+ * one wrapped object per split, these return a dict of columns, each a
+ * string holding one native-endian value per split: "date" (the posted
+ * date of the split's transaction, time64), "amount_num",
+ * "amount_denom", "value_num", "value_denom" and "account_index", all
+ * int64, and "guid", 16 bytes per split.  "account_index" indexes the
+ * list of accounts in "accounts".  numpy.frombuffer reads the columns
+ * without copying them; see SplitColumns in gnucash_core.py. */
+%{
+static void
+gnc_python_set_column(PyObject *columns, const char *name, PyObject *column)
+{
+    PyDict_SetItemString(columns, name, column);
+    Py_DECREF(column);
+}
+
+static PyObject *
+gnc_python_split_columns(GList *splits)
+{
+    const char *names[] = { "date", "amount_num", "amount_denom",
+                            "value_num", "value_denom", "account_index" };
+    const guint n_int64 = G_N_ELEMENTS(names);
+    Py_ssize_t count = g_list_length(splits), i;
+    PyObject *columns, *accounts, *column[G_N_ELEMENTS(names)], *guids;
+    gint64 *data[G_N_ELEMENTS(names)];
+    unsigned char *guid_data;
+    GHashTable *account_index;
+    GList *node;
+    guint c;
+
+    columns = PyDict_New();
+    accounts = PyList_New(0);
+    for (c = 0; c < n_int64; c++)
+    {
+        column[c] = PyString_FromStringAndSize(NULL, count * sizeof(gint64));
+        data[c] = column[c] ? (gint64 *)PyString_AS_STRING(column[c]) : NULL;
+    }
+    guids = PyString_FromStringAndSize(NULL, count * GUID_DATA_SIZE);
+    if (!columns || !accounts || !guids)
+        goto error;
+    for (c = 0; c < n_int64; c++)
+        if (!column[c])
+            goto error;
+    guid_data = (unsigned char *)PyString_AS_STRING(guids);
+
+    account_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (node = splits, i = 0; node; node = node->next, i++)
+    {
+        Split *split = node->data;
+        Account *acc = xaccSplitGetAccount(split);
+        gnc_numeric amount = xaccSplitGetAmount(split);
+        gnc_numeric value = xaccSplitGetValue(split);
+        gpointer index;
+
+        if (!g_hash_table_lookup_extended(account_index, acc, NULL, &index))
+        {
+            PyObject *pyacc = SWIG_NewPointerObj(acc, SWIGTYPE_p_Account, 0);
+            index = GINT_TO_POINTER(PyList_GET_SIZE(accounts));
+            PyList_Append(accounts, pyacc);
+            Py_DECREF(pyacc);
+            g_hash_table_insert(account_index, acc, index);
+        }
+        data[0][i] = xaccTransGetDate(xaccSplitGetParent(split));
+        data[1][i] = amount.num;
+        data[2][i] = amount.denom;
+        data[3][i] = value.num;
+        data[4][i] = value.denom;
+        data[5][i] = GPOINTER_TO_INT(index);
+        memcpy(guid_data + i * GUID_DATA_SIZE,
+               qof_instance_get_guid(QOF_INSTANCE(split))->reserved,
+               GUID_DATA_SIZE);
+    }
+    g_hash_table_destroy(account_index);
+
+    for (c = 0; c < n_int64; c++)
+        gnc_python_set_column(columns, names[c], column[c]);
+    gnc_python_set_column(columns, "guid", guids);
+    gnc_python_set_column(columns, "accounts", accounts);
+    return columns;
+
+error:
+    for (c = 0; c < n_int64; c++)
+        Py_XDECREF(column[c]);
+    Py_XDECREF(guids);
+    Py_XDECREF(accounts);
+    Py_XDECREF(columns);
+    return PyErr_NoMemory();
+}
+%}
+
+%inline %{
+/* The splits of the account, and of its descendants if include_children
+ * is true, each account's in their usual order. */
+static PyObject *
+gnc_python_account_split_columns(Account *account, gboolean include_children)
+{
+    GList *splits = g_list_copy(xaccAccountGetSplitList(account));
+    PyObject *columns;
+
+    if (include_children)
+    {
+        GList *descendants = gnc_account_get_descendants(account), *node;
+        for (node = descendants; node; node = node->next)
+            splits = g_list_concat(splits,
+                                   g_list_copy(xaccAccountGetSplitList(node->data)));
+        g_list_free(descendants);
+    }
+    columns = gnc_python_split_columns(splits);
+    g_list_free(splits);
+    return columns;
+}
+
+/* All the splits of the book, account by account. */
+static PyObject *
+gnc_python_book_split_columns(QofBook *book)
+{
+    Account *root = gnc_book_get_root_account(book);
+
+    if (!root)
+        return gnc_python_split_columns(NULL);
+    return gnc_python_account_split_columns(root, TRUE);
+}
+
+/* Sums the amounts of split columns into the balance of each account
+ * as of each of period_ends, ascending time64 values: a string of
+ * n_accounts * n_periods doubles, row by row.  The columns are only
+ * read, and no engine call is made, so other threads run meanwhile. */
+static PyObject *
+gnc_python_balance_matrix(PyObject *dates, PyObject *nums, PyObject *denoms,
+                          PyObject *account_index, int n_accounts,
+                          PyObject *period_ends)
+{
+    const gint64 *date, *num, *denom, *account, *end;
+    Py_ssize_t count, n_periods, i, a, p;
+    PyObject *matrix;
+    double *cell;
+
+    if (!PyString_Check(dates) || !PyString_Check(nums) ||
+        !PyString_Check(denoms) || !PyString_Check(account_index) ||
+        !PyString_Check(period_ends) || n_accounts < 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "expected split columns");
+        return NULL;
+    }
+    count = PyString_GET_SIZE(dates) / sizeof(gint64);
+    n_periods = PyString_GET_SIZE(period_ends) / sizeof(gint64);
+    if (PyString_GET_SIZE(nums) / sizeof(gint64) != count ||
+        PyString_GET_SIZE(denoms) / sizeof(gint64) != count ||
+        PyString_GET_SIZE(account_index) / sizeof(gint64) != count)
+    {
+        PyErr_SetString(PyExc_ValueError, "the columns differ in length");
+        return NULL;
+    }
+    matrix = PyString_FromStringAndSize(NULL, n_accounts * n_periods *
+                                        sizeof(double));
+    if (!matrix)
+        return NULL;
+    date = (const gint64 *)PyString_AS_STRING(dates);
+    num = (const gint64 *)PyString_AS_STRING(nums);
+    denom = (const gint64 *)PyString_AS_STRING(denoms);
+    account = (const gint64 *)PyString_AS_STRING(account_index);
+    end = (const gint64 *)PyString_AS_STRING(period_ends);
+    cell = (double *)PyString_AS_STRING(matrix);
+
+    Py_BEGIN_ALLOW_THREADS
+    memset(cell, 0, n_accounts * n_periods * sizeof(double));
+    for (i = 0; i < count; i++)
+    {
+        Py_ssize_t lo = 0, hi = n_periods;
+
+        if (account[i] < 0 || account[i] >= n_accounts || !denom[i])
+            continue;
+        /* The first period ending at or after the split's date. */
+        while (lo < hi)
+        {
+            Py_ssize_t mid = (lo + hi) / 2;
+            if (end[mid] < date[i])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < n_periods)
+            cell[account[i] * n_periods + lo] += (double)num[i] / denom[i];
+    }
+    for (a = 0; a < n_accounts; a++)
+        for (p = 1; p < n_periods; p++)
+            cell[a * n_periods + p] += cell[a * n_periods + p - 1];
+    Py_END_ALLOW_THREADS
+
+    return matrix;
+}
+
+/* Runs a query for splits, returning its results as columns. */
+static PyObject *
+gnc_python_query_split_columns(QofQuery *query)
+{
+    if (g_strcmp0(qof_query_get_search_for(query), GNC_ID_SPLIT) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "the query doesn't search for splits");
+        return NULL;
+    }
+    return gnc_python_split_columns(qof_query_run(query));
+}
+%}
+
 %init %{
 gnc_environment_setup();
 qof_log_init();
@@ -355,6 +355,10 @@ GncPriceDB.get_prices = method_function_returns_instance_list(
 
 class GncCommodity(GnuCashCoreClass): pass
 
+class GncCommodityCollector(GnuCashCoreClass):
+    """A CommodityCollector adds up amounts, keeping one total per commodity.
+    Call destroy() when done with it."""
+
 class GncCommodityTable(GnuCashCoreClass):
     """A CommodityTable provides a way to store and lookup commodities.
     Commodities are primarily currencies, but other tradable things such as
@@ -538,6 +542,14 @@ GncCommodity.add_constructor_and_methods_with_prefix('gnc_commodity_', 'new')
 GncCommodity.clone = method_function_returns_instance(
     GncCommodity.clone, GncCommodity )
 
+# GncCommodityCollector
+GncCommodityCollector.add_constructor_and_methods_with_prefix(
+    'gnc_commodity_collector_', 'new')
+methods_return_instance(GncCommodityCollector,
+                        { 'get_amount' : GncNumeric })
+methods_return_instance_lists(
+    GncCommodityCollector, { 'get_commodities': GncCommodity })
+
 # GncCommodityTable
 GncCommodityTable.add_methods_with_prefix('gnc_commodity_table_')
 commoditytable_dict =   {
@@ -680,6 +692,100 @@ methods_return_instance_lists(
                        })
 Account.name = property( Account.GetName, Account.SetName )
 
+class SplitColumns(object):
+    """The splits of an account or a query, one column per field.
+
+    The int64 columns (INT64_COLUMNS) and the guid column are strings of
+    native-endian values, one per split, so that they can be handed to
+    numpy without copying; to_numpy() does that, and column() unpacks
+    one into a list without needing numpy. accounts lists the Account
+    each account_index refers to.
+    """
+    INT64_COLUMNS = ('date', 'amount_num', 'amount_denom',
+                     'value_num', 'value_denom', 'account_index')
+
+    def __init__(self, columns):
+        for name in self.INT64_COLUMNS:
+            setattr(self, name, columns[name])
+        self.guid = columns['guid']
+        self.accounts = [Account(instance=account)
+                         for account in columns['accounts']]
+
+    def __len__(self):
+        return len(self.date) // 8
+
+    def column(self, name):
+        """Returns the named int64 column as a list."""
+        from struct import unpack
+        return list(unpack('=%dq' % len(self), getattr(self, name)))
+
+    def to_numpy(self):
+        """Returns a dict of numpy arrays sharing the columns' memory:
+        int64 arrays for INT64_COLUMNS and 16-byte void items for guid."""
+        import numpy
+        arrays = dict((name, numpy.frombuffer(getattr(self, name),
+                                              dtype=numpy.int64))
+                      for name in self.INT64_COLUMNS)
+        arrays['guid'] = numpy.frombuffer(self.guid, dtype='V16')
+        return arrays
+
+def _account_get_split_columns(self, include_children=False):
+    """Returns the account's splits, and with include_children those of
+    its descendants too, as SplitColumns."""
+    return SplitColumns(gnucash_core_c.gnc_python_account_split_columns(
+        self.get_instance(), include_children))
+Account.GetSplitColumns = _account_get_split_columns
+
+class BookSnapshot(object):
+    """A read-only copy of a book's splits and accounts for analysis.
+
+    The engine isn't thread-safe: its objects, Book, Account, Split and
+    the rest, may only be used by one thread at a time, and the GIL is
+    kept during every engine call to enforce that. A snapshot is taken
+    with one such call, on the thread using the book; it holds no
+    engine objects but accounts, and its other attributes never change
+    afterwards, so any number of threads may read them concurrently.
+
+    splits holds the SplitColumns of all the book's splits. For each
+    of them, in order, account_names has the full name, account_guids
+    the GUID string and account_commodities the commodity's mnemonic;
+    accounts has the Account objects, which are engine objects again.
+
+    balance_matrix() releases the GIL while it sums, as do numpy's
+    operations on to_numpy() arrays, so analyses run on all cores.
+    """
+
+    def __init__(self, book):
+        self.splits = SplitColumns(
+            gnucash_core_c.gnc_python_book_split_columns(book.get_instance()))
+        self.accounts = self.splits.accounts
+        self.account_names = tuple(a.get_full_name() for a in self.accounts)
+        self.account_guids = tuple(a.GetGUID().to_string()
+                                   for a in self.accounts)
+        self.account_commodities = tuple(
+            a.GetCommodity().get_mnemonic() if a.GetCommodity() else None
+            for a in self.accounts)
+
+    def balance_matrix(self, period_ends):
+        """Returns, for each account, the list of its balances as of each
+        of period_ends, ascending time64 values, computed from the split
+        amounts as floats."""
+        from struct import pack, unpack
+        n_accounts = len(self.accounts)
+        n_periods = len(period_ends)
+        matrix = gnucash_core_c.gnc_python_balance_matrix(
+            self.splits.date, self.splits.amount_num, self.splits.amount_denom,
+            self.splits.account_index, n_accounts,
+            pack('=%dq' % n_periods, *period_ends))
+        cells = unpack('=%dd' % (n_accounts * n_periods), matrix)
+        return [list(cells[a * n_periods:(a + 1) * n_periods])
+                for a in range(n_accounts)]
+
+def _book_snapshot(self):
+    """Returns a BookSnapshot of the book."""
+    return BookSnapshot(self)
+Book.snapshot = _book_snapshot
+
 #GUID
 GUID.add_methods_with_prefix('guid_')
 GUID.add_method('xaccAccountLookup', 'AccountLookup')
@@ -744,6 +850,12 @@ Query.add_method('qof_query_add_guid_list_match', 'add_guid_list_match')
 Query.add_method('qof_query_add_guid_match', 'add_guid_match')
 Query.add_method('qof_query_destroy', 'destroy')
 
+def _query_run_split_columns(self):
+    """Runs a query for splits and returns the results as SplitColumns."""
+    return SplitColumns(gnucash_core_c.gnc_python_query_split_columns(
+        self.get_instance()))
+Query.run_split_columns = _query_run_split_columns
+
 class QueryStringPredicate(GnuCashCoreClass):
     pass
 
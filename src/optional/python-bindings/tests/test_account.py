@@ -66,5 +66,63 @@ class TestAccount( AccountSession ):
         self.account.ScrubLots()
         self.assertEqual(len(self.account.GetLotList()),1)
 
+    def test_split_columns(self):
+        self.account.SetCommodity(self.currency)
+        child = Account(self.book)
+        child.SetCommodity(self.currency)
+        self.account.append_child(child)
+
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        tx.SetDateEnteredTS(datetime.now())
+        tx.SetDatePostedTS(datetime.now())
+        for account, amount in ((self.account, 25), (child, -25)):
+            split = Split(self.book)
+            split.SetParent(tx)
+            split.SetAccount(account)
+            split.SetAmount(GncNumeric(amount))
+            split.SetValue(GncNumeric(amount))
+        tx.CommitEdit()
+
+        columns = self.account.GetSplitColumns()
+        self.assertEqual(len(columns), 1)
+        self.assertEqual(columns.column('amount_num'), [25])
+        self.assertEqual(columns.column('amount_denom'), [1])
+        self.assertEqual(columns.column('date'), [tx.GetDate()])
+
+        columns = self.account.GetSplitColumns(True)
+        self.assertEqual(len(columns), 2)
+        self.assertEqual(sorted(columns.column('value_num')), [-25, 25])
+        self.assertEqual(len(columns.accounts), 2)
+        self.assertEqual(len(columns.guid), 32)
+        for index in columns.column('account_index'):
+            self.assertTrue(0 <= index < len(columns.accounts))
+
+    def test_snapshot(self):
+        self.account.SetCommodity(self.currency)
+        self.account.SetName("Money")
+        self.book.get_root_account().append_child(self.account)
+
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        tx.SetDateEnteredTS(datetime.now())
+        tx.SetDatePostedTS(datetime.now())
+        split = Split(self.book)
+        split.SetParent(tx)
+        split.SetAccount(self.account)
+        split.SetAmount(GncNumeric(10))
+        split.SetValue(GncNumeric(10))
+        tx.CommitEdit()
+
+        snapshot = self.book.snapshot()
+        self.assertEqual(len(snapshot.splits), 1)
+        self.assertEqual(snapshot.account_names, ("Money",))
+        self.assertEqual(snapshot.account_commodities, ("EUR",))
+        posted = tx.GetDate()
+        self.assertEqual(snapshot.balance_matrix([posted - 1, posted]),
+                         [[0.0, 10.0]])
+
 if __name__ == '__main__':
     main()
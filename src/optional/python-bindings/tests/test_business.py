@@ -5,7 +5,8 @@ from datetime import datetime
 from gnucash import Account, \
     ACCT_TYPE_RECEIVABLE, ACCT_TYPE_INCOME, ACCT_TYPE_BANK, \
     GncNumeric
-from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry
+from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry, \
+    post_invoices_to_account
 
 from test_book import BookSession
 
@@ -30,18 +31,21 @@ class BusinessSession( BookSession ):
         self.employee = Employee(self.book,'EmployeeID',self.currency)
         self.job = Job(self.book,'JobID',self.customer)
 
-        self.invoice = Invoice(self.book,'InvoiceID',self.currency,self.customer)
-        self.invoice.SetDateOpened(self.today)
+        self.invoice = self.make_invoice('InvoiceID', 100)
+        self.invoice.PostToAccount(self.receivable,
+            self.today, self.today, "", True, False)
+
+    def make_invoice(self, id, amount):
+        invoice = Invoice(self.book,id,self.currency,self.customer)
+        invoice.SetDateOpened(self.today)
         entry = Entry(self.book)
         entry.SetDate(self.today)
         entry.SetDescription("Some income")
         entry.SetQuantity(GncNumeric(1))
         entry.SetInvAccount(self.income)
-        entry.SetInvPrice(GncNumeric(100))
-        self.invoice.AddEntry(entry)
-
-        self.invoice.PostToAccount(self.receivable,
-            self.today, self.today, "", True, False)
+        entry.SetInvPrice(GncNumeric(amount))
+        invoice.AddEntry(entry)
+        return invoice
 
 class TestBusiness( BusinessSession ):
     def test_equal(self):
@@ -58,6 +62,16 @@ class TestBusiness( BusinessSession ):
     def test_post(self):
         self.assertTrue( self.invoice.IsPosted() )
 
+    def test_post_list(self):
+        first = self.make_invoice('First', 10)
+        second = self.make_invoice('Second', 20)
+        failed = post_invoices_to_account([first, self.invoice, second],
+            self.receivable, self.today, self.today, "", True, False)
+        self.assertTrue( first.IsPosted() )
+        self.assertTrue( second.IsPosted() )
+        self.assertEqual( 1, len(failed) )
+        self.assertEqual( self.invoice.GetID(), failed[0].GetID() )
+
     def test_owner(self):
         OWNER = self.invoice.GetOwner()
         self.assertTrue( self.customer.Equal( OWNER ) )
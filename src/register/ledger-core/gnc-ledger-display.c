@@ -581,6 +581,23 @@ refresh_handler (GHashTable *changes, gpointer user_data)
 
     gnc_ledger_display_set_watches (ld, splits);
 
+    /* Most commits only change the contents of rows that are already
+     * shown, so try redrawing those before reloading the register. */
+    if (changes && gnc_split_register_full_refresh_ok (ld->reg))
+    {
+        gboolean updated;
+
+        ld->loading = TRUE;
+        updated = gnc_split_register_update_rows (ld->reg, splits);
+        ld->loading = FALSE;
+
+        if (updated)
+        {
+            LEAVE("updated in place");
+            return;
+        }
+    }
+
     gnc_ledger_display_refresh_internal (ld, splits);
     LEAVE(" ");
 }
@@ -656,6 +673,9 @@ gnc_ledger_display_make_query (GNCLedgerDisplay *ld,
     xaccQueryAddAccountMatch (ld->query, accounts,
                               QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
 
+    /* Follow edits instead of searching again on every refresh */
+    qof_query_set_live (ld->query, TRUE);
+
     g_list_free (accounts);
 }
 
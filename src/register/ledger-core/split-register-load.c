@@ -213,31 +213,51 @@ _find_split_with_parent_txn(gconstpointer a, gconstpointer b)
     return xaccSplitGetParent(split) == txn ? 0 : 1;
 }
 
-static void add_quickfill_completions(TableLayout *layout, Transaction *trans,
+/** The cells that are filled with completions while loading.  They
+ *  are looked up once per load rather than once per split. */
+typedef struct
+{
+    QuickFillCell *desc_cell;
+    QuickFillCell *notes_cell;
+    QuickFillCell *memo_cell;
+    NumCell *num_cell;
+} QuickFillCells;
+
+static void
+get_quickfill_cells (TableLayout *layout, QuickFillCells *cells)
+{
+    cells->desc_cell =
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, DESC_CELL);
+    cells->notes_cell =
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, NOTES_CELL);
+    cells->memo_cell =
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, MEMO_CELL);
+    cells->num_cell =
+        (NumCell *) gnc_table_layout_get_cell (layout, NUM_CELL);
+}
+
+static void add_quickfill_completions(QuickFillCells *cells, Transaction *trans,
                                       Split *split, gboolean has_last_num)
 {
-    Split *s;
-    int i = 0;
+    GList *node;
 
-    gnc_quickfill_cell_add_completion(
-        (QuickFillCell *) gnc_table_layout_get_cell(layout, DESC_CELL),
-        xaccTransGetDescription(trans));
+    gnc_quickfill_cell_add_completion(cells->desc_cell,
+                                      xaccTransGetDescription(trans));
 
-    gnc_quickfill_cell_add_completion(
-        (QuickFillCell *) gnc_table_layout_get_cell(layout, NOTES_CELL),
-        xaccTransGetNotes(trans));
+    gnc_quickfill_cell_add_completion(cells->notes_cell,
+                                      xaccTransGetNotes(trans));
 
     if (!has_last_num)
-        gnc_num_cell_set_last_num(
-            (NumCell *) gnc_table_layout_get_cell(layout, NUM_CELL),
-            gnc_get_num_action(trans, split));
+        gnc_num_cell_set_last_num(cells->num_cell,
+                                  gnc_get_num_action(trans, split));
 
-    while ((s = xaccTransGetSplit(trans, i)) != NULL)
+    for (node = xaccTransGetSplitList(trans); node; node = node->next)
     {
-        gnc_quickfill_cell_add_completion(
-            (QuickFillCell *) gnc_table_layout_get_cell(layout, MEMO_CELL),
-            xaccSplitGetMemo(s));
-        i++;
+        Split *s = node->data;
+
+        if (!xaccTransStillHasSplit(trans, s)) continue;
+        gnc_quickfill_cell_add_completion(cells->memo_cell,
+                                          xaccSplitGetMemo(s));
     }
 }
 
@@ -331,6 +351,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     SRInfo *info;
     Transaction *pending_trans;
     CursorBuffer *cursor_buffer;
+    QuickFillCells quickfill_cells;
     GHashTable *trans_table = NULL;
     CellBlock *cursor_header;
     CellBlock *lead_cursor;
@@ -414,6 +435,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
 
     lead_cursor = gnc_split_register_get_passive_cursor (reg);
     split_cursor = gnc_table_layout_get_cursor (table->layout, CURSOR_SPLIT);
+    get_quickfill_cells (table->layout, &quickfill_cells);
 
     /* figure out where we are going to. */
     if (info->traverse_to_new)
@@ -622,7 +644,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         /* If this is the first load of the register,
          * fill up the quickfill cells. */
         if (info->first_pass)
-            add_quickfill_completions(reg->table->layout, trans, split, has_last_num);
+            add_quickfill_completions(&quickfill_cells, trans, split, has_last_num);
 
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
@@ -771,6 +793,181 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     LEAVE(" ");
 }
 
+/* Find the next split in @a node that gnc_split_register_load would
+ * give a transaction row, mirroring the filtering done there. */
+static GList *
+next_loaded_split (GList *node, Transaction *blank_trans, GHashTable *trans_table)
+{
+    for ( ; node; node = node->next)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+
+        if (!xaccTransStillHasSplit (trans, split))
+            continue;
+
+        /* another register's blank split */
+        if (xaccTransCountSplits (trans) == 1 &&
+                xaccSplitGetAccount (split) == NULL)
+            continue;
+
+        if (trans == blank_trans)
+            continue;
+
+        if (trans_table)
+        {
+            if (g_hash_table_lookup (trans_table, trans))
+                continue;
+
+            g_hash_table_insert (trans_table, trans, trans);
+        }
+        return node;
+    }
+    return NULL;
+}
+
+/* Check that loading @a slist would produce exactly the rows that are
+ * in the table now: the same transactions in the same order, each with
+ * the same number of split rows, and the same dividing rows. */
+static gboolean
+gnc_split_register_rows_match (SplitRegister *reg, GList *slist,
+                               Transaction *blank_trans)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+    Table *table = reg->table;
+    GHashTable *trans_table = NULL;
+    VirtualCellLocation vcell_loc;
+    time64 present = gnc_time64_get_today_end ();
+    int future_row = -1;
+    gboolean match = TRUE;
+    GList *node;
+
+    if (reg->style == REG_STYLE_JOURNAL)
+        trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    vcell_loc.virt_row = 1;
+    vcell_loc.virt_col = 0;
+    node = next_loaded_split (slist, blank_trans, trans_table);
+
+    while (match && vcell_loc.virt_row < table->num_virt_rows)
+    {
+        Split *split = gnc_split_register_get_split (reg, vcell_loc);
+        Transaction *trans = xaccSplitGetParent (split);
+        int trans_row = vcell_loc.virt_row;
+        int n_split_rows = 0;
+
+        if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+                CURSOR_CLASS_TRANS)
+        {
+            match = FALSE;
+            break;
+        }
+
+        for (vcell_loc.virt_row++; vcell_loc.virt_row < table->num_virt_rows;
+                vcell_loc.virt_row++)
+        {
+            if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+                    CURSOR_CLASS_SPLIT)
+                break;
+            n_split_rows++;
+        }
+
+        if (trans == blank_trans)
+            continue;
+
+        /* Each loaded transaction has a row per split plus an empty one. */
+        if (!node || node->data != split ||
+                n_split_rows != xaccTransCountSplits (trans) + 1)
+        {
+            match = FALSE;
+            break;
+        }
+
+        if (future_row < 0 && xaccTransGetDate (trans) > present)
+            future_row = trans_row;
+
+        node = next_loaded_split (node->next, blank_trans, trans_table);
+    }
+
+    if (trans_table)
+        g_hash_table_destroy (trans_table);
+
+    if (!match || node)
+        return FALSE;
+
+    if (!info->show_present_divider)
+        return TRUE;
+
+    if (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL_REGISTER,
+                            GNC_PREF_FUTURE_AFTER_BLANK))
+    {
+        if (future_row < 0)
+            return table->model->dividing_row < 0;
+        return table->model->dividing_row_lower == future_row;
+    }
+    return table->model->dividing_row == future_row;
+}
+
+gboolean
+gnc_split_register_update_rows (SplitRegister *reg, GList *slist)
+{
+    SRInfo *info;
+    Table *table;
+    Split *blank_split;
+    VirtualLocation save_loc;
+    VirtualLocation virt_loc;
+
+    g_return_val_if_fail (reg, FALSE);
+    table = reg->table;
+    g_return_val_if_fail (table, FALSE);
+    info = gnc_split_register_get_info (reg);
+    g_return_val_if_fail (info, FALSE);
+
+    ENTER("reg=%p, slist=%p", reg, slist);
+
+    /* Pending edits, the first load and the read-only divider are all
+     * handled only by the full load. */
+    if (info->first_pass ||
+            !guid_equal (&info->pending_trans_guid, guid_null ()) ||
+            gnc_table_current_cursor_changed (table, FALSE) ||
+            (info->show_present_divider &&
+             qof_book_uses_autoreadonly (gnc_get_current_book ())))
+    {
+        LEAVE("needs full load");
+        return FALSE;
+    }
+
+    blank_split = xaccSplitLookup (&info->blank_split_guid,
+                                   gnc_get_current_book ());
+    if (blank_split == NULL ||
+            !gnc_split_register_rows_match (reg, slist,
+                                            xaccSplitGetParent (blank_split)))
+    {
+        LEAVE("rows changed");
+        return FALSE;
+    }
+
+    /* The rows are the same, so only the cursor, which holds copies of
+     * the cell values, needs reloading before the redraw. */
+    save_loc = table->current_cursor_loc;
+
+    gnc_table_control_allow_move (table->control, FALSE);
+
+    gnc_virtual_location_init (&virt_loc);
+    gnc_table_move_cursor_gui (table, virt_loc);
+    gnc_table_move_cursor_gui (table, save_loc);
+
+    gnc_split_register_set_cell_fractions (
+        reg, gnc_split_register_get_current_split (reg));
+
+    gnc_table_redraw_gui (table);
+
+    gnc_table_control_allow_move (table->control, TRUE);
+
+    LEAVE("updated in place");
+    return TRUE;
+}
+
 /* ===================================================================== */
 
 #define QKEY  "split_reg_shared_quickfill"
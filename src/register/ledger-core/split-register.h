@@ -496,6 +496,21 @@ void gnc_split_register_cancel_cursor_trans_changes (SplitRegister *reg);
 void gnc_split_register_load (SplitRegister *reg, GList * slist,
                               Account *default_account);
 
+/** Refreshes the rows of a register in place, without rebuilding them.
+ *
+ *  This only succeeds if loading @a slist with gnc_split_register_load
+ *  would produce the rows already in the register, e.g. after an edit
+ *  that changed only the contents of existing transactions.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param slist a list of splits
+ *
+ *  @return TRUE if the register was refreshed, FALSE if a full
+ *  gnc_split_register_load is needed instead.
+ */
+gboolean gnc_split_register_update_rows (SplitRegister *reg, GList * slist);
+
 /** Copy the contents of the current cursor to a split. The split and
  *    transaction that are updated are the ones associated with the
  *    current cursor (register entry) position. If the do_commit flag
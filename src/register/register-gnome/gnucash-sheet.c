@@ -2590,6 +2590,21 @@ gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll)
     gnucash_sheet_activate_cursor_cell (sheet, TRUE);
 }
 
+void
+gnucash_sheet_table_redraw (GnucashSheet *sheet)
+{
+    g_return_if_fail (sheet != NULL);
+    g_return_if_fail (GNUCASH_IS_SHEET(sheet));
+    g_return_if_fail (sheet->table != NULL);
+
+    gnucash_sheet_stop_editing (sheet);
+
+    gnucash_sheet_cursor_set_from_table (sheet, FALSE);
+    gnucash_sheet_activate_cursor_cell (sheet, TRUE);
+
+    gnucash_sheet_redraw_all (sheet);
+}
+
 static void
 gnucash_sheet_realize_entry (GnucashSheet *sheet, GtkWidget *entry)
 {
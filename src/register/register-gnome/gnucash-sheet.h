@@ -73,6 +73,10 @@ GtkWidget *gnucash_sheet_new (Table *table);
 
 void gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll);
 
+/** Redraw the sheet and its cursor after the cell contents of the table
+ *  changed but its virtual cells did not. */
+void gnucash_sheet_table_redraw (GnucashSheet *sheet);
+
 void gnucash_sheet_recompute_block_offsets (GnucashSheet *sheet);
 
 GType gnucash_register_get_type (void);
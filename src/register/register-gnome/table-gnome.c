@@ -241,6 +241,23 @@ gnc_table_refresh_gui (Table * table, gboolean do_scroll)
     gnucash_sheet_redraw_all (sheet);
 }
 
+void
+gnc_table_redraw_gui (Table * table)
+{
+    GnucashSheet *sheet;
+
+    if (!table)
+        return;
+    if (!table->ui_data)
+        return;
+
+    g_return_if_fail (GNUCASH_IS_SHEET (table->ui_data));
+
+    sheet = GNUCASH_SHEET(table->ui_data);
+
+    gnucash_sheet_table_redraw (sheet);
+}
+
 
 static void
 gnc_table_refresh_cursor_gnome (Table * table,
@@ -27,7 +27,6 @@
 (define-module (gnucash report aging))
 
 (use-modules (gnucash main))
-(use-modules (gnucash printf))
 (use-modules (gnucash gnc-module))
 (use-modules (gnucash gettext))
 
@@ -47,22 +46,15 @@
 
 (export optname-show-zeros)
 
-;; The idea is:  have a hash with the key being the contact name
-;; (In future this might be GUID'ed, but for now it's a string
-;; from the description or the split memo.
-;; The value is a record which contains the currency that contact
-;; is stored in (you can only owe a particular contact one
-;; currency, it just gets far too difficult otherwise), and a list
-;; of buckets containing the money owed for each interval,
+;; The idea is:  the engine's aging pass (gncOwnerAgingNew) groups the
+;; open lot balances of the account by owner and buckets them by age,
+;; as they stood on the report date.  Each owner gets a record which
+;; contains the currency of the account and the buckets of money owed,
 ;; oldest first.
-;; overpayment is just that - it stores the current overpayment, 
-;; if any.  Any bills get taken out of the overpayment before
-;; incurring debt.
 
 (define company-info (make-record-type "ComanyInfo" 
 				       '(currency
 					 bucket-vector
-					 overpayment
 					 owner-obj)))
 
 (define num-buckets 5)
@@ -70,10 +62,10 @@
   (make-vector num-buckets (gnc-numeric-zero)))
 
 (define make-company-private
-  (record-constructor company-info '(currency bucket-vector overpayment owner-obj)))
+  (record-constructor company-info '(currency bucket-vector owner-obj)))
 
 (define (make-company currency owner-obj)
-  (make-company-private currency (new-bucket-vector) (gnc-numeric-zero) owner-obj))
+  (make-company-private currency (new-bucket-vector) owner-obj))
 
 (define company-get-currency
   (record-accessor company-info 'currency))
@@ -90,162 +82,35 @@
 (define company-set-buckets
   (record-modifier company-info 'bucket-vector))
 
-(define company-get-overpayment
-  (record-accessor company-info 'overpayment))
-
-(define company-set-overpayment
-  (record-modifier company-info 'overpayment))
-
-;; Put an invoice in the appropriate bucket
-
-(define (process-invoice company amount bucket-intervals date)
-  (define (in-interval this-date current-bucket)
-    (gnc:timepair-lt this-date current-bucket))
-
-  (define (find-bucket current-bucket bucket-intervals date)  
-    (gnc:debug "looking for bucket for date: " date)
-    (begin
-      (gnc:debug "current bucket: " current-bucket)
-      (gnc:debug "bucket-intervals: " bucket-intervals)
-      (if (> current-bucket (vector-length bucket-intervals))
-	  (gnc:error "sanity check failed in find-bucket")
-	  (if (in-interval date (vector-ref bucket-intervals current-bucket))
-	      (begin
-		(gnc:debug "found bucket")
-		current-bucket)
-	      (find-bucket (+ current-bucket 1) bucket-intervals date)))))
-
-  (define (calculate-adjusted-values amount overpayment)
-    (if (>= (gnc-numeric-compare amount overpayment) 0)
-	(cons (gnc-numeric-sub-fixed amount overpayment)
-	      (gnc-numeric-zero))
-	(cons (gnc-numeric-zero)
-	      (gnc-numeric-sub-fixed overpayment amount))))
-
-  (let* ((current-overpayment (company-get-overpayment company))
-	 (adjusted-values (calculate-adjusted-values amount current-overpayment))
-	 (adjusted-amount (car adjusted-values))
-	 (adjusted-overpayment (cdr adjusted-values))
-	 (bucket-index (find-bucket 0 bucket-intervals date))
-	 (buckets (company-get-buckets company))
-	 (new-bucket-value 
-	  (gnc-numeric-add-fixed adjusted-amount (vector-ref buckets bucket-index))))
-    (vector-set! buckets bucket-index new-bucket-value)
-    (company-set-buckets company buckets)
-    (company-set-overpayment company adjusted-overpayment)))
-
-
-;; NOTE: We assume that bill payments occur in a FIFO manner - ie
-;; any payment to a company goes towards the *oldest* bill first
-
-
-(define (process-payment company amount)
-  (define (process-payment-driver amount buckets current-bucket-index)
-    (if (>= current-bucket-index (vector-length buckets))
-	amount
-	(let ((current-bucket-amt (vector-ref buckets current-bucket-index)))
-	  (if (>= (gnc-numeric-compare current-bucket-amt amount) 0)
-	      (begin
-		(vector-set! buckets current-bucket-index (gnc-numeric-sub-fixed
-							   current-bucket-amt amount))
-		(gnc-numeric-zero))
-	      (begin
-		(vector-set! buckets current-bucket-index (gnc-numeric-zero))
-		(process-payment-driver 
-		 (gnc-numeric-sub-fixed amount current-bucket-amt)
-		 buckets
-		 (+ current-bucket-index 1)))))))
-  
-  (let ((overpayment (company-get-overpayment company)))
-	;; if there's already an overpayment, make it bigger
-    (gnc:debug "processing payment of " amount)
-    (gnc:debug "overpayment was " overpayment)
-
-	(if (gnc-numeric-positive-p overpayment)
-	    (company-set-overpayment company (gnc-numeric-add-fixed overpayment amount))
-	    
-	    (let ((result (process-payment-driver amount (company-get-buckets company) 0)))
-	      (gnc:debug "payment-driver processed.  new overpayment: " result)
-	      (company-set-overpayment company result)))))
-		  
-;; determine date function to use 
-(define (get-selected-date-from-txn transaction date-type)
-  (if (eq? date-type 'postdate)
-      (gnc-transaction-get-date-posted transaction)
-      (xaccTransRetDateDueTS transaction)))		    
-  
-;; deal with a transaction - figure out if we've seen the company before
-;; if so, either process it as a bill or a payment, if not, create
-;; a new company record in the hash
-
-(define (update-company-hash hash split bucket-intervals
-			     reverse? show-zeros date-type)
-
-  (define (do-update value)
-    (let* ((transaction (xaccSplitGetParent split))
-	   (temp-owner (gncOwnerNew))
-	   (owner (gnc:owner-from-split split temp-owner)))
-
-      (if (not (null? owner))
-       (let* ((guid (gncOwnerReturnGUID owner))
-	      (this-currency (xaccTransGetCurrency transaction))
-	      (this-date (get-selected-date-from-txn transaction date-type))
-	      (company-info (hash-ref hash guid)))
-
-	 (gnc:debug "update-company-hash called")
-	 (gnc:debug "owner: " owner ", guid: " guid)
-	 (gnc:debug "split-value: " value)
-	 (if reverse? (set! value (gnc-numeric-neg value)))
-	 (if company-info
-	     ;; if it's an existing company, destroy the temp owner and
-	     ;; then make sure the currencies match
-	     (begin
-	       (if (not (gnc-commodity-equiv
-			 this-currency
-			 (company-get-currency company-info)))
-		   (let ((error-str
-			  (string-append "IGNORING TRANSACTION!\n" "Invoice Owner: " (gncOwnerGetName owner)
-					 "\nTransaction GUID:" (gncTransGetGuid transaction)
-					 "\nTransaction Currency" (gnc-commodity-get-mnemonic this-currency)
-					 "\nClient Currency" (gnc-ommodity-get-mnemonic(company-get-currency company-info)))))
-		     (gnc-error-dialog '() error-str)
-		     (gnc:error error-str)
-		     (cons #f (sprintf
-			       (_ "Transactions relating to '%s' contain \
-more than one currency. This report is not designed to cope with this possibility.")  (gncOwnerGetName owner))))
-		   (begin
-		     (gnc:debug "it's an old company")
-		     (if (gnc-numeric-negative-p value)
-			 (process-invoice company-info (gnc-numeric-neg value) bucket-intervals this-date)
-			 (process-payment company-info value))
-		     (hash-set! hash guid company-info)
-		     (cons #t guid)))
-	       (gncOwnerFree temp-owner))
-		 
-	     ;; if it's a new company
-	     (begin
-	       (gnc:debug "value" value)
-	       (let ((new-company (make-company this-currency owner)))
-		 (if (gnc-numeric-negative-p value)
-		     (process-invoice new-company (gnc-numeric-neg value) bucket-intervals this-date)
-		     (process-payment new-company value))
-		 (hash-set! hash guid new-company))
-	       (cons #t guid))))
-       ; else (no owner)
-       (gncOwnerFree temp-owner))))
-  
-  ;; figure out if this split is part of a closed lot
-  ;; also save the split value...
-  (let* ((lot (xaccSplitGetLot split))
-	 (value (xaccSplitGetValue split))
-	 (is-paid? (if (null? lot) #f (gnc-lot-is-closed lot))))
-
-    ;; if it's closed, then ignore it because it doesn't matter.
-    ;; XXX: we _could_ just set the value to 0 in order to list
-    ;;      the company.  I'm not sure what to do.  Perhaps add an
-    ;;      option?
-    (if (or (not is-paid?) show-zeros)
-	(do-update value))))
+;; read the buckets of every owner of the account from the engine's
+;; aging pass, with the amounts owed positive.  Returns a list of
+;; (guid . company) pairs.
+
+(define (get-companies account report-date reverse? show-zeros date-type)
+  (let* ((aging (gncOwnerAgingNew account
+				  (gnc:timepair->secs report-date)
+				  (not (eq? date-type 'postdate))))
+	 (currency (xaccAccountGetCommodity account))
+	 (company-list '()))
+    (for-each
+     (lambda (owner)
+       (let* ((company (make-company currency owner))
+	      (buckets (company-get-buckets company)))
+	 (do ((i 0 (+ i 1)))
+	     ((= i num-buckets))
+	   (let ((bucket (gncOwnerAgingGetBucket aging owner i)))
+	     (vector-set! buckets i (if reverse?
+					bucket
+					(gnc-numeric-neg bucket)))))
+	 (if (or show-zeros
+		 (not (gnc-numeric-zero-p (buckets-get-total buckets))))
+	     (set! company-list
+		   (cons (cons (gncOwnerReturnGUID owner) company)
+			 company-list))
+	     (gncOwnerFree owner))))
+     (gncOwnerAgingGetOwners aging))
+    (gncOwnerAgingDestroy aging)
+    company-list))
 
 ;; get the total debt from the buckets
 (define (buckets-get-total buckets)
@@ -299,25 +164,6 @@ more than one currency. This report is not designed to cope with this possibilit
 	     (gnc:safe-strcmp (car litem-a) (car litem-b))
 	     difference)))
   
-    
-;; set up the query to get the splits in the chosen account
-;; XXX: FIXME: begindate is a hack -- we currently only go back a year
-(define (setup-query query account date)
-  (define (date-copy date)
-    (cons (car date) (cdr date)))
-  (let ((begindate (make-zdate))) ;Set begindate to the start of the Epoch
-;    (gnc:debug "Account: " account)
-    (gnc:debug "begindate" begindate)
-    (gnc:debug "date" date)
-    (qof-query-set-book query (gnc-get-current-book))
-    (gnc:query-set-match-non-voids-only! query (gnc-get-current-book))
-    (xaccQueryAddSingleAccountMatch query account QOF-QUERY-AND)
-    (xaccQueryAddDateMatchTS query #t begindate #t date QOF-QUERY-AND)
-    (qof-query-set-sort-order query
-			      (list SPLIT-TRANS TRANS-DATE-POSTED)
-			      '() '())
-    (qof-query-set-sort-increasing query #t #t #t)))
-     
 
 (define (aging-options-generator options)
   (let* ((add-option 
@@ -396,19 +242,6 @@ totals to report currency.")
     (gnc:options-set-default-section options "General")      
     options))
 
-(define (make-interval-list to-date)
-  (let ((begindate to-date))
-    (set! begindate (decdate begindate ThirtyDayDelta))
-    (set! begindate (decdate begindate ThirtyDayDelta))
-    (set! begindate (decdate begindate ThirtyDayDelta))
-    (gnc:make-date-list begindate to-date ThirtyDayDelta)))
-
-;; Have make-list create a stepped list, then add a date in the future for the "current" bucket
-(define (make-extended-interval-list to-date)
-    (define dayforcurrent (incdate to-date YearDelta)) ;; MAGIC CONSTANT
-    (define oldintervalreversed (reverse (make-interval-list to-date)))		
-  (reverse (cons dayforcurrent oldintervalreversed)))
-
 (define (aging-renderer report-obj reportname account reverse?)
 
   (define (get-name a)
@@ -499,8 +332,8 @@ totals to report currency.")
 	 column-totals)))
 
   ;; convert the buckets in the header data structure 
-  (define (convert-to-monetary-list bucket-list currency overpayment)
-    (let* ((running-total (gnc-numeric-neg overpayment))
+  (define (convert-to-monetary-list bucket-list currency)
+    (let* ((running-total (gnc-numeric-zero))
 	   (monetised-buckets
 	   (map (lambda (bucket-list-entry)
 		  (begin
@@ -543,13 +376,11 @@ totals to report currency.")
 
 
   (gnc:report-starting reportname)
-  (let* ((companys (make-hash-table 23))
-	 (report-title (op-value gnc:pagename-general gnc:optname-reportname))
+  (let* ((report-title (op-value gnc:pagename-general gnc:optname-reportname))
         ;; document will be the HTML document that we return.
 	(report-date (gnc:timepair-end-day-time 
 		      (gnc:date-option-absolute-time
 		       (op-value gnc:pagename-general optname-to-date))))
-	(interval-vec (list->vector (make-extended-interval-list report-date)))
 	(sort-pred (get-sort-pred 
 		    (op-value gnc:pagename-general optname-sort-by)
 		    (op-value gnc:pagename-general optname-sort-order)))
@@ -562,7 +393,6 @@ totals to report currency.")
 	(exchange-fn (gnc:case-exchange-fn price-source report-currency report-date))
 	(total-collector-list (make-collector-list))
 	(table (gnc:make-html-table))
-	(query (qof-query-create-for-splits))
 	(company-list '())
 	(work-done 0)
 	(work-to-do 0)
@@ -589,92 +419,69 @@ totals to report currency.")
 				     
     (if (not (null? account))
 	(begin
-	  (setup-query query account report-date)
-	  ;; get the appropriate splits
-	  (let ((splits (qof-query-run query)))
-;	    (gnc:debug "splits" splits)
-
-	    ;; build the table
-	    (set! work-to-do (length splits))
-	    ;; work-done is already zero
-	    (for-each (lambda (split)
-			(gnc:report-percent-done (* 50 (/ work-done work-to-do)))
-			(set! work-done (+ 1 work-done))
-			(update-company-hash companys 
-					      split 
-					      interval-vec 
-					      reverse? show-zeros
-                                              date-type))
-			splits)
-;	    (gnc:debug "companys" companys)
-	    ;; turn the hash into a list
-	    (hash-for-each (lambda (key value)
-			     (set! company-list
-				   (cons (cons key value) company-list)))
-			   companys)
-;	    (gnc:debug "company list" company-list)
-	   
-	    (set! company-list (sort-list! company-list
-					    sort-pred))
-
-	    ;; build the table
-	    (set! work-to-do (length company-list))
-	    (set! work-done 0)
-	    (for-each (lambda (company-list-entry)
-			(gnc:report-percent-done (+ 50 (* 50 (/ work-done work-to-do))))
-			(set! work-done (+ 1 work-done))
-			(let* ((monetary-list (convert-to-monetary-list
-					       (company-get-buckets
-						(cdr company-list-entry))
-					       (company-get-currency
-						(cdr company-list-entry))
-					       (company-get-overpayment
-						(cdr company-list-entry))))
-			       (owner (company-get-owner-obj
-				       (cdr company-list-entry)))
-			       (company-name (gncOwnerGetName owner)))
-
-			  (add-to-column-totals total-collector-list
-						monetary-list)
-
-			  (let* ((ml (reverse monetary-list))
-				 (total (car ml))
-				 (rest (cdr ml)))
-
-			    (set! monetary-list
-				  (reverse
-				   (cons
-				    (gnc:make-html-text
-				     (gnc:html-markup-anchor
-				      (gnc:owner-report-text owner account)
-				      total))
-				    rest))))
-
-			  (gnc:html-table-append-row!
-			   table (cons
+	  ;; get the bucketed balances
+	  (set! company-list (get-companies account report-date reverse?
+					    show-zeros date-type))
+	  (gnc:report-percent-done 50)
+
+	  (set! company-list (sort-list! company-list
+					  sort-pred))
+
+	  ;; build the table
+	  (set! work-to-do (length company-list))
+	  (set! work-done 0)
+	  (for-each (lambda (company-list-entry)
+		      (gnc:report-percent-done (+ 50 (* 50 (/ work-done work-to-do))))
+		      (set! work-done (+ 1 work-done))
+		      (let* ((monetary-list (convert-to-monetary-list
+					     (company-get-buckets
+					      (cdr company-list-entry))
+					     (company-get-currency
+					      (cdr company-list-entry))))
+			     (owner (company-get-owner-obj
+				     (cdr company-list-entry)))
+			     (company-name (gncOwnerGetName owner)))
+
+			(add-to-column-totals total-collector-list
+					      monetary-list)
+
+			(let* ((ml (reverse monetary-list))
+			       (total (car ml))
+			       (rest (cdr ml)))
+
+			  (set! monetary-list
+				(reverse
+				 (cons
 				  (gnc:make-html-text
 				   (gnc:html-markup-anchor
-				    (gnc:owner-anchor-text owner)
-				    company-name))
-				  monetary-list))
-			  (gncOwnerFree owner)))
-		      company-list)
-
-	    ;; add the totals
-	    (gnc:html-table-append-row!
-	     table 
-	     (cons (_ "Total") (convert-collectors total-collector-list 
-						   report-currency
-						   exchange-fn
-						   multi-totals-p)))
-	     
-	    (gnc:html-document-add-object!
-	     document table)))
+				    (gnc:owner-report-text owner account)
+				    total))
+				  rest))))
+
+			(gnc:html-table-append-row!
+			 table (cons
+				(gnc:make-html-text
+				 (gnc:html-markup-anchor
+				  (gnc:owner-anchor-text owner)
+				  company-name))
+				monetary-list))
+			(gncOwnerFree owner)))
+		    company-list)
+
+	  ;; add the totals
+	  (gnc:html-table-append-row!
+	   table 
+	   (cons (_ "Total") (convert-collectors total-collector-list 
+						 report-currency
+						 exchange-fn
+						 multi-totals-p)))
+
+	  (gnc:html-document-add-object!
+	   document table))
 	(gnc:html-document-add-object!
 	 document
 	 (gnc:make-html-text
 	  (_ "No valid account selected. Click on the Options button and select the account to use."))))
-    (qof-query-destroy query)
     (gnc:report-finished)
     document))
 
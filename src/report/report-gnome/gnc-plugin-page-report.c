@@ -125,6 +125,9 @@ typedef struct GncPluginPageReportPrivate
     /* The page is in the process of reloading the html */
     gboolean	reloading;
 
+    /* The idle source that will run the pending reload, or 0 */
+    guint	reload_idle_id;
+
     /// the gnc_html abstraction this PluginPage contains
 //        gnc_html *html;
     GncHtml *html;
@@ -158,6 +161,7 @@ static void gnc_plugin_page_report_load_cb(GncHtml * html, URLType type,
         const gchar * location, const gchar * label,
         gpointer data);
 static void gnc_plugin_page_report_expose_event_cb(GtkWidget *unused, GdkEventExpose *unused1, gpointer data);
+static void gnc_plugin_page_report_queue_reload(GncPluginPageReport *page);
 static void gnc_plugin_page_report_refresh (gpointer data);
 static void gnc_plugin_page_report_set_fwd_button(GncPluginPageReport * page, int enabled);
 static void gnc_plugin_page_report_set_back_button(GncPluginPageReport * page, int enabled);
@@ -616,12 +620,9 @@ gnc_plugin_page_report_option_change_cb(gpointer data)
     /* it's probably already dirty, but make sure */
     scm_call_2(dirty_report, priv->cur_report, SCM_BOOL_T);
 
-    /* Now queue the fact that we need to reload this report */
-    priv->need_reload = TRUE;
-    // jsled: this doesn't seem to cause any effect.
-    gtk_widget_queue_draw( GTK_WIDGET(priv->container) );
-    // jsled: this does.
-    gnc_html_reload( priv->html );
+    /* Now queue the fact that we need to reload this report.  Several
+     * options applied at once collapse into a single run. */
+    gnc_plugin_page_report_queue_reload(report);
 }
 
 /* FIXME: This function does... nothing.  */
@@ -653,6 +654,51 @@ gnc_plugin_page_report_history_destroy_cb(gnc_html_history_node * node,
 #endif
 }
 
+/* Run the pending reload of the report.  This is done from an idle
+ * handler rather than from the code that asked for it, so that the
+ * page (and the option dialog that caused the reload) get painted
+ * before the report runs, and so that any number of requests made in
+ * the meantime result in a single run. */
+static gboolean
+gnc_plugin_page_report_reload_idle_cb(gpointer data)
+{
+    GncPluginPageReport *page = data;
+    GncPluginPageReportPrivate *priv;
+
+    priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(page);
+    ENTER( "page %p", page );
+    priv->reload_idle_id = 0;
+    if (!priv->need_reload || !priv->html)
+    {
+        LEAVE( "no reload needed" );
+        return FALSE;
+    }
+
+    priv->need_reload = FALSE;
+    priv->reloading = TRUE;
+    gnc_window_set_progressbar_window( GNC_WINDOW(GNC_PLUGIN_PAGE(page)->window) );
+    gnc_html_reload(priv->html);
+    gnc_window_set_progressbar_window( NULL );
+    priv->reloading = FALSE;
+    LEAVE( "reload done" );
+    return FALSE;
+}
+
+/* Mark the report as needing a reload and schedule it, unless a reload
+ * is already pending. */
+static void
+gnc_plugin_page_report_queue_reload(GncPluginPageReport *page)
+{
+    GncPluginPageReportPrivate *priv;
+
+    priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(page);
+    priv->need_reload = TRUE;
+    if (priv->reload_idle_id == 0)
+        priv->reload_idle_id = g_idle_add(gnc_plugin_page_report_reload_idle_cb,
+                                          page);
+    gtk_widget_queue_draw( GTK_WIDGET(priv->container) );
+}
+
 /* We got a draw event.  See if we need to reload the report */
 static void
 gnc_plugin_page_report_expose_event_cb(GtkWidget *unused, GdkEventExpose *unused1, gpointer data)
@@ -664,17 +710,16 @@ gnc_plugin_page_report_expose_event_cb(GtkWidget *unused, GdkEventExpose *unused
 
     priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(page);
     ENTER( "report_draw" );
-    if (!priv->need_reload)
+    if (!priv->need_reload || priv->reload_idle_id)
     {
         LEAVE( "no reload needed" );
         return;
     }
 
-    priv->need_reload = FALSE;
-    gnc_window_set_progressbar_window( GNC_WINDOW(GNC_PLUGIN_PAGE(page)->window) );
-    gnc_html_reload(priv->html);
-    gnc_window_set_progressbar_window( NULL );
-    LEAVE( "reload forced" );
+    /* Let this expose finish painting before the report runs. */
+    priv->reload_idle_id = g_idle_add(gnc_plugin_page_report_reload_idle_cb,
+                                      page);
+    LEAVE( "reload queued" );
 }
 
 // @param data is actually GncPluginPageReportPrivate
@@ -697,6 +742,12 @@ gnc_plugin_page_report_destroy_widget(GncPluginPage *plugin_page)
     PINFO("destroy widget");
     priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(plugin_page);
 
+    if (priv->reload_idle_id)
+    {
+        g_source_remove(priv->reload_idle_id);
+        priv->reload_idle_id = 0;
+    }
+
     if (priv->component_manager_id)
     {
         gnc_unregister_gui_component(priv->component_manager_id);
@@ -1290,7 +1341,7 @@ static void
 gnc_plugin_page_report_reload_cb( GtkAction *action, GncPluginPageReport *report )
 {
     GncPluginPageReportPrivate *priv;
-    SCM dirty_report;
+    SCM dirty_report, get_id;
 
     DEBUG( "reload" );
     priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(report);
@@ -1301,16 +1352,13 @@ gnc_plugin_page_report_reload_cb( GtkAction *action, GncPluginPageReport *report
     dirty_report = scm_c_eval_string("gnc:report-set-dirty?!");
     scm_call_2(dirty_report, priv->cur_report, SCM_BOOL_T);
 
-    priv->need_reload = TRUE;
-    /* now queue the fact that we need to reload this report */
+    /* An explicit reload also picks up changes that the render cache
+     * can't see, e.g. made by another user of a database backend. */
+    get_id = scm_c_eval_string("gnc:report-id");
+    gnc_report_invalidate_render_cache(scm_to_int(scm_call_1(get_id, priv->cur_report)));
 
-    // this doens't seem to do anything...
-    gtk_widget_queue_draw( GTK_WIDGET(priv->container) );
-
-    // this does...
-    priv->reloading = TRUE;
-    gnc_html_reload( priv->html );
-    priv->reloading = FALSE;
+    /* now queue the fact that we need to reload this report */
+    gnc_plugin_page_report_queue_reload(report);
 }
 
 static void
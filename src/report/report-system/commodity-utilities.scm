@@ -921,6 +921,50 @@
 
 
 
+;; The same as gnc:make-exchange-function of the alist that
+;; gnc:make-exchange-cost-alist or gnc:make-exchange-alist would
+;; return, but with the rates from the book's exchange table (see
+;; gnc-exchange-table.h), which is computed once per state of the book
+;; rather than per report run. 'rate-fn' is
+;; gnc-exchange-table-get-average-cost or
+;; gnc-exchange-table-get-weighted-average.
+(define (gnc:make-exchange-table-function
+	 rate-fn report-commodity end-date)
+  (let ((book (gnc-get-current-book)))
+    (lambda (foreign domestic)
+      (if foreign
+          (or (gnc:exchange-by-euro foreign domestic #f)
+              (gnc:exchange-if-same foreign domestic)
+              (let ((foreign-amount (gnc:gnc-monetary-amount foreign)))
+                (gnc:make-gnc-monetary
+                 domestic
+                 (if (gnc-numeric-zero-p foreign-amount)
+                     (gnc-numeric-zero)
+                     (gnc-numeric-mul foreign-amount
+                                      (rate-fn book report-commodity end-date
+                                               (gnc:gnc-monetary-commodity
+                                                foreign))
+                                      (gnc-commodity-get-fraction domestic)
+                                      GNC-RND-ROUND)))))
+          #f))))
+
+;; Exchange by the weighted average rate nearest to 'date', like
+;; gnc:exchange-by-pricealist-nearest with the pricealist of
+;; gnc:get-commoditylist-totalavg-prices, but from the book's exchange
+;; table for 'report-commodity' and 'end-date'.
+(define (gnc:exchange-by-exchange-table-nearest
+	 report-commodity end-date foreign domestic date)
+  (if (and (record? foreign) (gnc:gnc-monetary? foreign)
+	   date)
+      (or (gnc:exchange-by-euro foreign domestic date)
+	  (gnc:exchange-if-same foreign domestic)
+	  (gnc:exchange-by-pricevalue-helper
+	   foreign domestic
+	   (gnc-exchange-table-get-weighted-average-nearest
+	    (gnc-get-current-book) report-commodity end-date
+	    (gnc:gnc-monetary-commodity foreign) date)))
+      #f))
+
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; Choosing exchange functions made easy -- get the right function by
 ;; the value of a multichoice option.
@@ -932,12 +976,12 @@
 (define (gnc:case-exchange-fn 
 	 source-option report-currency to-date-tp)
   (case source-option
-    ((average-cost) (gnc:make-exchange-function 
-                     (gnc:make-exchange-cost-alist
-                      report-currency to-date-tp)))
-    ((weighted-average) (gnc:make-exchange-function 
-			(gnc:make-exchange-alist 
-			 report-currency to-date-tp)))
+    ((average-cost) (gnc:make-exchange-table-function
+                     gnc-exchange-table-get-average-cost
+                     report-currency to-date-tp))
+    ((weighted-average) (gnc:make-exchange-table-function
+			gnc-exchange-table-get-weighted-average
+			report-currency to-date-tp))
     ((pricedb-latest) gnc:exchange-by-pricedb-latest)
     ((pricedb-nearest) (lambda (foreign domestic)
 			(gnc:exchange-by-pricedb-nearest
@@ -961,25 +1005,22 @@
 ;; gnc:options-add-price-source!.
 ;;
 ;; <int> start-percent, delta-percent: Fill in the [start:start+delta]
-;; section of the progress bar while running this function.
+;; section of the progress bar while running this function. None of
+;; the price sources takes long enough to need it any more.
 ;;
 (define (gnc:case-exchange-time-fn 
 	 source-option report-currency commodity-list to-date-tp
 	 start-percent delta-percent)
   (case source-option
     ;; Make this the same as gnc:case-exchange-fn
-    ((average-cost) (let* ((exchange-fn (gnc:make-exchange-function
-                                         (gnc:make-exchange-cost-alist
-                                          report-currency to-date-tp)))) 
+    ((average-cost) (let* ((exchange-fn (gnc:make-exchange-table-function
+                                         gnc-exchange-table-get-average-cost
+                                         report-currency to-date-tp)))
                       (lambda (foreign domestic date)
                        (exchange-fn foreign domestic))))
-    ((weighted-average) (let ((pricealist
-			      (gnc:get-commoditylist-totalavg-prices
-			       commodity-list report-currency to-date-tp
-			       start-percent delta-percent)))
-			 (lambda (foreign domestic date)
-			   (gnc:exchange-by-pricealist-nearest
-			    pricealist foreign domestic date))))
+    ((weighted-average) (lambda (foreign domestic date)
+			 (gnc:exchange-by-exchange-table-nearest
+			  report-currency to-date-tp foreign domestic date)))
     ((actual-transactions) (let ((pricealist
 				 (gnc:get-commoditylist-inst-prices
 				  commodity-list report-currency to-date-tp)))
@@ -1070,13 +1111,7 @@
 ;; (If this were implemented as a record, I would be able to
 ;; just (length ...) the alist, but....)
 (define (gnc-commodity-collector-commodity-count collector)
-    (let ((commodities 0))
-	(gnc-commodity-collector-map
-	    collector
-		(lambda (comm amt)
-		  (set! commodities (+ commodities 1))))
-	commodities
-    ))
+  (gnc-commodity-collector-get-n-commodities (collector 'pointer #f #f)))
 
 (define (gnc:uniform-commodity? amt report-commodity)
   ;; function to see if the commodity-collector amt
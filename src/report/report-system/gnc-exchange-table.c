@@ -0,0 +1,644 @@
+/********************************************************************
+ * gnc-exchange-table.c -- exchange rates from transactions for     *
+ *                         reports.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-engine.h"
+#include "gnc-euro.h"
+#include "gnc-exchange-table.h"
+
+static QofLogModule log_module = GNC_MOD_GUI;
+
+/* How many (book, report commodity, end date) tables to keep.  A
+ * report normally asks for one; a few more cover switching between
+ * reports with different settings. */
+#define EXCHANGE_TABLE_CACHE_SIZE 4
+
+#define EXCHANGE_RATE_HOW (GNC_HOW_DENOM_SIGFIGS(8) | GNC_HOW_RND_ROUND)
+
+/* Running totals of an exchange between two commodities. */
+typedef struct
+{
+    gnc_numeric foreign;  /* in the commodity being priced */
+    gnc_numeric domestic; /* in the commodity it is priced in */
+    guint seq;            /* creation order within a sum list */
+} ExchangeTotals;
+
+/* One rate of a weighted average series, valid from its date. */
+typedef struct
+{
+    Timespec date;
+    gnc_numeric rate;
+} ExchangePoint;
+
+typedef struct
+{
+    ExchangeTotals totals;
+    GArray *points;       /* of ExchangePoint, sorted by date */
+} ExchangeSeries;
+
+typedef struct
+{
+    QofBook *book;
+    const gnc_commodity *report_commodity;
+    Timespec end_date;
+    guint64 generation;
+
+    GHashTable *average_costs;     /* gnc_commodity* -> gnc_numeric* */
+    GHashTable *weighted_averages; /* gnc_commodity* -> gnc_numeric* */
+    GHashTable *series;            /* gnc_commodity* -> ExchangeSeries* */
+} ExchangeTable;
+
+/* Most recently used first. */
+static GList *exchange_tables = NULL;
+
+static gnc_numeric
+numeric_add (gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_add (a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+}
+
+static ExchangeTotals *
+exchange_totals_new (gnc_numeric foreign, gnc_numeric domestic)
+{
+    ExchangeTotals *totals = g_new (ExchangeTotals, 1);
+
+    totals->foreign = foreign;
+    totals->domestic = domestic;
+    totals->seq = 0;
+    return totals;
+}
+
+static void
+exchange_series_free (ExchangeSeries *series)
+{
+    g_array_free (series->points, TRUE);
+    g_free (series);
+}
+
+/* Sum lists
+ *
+ * The exchanged amounts are summed per pair of commodities, the same
+ * way gnc:get-exchange-totals always did: the outer table is keyed by
+ * the commodity a pair was first seen under (the report commodity, or
+ * else the transaction currency or the account commodity of its first
+ * split), the inner tables by the other commodity of the pair.  The
+ * pairs under the report commodity are rates as they stand; the others
+ * are then resolved through them as gnc:resolve-unknown-comm did.
+ * Since a pair may be resolvable through more than one other, the
+ * order of the old association lists is kept too: the lists most
+ * recently given a pair, and their newest pairs, come first.
+ */
+
+typedef struct
+{
+    GHashTable *lists; /* gnc_commodity* -> GHashTable* of
+                        * gnc_commodity* -> ExchangeTotals* */
+    GList *order;      /* of the keys of lists */
+    guint pairs;
+} SumList;
+
+static GHashTable *
+sumlist_inner_new (void)
+{
+    return g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+}
+
+static SumList *
+sumlist_new (const gnc_commodity *report_commodity)
+{
+    SumList *sumlist = g_new0 (SumList, 1);
+
+    sumlist->lists = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL,
+                                            (GDestroyNotify) g_hash_table_destroy);
+    g_hash_table_insert (sumlist->lists, (gpointer) report_commodity,
+                         sumlist_inner_new ());
+    sumlist->order = g_list_prepend (NULL, (gpointer) report_commodity);
+    return sumlist;
+}
+
+static void
+sumlist_free (SumList *sumlist)
+{
+    g_hash_table_destroy (sumlist->lists);
+    g_list_free (sumlist->order);
+    g_free (sumlist);
+}
+
+/* The totals of the pair of key and commodity in the inner table of
+ * key, created if need be.  A list given a new pair moves to the
+ * front. */
+static ExchangeTotals *
+sumlist_get_pair (SumList *sumlist, GHashTable *inner,
+                  const gnc_commodity *key, const gnc_commodity *commodity)
+{
+    ExchangeTotals *totals = g_hash_table_lookup (inner, commodity);
+
+    if (!totals)
+    {
+        totals = exchange_totals_new (gnc_numeric_zero (), gnc_numeric_zero ());
+        totals->seq = sumlist->pairs++;
+        g_hash_table_insert (inner, (gpointer) commodity, totals);
+        sumlist->order = g_list_remove (sumlist->order, key);
+        sumlist->order = g_list_prepend (sumlist->order, (gpointer) key);
+    }
+    return totals;
+}
+
+static void
+sumlist_add (SumList *sumlist, gnc_commodity *trans_comm,
+             gnc_commodity *acct_comm, gnc_numeric share_amount,
+             gnc_numeric value_amount, gboolean negate_by_currency)
+{
+    GHashTable *inner;
+    ExchangeTotals *totals;
+
+    if ((inner = g_hash_table_lookup (sumlist->lists, trans_comm)))
+    {
+        totals = sumlist_get_pair (sumlist, inner, trans_comm, acct_comm);
+        totals->foreign = numeric_add (totals->foreign, share_amount);
+        totals->domestic = numeric_add (totals->domestic, value_amount);
+        return;
+    }
+
+    if ((inner = g_hash_table_lookup (sumlist->lists, acct_comm)))
+    {
+        if (negate_by_currency)
+        {
+            value_amount = gnc_numeric_neg (value_amount);
+            share_amount = gnc_numeric_neg (share_amount);
+        }
+    }
+    else
+    {
+        inner = sumlist_inner_new ();
+        g_hash_table_insert (sumlist->lists, acct_comm, inner);
+    }
+    totals = sumlist_get_pair (sumlist, inner, acct_comm, trans_comm);
+    totals->foreign = numeric_add (totals->foreign, value_amount);
+    totals->domestic = numeric_add (totals->domestic, share_amount);
+}
+
+/* Newest pair first. */
+static gint
+sumlist_pair_order (gconstpointer a, gconstpointer b, gpointer inner)
+{
+    const ExchangeTotals *totals_a = g_hash_table_lookup (inner, a);
+    const ExchangeTotals *totals_b = g_hash_table_lookup (inner, b);
+
+    if (totals_a->seq == totals_b->seq)
+        return 0;
+    return totals_a->seq > totals_b->seq ? -1 : 1;
+}
+
+/* The totals of exchanging unknown for un_to_known of a commodity
+ * whose exchange with the report commodity is known. */
+static ExchangeTotals *
+sumlist_make_newrate (gnc_numeric unknown, gnc_numeric un_to_known,
+                      const ExchangeTotals *known)
+{
+    gnc_numeric domestic;
+
+    domestic = gnc_numeric_mul (un_to_known, known->domestic, GNC_DENOM_AUTO,
+                                GNC_HOW_DENOM_SIGFIGS(9) | GNC_HOW_RND_ROUND);
+    domestic = gnc_numeric_div (domestic, known->foreign, GNC_DENOM_AUTO,
+                                EXCHANGE_RATE_HOW);
+    return exchange_totals_new (unknown, domestic);
+}
+
+/* Add the pairs not involving the report commodity to those under it,
+ * wherever one of their commodities already is, or is a euro currency
+ * like the report commodity.  Later pairs see the ones added before
+ * them. */
+static void
+sumlist_resolve_unknown (SumList *sumlist,
+                         const gnc_commodity *report_commodity)
+{
+    GHashTable *reportlist = g_hash_table_lookup (sumlist->lists,
+                             report_commodity);
+    GList *onode;
+
+    for (onode = sumlist->order; onode; onode = onode->next)
+    {
+        gnc_commodity *other = onode->data;
+        GHashTable *inner;
+        GList *pairs, *pnode;
+
+        if (gnc_commodity_equiv (other, report_commodity))
+            continue;
+
+        inner = g_hash_table_lookup (sumlist->lists, other);
+        pairs = g_list_sort_with_data (g_hash_table_get_keys (inner),
+                                       sumlist_pair_order, inner);
+        for (pnode = pairs; pnode; pnode = pnode->next)
+        {
+            gnc_commodity *commodity = pnode->data;
+            const ExchangeTotals *pair = g_hash_table_lookup (inner, commodity);
+            const ExchangeTotals *pair_a, *pair_b;
+            ExchangeTotals euro;
+
+            /* The report commodity on the wrong side of the pair. */
+            if (gnc_commodity_equiv (commodity, report_commodity))
+            {
+                g_hash_table_insert (reportlist, other,
+                                     exchange_totals_new (pair->domestic,
+                                             pair->foreign));
+                continue;
+            }
+
+            pair_a = g_hash_table_lookup (reportlist, other);
+            if (!pair_a && gnc_is_euro_currency (other) &&
+                gnc_is_euro_currency (report_commodity))
+            {
+                euro.foreign = pair->domestic;
+                euro.domestic = gnc_convert_from_euro (report_commodity,
+                                                       gnc_convert_to_euro (other,
+                                                               pair->domestic));
+                pair_a = &euro;
+            }
+            pair_b = g_hash_table_lookup (reportlist, commodity);
+
+            if (!pair_a && !pair_b)
+                PWARN ("can't calculate rate for %s = %s to %s",
+                       gnc_commodity_get_mnemonic (commodity),
+                       gnc_commodity_get_mnemonic (other),
+                       gnc_commodity_get_mnemonic (report_commodity));
+            else if (pair_a && pair_b)
+                PWARN ("exchange rate ambiguity: %s = %s",
+                       gnc_commodity_get_mnemonic (commodity),
+                       gnc_commodity_get_mnemonic (other));
+            else if (!pair_a)
+                g_hash_table_insert (reportlist, other,
+                                     sumlist_make_newrate (pair->domestic,
+                                             pair->foreign, pair_b));
+            else
+                g_hash_table_insert (reportlist, commodity,
+                                     sumlist_make_newrate (pair->foreign,
+                                             pair->domestic, pair_a));
+        }
+        g_list_free (pairs);
+    }
+}
+
+/* Turn the pairs under the report commodity, once resolved, into a
+ * table of rates. */
+static GHashTable *
+sumlist_get_rates (SumList *sumlist, const gnc_commodity *report_commodity)
+{
+    GHashTable *rates = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                        NULL, g_free);
+    GHashTable *inner;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    sumlist_resolve_unknown (sumlist, report_commodity);
+
+    inner = g_hash_table_lookup (sumlist->lists, report_commodity);
+    g_hash_table_iter_init (&iter, inner);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        ExchangeTotals *totals = value;
+        gnc_numeric *rate = g_new (gnc_numeric, 1);
+
+        *rate = gnc_numeric_abs (gnc_numeric_div (totals->domestic,
+                                 totals->foreign,
+                                 GNC_DENOM_AUTO,
+                                 EXCHANGE_RATE_HOW));
+        g_hash_table_insert (rates, key, rate);
+    }
+    return rates;
+}
+
+/* Weighted average series */
+
+/* Extend the series of the commodity by an exchange of foreign_amount
+ * of it for other_amount of the other commodity.  Only exchanges with
+ * the report commodity count, after converting between euro
+ * currencies. */
+static void
+exchange_table_add_series_point (ExchangeTable *table,
+                                 gnc_commodity *commodity,
+                                 gnc_numeric foreign_amount,
+                                 const gnc_commodity *other,
+                                 gnc_numeric other_amount,
+                                 Timespec date)
+{
+    ExchangeSeries *series;
+    ExchangePoint point;
+
+    if (!gnc_commodity_equiv (other, table->report_commodity))
+    {
+        if (!gnc_is_euro_currency (table->report_commodity) ||
+            !gnc_is_euro_currency (other))
+            return;
+        other_amount = gnc_convert_from_euro (table->report_commodity,
+                                              gnc_convert_to_euro (other,
+                                                      other_amount));
+    }
+
+    series = g_hash_table_lookup (table->series, commodity);
+    if (!series)
+    {
+        series = g_new (ExchangeSeries, 1);
+        series->totals.foreign = gnc_numeric_zero ();
+        series->totals.domestic = gnc_numeric_zero ();
+        series->points = g_array_new (FALSE, FALSE, sizeof (ExchangePoint));
+        g_hash_table_insert (table->series, commodity, series);
+    }
+
+    series->totals.foreign = numeric_add (series->totals.foreign,
+                                          foreign_amount);
+    series->totals.domestic = numeric_add (series->totals.domestic,
+                                           other_amount);
+
+    point.date = date;
+    point.rate = gnc_numeric_div (series->totals.domestic,
+                                  series->totals.foreign,
+                                  GNC_DENOM_AUTO, EXCHANGE_RATE_HOW);
+    if (gnc_numeric_check (point.rate) == GNC_ERROR_OK &&
+        !gnc_numeric_zero_p (point.rate))
+        g_array_append_val (series->points, point);
+}
+
+/* The rate of the point nearest to the date, preferring the later one
+ * when two are as near. */
+static gnc_numeric
+exchange_series_get_nearest (const ExchangeSeries *series, Timespec date)
+{
+    const GArray *points = series->points;
+    const ExchangePoint *earlier, *later;
+    Timespec earlier_delta, later_delta;
+    guint lo = 0, hi = points->len;
+
+    if (points->len == 0)
+        return gnc_numeric_zero ();
+
+    /* Find the first point after the date. */
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (timespec_cmp (&g_array_index (points, ExchangePoint, mid).date,
+                          &date) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return g_array_index (points, ExchangePoint, 0).rate;
+    if (lo == points->len)
+        return g_array_index (points, ExchangePoint, lo - 1).rate;
+
+    earlier = &g_array_index (points, ExchangePoint, lo - 1);
+    later = &g_array_index (points, ExchangePoint, lo);
+    earlier_delta = timespec_diff (&date, &earlier->date);
+    later_delta = timespec_diff (&later->date, &date);
+    return timespec_cmp (&earlier_delta, &later_delta) < 0 ?
+           earlier->rate : later->rate;
+}
+
+/* Building and caching tables */
+
+static gint
+split_order (gconstpointer a, gconstpointer b)
+{
+    return xaccSplitOrder (a, b);
+}
+
+/* The non-void splits of the book's accounts posted up to the end
+ * date that involve two different commodities, in query order. */
+static GList *
+exchange_table_get_splits (const ExchangeTable *table)
+{
+    Account *root = gnc_book_get_root_account (table->book);
+    GList *accounts, *node, *splits = NULL;
+
+    accounts = gnc_account_get_descendants (root);
+    for (node = accounts; node; node = node->next)
+    {
+        Account *account = node->data;
+        gnc_commodity *acct_comm = xaccAccountGetCommodity (account);
+        SplitList *snode;
+
+        for (snode = xaccAccountGetSplitList (account); snode;
+             snode = snode->next)
+        {
+            Split *split = snode->data;
+            Transaction *trans = xaccSplitGetParent (split);
+            Timespec posted;
+
+            xaccTransGetDatePostedTS (trans, &posted);
+            if (timespec_cmp (&posted, &table->end_date) > 0)
+                break;
+            if (xaccSplitGetReconcile (split) == VREC ||
+                gnc_commodity_equiv (xaccTransGetCurrency (trans), acct_comm))
+                continue;
+            splits = g_list_prepend (splits, split);
+        }
+    }
+    g_list_free (accounts);
+
+    return g_list_sort (splits, split_order);
+}
+
+static void
+exchange_table_build (ExchangeTable *table)
+{
+    SumList *weighted_sums = sumlist_new (table->report_commodity);
+    SumList *cost_sums = sumlist_new (table->report_commodity);
+    GList *splits, *node;
+
+    splits = exchange_table_get_splits (table);
+    for (node = splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        Account *account = xaccSplitGetAccount (split);
+        gnc_commodity *trans_comm = xaccTransGetCurrency (trans);
+        gnc_commodity *acct_comm = xaccAccountGetCommodity (account);
+        gnc_numeric share_amount = xaccSplitGetAmount (split);
+        gnc_numeric value_amount = xaccSplitGetValue (split);
+        gnc_numeric abs_share = gnc_numeric_abs (share_amount);
+        gnc_numeric abs_value = gnc_numeric_abs (value_amount);
+        Timespec posted;
+
+        /* Without shares this is not a buy or sell. */
+        if (!gnc_numeric_zero_p (abs_share))
+            sumlist_add (weighted_sums, trans_comm, acct_comm,
+                         abs_share, abs_value, FALSE);
+
+        /* Trading splits counterbalance the others back to zero. */
+        if (xaccAccountGetType (account) != ACCT_TYPE_TRADING)
+            sumlist_add (cost_sums, trans_comm, acct_comm,
+                         share_amount, value_amount, TRUE);
+
+        xaccTransGetDatePostedTS (trans, &posted);
+        exchange_table_add_series_point (table, trans_comm, abs_value,
+                                         acct_comm, abs_share, posted);
+        exchange_table_add_series_point (table, acct_comm, abs_share,
+                                         trans_comm, abs_value, posted);
+    }
+
+    table->weighted_averages = sumlist_get_rates (weighted_sums,
+                               table->report_commodity);
+    table->average_costs = sumlist_get_rates (cost_sums,
+                           table->report_commodity);
+
+    DEBUG ("%u splits, %u weighted averages, %u average costs",
+           g_list_length (splits),
+           g_hash_table_size (table->weighted_averages),
+           g_hash_table_size (table->average_costs));
+
+    g_list_free (splits);
+    sumlist_free (weighted_sums);
+    sumlist_free (cost_sums);
+}
+
+static void
+exchange_table_free (ExchangeTable *table)
+{
+    g_hash_table_destroy (table->average_costs);
+    g_hash_table_destroy (table->weighted_averages);
+    g_hash_table_destroy (table->series);
+    g_free (table);
+}
+
+static ExchangeTable *
+exchange_table_new (QofBook *book, const gnc_commodity *report_commodity,
+                    Timespec end_date)
+{
+    ExchangeTable *table = g_new0 (ExchangeTable, 1);
+
+    table->book = book;
+    table->report_commodity = report_commodity;
+    table->end_date = end_date;
+    table->generation = qof_book_get_generation (book);
+    table->series = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                           NULL,
+                                           (GDestroyNotify) exchange_series_free);
+    exchange_table_build (table);
+    return table;
+}
+
+/* Return the table for the book, report commodity and end date,
+ * building it unless there is one for the book's present generation.
+ * Tables of books that are gone are never matched again, since the
+ * generation of any later book at the same address differs; they just
+ * age out of the cache. */
+static ExchangeTable *
+exchange_table_get (QofBook *book, const gnc_commodity *report_commodity,
+                    Timespec end_date)
+{
+    guint64 generation = qof_book_get_generation (book);
+    ExchangeTable *table;
+    GList *node;
+
+    for (node = exchange_tables; node; node = node->next)
+    {
+        table = node->data;
+        if (table->book != book ||
+            table->report_commodity != report_commodity ||
+            !timespec_equal (&table->end_date, &end_date))
+            continue;
+
+        exchange_tables = g_list_remove_link (exchange_tables, node);
+        if (table->generation == generation)
+        {
+            exchange_tables = g_list_concat (node, exchange_tables);
+            return table;
+        }
+        g_list_free_1 (node);
+        exchange_table_free (table);
+        break;
+    }
+
+    table = exchange_table_new (book, report_commodity, end_date);
+    exchange_tables = g_list_prepend (exchange_tables, table);
+
+    if (g_list_length (exchange_tables) > EXCHANGE_TABLE_CACHE_SIZE)
+    {
+        node = g_list_last (exchange_tables);
+        exchange_table_free (node->data);
+        exchange_tables = g_list_delete_link (exchange_tables, node);
+    }
+    return table;
+}
+
+static gnc_numeric
+exchange_rates_lookup (GHashTable *rates, const gnc_commodity *commodity)
+{
+    gnc_numeric *rate = g_hash_table_lookup (rates, commodity);
+    return rate ? *rate : gnc_numeric_zero ();
+}
+
+gnc_numeric
+gnc_exchange_table_get_average_cost (QofBook *book,
+                                     const gnc_commodity *report_commodity,
+                                     Timespec end_date,
+                                     const gnc_commodity *commodity)
+{
+    ExchangeTable *table;
+
+    g_return_val_if_fail (book && report_commodity, gnc_numeric_zero ());
+
+    table = exchange_table_get (book, report_commodity, end_date);
+    return exchange_rates_lookup (table->average_costs, commodity);
+}
+
+gnc_numeric
+gnc_exchange_table_get_weighted_average (QofBook *book,
+                                         const gnc_commodity *report_commodity,
+                                         Timespec end_date,
+                                         const gnc_commodity *commodity)
+{
+    ExchangeTable *table;
+
+    g_return_val_if_fail (book && report_commodity, gnc_numeric_zero ());
+
+    table = exchange_table_get (book, report_commodity, end_date);
+    return exchange_rates_lookup (table->weighted_averages, commodity);
+}
+
+gnc_numeric
+gnc_exchange_table_get_weighted_average_nearest (QofBook *book,
+                                                 const gnc_commodity *report_commodity,
+                                                 Timespec end_date,
+                                                 const gnc_commodity *commodity,
+                                                 Timespec date)
+{
+    ExchangeTable *table;
+    ExchangeSeries *series;
+
+    g_return_val_if_fail (book && report_commodity, gnc_numeric_zero ());
+
+    table = exchange_table_get (book, report_commodity, end_date);
+    series = g_hash_table_lookup (table->series, commodity);
+    return series ? exchange_series_get_nearest (series, date)
+           : gnc_numeric_zero ();
+}
@@ -0,0 +1,75 @@
+/********************************************************************
+ * gnc-exchange-table.h -- exchange rates from transactions for     *
+ *                         reports.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/** @file gnc-exchange-table.h
+ *  @brief Exchange rates into a report commodity, derived from the
+ *  cross-commodity transactions of a book.
+ *
+ *  These are the "average cost" and "weighted average" price sources
+ *  of the reports.  All the rates for a (book, report commodity, end
+ *  date) are computed in one pass over the book's non-void splits
+ *  posted up to the end date that involve two different commodities.
+ *  The result is kept until the book's generation changes, so running
+ *  several reports, or one report several times, only pays for it
+ *  once.
+ *
+ *  A commodity never exchanged with the report commodity itself gets
+ *  its rate through one that was, the way gnc:resolve-unknown-comm
+ *  derived it: stock bought in US dollars is priced in euros by the
+ *  rate of the dollar to the euro.
+ *
+ *  All lookups return zero when there is no rate for the commodity.
+ */
+
+#ifndef GNC_EXCHANGE_TABLE_H
+#define GNC_EXCHANGE_TABLE_H
+
+#include <glib.h>
+#include "qof.h"
+#include "gnc-commodity.h"
+
+/** @return The volume-weighted average cost of the commodity, in units
+ *  of the report commodity per unit of it, over all its buys and sells
+ *  outside trading accounts up to the end date. */
+gnc_numeric gnc_exchange_table_get_average_cost (QofBook *book,
+                                                 const gnc_commodity *report_commodity,
+                                                 Timespec end_date,
+                                                 const gnc_commodity *commodity);
+
+/** @return The weighted average exchange rate of the commodity over all
+ *  its exchanges with the report commodity up to the end date. */
+gnc_numeric gnc_exchange_table_get_weighted_average (QofBook *book,
+                                                     const gnc_commodity *report_commodity,
+                                                     Timespec end_date,
+                                                     const gnc_commodity *commodity);
+
+/** @return The weighted average exchange rate of the commodity over its
+ *  exchanges with the report commodity up to the one nearest the date.
+ *  Exchanges between two euro currencies count as exchanges with the
+ *  report commodity when that is a euro currency too. */
+gnc_numeric gnc_exchange_table_get_weighted_average_nearest (QofBook *book,
+                                                             const gnc_commodity *report_commodity,
+                                                             Timespec end_date,
+                                                             const gnc_commodity *commodity,
+                                                             Timespec date);
+
+#endif
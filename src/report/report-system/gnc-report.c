@@ -39,6 +39,9 @@
 #include "gnc-guile-utils.h"
 #include "gnc-report.h"
 #include "gnc-engine.h"
+#include "gnc-session.h"
+#include "Account.h"
+#include "Transaction.h"
 
 static QofLogModule log_module = GNC_MOD_GUI;
 
@@ -46,6 +49,26 @@ static QofLogModule log_module = GNC_MOD_GUI;
 static GHashTable *reports = NULL;
 static gint report_next_serial_id = 0;
 
+/* The html of the last run of each report, by report id, to hand out
+ * again while neither the report's options nor any of the book's data
+ * it depends on have changed. */
+typedef struct
+{
+    gchar *html;
+    gchar *key;               /* gnc:report-render-cache-key at the run */
+    QofBook *book;
+    guint dropped;            /* qof_event_get_dropped_count() at the run */
+    time64 today;             /* relative dates depend on it */
+    GHashTable *accounts;     /* GUIDs of the accounts the report read, or
+                                 NULL if unknown, i.e. any change matters */
+    gboolean stale;           /* set by events touching what it read */
+} ReportRenderCache;
+
+static GHashTable *render_cache = NULL;
+static gint render_cache_event_handler_id = 0;
+
+static void gnc_report_render_cache_remove (gint id);
+
 static void
 gnc_report_init_table(void)
 {
@@ -62,6 +85,7 @@ gnc_report_remove_by_id(gint id)
 {
     if (reports)
         g_hash_table_remove(reports, &id);
+    gnc_report_render_cache_remove (id);
 }
 
 SCM gnc_report_find(gint id)
@@ -133,6 +157,8 @@ gnc_reports_flush_global(void)
 {
     if (reports)
         g_hash_table_foreach_remove(reports, yes_remove, NULL);
+    if (render_cache)
+        g_hash_table_remove_all (render_cache);
 }
 
 GHashTable *
@@ -148,25 +174,219 @@ error_handler(const char *str)
     g_warning("Failure running report: %s", str);
 }
 
+static void
+report_render_cache_free (ReportRenderCache *entry)
+{
+    g_free (entry->html);
+    g_free (entry->key);
+    if (entry->accounts)
+        g_hash_table_destroy (entry->accounts);
+    g_free (entry);
+}
+
+static void
+report_render_cache_mark_stale (gpointer key, gpointer value, gpointer data)
+{
+    ReportRenderCache *entry = value;
+    GList *accounts = data, *node;
+
+    if (entry->stale)
+        return;
+    if (!entry->accounts)
+    {
+        entry->stale = TRUE;
+        return;
+    }
+    for (node = accounts; node; node = node->next)
+    {
+        if (g_hash_table_lookup (entry->accounts,
+                                 qof_instance_get_guid (node->data)))
+        {
+            entry->stale = TRUE;
+            return;
+        }
+    }
+}
+
+/* Mark stale the cached runs that read what the event touched.  Splits
+ * and transactions touch the accounts they are in; anything else, such
+ * as a price or a commodity, may bear on any report. */
+static void
+report_render_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                                   gpointer user_data, gpointer event_data)
+{
+    GList *accounts = NULL;
+    gboolean any = FALSE;
+
+    if (!render_cache || g_hash_table_size (render_cache) == 0)
+        return;
+
+    if (GNC_IS_ACCOUNT (entity))
+        accounts = g_list_prepend (accounts, entity);
+    else if (GNC_IS_SPLIT (entity))
+    {
+        Account *account = xaccSplitGetAccount (GNC_SPLIT (entity));
+        if (account)
+            accounts = g_list_prepend (accounts, account);
+    }
+    else if (GNC_IS_TRANSACTION (entity))
+    {
+        GList *node;
+
+        for (node = xaccTransGetSplitList (GNC_TRANSACTION (entity)); node;
+             node = node->next)
+        {
+            Account *account = xaccSplitGetAccount (node->data);
+            if (account)
+                accounts = g_list_prepend (accounts, account);
+        }
+    }
+    else
+        any = TRUE;
+
+    if (any)
+    {
+        GHashTableIter iter;
+        gpointer value;
+
+        g_hash_table_iter_init (&iter, render_cache);
+        while (g_hash_table_iter_next (&iter, NULL, &value))
+            ((ReportRenderCache *) value)->stale = TRUE;
+    }
+    else if (accounts)
+    {
+        g_hash_table_foreach (render_cache, report_render_cache_mark_stale,
+                              accounts);
+    }
+    g_list_free (accounts);
+}
+
+static void
+gnc_report_render_cache_remove (gint id)
+{
+    if (render_cache)
+        g_hash_table_remove (render_cache, &id);
+}
+
+void
+gnc_report_invalidate_render_cache (gint report_id)
+{
+    gnc_report_render_cache_remove (report_id);
+}
+
+/* The set of account GUIDs that gnc:report-render-dependencies gives
+ * for the report, or NULL if it doesn't know. */
+static GHashTable *
+report_render_cache_get_accounts (SCM report)
+{
+    SCM get_deps = scm_c_eval_string ("gnc:report-render-dependencies");
+    SCM deps = gfec_apply (get_deps, scm_list_1 (report), error_handler);
+    GHashTable *accounts;
+
+    if (deps == SCM_UNDEFINED || !scm_is_true (scm_list_p (deps)))
+        return NULL;
+
+    accounts = g_hash_table_new_full (guid_hash_to_guint,
+                                      guid_g_hash_table_equal,
+                                      (GDestroyNotify) guid_free, NULL);
+    for (; !scm_is_null (deps); deps = SCM_CDR (deps))
+    {
+        gchar *str = gnc_scm_to_utf8_string (SCM_CAR (deps));
+        GncGUID *guid = guid_malloc ();
+
+        if (string_to_guid (str, guid))
+            g_hash_table_insert (accounts, guid, guid);
+        else
+            guid_free (guid);
+        g_free (str);
+    }
+    return accounts;
+}
+
+static gboolean
+report_render_cache_entry_valid (const ReportRenderCache *entry,
+                                 const gchar *key, QofBook *book)
+{
+    if (entry->book != book || g_strcmp0 (entry->key, key) != 0 ||
+        entry->today != gnc_time64_get_today_start ())
+        return FALSE;
+    /* Changes made while events were suspended may be about anything. */
+    return !entry->stale &&
+           entry->dropped == qof_event_get_dropped_count ();
+}
+
 gboolean
 gnc_run_report (gint report_id, char ** data)
 {
-    gchar *free_data;
+    SCM report, get_key, scm_key, dirty_report;
+    ReportRenderCache *entry;
+    QofBook *book = gnc_get_current_book ();
+    gchar *key = NULL;
     SCM scm_text;
     gchar *str;
 
     g_return_val_if_fail (data != NULL, FALSE);
     *data = NULL;
 
+    report = gnc_report_find (report_id);
+    if (report != SCM_BOOL_F)
+    {
+        get_key = scm_c_eval_string ("gnc:report-render-cache-key");
+        scm_key = gfec_apply (get_key, scm_list_1 (report), error_handler);
+        if (scm_key != SCM_UNDEFINED && scm_is_string (scm_key))
+            key = gnc_scm_to_utf8_string (scm_key);
+    }
+
+    entry = render_cache ? g_hash_table_lookup (render_cache, &report_id) : NULL;
+    if (entry && key && report_render_cache_entry_valid (entry, key, book))
+    {
+        DEBUG ("report %d unchanged, using its cached html", report_id);
+        g_free (key);
+        *data = g_strdup (entry->html);
+        return TRUE;
+    }
+
+    /* Don't let the report hand back its own cached html either. */
+    if (report != SCM_BOOL_F)
+    {
+        dirty_report = scm_c_eval_string ("gnc:report-set-dirty?!");
+        scm_call_2 (dirty_report, report, SCM_BOOL_T);
+    }
+
     str = g_strdup_printf("(gnc:report-run %d)", report_id);
     scm_text = gfec_eval_string(str, error_handler);
     g_free(str);
 
     if (scm_text == SCM_UNDEFINED || !scm_is_string (scm_text))
+    {
+        g_free (key);
+        gnc_report_render_cache_remove (report_id);
         return FALSE;
+    }
 
     *data = gnc_scm_to_utf8_string (scm_text);
 
+    if (key)
+    {
+        if (!render_cache)
+            render_cache = g_hash_table_new_full (g_int_hash, g_int_equal, g_free,
+                                                  (GDestroyNotify) report_render_cache_free);
+        if (!render_cache_event_handler_id)
+            render_cache_event_handler_id =
+                qof_event_register_handler (report_render_cache_event_handler,
+                                            NULL);
+
+        entry = g_new0 (ReportRenderCache, 1);
+        entry->html = g_strdup (*data);
+        entry->key = key;
+        entry->book = book;
+        entry->dropped = qof_event_get_dropped_count ();
+        entry->today = gnc_time64_get_today_start ();
+        entry->accounts = report_render_cache_get_accounts (report);
+        g_hash_table_insert (render_cache, g_memdup (&report_id, sizeof (gint)),
+                             entry);
+    }
+
     return TRUE;
 }
 
@@ -31,6 +31,10 @@
 #define SAVED_REPORTS_FILE "saved-reports-2.4"
 #define SAVED_REPORTS_FILE_OLD_REV "saved-reports-2.0"
 
+/** Run the report and return its html in a newly allocated *data.
+ *  The html of the last run is handed out again while neither the
+ *  report's options (see gnc:report-render-cache-key) nor any book data
+ *  it depends on (see gnc:report-render-dependencies) have changed. */
 gboolean gnc_run_report (gint report_id, char ** data);
 gboolean gnc_run_report_id_string (const char * id_string, char **data);
 
@@ -44,6 +48,8 @@ gchar* gnc_report_name( SCM report );
 /* returns #f if the report id cannot be found */
 SCM gnc_report_find(gint id);
 void gnc_report_remove_by_id(gint id);
+/** Make the next gnc_run_report of the report run it afresh. */
+void gnc_report_invalidate_render_cache (gint report_id);
 gint gnc_report_add(SCM report);
 
 void gnc_reports_flush_global(void);
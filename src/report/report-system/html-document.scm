@@ -125,6 +125,16 @@
     (do-list tree)
     retval))
 
+;; write a tree as produced by the renderers straight to a port.  as
+;; for gnc:html-document-tree-collapse, each list in the tree holds
+;; its pieces last one first.
+(define (gnc:html-document-tree-write tree port)
+  (define (write-elt elt)
+    (cond ((string? elt) (display elt port))
+          ((list? elt) (for-each write-elt (reverse elt)))
+          (else (display elt port))))
+  (write-elt tree))
+
 ;; first optional argument is "headers?"
 ;; returns the html document as a string, I think.
 (define (gnc:html-document-render doc . rest) 
@@ -136,9 +146,11 @@
         ;; if there's a style sheet, let it do the rendering 
         (gnc:html-style-sheet-render stylesheet doc headers?)
         
-        ;; otherwise, do the trivial render. 
-        (let* ((retval '())
-               (push (lambda (l) (set! retval (cons l retval))))
+        ;; otherwise, do the trivial render.  the pieces are written
+        ;; out as they are rendered rather than collected into a tree
+        ;; and flattened at the end.
+        (let* ((port (open-output-string))
+               (push (lambda (l) (gnc:html-document-tree-write l port)))
 	       (objs (gnc:html-document-objects doc))
 	       (work-to-do (length objs))
            (css? (gnc-html-engine-supports-css))
@@ -192,7 +204,7 @@
           (gnc:html-document-pop-style doc)
           (gnc:html-style-table-uncompile (gnc:html-document-style doc))
 
-          (string-concatenate (gnc:html-document-tree-collapse retval))))))
+          (get-output-string port)))))
 
 
 (define (gnc:html-document-push-style doc style)
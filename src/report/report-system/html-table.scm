@@ -707,7 +707,14 @@
          (let ((rowstyle 
                 (gnc:html-table-row-style table rownum))
                (rowmarkup 
-                (gnc:html-table-row-markup table rownum)))
+                (gnc:html-table-row-markup table rownum))
+               ;; each row is written to a string of its own as it is
+               ;; rendered, so a big table doesn't hold on to the
+               ;; pieces of all its cells.
+               (row-port (open-output-string)))
+           (define (row-push l)
+             (gnc:html-document-tree-write l row-port))
+
            ;; set default row markup
            (if (not rowmarkup)
                (set! rowmarkup "tr"))
@@ -715,7 +722,7 @@
            ;; push the style for this row and write the start tag, then 
            ;; pop it again.
            (if rowstyle (gnc:html-document-push-style doc rowstyle))
-           (push (gnc:html-document-markup-start doc rowmarkup #t))
+           (row-push (gnc:html-document-markup-start doc rowmarkup #t))
            (if rowstyle (gnc:html-document-pop-style doc))
            
            ;; write the column data, pushing the right column style 
@@ -730,10 +737,10 @@
                 
                 ;; render the cell contents 
                 (if (not (gnc:html-table-cell? datum))
-                    (push (gnc:html-document-markup-start doc "td" #t)))
-                (push (gnc:html-object-render datum doc))
+                    (row-push (gnc:html-document-markup-start doc "td" #t)))
+                (row-push (gnc:html-object-render datum doc))
                 (if (not (gnc:html-table-cell? datum))
-                    (push (gnc:html-document-markup-end doc "td")))
+                    (row-push (gnc:html-document-markup-end doc "td")))
                 
                 ;; pop styles 
                 (if rowstyle (gnc:html-document-pop-style doc))
@@ -743,8 +750,9 @@
            
            ;; write the row end tag and pop the row style 
            (if rowstyle (gnc:html-document-push-style doc rowstyle))
-           (push (gnc:html-document-markup-end doc rowmarkup))
+           (row-push (gnc:html-document-markup-end doc rowmarkup))
            (if rowstyle (gnc:html-document-pop-style doc))
+           (push (get-output-string row-port))
            
            (set! colnum 0)
            (set! rownum (+ 1 rownum))))
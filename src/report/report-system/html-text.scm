@@ -144,8 +144,9 @@
            ((string? rendered-elt)
             rendered-elt)
            ((list? rendered-elt)
-            (apply string-append
-                   (gnc:html-document-tree-collapse rendered-elt)))
+            (call-with-output-string
+             (lambda (port)
+               (gnc:html-document-tree-write rendered-elt port))))
            (#t 
             (format "hold on there podner. form='~s'\n" rendered-elt)
             ""))))
@@ -22,6 +22,7 @@
 %{
 /* Includes the header in the wrapper code */
 #include <config.h>
+#include <gnc-exchange-table.h>
 #include <gnc-report.h>
 %}
 #if defined(SWIGGUILE)
@@ -41,4 +42,8 @@ gint gnc_report_add(SCM report);
 gchar* gnc_get_default_report_font_family();
 
 void gnc_saved_reports_backup (void);
-gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
\ No newline at end of file
+gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
+
+gnc_numeric gnc_exchange_table_get_average_cost (QofBook *book, const gnc_commodity *report_commodity, Timespec end_date, const gnc_commodity *commodity);
+gnc_numeric gnc_exchange_table_get_weighted_average (QofBook *book, const gnc_commodity *report_commodity, Timespec end_date, const gnc_commodity *commodity);
+gnc_numeric gnc_exchange_table_get_weighted_average_nearest (QofBook *book, const gnc_commodity *report_commodity, Timespec end_date, const gnc_commodity *commodity, Timespec date);
@@ -62,6 +62,8 @@
 (export gnc:exchange-by-pricedb-latest )
 (export gnc:exchange-by-pricedb-nearest)
 (export gnc:exchange-by-pricealist-nearest)
+(export gnc:make-exchange-table-function)
+(export gnc:exchange-by-exchange-table-nearest)
 (export gnc:case-exchange-fn)
 (export gnc:case-exchange-time-fn)
 (export gnc:sum-collector-commodity)
@@ -185,11 +187,16 @@
 (export gnc:delete-report)
 (export gnc:rename-report)
 (export gnc:find-report-template)
+(export gnc:define-report-stub)
+(export gnc:report-template-load!)
 (export gnc:report-serialize)
 (export gnc:report-to-template-new)
 (export gnc:report-to-template-update)
 (export gnc:report-render-html)
 (export gnc:report-run)
+(export gnc:report-run-by-name)
+(export gnc:report-render-cache-key)
+(export gnc:report-render-dependencies)
 (export gnc:report-templates-for-each)
 (export gnc:report-embedded-list)
 (export gnc:report-template-is-custom/template-guid?)
@@ -277,6 +284,7 @@
 (export gnc:html-document?)
 (export gnc:html-document-set-style!)
 (export gnc:html-document-tree-collapse)
+(export gnc:html-document-tree-write)
 (export gnc:html-document-render)
 (export gnc:html-document-push-style)
 (export gnc:html-document-pop-style)
@@ -691,6 +699,8 @@
 (export gnc:accountlist-get-comm-balance-interval-with-closing)
 (export gnc:accountlist-get-comm-balance-at-date)
 (export gnc:accountlist-get-comm-balance-at-date-with-closing)
+(export gnc:accountlist-get-comm-balances-at-dates)
+(export gnc:accountlist-get-comm-balance-changes-for-intervals)
 (export gnc:query-set-match-non-voids-only!)
 (export gnc:query-set-match-voids-only!)
 (export gnc:split-voided?)
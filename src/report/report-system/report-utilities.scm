@@ -320,95 +320,81 @@
 ;;       <commodity> doesn't exist, the balance will be
 ;;       (gnc-numeric-zero). If signreverse? is true, the result's
 ;;       sign will be reversed.
+;;   'convert <commodity> <date>: Returns the sum of all the balances,
+;;       each converted to <commodity> at the price-db price nearest
+;;       to the timepair <date>. Balances without a price add zero.
 ;;   (internal) 'list #f #f: get the association list of 
 ;;       commodity->numeric-collector
+;;   (internal) 'pointer #f #f: get the underlying C
+;;       GncCommodityCollector.  The totals are kept there; it is
+;;       freed once the collector procedure has been garbage collected.
+
+(define commodity-collector-guardian (make-guardian))
+
+;; Free the C collectors of commodity collectors that are no longer
+;; referenced anywhere.
+(define (commodity-collector-free-unreachable)
+  (let loop ((collector (commodity-collector-guardian)))
+    (if collector
+        (begin
+          (gnc-commodity-collector-destroy (collector 'pointer #f #f))
+          (loop (commodity-collector-guardian))))))
 
 (define (gnc:make-commodity-collector)
+  (commodity-collector-free-unreachable)
   (let 
-      ;; the association list of (commodity -> value-collector) pairs.
-      ((commoditylist '()))
-    
-    ;; helper function to add a commodity->value pair to our list. 
-    ;; If no pair with this commodity exists, we will create one.
-    (define (add-commodity-value commodity value)
-      ;; lookup the corresponding pair
-      (let ((pair (assoc commodity commoditylist)))
-	(if (not pair)
-	    (begin
-	      ;; create a new pair, using the gnc:numeric-collector
-	      (set! pair (list commodity (gnc:make-numeric-collector)))
-	      ;; and add it to the alist
-	      (set! commoditylist (cons pair commoditylist))))
-	;; add the value
-	(gnc:numeric-collector-add (cadr pair) value)))
-    
-    ;; helper function to walk an association list, adding each
-    ;; (commodity -> collector) pair to our list at the appropriate 
-    ;; place
-    (define (add-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   (gnc:numeric-collector-total (cadar clist)))
-		  (add-commodity-clist (cdr clist)))))
-
-    (define (minus-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   (gnc-numeric-neg
-		    (gnc:numeric-collector-total (cadar clist))))
-		  (minus-commodity-clist (cdr clist)))))
-
-    ;; helper function walk the association list doing a callback on
-    ;; each key-value pair.
-    (define (process-commodity-list fn clist)
-      (map 
-       (lambda (pair) (fn (car pair) 
-			  (gnc:numeric-collector-total (cadr pair))))
-       clist))
-
-    ;; helper function which is given a commodity and returns, if
-    ;; existing, a list (gnc:commodity gnc:numeric). If the second
-    ;; argument was #t, the sign gets reversed.
-    (define (getpair c sign?)
-      (let ((pair (assoc c commoditylist)))
-	(cons c (cons 
-	      (if (not pair)
-		  (gnc-numeric-zero)
-		  (if sign?
-		      (gnc-numeric-neg
-		       (gnc:numeric-collector-total (cadr pair)))
-		      (gnc:numeric-collector-total (cadr pair))))
-	      '()))))
-
-    ;; helper function which is given a commodity and returns, if
-    ;; existing, a <gnc:monetary> value. If the second argument was
-    ;; #t, the sign gets reversed.
-    (define (getmonetary c sign?)
-      (let ((pair (assoc c commoditylist)))
-	(gnc:make-gnc-monetary
-	 c (if (not pair)
-	       (gnc-numeric-zero)
-	       (if sign?
-		   (gnc-numeric-neg
-		    (gnc:numeric-collector-total (cadr pair)))
-		   (gnc:numeric-collector-total (cadr pair)))))))
-    
-    ;; Dispatch function
-    (lambda (action commodity amount)
-      (case action
-	((add) (add-commodity-value commodity amount))
-	((merge) (add-commodity-clist 
-		 (gnc-commodity-collector-list commodity)))
-	((minusmerge) (minus-commodity-clist
-		      (gnc-commodity-collector-list commodity)))
-	((format) (process-commodity-list commodity commoditylist))
-	((reset) (set! commoditylist '()))
-	((getpair) (getpair commodity amount))
-	((getmonetary) (getmonetary commodity amount))
-	((list) commoditylist) ; this one is only for internal use
-	(else (gnc:warn "bad commodity-collector action: " action))))))
+      ;; the C collector holding one total per commodity.
+      ((totals (gnc-commodity-collector-new)))
+
+    ;; helper function which is given a commodity and returns its
+    ;; total, with the sign reversed if the second argument was #t.
+    (define (get-amount c sign?)
+      (let ((amount (gnc-commodity-collector-get-amount totals c)))
+        (if sign? (gnc-numeric-neg amount) amount)))
+
+    ;; helper function walk the commodities doing a callback on each
+    ;; commodity and its total.
+    (define (process-commodity-list fn)
+      (map (lambda (c) (fn c (get-amount c #f)))
+           (gnc-commodity-collector-get-commodities totals)))
+
+    ;; helper function which builds the old association list of
+    ;; (commodity numeric-collector) pairs.
+    (define (make-commodity-list)
+      (process-commodity-list
+       (lambda (c amount)
+         (let ((collector (gnc:make-numeric-collector)))
+           (gnc:numeric-collector-add collector amount)
+           (list c collector)))))
+
+    (define self
+      ;; Dispatch function
+      (lambda (action commodity amount)
+        (case action
+          ((add) (if (gnc:gnc-numeric? amount)
+                     (gnc-commodity-collector-add-amount
+                      totals commodity amount)
+                     (gnc:warn 
+                      "gnc:numeric-collector called with wrong argument: "
+                      amount)))
+          ((merge) (gnc-commodity-collector-add-collector
+                    totals (commodity 'pointer #f #f)))
+          ((minusmerge) (gnc-commodity-collector-subtract-collector
+                         totals (commodity 'pointer #f #f)))
+          ((format) (process-commodity-list commodity))
+          ((reset) (gnc-commodity-collector-reset totals))
+          ((getpair) (list commodity (get-amount commodity amount)))
+          ((getmonetary) (gnc:make-gnc-monetary
+                          commodity (get-amount commodity amount)))
+          ((convert) (gnc-pricedb-convert-collector-nearest-price
+                      (gnc-pricedb-get-db (gnc-get-current-book))
+                      totals commodity amount))
+          ((list) (make-commodity-list)) ; this one is only for internal use
+          ((pointer) totals)             ; likewise
+          (else (gnc:warn "bad commodity-collector action: " action)))))
+
+    (commodity-collector-guardian self)
+    self))
 
 (define (gnc:commodity-collector-get-negated collector)
   (let
@@ -459,10 +445,16 @@
 ;; is true, the balances of all children (not just direct children)
 ;; are included in the calculation.
 (define (gnc:account-get-balance-at-date account date include-children?)
-  (let ((collector (gnc:account-get-comm-balance-at-date
-                    account date include-children?)))
-    (cadr (gnc-commodity-collector-assoc-pair
-	   collector (xaccAccountGetCommodity account) #f))))
+  (if include-children?
+      (let ((collector (gnc:account-get-comm-balance-at-date
+                        account date include-children?)))
+        (cadr (gnc-commodity-collector-assoc-pair
+               collector (xaccAccountGetCommodity account) #f)))
+      (let ((split (xaccAccountFindLastSplitAtDate
+                    account (gnc:timepair->secs date))))
+        (if (and split (not (null? split)))
+            (xaccSplitGetBalance split)
+            (gnc-numeric-zero)))))
 
 ;; This works similar as above but returns a commodity-collector, 
 ;; thus takes care of children accounts with different currencies.
@@ -472,8 +464,8 @@
 (define (gnc:account-get-comm-balance-at-date account 
 					      date include-children?)
   (let ((balance-collector (gnc:make-commodity-collector))
-	(query (qof-query-create-for-splits))
-	(splits #f))
+	(split (xaccAccountFindLastSplitAtDate
+		account (gnc:timepair->secs date))))
 
       (if include-children?
 	  (for-each 
@@ -484,23 +476,12 @@
 	      (gnc:account-get-comm-balance-at-date child date #f))
 	    account)))
 
-      (qof-query-set-book query (gnc-get-current-book))
-      (xaccQueryAddSingleAccountMatch query account QOF-QUERY-AND)
-      (xaccQueryAddDateMatchTS query #f date #t date QOF-QUERY-AND)
-      (qof-query-set-sort-order query
-				(list SPLIT-TRANS TRANS-DATE-POSTED)
-				(list QUERY-DEFAULT-SORT)
-				'())
-      (qof-query-set-sort-increasing query #t #t #t)
-      (qof-query-set-max-results query 1)
-      
-      (set! splits (qof-query-run query))
-      (qof-query-destroy query)
-
-      (if (and splits (not (null? splits)))
+      ;; The last split posted on or before the date carries the
+      ;; running balance at that date.
+      (if (and split (not (null? split)))
 	  (gnc-commodity-collector-add balance-collector
 				       (xaccAccountGetCommodity account)
-				       (xaccSplitGetBalance (car splits))))
+				       (xaccSplitGetBalance split)))
       balance-collector))
 
 ;; Calculate the increase in the balance of the account in terms of
@@ -537,12 +518,8 @@
 
     ;; Add the "value" of each split returned (which is measured
     ;; in the transaction currency).
-    (for-each
-     (lambda (split)
-       (value-collector 'add
-                        (xaccTransGetCurrency (xaccSplitGetParent split))
-                        (xaccSplitGetValue split)))
-     splits)
+    (gnc-commodity-collector-add-splits
+     (value-collector 'pointer #f #f) splits #t)
 
     value-collector))
 
@@ -649,6 +626,43 @@
 (define (gnc:accountlist-get-comm-balance-at-date-with-closing accountlist date)
   (gnc:account-get-trans-type-balance-interval-with-closing accountlist #f #f date))
 
+;; Sum a balance matrix, one list of balances per account of
+;; <accountlist> with one balance per element of <columns>, into one
+;; commodity collector per column.
+(define (balance-matrix->comm-collectors accountlist matrix columns)
+  (let ((collectors (map (lambda (c) (gnc:make-commodity-collector))
+                         columns)))
+    (for-each
+     (lambda (account row)
+       (let ((commodity (xaccAccountGetCommodity account)))
+         (for-each
+          (lambda (collector balance)
+            (gnc-commodity-collector-add collector commodity balance))
+          collectors row)))
+     accountlist matrix)
+    collectors))
+
+;; The balances of all accounts in <accountlist> (not including
+;; their children) at each date of <dates>, as one commodity collector
+;; per date. Unlike calling gnc:account-get-comm-balance-at-date per
+;; account and date, this walks each account's splits only once.
+(define (gnc:accountlist-get-comm-balances-at-dates accountlist dates)
+  (balance-matrix->comm-collectors
+   accountlist
+   (gnc-accounts-get-balances-at-dates accountlist dates)
+   dates))
+
+;; The increase in the balances of all accounts in <accountlist> over
+;; each (from to) interval of <intervals>, e.g. from
+;; gnc:make-date-interval-list, as one commodity collector per
+;; interval. This walks each account's splits only once.
+(define (gnc:accountlist-get-comm-balance-changes-for-intervals
+         accountlist intervals)
+  (balance-matrix->comm-collectors
+   accountlist
+   (gnc-accounts-get-balance-changes-for-intervals accountlist intervals)
+   intervals))
+
 ;; utility function - ensure that a query matches only non-voids.  Destructive.
 (define (gnc:query-set-match-non-voids-only! query book)
   (let ((temp-query (qof-query-create-for-splits)))
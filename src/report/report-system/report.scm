@@ -60,6 +60,12 @@
 ;; value is the report definition structure.
 (define *gnc:_report-templates_* (make-hash-table 23))
 
+;; Hash table of the report modules that define templates but haven't
+;; been loaded yet, keyed by the guid of each such template. The entry
+;; in *gnc:_report-templates_* is then a stand-in, see
+;; gnc:define-report-stub.
+(define *gnc:_report-template-modules_* (make-hash-table 23))
+
 ;; Define those strings here to make changes easier and avoid typos.
 (define gnc:menuname-reports "Reports/StandardReports")
 (define gnc:menuname-asset-liability (N_ "_Assets & Liabilities"))
@@ -135,9 +141,13 @@
 	(let* ((report-guid (gnc:report-template-report-guid report-rec))
 	       (name (gnc:report-template-name report-rec))
 	       (tmpl (hash-ref *gnc:_report-templates_* report-guid)))
-	  (if (not tmpl)
-	      (hash-set! *gnc:_report-templates_*
-			 report-guid report-rec)
+	  (if (or (not tmpl)
+                  ;; the module of a stand-in is being loaded
+                  (hash-ref *gnc:_report-template-modules_* report-guid))
+	      (begin
+                (hash-remove! *gnc:_report-template-modules_* report-guid)
+                (hash-set! *gnc:_report-templates_*
+                           report-guid report-rec))
 	      (begin
 		;; FIXME: We should pass the top-level window
 		;; instead of the '() to gnc-error-dialog, but I
@@ -335,6 +345,7 @@
 ;; gnc:make-report instantiates a report from a report-template.
 ;; The actual report is stored away in a hash-table -- only the id is returned.
 (define (gnc:make-report template-id . rest)
+  (gnc:report-template-load! template-id)
   (let* ((template-parent (gnc:report-template-parent-type (hash-ref *gnc:_report-templates_* template-id)))
 	 (report-type (if template-parent
 			  template-parent
@@ -472,6 +483,53 @@
 (define (gnc:find-report-template report-type) 
   (hash-ref *gnc:_report-templates_* report-type))
 
+;; define a stand-in for the template with the given guid that the
+;; report module module-name defines, from what the report menus need
+;; to know about it. the module is only loaded once the template's
+;; options or renderer are first needed.
+(define (gnc:define-report-stub module-name report-guid name
+                                menu-path menu-name menu-tip in-menu?)
+  (if (not (hash-ref *gnc:_report-templates_* report-guid))
+      (begin
+        (gnc:define-report
+         'version 1
+         'name name
+         'report-guid report-guid
+         'menu-path menu-path
+         'menu-name menu-name
+         'menu-tip menu-tip
+         'in-menu? in-menu?
+         'options-generator
+         (lambda ()
+           (let* ((template (gnc:report-template-load! report-guid))
+                  (generator (and template
+                                  (gnc:report-template-options-generator
+                                   template))))
+             (if generator (generator) (gnc:new-options))))
+         'renderer
+         (lambda (report)
+           (let ((template (gnc:report-template-load! report-guid)))
+             (if template
+                 ((gnc:report-template-renderer template) report)
+                 (gnc:make-html-document)))))
+        (hash-set! *gnc:_report-template-modules_* report-guid module-name))))
+
+;; load the module of the template if it's still a stand-in.
+;; returns the template, or #f if the module didn't define it.
+(define (gnc:report-template-load! report-guid)
+  (let ((module-name (hash-ref *gnc:_report-template-modules_* report-guid)))
+    (if module-name
+        (begin
+          (gnc:debug "loading report module " module-name)
+          (resolve-module module-name)
+          (if (hash-ref *gnc:_report-template-modules_* report-guid)
+              (begin
+                (gnc:warn "report module " module-name
+                          " no longer defines report " report-guid)
+                (hash-remove! *gnc:_report-template-modules_* report-guid)
+                (hash-remove! *gnc:_report-templates_* report-guid)))))
+    (hash-ref *gnc:_report-templates_* report-guid)))
+
 (define (gnc:report-template-is-custom/template-guid? guid)
   (let* ((custom-template (if (string? guid) (if (string-null? guid) #f (hash-ref *gnc:_report-templates_* guid)) #f))
          (parent-type (if custom-template (gnc:report-template-parent-type custom-template) #f)))
@@ -740,6 +798,57 @@
                       #f))
 	doc))) ;; YUK! inner doc is html-doc object; outer doc is a string.
 
+;; A string that changes whenever the rendering of the report may,
+;; short of changes to the book: when its options, its style sheet's
+;; options or those of its embedded reports do. gnc_run_report keeps
+;; the last rendering of each report under this key.
+(define (gnc:report-render-cache-key report)
+  (let* ((options (gnc:report-options report))
+         (stylesheet (gnc:report-stylesheet report))
+         (embedded (or (gnc:report-embedded-list options) '())))
+    (apply string-append
+           (gnc:generate-restore-forms options "options")
+           (if stylesheet
+               (gnc:generate-restore-forms
+                (gnc:html-style-sheet-options stylesheet) "stylesheet")
+               "")
+           (map (lambda (id)
+                  (let ((child (gnc-report-find id)))
+                    (if child (gnc:report-render-cache-key child) "")))
+                embedded))))
+
+;; The GUIDs of the accounts the report reads, as far as its account
+;; options tell: the selected accounts and all their descendants, for
+;; the report and its embedded reports. Returns #f if a report has
+;; neither account options nor embedded reports, in which case its
+;; cached rendering is dropped on any change to the book.
+(define (gnc:report-render-dependencies report)
+  (let* ((options (gnc:report-options report))
+         (embedded (or (gnc:report-embedded-list options) '()))
+         (has-account-option? #f)
+         (guids '()))
+    (gnc:options-for-each
+     (lambda (option)
+       (if (memq (gnc:option-type option) '(account-list account-sel))
+           (let ((value (gnc:option-value option)))
+             (set! has-account-option? #t)
+             (for-each
+              (lambda (acct)
+                (if acct
+                    (for-each
+                     (lambda (a) (set! guids (cons (gncAccountGetGUID a) guids)))
+                     (cons acct (gnc-account-get-descendants acct)))))
+              (if (list? value) value (list value))))))
+     options)
+    (let loop ((ids embedded) (guids guids))
+      (if (null? ids)
+          (and (or has-account-option? (not (null? embedded))) guids)
+          (let* ((child (gnc-report-find (car ids)))
+                 (child-guids (and child
+                                   (gnc:report-render-dependencies child))))
+            (and child-guids
+                 (loop (cdr ids) (append child-guids guids))))))))
+
 ;; looks up the report by id and renders it with gnc:report-render-html
 ;; marks the cursor busy during rendering; returns the html
 ;; Note: the final html document is post-processed to ensure there's only one single
@@ -762,6 +871,23 @@
     html))
 
 
+;; instantiates the report template (a saved report or a standard
+;; report) called template-name and renders it as gnc:report-run does,
+;; but without touching the user interface, for gnucash --run-report.
+;; returns the html, or #f if there's no such report or it failed.
+(define (gnc:report-run-by-name template-name)
+  (let ((template-id (gnc:report-template-name-to-id template-name))
+        (html #f))
+    (if template-id
+        (let ((report (gnc-report-find (gnc:make-report template-id))))
+          (gnc:backtrace-if-exception
+           (lambda ()
+             (set! html (gnc:report-render-html report #t))
+             (set! html (gnc:substring-replace-from-to html "jquery.min.js" "" 2 -1))
+             (set! html (gnc:substring-replace-from-to html "jquery.jqplot.js" "" 2 -1)))))
+        (gnc:warn "No report named " template-name))
+    html))
+
 ;; "thunk" should take the report-type and the report template record
 (define (gnc:report-templates-for-each thunk)
   (hash-for-each (lambda (report-id template) (thunk report-id template))
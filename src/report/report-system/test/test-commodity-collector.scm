@@ -0,0 +1,115 @@
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; This program is free software; you can redistribute it and/or
+;; modify it under the terms of the GNU General Public License as
+;; published by the Free Software Foundation; either version 2 of
+;; the License, or (at your option) any later version.
+;;
+;; This program is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+;;
+;; You should have received a copy of the GNU General Public License
+;; along with this program; if not, contact:
+;;
+;; Free Software Foundation           Voice:  +1-617-542-5942
+;; 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+;; Boston, MA  02110-1301,  USA       gnu@gnu.org
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+;; gnc:make-commodity-collector keeps its totals in a C
+;; GncCommodityCollector; each of its actions must still behave as
+;; documented in report-utilities.scm.
+
+(use-modules (gnucash gnc-module))
+(use-modules (srfi srfi-1))
+
+(gnc:module-begin-syntax (gnc:module-load "gnucash/app-utils" 0))
+(gnc:module-begin-syntax (gnc:module-load "gnucash/report/report-system" 0))
+
+(use-modules (gnucash engine))
+(use-modules (sw_engine))
+(use-modules (gnucash engine test test-extras))
+(use-modules (gnucash report report-system))
+
+(define (run-test)
+  (and (test-collector-actions)
+       (test-collector-convert)))
+
+(define (num n d) (gnc:make-gnc-numeric n d))
+
+(define (check what ok?)
+  (or ok?
+      (begin (format #t "commodity collector: ~a failed\n" what) #f)))
+
+(define (total collector commodity)
+  (cadr (collector 'getpair commodity #f)))
+
+(define (test-collector-actions)
+  (let* ((env (create-test-env))
+	 (table (gnc-commodity-table-get-table (gnc-get-current-book)))
+	 (usd (gnc-commodity-table-lookup table "ISO4217" "USD"))
+	 (eur (gnc-commodity-table-lookup table "ISO4217" "EUR"))
+	 (a (gnc:make-commodity-collector))
+	 (b (gnc:make-commodity-collector)))
+    (a 'add usd (num 150 100))
+    (a 'add eur (num 3 1))
+    (a 'add usd (num 25 10))
+    (b 'add usd (num 1 1))
+    (and
+     (check "add" (gnc-numeric-equal (total a usd) (num 4 1)))
+     (check "getpair of an unseen commodity"
+	    (gnc-numeric-zero-p (total b eur)))
+     (check "getpair signreverse"
+	    (gnc-numeric-equal (cadr (a 'getpair eur #t)) (num -3 1)))
+     (check "getmonetary"
+	    (gnc-numeric-equal
+	     (gnc:gnc-monetary-amount (a 'getmonetary usd #f)) (num 4 1)))
+     (check "format, most recently seen first"
+	    (equal? (list eur usd)
+		    (a 'format (lambda (commodity amount) commodity) #f)))
+     (begin (a 'merge b #f)
+	    (check "merge" (gnc-numeric-equal (total a usd) (num 5 1))))
+     (begin (a 'minusmerge b #f)
+	    (a 'minusmerge b #f)
+	    (check "minusmerge"
+		   (and (gnc-numeric-equal (total a usd) (num 3 1))
+			(gnc-numeric-equal (total a eur) (num 3 1)))))
+     (check "negated"
+	    (gnc-numeric-equal
+	     (total (gnc:commodity-collector-get-negated a) usd) (num -3 1)))
+     (check "list"
+	    (= 2 (length (gnc-commodity-collector-list a))))
+     (begin (a 'reset #f #f)
+	    (check "reset"
+		   (and (null? (a 'format (lambda (c n) c) #f))
+			(gnc-numeric-zero-p (total a usd))))))))
+
+(define (add-price book commodity currency date value)
+  (let ((price (gnc-price-create book)))
+    (gnc-price-begin-edit price)
+    (gnc-price-set-commodity price commodity)
+    (gnc-price-set-currency price currency)
+    (gnc-price-set-time price date)
+    (gnc-price-set-source price PRICE-SOURCE-FQ)
+    (gnc-price-set-value price value)
+    (gnc-price-commit-edit price)
+    (gnc-pricedb-add-price (gnc-pricedb-get-db book) price)
+    (gnc-price-unref price)))
+
+(define (test-collector-convert)
+  (let* ((env (create-test-env))
+	 (book (gnc-get-current-book))
+	 (table (gnc-commodity-table-get-table book))
+	 (usd (gnc-commodity-table-lookup table "ISO4217" "USD"))
+	 (eur (gnc-commodity-table-lookup table "ISO4217" "EUR"))
+	 (gbp (gnc-commodity-table-lookup table "ISO4217" "GBP"))
+	 (now (cons (current-time) 0))
+	 (c (gnc:make-commodity-collector)))
+    (add-price book eur usd now (num 2 1))
+    (c 'add usd (num 10 1))
+    (c 'add eur (num 5 1))
+    (c 'add gbp (num 7 1))
+    ;; The pounds have no price, so they add nothing.
+    (check "convert"
+	   (gnc-numeric-equal (c 'convert usd now) (num 20 1)))))
@@ -0,0 +1,129 @@
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; This program is free software; you can redistribute it and/or
+;; modify it under the terms of the GNU General Public License as
+;; published by the Free Software Foundation; either version 2 of
+;; the License, or (at your option) any later version.
+;;
+;; This program is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+;;
+;; You should have received a copy of the GNU General Public License
+;; along with this program; if not, contact:
+;;
+;; Free Software Foundation           Voice:  +1-617-542-5942
+;; 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+;; Boston, MA  02110-1301,  USA       gnu@gnu.org
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+;; The exchange table (gnc-exchange-table.h) must give the rates the
+;; Scheme gnc:make-exchange-alist and gnc:make-exchange-cost-alist
+;; compute, including those only resolvable through another commodity.
+
+(use-modules (gnucash gnc-module))
+(use-modules (srfi srfi-1))
+
+(gnc:module-begin-syntax (gnc:module-load "gnucash/app-utils" 0))
+(gnc:module-begin-syntax (gnc:module-load "gnucash/report/report-system" 0))
+
+(use-modules (gnucash engine))
+(use-modules (sw_engine))
+(use-modules (sw_report_system))
+(use-modules (gnucash engine test test-extras))
+(use-modules (gnucash report report-system))
+
+(define (run-test)
+  (and (test-exchange-table-matches-alists)))
+
+(define (days-ago n)
+  (cons (- (current-time) (* n 86400)) 0))
+
+;; Exchange 'value' of 'currency' from 'from-account' for 'amount' of
+;; the commodity of 'to-account'.
+(define (create-exchange env date currency from-account to-account
+			 value amount)
+  (let* ((book (gnc-get-current-book))
+	 (txn (xaccMallocTransaction book))
+	 (split-1 (xaccMallocSplit book))
+	 (split-2 (xaccMallocSplit book))
+	 (localtime (gnc:timepair->date date)))
+    (with-transaction txn
+		      (lambda ()
+			(xaccTransSetDescription txn (env-string env "exchange"))
+			(xaccTransSetCurrency txn currency)
+			(xaccTransSetDate txn
+					  (gnc:date-get-month-day localtime)
+					  (gnc:date-get-month localtime)
+					  (gnc:date-get-year localtime))
+			(xaccSplitSetParent split-1 txn)
+			(xaccSplitSetParent split-2 txn)
+			(xaccSplitSetAccount split-1 to-account)
+			(xaccSplitSetAccount split-2 from-account)
+			(xaccSplitSetAmount split-1 amount)
+			(xaccSplitSetValue split-1 value)
+			(xaccSplitSetAmount split-2 (gnc-numeric-neg value))
+			(xaccSplitSetValue split-2 (gnc-numeric-neg value))))
+    txn))
+
+;; Whether the table gives the rate of the alist for each commodity,
+;; and zero for those not in the alist.
+(define (rates-match? rate-fn alist report-commodity end-date commodities)
+  (let ((book (gnc-get-current-book)))
+    (every (lambda (commodity)
+	     (let ((pair (assoc commodity alist))
+		   (rate (rate-fn book report-commodity end-date commodity)))
+	       (or (if pair
+		       (gnc-numeric-equal rate (cadr pair))
+		       (gnc-numeric-zero-p rate))
+		   (begin
+		     (format #t "rate of ~a in ~a: ~a, expected ~a\n"
+			     (gnc-commodity-get-mnemonic commodity)
+			     (gnc-commodity-get-mnemonic report-commodity)
+			     rate (and pair (cadr pair)))
+		     #f))))
+	   commodities)))
+
+(define (test-exchange-table-matches-alists)
+  (let* ((env (create-test-env))
+	 (book (gnc-get-current-book))
+	 (table (gnc-commodity-table-get-table book))
+	 (eur (gnc-commodity-table-lookup table "ISO4217" "EUR"))
+	 (usd (gnc-commodity-table-lookup table "ISO4217" "USD"))
+	 (gbp (gnc-commodity-table-lookup table "ISO4217" "GBP"))
+	 (acme (gnc-commodity-table-insert
+		table (gnc-commodity-new book "Acme Corp" "NASDAQ" "ACME" "" 1)))
+	 (eur-cash (env-create-root-account env ACCT-TYPE-BANK eur))
+	 (usd-cash (env-create-root-account env ACCT-TYPE-BANK usd))
+	 (gbp-cash (env-create-root-account env ACCT-TYPE-BANK gbp))
+	 (stock (env-create-root-account env ACCT-TYPE-STOCK acme))
+	 (commodities (list eur usd gbp acme))
+	 (end-date (days-ago 0)))
+    ;; Dollars for euros, then stock for dollars: the stock is only
+    ;; ever traded against the dollar.
+    (create-exchange env (days-ago 5) eur eur-cash usd-cash
+		     (gnc:make-gnc-numeric 1000 1) (gnc:make-gnc-numeric 1200 1))
+    (create-exchange env (days-ago 4) usd usd-cash stock
+		     (gnc:make-gnc-numeric 600 1) (gnc:make-gnc-numeric 10 1))
+    ;; Dollars for pounds, then euros for dollars: the euro ends up on
+    ;; the wrong side of the dollar's pairs.
+    (create-exchange env (days-ago 3) gbp gbp-cash usd-cash
+		     (gnc:make-gnc-numeric 500 1) (gnc:make-gnc-numeric 700 1))
+    (create-exchange env (days-ago 2) usd usd-cash eur-cash
+		     (gnc:make-gnc-numeric 110 1) (gnc:make-gnc-numeric 100 1))
+    (and
+     (every
+      (lambda (report-commodity)
+	(and (rates-match? gnc-exchange-table-get-weighted-average
+			   (gnc:make-exchange-alist report-commodity end-date)
+			   report-commodity end-date commodities)
+	     (rates-match? gnc-exchange-table-get-average-cost
+			   (gnc:make-exchange-cost-alist report-commodity end-date)
+			   report-commodity end-date commodities)))
+      commodities)
+     ;; Everything resolves to euros, the stock through the dollar.
+     (every (lambda (commodity)
+	      (not (gnc-numeric-zero-p
+		    (gnc-exchange-table-get-weighted-average
+		     book eur end-date commodity))))
+	    (list usd gbp acme)))))
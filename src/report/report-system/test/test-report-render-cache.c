@@ -0,0 +1,127 @@
+/********************************************************************\
+ * test-report-render-cache.c: when gnc_run_report reruns a report. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <libguile.h>
+#include <gnc-module.h>
+#include <gnc-engine.h>
+#include <gnc-session.h>
+#include <Account.h>
+#include <test-stuff.h>
+
+#include "../gnc-report.h"
+
+/* A report without account options, so any change to the book affects
+ * it.  Each run renders the number of runs so far. */
+static const char *define_report =
+    "(use-modules (gnucash report report-system))"
+    "(define render-cache-test-runs 0)"
+    "(gnc:define-report"
+    " 'version 1"
+    " 'name \"Render Cache Test\""
+    " 'report-guid \"5e1f0a3c6d2b4e8f9a7c0b1d2e3f4a5b\""
+    " 'options-generator gnc:new-options"
+    " 'renderer (lambda (report)"
+    "             (set! render-cache-test-runs (+ render-cache-test-runs 1))"
+    "             (number->string render-cache-test-runs)))"
+    "(gnc:make-report \"5e1f0a3c6d2b4e8f9a7c0b1d2e3f4a5b\")";
+
+static gint report_id;
+
+static void
+check_run (int runs, const char *title)
+{
+    gchar *html = NULL, *expected = g_strdup_printf ("%d", runs);
+
+    do_test (gnc_run_report (report_id, &html) && html &&
+             strstr (html, expected) != NULL, title);
+    g_free (html);
+    g_free (expected);
+}
+
+static void
+add_account (const char *name)
+{
+    QofBook *book = gnc_get_current_book ();
+    Account *acc = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (gnc_book_get_root_account (book), acc);
+}
+
+static void
+run_tests (void)
+{
+    check_run (1, "first run renders");
+    check_run (1, "unchanged book reuses the html");
+
+    add_account ("with events");
+    check_run (2, "change with events reruns");
+    check_run (2, "and is cached again");
+
+    qof_event_suspend ();
+    add_account ("while suspended");
+    qof_event_resume ();
+    check_run (3, "change while events are suspended reruns");
+    check_run (3, "and is cached again");
+
+    qof_event_suspend_coalescing ();
+    add_account ("while coalescing");
+    qof_event_resume ();
+    check_run (4, "change while events are coalesced reruns");
+
+    gnc_report_invalidate_render_cache (report_id);
+    check_run (5, "invalidated report reruns");
+}
+
+static void
+guile_main (void *closure, int argc, char ** argv)
+{
+    SCM id;
+
+    gnc_module_system_init ();
+    gnc_module_load ("gnucash/report/report-system", 0);
+
+    id = scm_c_eval_string (define_report);
+    do_test (scm_is_integer (id), "make the report");
+    if (scm_is_integer (id))
+    {
+        report_id = scm_to_int (id);
+        run_tests ();
+    }
+
+    print_test_results ();
+    exit (get_rv ());
+}
+
+int
+main (int argc, char ** argv)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    scm_boot_guile (argc, argv, guile_main, NULL);
+    return 0;
+}
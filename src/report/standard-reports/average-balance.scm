@@ -434,11 +434,8 @@
           
           ;; find the net starting balance for the set of accounts 
           (set! startbal 
-                (gnc:accounts-get-balance-helper 
-                 accounts 
-                 (lambda (acct) (gnc:account-get-comm-balance-at-date 
-                                 acct beforebegindate #f))
-                 (lambda (x) #f)))
+                (car (gnc:accountlist-get-comm-balances-at-dates
+                      accounts (list beforebegindate))))
 	  (gnc:report-percent-done 50)
 
           (set! startbal 
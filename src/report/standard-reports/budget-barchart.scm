@@ -182,6 +182,8 @@
         (bgt-vals '())
         (act-vals '())
         (date-list '())
+        (actuals (list->vector
+                  (gnc-budget-get-account-period-actual-value-list budget acct)))
       )
 
       ;; Loop through periods
@@ -193,8 +195,7 @@
               (gnc-numeric-to-double
                 (gnc:get-account-period-rolledup-budget-value budget acct period))))
 	    (set! act-sum (+ act-sum
-              (gnc-numeric-to-double
-                (gnc-budget-get-account-period-actual-value budget acct period))))
+              (gnc-numeric-to-double (vector-ref actuals period))))
           )
         )
         (if (<= report-start-time period-start-time)
@@ -206,8 +207,7 @@
                   (gnc-numeric-to-double
                     (gnc:get-account-period-rolledup-budget-value budget acct period)))
 	        (set! act-sum
-                  (gnc-numeric-to-double
-                    (gnc-budget-get-account-period-actual-value budget acct period)))
+                  (gnc-numeric-to-double (vector-ref actuals period)))
               )
             )
             (set! bgt-vals (append bgt-vals (list bgt-sum)))
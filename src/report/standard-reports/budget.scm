@@ -359,6 +359,19 @@
            )
           )
 
+  ;; The actuals of every period for an account, computed in one pass
+  ;; the first time the account is asked for.
+        (define actuals-table (make-hash-table))
+        (define (get-account-actuals budget acct)
+          (let* ((guid (gncAccountGetGUID acct))
+                 (actuals (hash-ref actuals-table guid)))
+            (or actuals
+                (let ((actuals (list->vector
+                                (gnc-budget-get-account-period-actual-value-list
+                                 budget acct))))
+                  (hash-set! actuals-table guid actuals)
+                  actuals))))
+
   ;; Calculate the value to use for the actual of an account for a specific set of periods.
   ;; This is the sum of the actuals for each of the periods.
   ;;
@@ -370,15 +383,17 @@
   ;; Return value:
   ;;   Budget sum
         (define (gnc:get-account-periodlist-actual-value budget acct periodlist)
-          (cond
-           ((= (length periodlist) 1)
-            (gnc-budget-get-account-period-actual-value budget acct (car periodlist)))
-           (else
-            (gnc-numeric-add
-             (gnc-budget-get-account-period-actual-value budget acct (car periodlist))
-             (gnc:get-account-periodlist-actual-value budget acct (cdr periodlist))
-             GNC-DENOM-AUTO GNC-RND-ROUND))
-           )
+          (let ((actuals (get-account-actuals budget acct)))
+            (cond
+             ((= (length periodlist) 1)
+              (vector-ref actuals (car periodlist)))
+             (else
+              (gnc-numeric-add
+               (vector-ref actuals (car periodlist))
+               (gnc:get-account-periodlist-actual-value budget acct (cdr periodlist))
+               GNC-DENOM-AUTO GNC-RND-ROUND))
+             )
+            )
           )
 
   ;; Adds a line to tbe budget report.
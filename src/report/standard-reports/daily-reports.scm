@@ -419,11 +419,15 @@
           
           ;; find the net starting balance for the set of accounts 
           (set! startbal 
-                (gnc:accounts-get-balance-helper 
-                 accounts 
-                 (lambda (acct) (gnc:account-get-comm-balance-at-date 
-                                 acct beforebegindate #f))
-                 gnc-reverse-balance))
+                (let ((balance-at-date
+                       (lambda (accts)
+                         (car (gnc:accountlist-get-comm-balances-at-dates
+                               accts (list beforebegindate)))))
+                      (reversed (filter gnc-reverse-balance accounts)))
+                  (gnc:commodity-collectorlist-get-merged
+                   (list (balance-at-date (remove gnc-reverse-balance accounts))
+                         (gnc:commodity-collector-get-negated
+                          (balance-at-date reversed))))))
 	  (gnc:report-percent-done 50)
           
           (set! startbal 
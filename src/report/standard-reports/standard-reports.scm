@@ -25,9 +25,11 @@
 
 
 (define-module (gnucash report standard-reports))
+(use-modules (srfi srfi-1))
 (use-modules (srfi srfi-13))
 (use-modules (gnucash main)) ;; FIXME: delete after we finish modularizing.
 (use-modules (gnucash core-utils))
+(use-modules (gnucash report report-system))
 
 (export gnc:register-report-create)
 (export gnc:register-report-hook)
@@ -146,12 +148,85 @@
 (gnc:debug "processed=" (process-file-list (directory-files (gnc-path-get-stdreportsdir))))
 (gnc:debug "report-list=" (get-report-list))
 
-(for-each
-    (lambda (x)
-	    (module-use!
-		    (current-module)
-			(resolve-interface (append '(gnucash report standard-reports) (list x)))))
-	(get-report-list))
+;; The report modules are loaded lazily.  What the report menus need to
+;; know about the templates of each module, and the names it exports,
+;; are kept in a registry in the user's .gnucash directory.  When a
+;; module hasn't changed since it was registered, only stand-ins for
+;; its templates are defined and its exports are autoloaded; the module
+;; itself is loaded when one of its reports is first used.  Other
+;; modules are loaded and (re)registered.
+;;
+;; The registry is a list of (report-symbol mtime exports templates)
+;; entries, where templates is a list of the arguments after the module
+;; name to gnc:define-report-stub.
+
+(define registry-file (gnc-build-dotgnucash-path "standard-reports-registry"))
+(define registry-header (list 'standard-reports-registry 1 (version)
+                              (gnc-path-get-stdreportsdir)))
+
+(define (report-module-name report)
+  (append '(gnucash report standard-reports) (list report)))
+
+(define (report-module-mtime report)
+  (false-if-exception
+   (stat:mtime (stat (string-append (gnc-path-get-stdreportsdir) "/"
+                                    (symbol->string report) ".scm")))))
+
+(define (read-registry)
+  (let ((registry (false-if-exception
+                   (with-input-from-file registry-file read))))
+    (if (and (pair? registry) (equal? (car registry) registry-header))
+        (cdr registry)
+        '())))
+
+(define (write-registry registry)
+  (false-if-exception
+   (with-output-to-file registry-file
+     (lambda ()
+       (display ";;; standard-reports-registry\n")
+       (display ";;; Automatically generated by GnuCash. DO NOT EDIT.\n")
+       (write (cons registry-header registry))
+       (newline)))))
+
+(define (template-registry-entry guid)
+  (let ((template (gnc:find-report-template guid)))
+    (list guid
+          (gnc:report-template-name template)
+          (gnc:report-template-menu-path template)
+          (gnc:report-template-menu-name template)
+          (gnc:report-template-menu-tip template)
+          (gnc:report-template-in-menu? template))))
+
+(define (load-report-module report mtime)
+  (let* ((before (gnc:all-report-template-guids))
+         (interface (resolve-interface (report-module-name report)))
+         (exports (module-map (lambda (sym var) sym) interface)))
+    (module-use! (current-module) interface)
+    (list report mtime exports
+          (map template-registry-entry
+               (remove (lambda (guid) (member guid before))
+                       (gnc:all-report-template-guids))))))
+
+(define (stub-report-module entry)
+  (let ((module-name (report-module-name (car entry))))
+    (for-each
+     (lambda (template) (apply gnc:define-report-stub module-name template))
+     (cadddr entry))
+    (if (not (null? (caddr entry)))
+        (module-autoload! (current-module) module-name (caddr entry)))
+    entry))
+
+(let* ((registry (read-registry))
+       (new-registry
+        (map (lambda (report)
+               (let ((mtime (report-module-mtime report))
+                     (entry (assq report registry)))
+                 (if (and mtime entry (equal? (cadr entry) mtime))
+                     (stub-report-module entry)
+                     (load-report-module report mtime))))
+             (get-report-list))))
+  (if (not (equal? registry new-registry))
+      (write-registry new-registry)))
 
 (use-modules (gnucash gnc-module))
 (gnc:module-load "gnucash/engine" 0)
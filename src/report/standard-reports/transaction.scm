@@ -70,57 +70,6 @@
                            corresponding-acc-name
                            corresponding-acc-code))
 
-(define (split-account-full-name-same-p a b)
-  (= (xaccSplitCompareAccountFullNames a b) 0))
-
-(define (split-account-code-same-p a b)
-  (= (xaccSplitCompareAccountCodes a b) 0))
-
-(define (split-same-corr-account-full-name-p a b)
-  (= (xaccSplitCompareOtherAccountFullNames a b) 0))
-
-(define (split-same-corr-account-code-p a b)
-  (= (xaccSplitCompareOtherAccountCodes a b) 0))
-
-(define (timepair-same-year tp-a tp-b)
-  (= (gnc:timepair-get-year tp-a)
-     (gnc:timepair-get-year tp-b)))
-
-(define (timepair-same-quarter tp-a tp-b)
-  (and (timepair-same-year tp-a tp-b) 
-       (= (gnc:timepair-get-quarter tp-a)
-          (gnc:timepair-get-quarter tp-b))))
-
-(define (timepair-same-month tp-a tp-b)
-  (and (timepair-same-year tp-a tp-b) 
-       (= (gnc:timepair-get-month tp-a)
-          (gnc:timepair-get-month tp-b))))
-
-(define (timepair-same-week tp-a tp-b)
-  (and (timepair-same-year tp-a tp-b)
-       (= (gnc:timepair-get-week tp-a)
-	  (gnc:timepair-get-week tp-b))))
-
-(define (split-same-week-p a b)
-  (let ((tp-a (gnc-transaction-get-date-posted (xaccSplitGetParent a)))
-	(tp-b (gnc-transaction-get-date-posted (xaccSplitGetParent b))))
-    (timepair-same-week tp-a tp-b)))
-
-(define (split-same-month-p a b)
-  (let ((tp-a (gnc-transaction-get-date-posted (xaccSplitGetParent a)))
-        (tp-b (gnc-transaction-get-date-posted (xaccSplitGetParent b))))
-    (timepair-same-month tp-a tp-b)))
-
-(define (split-same-quarter-p a b)
-  (let ((tp-a (gnc-transaction-get-date-posted (xaccSplitGetParent a)))
-        (tp-b (gnc-transaction-get-date-posted (xaccSplitGetParent b))))
-    (timepair-same-quarter tp-a tp-b)))
-
-(define (split-same-year-p a b)
-  (let ((tp-a (gnc-transaction-get-date-posted (xaccSplitGetParent a)))
-        (tp-b (gnc-transaction-get-date-posted (xaccSplitGetParent b))))
-    (timepair-same-year tp-a tp-b)))
-
 (define (set-last-row-style! table tag . rest)
   (let ((arg-list 
          (cons table 
@@ -1106,7 +1055,11 @@ Credit Card, and Income accounts.")))))
     (other-rows-driver split (xaccSplitGetParent split)
                        table used-columns 0))
 
+  ;; group-breaks holds, for each split, where it ends a group; see
+  ;; gnc-split-list-get-group-breaks.  the subtotal preds are the
+  ;; SPLIT-GROUP-* keys of the groups, or #f.
   (define (do-rows-with-subtotals splits 
+                                  group-breaks
                                   table 
                                   used-columns
                                   width
@@ -1144,6 +1097,7 @@ Credit Card, and Income accounts.")))))
                (rest (cdr splits))
                (next (if (null? rest) #f
                          (car rest)))
+               (group-break (car group-breaks))
                (split-value (add-split-row 
                              table 
                              current 
@@ -1171,10 +1125,7 @@ Credit Card, and Income accounts.")))))
                            (gnc:gnc-monetary-commodity split-value)
                            (gnc:gnc-monetary-amount split-value))
 
-          (if (and primary-subtotal-pred
-                   (or (not next)
-                       (and next
-                            (not (primary-subtotal-pred current next)))))
+          (if (= group-break 2)
               (begin 
                 (if secondary-subtotal-pred
 
@@ -1203,11 +1154,7 @@ Credit Card, and Income accounts.")))))
                            table 
                            width def:secondary-subtotal-style used-columns)))))
 
-              (if (and secondary-subtotal-pred
-                       (or (not next)
-                           (and next
-                                (not (secondary-subtotal-pred
-                                      current next)))))
+              (if (= group-break 1)
                   (begin (secondary-subtotal-renderer
                           table width current
                           secondary-subtotal-collector
@@ -1219,6 +1166,7 @@ Credit Card, and Income accounts.")))))
                               def:secondary-subtotal-style used-columns)))))
 
           (do-rows-with-subtotals rest 
+                                  (cdr group-breaks)
                                   table 
                                   used-columns
                                   width 
@@ -1256,7 +1204,12 @@ Credit Card, and Income accounts.")))))
               (secondary-subheading-renderer
                (car splits) table width def:secondary-subtotal-style used-columns))
 
-          (do-rows-with-subtotals splits table used-columns width
+          (do-rows-with-subtotals splits
+                                  (gnc-split-list-get-group-breaks
+                                   splits
+                                   (or primary-subtotal-pred SPLIT-GROUP-NONE)
+                                   (or secondary-subtotal-pred SPLIT-GROUP-NONE))
+                                  table used-columns width
                                   multi-rows? #t
                                   export?
                                   account-types-to-reverse
@@ -1286,17 +1239,17 @@ Credit Card, and Income accounts.")))))
     ;; Defines the different sorting keys, together with the
     ;; subtotal functions. Each entry: (cons
     ;; 'sorting-key-option-value (vector 'query-sorting-key
-    ;; subtotal-function subtotal-renderer))
+    ;; subtotal-group subtotal-renderer))
 ;;  (let* ((used-columns (build-column-used options))) ;; tpo: gives unbound variable options?
     (let* ((used-columns (build-column-used (gnc:report-options report-obj))))
       (list (cons 'account-name  (vector 
                                   (list SPLIT-ACCT-FULLNAME)
-                                  split-account-full-name-same-p 
+                                  SPLIT-GROUP-ACCOUNT-NAME 
                                   render-account-subheading
                                   render-account-subtotal))
             (cons 'account-code  (vector 
                                   (list SPLIT-ACCOUNT ACCOUNT-CODE-)
-                                  split-account-code-same-p
+                                  SPLIT-GROUP-ACCOUNT-CODE
                                   render-account-subheading
                                   render-account-subtotal))
             (cons 'exact-time    (vector
@@ -1314,13 +1267,13 @@ Credit Card, and Income accounts.")))))
             (cons 'corresponding-acc-name
                                  (vector
                                   (list SPLIT-CORR-ACCT-NAME)
-                                  split-same-corr-account-full-name-p 
+                                  SPLIT-GROUP-OTHER-ACCOUNT-NAME 
                                   render-corresponding-account-subheading
                                   render-corresponding-account-subtotal))
             (cons 'corresponding-acc-code
                                  (vector
                                   (list SPLIT-CORR-ACCT-CODE)
-                                  split-same-corr-account-code-p 
+                                  SPLIT-GROUP-OTHER-ACCOUNT-CODE 
                                   render-corresponding-account-subheading
                                   render-corresponding-account-subtotal))
             (cons 'amount        (vector (list SPLIT-VALUE) #f #f #f))
@@ -1334,17 +1287,17 @@ Credit Card, and Income accounts.")))))
 
   (define date-comp-funcs-assoc-list
     ;; Extra list for date option. Each entry: (cons
-    ;; 'date-subtotal-option-value (vector subtotal-function
+    ;; 'date-subtotal-option-value (vector subtotal-group
     ;; subtotal-renderer))
     (list
      (cons 'none (vector #f #f #f))
-     (cons 'weekly (vector split-same-week-p render-week-subheading
+     (cons 'weekly (vector SPLIT-GROUP-WEEK render-week-subheading
 			   render-week-subtotal))
-     (cons 'monthly (vector split-same-month-p render-month-subheading 
+     (cons 'monthly (vector SPLIT-GROUP-MONTH render-month-subheading 
                             render-month-subtotal))
-     (cons 'quarterly (vector split-same-quarter-p render-quarter-subheading 
+     (cons 'quarterly (vector SPLIT-GROUP-QUARTER render-quarter-subheading 
                             render-quarter-subtotal))
-     (cons 'yearly (vector split-same-year-p render-year-subheading
+     (cons 'yearly (vector SPLIT-GROUP-YEAR render-year-subheading
                            render-year-subtotal))))
 
   (define (get-subtotalstuff-helper 